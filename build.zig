@@ -136,6 +136,8 @@ pub fn build(b: *Builder) !void {
 
     test_step.dependOn(tests.addPkgTests(b, test_filter, "std/special/compiler_rt.zig", "compiler-rt", "Run the compiler_rt tests", modes, just_multi, skip_non_native));
 
+    test_step.dependOn(tests.addPkgTests(b, test_filter, "std/special/profile_rt.zig", "profile-rt", "Run the profile_rt tests", modes, just_multi, skip_non_native));
+
     test_step.dependOn(tests.addCompareOutputTests(b, test_filter, modes));
     test_step.dependOn(tests.addStandaloneTests(b, test_filter, modes));
     test_step.dependOn(tests.addCliTests(b, test_filter, modes));
@@ -22,6 +22,7 @@
 
 struct AstNode;
 struct ZigFn;
+struct IrGenJob;
 struct Scope;
 struct ScopeBlock;
 struct ScopeFnDef;
@@ -45,6 +46,7 @@ struct ResultLoc;
 struct ResultLocPeer;
 struct ResultLocPeerParent;
 struct ResultLocBitCast;
+struct CImportLazy;
 
 enum X64CABIClass {
     X64CABIClass_Unknown,
@@ -69,6 +71,10 @@ struct IrExecutable {
     IrAnalyze *analysis;
     Scope *begin_scope;
     ZigList<Tld *> tld_list;
+    // Pass 1 state that analysis writes to. It is reset when the same pass 1
+    // IR is analyzed again for another comptime call.
+    ZigList<ResultLoc *> result_loc_list;
+    ZigList<ZigVar *> var_list;
 
     IrInstruction *coro_handle;
     IrInstruction *atomic_state_field_ptr; // this one is shared and in the promise
@@ -146,6 +152,9 @@ struct ConstUnionValue {
 enum ConstArraySpecial {
     ConstArraySpecialNone,
     ConstArraySpecialUndef,
+    // Only [N]u8 arrays use the packed form. Arrays of other integer, float
+    // and bool types always have one ConstExprValue per element. Slices of a
+    // packed array point into its Buf without expanding it.
     ConstArraySpecialBuf,
 };
 
@@ -157,6 +166,9 @@ struct ConstArrayValue {
         } s_none;
         Buf *s_buf;
     } data;
+    // The only array that refers to s_buf, which it may write in place.
+    // Other arrays, like string literals and copies, copy the Buf first.
+    ConstExprValue *buf_owner;
 };
 
 enum ConstPtrSpecial {
@@ -525,9 +537,15 @@ struct AstNodeFnProto {
     AstNode *async_allocator_type;
 };
 
+struct ParseContext;
+
 struct AstNodeFnDef {
     AstNode *fn_proto;
+    // Null while the body is pending. Use ast_fn_def_body.
     AstNode *body;
+    // Set when the parser skipped the body, which starts at lazy_body_token.
+    ParseContext *lazy_pc;
+    size_t lazy_body_token;
 };
 
 struct AstNodeParamDecl {
@@ -1125,6 +1143,15 @@ struct RootStruct {
     ZigList<size_t> *line_offsets;
     Buf *source_code;
     ZigLLVMDIFile *di_file;
+    // What the code in this file fetched with @import and @embedFile, and
+    // whether it used @cImport. The comptime cache treats these as inputs
+    // of everything declared here.
+    ZigList<ZigType *> fetched_imports;
+    ZigList<Buf *> embedded_files;
+    bool uses_c_import;
+    // Set for an @cImport built with --lazy-cimport. Its source is empty and
+    // find_container_decl translates declarations as they are looked up.
+    CImportLazy *c_import_lazy;
 };
 
 struct ZigTypeStruct {
@@ -1386,6 +1413,15 @@ struct ZigFn {
     ZigList<IrInstructionAllocaGen *> alloca_gen_list;
     ZigList<ZigVar *> variable_list;
 
+    // Pass 1 IR of the body shared by comptime calls, the copy of the
+    // parameter scopes it was generated in, and its variables as pass 1
+    // left them.
+    IrExecutable *comptime_ir;
+    Scope *comptime_ir_scope;
+    ZigVar *comptime_ir_vars;
+    // Set when semantic_analyze ran pass 1 of the body ahead of its analysis.
+    IrGenJob *ir_gen_job;
+
     Buf *section_name;
     AstNode *set_alignstack_node;
 
@@ -1404,6 +1440,18 @@ struct ZigFn {
     bool calls_or_awaits_errorable_fn;
     bool is_cold;
     bool is_test;
+    bool comptime_ir_in_use;
+    bool comptime_ir_uncacheable;
+};
+
+// Pass 1 of a function body, run on a worker thread before the main thread
+// gets to analyzing the function.
+struct IrGenJob {
+    ZigFn *fn_entry;
+    // Errors found in pass 1. They are added to CodeGen::errors when the
+    // function is analyzed, which keeps the order they have without workers.
+    ZigList<ErrorMsg *> errors;
+    size_t ir_instructions_created;
 };
 
 uint32_t fn_table_entry_hash(ZigFn*);
@@ -1647,6 +1695,25 @@ struct TimeEvent {
     const char *name;
 };
 
+// A span of compilation work, such as analyzing one function. Spans nest;
+// they are recorded in the order they begin.
+struct TraceEvent {
+    const char *category;
+    Buf *name;
+    AstNode *source_node; // may be null
+    double start;
+    double end;
+    uint32_t depth;
+};
+
+// Counter values sampled at each TimeEvent.
+struct TraceCounterSample {
+    double time;
+    size_t ir_instructions_created;
+    size_t backward_branches;
+    size_t types_interned;
+};
+
 enum BuildMode {
     BuildModeDebug,
     BuildModeFastRelease,
@@ -1749,16 +1816,43 @@ struct CodeGen {
     HashMap<Buf *, Tld *, buf_hash, buf_eql_buf> external_prototypes;
     HashMap<Buf *, ConstExprValue *, buf_hash, buf_eql_buf> string_literals_table;
     HashMap<const ZigType *, ConstExprValue *, type_ptr_hash, type_ptr_eql> type_info_cache;
+    // indexes into cache_hash.files, for checking comptime cache entries
+    HashMap<Buf *, size_t, buf_hash, buf_eql_buf> comptime_cache_file_table;
 
     ZigList<Tld *> resolve_queue;
     size_t resolve_queue_index;
     ZigList<TimeEvent> timing_events;
+    ZigList<TraceEvent> trace_events;
+    ZigList<TraceCounterSample> trace_counter_samples;
+    // indexes into trace_events of the spans that have begun but not ended
+    ZigList<size_t> trace_stack;
     ZigList<AstNode *> tld_ref_source_node_stack;
     ZigList<ZigFn *> inline_fns;
     ZigList<ZigFn *> test_fns;
     ZigList<ErrorTableEntry *> errors_by_index;
     ZigList<CacheHash *> caches_to_release;
+    // Building the link dependencies in the background; see codegen_start_link_deps.
+    OsProcess *link_deps_process;
+    // How many of job_count are lent to link_deps_process while it runs.
+    size_t link_deps_job_count;
     size_t largest_err_name_len;
+    size_t comptime_eval_count;
+    size_t comptime_eval_depth;
+    // IR arena bytes used by comptime evaluations, counting nested ones once
+    size_t comptime_eval_ir_bytes;
+    size_t comptime_ir_reused;
+    size_t comptime_loop_iterations;
+    size_t packed_arrays_expanded;
+    size_t comptime_cache_files_indexed;
+    size_t comptime_cache_hits;
+    size_t comptime_cache_stores;
+    size_t codegen_units_emitted;
+    size_t codegen_units_reused;
+    size_t source_bytes_read;
+    size_t token_str_bytes_copied;
+    size_t fn_bodies_parsed_lazily;
+    size_t ir_instructions_created;
+    size_t backward_branches;
 
     ZigPackage *std_package;
     ZigPackage *panic_package;
@@ -1814,6 +1908,8 @@ struct CodeGen {
     Buf output_file_path;
     Buf o_file_output_path;
     Buf *cache_dir;
+    Buf *comptime_cache_dir; // created on first use
+    Buf *time_trace_path; // where to write Chrome trace event JSON, or null
     // As an input parameter, mutually exclusive with enable_cache. But it gets
     // populated in codegen_build_and_link.
     Buf *output_dir;
@@ -1832,6 +1928,14 @@ struct CodeGen {
     // The function definitions this module includes.
     ZigList<ZigFn *> fn_defs;
     size_t fn_defs_index;
+    size_t fn_bodies_generated_ahead;
+    // Guard string_literals_table, type_table and the job queue while pass 1
+    // runs on worker threads. Created the first time that happens.
+    OsMutex *string_literals_mutex;
+    OsMutex *type_table_mutex;
+    OsMutex *ir_gen_ahead_mutex;
+    // get_tmp_filename is called from the C object and codegen unit workers.
+    OsMutex *tmp_filename_mutex;
     ZigList<TldVar *> global_vars;
 
     ZigFn *cur_fn;
@@ -1872,9 +1976,11 @@ struct CodeGen {
     bool generate_error_name_table;
     bool enable_cache; // mutually exclusive with output_dir
     bool enable_time_report;
+    bool enable_trace; // record TraceEvents; set by -ftime-report and --time-trace
     bool system_linker_hack;
     bool reported_bad_link_libc_error;
     bool is_dynamic; // shared library rather than static library. dynamic musl rather than static musl.
+    size_t job_count; // max concurrent jobs such as C compilations. 0 means one per CPU core.
 
     //////////////////////////// Participates in Input Parameter Cache Hash
     /////// Note: there is a separate cache hash for builtin.zig, when adding fields,
@@ -1911,11 +2017,18 @@ struct CodeGen {
     bool each_lib_rpath;
     bool is_dummy_so;
     bool disable_gen_h;
+    bool enable_c_pch;
+    bool lazy_cimport;
     bool bundle_compiler_rt;
     bool have_pic;
     bool have_dynamic_link; // this is whether the final thing will be dynamically linked. see also is_dynamic
     bool have_stack_probing;
     bool function_sections;
+    size_t codegen_units; // number of objects the zig module is split into. 0 and 1 mean no split.
+    bool thin_lto; // objects are bitcode with summaries; the linker optimizes them. overrides codegen_units.
+    bool profile_generate;
+    Buf *profile_generate_dir; // null for the working directory of the instrumented program
+    Buf *profile_use_path;
 
     Buf *mmacosx_version_min;
     Buf *mios_version_min;
@@ -2187,6 +2300,9 @@ struct IrBasicBlock {
     bool already_appended;
     bool suspended;
     bool in_resume_stack;
+    // Set when the comptime loop fast path could not run a single iteration
+    // of the loop headed by this block, so later back edges skip it.
+    bool comptime_loop_unsupported;
 };
 
 // These instructions are in transition to having "pass 1" instructions
@@ -2376,7 +2492,9 @@ enum IrInstructionId {
 struct IrInstruction {
     Scope *scope;
     AstNode *source_node;
-    ConstExprValue value;
+    // Never null. In pass1 IR most instructions share one zeroed value;
+    // see ir_create_instruction.
+    ConstExprValue *value;
     size_t debug_id;
     LLVMValueRef llvm_value;
     // if ref_count is zero and the instruction has no side effects,
@@ -3826,6 +3944,8 @@ static const size_t stack_trace_ptr_count = 32;
 
 #define CACHE_OUT_SUBDIR "o"
 #define CACHE_HASH_SUBDIR "h"
+#define CACHE_UNIT_SUBDIR "u"
+#define CACHE_COMPTIME_SUBDIR "ce"
 
 enum FloatMode {
     FloatModeStrict,
@@ -6,14 +6,18 @@
  */
 
 #include "analyze.hpp"
+#include "arena.hpp"
 #include "ast_render.hpp"
+#include "codegen.hpp"
 #include "config.h"
 #include "error.hpp"
 #include "ir.hpp"
 #include "ir_print.hpp"
 #include "os.hpp"
 #include "parser.hpp"
+#include "server.hpp"
 #include "softfloat.hpp"
+#include "translate_c.hpp"
 #include "zig_llvm.h"
 
 
@@ -31,6 +35,21 @@ static void resolve_llvm_types(CodeGen *g, ZigType *type, ResolveStatus wanted_r
 static void preview_use_decl(CodeGen *g, TldUsingNamespace *using_namespace, ScopeDecls *dest_decls_scope);
 static void resolve_use_decl(CodeGen *g, TldUsingNamespace *tld_using_namespace, ScopeDecls *dest_decls_scope);
 
+thread_local IrGenJob *current_ir_gen_job;
+
+// Pass 1 of several functions may be running at once, and it interns the
+// types of string literals and of integer primitives such as u3. Interning
+// also creates LLVM types, so the lock is held until the type is in the table.
+static void lock_type_table(CodeGen *g) {
+    if (current_ir_gen_job != nullptr)
+        os_mutex_lock(g->type_table_mutex);
+}
+
+static void unlock_type_table(CodeGen *g) {
+    if (current_ir_gen_job != nullptr)
+        os_mutex_unlock(g->type_table_mutex);
+}
+
 static bool is_top_level_struct(ZigType *import) {
     return import->id == ZigTypeIdStruct && import->data.structure.root_struct != nullptr;
 }
@@ -52,7 +71,11 @@ ErrorMsg *add_token_error(CodeGen *g, ZigType *owner, Token *token, Buf *msg) {
     ErrorMsg *err = err_msg_create_with_line(root_struct->path, token->start_line, token->start_column,
             root_struct->source_code, root_struct->line_offsets, msg);
 
-    g->errors.append(err);
+    if (current_ir_gen_job != nullptr) {
+        current_ir_gen_job->errors.append(err);
+    } else {
+        g->errors.append(err);
+    }
     return err;
 }
 
@@ -400,6 +423,7 @@ ZigType *get_pointer_to_type_extra(CodeGen *g, ZigType *child_type, bool is_cons
         }
     }
 
+    lock_type_table(g);
     TypeId type_id = {};
     ZigType **parent_pointer = nullptr;
     if (host_int_bytes != 0 || is_volatile || byte_alignment != 0 || ptr_len != PtrLenSingle || allow_zero) {
@@ -414,14 +438,18 @@ ZigType *get_pointer_to_type_extra(CodeGen *g, ZigType *child_type, bool is_cons
         type_id.data.pointer.allow_zero = allow_zero;
 
         auto existing_entry = g->type_table.maybe_get(type_id);
-        if (existing_entry)
+        if (existing_entry) {
+            unlock_type_table(g);
             return existing_entry->value;
+        }
     } else {
         assert(bit_offset_in_host == 0);
         parent_pointer = &child_type->pointer_parent[(is_const ? 1 : 0)];
         if (*parent_pointer) {
             assert((*parent_pointer)->data.pointer.explicit_alignment == 0);
-            return *parent_pointer;
+            ZigType *existing = *parent_pointer;
+            unlock_type_table(g);
+            return existing;
         }
     }
 
@@ -483,6 +511,7 @@ ZigType *get_pointer_to_type_extra(CodeGen *g, ZigType *child_type, bool is_cons
     } else {
         g->type_table.put(type_id, entry);
     }
+    unlock_type_table(g);
     return entry;
 }
 
@@ -592,8 +621,10 @@ ZigType *get_error_union_type(CodeGen *g, ZigType *err_set_type, ZigType *payloa
     type_id.data.error_union.err_set_type = err_set_type;
     type_id.data.error_union.payload_type = payload_type;
 
+    lock_type_table(g);
     auto existing_entry = g->type_table.maybe_get(type_id);
     if (existing_entry) {
+        unlock_type_table(g);
         return existing_entry->value;
     }
 
@@ -634,6 +665,7 @@ ZigType *get_error_union_type(CodeGen *g, ZigType *err_set_type, ZigType *payloa
     }
 
     g->type_table.put(type_id, entry);
+    unlock_type_table(g);
     return entry;
 }
 
@@ -642,8 +674,10 @@ ZigType *get_array_type(CodeGen *g, ZigType *child_type, uint64_t array_size) {
     type_id.id = ZigTypeIdArray;
     type_id.data.array.child_type = child_type;
     type_id.data.array.size = array_size;
+    lock_type_table(g);
     auto existing_entry = g->type_table.maybe_get(type_id);
     if (existing_entry) {
+        unlock_type_table(g);
         return existing_entry->value;
     }
 
@@ -662,6 +696,7 @@ ZigType *get_array_type(CodeGen *g, ZigType *child_type, uint64_t array_size) {
     entry->data.array.len = array_size;
 
     g->type_table.put(type_id, entry);
+    unlock_type_table(g);
     return entry;
 }
 
@@ -929,10 +964,17 @@ static ZigTypeId container_to_type(ContainerKind kind) {
 }
 
 // This is like get_partial_container_type except it's for the implicit root struct of files.
+// If entry is non-null it is a blank type that already-parsed AST nodes use
+// as their owner; it is initialized in place instead of allocating a new one.
 static ZigType *get_root_container_type(CodeGen *g, const char *full_name, Buf *bare_name,
-        RootStruct *root_struct)
+        RootStruct *root_struct, ZigType *entry)
 {
-    ZigType *entry = new_type_table_entry(ZigTypeIdStruct);
+    if (entry == nullptr) {
+        entry = new_type_table_entry(ZigTypeIdStruct);
+    } else {
+        memset(entry, 0, sizeof(ZigType));
+        entry->id = ZigTypeIdStruct;
+    }
     entry->data.structure.decls_scope = create_decls_scope(g, nullptr, nullptr, entry, entry, bare_name);
     entry->data.structure.root_struct = root_struct;
     entry->data.structure.layout = ContainerLayoutAuto;
@@ -2671,8 +2713,12 @@ ZigFn *create_fn(CodeGen *g, AstNode *proto_node) {
     ZigFn *fn_entry = create_fn_raw(g, inline_value);
 
     fn_entry->proto_node = proto_node;
-    fn_entry->body_node = (proto_node->data.fn_proto.fn_def_node == nullptr) ? nullptr :
-        proto_node->data.fn_proto.fn_def_node->data.fn_def.body;
+    AstNode *fn_def_node = proto_node->data.fn_proto.fn_def_node;
+    if (fn_def_node != nullptr) {
+        if (fn_def_node->data.fn_def.body == nullptr)
+            g->fn_bodies_parsed_lazily += 1;
+        fn_entry->body_node = ast_fn_def_body(fn_def_node);
+    }
 
     return fn_entry;
 }
@@ -3368,7 +3414,7 @@ static void preview_use_decl(CodeGen *g, TldUsingNamespace *using_namespace, Sco
     if (type_is_invalid(result->type)) {
         dest_decls_scope->any_imports_failed = true;
         using_namespace->base.resolution = TldResolutionInvalid;
-        using_namespace->using_namespace_value = &g->invalid_instruction->value;
+        using_namespace->using_namespace_value = g->invalid_instruction->value;
         return;
     }
 
@@ -3377,7 +3423,7 @@ static void preview_use_decl(CodeGen *g, TldUsingNamespace *using_namespace, Sco
             buf_sprintf("expected struct, enum, or union; found '%s'", buf_ptr(&result->data.x_type->name)));
         dest_decls_scope->any_imports_failed = true;
         using_namespace->base.resolution = TldResolutionInvalid;
-        using_namespace->using_namespace_value = &g->invalid_instruction->value;
+        using_namespace->using_namespace_value = g->invalid_instruction->value;
         return;
     }
 }
@@ -3389,6 +3435,14 @@ void resolve_top_level_decl(CodeGen *g, Tld *tld, AstNode *source_node) {
     assert(tld->resolution != TldResolutionResolving);
     tld->resolution = TldResolutionResolving;
     g->tld_ref_source_node_stack.append(source_node);
+    // comptime blocks and usingnamespace decls have no name of their own.
+    static Buf *comptime_decl_name = buf_create_from_str("comptime");
+    static Buf *using_namespace_decl_name = buf_create_from_str("usingnamespace");
+    Buf *trace_name = tld->name;
+    if (trace_name == nullptr) {
+        trace_name = (tld->id == TldIdUsingNamespace) ? using_namespace_decl_name : comptime_decl_name;
+    }
+    codegen_trace_begin(g, "decl", trace_name, tld->source_node);
 
     switch (tld->id) {
         case TldIdVar:
@@ -3425,10 +3479,65 @@ void resolve_top_level_decl(CodeGen *g, Tld *tld, AstNode *source_node) {
         }
     }
 
+    codegen_trace_end(g);
     tld->resolution = TldResolutionOk;
     g->tld_ref_source_node_stack.pop();
 }
 
+static CImportLazy *get_c_import_lazy(ScopeDecls *decls_scope) {
+    if (decls_scope->container_type == nullptr || decls_scope->container_type != decls_scope->import)
+        return nullptr;
+    return decls_scope->import->data.structure.root_struct->c_import_lazy;
+}
+
+static void set_node_owner(AstNode **node, void *context) {
+    if (*node == nullptr)
+        return;
+    (*node)->owner = reinterpret_cast<ZigType *>(context);
+    ast_visit_node_children(*node, set_node_owner, context);
+}
+
+// With --lazy-cimport an @cImport starts out without declarations. A name that
+// is not found in it, or in a scope with a usingnamespace of it, is translated
+// from the header and added to it now.
+static Tld *find_lazy_c_decl(CodeGen *g, ScopeDecls *decls_scope, Buf *name) {
+    if (!g->lazy_cimport)
+        return nullptr;
+
+    CImportLazy *c_import_lazy = get_c_import_lazy(decls_scope);
+    if (c_import_lazy != nullptr) {
+        ZigList<AstNode *> new_decls = {};
+        translate_c_lazy_name(c_import_lazy, name, &new_decls);
+        AstNode *root_node = decls_scope->import->data.structure.decl_node;
+        for (size_t i = 0; i < new_decls.length; i += 1) {
+            AstNode *decl_node = new_decls.at(i);
+            set_node_owner(&decl_node, decls_scope->import);
+            root_node->data.container_decl.decls.append(decl_node);
+            scan_decls(g, decls_scope, decl_node);
+        }
+        new_decls.deinit();
+
+        auto entry = decls_scope->decl_table.maybe_get(name);
+        return (entry == nullptr) ? nullptr : entry->value;
+    }
+
+    for (size_t i = 0; i < decls_scope->use_decls.length; i += 1) {
+        TldUsingNamespace *tld_using_namespace = decls_scope->use_decls.at(i);
+        if (tld_using_namespace->base.resolution != TldResolutionOk)
+            continue;
+        ScopeDecls *src_scope = get_container_scope(tld_using_namespace->using_namespace_value->data.x_type);
+        if (get_c_import_lazy(src_scope) == nullptr)
+            continue;
+        Tld *tld = find_lazy_c_decl(g, src_scope, name);
+        if (tld == nullptr || tld->visib_mod == VisibModPrivate)
+            continue;
+        // what resolve_use_decl would have copied had it been declared then
+        decls_scope->decl_table.put(name, tld);
+        return tld;
+    }
+    return nullptr;
+}
+
 Tld *find_container_decl(CodeGen *g, ScopeDecls *decls_scope, Buf *name) {
     // resolve all the using_namespace decls
     for (size_t i = 0; i < decls_scope->use_decls.length; i += 1) {
@@ -3440,7 +3549,9 @@ Tld *find_container_decl(CodeGen *g, ScopeDecls *decls_scope, Buf *name) {
     }
 
     auto entry = decls_scope->decl_table.maybe_get(name);
-    return (entry == nullptr) ? nullptr : entry->value;
+    if (entry != nullptr)
+        return entry->value;
+    return find_lazy_c_decl(g, decls_scope, name);
 }
 
 Tld *find_decl(CodeGen *g, Scope *scope, Buf *name) {
@@ -3843,26 +3954,39 @@ void analyze_fn_ir(CodeGen *g, ZigFn *fn_table_entry, AstNode *return_type_node)
 
 static void analyze_fn_body(CodeGen *g, ZigFn *fn_table_entry) {
     assert(fn_table_entry->anal_state != FnAnalStateProbing);
+    IrGenJob *ir_gen_job = fn_table_entry->ir_gen_job;
+    if (ir_gen_job != nullptr) {
+        fn_table_entry->ir_gen_job = nullptr;
+        for (size_t i = 0; i < ir_gen_job->errors.length; i += 1) {
+            g->errors.append(ir_gen_job->errors.at(i));
+        }
+        ir_gen_job->errors.deinit();
+    }
     if (fn_table_entry->anal_state != FnAnalStateReady)
         return;
 
     fn_table_entry->anal_state = FnAnalStateProbing;
+    codegen_trace_begin(g, fn_table_entry->analyzed_executable.is_generic_instantiation ? "generic" : "fn",
+            &fn_table_entry->symbol_name, fn_table_entry->proto_node);
 
     AstNode *return_type_node = (fn_table_entry->proto_node != nullptr) ?
         fn_table_entry->proto_node->data.fn_proto.return_type : fn_table_entry->fndef_scope->base.source_node;
 
-    assert(fn_table_entry->fndef_scope);
-    if (!fn_table_entry->child_scope)
-        fn_table_entry->child_scope = &fn_table_entry->fndef_scope->base;
+    if (ir_gen_job == nullptr) {
+        assert(fn_table_entry->fndef_scope);
+        if (!fn_table_entry->child_scope)
+            fn_table_entry->child_scope = &fn_table_entry->fndef_scope->base;
 
-    define_local_param_variables(g, fn_table_entry);
+        define_local_param_variables(g, fn_table_entry);
 
-    ZigType *fn_type = fn_table_entry->type_entry;
-    assert(!fn_type->data.fn.is_generic);
+        ZigType *fn_type = fn_table_entry->type_entry;
+        assert(!fn_type->data.fn.is_generic);
 
-    ir_gen_fn(g, fn_table_entry);
+        ir_gen_fn(g, fn_table_entry);
+    }
     if (fn_table_entry->ir_executable.invalid) {
         fn_table_entry->anal_state = FnAnalStateInvalid;
+        codegen_trace_end(g);
         return;
     }
     if (g->verbose_ir) {
@@ -3874,11 +3998,14 @@ static void analyze_fn_body(CodeGen *g, ZigFn *fn_table_entry) {
     }
 
     analyze_fn_ir(g, fn_table_entry, return_type_node);
+    codegen_trace_end(g);
 }
 
 ZigType *add_source_file(CodeGen *g, ZigPackage *package, Buf *resolved_path, Buf *source_code,
         SourceKind source_kind)
 {
+    codegen_trace_begin(g, "file", resolved_path, nullptr);
+
     if (g->verbose_tokenize) {
         fprintf(stderr, "\nOriginal Source (%s):\n", buf_ptr(resolved_path));
         fprintf(stderr, "----------------\n");
@@ -3889,7 +4016,12 @@ ZigType *add_source_file(CodeGen *g, ZigPackage *package, Buf *resolved_path, Bu
     }
 
     Tokenization tokenization = {0};
-    tokenize(source_code, &tokenization);
+    AstNode *root_node = nullptr;
+    ZigType *resident_owner = server_ast_cache_claim(resolved_path, source_code, &tokenization, &root_node);
+    if (resident_owner == nullptr) {
+        tokenize(source_code, &tokenization);
+        g->token_str_bytes_copied += tokenization.str_bytes_copied;
+    }
 
     if (tokenization.err) {
         ErrorMsg *err = err_msg_create_with_line(resolved_path, tokenization.err_line, tokenization.err_column,
@@ -3941,14 +4073,20 @@ ZigType *add_source_file(CodeGen *g, ZigPackage *package, Buf *resolved_path, Bu
     root_struct->line_offsets = tokenization.line_offsets;
     root_struct->path = resolved_path;
     root_struct->di_file = ZigLLVMCreateFile(g->dbuilder, buf_ptr(src_basename), buf_ptr(src_dirname));
-    ZigType *import_entry = get_root_container_type(g, buf_ptr(namespace_name), bare_name, root_struct);
+    ZigType *import_entry = get_root_container_type(g, buf_ptr(namespace_name), bare_name, root_struct,
+            resident_owner);
     if (source_kind == SourceKindRoot) {
         assert(g->root_import == nullptr);
         g->root_import = import_entry;
     }
     g->import_table.put(resolved_path, import_entry);
 
-    AstNode *root_node = ast_parse(source_code, tokenization.tokens, import_entry, g->err_color);
+    if (root_node == nullptr) {
+        // Most of the functions in std and other packages are never called, so
+        // their bodies are left unparsed until create_fn needs them.
+        bool lazy_fn_bodies = package != g->root_package && !g->verbose_ast;
+        root_node = ast_parse(source_code, tokenization.tokens, import_entry, g->err_color, lazy_fn_bodies);
+    }
     assert(root_node != nullptr);
     assert(root_node->type == NodeTypeContainerDecl);
     import_entry->data.structure.decl_node = root_node;
@@ -3990,9 +4128,191 @@ ZigType *add_source_file(CodeGen *g, ZigPackage *package, Buf *resolved_path, Bu
     tld_container->decls_scope = import_entry->data.structure.decls_scope;
     g->resolve_queue.append(&tld_container->base);
 
+    codegen_trace_end(g);
     return import_entry;
 }
 
+// A worker thread is only worth starting for at least this many functions.
+static const size_t ir_gen_ahead_min_jobs_per_thread = 4;
+
+struct IrGenAheadQueue {
+    CodeGen *g;
+    IrGenJob *jobs;
+    size_t jobs_len;
+    size_t next_job_index;
+};
+
+struct IrGenAheadThread {
+    IrGenAheadQueue *queue;
+    OsThread *thread;
+    Arena ir_arena;
+    Arena const_val_arena;
+};
+
+static void ir_gen_ahead_scan(AstNode **node_ptr, void *context) {
+    bool *ok = reinterpret_cast<bool *>(context);
+    AstNode *node = *node_ptr;
+    if (!*ok)
+        return;
+    switch (node->type) {
+        // These create types or declarations while the IR is generated.
+        case NodeTypeContainerDecl:
+        case NodeTypeErrorSetDecl:
+        case NodeTypeCancel:
+        case NodeTypeResume:
+        case NodeTypeAwaitExpr:
+            *ok = false;
+            return;
+        default:
+            ast_visit_node_children(node, ir_gen_ahead_scan, context);
+            return;
+    }
+}
+
+// Whether pass 1 of the body can run on a worker thread. Pass 1 of most
+// functions only reads shared state, and the string literal and type tables
+// are locked. Anything that would create a container or error set type, add a
+// declaration, or resolve a usingnamespace keeps the function on the main thread.
+static bool can_ir_gen_ahead(ZigFn *fn_entry) {
+    if (fn_entry->anal_state != FnAnalStateReady || fn_entry->ir_gen_job != nullptr ||
+        fn_entry->fndef_scope == nullptr || fn_entry->body_node == nullptr)
+    {
+        return false;
+    }
+    ZigType *fn_type = fn_entry->type_entry;
+    FnTypeId *fn_type_id = &fn_type->data.fn.fn_type_id;
+    if (fn_type->data.fn.is_generic || fn_type_id->is_var_args || fn_type_id->cc == CallingConventionAsync)
+        return false;
+    for (size_t i = 0; i < fn_type_id->param_count; i += 1) {
+        if (!type_is_resolved(fn_type_id->param_info[i].type, ResolveStatusAlignmentKnown))
+            return false;
+    }
+    Scope *scope = (fn_entry->child_scope != nullptr) ? fn_entry->child_scope : &fn_entry->fndef_scope->base;
+    for (; scope != nullptr; scope = scope->parent) {
+        if (scope->id != ScopeIdDecls)
+            continue;
+        ScopeDecls *decls_scope = reinterpret_cast<ScopeDecls *>(scope);
+        if (get_c_import_lazy(decls_scope) != nullptr)
+            return false;
+        for (size_t i = 0; i < decls_scope->use_decls.length; i += 1) {
+            TldUsingNamespace *tld_using_namespace = decls_scope->use_decls.at(i);
+            if (tld_using_namespace->base.resolution == TldResolutionUnresolved)
+                return false;
+            // a name lookup there may translate C declarations into it
+            if (tld_using_namespace->base.resolution == TldResolutionOk &&
+                get_c_import_lazy(get_container_scope(tld_using_namespace->using_namespace_value->data.x_type)))
+            {
+                return false;
+            }
+        }
+    }
+    bool ok = true;
+    ir_gen_ahead_scan(&fn_entry->body_node, &ok);
+    return ok;
+}
+
+static void ir_gen_ahead_worker(void *context) {
+    IrGenAheadQueue *queue = reinterpret_cast<IrGenAheadQueue *>(context);
+    for (;;) {
+        os_mutex_lock(queue->g->ir_gen_ahead_mutex);
+        if (queue->next_job_index >= queue->jobs_len) {
+            os_mutex_unlock(queue->g->ir_gen_ahead_mutex);
+            return;
+        }
+        IrGenJob *job = &queue->jobs[queue->next_job_index];
+        queue->next_job_index += 1;
+        os_mutex_unlock(queue->g->ir_gen_ahead_mutex);
+
+        current_ir_gen_job = job;
+        ir_gen_fn(queue->g, job->fn_entry);
+        current_ir_gen_job = nullptr;
+    }
+}
+
+static void ir_gen_ahead_thread(void *context) {
+    IrGenAheadThread *thread = reinterpret_cast<IrGenAheadThread *>(context);
+    ir_gen_ahead_worker(thread->queue);
+    // The IR stays in this thread's arenas; only their statistics go back.
+    thread->ir_arena = ir_arena;
+    thread->const_val_arena = const_val_arena;
+}
+
+// Runs pass 1 of the functions in g->fn_defs up to end on worker threads,
+// before the main thread analyzes them in order. Pass 2 stays on the main
+// thread because it interns types and resolves declarations as it goes.
+static void ir_gen_fn_bodies_ahead(CodeGen *g, size_t end) {
+    Error err;
+
+    size_t job_count = (g->job_count == 0) ? os_cpu_count() : g->job_count;
+    if (job_count < 2 || end - g->fn_defs_index < 2 * ir_gen_ahead_min_jobs_per_thread)
+        return;
+
+    ZigList<ZigFn *> fns = {0};
+    for (size_t i = g->fn_defs_index; i < end; i += 1) {
+        ZigFn *fn_entry = g->fn_defs.at(i);
+        if (can_ir_gen_ahead(fn_entry))
+            fns.append(fn_entry);
+    }
+    size_t thread_count = fns.length / ir_gen_ahead_min_jobs_per_thread;
+    if (thread_count > job_count)
+        thread_count = job_count;
+    if (thread_count < 2) {
+        fns.deinit();
+        return;
+    }
+
+    if (g->ir_gen_ahead_mutex == nullptr) {
+        g->ir_gen_ahead_mutex = os_mutex_create();
+        g->string_literals_mutex = os_mutex_create();
+        g->type_table_mutex = os_mutex_create();
+    }
+    // Pass 1 types `_` as this; the workers must find it already interned.
+    get_pointer_to_type(g, g->builtin_types.entry_void, false);
+
+    codegen_trace_begin(g, "analyze", buf_create_from_str("ir_gen ahead"), nullptr);
+    IrGenAheadQueue queue = {};
+    queue.g = g;
+    queue.jobs = allocate<IrGenJob>(fns.length);
+    queue.jobs_len = fns.length;
+    for (size_t i = 0; i < fns.length; i += 1) {
+        ZigFn *fn_entry = fns.at(i);
+        IrGenJob *job = &queue.jobs[i];
+        job->fn_entry = fn_entry;
+        fn_entry->ir_gen_job = job;
+        if (!fn_entry->child_scope)
+            fn_entry->child_scope = &fn_entry->fndef_scope->base;
+        current_ir_gen_job = job;
+        define_local_param_variables(g, fn_entry);
+        current_ir_gen_job = nullptr;
+    }
+    fns.deinit();
+
+    // The calling thread is one of the workers.
+    IrGenAheadThread *threads = allocate<IrGenAheadThread>(thread_count - 1);
+    size_t threads_len = 0;
+    for (; threads_len < thread_count - 1; threads_len += 1) {
+        IrGenAheadThread *thread = &threads[threads_len];
+        thread->queue = &queue;
+        if ((err = os_thread_spawn(ir_gen_ahead_thread, thread, &thread->thread))) {
+            // Not fatal; the threads we do have will drain the queue.
+            break;
+        }
+    }
+    ir_gen_ahead_worker(&queue);
+    for (size_t i = 0; i < threads_len; i += 1) {
+        os_thread_join(threads[i].thread);
+        arena_add_stats(&ir_arena, &threads[i].ir_arena);
+        arena_add_stats(&const_val_arena, &threads[i].const_val_arena);
+    }
+    free(threads);
+
+    for (size_t i = 0; i < queue.jobs_len; i += 1) {
+        g->ir_instructions_created += queue.jobs[i].ir_instructions_created;
+    }
+    g->fn_bodies_generated_ahead += queue.jobs_len;
+    codegen_trace_end(g);
+}
+
 void semantic_analyze(CodeGen *g) {
     while (g->resolve_queue_index < g->resolve_queue.length ||
            g->fn_defs_index < g->fn_defs.length)
@@ -4003,9 +4323,13 @@ void semantic_analyze(CodeGen *g) {
             resolve_top_level_decl(g, tld, source_node);
         }
 
-        for (; g->fn_defs_index < g->fn_defs.length; g->fn_defs_index += 1) {
-            ZigFn *fn_entry = g->fn_defs.at(g->fn_defs_index);
-            analyze_fn_body(g, fn_entry);
+        while (g->fn_defs_index < g->fn_defs.length) {
+            size_t end = g->fn_defs.length;
+            ir_gen_fn_bodies_ahead(g, end);
+            for (; g->fn_defs_index < end; g->fn_defs_index += 1) {
+                ZigFn *fn_entry = g->fn_defs.at(g->fn_defs_index);
+                analyze_fn_body(g, fn_entry);
+            }
         }
     }
 }
@@ -4017,14 +4341,18 @@ ZigType *get_int_type(CodeGen *g, bool is_signed, uint32_t size_in_bits) {
     type_id.data.integer.is_signed = is_signed;
     type_id.data.integer.bit_count = size_in_bits;
 
+    lock_type_table(g);
     {
         auto entry = g->type_table.maybe_get(type_id);
-        if (entry)
+        if (entry) {
+            unlock_type_table(g);
             return entry->value;
+        }
     }
 
     ZigType *new_entry = make_int_type(g, is_signed, size_in_bits);
     g->type_table.put(type_id, new_entry);
+    unlock_type_table(g);
     return new_entry;
 }
 
@@ -4043,10 +4371,13 @@ ZigType *get_vector_type(CodeGen *g, uint32_t len, ZigType *elem_type) {
     type_id.data.vector.len = len;
     type_id.data.vector.elem_type = elem_type;
 
+    lock_type_table(g);
     {
         auto entry = g->type_table.maybe_get(type_id);
-        if (entry)
+        if (entry) {
+            unlock_type_table(g);
             return entry->value;
+        }
     }
 
     ZigType *entry = new_type_table_entry(ZigTypeIdVector);
@@ -4071,6 +4402,7 @@ ZigType *get_vector_type(CodeGen *g, uint32_t len, ZigType *elem_type) {
     buf_appendf(&entry->name, "@Vector(%u, %s)", len, buf_ptr(&elem_type->name));
 
     g->type_table.put(type_id, entry);
+    unlock_type_table(g);
     return entry;
 }
 
@@ -4124,11 +4456,11 @@ bool handle_is_ptr(ZigType *type_entry) {
 }
 
 static uint32_t hash_ptr(void *ptr) {
-    return (uint32_t)(((uintptr_t)ptr) % UINT32_MAX);
+    return ptr_hash(ptr);
 }
 
 static uint32_t hash_size(size_t x) {
-    return (uint32_t)(x % UINT32_MAX);
+    return uint64_hash(x);
 }
 
 uint32_t fn_table_entry_hash(ZigFn* value) {
@@ -4721,18 +5053,25 @@ ReqCompTime type_requires_comptime(CodeGen *g, ZigType *type_entry) {
 }
 
 void init_const_str_lit(CodeGen *g, ConstExprValue *const_val, Buf *str) {
+    // Pass 1 of several functions may be running at once.
+    bool need_lock = current_ir_gen_job != nullptr;
+    if (need_lock)
+        os_mutex_lock(g->string_literals_mutex);
+
     auto entry = g->string_literals_table.maybe_get(str);
     if (entry != nullptr) {
         memcpy(const_val, entry->value, sizeof(ConstExprValue));
-        return;
-    }
+    } else {
+        const_val->special = ConstValSpecialStatic;
+        const_val->type = get_array_type(g, g->builtin_types.entry_u8, buf_len(str));
+        const_val->data.x_array.special = ConstArraySpecialBuf;
+        const_val->data.x_array.data.s_buf = str;
 
-    const_val->special = ConstValSpecialStatic;
-    const_val->type = get_array_type(g, g->builtin_types.entry_u8, buf_len(str));
-    const_val->data.x_array.special = ConstArraySpecialBuf;
-    const_val->data.x_array.data.s_buf = str;
+        g->string_literals_table.put(str, const_val);
+    }
 
-    g->string_literals_table.put(str, const_val);
+    if (need_lock)
+        os_mutex_unlock(g->string_literals_mutex);
 }
 
 ConstExprValue *create_const_str_lit(CodeGen *g, Buf *str) {
@@ -5021,8 +5360,8 @@ void init_const_undefined(CodeGen *g, ConstExprValue *const_val) {
 }
 
 ConstExprValue *create_const_vals(size_t count) {
-    ConstGlobalRefs *global_refs = allocate<ConstGlobalRefs>(count);
-    ConstExprValue *vals = allocate<ConstExprValue>(count);
+    ConstGlobalRefs *global_refs = arena_allocate<ConstGlobalRefs>(&const_val_arena, count);
+    ConstExprValue *vals = arena_allocate<ConstExprValue>(&const_val_arena, count);
     for (size_t i = 0; i < count; i += 1) {
         vals[i].global_refs = &global_refs[i];
     }
@@ -5083,14 +5422,14 @@ bool ir_get_var_is_comptime(ZigVar *var) {
     // When the is_comptime field references an instruction that has to get analyzed, this
     // is the value.
     if (var->is_comptime->child != nullptr) {
-        assert(var->is_comptime->child->value.type->id == ZigTypeIdBool);
-        return var->is_comptime->child->value.data.x_bool;
+        assert(var->is_comptime->child->value->type->id == ZigTypeIdBool);
+        return var->is_comptime->child->value->data.x_bool;
     }
     // As an optimization, is_comptime values which are constant are allowed
     // to be omitted from analysis. In this case, there is no child instruction
     // and we simply look at the unanalyzed const parent instruction.
-    assert(var->is_comptime->value.type->id == ZigTypeIdBool);
-    return var->is_comptime->value.data.x_bool;
+    assert(var->is_comptime->value->type->id == ZigTypeIdBool);
+    return var->is_comptime->value->data.x_bool;
 }
 
 bool const_values_equal_ptr(ConstExprValue *a, ConstExprValue *b) {
@@ -5678,8 +6017,7 @@ uint32_t type_id_hash(TypeId x) {
             return hash_ptr(x.data.array.child_type) +
                 ((uint32_t)x.data.array.size ^ (uint32_t)2122979968);
         case ZigTypeIdInt:
-            return (x.data.integer.is_signed ? (uint32_t)2652528194 : (uint32_t)163929201) +
-                    (((uint32_t)x.data.integer.bit_count) ^ (uint32_t)2998081557);
+            return uint64_hash((((uint64_t)x.data.integer.bit_count) << 1) | x.data.integer.is_signed);
         case ZigTypeIdVector:
             return hash_ptr(x.data.vector.elem_type) * (x.data.vector.len * 526582681);
     }
@@ -5834,6 +6172,7 @@ void expand_undef_array(CodeGen *g, ConstExprValue *const_val) {
             // If we're doing this it means that we are potentially modifying the data,
             // so we can't have it be in the string literals table
             g->string_literals_table.maybe_remove(buf);
+            g->packed_arrays_expanded += 1;
 
             const_val->data.x_array.special = ConstArraySpecialNone;
             assert(elem_count == buf_len(buf));
@@ -6116,11 +6455,16 @@ not_integer:
 }
 
 Error file_fetch(CodeGen *g, Buf *resolved_path, Buf *contents) {
+    Error err;
     if (g->enable_cache) {
-        return cache_add_file_fetch(&g->cache_hash, resolved_path, contents);
+        err = cache_add_file_fetch(&g->cache_hash, resolved_path, contents);
     } else {
-        return os_fetch_file_path(resolved_path, contents);
+        err = os_fetch_file_path(resolved_path, contents);
+    }
+    if (err == ErrorNone) {
+        g->source_bytes_read += buf_len(contents);
     }
+    return err;
 }
 
 static X64CABIClass type_windows_abi_x86_64_class(CodeGen *g, ZigType *ty, size_t ty_size) {
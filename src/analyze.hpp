@@ -10,6 +10,9 @@
 
 #include "all_types.hpp"
 
+// The pass 1 job this thread is running, if any. See semantic_analyze.
+extern thread_local IrGenJob *current_ir_gen_job;
+
 void semantic_analyze(CodeGen *g);
 ErrorMsg *add_node_error(CodeGen *g, AstNode *node, Buf *msg);
 ErrorMsg *add_token_error(CodeGen *g, ZigType *owner, Token *token, Buf *msg);
@@ -241,6 +244,7 @@ void typecheck_panic_fn(CodeGen *g, TldFn *tld_fn, ZigFn *panic_fn);
 Buf *type_bare_name(ZigType *t);
 Buf *type_h_name(ZigType *t);
 Error create_c_object_cache(CodeGen *g, CacheHash **out_cache_hash, bool verbose);
+Error get_tmp_filename(CodeGen *g, Buf *out, Buf *suffix);
 
 LLVMTypeRef get_llvm_type(CodeGen *g, ZigType *type);
 ZigLLVMDIType *get_llvm_di_type(CodeGen *g, ZigType *type);
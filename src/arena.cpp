@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2019 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "arena.hpp"
+
+static const size_t arena_chunk_size = 1024 * 1024;
+
+thread_local Arena ast_arena = {"ast"};
+thread_local Arena ir_arena = {"ir"};
+thread_local Arena const_val_arena = {"const_val"};
+
+static uint8_t *arena_new_chunk(Arena *arena, size_t size) {
+    // calloc hands out fresh zeroed pages for chunks this large, which is
+    // what lets arena_alloc skip the memset.
+    uint8_t *chunk = reinterpret_cast<uint8_t *>(calloc(1, size));
+    if (!chunk)
+        zig_panic("allocation failed");
+    arena->bytes_reserved += size;
+    arena->chunk_count += 1;
+    return chunk;
+}
+
+void *arena_alloc_slow(Arena *arena, size_t size, size_t align) {
+    arena->alloc_count += 1;
+    arena->bytes_used += size;
+    // Large allocations get a chunk of their own so that the rest of the
+    // current chunk is not wasted.
+    if (size + align > arena_chunk_size / 4) {
+        uint8_t *chunk = arena_new_chunk(arena, size + align);
+        return reinterpret_cast<void *>(((uintptr_t)chunk + align - 1) & ~(uintptr_t)(align - 1));
+    }
+    uint8_t *chunk = arena_new_chunk(arena, arena_chunk_size);
+    uintptr_t addr = ((uintptr_t)chunk + align - 1) & ~(uintptr_t)(align - 1);
+    arena->ptr = reinterpret_cast<uint8_t *>(addr + size);
+    arena->end = chunk + arena_chunk_size;
+    return reinterpret_cast<void *>(addr);
+}
+
+void arena_add_stats(Arena *dest, const Arena *src) {
+    dest->alloc_count += src->alloc_count;
+    dest->bytes_used += src->bytes_used;
+    dest->bytes_reserved += src->bytes_reserved;
+    dest->chunk_count += src->chunk_count;
+}
+
+void arena_print_stats(FILE *f) {
+    Arena *arenas[] = {&ast_arena, &ir_arena, &const_val_arena};
+    fprintf(f, "%20s%14s%14s%16s%10s\n", "Arena", "Allocations", "Bytes Used", "Bytes Reserved", "Chunks");
+    for (size_t i = 0; i < array_length(arenas); i += 1) {
+        Arena *arena = arenas[i];
+        fprintf(f, "%20s%14zu%14zu%16zu%10zu\n", arena->name, arena->alloc_count, arena->bytes_used,
+                arena->bytes_reserved, arena->chunk_count);
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2019 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_ARENA_HPP
+#define ZIG_ARENA_HPP
+
+#include "util.hpp"
+
+#include <stdio.h>
+
+// A bump pointer allocator for objects which live until the process exits,
+// such as AST nodes, IR instructions and comptime values. Memory comes from
+// zeroed chunks and is never reused, so allocations are zeroed without a
+// memset and cost no malloc header. Nothing allocated here may be passed to
+// free or realloc. Each thread allocates from its own chunks; the memory
+// stays valid after the thread exits.
+struct Arena {
+    const char *name;
+    uint8_t *ptr;
+    uint8_t *end;
+    size_t alloc_count;
+    size_t bytes_used;
+    size_t bytes_reserved;
+    size_t chunk_count;
+};
+
+extern thread_local Arena ast_arena;
+extern thread_local Arena ir_arena;
+extern thread_local Arena const_val_arena;
+
+void *arena_alloc_slow(Arena *arena, size_t size, size_t align);
+
+ATTRIBUTE_RETURNS_NOALIAS static inline void *arena_alloc(Arena *arena, size_t size, size_t align) {
+    uintptr_t addr = ((uintptr_t)arena->ptr + align - 1) & ~(uintptr_t)(align - 1);
+    if (addr + size > (uintptr_t)arena->end)
+        return arena_alloc_slow(arena, size, align);
+    arena->ptr = reinterpret_cast<uint8_t *>(addr + size);
+    arena->alloc_count += 1;
+    arena->bytes_used += size;
+    return reinterpret_cast<void *>(addr);
+}
+
+template<typename T>
+ATTRIBUTE_RETURNS_NOALIAS static inline T *arena_allocate(Arena *arena, size_t count) {
+    return reinterpret_cast<T *>(arena_alloc(arena, count * sizeof(T), alignof(T)));
+}
+
+// Adds the statistics of src, which belongs to a thread that is done with
+// it, to dest.
+void arena_add_stats(Arena *dest, const Arena *src);
+void arena_print_stats(FILE *f);
+
+#endif
@@ -8,6 +8,7 @@
 #include "analyze.hpp"
 #include "ast_render.hpp"
 #include "os.hpp"
+#include "parser.hpp"
 
 #include <stdio.h>
 
@@ -330,7 +331,7 @@ static bool is_printable(uint8_t c) {
     return false;
 }
 
-static void string_literal_escape(Buf *source, Buf *dest) {
+void string_literal_escape(Buf *source, Buf *dest) {
     buf_resize(dest, 0);
     for (size_t i = 0; i < buf_len(source); i += 1) {
         uint8_t c = *((uint8_t*)buf_ptr(source) + i);
@@ -499,7 +500,7 @@ static void render_node_extra(AstRender *ar, AstNode *node, bool grouped) {
             {
                 render_node_grouped(ar, node->data.fn_def.fn_proto);
                 fprintf(ar->f, " ");
-                render_node_grouped(ar, node->data.fn_def.body);
+                render_node_grouped(ar, ast_fn_def_body(node));
                 break;
             }
         case NodeTypeBlock:
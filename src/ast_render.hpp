@@ -17,4 +17,7 @@ void ast_print(FILE *f, AstNode *node, int indent);
 
 void ast_render(FILE *f, AstNode *node, int indent_size);
 
+// Escapes source for use between the quotes of a Zig string literal.
+void string_literal_escape(Buf *source, Buf *dest);
+
 #endif
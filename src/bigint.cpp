@@ -1700,7 +1700,7 @@ uint32_t bigint_hash(BigInt x) {
     if (x.digit_count == 0) {
         return 0;
     } else {
-        return bigint_ptr(&x)[0];
+        return uint64_hash(bigint_ptr(&x)[0]);
     }
 }
 
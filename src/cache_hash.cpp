@@ -21,6 +21,7 @@ void cache_init(CacheHash *ch, Buf *manifest_dir) {
     ch->manifest_file_path = nullptr;
     ch->manifest_dirty = false;
     ch->force_check_manifest = false;
+    ch->job_count = 0;
     ch->b64_digest = BUF_INIT;
 }
 
@@ -196,14 +197,21 @@ static Error base64_decode(Slice<uint8_t> dest, Slice<uint8_t> source) {
 static Error hash_file(uint8_t *digest, OsFile handle, Buf *contents) {
     Error err;
 
-    if (contents) {
-        buf_resize(contents, 0);
-    }
-
     blake2b_state blake;
     int rc = blake2b_init(&blake, 48);
     assert(rc == 0);
 
+    if (contents) {
+        // The caller keeps the contents anyway, so take them in one piece and hash that.
+        buf_resize(contents, 0);
+        if ((err = os_file_read_all(handle, contents)))
+            return err;
+        blake2b_update(&blake, buf_ptr(contents), buf_len(contents));
+        rc = blake2b_final(&blake, digest, 48);
+        assert(rc == 0);
+        return ErrorNone;
+    }
+
     for (;;) {
         uint8_t buf[4096];
         size_t amt = 4096;
@@ -215,9 +223,6 @@ static Error hash_file(uint8_t *digest, OsFile handle, Buf *contents) {
             return ErrorNone;
         }
         blake2b_update(&blake, buf, amt);
-        if (contents) {
-            buf_append_mem(contents, (char*)buf, amt);
-        }
     }
 }
 
@@ -241,6 +246,27 @@ static bool is_problematic_timestamp(const OsTimeStamp *fs_clock) {
     return wall_clock.nsec == fs_clock->nsec && wall_clock.sec == fs_clock->sec;
 }
 
+// Attributes taken too close to a modification cannot tell a later
+// modification apart, so zero them and the next check hashes the file again.
+static void forget_problematic_attr(OsFileAttr *attr) {
+    if (is_problematic_timestamp(&attr->mtime) || is_problematic_timestamp(&attr->ctime)) {
+        attr->mtime.sec = 0;
+        attr->mtime.nsec = 0;
+        attr->ctime.sec = 0;
+        attr->ctime.nsec = 0;
+        attr->inode = 0;
+    }
+}
+
+static bool file_attr_eql(const OsFileAttr *a, const OsFileAttr *b) {
+    return a->size == b->size &&
+        a->inode == b->inode &&
+        a->mtime.sec == b->mtime.sec &&
+        a->mtime.nsec == b->mtime.nsec &&
+        a->ctime.sec == b->ctime.sec &&
+        a->ctime.nsec == b->ctime.nsec;
+}
+
 static Error populate_file_hash(CacheHash *ch, CacheHashFile *chf, Buf *contents) {
     Error err;
 
@@ -250,11 +276,7 @@ static Error populate_file_hash(CacheHash *ch, CacheHashFile *chf, Buf *contents
     if ((err = os_file_open_r(chf->path, &this_file, &chf->attr)))
         return err;
 
-    if (is_problematic_timestamp(&chf->attr.mtime)) {
-        chf->attr.mtime.sec = 0;
-        chf->attr.mtime.nsec = 0;
-        chf->attr.inode = 0;
-    }
+    forget_problematic_attr(&chf->attr);
 
     if ((err = hash_file(chf->bin_digest, this_file, contents))) {
         os_file_close(&this_file);
@@ -267,6 +289,84 @@ static Error populate_file_hash(CacheHash *ch, CacheHashFile *chf, Buf *contents
     return ErrorNone;
 }
 
+// A worker thread is only worth starting for at least this many files.
+static const size_t check_files_min_jobs_per_thread = 8;
+
+struct CheckFileJob {
+    CacheHashFile *chf;
+    size_t file_index;
+    OsFileAttr attr;
+    uint8_t digest[48];
+    Error err;
+};
+
+struct CheckFileQueue {
+    CheckFileJob *jobs;
+    size_t jobs_len;
+    size_t next_job_index;
+    OsMutex *mutex;
+};
+
+// The attributes come from the handle that is hashed, so that a file
+// modified after the stat in cache_hit is not recorded with the old ones.
+static Error check_file(CheckFileJob *job) {
+    Error err;
+    OsFile this_file;
+    if ((err = os_file_open_r(job->chf->path, &this_file, &job->attr)))
+        return err;
+    forget_problematic_attr(&job->attr);
+
+    err = hash_file(job->digest, this_file, nullptr);
+    os_file_close(&this_file);
+    return err;
+}
+
+static void check_files_worker(void *context) {
+    CheckFileQueue *queue = reinterpret_cast<CheckFileQueue *>(context);
+    for (;;) {
+        os_mutex_lock(queue->mutex);
+        if (queue->next_job_index >= queue->jobs_len) {
+            os_mutex_unlock(queue->mutex);
+            return;
+        }
+        CheckFileJob *job = &queue->jobs[queue->next_job_index];
+        queue->next_job_index += 1;
+        os_mutex_unlock(queue->mutex);
+
+        job->err = check_file(job);
+    }
+}
+
+// Hashes the files of the jobs, spread over threads when there are enough of them.
+static void check_files(CheckFileJob *jobs, size_t jobs_len, size_t job_count) {
+    Error err;
+
+    CheckFileQueue queue = {};
+    queue.jobs = jobs;
+    queue.jobs_len = jobs_len;
+    queue.mutex = os_mutex_create();
+
+    size_t max_thread_count = (job_count == 0) ? os_cpu_count() : job_count;
+    size_t thread_count = jobs_len / check_files_min_jobs_per_thread;
+    if (thread_count > max_thread_count)
+        thread_count = max_thread_count;
+    // The calling thread is one of the workers.
+    ZigList<OsThread *> threads = {};
+    for (size_t thread_i = 1; thread_i < thread_count; thread_i += 1) {
+        OsThread *thread;
+        if ((err = os_thread_spawn(check_files_worker, &queue, &thread))) {
+            // Not fatal; the threads we do have will drain the queue.
+            break;
+        }
+        threads.append(thread);
+    }
+    check_files_worker(&queue);
+    for (size_t thread_i = 0; thread_i < threads.length; thread_i += 1) {
+        os_thread_join(threads.at(thread_i));
+    }
+    threads.deinit();
+}
+
 Error cache_hit(CacheHash *ch, Buf *out_digest) {
     Error err;
 
@@ -305,63 +405,45 @@ Error cache_hit(CacheHash *ch, Buf *out_digest) {
         return err;
     }
 
+    // First read the whole manifest. Each line is
+    // size inode mtime_sec mtime_nsec ctime_sec ctime_nsec digest path
     size_t input_file_count = ch->files.length;
-    bool any_file_changed = false;
     Error return_code = ErrorNone;
     size_t file_i = 0;
     SplitIterator line_it = memSplit(buf_to_slice(&line_buf), str("\n"));
     for (;; file_i += 1) {
         Optional<Slice<uint8_t>> opt_line = SplitIterator_next(&line_it);
+        if (!opt_line.is_some)
+            break;
 
         CacheHashFile *chf;
         if (file_i < input_file_count) {
             chf = &ch->files.at(file_i);
-        } else if (any_file_changed) {
-            // cache miss.
-            // keep the manifest file open with the rw lock
-            // reset the hash
-            rc = blake2b_init(&ch->blake, 48);
-            assert(rc == 0);
-            blake2b_update(&ch->blake, bin_digest, 48);
-            ch->files.resize(input_file_count);
-            // bring the hash up to the input file hashes
-            for (file_i = 0; file_i < input_file_count; file_i += 1) {
-                blake2b_update(&ch->blake, ch->files.at(file_i).bin_digest, 48);
-            }
-            // caller can notice that out_digest is unmodified.
-            return return_code;
-        } else if (!opt_line.is_some) {
-            break;
         } else {
             chf = ch->files.add_one();
             chf->path = nullptr;
         }
 
-        if (!opt_line.is_some)
-            break;
-
         SplitIterator it = memSplit(opt_line.value, str(" "));
 
-        Optional<Slice<uint8_t>> opt_inode = SplitIterator_next(&it);
-        if (!opt_inode.is_some) {
-            return_code = ErrorInvalidFormat;
-            break;
-        }
-        chf->attr.inode = strtoull((const char *)opt_inode.value.ptr, nullptr, 10);
-
-        Optional<Slice<uint8_t>> opt_mtime_sec = SplitIterator_next(&it);
-        if (!opt_mtime_sec.is_some) {
-            return_code = ErrorInvalidFormat;
-            break;
+        uint64_t *int_fields[] = {
+            &chf->attr.size,
+            &chf->attr.inode,
+            &chf->attr.mtime.sec,
+            &chf->attr.mtime.nsec,
+            &chf->attr.ctime.sec,
+            &chf->attr.ctime.nsec,
+        };
+        for (size_t field_i = 0; field_i < array_length(int_fields); field_i += 1) {
+            Optional<Slice<uint8_t>> opt_field = SplitIterator_next(&it);
+            if (!opt_field.is_some) {
+                return_code = ErrorInvalidFormat;
+                break;
+            }
+            *int_fields[field_i] = strtoull((const char *)opt_field.value.ptr, nullptr, 10);
         }
-        chf->attr.mtime.sec = strtoull((const char *)opt_mtime_sec.value.ptr, nullptr, 10);
-
-        Optional<Slice<uint8_t>> opt_mtime_nsec = SplitIterator_next(&it);
-        if (!opt_mtime_nsec.is_some) {
-            return_code = ErrorInvalidFormat;
+        if (return_code != ErrorNone)
             break;
-        }
-        chf->attr.mtime.nsec = strtoull((const char *)opt_mtime_nsec.value.ptr, nullptr, 10);
 
         Optional<Slice<uint8_t>> opt_digest = SplitIterator_next(&it);
         if (!opt_digest.is_some) {
@@ -384,66 +466,91 @@ Error cache_hit(CacheHash *ch, Buf *out_digest) {
             break;
         }
         chf->path = this_path;
+    }
 
-        // if the mtime matches we can trust the digest
-        OsFile this_file;
-        OsFileAttr actual_attr;
-        if ((err = os_file_open_r(chf->path, &this_file, &actual_attr))) {
-            fprintf(stderr, "Unable to open %s\n: %s", buf_ptr(chf->path), err_str(err));
-            os_file_close(&ch->manifest_file);
-            return ErrorCacheUnavailable;
-        }
-        if (chf->attr.mtime.sec == actual_attr.mtime.sec &&
-            chf->attr.mtime.nsec == actual_attr.mtime.nsec &&
-            chf->attr.inode == actual_attr.inode)
-        {
-            os_file_close(&this_file);
-        } else {
-            // we have to recompute the digest.
-            // later we'll rewrite the manifest with the new mtime/digest values
-            ch->manifest_dirty = true;
-            chf->attr = actual_attr;
-
-            if (is_problematic_timestamp(&actual_attr.mtime)) {
-                chf->attr.mtime.sec = 0;
-                chf->attr.mtime.nsec = 0;
-                chf->attr.inode = 0;
-            }
+    // A manifest that is empty, missing input files, or malformed is a cache
+    // miss. Only the input files are kept, and those without a manifest entry
+    // get hashed along with any that changed.
+    bool manifest_miss = file_i < input_file_count || file_i == 0 || return_code != ErrorNone;
+    size_t manifest_file_count = file_i;
+    if (manifest_miss) {
+        ch->files.resize(input_file_count);
+        if (manifest_file_count > input_file_count)
+            manifest_file_count = input_file_count;
+    }
 
-            uint8_t actual_digest[48];
-            if ((err = hash_file(actual_digest, this_file, nullptr))) {
-                os_file_close(&this_file);
+    // Then stat every file, and hash only those whose attributes differ from
+    // the manifest. The hashing is what takes time, so it runs on threads.
+    // A file found during the last build that is gone now makes a cache miss
+    // rather than an error, since whatever included it may have changed too.
+    bool any_file_changed = false;
+    ZigList<CheckFileJob> jobs = {};
+    for (file_i = 0; file_i < ch->files.length; file_i += 1) {
+        CacheHashFile *chf = &ch->files.at(file_i);
+        if (file_i < manifest_file_count) {
+            OsFileAttr actual_attr;
+            if ((err = os_file_stat(chf->path, &actual_attr))) {
+                if (file_i >= input_file_count) {
+                    any_file_changed = true;
+                    continue;
+                }
+                fprintf(stderr, "Unable to open %s\n: %s", buf_ptr(chf->path), err_str(err));
                 os_file_close(&ch->manifest_file);
-                return err;
+                jobs.deinit();
+                return ErrorCacheUnavailable;
             }
-            os_file_close(&this_file);
-            if (memcmp(chf->bin_digest, actual_digest, 48) != 0) {
-                memcpy(chf->bin_digest, actual_digest, 48);
-                // keep going until we have the input file digests
+            if (file_attr_eql(&chf->attr, &actual_attr))
+                continue;
+        }
+        CheckFileJob *job = jobs.add_one();
+        job->chf = chf;
+        job->file_index = file_i;
+    }
+    check_files(jobs.items, jobs.length, ch->job_count);
+
+    for (size_t job_i = 0; job_i < jobs.length; job_i += 1) {
+        CheckFileJob *job = &jobs.at(job_i);
+        CacheHashFile *chf = job->chf;
+        if (job->err != ErrorNone) {
+            if (job->file_index >= input_file_count) {
                 any_file_changed = true;
+                continue;
             }
+            fprintf(stderr, "Unable to hash %s: %s\n", buf_ptr(chf->path), err_str(job->err));
+            os_file_close(&ch->manifest_file);
+            jobs.deinit();
+            return ErrorCacheUnavailable;
         }
-        if (!any_file_changed) {
-            blake2b_update(&ch->blake, chf->bin_digest, 48);
+        // Later we'll rewrite the manifest with the new attributes and digest.
+        ch->manifest_dirty = true;
+        chf->attr = job->attr;
+        if (memcmp(chf->bin_digest, job->digest, 48) != 0) {
+            memcpy(chf->bin_digest, job->digest, 48);
+            if (job->file_index < manifest_file_count)
+                any_file_changed = true;
         }
     }
-    if (file_i < input_file_count || file_i == 0 || return_code != ErrorNone) {
-        // manifest file is empty or missing entries, so this is a cache miss
+    jobs.deinit();
+
+    if (manifest_miss || any_file_changed) {
+        // Cache miss. Keep the manifest file open with the rw lock, and
+        // bring the hash up to the input file digests. The caller can notice
+        // that out_digest is unmodified.
         ch->manifest_dirty = true;
-        for (; file_i < input_file_count; file_i += 1) {
-            CacheHashFile *chf = &ch->files.at(file_i);
-            if ((err = populate_file_hash(ch, chf, nullptr))) {
-                fprintf(stderr, "Unable to hash %s: %s\n", buf_ptr(chf->path), err_str(err));
-                os_file_close(&ch->manifest_file);
-                return ErrorCacheUnavailable;
-            }
+        ch->files.resize(input_file_count);
+        for (file_i = 0; file_i < input_file_count; file_i += 1) {
+            blake2b_update(&ch->blake, ch->files.at(file_i).bin_digest, 48);
         }
         if (return_code != ErrorNone && return_code != ErrorInvalidFormat) {
             os_file_close(&ch->manifest_file);
         }
         return return_code;
     }
+
     // Cache Hit
+    for (file_i = 0; file_i < ch->files.length; file_i += 1) {
+        blake2b_update(&ch->blake, ch->files.at(file_i).bin_digest, 48);
+    }
     return cache_final(ch, out_digest);
 }
 
@@ -541,8 +648,10 @@ static Error write_manifest_file(CacheHash *ch) {
     for (size_t i = 0; i < ch->files.length; i += 1) {
         CacheHashFile *chf = &ch->files.at(i);
         base64_encode({encoded_digest, 64}, {chf->bin_digest, 48});
-        buf_appendf(&contents, "%" ZIG_PRI_u64 " %" ZIG_PRI_u64 " %" ZIG_PRI_u64 " %s %s\n",
-            chf->attr.inode, chf->attr.mtime.sec, chf->attr.mtime.nsec, encoded_digest, buf_ptr(chf->path));
+        buf_appendf(&contents, "%" ZIG_PRI_u64 " %" ZIG_PRI_u64 " %" ZIG_PRI_u64 " %" ZIG_PRI_u64
+            " %" ZIG_PRI_u64 " %" ZIG_PRI_u64 " %s %s\n",
+            chf->attr.size, chf->attr.inode, chf->attr.mtime.sec, chf->attr.mtime.nsec,
+            chf->attr.ctime.sec, chf->attr.ctime.nsec, encoded_digest, buf_ptr(chf->path));
     }
     if ((err = os_file_overwrite(ch->manifest_file, &contents)))
         return err;
@@ -568,6 +677,32 @@ Error cache_final(CacheHash *ch, Buf *out_digest) {
     return ErrorNone;
 }
 
+Error cache_file_digest(Buf *resolved_path, uint8_t *bin_digest) {
+    Error err;
+    OsFile this_file;
+    if ((err = os_file_open_r(resolved_path, &this_file, nullptr)))
+        return err;
+    err = hash_file(bin_digest, this_file, nullptr);
+    os_file_close(&this_file);
+    return err;
+}
+
+void cache_mem_digest(CacheHash *ch, const void *ptr, size_t len, Buf *out_b64_digest) {
+    assert(buf_len(&ch->b64_digest) != 0);
+
+    blake2b_state blake;
+    int rc = blake2b_init(&blake, 48);
+    assert(rc == 0);
+    blake2b_update(&blake, buf_ptr(&ch->b64_digest), buf_len(&ch->b64_digest));
+    blake2b_update(&blake, ptr, len);
+
+    uint8_t bin_digest[48];
+    rc = blake2b_final(&blake, bin_digest, 48);
+    assert(rc == 0);
+    buf_resize(out_b64_digest, 64);
+    base64_encode(buf_to_slice(out_b64_digest), {bin_digest, 48});
+}
+
 void cache_release(CacheHash *ch) {
     assert(ch->manifest_file_path != nullptr);
 
@@ -583,3 +718,50 @@ void cache_release(CacheHash *ch) {
     os_file_close(&ch->manifest_file);
 }
 
+struct CollectDirEntry {
+    Buf *path;
+    int64_t mtime_sec;
+};
+
+static int collect_dir_entry_cmp(const void *a, const void *b) {
+    int64_t a_time = reinterpret_cast<const CollectDirEntry *>(a)->mtime_sec;
+    int64_t b_time = reinterpret_cast<const CollectDirEntry *>(b)->mtime_sec;
+    return (a_time > b_time) - (a_time < b_time);
+}
+
+void cache_collect_dir(Buf *dir, size_t max_entries, int64_t min_age_sec) {
+    Error err;
+    ZigList<OsDirEntry> dir_entries = {};
+    if ((err = os_dir_entries(dir, dir_entries)))
+        return;
+    if (dir_entries.length > max_entries) {
+        ZigList<CollectDirEntry> entries = {};
+        for (size_t i = 0; i < dir_entries.length; i += 1) {
+            if (dir_entries.at(i).is_dir)
+                continue;
+            CollectDirEntry entry;
+            entry.path = buf_alloc();
+            os_path_join(dir, dir_entries.at(i).name, entry.path);
+            OsFile file;
+            OsFileAttr attr;
+            if ((err = os_file_open_r(entry.path, &file, &attr)))
+                continue;
+            os_file_close(&file);
+            entry.mtime_sec = (int64_t)attr.mtime.sec;
+            entries.append(entry);
+        }
+        qsort(entries.items, entries.length, sizeof(CollectDirEntry), collect_dir_entry_cmp);
+
+        int64_t now_sec = (int64_t)os_timestamp_calendar().sec;
+        size_t remaining = entries.length;
+        for (size_t i = 0; i < entries.length && remaining > max_entries; i += 1) {
+            if (now_sec - entries.at(i).mtime_sec < min_age_sec)
+                break;
+            if (os_delete_file(entries.at(i).path) == ErrorNone) {
+                remaining -= 1;
+            }
+        }
+        entries.deinit();
+    }
+    dir_entries.deinit();
+}
@@ -29,6 +29,8 @@ struct CacheHash {
     OsFile manifest_file;
     bool manifest_dirty;
     bool force_check_manifest;
+    // The most threads cache_hit hashes files on, as with -j. 0 means one per CPU.
+    size_t job_count;
 };
 
 // Always call this first to set up.
@@ -77,5 +79,20 @@ Error ATTRIBUTE_MUST_USE cache_final(CacheHash *ch, Buf *out_b64_digest);
 // Until this function is called, no one will be able to get a lock on your input params.
 void cache_release(CacheHash *ch);
 
+// Computes the digest that a manifest would record for the file, without
+// adding it to any CacheHash. The file path argument must be already resolved.
+Error ATTRIBUTE_MUST_USE cache_file_digest(Buf *resolved_path, uint8_t *bin_digest);
+
+// Hashes ptr together with the input parameter digest of ch, for artifacts
+// addressed by their contents rather than recorded in the manifest.
+// May be called from any thread after cache_hit.
+void cache_mem_digest(CacheHash *ch, const void *ptr, size_t len, Buf *out_b64_digest);
+
+// For a directory of such artifacts, which no manifest refers to: once it holds
+// more than max_entries files, deletes the least recently modified ones, except
+// those modified within min_age_sec, which a concurrent build may be using.
+// Touch an artifact when reusing it so that it counts as recently used.
+void cache_collect_dir(Buf *dir, size_t max_entries, int64_t min_age_sec);
+
 
 #endif
@@ -6,6 +6,7 @@
  */
 
 #include "analyze.hpp"
+#include "arena.hpp"
 #include "ast_render.hpp"
 #include "codegen.hpp"
 #include "compiler.hpp"
@@ -21,6 +22,8 @@
 #include "zig_llvm.h"
 #include "userland.h"
 
+#include <llvm-c/BitReader.h>
+
 #include <stdio.h>
 #include <errno.h>
 
@@ -1933,21 +1936,21 @@ static void gen_var_debug_decl(CodeGen *g, ZigVar *var) {
 }
 
 static LLVMValueRef ir_llvm_value(CodeGen *g, IrInstruction *instruction) {
-    if (!type_has_bits(instruction->value.type))
+    if (!type_has_bits(instruction->value->type))
         return nullptr;
     if (!instruction->llvm_value) {
-        src_assert(instruction->value.special != ConstValSpecialRuntime, instruction->source_node);
-        assert(instruction->value.type);
-        render_const_val(g, &instruction->value, "");
+        src_assert(instruction->value->special != ConstValSpecialRuntime, instruction->source_node);
+        assert(instruction->value->type);
+        render_const_val(g, instruction->value, "");
         // we might have to do some pointer casting here due to the way union
         // values are rendered with a type other than the one we expect
-        if (handle_is_ptr(instruction->value.type)) {
-            render_const_val_global(g, &instruction->value, "");
-            ZigType *ptr_type = get_pointer_to_type(g, instruction->value.type, true);
-            instruction->llvm_value = LLVMBuildBitCast(g->builder, instruction->value.global_refs->llvm_global, get_llvm_type(g, ptr_type), "");
+        if (handle_is_ptr(instruction->value->type)) {
+            render_const_val_global(g, instruction->value, "");
+            ZigType *ptr_type = get_pointer_to_type(g, instruction->value->type, true);
+            instruction->llvm_value = LLVMBuildBitCast(g->builder, instruction->value->global_refs->llvm_global, get_llvm_type(g, ptr_type), "");
         } else {
-            instruction->llvm_value = LLVMBuildBitCast(g->builder, instruction->value.global_refs->llvm_value,
-                    get_llvm_type(g, instruction->value.type), "");
+            instruction->llvm_value = LLVMBuildBitCast(g->builder, instruction->value->global_refs->llvm_value,
+                    get_llvm_type(g, instruction->value->type), "");
         }
         assert(instruction->llvm_value);
     }
@@ -2009,7 +2012,7 @@ static bool iter_function_params_c_abi(CodeGen *g, ZigType *fn_type, FnWalk *fn_
             if (src_i >= fn_walk->data.call.inst->arg_count)
                 return false;
             IrInstruction *arg = fn_walk->data.call.inst->args[src_i];
-            ty = arg->value.type;
+            ty = arg->value->type;
             source_node = arg->source_node;
             val = ir_llvm_value(g, arg);
             break;
@@ -2232,7 +2235,7 @@ void walk_function_params(CodeGen *g, ZigType *fn_type, FnWalk *fn_walk) {
         bool is_var_args = fn_walk->data.call.is_var_args;
         for (size_t call_i = 0; call_i < instruction->arg_count; call_i += 1) {
             IrInstruction *param_instruction = instruction->args[call_i];
-            ZigType *param_type = param_instruction->value.type;
+            ZigType *param_type = param_instruction->value->type;
             if (is_var_args || type_has_bits(param_type)) {
                 LLVMValueRef param_value = ir_llvm_value(g, param_instruction);
                 assert(param_value);
@@ -2328,10 +2331,10 @@ static LLVMValueRef ir_render_return(CodeGen *g, IrExecutable *executable, IrIns
             return nullptr;
         }
         assert(g->cur_ret_ptr);
-        src_assert(return_instruction->value->value.special != ConstValSpecialRuntime,
+        src_assert(return_instruction->value->value->special != ConstValSpecialRuntime,
                 return_instruction->base.source_node);
         LLVMValueRef value = ir_llvm_value(g, return_instruction->value);
-        ZigType *return_type = return_instruction->value->value.type;
+        ZigType *return_type = return_instruction->value->value->type;
         gen_assign_raw(g, g->cur_ret_ptr, get_pointer_to_type(g, return_type, false), value);
         LLVMBuildRetVoid(g->builder);
     } else if (g->cur_fn->type_entry->data.fn.fn_type_id.cc != CallingConventionAsync &&
@@ -2665,15 +2668,15 @@ static LLVMValueRef ir_render_bin_op(CodeGen *g, IrExecutable *executable,
     IrInstruction *op1 = bin_op_instruction->op1;
     IrInstruction *op2 = bin_op_instruction->op2;
 
-    assert(op1->value.type == op2->value.type || op_id == IrBinOpBitShiftLeftLossy ||
+    assert(op1->value->type == op2->value->type || op_id == IrBinOpBitShiftLeftLossy ||
         op_id == IrBinOpBitShiftLeftExact || op_id == IrBinOpBitShiftRightLossy ||
         op_id == IrBinOpBitShiftRightExact ||
-        (op1->value.type->id == ZigTypeIdErrorSet && op2->value.type->id == ZigTypeIdErrorSet) ||
-        (op1->value.type->id == ZigTypeIdPointer &&
+        (op1->value->type->id == ZigTypeIdErrorSet && op2->value->type->id == ZigTypeIdErrorSet) ||
+        (op1->value->type->id == ZigTypeIdPointer &&
             (op_id == IrBinOpAdd || op_id == IrBinOpSub) &&
-            op1->value.type->data.pointer.ptr_len != PtrLenSingle)
+            op1->value->type->data.pointer.ptr_len != PtrLenSingle)
     );
-    ZigType *operand_type = op1->value.type;
+    ZigType *operand_type = op1->value->type;
     ZigType *scalar_type = (operand_type->id == ZigTypeIdVector) ? operand_type->data.vector.elem_type : operand_type;
 
     bool want_runtime_safety = bin_op_instruction->safety_check_on &&
@@ -2775,7 +2778,7 @@ static LLVMValueRef ir_render_bin_op(CodeGen *g, IrExecutable *executable,
         case IrBinOpBitShiftLeftExact:
             {
                 assert(scalar_type->id == ZigTypeIdInt);
-                LLVMValueRef op2_casted = gen_widen_or_shorten(g, false, op2->value.type, scalar_type, op2_value);
+                LLVMValueRef op2_casted = gen_widen_or_shorten(g, false, op2->value->type, scalar_type, op2_value);
                 bool is_sloppy = (op_id == IrBinOpBitShiftLeftLossy);
                 if (is_sloppy) {
                     return LLVMBuildShl(g->builder, op1_value, op2_casted, "");
@@ -2791,7 +2794,7 @@ static LLVMValueRef ir_render_bin_op(CodeGen *g, IrExecutable *executable,
         case IrBinOpBitShiftRightExact:
             {
                 assert(scalar_type->id == ZigTypeIdInt);
-                LLVMValueRef op2_casted = gen_widen_or_shorten(g, false, op2->value.type, scalar_type, op2_value);
+                LLVMValueRef op2_casted = gen_widen_or_shorten(g, false, op2->value->type, scalar_type, op2_value);
                 bool is_sloppy = (op_id == IrBinOpBitShiftRightLossy);
                 if (is_sloppy) {
                     if (scalar_type->data.integral.is_signed) {
@@ -2881,8 +2884,8 @@ static void add_error_range_check(CodeGen *g, ZigType *err_set_type, ZigType *in
 static LLVMValueRef ir_render_resize_slice(CodeGen *g, IrExecutable *executable,
         IrInstructionResizeSlice *instruction)
 {
-    ZigType *actual_type = instruction->operand->value.type;
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *actual_type = instruction->operand->value->type;
+    ZigType *wanted_type = instruction->base.value->type;
     LLVMValueRef expr_val = ir_llvm_value(g, instruction->operand);
     assert(expr_val);
 
@@ -2949,8 +2952,8 @@ static LLVMValueRef ir_render_resize_slice(CodeGen *g, IrExecutable *executable,
 static LLVMValueRef ir_render_cast(CodeGen *g, IrExecutable *executable,
         IrInstructionCast *cast_instruction)
 {
-    ZigType *actual_type = cast_instruction->value->value.type;
-    ZigType *wanted_type = cast_instruction->base.value.type;
+    ZigType *actual_type = cast_instruction->value->value->type;
+    ZigType *wanted_type = cast_instruction->base.value->type;
     LLVMValueRef expr_val = ir_llvm_value(g, cast_instruction->value);
     assert(expr_val);
 
@@ -3017,7 +3020,7 @@ static LLVMValueRef ir_render_cast(CodeGen *g, IrExecutable *executable,
 static LLVMValueRef ir_render_ptr_of_array_to_slice(CodeGen *g, IrExecutable *executable,
         IrInstructionPtrOfArrayToSlice *instruction)
 {
-    ZigType *actual_type = instruction->operand->value.type;
+    ZigType *actual_type = instruction->operand->value->type;
     LLVMValueRef expr_val = ir_llvm_value(g, instruction->operand);
     assert(expr_val);
 
@@ -3046,7 +3049,7 @@ static LLVMValueRef ir_render_ptr_of_array_to_slice(CodeGen *g, IrExecutable *ex
 static LLVMValueRef ir_render_ptr_cast(CodeGen *g, IrExecutable *executable,
         IrInstructionPtrCastGen *instruction)
 {
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *wanted_type = instruction->base.value->type;
     if (!type_has_bits(wanted_type)) {
         return nullptr;
     }
@@ -3072,8 +3075,8 @@ static LLVMValueRef ir_render_ptr_cast(CodeGen *g, IrExecutable *executable,
 static LLVMValueRef ir_render_bit_cast(CodeGen *g, IrExecutable *executable,
         IrInstructionBitCastGen *instruction)
 {
-    ZigType *wanted_type = instruction->base.value.type;
-    ZigType *actual_type = instruction->operand->value.type;
+    ZigType *wanted_type = instruction->base.value->type;
+    ZigType *actual_type = instruction->operand->value->type;
     LLVMValueRef value = ir_llvm_value(g, instruction->operand);
 
     bool wanted_is_ptr = handle_is_ptr(wanted_type);
@@ -3096,7 +3099,7 @@ static LLVMValueRef ir_render_bit_cast(CodeGen *g, IrExecutable *executable,
 static LLVMValueRef ir_render_widen_or_shorten(CodeGen *g, IrExecutable *executable,
         IrInstructionWidenOrShorten *instruction)
 {
-    ZigType *actual_type = instruction->target->value.type;
+    ZigType *actual_type = instruction->target->value->type;
     // TODO instead of this logic, use the Noop instruction to change the type from
     // enum_tag to the underlying int type
     ZigType *int_type;
@@ -3107,11 +3110,11 @@ static LLVMValueRef ir_render_widen_or_shorten(CodeGen *g, IrExecutable *executa
     }
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     return gen_widen_or_shorten(g, ir_want_runtime_safety(g, &instruction->base), int_type,
-            instruction->base.value.type, target_val);
+            instruction->base.value->type, target_val);
 }
 
 static LLVMValueRef ir_render_int_to_ptr(CodeGen *g, IrExecutable *executable, IrInstructionIntToPtr *instruction) {
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *wanted_type = instruction->base.value->type;
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     if (!ptr_allows_addr_zero(wanted_type) && ir_want_runtime_safety(g, &instruction->base)) {
         LLVMValueRef zero = LLVMConstNull(LLVMTypeOf(target_val));
@@ -3129,19 +3132,19 @@ static LLVMValueRef ir_render_int_to_ptr(CodeGen *g, IrExecutable *executable, I
 }
 
 static LLVMValueRef ir_render_ptr_to_int(CodeGen *g, IrExecutable *executable, IrInstructionPtrToInt *instruction) {
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *wanted_type = instruction->base.value->type;
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     return LLVMBuildPtrToInt(g->builder, target_val, get_llvm_type(g, wanted_type), "");
 }
 
 static LLVMValueRef ir_render_int_to_enum(CodeGen *g, IrExecutable *executable, IrInstructionIntToEnum *instruction) {
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *wanted_type = instruction->base.value->type;
     assert(wanted_type->id == ZigTypeIdEnum);
     ZigType *tag_int_type = wanted_type->data.enumeration.tag_int_type;
 
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     LLVMValueRef tag_int_value = gen_widen_or_shorten(g, ir_want_runtime_safety(g, &instruction->base),
-            instruction->target->value.type, tag_int_type, target_val);
+            instruction->target->value->type, tag_int_type, target_val);
 
     if (ir_want_runtime_safety(g, &instruction->base)) {
         LLVMBasicBlockRef bad_value_block = LLVMAppendBasicBlock(g->cur_fn_val, "BadValue");
@@ -3162,10 +3165,10 @@ static LLVMValueRef ir_render_int_to_enum(CodeGen *g, IrExecutable *executable,
 }
 
 static LLVMValueRef ir_render_int_to_err(CodeGen *g, IrExecutable *executable, IrInstructionIntToErr *instruction) {
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *wanted_type = instruction->base.value->type;
     assert(wanted_type->id == ZigTypeIdErrorSet);
 
-    ZigType *actual_type = instruction->target->value.type;
+    ZigType *actual_type = instruction->target->value->type;
     assert(actual_type->id == ZigTypeIdInt);
     assert(!actual_type->data.integral.is_signed);
 
@@ -3179,11 +3182,11 @@ static LLVMValueRef ir_render_int_to_err(CodeGen *g, IrExecutable *executable, I
 }
 
 static LLVMValueRef ir_render_err_to_int(CodeGen *g, IrExecutable *executable, IrInstructionErrToInt *instruction) {
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *wanted_type = instruction->base.value->type;
     assert(wanted_type->id == ZigTypeIdInt);
     assert(!wanted_type->data.integral.is_signed);
 
-    ZigType *actual_type = instruction->target->value.type;
+    ZigType *actual_type = instruction->target->value->type;
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
 
     if (actual_type->id == ZigTypeIdErrorSet) {
@@ -3233,7 +3236,7 @@ static LLVMValueRef ir_render_br(CodeGen *g, IrExecutable *executable, IrInstruc
 static LLVMValueRef ir_render_un_op(CodeGen *g, IrExecutable *executable, IrInstructionUnOp *un_op_instruction) {
     IrUnOp op_id = un_op_instruction->op_id;
     LLVMValueRef expr = ir_llvm_value(g, un_op_instruction->value);
-    ZigType *operand_type = un_op_instruction->value->value.type;
+    ZigType *operand_type = un_op_instruction->value->value->type;
     ZigType *scalar_type = (operand_type->id == ZigTypeIdVector) ? operand_type->data.vector.elem_type : operand_type;
 
     switch (op_id) {
@@ -3288,12 +3291,12 @@ static LLVMValueRef ir_render_decl_var(CodeGen *g, IrExecutable *executable, IrI
 
 static LLVMValueRef ir_render_extractinsert(CodeGen *g, IrExecutable *executable, IrInstructionExtractInsert *instruction) {
     assert(instruction->index);
-    ZigType *child_type = instruction->base.value.type;
+    ZigType *child_type = instruction->base.value->type;
     if (!type_has_bits(child_type))
         return nullptr;
     
     LLVMValueRef agg = ir_llvm_value(g, instruction->agg);
-    ZigType *agg_type = instruction->agg->value.type;
+    ZigType *agg_type = instruction->agg->value->type;
     assert(agg_type->id == ZigTypeIdVector && "Arrays not yet implemented");
 
     // As vector indices are constant there is no dynamic safety checks needed.
@@ -3305,12 +3308,12 @@ static LLVMValueRef ir_render_extractinsert(CodeGen *g, IrExecutable *executable
 }
 
 static LLVMValueRef ir_render_load(CodeGen *g, IrExecutable *executable, IrInstructionLoadPtrGen *instruction) {
-    ZigType *child_type = instruction->base.value.type;
+    ZigType *child_type = instruction->base.value->type;
     if (!type_has_bits(child_type))
         return nullptr;
 
     LLVMValueRef ptr = ir_llvm_value(g, instruction->ptr);
-    ZigType *ptr_type = instruction->ptr->value.type;
+    ZigType *ptr_type = instruction->ptr->value->type;
     assert(ptr_type->id == ZigTypeIdPointer);
 
     uint32_t host_int_bytes = ptr_type->data.pointer.host_int_bytes;
@@ -3488,18 +3491,18 @@ static void gen_undef_init(CodeGen *g, uint32_t ptr_align_bytes, ZigType *value_
 }
 
 static LLVMValueRef ir_render_store(CodeGen *g, IrExecutable *executable, IrInstructionStore *instruction) {
-    ZigType *ptr_type = instruction->ptr->value.type;
+    ZigType *ptr_type = instruction->ptr->value->type;
     assert(ptr_type->id == ZigTypeIdPointer);
     if (!type_has_bits(ptr_type))
         return nullptr;
 
-    bool have_init_expr = !value_is_all_undef(&instruction->value->value);
+    bool have_init_expr = !value_is_all_undef(instruction->value->value);
     if (have_init_expr) {
         LLVMValueRef ptr = ir_llvm_value(g, instruction->ptr);
         LLVMValueRef value = ir_llvm_value(g, instruction->value);
         gen_assign_raw(g, ptr, ptr_type, value);
     } else if (ir_want_runtime_safety(g, &instruction->base)) {
-        gen_undef_init(g, get_ptr_align(g, ptr_type), instruction->value->value.type,
+        gen_undef_init(g, get_ptr_align(g, ptr_type), instruction->value->value->type,
             ir_llvm_value(g, instruction->ptr));
     }
     return nullptr;
@@ -3518,14 +3521,14 @@ static LLVMValueRef ir_render_var_ptr(CodeGen *g, IrExecutable *executable, IrIn
 static LLVMValueRef ir_render_return_ptr(CodeGen *g, IrExecutable *executable,
         IrInstructionReturnPtr *instruction)
 {
-    src_assert(g->cur_ret_ptr != nullptr || !type_has_bits(instruction->base.value.type),
+    src_assert(g->cur_ret_ptr != nullptr || !type_has_bits(instruction->base.value->type),
             instruction->base.source_node);
     return g->cur_ret_ptr;
 }
 
 static LLVMValueRef ir_render_elem(CodeGen *g, IrExecutable *executable, IrInstructionElem *instruction) {
     LLVMValueRef array_ptr_ptr = ir_llvm_value(g, instruction->array_ptr);
-    ZigType *array_ptr_type = instruction->array_ptr->value.type;
+    ZigType *array_ptr_type = instruction->array_ptr->value->type;
     if (array_ptr_type->id != ZigTypeIdPointer)
         return ir_llvm_value(g, instruction->array_ptr);
     ZigType *array_type = array_ptr_type->data.pointer.child_type;
@@ -3557,7 +3560,7 @@ static LLVMValueRef ir_render_elem(CodeGen *g, IrExecutable *executable, IrInstr
         if (child_type->id == ZigTypeIdStruct &&
             child_type->data.structure.layout == ContainerLayoutPacked)
         {
-            ZigType *ptr_type = instruction->base.value.type;
+            ZigType *ptr_type = instruction->base.value->type;
             size_t host_int_bytes = ptr_type->data.pointer.host_int_bytes;
             if (host_int_bytes != 0) {
                 uint32_t size_in_bits = type_size_bits(g, ptr_type->data.pointer.child_type);
@@ -3588,7 +3591,7 @@ static LLVMValueRef ir_render_elem(CodeGen *g, IrExecutable *executable, IrInstr
     } else if (array_type->id == ZigTypeIdStruct) {
         assert(array_type->data.structure.is_slice);
 
-        ZigType *ptr_type = instruction->base.value.type;
+        ZigType *ptr_type = instruction->base.value->type;
         if (!type_has_bits(ptr_type)) {
             if (safety_check_on) {
                 assert(LLVMGetTypeKind(LLVMTypeOf(array_ptr)) == LLVMIntegerTypeKind);
@@ -3684,7 +3687,7 @@ static LLVMValueRef ir_render_call(CodeGen *g, IrExecutable *executable, IrInstr
     } else {
         assert(instruction->fn_ref);
         fn_val = ir_llvm_value(g, instruction->fn_ref);
-        fn_type = instruction->fn_ref->value.type;
+        fn_type = instruction->fn_ref->value->type;
     }
 
     FnTypeId *fn_type_id = &fn_type->data.fn.fn_type_id;
@@ -3765,7 +3768,7 @@ static LLVMValueRef ir_render_call(CodeGen *g, IrExecutable *executable, IrInstr
         return result_loc;
     } else if (handle_is_ptr(src_return_type)) {
         LLVMValueRef store_instr = LLVMBuildStore(g->builder, result, result_loc);
-        LLVMSetAlignment(store_instr, get_ptr_align(g, instruction->result_loc->value.type));
+        LLVMSetAlignment(store_instr, get_ptr_align(g, instruction->result_loc->value->type));
         return result_loc;
     } else {
         return result;
@@ -3775,12 +3778,12 @@ static LLVMValueRef ir_render_call(CodeGen *g, IrExecutable *executable, IrInstr
 static LLVMValueRef ir_render_struct_field_ptr(CodeGen *g, IrExecutable *executable,
     IrInstructionStructFieldPtr *instruction)
 {
-    if (instruction->base.value.special != ConstValSpecialRuntime)
+    if (instruction->base.value->special != ConstValSpecialRuntime)
         return nullptr;
 
     LLVMValueRef struct_ptr = ir_llvm_value(g, instruction->struct_ptr);
     // not necessarily a pointer. could be ZigTypeIdStruct
-    ZigType *struct_ptr_type = instruction->struct_ptr->value.type;
+    ZigType *struct_ptr_type = instruction->struct_ptr->value->type;
     TypeStructField *field = instruction->field;
 
     if (!type_has_bits(field->type_entry))
@@ -3799,10 +3802,10 @@ static LLVMValueRef ir_render_struct_field_ptr(CodeGen *g, IrExecutable *executa
 static LLVMValueRef ir_render_union_field_ptr(CodeGen *g, IrExecutable *executable,
     IrInstructionUnionFieldPtr *instruction)
 {
-    if (instruction->base.value.special != ConstValSpecialRuntime)
+    if (instruction->base.value->special != ConstValSpecialRuntime)
         return nullptr;
 
-    ZigType *union_ptr_type = instruction->union_ptr->value.type;
+    ZigType *union_ptr_type = instruction->union_ptr->value->type;
     assert(union_ptr_type->id == ZigTypeIdPointer);
     ZigType *union_type = union_ptr_type->data.pointer.child_type;
     assert(union_type->id == ZigTypeIdUnion);
@@ -3972,7 +3975,7 @@ static LLVMValueRef ir_render_asm(CodeGen *g, IrExecutable *executable, IrInstru
             buf_append_char(&constraint_buf, ',');
         }
 
-        ZigType *const type = ir_input->value.type;
+        ZigType *const type = ir_input->value->type;
         LLVMTypeRef type_ref = get_llvm_type(g, type);
         LLVMValueRef value_ref = ir_llvm_value(g, ir_input);
         // Handle integers of non pot bitsize by widening them.
@@ -4002,7 +4005,7 @@ static LLVMValueRef ir_render_asm(CodeGen *g, IrExecutable *executable, IrInstru
     if (instruction->return_count == 0) {
         ret_type = LLVMVoidType();
     } else {
-        ret_type = get_llvm_type(g, instruction->base.value.type);
+        ret_type = get_llvm_type(g, instruction->base.value->type);
     }
     LLVMTypeRef function_type = LLVMFunctionType(ret_type, param_types, (unsigned)input_and_output_count, false);
 
@@ -4032,16 +4035,16 @@ static LLVMValueRef gen_non_null_bit(CodeGen *g, ZigType *maybe_type, LLVMValueR
 static LLVMValueRef ir_render_test_non_null(CodeGen *g, IrExecutable *executable,
     IrInstructionTestNonNull *instruction)
 {
-    return gen_non_null_bit(g, instruction->value->value.type, ir_llvm_value(g, instruction->value));
+    return gen_non_null_bit(g, instruction->value->value->type, ir_llvm_value(g, instruction->value));
 }
 
 static LLVMValueRef ir_render_optional_unwrap_ptr(CodeGen *g, IrExecutable *executable,
         IrInstructionOptionalUnwrapPtr *instruction)
 {
-    if (instruction->base.value.special != ConstValSpecialRuntime)
+    if (instruction->base.value->special != ConstValSpecialRuntime)
         return nullptr;
 
-    ZigType *ptr_type = instruction->base_ptr->value.type;
+    ZigType *ptr_type = instruction->base_ptr->value->type;
     assert(ptr_type->id == ZigTypeIdPointer);
     ZigType *maybe_type = ptr_type->data.pointer.child_type;
     assert(maybe_type->id == ZigTypeIdOptional);
@@ -4141,7 +4144,7 @@ static LLVMValueRef get_int_builtin_fn(CodeGen *g, ZigType *expr_type, BuiltinFn
 }
 
 static LLVMValueRef ir_render_clz(CodeGen *g, IrExecutable *executable, IrInstructionClz *instruction) {
-    ZigType *int_type = instruction->op->value.type;
+    ZigType *int_type = instruction->op->value->type;
     LLVMValueRef fn_val = get_int_builtin_fn(g, int_type, BuiltinFnIdClz);
     LLVMValueRef operand = ir_llvm_value(g, instruction->op);
     LLVMValueRef params[] {
@@ -4149,11 +4152,11 @@ static LLVMValueRef ir_render_clz(CodeGen *g, IrExecutable *executable, IrInstru
         LLVMConstNull(LLVMInt1Type()),
     };
     LLVMValueRef wrong_size_int = LLVMBuildCall(g->builder, fn_val, params, 2, "");
-    return gen_widen_or_shorten(g, false, int_type, instruction->base.value.type, wrong_size_int);
+    return gen_widen_or_shorten(g, false, int_type, instruction->base.value->type, wrong_size_int);
 }
 
 static LLVMValueRef ir_render_ctz(CodeGen *g, IrExecutable *executable, IrInstructionCtz *instruction) {
-    ZigType *int_type = instruction->op->value.type;
+    ZigType *int_type = instruction->op->value->type;
     LLVMValueRef fn_val = get_int_builtin_fn(g, int_type, BuiltinFnIdCtz);
     LLVMValueRef operand = ir_llvm_value(g, instruction->op);
     LLVMValueRef params[] {
@@ -4161,12 +4164,12 @@ static LLVMValueRef ir_render_ctz(CodeGen *g, IrExecutable *executable, IrInstru
         LLVMConstNull(LLVMInt1Type()),
     };
     LLVMValueRef wrong_size_int = LLVMBuildCall(g->builder, fn_val, params, 2, "");
-    return gen_widen_or_shorten(g, false, int_type, instruction->base.value.type, wrong_size_int);
+    return gen_widen_or_shorten(g, false, int_type, instruction->base.value->type, wrong_size_int);
 }
 
 static LLVMValueRef ir_render_shuffle_vector(CodeGen *g, IrExecutable *executable, IrInstructionShuffleVector *instruction) {
-    uint64_t len_a = instruction->a->value.type->data.vector.len;
-    uint64_t len_c = instruction->mask->value.type->data.vector.len;
+    uint64_t len_a = instruction->a->value->type->data.vector.len;
+    uint64_t len_c = instruction->mask->value->type->data.vector.len;
 
     // LLVM uses integers larger than the length of the first array to
     // index into the second array. This was deemed unnecessarily fragile
@@ -4176,10 +4179,10 @@ static LLVMValueRef ir_render_shuffle_vector(CodeGen *g, IrExecutable *executabl
     IrInstruction *mask = instruction->mask;
     LLVMValueRef *values = allocate<LLVMValueRef>(len_c);
     for (uint64_t i = 0;i < len_c;i++) {
-        if (mask->value.data.x_array.data.s_none.elements[i].special == ConstValSpecialUndef) {
+        if (mask->value->data.x_array.data.s_none.elements[i].special == ConstValSpecialUndef) {
             values[i] = LLVMGetUndef(LLVMInt32Type());
         } else {
-            int64_t v = bigint_as_signed(&mask->value.data.x_array.data.s_none.elements[i].data.x_bigint);
+            int64_t v = bigint_as_signed(&mask->value->data.x_array.data.s_none.elements[i].data.x_bigint);
             if (v < 0)
                 v = (uint32_t)~v + (uint32_t)len_a;
             values[i] = LLVMConstInt(LLVMInt32Type(), v, false);
@@ -4194,8 +4197,8 @@ static LLVMValueRef ir_render_shuffle_vector(CodeGen *g, IrExecutable *executabl
 }
 
 static LLVMValueRef ir_render_splat(CodeGen *g, IrExecutable *executable, IrInstructionSplat *instruction) {
-    uint64_t len = bigint_as_unsigned(&instruction->len->value.data.x_bigint);
-    LLVMValueRef wrapped_scalar_undef = LLVMGetUndef(instruction->base.value.type->llvm_type);
+    uint64_t len = bigint_as_unsigned(&instruction->len->value->data.x_bigint);
+    LLVMValueRef wrapped_scalar_undef = LLVMGetUndef(instruction->base.value->type->llvm_type);
     LLVMValueRef wrapped_scalar = LLVMBuildInsertElement(g->builder, wrapped_scalar_undef,
         ir_llvm_value(g, instruction->scalar),
         LLVMConstInt(LLVMInt32Type(), 0, false),
@@ -4208,11 +4211,11 @@ static LLVMValueRef ir_render_splat(CodeGen *g, IrExecutable *executable, IrInst
 }
 
 static LLVMValueRef ir_render_pop_count(CodeGen *g, IrExecutable *executable, IrInstructionPopCount *instruction) {
-    ZigType *int_type = instruction->op->value.type;
+    ZigType *int_type = instruction->op->value->type;
     LLVMValueRef fn_val = get_int_builtin_fn(g, int_type, BuiltinFnIdPopCount);
     LLVMValueRef operand = ir_llvm_value(g, instruction->op);
     LLVMValueRef wrong_size_int = LLVMBuildCall(g->builder, fn_val, &operand, 1, "");
-    return gen_widen_or_shorten(g, false, int_type, instruction->base.value.type, wrong_size_int);
+    return gen_widen_or_shorten(g, false, int_type, instruction->base.value->type, wrong_size_int);
 }
 
 static LLVMValueRef ir_render_switch_br(CodeGen *g, IrExecutable *executable, IrInstructionSwitchBr *instruction) {
@@ -4228,14 +4231,14 @@ static LLVMValueRef ir_render_switch_br(CodeGen *g, IrExecutable *executable, Ir
 }
 
 static LLVMValueRef ir_render_phi(CodeGen *g, IrExecutable *executable, IrInstructionPhi *instruction) {
-    if (!type_has_bits(instruction->base.value.type))
+    if (!type_has_bits(instruction->base.value->type))
         return nullptr;
 
     LLVMTypeRef phi_type;
-    if (handle_is_ptr(instruction->base.value.type)) {
-        phi_type = LLVMPointerType(get_llvm_type(g,instruction->base.value.type), 0);
+    if (handle_is_ptr(instruction->base.value->type)) {
+        phi_type = LLVMPointerType(get_llvm_type(g,instruction->base.value->type), 0);
     } else {
-        phi_type = get_llvm_type(g, instruction->base.value.type);
+        phi_type = get_llvm_type(g, instruction->base.value->type);
     }
 
     LLVMValueRef phi = LLVMBuildPhi(g->builder, phi_type, "");
@@ -4250,11 +4253,11 @@ static LLVMValueRef ir_render_phi(CodeGen *g, IrExecutable *executable, IrInstru
 }
 
 static LLVMValueRef ir_render_ref(CodeGen *g, IrExecutable *executable, IrInstructionRefGen *instruction) {
-    if (!type_has_bits(instruction->base.value.type)) {
+    if (!type_has_bits(instruction->base.value->type)) {
         return nullptr;
     }
     LLVMValueRef value = ir_llvm_value(g, instruction->operand);
-    if (handle_is_ptr(instruction->operand->value.type)) {
+    if (handle_is_ptr(instruction->operand->value->type)) {
         return value;
     } else {
         LLVMValueRef result_loc = ir_llvm_value(g, instruction->result_loc);
@@ -4386,7 +4389,7 @@ static LLVMValueRef get_enum_tag_name_function(CodeGen *g, ZigType *enum_type) {
 static LLVMValueRef ir_render_enum_tag_name(CodeGen *g, IrExecutable *executable,
         IrInstructionTagName *instruction)
 {
-    ZigType *enum_type = instruction->target->value.type;
+    ZigType *enum_type = instruction->target->value->type;
     assert(enum_type->id == ZigTypeIdEnum);
 
     LLVMValueRef enum_name_function = get_enum_tag_name_function(g, enum_type);
@@ -4399,7 +4402,7 @@ static LLVMValueRef ir_render_enum_tag_name(CodeGen *g, IrExecutable *executable
 static LLVMValueRef ir_render_field_parent_ptr(CodeGen *g, IrExecutable *executable,
         IrInstructionFieldParentPtr *instruction)
 {
-    ZigType *container_ptr_type = instruction->base.value.type;
+    ZigType *container_ptr_type = instruction->base.value->type;
     assert(container_ptr_type->id == ZigTypeIdPointer);
 
     ZigType *container_type = container_ptr_type->data.pointer.child_type;
@@ -4432,7 +4435,7 @@ static LLVMValueRef ir_render_align_cast(CodeGen *g, IrExecutable *executable, I
         return target_val;
     }
 
-    ZigType *target_type = instruction->base.value.type;
+    ZigType *target_type = instruction->base.value->type;
     uint32_t align_bytes;
     LLVMValueRef ptr_val;
 
@@ -4553,7 +4556,7 @@ static LLVMValueRef ir_render_cmpxchg(CodeGen *g, IrExecutable *executable, IrIn
     LLVMValueRef result_val = ZigLLVMBuildCmpXchg(g->builder, ptr_val, cmp_val, new_val,
             success_order, failure_order, instruction->is_weak);
 
-    ZigType *optional_type = instruction->base.value.type;
+    ZigType *optional_type = instruction->base.value->type;
     assert(optional_type->id == ZigTypeIdOptional);
     ZigType *child_type = optional_type->data.maybe.child_type;
 
@@ -4585,8 +4588,8 @@ static LLVMValueRef ir_render_fence(CodeGen *g, IrExecutable *executable, IrInst
 
 static LLVMValueRef ir_render_truncate(CodeGen *g, IrExecutable *executable, IrInstructionTruncate *instruction) {
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
-    ZigType *dest_type = instruction->base.value.type;
-    ZigType *src_type = instruction->target->value.type;
+    ZigType *dest_type = instruction->base.value->type;
+    ZigType *src_type = instruction->target->value->type;
     if (dest_type == src_type) {
         // no-op
         return target_val;
@@ -4605,10 +4608,10 @@ static LLVMValueRef ir_render_memset(CodeGen *g, IrExecutable *executable, IrIns
     LLVMTypeRef ptr_u8 = LLVMPointerType(LLVMInt8Type(), 0);
     LLVMValueRef dest_ptr_casted = LLVMBuildBitCast(g->builder, dest_ptr, ptr_u8, "");
 
-    ZigType *ptr_type = instruction->dest_ptr->value.type;
+    ZigType *ptr_type = instruction->dest_ptr->value->type;
     assert(ptr_type->id == ZigTypeIdPointer);
 
-    bool val_is_undef = value_is_all_undef(&instruction->byte->value);
+    bool val_is_undef = value_is_all_undef(instruction->byte->value);
     LLVMValueRef fill_char;
     if (val_is_undef) {
         fill_char = LLVMConstInt(LLVMInt8Type(), 0xaa, false);
@@ -4634,8 +4637,8 @@ static LLVMValueRef ir_render_memcpy(CodeGen *g, IrExecutable *executable, IrIns
     LLVMValueRef dest_ptr_casted = LLVMBuildBitCast(g->builder, dest_ptr, ptr_u8, "");
     LLVMValueRef src_ptr_casted = LLVMBuildBitCast(g->builder, src_ptr, ptr_u8, "");
 
-    ZigType *dest_ptr_type = instruction->dest_ptr->value.type;
-    ZigType *src_ptr_type = instruction->src_ptr->value.type;
+    ZigType *dest_ptr_type = instruction->dest_ptr->value->type;
+    ZigType *src_ptr_type = instruction->src_ptr->value->type;
 
     assert(dest_ptr_type->id == ZigTypeIdPointer);
     assert(src_ptr_type->id == ZigTypeIdPointer);
@@ -4648,7 +4651,7 @@ static LLVMValueRef ir_render_memcpy(CodeGen *g, IrExecutable *executable, IrIns
 
 static LLVMValueRef ir_render_slice(CodeGen *g, IrExecutable *executable, IrInstructionSliceGen *instruction) {
     LLVMValueRef array_ptr_ptr = ir_llvm_value(g, instruction->ptr);
-    ZigType *array_ptr_type = instruction->ptr->value.type;
+    ZigType *array_ptr_type = instruction->ptr->value->type;
     assert(array_ptr_type->id == ZigTypeIdPointer);
     ZigType *array_type = array_ptr_type->data.pointer.child_type;
     LLVMValueRef array_ptr = get_handle_value(g, array_ptr_ptr, array_type, array_ptr_type);
@@ -4671,7 +4674,7 @@ static LLVMValueRef ir_render_slice(CodeGen *g, IrExecutable *executable, IrInst
             end_val = LLVMConstInt(g->builtin_types.entry_usize->llvm_type, array_type->data.array.len, false);
         }
         if (want_runtime_safety) {
-            if (instruction->start->value.special == ConstValSpecialRuntime || instruction->end) {
+            if (instruction->start->value->special == ConstValSpecialRuntime || instruction->end) {
                 add_bounds_check(g, start_val, LLVMIntEQ, nullptr, LLVMIntULE, end_val);
             }
             if (instruction->end) {
@@ -4713,13 +4716,13 @@ static LLVMValueRef ir_render_slice(CodeGen *g, IrExecutable *executable, IrInst
         }
 
         if (type_has_bits(array_type)) {
-            size_t gen_ptr_index = instruction->base.value.type->data.structure.fields[slice_ptr_index].gen_index;
+            size_t gen_ptr_index = instruction->base.value->type->data.structure.fields[slice_ptr_index].gen_index;
             LLVMValueRef ptr_field_ptr = LLVMBuildStructGEP(g->builder, tmp_struct_ptr, gen_ptr_index, "");
             LLVMValueRef slice_start_ptr = LLVMBuildInBoundsGEP(g->builder, array_ptr, &start_val, 1, "");
             gen_store_untyped(g, slice_start_ptr, ptr_field_ptr, 0, false);
         }
 
-        size_t gen_len_index = instruction->base.value.type->data.structure.fields[slice_len_index].gen_index;
+        size_t gen_len_index = instruction->base.value->type->data.structure.fields[slice_len_index].gen_index;
         LLVMValueRef len_field_ptr = LLVMBuildStructGEP(g->builder, tmp_struct_ptr, gen_len_index, "");
         LLVMValueRef len_value = LLVMBuildNSWSub(g->builder, end_val, start_val, "");
         gen_store_untyped(g, len_value, len_field_ptr, 0, false);
@@ -4849,8 +4852,8 @@ static LLVMValueRef render_shl_with_overflow(CodeGen *g, IrInstructionOverflowOp
     LLVMValueRef op2 = ir_llvm_value(g, instruction->op2);
     LLVMValueRef ptr_result = ir_llvm_value(g, instruction->result_ptr);
 
-    LLVMValueRef op2_casted = gen_widen_or_shorten(g, false, instruction->op2->value.type,
-            instruction->op1->value.type, op2);
+    LLVMValueRef op2_casted = gen_widen_or_shorten(g, false, instruction->op2->value->type,
+            instruction->op1->value->type, op2);
 
     LLVMValueRef result = LLVMBuildShl(g->builder, op1, op2_casted, "");
     LLVMValueRef orig_val;
@@ -4861,7 +4864,7 @@ static LLVMValueRef render_shl_with_overflow(CodeGen *g, IrInstructionOverflowOp
     }
     LLVMValueRef overflow_bit = LLVMBuildICmp(g->builder, LLVMIntNE, op1, orig_val, "");
 
-    gen_store(g, result, ptr_result, instruction->result_ptr->value.type);
+    gen_store(g, result, ptr_result, instruction->result_ptr->value->type);
 
     return overflow_bit;
 }
@@ -4899,13 +4902,13 @@ static LLVMValueRef ir_render_overflow_op(CodeGen *g, IrExecutable *executable,
     LLVMValueRef result_struct = LLVMBuildCall(g->builder, fn_val, params, 2, "");
     LLVMValueRef result = LLVMBuildExtractValue(g->builder, result_struct, 0, "");
     LLVMValueRef overflow_bit = LLVMBuildExtractValue(g->builder, result_struct, 1, "");
-    gen_store(g, result, ptr_result, instruction->result_ptr->value.type);
+    gen_store(g, result, ptr_result, instruction->result_ptr->value->type);
 
     return overflow_bit;
 }
 
 static LLVMValueRef ir_render_test_err(CodeGen *g, IrExecutable *executable, IrInstructionTestErrGen *instruction) {
-    ZigType *err_union_type = instruction->err_union->value.type;
+    ZigType *err_union_type = instruction->err_union->value->type;
     ZigType *payload_type = err_union_type->data.error_union.payload_type;
     LLVMValueRef err_union_handle = ir_llvm_value(g, instruction->err_union);
 
@@ -4924,10 +4927,10 @@ static LLVMValueRef ir_render_test_err(CodeGen *g, IrExecutable *executable, IrI
 static LLVMValueRef ir_render_unwrap_err_code(CodeGen *g, IrExecutable *executable,
         IrInstructionUnwrapErrCode *instruction)
 {
-    if (instruction->base.value.special != ConstValSpecialRuntime)
+    if (instruction->base.value->special != ConstValSpecialRuntime)
         return nullptr;
 
-    ZigType *ptr_type = instruction->err_union_ptr->value.type;
+    ZigType *ptr_type = instruction->err_union_ptr->value->type;
     assert(ptr_type->id == ZigTypeIdPointer);
     ZigType *err_union_type = ptr_type->data.pointer.child_type;
     ZigType *payload_type = err_union_type->data.error_union.payload_type;
@@ -4944,14 +4947,14 @@ static LLVMValueRef ir_render_unwrap_err_code(CodeGen *g, IrExecutable *executab
 static LLVMValueRef ir_render_unwrap_err_payload(CodeGen *g, IrExecutable *executable,
         IrInstructionUnwrapErrPayload *instruction)
 {
-    if (instruction->base.value.special != ConstValSpecialRuntime)
+    if (instruction->base.value->special != ConstValSpecialRuntime)
         return nullptr;
 
     bool want_safety = instruction->safety_check_on && ir_want_runtime_safety(g, &instruction->base) &&
         g->errors_by_index.length > 1;
-    if (!want_safety && !type_has_bits(instruction->base.value.type))
+    if (!want_safety && !type_has_bits(instruction->base.value->type))
         return nullptr;
-    ZigType *ptr_type = instruction->value->value.type;
+    ZigType *ptr_type = instruction->value->value->type;
     assert(ptr_type->id == ZigTypeIdPointer);
     ZigType *err_union_type = ptr_type->data.pointer.child_type;
     ZigType *payload_type = err_union_type->data.error_union.payload_type;
@@ -4995,7 +4998,7 @@ static LLVMValueRef ir_render_unwrap_err_payload(CodeGen *g, IrExecutable *execu
 }
 
 static LLVMValueRef ir_render_optional_wrap(CodeGen *g, IrExecutable *executable, IrInstructionOptionalWrap *instruction) {
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *wanted_type = instruction->base.value->type;
 
     assert(wanted_type->id == ZigTypeIdOptional);
 
@@ -5022,7 +5025,7 @@ static LLVMValueRef ir_render_optional_wrap(CodeGen *g, IrExecutable *executable
     LLVMValueRef result_loc = ir_llvm_value(g, instruction->result_loc);
 
     LLVMValueRef val_ptr = LLVMBuildStructGEP(g->builder, result_loc, maybe_child_index, "");
-    // child_type and instruction->value->value.type may differ by constness
+    // child_type and instruction->value->value->type may differ by constness
     gen_assign_raw(g, val_ptr, get_pointer_to_type(g, child_type, false), payload_val);
     LLVMValueRef maybe_ptr = LLVMBuildStructGEP(g->builder, result_loc, maybe_null_index, "");
     gen_store_untyped(g, LLVMConstAllOnes(LLVMInt1Type()), maybe_ptr, 0, false);
@@ -5031,7 +5034,7 @@ static LLVMValueRef ir_render_optional_wrap(CodeGen *g, IrExecutable *executable
 }
 
 static LLVMValueRef ir_render_err_wrap_code(CodeGen *g, IrExecutable *executable, IrInstructionErrWrapCode *instruction) {
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *wanted_type = instruction->base.value->type;
 
     assert(wanted_type->id == ZigTypeIdErrorUnion);
 
@@ -5051,7 +5054,7 @@ static LLVMValueRef ir_render_err_wrap_code(CodeGen *g, IrExecutable *executable
 }
 
 static LLVMValueRef ir_render_err_wrap_payload(CodeGen *g, IrExecutable *executable, IrInstructionErrWrapPayload *instruction) {
-    ZigType *wanted_type = instruction->base.value.type;
+    ZigType *wanted_type = instruction->base.value->type;
 
     assert(wanted_type->id == ZigTypeIdErrorUnion);
 
@@ -5082,7 +5085,7 @@ static LLVMValueRef ir_render_err_wrap_payload(CodeGen *g, IrExecutable *executa
 }
 
 static LLVMValueRef ir_render_union_tag(CodeGen *g, IrExecutable *executable, IrInstructionUnionTag *instruction) {
-    ZigType *union_type = instruction->value->value.type;
+    ZigType *union_type = instruction->value->value->type;
 
     ZigType *tag_type = union_type->data.unionation.tag_type;
     if (!type_has_bits(tag_type))
@@ -5206,7 +5209,7 @@ static LLVMValueRef ir_render_coro_promise(CodeGen *g, IrExecutable *executable,
         LLVMConstNull(LLVMInt1Type()),
     };
     LLVMValueRef uncasted_result = LLVMBuildCall(g->builder, get_coro_promise_fn_val(g), params, 3, "");
-    return LLVMBuildBitCast(g->builder, uncasted_result, get_llvm_type(g, instruction->base.value.type), "");
+    return LLVMBuildBitCast(g->builder, uncasted_result, get_llvm_type(g, instruction->base.value->type), "");
 }
 
 static LLVMValueRef get_coro_alloc_helper_fn_val(CodeGen *g, LLVMTypeRef alloc_fn_type_ref, ZigType *fn_type) {
@@ -5328,7 +5331,7 @@ static LLVMValueRef ir_render_coro_alloc_helper(CodeGen *g, IrExecutable *execut
 {
     LLVMValueRef realloc_fn = ir_llvm_value(g, instruction->realloc_fn);
     LLVMValueRef coro_size = ir_llvm_value(g, instruction->coro_size);
-    LLVMValueRef fn_val = get_coro_alloc_helper_fn_val(g, LLVMTypeOf(realloc_fn), instruction->realloc_fn->value.type);
+    LLVMValueRef fn_val = get_coro_alloc_helper_fn_val(g, LLVMTypeOf(realloc_fn), instruction->realloc_fn->value->type);
     size_t err_code_ptr_arg_index = get_async_err_code_arg_index(g, &g->cur_fn->type_entry->data.fn.fn_type_id);
     size_t allocator_arg_index = get_async_allocator_arg_index(g, &g->cur_fn->type_entry->data.fn.fn_type_id);
 
@@ -5350,7 +5353,7 @@ static LLVMValueRef ir_render_atomic_rmw(CodeGen *g, IrExecutable *executable,
         IrInstructionAtomicRmw *instruction)
 {
     bool is_signed;
-    ZigType *operand_type = instruction->operand->value.type;
+    ZigType *operand_type = instruction->operand->value->type;
     if (operand_type->id == ZigTypeIdInt) {
         is_signed = operand_type->data.integral.is_signed;
     } else {
@@ -5378,7 +5381,7 @@ static LLVMValueRef ir_render_atomic_load(CodeGen *g, IrExecutable *executable,
 {
     LLVMAtomicOrdering ordering = to_LLVMAtomicOrdering(instruction->resolved_ordering);
     LLVMValueRef ptr = ir_llvm_value(g, instruction->ptr);
-    LLVMValueRef load_inst = gen_load(g, ptr, instruction->ptr->value.type, "");
+    LLVMValueRef load_inst = gen_load(g, ptr, instruction->ptr->value->type, "");
     LLVMSetOrdering(load_inst, ordering);
     return load_inst;
 }
@@ -5406,8 +5409,8 @@ static LLVMValueRef ir_render_mark_err_ret_trace_ptr(CodeGen *g, IrExecutable *e
 
 static LLVMValueRef ir_render_float_op(CodeGen *g, IrExecutable *executable, IrInstructionFloatOp *instruction) {
     LLVMValueRef op = ir_llvm_value(g, instruction->op1);
-    assert(instruction->base.value.type->id == ZigTypeIdFloat);
-    LLVMValueRef fn_val = get_float_fn(g, instruction->base.value.type, ZigLLVMFnIdFloatOp, instruction->op);
+    assert(instruction->base.value->type->id == ZigTypeIdFloat);
+    LLVMValueRef fn_val = get_float_fn(g, instruction->base.value->type, ZigLLVMFnIdFloatOp, instruction->op);
     return LLVMBuildCall(g->builder, fn_val, &op, 1, "");
 }
 
@@ -5415,9 +5418,9 @@ static LLVMValueRef ir_render_mul_add(CodeGen *g, IrExecutable *executable, IrIn
     LLVMValueRef op1 = ir_llvm_value(g, instruction->op1);
     LLVMValueRef op2 = ir_llvm_value(g, instruction->op2);
     LLVMValueRef op3 = ir_llvm_value(g, instruction->op3);
-    assert(instruction->base.value.type->id == ZigTypeIdFloat ||
-           instruction->base.value.type->id == ZigTypeIdVector);
-    LLVMValueRef fn_val = get_float_fn(g, instruction->base.value.type, ZigLLVMFnIdFMA, BuiltinFnIdMulAdd);
+    assert(instruction->base.value->type->id == ZigTypeIdFloat ||
+           instruction->base.value->type->id == ZigTypeIdVector);
+    LLVMValueRef fn_val = get_float_fn(g, instruction->base.value->type, ZigLLVMFnIdFMA, BuiltinFnIdMulAdd);
     LLVMValueRef args[3] = {
         op1,
         op2,
@@ -5428,7 +5431,7 @@ static LLVMValueRef ir_render_mul_add(CodeGen *g, IrExecutable *executable, IrIn
 
 static LLVMValueRef ir_render_bswap(CodeGen *g, IrExecutable *executable, IrInstructionBswap *instruction) {
     LLVMValueRef op = ir_llvm_value(g, instruction->op);
-    ZigType *expr_type = instruction->base.value.type;
+    ZigType *expr_type = instruction->base.value->type;
     bool is_vector = expr_type->id == ZigTypeIdVector;
     ZigType *int_type = is_vector ? expr_type->data.vector.elem_type : expr_type;
     assert(int_type->id == ZigTypeIdInt);
@@ -5455,22 +5458,22 @@ static LLVMValueRef ir_render_bswap(CodeGen *g, IrExecutable *executable, IrInst
 
 static LLVMValueRef ir_render_bit_reverse(CodeGen *g, IrExecutable *executable, IrInstructionBitReverse *instruction) {
     LLVMValueRef op = ir_llvm_value(g, instruction->op);
-    ZigType *int_type = instruction->base.value.type;
+    ZigType *int_type = instruction->base.value->type;
     assert(int_type->id == ZigTypeIdInt);
-    LLVMValueRef fn_val = get_int_builtin_fn(g, instruction->base.value.type, BuiltinFnIdBitReverse);
+    LLVMValueRef fn_val = get_int_builtin_fn(g, instruction->base.value->type, BuiltinFnIdBitReverse);
     return LLVMBuildCall(g->builder, fn_val, &op, 1, "");
 }
 
 static LLVMValueRef ir_render_vector_to_array(CodeGen *g, IrExecutable *executable,
         IrInstructionVectorToArray *instruction)
 {
-    ZigType *array_type = instruction->base.value.type;
+    ZigType *array_type = instruction->base.value->type;
     assert(array_type->id == ZigTypeIdArray);
     assert(handle_is_ptr(array_type));
     LLVMValueRef result_loc = ir_llvm_value(g, instruction->result_loc);
     LLVMValueRef vector = ir_llvm_value(g, instruction->vector);
     LLVMValueRef array = LLVMGetUndef(get_llvm_type(g, array_type));
-    for (uintptr_t i = 0; i < instruction->vector->value.type->data.vector.len; i++) {
+    for (uintptr_t i = 0; i < instruction->vector->value->type->data.vector.len; i++) {
         LLVMValueRef index = LLVMConstInt(g->builtin_types.entry_u32->llvm_type, i, false);
         LLVMValueRef elem = LLVMBuildExtractElement(g->builder, vector,
             index, "vector_to_array");
@@ -5483,14 +5486,14 @@ static LLVMValueRef ir_render_vector_to_array(CodeGen *g, IrExecutable *executab
 static LLVMValueRef ir_render_array_to_vector(CodeGen *g, IrExecutable *executable,
         IrInstructionArrayToVector *instruction)
 {
-    ZigType *vector_type = instruction->base.value.type;
+    ZigType *vector_type = instruction->base.value->type;
     assert(vector_type->id == ZigTypeIdVector);
     assert(!handle_is_ptr(vector_type));
     LLVMValueRef array_ptr = ir_llvm_value(g, instruction->array);
-    LLVMValueRef array = LLVMBuildLoad2(g->builder, get_llvm_type(g, instruction->array->value.type),
+    LLVMValueRef array = LLVMBuildLoad2(g->builder, get_llvm_type(g, instruction->array->value->type),
         array_ptr, "");
     LLVMValueRef vector = LLVMGetUndef(get_llvm_type(g, vector_type));
-    for (uintptr_t i = 0; i < instruction->base.value.type->data.vector.len; i++) {
+    for (uintptr_t i = 0; i < instruction->base.value->type->data.vector.len; i++) {
         LLVMValueRef index = LLVMConstInt(g->builtin_types.entry_u32->llvm_type, i, false);
         LLVMValueRef elem = LLVMBuildExtractValue(g->builder, array,
             i, "vector_to_array");
@@ -5503,7 +5506,7 @@ static LLVMValueRef ir_render_assert_zero(CodeGen *g, IrExecutable *executable,
         IrInstructionAssertZero *instruction)
 {
     LLVMValueRef target = ir_llvm_value(g, instruction->target);
-    ZigType *int_type = instruction->target->value.type;
+    ZigType *int_type = instruction->target->value->type;
     if (ir_want_runtime_safety(g, &instruction->base)) {
         return gen_assert_zero(g, target, int_type);
     }
@@ -5514,7 +5517,7 @@ static LLVMValueRef ir_render_assert_non_null(CodeGen *g, IrExecutable *executab
         IrInstructionAssertNonNull *instruction)
 {
     LLVMValueRef target = ir_llvm_value(g, instruction->target);
-    ZigType *target_type = instruction->target->value.type;
+    ZigType *target_type = instruction->target->value->type;
 
     if (target_type->id == ZigTypeIdPointer) {
         assert(target_type->data.pointer.ptr_len == PtrLenC);
@@ -6899,15 +6902,15 @@ static void do_code_gen(CodeGen *g) {
         // allocate temporary stack data
         for (size_t alloca_i = 0; alloca_i < fn_table_entry->alloca_gen_list.length; alloca_i += 1) {
             IrInstructionAllocaGen *instruction = fn_table_entry->alloca_gen_list.at(alloca_i);
-            ZigType *ptr_type = instruction->base.value.type;
+            ZigType *ptr_type = instruction->base.value->type;
             assert(ptr_type->id == ZigTypeIdPointer);
             ZigType *child_type = ptr_type->data.pointer.child_type;
             if (!type_has_bits(child_type))
                 continue;
             if (instruction->base.ref_count == 0)
                 continue;
-            if (instruction->base.value.special != ConstValSpecialRuntime) {
-                if (const_ptr_pointee(nullptr, g, &instruction->base.value, nullptr)->special !=
+            if (instruction->base.value->special != ConstValSpecialRuntime) {
+                if (const_ptr_pointee(nullptr, g, instruction->base.value, nullptr)->special !=
                         ConstValSpecialRuntime)
                 {
                     continue;
@@ -7037,21 +7040,254 @@ static void do_code_gen(CodeGen *g) {
 #endif
 }
 
+// Where the program instrumented by -fprofile-generate writes its profile,
+// unless LLVM_PROFILE_FILE says otherwise. See std/special/profile_rt.zig.
+static Buf *get_profile_generate_file(CodeGen *g) {
+    assert(g->profile_generate);
+    Buf *basename = buf_create_from_str("default.profraw");
+    if (g->profile_generate_dir == nullptr)
+        return basename;
+    Buf *result = buf_alloc();
+    os_path_join(g->profile_generate_dir, basename, result);
+    return result;
+}
+
+static const char *get_pgo_instr_gen(CodeGen *g) {
+    return g->profile_generate ? buf_ptr(get_profile_generate_file(g)) : nullptr;
+}
+
+static const char *get_pgo_instr_use(CodeGen *g) {
+    return (g->profile_use_path != nullptr) ? buf_ptr(g->profile_use_path) : nullptr;
+}
+
+struct CodegenUnitJob {
+    LLVMMemoryBufferRef bitcode;
+    Buf *o_path;
+    char *err_msg;
+    bool reused;
+};
+
+struct CodegenUnitQueue {
+    CodeGen *g;
+    OsMutex *mutex;
+    // Signaled when a unit is added to jobs, when the split is done, and on failure.
+    OsCond *cond;
+    // When caching is enabled, units are stored here by the hash of their bitcode.
+    Buf *unit_cache_dir;
+    Buf *o_stem;
+    Buf *o_ext;
+    // Has room for g->codegen_units jobs; jobs_len grows as the split produces them.
+    CodegenUnitJob *jobs;
+    size_t jobs_len;
+    size_t next_job_index;
+    bool split_done;
+    bool any_failed;
+};
+
+// May be called from a worker thread. Each unit gets its own LLVMContext and
+// target machine; g is only read.
+static bool emit_codegen_unit(CodegenUnitQueue *queue, CodegenUnitJob *job) {
+    Error err;
+    CodeGen *g = queue->g;
+    bool is_small = g->build_mode == BuildModeSmallRelease;
+
+    // The bitcode of a unit holds every function in it along with the
+    // declarations it references, and the input parameter digest covers the
+    // target and build options. A unit whose functions did not change since
+    // a previous build therefore skips optimization and emission entirely.
+    // Instances of a generic function share a name that LLVM numbers in the
+    // order they were created, so an edit that adds an instance still changes
+    // the units that hold the ones created after it.
+    Buf *emit_path = job->o_path;
+    if (queue->unit_cache_dir != nullptr) {
+        Buf digest = BUF_INIT;
+        cache_mem_digest(&g->cache_hash, LLVMGetBufferStart(job->bitcode), LLVMGetBufferSize(job->bitcode),
+                &digest);
+        job->o_path = buf_sprintf("%s" OS_SEP "%s%s", buf_ptr(queue->unit_cache_dir), buf_ptr(&digest),
+                target_o_file_ext(g->zig_target));
+        // Touching the object both checks that it exists and marks it as
+        // recently used, so that cache_collect_dir keeps it.
+        if ((err = os_file_touch(job->o_path)) == ErrorNone) {
+            job->reused = true;
+            return true;
+        }
+        // Emit to a temporary file so a concurrent build never links a partial object.
+        emit_path = buf_alloc();
+        if ((err = get_tmp_filename(g, emit_path, &digest))) {
+            job->err_msg = strdup(err_str(err));
+            return false;
+        }
+    }
+
+    LLVMContextRef context = LLVMContextCreate();
+    LLVMModuleRef module;
+    if (LLVMParseBitcodeInContext2(context, job->bitcode, &module)) {
+        job->err_msg = strdup("unable to parse codegen unit bitcode");
+        LLVMContextDispose(context);
+        return false;
+    }
+    LLVMTargetMachineRef target_machine = ZigLLVMCloneTargetMachine(g->target_machine);
+    bool failed = ZigLLVMTargetMachineEmitToFile(target_machine, module, buf_ptr(emit_path),
+            ZigLLVM_EmitBinary, &job->err_msg, g->build_mode == BuildModeDebug, is_small, false,
+            get_pgo_instr_gen(g), get_pgo_instr_use(g));
+    LLVMDisposeTargetMachine(target_machine);
+    LLVMDisposeModule(module);
+    LLVMContextDispose(context);
+    if (failed)
+        return false;
+
+    if (emit_path != job->o_path && (err = os_rename(emit_path, job->o_path))) {
+        job->err_msg = strdup(err_str(err));
+        return false;
+    }
+    return true;
+}
+
+static void emit_codegen_units_worker(void *context) {
+    CodegenUnitQueue *queue = reinterpret_cast<CodegenUnitQueue *>(context);
+    for (;;) {
+        os_mutex_lock(queue->mutex);
+        while (!queue->any_failed && !queue->split_done && queue->next_job_index >= queue->jobs_len) {
+            os_cond_wait(queue->cond, queue->mutex);
+        }
+        if (queue->any_failed || queue->next_job_index >= queue->jobs_len) {
+            os_mutex_unlock(queue->mutex);
+            return;
+        }
+        CodegenUnitJob *job = &queue->jobs[queue->next_job_index];
+        queue->next_job_index += 1;
+        os_mutex_unlock(queue->mutex);
+
+        if (!emit_codegen_unit(queue, job)) {
+            os_mutex_lock(queue->mutex);
+            queue->any_failed = true;
+            os_cond_broadcast(queue->cond);
+            os_mutex_unlock(queue->mutex);
+        }
+    }
+}
+
+// Called on the main thread by ZigLLVMSplitModule as each unit is serialized.
+static void add_codegen_unit(void *context, LLVMMemoryBufferRef bitcode) {
+    CodegenUnitQueue *queue = reinterpret_cast<CodegenUnitQueue *>(context);
+    os_mutex_lock(queue->mutex);
+    size_t unit_i = queue->jobs_len;
+    assert(unit_i < queue->g->codegen_units);
+    queue->jobs[unit_i].bitcode = bitcode;
+    queue->jobs[unit_i].o_path = buf_sprintf("%s.%" ZIG_PRI_usize "%s",
+            buf_ptr(queue->o_stem), unit_i, buf_ptr(queue->o_ext));
+    queue->jobs_len += 1;
+    os_cond_broadcast(queue->cond);
+    os_mutex_unlock(queue->mutex);
+}
+
+// Splits g->module into g->codegen_units objects which are optimized and
+// emitted concurrently, then handed to the linker like any other object.
+// Optimizations that need to see the whole module, such as inlining across
+// units, are lost; that is the price of the parallelism.
+// No manifest refers to the unit objects, so nothing else ever removes them.
+// Once the directory holds more than unit_cache_max_entries objects, the least
+// recently used are deleted, except those used within unit_cache_min_age_sec,
+// which a concurrent build may be about to link.
+static const size_t unit_cache_max_entries = 4096;
+static const int64_t unit_cache_min_age_sec = 60 * 60;
+
+static void emit_codegen_units(CodeGen *g) {
+    Error err;
+
+    CodegenUnitQueue queue = {};
+    queue.g = g;
+    queue.mutex = os_mutex_create();
+    queue.cond = os_cond_create();
+    queue.jobs = allocate<CodegenUnitJob>(g->codegen_units);
+    // Only a module split by --codegen-units is cached per unit; with a single
+    // unit, the whole-build cache in check_cache already covers the object.
+    // A unit is reused by the digest of its bitcode, which does not cover the
+    // contents of the profile that optimizes it.
+    if (g->enable_cache && g->profile_use_path == nullptr) {
+        queue.unit_cache_dir = buf_sprintf("%s" OS_SEP CACHE_UNIT_SUBDIR, buf_ptr(g->cache_dir));
+        if ((err = os_make_path(queue.unit_cache_dir))) {
+            fprintf(stderr, "Unable to create cache directory %s: %s\n",
+                    buf_ptr(queue.unit_cache_dir), err_str(err));
+            exit(1);
+        }
+    }
+
+    Buf o_stem = BUF_INIT;
+    Buf o_ext = BUF_INIT;
+    os_path_extname(&g->o_file_output_path, &o_stem, &o_ext);
+    queue.o_stem = &o_stem;
+    queue.o_ext = &o_ext;
+
+    // The workers start before the split so that the first units are being
+    // optimized and emitted while the calling thread is still cloning and
+    // serializing the rest of the module. Once the split is done, the calling
+    // thread becomes one of the workers.
+    size_t job_count = (g->job_count == 0) ? os_cpu_count() : g->job_count;
+    size_t thread_count = (job_count < g->codegen_units) ? job_count : g->codegen_units;
+    ZigList<OsThread *> threads = {};
+    for (size_t thread_i = 1; thread_i < thread_count; thread_i += 1) {
+        OsThread *thread;
+        if ((err = os_thread_spawn(emit_codegen_units_worker, &queue, &thread))) {
+            // Not fatal; the threads we do have will drain the queue.
+            break;
+        }
+        threads.append(thread);
+    }
+
+    ZigLLVMSplitModule(g->module, g->codegen_units, add_codegen_unit, &queue);
+    os_mutex_lock(queue.mutex);
+    queue.split_done = true;
+    os_cond_broadcast(queue.cond);
+    os_mutex_unlock(queue.mutex);
+    validate_inline_fns(g);
+
+    emit_codegen_units_worker(&queue);
+    for (size_t thread_i = 0; thread_i < threads.length; thread_i += 1) {
+        os_thread_join(threads.at(thread_i));
+    }
+    threads.deinit();
+
+    for (size_t unit_i = 0; unit_i < queue.jobs_len; unit_i += 1) {
+        CodegenUnitJob *job = &queue.jobs[unit_i];
+        if (job->err_msg != nullptr) {
+            zig_panic("unable to write object file %s: %s", buf_ptr(job->o_path), job->err_msg);
+        }
+        LLVMDisposeMemoryBuffer(job->bitcode);
+        g->link_objects.append(job->o_path);
+        if (job->reused) {
+            g->codegen_units_reused += 1;
+        }
+    }
+    g->codegen_units_emitted = queue.jobs_len;
+
+    if (queue.unit_cache_dir != nullptr) {
+        cache_collect_dir(queue.unit_cache_dir, unit_cache_max_entries, unit_cache_min_age_sec);
+    }
+}
+
 static void zig_llvm_emit_output(CodeGen *g) {
     bool is_small = g->build_mode == BuildModeSmallRelease;
 
     Buf *output_path = &g->o_file_output_path;
     char *err_msg = nullptr;
+    // Set here, before any codegen unit thread starts.
+    ZigLLVMSetTimePasses(g->enable_time_report);
     switch (g->emit_file_type) {
         case EmitFileTypeBinary:
-            if (ZigLLVMTargetMachineEmitToFile(g->target_machine, g->module, buf_ptr(output_path),
-                        ZigLLVM_EmitBinary, &err_msg, g->build_mode == BuildModeDebug, is_small,
-                        g->enable_time_report))
-            {
-                zig_panic("unable to write object file %s: %s", buf_ptr(output_path), err_msg);
+            if (g->codegen_units > 1 && !g->thin_lto) {
+                emit_codegen_units(g);
+            } else {
+                ZigLLVM_EmitOutputType output_type = g->thin_lto ? ZigLLVM_EmitThinLTOBitcode : ZigLLVM_EmitBinary;
+                if (ZigLLVMTargetMachineEmitToFile(g->target_machine, g->module, buf_ptr(output_path),
+                            output_type, &err_msg, g->build_mode == BuildModeDebug, is_small,
+                            g->enable_time_report, get_pgo_instr_gen(g), get_pgo_instr_use(g)))
+                {
+                    zig_panic("unable to write object file %s: %s", buf_ptr(output_path), err_msg);
+                }
+                validate_inline_fns(g);
+                g->link_objects.append(output_path);
             }
-            validate_inline_fns(g);
-            g->link_objects.append(output_path);
             if (g->bundle_compiler_rt && (g->out_type == OutTypeObj ||
                 (g->out_type == OutTypeLib && !g->is_dynamic)))
             {
@@ -7062,7 +7298,7 @@ static void zig_llvm_emit_output(CodeGen *g) {
         case EmitFileTypeAssembly:
             if (ZigLLVMTargetMachineEmitToFile(g->target_machine, g->module, buf_ptr(output_path),
                         ZigLLVM_EmitAssembly, &err_msg, g->build_mode == BuildModeDebug, is_small,
-                        g->enable_time_report))
+                        g->enable_time_report, get_pgo_instr_gen(g), get_pgo_instr_use(g)))
             {
                 zig_panic("unable to write assembly file %s: %s", buf_ptr(output_path), err_msg);
             }
@@ -7072,7 +7308,7 @@ static void zig_llvm_emit_output(CodeGen *g) {
         case EmitFileTypeLLVMIr:
             if (ZigLLVMTargetMachineEmitToFile(g->target_machine, g->module, buf_ptr(output_path),
                         ZigLLVM_EmitLLVMIr, &err_msg, g->build_mode == BuildModeDebug, is_small,
-                        g->enable_time_report))
+                        g->enable_time_report, get_pgo_instr_gen(g), get_pgo_instr_use(g)))
             {
                 zig_panic("unable to write llvm-ir file %s: %s", buf_ptr(output_path), err_msg);
             }
@@ -7980,6 +8216,13 @@ Buf *codegen_generate_builtin_source(CodeGen *g) {
     buf_appendf(contents, "pub const valgrind_support = %s;\n", bool_to_str(want_valgrind_support(g)));
     buf_appendf(contents, "pub const position_independent_code = %s;\n", bool_to_str(g->have_pic));
     buf_appendf(contents, "pub const strip_debug_info = %s;\n", bool_to_str(g->strip_debug_symbols));
+    if (g->profile_generate) {
+        Buf escaped = BUF_INIT;
+        string_literal_escape(get_profile_generate_file(g), &escaped);
+        buf_appendf(contents, "pub const profile_generate_file: ?[]const u8 = \"%s\";\n", buf_ptr(&escaped));
+    } else {
+        buf_appendf(contents, "pub const profile_generate_file: ?[]const u8 = null;\n");
+    }
 
     {
         TargetSubsystem detected_subsystem = detect_subsystem(g);
@@ -8020,6 +8263,7 @@ static Error define_builtin_compile_vars(CodeGen *g) {
 
     CacheHash cache_hash;
     cache_init(&cache_hash, manifest_dir);
+    cache_hash.job_count = g->job_count;
 
     Buf *compiler_id;
     if ((err = get_compiler_id(&compiler_id)))
@@ -8210,12 +8454,12 @@ static void init(CodeGen *g) {
 
     IrInstruction *sentinel_instructions = allocate<IrInstruction>(2);
     g->invalid_instruction = &sentinel_instructions[0];
-    g->invalid_instruction->value.type = g->builtin_types.entry_invalid;
-    g->invalid_instruction->value.global_refs = allocate<ConstGlobalRefs>(1);
+    g->invalid_instruction->value = create_const_vals(1);
+    g->invalid_instruction->value->type = g->builtin_types.entry_invalid;
 
     g->unreach_instruction = &sentinel_instructions[1];
-    g->unreach_instruction->value.type = g->builtin_types.entry_unreachable;
-    g->unreach_instruction->value.global_refs = allocate<ConstGlobalRefs>(1);
+    g->unreach_instruction->value = create_const_vals(1);
+    g->unreach_instruction->value->type = g->builtin_types.entry_unreachable;
 
     g->const_void_val.special = ConstValSpecialStatic;
     g->const_void_val.type = g->builtin_types.entry_void;
@@ -8393,6 +8637,25 @@ void add_cc_args(CodeGen *g, ZigList<const char *> &args, const char *out_dep_pa
         args.append("-ffunction-sections");
     }
 
+    if (g->thin_lto && !translate_c) {
+        args.append("-flto=thin");
+    }
+
+    if (!translate_c && (g->profile_generate || g->profile_use_path != nullptr)) {
+        if (g->profile_generate) {
+            if (g->profile_generate_dir != nullptr) {
+                args.append(buf_ptr(buf_sprintf("-fprofile-generate=%s", buf_ptr(g->profile_generate_dir))));
+            } else {
+                args.append("-fprofile-generate");
+            }
+        } else {
+            args.append(buf_ptr(buf_sprintf("-fprofile-use=%s", buf_ptr(g->profile_use_path))));
+        }
+        // Match the Zig code, see main.cpp.
+        args.append("-mllvm");
+        args.append("-disable-vp");
+    }
+
     if (translate_c) {
         // this gives us access to preprocessing entities, presumably at
         // the cost of performance
@@ -8707,6 +8970,7 @@ static void gen_root_source(CodeGen *g) {
         fprintf(stderr, "unable to open '%s': %s\n", buf_ptr(resolved_path), err_str(err));
         exit(1);
     }
+    g->source_bytes_read += buf_len(source_code);
 
     ZigType *root_import_alias = add_source_file(g, g->root_package, resolved_path, source_code, SourceKindRoot);
     assert(root_import_alias == g->root_import);
@@ -8772,7 +9036,8 @@ static void print_zig_cc_cmd(ZigList<const char *> *args) {
 }
 
 // Caller should delete the file when done or rename it into a better location.
-static Error get_tmp_filename(CodeGen *g, Buf *out, Buf *suffix) {
+// Safe to call from several threads at once.
+Error get_tmp_filename(CodeGen *g, Buf *out, Buf *suffix) {
     Error err;
     buf_resize(out, 0);
     os_path_join(g->cache_dir, buf_create_from_str("tmp" OS_SEP), out);
@@ -8781,9 +9046,13 @@ static Error get_tmp_filename(CodeGen *g, Buf *out, Buf *suffix) {
     }
     const char base64[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_";
     assert(array_length(base64) == 64 + 1);
+    // rand() keeps shared state, and two threads that read the same state
+    // would pick the same name.
+    os_mutex_lock(g->tmp_filename_mutex);
     for (size_t i = 0; i < 12; i += 1) {
         buf_append_char(out, base64[rand() % 64]);
     }
+    os_mutex_unlock(g->tmp_filename_mutex);
     buf_append_char(out, '-');
     buf_append_buf(out, suffix);
     return ErrorNone;
@@ -8794,6 +9063,9 @@ Error create_c_object_cache(CodeGen *g, CacheHash **out_cache_hash, bool verbose
     CacheHash *cache_hash = allocate<CacheHash>(1);
     Buf *manifest_dir = buf_sprintf("%s" OS_SEP CACHE_HASH_SUBDIR, buf_ptr(g->cache_dir));
     cache_init(cache_hash, manifest_dir);
+    // These are checked from a gen_c_objects worker, which is already one of
+    // -j threads; hashing on more threads would oversubscribe the machine.
+    cache_hash->job_count = 1;
 
     Buf *compiler_id;
     if ((err = get_compiler_id(&compiler_id))) {
@@ -8817,6 +9089,12 @@ Error create_c_object_cache(CodeGen *g, CacheHash **out_cache_hash, bool verbose
     cache_bool(cache_hash, g->have_pic);
     cache_bool(cache_hash, want_valgrind_support(g));
     cache_bool(cache_hash, g->function_sections);
+    cache_bool(cache_hash, g->thin_lto);
+    cache_bool(cache_hash, g->profile_generate);
+    cache_buf_opt(cache_hash, g->profile_generate_dir);
+    if (g->profile_use_path != nullptr) {
+        cache_file(cache_hash, g->profile_use_path);
+    }
     for (size_t arg_i = 0; arg_i < g->clang_argv_len; arg_i += 1) {
         cache_str(cache_hash, g->clang_argv[arg_i]);
     }
@@ -8825,10 +9103,74 @@ Error create_c_object_cache(CodeGen *g, CacheHash **out_cache_hash, bool verbose
     return ErrorNone;
 }
 
-// returns true if it was a cache miss
-static void gen_c_object(CodeGen *g, Buf *self_exe_path, CFile *c_file) {
+struct CPchGroup;
+
+struct CObjectJob {
+    CFile *c_file;
+    // Set when the source starts with the includes of a shared precompiled header.
+    CPchGroup *pch_group;
+    Buf *o_final_path;
+    CacheHash *cache_hash;
+};
+
+struct CObjectJobQueue {
+    CodeGen *g;
+    Buf *self_exe_path;
+    OsMutex *mutex;
+    // Every precompiled header is handed out before any object, so an object
+    // waiting for one only waits on a worker that is already building it.
+    ZigList<CPchGroup *> pch_groups;
+    size_t next_pch_group_index;
+    OsCond *pch_built;
+    CObjectJob *jobs;
+    size_t jobs_len;
+    size_t next_job_index;
+    bool any_failed;
+};
+
+// C sources built with the same arguments tend to start with the same
+// includes, and parsing those headers is often most of the work. Sources in
+// the same directory whose leading includes start the same way share a
+// precompiled header of the includes they have in common. The includes in
+// the source itself are then skipped by their include guards, so this is
+// only done with --enable-c-pch: a leading header without them would be
+// included twice.
+static const size_t c_pch_min_users = 2;
+
+struct CPchGroup {
+    const char *header_lang;
+    Buf *source_dir;
+    CFile *c_file;
+    // The leading include lines, such as <stdio.h> or "foo.h", that every
+    // source in the group starts with.
+    ZigList<Buf *> includes;
+    ZigList<CObjectJob *> jobs;
+
+    // Protected by the queue mutex.
+    bool is_built;
+    // Null if building the precompiled header failed.
+    Buf *pch_path;
+    Buf *pch_digest;
+};
+
+static CPchGroup *wait_for_c_pch(CObjectJobQueue *queue, CPchGroup *group) {
+    os_mutex_lock(queue->mutex);
+    while (!group->is_built) {
+        os_cond_wait(queue->pch_built, queue->mutex);
+    }
+    os_mutex_unlock(queue->mutex);
+    return (group->pch_path != nullptr) ? group : nullptr;
+}
+
+// May be called from a worker thread. Everything shared with other jobs goes
+// through queue->mutex; the rest is owned by this job.
+static Error gen_c_object(CObjectJobQueue *queue, CObjectJob *job) {
     Error err;
 
+    CodeGen *g = queue->g;
+    CFile *c_file = job->c_file;
+    CPchGroup *pch_group = (job->pch_group != nullptr) ? wait_for_c_pch(queue, job->pch_group) : nullptr;
+
     Buf *artifact_dir;
     Buf *o_final_path;
 
@@ -8844,7 +9186,7 @@ static void gen_c_object(CodeGen *g, Buf *self_exe_path, CFile *c_file) {
     CacheHash *cache_hash;
     if ((err = create_c_object_cache(g, &cache_hash, true))) {
         // Already printed error; verbose = true
-        exit(1);
+        return err;
     }
     cache_file(cache_hash, c_source_file);
 
@@ -8863,6 +9205,12 @@ static void gen_c_object(CodeGen *g, Buf *self_exe_path, CFile *c_file) {
         }
     }
 
+    // The header files inside the precompiled header are covered by its digest.
+    if (pch_group != nullptr) {
+        cache_str(cache_hash, "pch");
+        cache_buf(cache_hash, pch_group->pch_digest);
+    }
+
     Buf digest = BUF_INIT;
     buf_resize(&digest, 0);
     if ((err = cache_hit(cache_hash, &digest))) {
@@ -8872,7 +9220,7 @@ static void gen_c_object(CodeGen *g, Buf *self_exe_path, CFile *c_file) {
             } else {
                 fprintf(stderr, "unable to check cache when compiling C object: %s\n", err_str(err));
             }
-            exit(1);
+            return err;
         }
     }
     bool is_cache_miss = (buf_len(&digest) == 0);
@@ -8882,17 +9230,22 @@ static void gen_c_object(CodeGen *g, Buf *self_exe_path, CFile *c_file) {
         Buf *out_obj_path = buf_alloc();
         if ((err = get_tmp_filename(g, out_obj_path, final_o_basename))) {
             fprintf(stderr, "unable to create tmp dir: %s\n", err_str(err));
-            exit(1);
+            return err;
         }
 
         Termination term;
         ZigList<const char *> args = {};
-        args.append(buf_ptr(self_exe_path));
+        args.append(buf_ptr(queue->self_exe_path));
         args.append("cc");
 
         Buf *out_dep_path = buf_sprintf("%s.d", buf_ptr(out_obj_path));
         add_cc_args(g, args, buf_ptr(out_dep_path), false);
 
+        if (pch_group != nullptr) {
+            args.append("-include-pch");
+            args.append(buf_ptr(pch_group->pch_path));
+        }
+
         args.append("-o");
         args.append(buf_ptr(out_obj_path));
 
@@ -8904,13 +9257,17 @@ static void gen_c_object(CodeGen *g, Buf *self_exe_path, CFile *c_file) {
         }
 
         if (g->verbose_cc) {
+            os_mutex_lock(queue->mutex);
             print_zig_cc_cmd(&args);
+            os_mutex_unlock(queue->mutex);
         }
         os_spawn_process(args, &term);
         if (term.how != TerminationIdClean || term.code != 0) {
+            os_mutex_lock(queue->mutex);
             fprintf(stderr, "\nThe following command failed:\n");
             print_zig_cc_cmd(&args);
-            exit(1);
+            os_mutex_unlock(queue->mutex);
+            return ErrorCCompileErrors;
         }
 
         // add the files depended on to the cache system
@@ -8919,7 +9276,7 @@ static void gen_c_object(CodeGen *g, Buf *self_exe_path, CFile *c_file) {
             // compiler may not produce one eg. when compiling .s files
             if (err != ErrorFileNotFound) {
                 fprintf(stderr, "Failed to add C source dependencies to cache: %s\n", err_str(err));
-                exit(1);
+                return err;
             }
         }
         if (err != ErrorFileNotFound) {
@@ -8928,20 +9285,20 @@ static void gen_c_object(CodeGen *g, Buf *self_exe_path, CFile *c_file) {
 
         if ((err = cache_final(cache_hash, &digest))) {
             fprintf(stderr, "Unable to finalize cache hash: %s\n", err_str(err));
-            exit(1);
+            return err;
         }
         artifact_dir = buf_alloc();
         os_path_join(o_dir, &digest, artifact_dir);
         if ((err = os_make_path(artifact_dir))) {
             fprintf(stderr, "Unable to create output directory '%s': %s",
                     buf_ptr(artifact_dir), err_str(err));
-            exit(1);
+            return err;
         }
         o_final_path = buf_alloc();
         os_path_join(artifact_dir, final_o_basename, o_final_path);
         if ((err = os_rename(out_obj_path, o_final_path))) {
             fprintf(stderr, "Unable to rename object: %s\n", err_str(err));
-            exit(1);
+            return err;
         }
     } else {
         // cache hit
@@ -8951,8 +9308,325 @@ static void gen_c_object(CodeGen *g, Buf *self_exe_path, CFile *c_file) {
         os_path_join(artifact_dir, final_o_basename, o_final_path);
     }
 
-    g->link_objects.append(o_final_path);
+    job->o_final_path = o_final_path;
+    job->cache_hash = cache_hash;
+    return ErrorNone;
+}
+
+static const char *c_pch_header_lang(Buf *source_path) {
+    if (buf_ends_with_str(source_path, ".c"))
+        return "c-header";
+    if (buf_ends_with_str(source_path, ".cpp") || buf_ends_with_str(source_path, ".cc") ||
+        buf_ends_with_str(source_path, ".cxx"))
+    {
+        return "c++-header";
+    }
+    return nullptr;
+}
+
+static bool is_c_horizontal_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Collects the operands of the #include lines at the start of a C source,
+// skipping comments and blank lines. Stops at anything else, including other
+// directives, since they could change what the includes mean.
+static void get_c_include_prefix(Buf *source, ZigList<Buf *> *out_includes) {
+    const char *it = buf_ptr(source);
+    const char *end = it + buf_len(source);
+    for (;;) {
+        while (it != end && (is_c_horizontal_space(*it) || *it == '\n'))
+            it += 1;
+        if (end - it >= 2 && it[0] == '/' && it[1] == '/') {
+            while (it != end && *it != '\n')
+                it += 1;
+            continue;
+        }
+        if (end - it >= 2 && it[0] == '/' && it[1] == '*') {
+            const char *comment_end = nullptr;
+            for (const char *c = it + 2; end - c >= 2; c += 1) {
+                if (c[0] == '*' && c[1] == '/') {
+                    comment_end = c + 2;
+                    break;
+                }
+            }
+            if (comment_end == nullptr)
+                return;
+            it = comment_end;
+            continue;
+        }
+        if (it == end || *it != '#')
+            return;
+
+        const char *line_end = it;
+        while (line_end != end && *line_end != '\n')
+            line_end += 1;
+        it += 1;
+        while (it != line_end && is_c_horizontal_space(*it))
+            it += 1;
+        if (line_end - it < 7 || memcmp(it, "include", 7) != 0)
+            return;
+        it += 7;
+        while (it != line_end && is_c_horizontal_space(*it))
+            it += 1;
+        if (it == line_end || (*it != '<' && *it != '"'))
+            return;
+        char close = (*it == '<') ? '>' : '"';
+        const char *operand_end = it + 1;
+        while (operand_end != line_end && *operand_end != close)
+            operand_end += 1;
+        if (operand_end == line_end)
+            return;
+        operand_end += 1;
+        // Anything but a line comment after the operand, such as a block
+        // comment that continues on the next line, ends the prefix.
+        const char *rest = operand_end;
+        while (rest != line_end && is_c_horizontal_space(*rest))
+            rest += 1;
+        if (rest != line_end && !(line_end - rest >= 2 && rest[0] == '/' && rest[1] == '/'))
+            return;
+        out_includes->append(buf_create_from_mem(it, operand_end - it));
+        it = line_end;
+    }
+}
+
+static bool c_file_args_eql(CFile *a, CFile *b) {
+    if (a->args.length != b->args.length)
+        return false;
+    for (size_t i = 0; i < a->args.length; i += 1) {
+        if (strcmp(a->args.at(i), b->args.at(i)) != 0)
+            return false;
+    }
+    return true;
+}
+
+static bool c_file_can_use_pch(CFile *c_file) {
+    // These would have to come before the precompiled includes.
+    for (size_t i = 0; i < c_file->args.length; i += 1) {
+        const char *arg = c_file->args.at(i);
+        if (strncmp(arg, "-include", 8) == 0 || strcmp(arg, "-x") == 0)
+            return false;
+    }
+    return true;
+}
+
+// May be called from a worker thread, like gen_c_object.
+static Error build_c_pch(CObjectJobQueue *queue, CPchGroup *group, Buf *out_pch_path, Buf *out_digest) {
+    Error err;
+    CodeGen *g = queue->g;
+
+    // Quoted includes are relative to the source, so point those at the
+    // same files the source finds.
+    Buf *header = buf_alloc();
+    for (size_t i = 0; i < group->includes.length; i += 1) {
+        Buf *operand = group->includes.at(i);
+        if (buf_ptr(operand)[0] == '"') {
+            Buf *rel_path = buf_create_from_mem(buf_ptr(operand) + 1, buf_len(operand) - 2);
+            Buf *full_path = buf_alloc();
+            os_path_join(group->source_dir, rel_path, full_path);
+            bool exists;
+            if ((err = os_file_exists(full_path, &exists)))
+                return err;
+            if (exists) {
+                buf_appendf(header, "#include \"%s\"\n", buf_ptr(full_path));
+                continue;
+            }
+        }
+        buf_appendf(header, "#include %s\n", buf_ptr(operand));
+    }
+
+    CacheHash *cache_hash;
+    if ((err = create_c_object_cache(g, &cache_hash, g->verbose_cc)))
+        return err;
+    cache_str(cache_hash, "pch");
+    cache_str(cache_hash, group->header_lang);
+    cache_buf(cache_hash, header);
+    for (size_t arg_i = 0; arg_i < group->c_file->args.length; arg_i += 1) {
+        cache_str(cache_hash, group->c_file->args.at(arg_i));
+    }
+
+    // Set this because we're not adding any files before checking for a hit.
+    cache_hash->force_check_manifest = true;
+
+    buf_resize(out_digest, 0);
+    if ((err = cache_hit(cache_hash, out_digest))) {
+        if (err != ErrorInvalidFormat)
+            return err;
+    }
+    // Holding the manifest lock until the end keeps another process from
+    // rebuilding the precompiled header while our objects use it.
+    os_mutex_lock(queue->mutex);
     g->caches_to_release.append(cache_hash);
+    os_mutex_unlock(queue->mutex);
+
+    // clang checks that the header a precompiled header was made from is
+    // unchanged, so both stay in a directory named by the inputs.
+    Buf *pch_dir = buf_sprintf("%s" OS_SEP CACHE_OUT_SUBDIR OS_SEP "%s",
+            buf_ptr(g->cache_dir), buf_ptr(&cache_hash->b64_digest));
+    Buf *header_path = buf_alloc();
+    os_path_join(pch_dir, buf_create_from_str("pch.h"), header_path);
+    buf_init_from_buf(out_pch_path, header_path);
+    buf_append_str(out_pch_path, ".pch");
+
+    if (buf_len(out_digest) != 0 && cache_hash->files.length != 0)
+        return ErrorNone;
+
+    if ((err = os_make_path(pch_dir)))
+        return err;
+    if ((err = os_write_file(header_path, header)))
+        return err;
+
+    Buf *dep_path = buf_sprintf("%s.d", buf_ptr(header_path));
+    ZigList<const char *> args = {};
+    args.append(buf_ptr(queue->self_exe_path));
+    args.append("cc");
+    add_cc_args(g, args, buf_ptr(dep_path), false);
+    for (size_t arg_i = 0; arg_i < group->c_file->args.length; arg_i += 1) {
+        args.append(group->c_file->args.at(arg_i));
+    }
+    args.append("-x");
+    args.append(group->header_lang);
+    args.append(buf_ptr(header_path));
+    args.append("-o");
+    args.append(buf_ptr(out_pch_path));
+
+    if (g->verbose_cc) {
+        os_mutex_lock(queue->mutex);
+        print_zig_cc_cmd(&args);
+        os_mutex_unlock(queue->mutex);
+    }
+    Termination term;
+    os_spawn_process(args, &term);
+    if (term.how != TerminationIdClean || term.code != 0)
+        return ErrorCCompileErrors;
+
+    if ((err = cache_add_dep_file(cache_hash, dep_path, true)))
+        return err;
+    os_delete_file(dep_path);
+
+    return cache_final(cache_hash, out_digest);
+}
+
+// Groups the jobs by their leading includes and queues a precompiled header
+// for each group that is large enough. A job without one is compiled as usual.
+static void setup_c_pchs(CObjectJobQueue *queue) {
+    Error err;
+
+    ZigList<CPchGroup *> groups = {};
+    for (size_t job_i = 0; job_i < queue->jobs_len; job_i += 1) {
+        CObjectJob *job = &queue->jobs[job_i];
+        Buf *source_path = buf_create_from_str(job->c_file->source_path);
+        const char *header_lang = c_pch_header_lang(source_path);
+        if (header_lang == nullptr || !c_file_can_use_pch(job->c_file))
+            continue;
+
+        Buf *source = buf_alloc();
+        if ((err = os_fetch_file_path(source_path, source))) {
+            // The compile reports it.
+            continue;
+        }
+        ZigList<Buf *> includes = {};
+        get_c_include_prefix(source, &includes);
+        buf_deinit(source);
+        if (includes.length == 0)
+            continue;
+
+        Buf *abs_source_path = buf_alloc();
+        *abs_source_path = os_path_resolve(&source_path, 1);
+        Buf *source_dir = buf_alloc();
+        os_path_split(abs_source_path, source_dir, nullptr);
+
+        CPchGroup *group = nullptr;
+        for (size_t group_i = 0; group_i < groups.length; group_i += 1) {
+            CPchGroup *candidate = groups.at(group_i);
+            if (strcmp(candidate->header_lang, header_lang) == 0 &&
+                buf_eql_buf(candidate->source_dir, source_dir) &&
+                buf_eql_buf(candidate->includes.at(0), includes.at(0)) &&
+                c_file_args_eql(candidate->c_file, job->c_file))
+            {
+                group = candidate;
+                break;
+            }
+        }
+        if (group == nullptr) {
+            group = allocate<CPchGroup>(1);
+            group->header_lang = header_lang;
+            group->source_dir = source_dir;
+            group->c_file = job->c_file;
+            group->includes = includes;
+            groups.append(group);
+        } else {
+            size_t common_len = 1;
+            while (common_len < group->includes.length && common_len < includes.length &&
+                buf_eql_buf(group->includes.at(common_len), includes.at(common_len)))
+            {
+                common_len += 1;
+            }
+            group->includes.resize(common_len);
+            includes.deinit();
+        }
+        group->jobs.append(job);
+    }
+
+    for (size_t group_i = 0; group_i < groups.length; group_i += 1) {
+        CPchGroup *group = groups.at(group_i);
+        if (group->jobs.length < c_pch_min_users)
+            continue;
+        queue->pch_groups.append(group);
+        for (size_t job_i = 0; job_i < group->jobs.length; job_i += 1) {
+            group->jobs.at(job_i)->pch_group = group;
+        }
+    }
+    groups.deinit();
+}
+
+static void build_queued_c_pch(CObjectJobQueue *queue, CPchGroup *group) {
+    Error err;
+    Buf *pch_path = buf_alloc();
+    Buf *pch_digest = buf_alloc();
+    err = build_c_pch(queue, group, pch_path, pch_digest);
+
+    os_mutex_lock(queue->mutex);
+    if (err == ErrorNone) {
+        group->pch_path = pch_path;
+        group->pch_digest = pch_digest;
+    } else if (queue->g->verbose_cc) {
+        // Not fatal; the sources still compile without it, and report
+        // any error in the headers themselves.
+        fprintf(stderr, "unable to build precompiled header, compiling without it: %s\n",
+                err_str(err));
+    }
+    group->is_built = true;
+    os_cond_broadcast(queue->pch_built);
+    os_mutex_unlock(queue->mutex);
+}
+
+static void gen_c_objects_worker(void *context) {
+    CObjectJobQueue *queue = reinterpret_cast<CObjectJobQueue *>(context);
+    for (;;) {
+        os_mutex_lock(queue->mutex);
+        if (queue->next_pch_group_index < queue->pch_groups.length) {
+            CPchGroup *group = queue->pch_groups.at(queue->next_pch_group_index);
+            queue->next_pch_group_index += 1;
+            os_mutex_unlock(queue->mutex);
+
+            build_queued_c_pch(queue, group);
+            continue;
+        }
+        if (queue->any_failed || queue->next_job_index >= queue->jobs_len) {
+            os_mutex_unlock(queue->mutex);
+            return;
+        }
+        CObjectJob *job = &queue->jobs[queue->next_job_index];
+        queue->next_job_index += 1;
+        os_mutex_unlock(queue->mutex);
+
+        if (gen_c_object(queue, job) != ErrorNone) {
+            os_mutex_lock(queue->mutex);
+            queue->any_failed = true;
+            os_mutex_unlock(queue->mutex);
+        }
+    }
 }
 
 // returns true if we had any cache misses
@@ -8968,11 +9642,58 @@ static void gen_c_objects(CodeGen *g) {
         exit(1);
     }
 
+    // The compiler id is computed lazily and memoized in a global; do it here
+    // so that the worker threads only ever read it.
+    Buf *compiler_id;
+    if ((err = get_compiler_id(&compiler_id))) {
+        fprintf(stderr, "unable to get compiler id: %s\n", err_str(err));
+        exit(1);
+    }
+
     codegen_add_time_event(g, "Compile C Code");
 
+    CObjectJobQueue queue = {};
+    queue.g = g;
+    queue.self_exe_path = self_exe_path;
+    queue.mutex = os_mutex_create();
+    queue.jobs_len = g->c_source_files.length;
+    queue.jobs = allocate<CObjectJob>(queue.jobs_len);
     for (size_t c_file_i = 0; c_file_i < g->c_source_files.length; c_file_i += 1) {
-        CFile *c_file = g->c_source_files.at(c_file_i);
-        gen_c_object(g, self_exe_path, c_file);
+        queue.jobs[c_file_i].c_file = g->c_source_files.at(c_file_i);
+    }
+    if (g->enable_c_pch) {
+        setup_c_pchs(&queue);
+        queue.pch_built = os_cond_create();
+    }
+
+    size_t job_count = (g->job_count == 0) ? os_cpu_count() : g->job_count;
+    size_t thread_count = (job_count < queue.jobs_len) ? job_count : queue.jobs_len;
+    // The calling thread is one of the workers.
+    ZigList<OsThread *> threads = {};
+    for (size_t thread_i = 1; thread_i < thread_count; thread_i += 1) {
+        OsThread *thread;
+        if ((err = os_thread_spawn(gen_c_objects_worker, &queue, &thread))) {
+            // Not fatal; the threads we do have will drain the queue.
+            break;
+        }
+        threads.append(thread);
+    }
+    gen_c_objects_worker(&queue);
+    for (size_t thread_i = 0; thread_i < threads.length; thread_i += 1) {
+        os_thread_join(threads.at(thread_i));
+    }
+    threads.deinit();
+
+    if (queue.any_failed) {
+        exit(1);
+    }
+
+    // Objects are appended in command line order regardless of which job
+    // finished first, so that the link and the cache hash are deterministic.
+    for (size_t job_i = 0; job_i < queue.jobs_len; job_i += 1) {
+        CObjectJob *job = &queue.jobs[job_i];
+        g->link_objects.append(job->o_final_path);
+        g->caches_to_release.append(job->cache_hash);
     }
 }
 
@@ -9437,6 +10158,155 @@ static void gen_h_file(CodeGen *g) {
         zig_panic("unable to close h file: %s", strerror(errno));
 }
 
+// The probe length columns count how many keys a lookup finds in the first,
+// second, third, or a later group it scans.
+template<typename K, typename V, uint32_t (*HashFunction)(K key), bool (*EqualFn)(K a, K b)>
+static void print_hash_map_stats(FILE *f, const char *name, const HashMap<K, V, HashFunction, EqualFn> &map) {
+    HashMapProbeStats stats = map.probe_stats();
+    double mean = (stats.size == 0) ? 0.0 : (double)stats.total_probe_length / (double)stats.size;
+    fprintf(f, "%24s%10d%10d%10.3f%10d", name, stats.size, stats.capacity, mean, stats.max_probe_length);
+    for (int i = 0; i < hash_map_probe_histogram_len; i += 1) {
+        fprintf(f, "%10d", stats.histogram[i]);
+    }
+    fprintf(f, "\n");
+}
+
+static size_t trace_types_interned(CodeGen *g) {
+    return g->type_table.size() + g->fn_type_table.size();
+}
+
+struct TraceSelfTime {
+    double self_time;
+    size_t event_index;
+};
+
+static int trace_self_time_cmp(const void *a, const void *b) {
+    double a_time = reinterpret_cast<const TraceSelfTime *>(a)->self_time;
+    double b_time = reinterpret_cast<const TraceSelfTime *>(b)->self_time;
+    return (a_time < b_time) - (a_time > b_time);
+}
+
+static const char *trace_categories[] = {"file", "decl", "fn", "generic", "comptime"};
+static const size_t trace_report_len = 10;
+
+// Prints the spans with the most self time, that is time not spent in a
+// nested span, for each category.
+static void print_trace_report(CodeGen *g, FILE *f) {
+    size_t events_len = g->trace_events.length;
+    if (events_len == 0)
+        return;
+
+    double *self_time = allocate<double>(events_len);
+    ZigList<size_t> parents = {};
+    for (size_t i = 0; i < events_len; i += 1) {
+        TraceEvent *event = &g->trace_events.at(i);
+        double duration = event->end - event->start;
+        self_time[i] = duration;
+        parents.resize(event->depth);
+        if (event->depth != 0) {
+            self_time[parents.last()] -= duration;
+        }
+        parents.append(i);
+    }
+    parents.deinit();
+
+    TraceSelfTime *sorted = allocate<TraceSelfTime>(events_len);
+    for (size_t category_i = 0; category_i < array_length(trace_categories); category_i += 1) {
+        const char *category = trace_categories[category_i];
+        size_t sorted_len = 0;
+        for (size_t i = 0; i < events_len; i += 1) {
+            if (strcmp(g->trace_events.at(i).category, category) == 0) {
+                sorted[sorted_len] = {self_time[i], i};
+                sorted_len += 1;
+            }
+        }
+        if (sorted_len == 0)
+            continue;
+        qsort(sorted, sorted_len, sizeof(TraceSelfTime), trace_self_time_cmp);
+
+        fprintf(f, "\n%10s%12s%12s  %s (%zu total)\n", "Category", "Self", "Total", "Name", sorted_len);
+        for (size_t i = 0; i < sorted_len && i < trace_report_len; i += 1) {
+            TraceEvent *event = &g->trace_events.at(sorted[i].event_index);
+            fprintf(f, "%10s%12.4f%12.4f  %s", category, sorted[i].self_time, event->end - event->start,
+                    buf_ptr(event->name));
+            if (event->source_node != nullptr) {
+                fprintf(f, " at %s:%zu", buf_ptr(event->source_node->owner->data.structure.root_struct->path),
+                        event->source_node->line + 1);
+            }
+            fprintf(f, "\n");
+        }
+    }
+    free(sorted);
+    free(self_time);
+}
+
+static void write_json_str(FILE *f, const char *str) {
+    fputc('"', f);
+    for (const char *c = str; *c != 0; c += 1) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', f);
+            fputc(*c, f);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(f, "\\u%04x", (unsigned)*c);
+        } else {
+            fputc(*c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+// Writes the phases, spans and counters in the Chrome trace event format,
+// which chrome://tracing and Perfetto can open. Phases go on their own track.
+static void write_time_trace(CodeGen *g, Buf *path) {
+    FILE *f = fopen(buf_ptr(path), "wb");
+    if (f == nullptr) {
+        fprintf(stderr, "Unable to open %s: %s\n", buf_ptr(path), strerror(errno));
+        return;
+    }
+    double start_time = g->timing_events.at(0).time;
+    fprintf(f, "{\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"phases\"}},\n");
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"frontend\"}}");
+    for (size_t i = 0; i + 1 < g->timing_events.length; i += 1) {
+        TimeEvent *te = &g->timing_events.at(i);
+        TimeEvent *next_te = &g->timing_events.at(i + 1);
+        fprintf(f, ",\n{\"name\":");
+        write_json_str(f, te->name);
+        fprintf(f, ",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+                (te->time - start_time) * 1000000.0, (next_te->time - te->time) * 1000000.0);
+    }
+    Buf *location = buf_alloc();
+    for (size_t i = 0; i < g->trace_events.length; i += 1) {
+        TraceEvent *event = &g->trace_events.at(i);
+        fprintf(f, ",\n{\"name\":");
+        write_json_str(f, buf_ptr(event->name));
+        fprintf(f, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f",
+                event->category, (event->start - start_time) * 1000000.0,
+                (event->end - event->start) * 1000000.0);
+        if (event->source_node != nullptr) {
+            buf_resize(location, 0);
+            buf_appendf(location, "%s:%zu",
+                    buf_ptr(event->source_node->owner->data.structure.root_struct->path),
+                    event->source_node->line + 1);
+            fprintf(f, ",\"args\":{\"source\":");
+            write_json_str(f, buf_ptr(location));
+            fprintf(f, "}");
+        }
+        fprintf(f, "}");
+    }
+    for (size_t i = 0; i < g->trace_counter_samples.length; i += 1) {
+        TraceCounterSample *sample = &g->trace_counter_samples.at(i);
+        fprintf(f, ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{"
+                "\"ir_instructions_created\":%zu,\"backward_branches\":%zu,\"types_interned\":%zu}}",
+                (sample->time - start_time) * 1000000.0, sample->ir_instructions_created,
+                sample->backward_branches, sample->types_interned);
+    }
+    fprintf(f, "\n]}\n");
+    if (fclose(f) != 0) {
+        fprintf(stderr, "Unable to write %s: %s\n", buf_ptr(path), strerror(errno));
+    }
+}
+
 void codegen_print_timing_report(CodeGen *g, FILE *f) {
     double start_time = g->timing_events.at(0).time;
     double end_time = g->timing_events.last().time;
@@ -9452,13 +10322,86 @@ void codegen_print_timing_report(CodeGen *g, FILE *f) {
                 (next_te->time - te->time) / total);
     }
     fprintf(f, "%20s%12.4f%12.4f%12.4f%12.4f\n", "Total", 0.0, total, total, 1.0);
+
+    fprintf(f, "\n%24s%10s%10s%10s%10s%10s%10s%10s%10s\n", "Hash Map", "Size", "Capacity",
+            "Mean", "Max", "1", "2", "3", "4+");
+    print_hash_map_stats(f, "import_table", g->import_table);
+    print_hash_map_stats(f, "builtin_fn_table", g->builtin_fn_table);
+    print_hash_map_stats(f, "primitive_type_table", g->primitive_type_table);
+    print_hash_map_stats(f, "type_table", g->type_table);
+    print_hash_map_stats(f, "fn_type_table", g->fn_type_table);
+    print_hash_map_stats(f, "error_table", g->error_table);
+    print_hash_map_stats(f, "generic_table", g->generic_table);
+    print_hash_map_stats(f, "memoized_fn_eval_table", g->memoized_fn_eval_table);
+    print_hash_map_stats(f, "llvm_fn_table", g->llvm_fn_table);
+    print_hash_map_stats(f, "exported_symbol_names", g->exported_symbol_names);
+    print_hash_map_stats(f, "external_prototypes", g->external_prototypes);
+    print_hash_map_stats(f, "string_literals_table", g->string_literals_table);
+    print_hash_map_stats(f, "type_info_cache", g->type_info_cache);
+
+    fprintf(f, "\n");
+    arena_print_stats(f);
+    fprintf(f, "%zu comptime evaluations used %zu bytes of IR\n",
+            g->comptime_eval_count, g->comptime_eval_ir_bytes);
+    fprintf(f, "%zu comptime calls reused the IR of an earlier call instead of running ir_gen\n",
+            g->comptime_ir_reused);
+    fprintf(f, "%zu comptime loop iterations ran without analyzing the loop body\n",
+            g->comptime_loop_iterations);
+    fprintf(f, "%zu packed u8 arrays expanded into a value per byte\n", g->packed_arrays_expanded);
+    if (g->enable_cache) {
+        fprintf(f, "%zu comptime calls loaded from the cache, %zu stored\n",
+                g->comptime_cache_hits, g->comptime_cache_stores);
+    }
+    if (g->codegen_units_emitted != 0) {
+        fprintf(f, "%zu of %zu codegen units reused from the cache\n",
+                g->codegen_units_reused, g->codegen_units_emitted);
+    }
+    fprintf(f, "%zu bytes of source read, %zu bytes copied into token strings\n",
+            g->source_bytes_read, g->token_str_bytes_copied);
+    fprintf(f, "%zu function bodies parsed when first needed\n", g->fn_bodies_parsed_lazily);
+    fprintf(f, "%zu IR instructions created, %zu backward branches, %zu types interned\n",
+            g->ir_instructions_created, g->backward_branches, trace_types_interned(g));
+    fprintf(f, "%zu function bodies had their pass 1 IR generated on worker threads\n",
+            g->fn_bodies_generated_ahead);
+    print_trace_report(g, f);
+    size_t peak_rss = os_peak_rss();
+    if (peak_rss != 0) {
+        fprintf(f, "peak RSS: %zu bytes\n", peak_rss);
+    }
 }
 
-void codegen_add_time_event(CodeGen *g, const char *name) {
+static double timestamp_seconds(void) {
     OsTimeStamp timestamp = os_timestamp_monotonic();
     double seconds = (double)timestamp.sec;
     seconds += ((double)timestamp.nsec) / 1000000000.0;
+    return seconds;
+}
+
+void codegen_add_time_event(CodeGen *g, const char *name) {
+    double seconds = timestamp_seconds();
     g->timing_events.append({seconds, name});
+    if (g->enable_trace) {
+        g->trace_counter_samples.append({seconds, g->ir_instructions_created, g->backward_branches,
+                trace_types_interned(g)});
+    }
+}
+
+void codegen_trace_begin(CodeGen *g, const char *category, Buf *name, AstNode *source_node) {
+    if (!g->enable_trace)
+        return;
+    g->trace_stack.append(g->trace_events.length);
+    TraceEvent *event = g->trace_events.add_one();
+    event->category = category;
+    event->name = name;
+    event->source_node = source_node;
+    event->depth = (uint32_t)(g->trace_stack.length - 1);
+    event->start = timestamp_seconds();
+}
+
+void codegen_trace_end(CodeGen *g) {
+    if (!g->enable_trace)
+        return;
+    g->trace_events.at(g->trace_stack.pop()).end = timestamp_seconds();
 }
 
 static void add_cache_pkg(CodeGen *g, CacheHash *ch, ZigPackage *pkg) {
@@ -9494,6 +10437,7 @@ static Error check_cache(CodeGen *g, Buf *manifest_dir, Buf *digest) {
 
     CacheHash *ch = &g->cache_hash;
     cache_init(ch, manifest_dir);
+    ch->job_count = g->job_count;
 
     add_cache_pkg(g, ch, g->root_package);
     if (g->linker_script != nullptr) {
@@ -9531,6 +10475,7 @@ static Error check_cache(CodeGen *g, Buf *manifest_dir, Buf *digest) {
     cache_bool(ch, g->linker_rdynamic);
     cache_bool(ch, g->each_lib_rpath);
     cache_bool(ch, g->disable_gen_h);
+    cache_bool(ch, g->lazy_cimport);
     cache_bool(ch, g->bundle_compiler_rt);
     cache_bool(ch, want_valgrind_support(g));
     cache_bool(ch, g->have_pic);
@@ -9538,6 +10483,13 @@ static Error check_cache(CodeGen *g, Buf *manifest_dir, Buf *digest) {
     cache_bool(ch, g->have_stack_probing);
     cache_bool(ch, g->is_dummy_so);
     cache_bool(ch, g->function_sections);
+    cache_usize(ch, g->codegen_units);
+    cache_bool(ch, g->thin_lto);
+    cache_bool(ch, g->profile_generate);
+    cache_buf_opt(ch, g->profile_generate_dir);
+    if (g->profile_use_path != nullptr) {
+        cache_file(ch, g->profile_use_path);
+    }
     cache_buf_opt(ch, g->mmacosx_version_min);
     cache_buf_opt(ch, g->mios_version_min);
     cache_usize(ch, g->version_major);
@@ -9650,6 +10602,11 @@ void codegen_build_and_link(CodeGen *g) {
     detect_libc(g);
     detect_dynamic_linker(g);
 
+    if (g->thin_lto && target_object_format(g->zig_target) == ZigLLVM_MachO) {
+        fprintf(stderr, "-flto=thin is not supported by the Mach-O linker\n");
+        exit(1);
+    }
+
     Buf digest = BUF_INIT;
     if (g->enable_cache) {
         Buf *manifest_dir = buf_alloc();
@@ -9676,12 +10633,15 @@ void codegen_build_and_link(CodeGen *g) {
                 buf_ptr(g->cache_dir), buf_ptr(&digest));
         resolve_out_paths(g);
     } else {
+        codegen_start_link_deps(g);
+
         if (need_llvm_module(g)) {
             init(g);
 
             codegen_add_time_event(g, "Semantic Analysis");
 
             gen_root_source(g);
+            ir_comptime_cache_collect(g);
 
         }
         if (g->enable_cache) {
@@ -9728,6 +10688,10 @@ void codegen_build_and_link(CodeGen *g) {
 
     codegen_release_caches(g);
     codegen_add_time_event(g, "Done");
+
+    if (g->time_trace_path != nullptr) {
+        write_time_trace(g, g->time_trace_path);
+    }
 }
 
 void codegen_release_caches(CodeGen *g) {
@@ -9770,6 +10734,7 @@ CodeGen *create_child_codegen(CodeGen *parent_gen, Buf *root_src_path, OutType o
     child_gen->verbose_cc = parent_gen->verbose_cc;
     child_gen->llvm_argv = parent_gen->llvm_argv;
     child_gen->dynamic_linker_path = parent_gen->dynamic_linker_path;
+    child_gen->job_count = parent_gen->job_count;
 
     codegen_set_strip(child_gen, parent_gen->strip_debug_symbols);
     child_gen->want_pic = parent_gen->have_pic ? WantPICEnabled : WantPICDisabled;
@@ -9790,6 +10755,7 @@ CodeGen *codegen_create(Buf *main_pkg_path, Buf *root_src_path, const ZigTarget
     ZigLibCInstallation *libc, Buf *cache_dir, bool is_test_build)
 {
     CodeGen *g = allocate<CodeGen>(1);
+    g->tmp_filename_mutex = os_mutex_create();
 
     codegen_add_time_event(g, "Initialize");
 
@@ -9829,6 +10795,7 @@ CodeGen *codegen_create(Buf *main_pkg_path, Buf *root_src_path, const ZigTarget
     g->external_prototypes.init(8);
     g->string_literals_table.init(16);
     g->type_info_cache.init(32);
+    g->comptime_cache_file_table.init(32);
     g->is_test_build = is_test_build;
     g->is_single_threaded = false;
     buf_resize(&g->global_asm, 0);
@@ -45,6 +45,13 @@ void codegen_set_test_name_prefix(CodeGen *g, Buf *prefix);
 void codegen_set_lib_version(CodeGen *g, size_t major, size_t minor, size_t patch);
 void codegen_add_time_event(CodeGen *g, const char *name);
 void codegen_print_timing_report(CodeGen *g, FILE *f);
+// Spans are only recorded when g->enable_trace is set. Every begin must be
+// matched by an end in the same function.
+void codegen_trace_begin(CodeGen *g, const char *category, Buf *name, AstNode *source_node);
+void codegen_trace_end(CodeGen *g);
+// Starts building what codegen_link will need, such as compiler_rt and libc,
+// in a copy of this process, so that codegen_link finds it in the cache.
+void codegen_start_link_deps(CodeGen *g);
 void codegen_link(CodeGen *g);
 void zig_link_add_compiler_rt(CodeGen *g);
 void codegen_build_and_link(CodeGen *g);
@@ -95,6 +95,21 @@ Error get_compiler_id(Buf **result) {
     CacheHash cache_hash;
     CacheHash *ch = &cache_hash;
     cache_init(ch, manifest_dir);
+
+    // The linker derives the build ID from the contents, so when the executable
+    // and all its shared libraries have one, that stands in for hashing them.
+    // With no files added, cache_hit only hashes the parameters.
+    Buf build_id = BUF_INIT;
+    if (os_self_build_id(&build_id) == ErrorNone) {
+        cache_str(ch, "build-id");
+        cache_buf(ch, &build_id);
+        buf_resize(&saved_compiler_id, 0);
+        if ((err = cache_hit(ch, &saved_compiler_id)))
+            return err;
+        *result = &saved_compiler_id;
+        return ErrorNone;
+    }
+
     Buf self_exe_path = BUF_INIT;
     if ((err = os_self_exe_path(&self_exe_path)))
         return err;
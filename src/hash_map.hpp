@@ -12,29 +12,54 @@
 
 #include <stdint.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ZIG_HASH_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+static const int hash_map_probe_histogram_len = 4;
+
+// Probe length is the number of groups a successful lookup scans.
+struct HashMapProbeStats {
+    int size;
+    int capacity;
+    int max_probe_length;
+    int64_t total_probe_length;
+    // histogram[i] counts the keys found in group i + 1 of their probe
+    // sequence. The last bucket also counts every key further along.
+    int histogram[hash_map_probe_histogram_len];
+};
+
+// Open addressing with the per-slot metadata kept in a separate byte array,
+// in the style of SwissTable. Each control byte is either empty, deleted, or
+// the low 7 bits of the hash of the key in that slot. Lookups scan a group of
+// 16 control bytes at a time and only compare keys whose 7 hash bits match.
+// The remaining hash bits pick the group, with the capacity a power of two.
 template<typename K, typename V, uint32_t (*HashFunction)(K key), bool (*EqualFn)(K a, K b)>
 class HashMap {
 public:
     void init(int capacity) {
-        init_capacity(capacity);
+        init_capacity(capacity_for_size(capacity));
     }
     void deinit(void) {
+        free(_ctrl);
         free(_entries);
     }
 
     struct Entry {
-        bool used;
-        int distance_from_start_index;
         K key;
         V value;
     };
 
+    struct GetOrPutResult {
+        Entry *entry;
+        bool found_existing;
+    };
+
     void clear() {
-        for (int i = 0; i < _capacity; i += 1) {
-            _entries[i].used = false;
-        }
+        memset(_ctrl, ctrl_empty, _capacity);
         _size = 0;
-        _max_distance_from_start_index = 0;
+        _growth_left = max_load(_capacity);
         _modification_count += 1;
     }
 
@@ -43,30 +68,59 @@ public:
     }
 
     void put(const K &key, const V &value) {
+        GetOrPutResult gop = get_or_put(key);
+        gop.entry->value = value;
+    }
+
+    // Returns the entry for key, inserting it if it was not there. When
+    // found_existing is false the caller must initialize entry->value.
+    // The entry is valid until the next modification of the map.
+    GetOrPutResult get_or_put(const K &key) {
+        uint32_t hash = HashFunction(key);
+        int insert_index = -1;
+        int group_mask = (_capacity / group_width) - 1;
+        int group_index = (int)(hash >> 7) & group_mask;
+        for (int probe = 1;; probe += 1) {
+            const uint8_t *ctrl = &_ctrl[group_index * group_width];
+            uint32_t match = group_match(ctrl, hash_bits(hash));
+            while (match != 0) {
+                int index = group_index * group_width + ctzll(match);
+                if (EqualFn(_entries[index].key, key))
+                    return {&_entries[index], true};
+                match &= match - 1;
+            }
+            if (insert_index == -1) {
+                uint32_t available = group_match_empty_or_deleted(ctrl);
+                if (available != 0)
+                    insert_index = group_index * group_width + ctzll(available);
+            }
+            if (group_match(ctrl, ctrl_empty) != 0)
+                break;
+            // Triangular probing visits every group when the group count is a power of two.
+            group_index = (group_index + probe) & group_mask;
+        }
+
+        // Finding an existing key does not disturb iterators, so only
+        // insertions count as modifications.
         _modification_count += 1;
-        internal_put(key, value);
-
-        // if we get too full (60%), double the capacity
-        if (_size * 5 >= _capacity * 3) {
-            Entry *old_entries = _entries;
-            int old_capacity = _capacity;
-            init_capacity(_capacity * 2);
-            // dump all of the old elements into the new table
-            for (int i = 0; i < old_capacity; i += 1) {
-                Entry *old_entry = &old_entries[i];
-                if (old_entry->used)
-                    internal_put(old_entry->key, old_entry->value);
+        if (_ctrl[insert_index] == ctrl_empty) {
+            if (_growth_left == 0) {
+                rehash();
+                insert_index = find_insert_index(hash);
             }
-            free(old_entries);
+            _growth_left -= 1;
         }
+        _ctrl[insert_index] = hash_bits(hash);
+        _size += 1;
+        _entries[insert_index].key = key;
+        return {&_entries[insert_index], false};
     }
 
     Entry *put_unique(const K &key, const V &value) {
-        // TODO make this more efficient
-        Entry *entry = internal_get(key);
-        if (entry)
-            return entry;
-        put(key, value);
+        GetOrPutResult gop = get_or_put(key);
+        if (gop.found_existing)
+            return gop.entry;
+        gop.entry->value = value;
         return nullptr;
     }
 
@@ -89,32 +143,21 @@ public:
 
     void remove(const K &key) {
         _modification_count += 1;
-        int start_index = key_to_index(key);
-        for (int roll_over = 0; roll_over <= _max_distance_from_start_index; roll_over += 1) {
-            int index = (start_index + roll_over) % _capacity;
-            Entry *entry = &_entries[index];
-
-            if (!entry->used)
-                zig_panic("key not found");
-
-            if (!EqualFn(entry->key, key))
-                continue;
-
-            for (; roll_over < _capacity; roll_over += 1) {
-                int next_index = (start_index + roll_over + 1) % _capacity;
-                Entry *next_entry = &_entries[next_index];
-                if (!next_entry->used || next_entry->distance_from_start_index == 0) {
-                    entry->used = false;
-                    _size -= 1;
-                    return;
-                }
-                *entry = *next_entry;
-                entry->distance_from_start_index -= 1;
-                entry = next_entry;
-            }
-            zig_panic("shifting everything in the table");
+        Entry *entry = internal_get(key);
+        if (!entry)
+            zig_panic("key not found");
+        int index = (int)(entry - _entries);
+        // A group that still has an empty slot has never been full, so no
+        // probe sequence continues past it and the slot can become empty
+        // again. Otherwise leave a tombstone.
+        const uint8_t *group = &_ctrl[index - (index % group_width)];
+        if (group_match(group, ctrl_empty) != 0) {
+            _ctrl[index] = ctrl_empty;
+            _growth_left += 1;
+        } else {
+            _ctrl[index] = ctrl_deleted;
         }
-        zig_panic("key not found");
+        _size -= 1;
     }
 
     class Iterator {
@@ -125,8 +168,8 @@ public:
             if (_count >= _table->size())
                 return NULL;
             for (; _index < _table->_capacity; _index += 1) {
-                Entry *entry = &_table->_entries[_index];
-                if (entry->used) {
+                if (is_full(_table->_ctrl[_index])) {
+                    Entry *entry = &_table->_entries[_index];
                     _index += 1;
                     _count += 1;
                     return entry;
@@ -153,89 +196,153 @@ public:
         return Iterator(this);
     }
 
+    HashMapProbeStats probe_stats() const {
+        HashMapProbeStats stats = {};
+        stats.size = _size;
+        stats.capacity = _capacity;
+        int group_mask = (_capacity / group_width) - 1;
+        for (int i = 0; i < _capacity; i += 1) {
+            if (!is_full(_ctrl[i]))
+                continue;
+            int group_index = (int)(HashFunction(_entries[i].key) >> 7) & group_mask;
+            int probe_length = 1;
+            while (group_index != i / group_width) {
+                group_index = (group_index + probe_length) & group_mask;
+                probe_length += 1;
+            }
+            stats.total_probe_length += probe_length;
+            if (probe_length > stats.max_probe_length)
+                stats.max_probe_length = probe_length;
+            int bucket = (probe_length < hash_map_probe_histogram_len) ?
+                probe_length : hash_map_probe_histogram_len;
+            stats.histogram[bucket - 1] += 1;
+        }
+        return stats;
+    }
+
 private:
+    static const int group_width = 16;
+    static const uint8_t ctrl_empty = 0x80;
+    static const uint8_t ctrl_deleted = 0xfe;
 
+    uint8_t *_ctrl;
     Entry *_entries;
     int _capacity;
     int _size;
-    int _max_distance_from_start_index;
+    // how many more empty slots may be filled before the table must grow
+    int _growth_left;
     // this is used to detect bugs where a hashtable is edited while an iterator is running.
     uint32_t _modification_count;
 
+    static bool is_full(uint8_t ctrl) {
+        return (ctrl & 0x80) == 0;
+    }
+
+    static uint8_t hash_bits(uint32_t hash) {
+        return (uint8_t)(hash & 0x7f);
+    }
+
+    // Keep the table at most 7/8 full.
+    static int max_load(int capacity) {
+        return capacity - capacity / 8;
+    }
+
+    static int capacity_for_size(int size) {
+        int capacity = group_width;
+        while (max_load(capacity) < size) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    // Bit i is set if ctrl[i] == byte.
+    static uint32_t group_match(const uint8_t *ctrl, uint8_t byte) {
+#if defined(ZIG_HASH_MAP_SSE2)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte)));
+#else
+        uint32_t result = 0;
+        for (int i = 0; i < group_width; i += 1) {
+            result |= (uint32_t)(ctrl[i] == byte) << i;
+        }
+        return result;
+#endif
+    }
+
+    // Bit i is set if ctrl[i] is empty or deleted, which both have the high bit set.
+    static uint32_t group_match_empty_or_deleted(const uint8_t *ctrl) {
+#if defined(ZIG_HASH_MAP_SSE2)
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+        return (uint32_t)_mm_movemask_epi8(group);
+#else
+        uint32_t result = 0;
+        for (int i = 0; i < group_width; i += 1) {
+            result |= (uint32_t)(ctrl[i] >> 7) << i;
+        }
+        return result;
+#endif
+    }
+
     void init_capacity(int capacity) {
+        assert(capacity >= group_width && (capacity & (capacity - 1)) == 0);
         _capacity = capacity;
+        _ctrl = allocate_nonzero<uint8_t>(_capacity);
         _entries = allocate<Entry>(_capacity);
         _size = 0;
-        _max_distance_from_start_index = 0;
-        for (int i = 0; i < _capacity; i += 1) {
-            _entries[i].used = false;
+        _growth_left = max_load(_capacity);
+        memset(_ctrl, ctrl_empty, _capacity);
+    }
+
+    // Only valid when key is known not to be in the table.
+    int find_insert_index(uint32_t hash) const {
+        int group_mask = (_capacity / group_width) - 1;
+        int group_index = (int)(hash >> 7) & group_mask;
+        for (int probe = 1;; probe += 1) {
+            uint32_t available = group_match_empty_or_deleted(&_ctrl[group_index * group_width]);
+            if (available != 0)
+                return group_index * group_width + ctzll(available);
+            group_index = (group_index + probe) & group_mask;
         }
     }
 
-    void internal_put(K key, V value) {
-        int start_index = key_to_index(key);
-        for (int roll_over = 0, distance_from_start_index = 0;
-                roll_over < _capacity; roll_over += 1, distance_from_start_index += 1)
-        {
-            int index = (start_index + roll_over) % _capacity;
-            Entry *entry = &_entries[index];
-
-            if (entry->used && !EqualFn(entry->key, key)) {
-                if (entry->distance_from_start_index < distance_from_start_index) {
-                    // robin hood to the rescue
-                    Entry tmp = *entry;
-                    if (distance_from_start_index > _max_distance_from_start_index)
-                        _max_distance_from_start_index = distance_from_start_index;
-                    *entry = {
-                        true,
-                        distance_from_start_index,
-                        key,
-                        value,
-                    };
-                    key = tmp.key;
-                    value = tmp.value;
-                    distance_from_start_index = tmp.distance_from_start_index;
-                }
+    // Grows the table, or if it is mostly tombstones, rebuilds it at the same size.
+    void rehash() {
+        uint8_t *old_ctrl = _ctrl;
+        Entry *old_entries = _entries;
+        int old_capacity = _capacity;
+        int old_size = _size;
+        init_capacity(capacity_for_size(old_size * 2 + 1));
+        for (int i = 0; i < old_capacity; i += 1) {
+            if (!is_full(old_ctrl[i]))
                 continue;
-            }
-
-            if (!entry->used) {
-                // adding an entry. otherwise overwriting old value with
-                // same key
-                _size += 1;
-            }
-
-            if (distance_from_start_index > _max_distance_from_start_index)
-                _max_distance_from_start_index = distance_from_start_index;
-            *entry = {
-                true,
-                distance_from_start_index,
-                key,
-                value,
-            };
-            return;
+            uint32_t hash = HashFunction(old_entries[i].key);
+            int index = find_insert_index(hash);
+            _ctrl[index] = hash_bits(hash);
+            _entries[index] = old_entries[i];
         }
-        zig_panic("put into a full HashMap");
+        _size = old_size;
+        _growth_left -= old_size;
+        free(old_ctrl);
+        free(old_entries);
     }
 
-
     Entry *internal_get(const K &key) const {
-        int start_index = key_to_index(key);
-        for (int roll_over = 0; roll_over <= _max_distance_from_start_index; roll_over += 1) {
-            int index = (start_index + roll_over) % _capacity;
-            Entry *entry = &_entries[index];
-
-            if (!entry->used)
+        uint32_t hash = HashFunction(key);
+        int group_mask = (_capacity / group_width) - 1;
+        int group_index = (int)(hash >> 7) & group_mask;
+        for (int probe = 1;; probe += 1) {
+            const uint8_t *ctrl = &_ctrl[group_index * group_width];
+            uint32_t match = group_match(ctrl, hash_bits(hash));
+            while (match != 0) {
+                int index = group_index * group_width + ctzll(match);
+                if (EqualFn(_entries[index].key, key))
+                    return &_entries[index];
+                match &= match - 1;
+            }
+            if (group_match(ctrl, ctrl_empty) != 0)
                 return NULL;
-
-            if (EqualFn(entry->key, key))
-                return entry;
+            group_index = (group_index + probe) & group_mask;
         }
-        return NULL;
-    }
-
-    int key_to_index(const K &key) const {
-        return (int)(HashFunction(key) % ((uint32_t)_capacity));
     }
 };
 
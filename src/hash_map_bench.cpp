@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2019 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// Builds HashMaps from key sets taken from the .zig files under the given
+// directories, std and lib by default, and reports the probe-length
+// distribution and lookup time of the current hash functions next to the
+// ones they replaced. See the hash_map_bench target in CMakeLists.txt.
+//
+// The key sets are the ones the compiler's own tables see: the distinct
+// identifiers (import_table, exported_symbol_names and other Buf keys), the
+// heap addresses of those Bufs (the pointer-keyed tables), and sequential
+// integers (error values and type ids).
+
+#include "buffer.hpp"
+#include "error.hpp"
+#include "hash_map.hpp"
+#include "os.hpp"
+#include "tokenizer.hpp"
+
+#include <stdio.h>
+
+static const double min_seconds = 0.25;
+
+static double timestamp_seconds(void) {
+    OsTimeStamp timestamp = os_timestamp_monotonic();
+    return (double)timestamp.sec + ((double)timestamp.nsec) / 1000000000.0;
+}
+
+// The hash functions from before hash_mix64 and hash_bytes.
+static uint32_t old_ptr_hash(const void *ptr) {
+    return (uint32_t)(((uintptr_t)ptr) % UINT32_MAX);
+}
+
+static uint32_t old_uint64_hash(uint64_t i) {
+    return (uint32_t)(i % UINT32_MAX);
+}
+
+static uint32_t old_buf_hash(Buf *buf) {
+    size_t interval = buf->list.length / 256;
+    if (interval == 0)
+        interval = 1;
+    // FNV 32-bit hash
+    uint32_t h = 2166136261;
+    for (size_t i = 0; i < buf_len(buf); i += interval) {
+        h = h ^ ((uint8_t)buf->list.at(i));
+        h = h * 16777619;
+    }
+    return h;
+}
+
+static void collect_zig_files(Buf *dir_path, ZigList<Buf *> &out_paths) {
+    Error err;
+    ZigList<OsDirEntry> entries = {0};
+    if ((err = os_dir_entries(dir_path, entries))) {
+        fprintf(stderr, "unable to open directory '%s': %s\n", buf_ptr(dir_path), err_str(err));
+        return;
+    }
+    for (size_t i = 0; i < entries.length; i += 1) {
+        Buf *full_path = buf_alloc();
+        os_path_join(dir_path, entries.at(i).name, full_path);
+        if (entries.at(i).is_dir) {
+            collect_zig_files(full_path, out_paths);
+        } else if (buf_ends_with_str(full_path, ".zig")) {
+            out_paths.append(full_path);
+        }
+    }
+    entries.deinit();
+}
+
+static void free_tokenization(Tokenization *tokenization) {
+    for (size_t i = 0; i < tokenization->tokens->length; i += 1) {
+        Token *token = &tokenization->tokens->at(i);
+        if (token->id == TokenIdSymbol || token->id == TokenIdStringLiteral) {
+            buf_deinit(&token->data.str_lit.str);
+        }
+    }
+    tokenization->tokens->deinit();
+    tokenization->line_offsets->deinit();
+    free(tokenization->tokens);
+    free(tokenization->line_offsets);
+}
+
+template<typename K, uint32_t (*HashFunction)(K key), bool (*EqualFn)(K a, K b)>
+static void bench_keys(const char *name, const ZigList<K> &keys) {
+    HashMap<K, size_t, HashFunction, EqualFn> map;
+    map.init(16);
+    for (size_t i = 0; i < keys.length; i += 1) {
+        map.put(keys.at(i), i);
+    }
+
+    size_t passes = 0;
+    size_t found = 0;
+    double start = timestamp_seconds();
+    double elapsed;
+    do {
+        for (size_t i = 0; i < keys.length; i += 1) {
+            found += (map.maybe_get(keys.at(i)) != nullptr);
+        }
+        passes += 1;
+        elapsed = timestamp_seconds() - start;
+    } while (elapsed < min_seconds);
+    if (found != keys.length * passes) {
+        fprintf(stderr, "%s: lookup missed a key\n", name);
+        exit(EXIT_FAILURE);
+    }
+
+    HashMapProbeStats stats = map.probe_stats();
+    double mean = (stats.size == 0) ? 0.0 : (double)stats.total_probe_length / (double)stats.size;
+    double ns = elapsed * 1000000000.0 / (double)(keys.length * passes);
+    fprintf(stdout, "%16s%10d%10d%10.3f%10d", name, stats.size, stats.capacity, mean, stats.max_probe_length);
+    for (int i = 0; i < hash_map_probe_histogram_len; i += 1) {
+        fprintf(stdout, "%10d", stats.histogram[i]);
+    }
+    fprintf(stdout, "%10.2f\n", ns);
+    map.deinit();
+}
+
+int main(int argc, char **argv) {
+    Error err;
+    os_init();
+
+    ZigList<Buf *> paths = {0};
+    if (argc > 1) {
+        for (int i = 1; i < argc; i += 1) {
+            collect_zig_files(buf_create_from_str(argv[i]), paths);
+        }
+    } else {
+        collect_zig_files(buf_create_from_str("std"), paths);
+        collect_zig_files(buf_create_from_str("lib"), paths);
+    }
+    if (paths.length == 0) {
+        fprintf(stderr, "no .zig files found\n");
+        return EXIT_FAILURE;
+    }
+
+    // Each distinct identifier gets its own heap-allocated Buf, the way the
+    // compiler allocates its names, so the Buf addresses double as a
+    // realistic set of pointer keys.
+    HashMap<Buf *, bool, buf_hash, buf_eql_buf> seen;
+    seen.init(1024);
+    ZigList<Buf *> symbols = {0};
+    for (size_t i = 0; i < paths.length; i += 1) {
+        Buf *contents = buf_alloc();
+        if ((err = os_fetch_file_path(paths.at(i), contents))) {
+            fprintf(stderr, "unable to read '%s': %s\n", buf_ptr(paths.at(i)), err_str(err));
+            return EXIT_FAILURE;
+        }
+        Tokenization tokenization = {0};
+        tokenize(contents, &tokenization);
+        for (size_t j = 0; j < tokenization.tokens->length; j += 1) {
+            Token *token = &tokenization.tokens->at(j);
+            if (token->id != TokenIdSymbol)
+                continue;
+            Buf *name = &token->data.str_lit.str;
+            if (buf_len(name) == 0 || seen.maybe_get(name) != nullptr)
+                continue;
+            Buf *symbol = buf_create_from_buf(name);
+            seen.put(symbol, true);
+            symbols.append(symbol);
+        }
+        free_tokenization(&tokenization);
+        buf_deinit(contents);
+        free(contents);
+    }
+    seen.deinit();
+
+    ZigList<const void *> pointers = {0};
+    ZigList<uint64_t> integers = {0};
+    for (size_t i = 0; i < symbols.length; i += 1) {
+        pointers.append(symbols.at(i));
+        integers.append(i);
+    }
+
+    fprintf(stdout, "%zu files, %zu distinct identifiers\n", paths.length, symbols.length);
+    fprintf(stdout, "%16s%10s%10s%10s%10s%10s%10s%10s%10s%10s\n",
+            "keys", "size", "capacity", "mean", "max", "1", "2", "3", "4+", "ns/get");
+    bench_keys<Buf *, old_buf_hash, buf_eql_buf>("buf old", symbols);
+    bench_keys<Buf *, buf_hash, buf_eql_buf>("buf", symbols);
+    bench_keys<const void *, old_ptr_hash, ptr_eq>("ptr old", pointers);
+    bench_keys<const void *, ptr_hash, ptr_eq>("ptr", pointers);
+    bench_keys<uint64_t, old_uint64_hash, uint64_eq>("uint64 old", integers);
+    bench_keys<uint64_t, uint64_hash, uint64_eq>("uint64", integers);
+    return EXIT_SUCCESS;
+}
@@ -6,11 +6,14 @@
  */
 
 #include "analyze.hpp"
+#include "arena.hpp"
 #include "ast_render.hpp"
+#include "codegen.hpp"
 #include "error.hpp"
 #include "ir.hpp"
 #include "ir_print.hpp"
 #include "os.hpp"
+#include "parser.hpp"
 #include "range_set.hpp"
 #include "softfloat.hpp"
 #include "translate_c.hpp"
@@ -26,6 +29,8 @@ struct IrBuilder {
     CodeGen *codegen;
     IrExecutable *exec;
     IrBasicBlock *current_basic_block;
+    // true when building pass1 IR, see ir_create_instruction
+    bool is_pass1;
 };
 
 struct IrAnalyze {
@@ -371,11 +376,11 @@ static bool value_is_comptime(ConstExprValue *const_val) {
 }
 
 static bool instr_is_comptime(IrInstruction *instruction) {
-    return value_is_comptime(&instruction->value);
+    return value_is_comptime(instruction->value);
 }
 
 static bool instr_is_unreachable(IrInstruction *instruction) {
-    return instruction->value.type && instruction->value.type->id == ZigTypeIdUnreachable;
+    return instruction->value->type && instruction->value->type->id == ZigTypeIdUnreachable;
 }
 
 static void ir_link_new_bb(IrBasicBlock *new_bb, IrBasicBlock *old_bb) {
@@ -411,7 +416,7 @@ ZigType *ir_analyze_type_expr(IrAnalyze *ira, Scope *scope, AstNode *node) {
 }
 
 static IrBasicBlock *ir_create_basic_block(IrBuilder *irb, Scope *scope, const char *name_hint) {
-    IrBasicBlock *result = allocate<IrBasicBlock>(1);
+    IrBasicBlock *result = arena_allocate<IrBasicBlock>(&ir_arena, 1);
     result->scope = scope;
     result->name_hint = name_hint;
     result->debug_id = exec_next_debug_id(irb->exec);
@@ -1109,15 +1114,52 @@ static constexpr IrInstructionId ir_instruction_id(IrInstructionUnionInitNamedFi
     return IrInstructionIdUnionInitNamedField;
 }
 
+// In pass1 IR only constants and the instructions whose builders record a type
+// have a value of their own. The rest point at this one, which must stay zeroed,
+// and analysis only ever reads the values of pass1 constants.
+static ConstExprValue ir_pass1_runtime_value;
+
+static bool ir_pass1_instruction_has_value(IrInstructionId id) {
+    switch (id) {
+        case IrInstructionIdConst:
+        case IrInstructionIdBr:
+        case IrInstructionIdCondBr:
+        case IrInstructionIdSwitchBr:
+        case IrInstructionIdReturn:
+        case IrInstructionIdUnreachable:
+        case IrInstructionIdPanic:
+        case IrInstructionIdStore:
+        case IrInstructionIdDeclVarSrc:
+        case IrInstructionIdExport:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void ir_assert_pass1_runtime_value_zeroed(void) {
+    static const ConstExprValue zero_value = {};
+    assert(memcmp(&ir_pass1_runtime_value, &zero_value, sizeof(ConstExprValue)) == 0);
+}
+
 template<typename T>
 static T *ir_create_instruction(IrBuilder *irb, Scope *scope, AstNode *source_node) {
-    T *special_instruction = allocate<T>(1);
+    T *special_instruction = arena_allocate<T>(&ir_arena, 1);
     special_instruction->base.id = ir_instruction_id(special_instruction);
     special_instruction->base.scope = scope;
     special_instruction->base.source_node = source_node;
     special_instruction->base.debug_id = exec_next_debug_id(irb->exec);
     special_instruction->base.owner_bb = irb->current_basic_block;
-    special_instruction->base.value.global_refs = allocate<ConstGlobalRefs>(1);
+    if (current_ir_gen_job != nullptr) {
+        current_ir_gen_job->ir_instructions_created += 1;
+    } else {
+        irb->codegen->ir_instructions_created += 1;
+    }
+    if (irb->is_pass1 && !ir_pass1_instruction_has_value(special_instruction->base.id)) {
+        special_instruction->base.value = &ir_pass1_runtime_value;
+    } else {
+        special_instruction->base.value = create_const_vals(1);
+    }
     return special_instruction;
 }
 
@@ -1145,8 +1187,8 @@ static IrInstruction *ir_build_cond_br(IrBuilder *irb, Scope *scope, AstNode *so
         IrBasicBlock *then_block, IrBasicBlock *else_block, IrInstruction *is_comptime)
 {
     IrInstructionCondBr *cond_br_instruction = ir_build_instruction<IrInstructionCondBr>(irb, scope, source_node);
-    cond_br_instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
-    cond_br_instruction->base.value.special = ConstValSpecialStatic;
+    cond_br_instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
+    cond_br_instruction->base.value->special = ConstValSpecialStatic;
     cond_br_instruction->condition = condition;
     cond_br_instruction->then_block = then_block;
     cond_br_instruction->else_block = else_block;
@@ -1164,8 +1206,8 @@ static IrInstruction *ir_build_return(IrBuilder *irb, Scope *scope, AstNode *sou
         IrInstruction *return_value)
 {
     IrInstructionReturn *return_instruction = ir_build_instruction<IrInstructionReturn>(irb, scope, source_node);
-    return_instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
-    return_instruction->base.value.special = ConstValSpecialStatic;
+    return_instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
+    return_instruction->base.value->special = ConstValSpecialStatic;
     return_instruction->value = return_value;
 
     if (return_value != nullptr) ir_ref_instruction(return_value, irb->current_basic_block);
@@ -1175,62 +1217,62 @@ static IrInstruction *ir_build_return(IrBuilder *irb, Scope *scope, AstNode *sou
 
 static IrInstruction *ir_build_const_void(IrBuilder *irb, Scope *scope, AstNode *source_node) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_void;
-    const_instruction->base.value.special = ConstValSpecialStatic;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_void;
+    const_instruction->base.value->special = ConstValSpecialStatic;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_undefined(IrBuilder *irb, Scope *scope, AstNode *source_node) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.special = ConstValSpecialUndef;
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_undef;
+    const_instruction->base.value->special = ConstValSpecialUndef;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_undef;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_uint(IrBuilder *irb, Scope *scope, AstNode *source_node, uint64_t value) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_num_lit_int;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    bigint_init_unsigned(&const_instruction->base.value.data.x_bigint, value);
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_num_lit_int;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    bigint_init_unsigned(&const_instruction->base.value->data.x_bigint, value);
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_bigint(IrBuilder *irb, Scope *scope, AstNode *source_node, BigInt *bigint) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_num_lit_int;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    bigint_init_bigint(&const_instruction->base.value.data.x_bigint, bigint);
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_num_lit_int;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    bigint_init_bigint(&const_instruction->base.value->data.x_bigint, bigint);
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_bigfloat(IrBuilder *irb, Scope *scope, AstNode *source_node, BigFloat *bigfloat) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_num_lit_float;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    bigfloat_init_bigfloat(&const_instruction->base.value.data.x_bigfloat, bigfloat);
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_num_lit_float;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    bigfloat_init_bigfloat(&const_instruction->base.value->data.x_bigfloat, bigfloat);
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_null(IrBuilder *irb, Scope *scope, AstNode *source_node) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_null;
-    const_instruction->base.value.special = ConstValSpecialStatic;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_null;
+    const_instruction->base.value->special = ConstValSpecialStatic;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_usize(IrBuilder *irb, Scope *scope, AstNode *source_node, uint64_t value) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_usize;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    bigint_init_unsigned(&const_instruction->base.value.data.x_bigint, value);
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_usize;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    bigint_init_unsigned(&const_instruction->base.value->data.x_bigint, value);
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_u8(IrBuilder *irb, Scope *scope, AstNode *source_node, uint8_t value) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_u8;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    bigint_init_unsigned(&const_instruction->base.value.data.x_bigint, value);
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_u8;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    bigint_init_unsigned(&const_instruction->base.value->data.x_bigint, value);
     return &const_instruction->base;
 }
 
@@ -1238,9 +1280,9 @@ static IrInstruction *ir_create_const_type(IrBuilder *irb, Scope *scope, AstNode
         ZigType *type_entry)
 {
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_type;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_type = type_entry;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_type;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_type = type_entry;
     return &const_instruction->base;
 }
 
@@ -1254,35 +1296,35 @@ static IrInstruction *ir_build_const_type(IrBuilder *irb, Scope *scope, AstNode
 
 static IrInstruction *ir_create_const_fn(IrBuilder *irb, Scope *scope, AstNode *source_node, ZigFn *fn_entry) {
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = fn_entry->type_entry;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_ptr.data.fn.fn_entry = fn_entry;
-    const_instruction->base.value.data.x_ptr.mut = ConstPtrMutComptimeConst;
-    const_instruction->base.value.data.x_ptr.special = ConstPtrSpecialFunction;
+    const_instruction->base.value->type = fn_entry->type_entry;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_ptr.data.fn.fn_entry = fn_entry;
+    const_instruction->base.value->data.x_ptr.mut = ConstPtrMutComptimeConst;
+    const_instruction->base.value->data.x_ptr.special = ConstPtrSpecialFunction;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_import(IrBuilder *irb, Scope *scope, AstNode *source_node, ZigType *import) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_type;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_type = import;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_type;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_type = import;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_bool(IrBuilder *irb, Scope *scope, AstNode *source_node, bool value) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_bool;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_bool = value;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_bool;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_bool = value;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_enum_literal(IrBuilder *irb, Scope *scope, AstNode *source_node, Buf *name) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_enum_literal;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_enum_literal = name;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_enum_literal;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_enum_literal = name;
     return &const_instruction->base;
 }
 
@@ -1290,16 +1332,16 @@ static IrInstruction *ir_build_const_bound_fn(IrBuilder *irb, Scope *scope, AstN
     ZigFn *fn_entry, IrInstruction *first_arg)
 {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = get_bound_fn_type(irb->codegen, fn_entry);
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_bound_fn.fn = fn_entry;
-    const_instruction->base.value.data.x_bound_fn.first_arg = first_arg;
+    const_instruction->base.value->type = get_bound_fn_type(irb->codegen, fn_entry);
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_bound_fn.fn = fn_entry;
+    const_instruction->base.value->data.x_bound_fn.first_arg = first_arg;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_create_const_str_lit(IrBuilder *irb, Scope *scope, AstNode *source_node, Buf *str) {
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(irb, scope, source_node);
-    init_const_str_lit(irb->codegen, &const_instruction->base.value, str);
+    init_const_str_lit(irb->codegen, const_instruction->base.value, str);
 
     return &const_instruction->base;
 }
@@ -1311,7 +1353,7 @@ static IrInstruction *ir_build_const_str_lit(IrBuilder *irb, Scope *scope, AstNo
 
 static IrInstruction *ir_build_const_c_str_lit(IrBuilder *irb, Scope *scope, AstNode *source_node, Buf *str) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    init_const_c_str_lit(irb->codegen, &const_instruction->base.value, str);
+    init_const_c_str_lit(irb->codegen, const_instruction->base.value, str);
     return &const_instruction->base;
 }
 
@@ -1349,7 +1391,7 @@ static IrInstruction *ir_build_var_ptr(IrBuilder *irb, Scope *scope, AstNode *so
 static IrInstruction *ir_build_return_ptr(IrAnalyze *ira, IrInstruction *source_instruction, ZigType *ty) {
     IrInstructionReturnPtr *instruction = ir_build_instruction<IrInstructionReturnPtr>(&ira->new_irb,
             source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = ty;
+    instruction->base.value->type = ty;
     return &instruction->base;
 }
 
@@ -1472,7 +1514,7 @@ static IrInstruction *ir_build_call_gen(IrAnalyze *ira, IrInstruction *source_in
 {
     IrInstructionCallGen *call_instruction = ir_build_instruction<IrInstructionCallGen>(&ira->new_irb,
             source_instruction->scope, source_instruction->source_node);
-    call_instruction->base.value.type = return_type;
+    call_instruction->base.value->type = return_type;
     call_instruction->fn_entry = fn_entry;
     call_instruction->fn_ref = fn_ref;
     call_instruction->fn_inline = fn_inline;
@@ -1518,8 +1560,8 @@ static IrInstruction *ir_create_br(IrBuilder *irb, Scope *scope, AstNode *source
         IrBasicBlock *dest_block, IrInstruction *is_comptime)
 {
     IrInstructionBr *br_instruction = ir_create_instruction<IrInstructionBr>(irb, scope, source_node);
-    br_instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
-    br_instruction->base.value.special = ConstValSpecialStatic;
+    br_instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
+    br_instruction->base.value->special = ConstValSpecialStatic;
     br_instruction->dest_block = dest_block;
     br_instruction->is_comptime = is_comptime;
 
@@ -1620,8 +1662,8 @@ static IrInstruction *ir_build_container_init_fields(IrBuilder *irb, Scope *scop
 static IrInstruction *ir_build_unreachable(IrBuilder *irb, Scope *scope, AstNode *source_node) {
     IrInstructionUnreachable *unreachable_instruction =
         ir_build_instruction<IrInstructionUnreachable>(irb, scope, source_node);
-    unreachable_instruction->base.value.special = ConstValSpecialStatic;
-    unreachable_instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
+    unreachable_instruction->base.value->special = ConstValSpecialStatic;
+    unreachable_instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
     return &unreachable_instruction->base;
 }
 
@@ -1629,8 +1671,8 @@ static IrInstruction *ir_build_store(IrBuilder *irb, Scope *scope, AstNode *sour
         IrInstruction *ptr, IrInstruction *value)
 {
     IrInstructionStore *instruction = ir_build_instruction<IrInstructionStore>(irb, scope, source_node);
-    instruction->base.value.special = ConstValSpecialStatic;
-    instruction->base.value.type = irb->codegen->builtin_types.entry_void;
+    instruction->base.value->special = ConstValSpecialStatic;
+    instruction->base.value->type = irb->codegen->builtin_types.entry_void;
     instruction->ptr = ptr;
     instruction->value = value;
 
@@ -1644,8 +1686,8 @@ static IrInstruction *ir_build_var_decl_src(IrBuilder *irb, Scope *scope, AstNod
         ZigVar *var, IrInstruction *align_value, IrInstruction *ptr)
 {
     IrInstructionDeclVarSrc *decl_var_instruction = ir_build_instruction<IrInstructionDeclVarSrc>(irb, scope, source_node);
-    decl_var_instruction->base.value.special = ConstValSpecialStatic;
-    decl_var_instruction->base.value.type = irb->codegen->builtin_types.entry_void;
+    decl_var_instruction->base.value->special = ConstValSpecialStatic;
+    decl_var_instruction->base.value->type = irb->codegen->builtin_types.entry_void;
     decl_var_instruction->var = var;
     decl_var_instruction->align_value = align_value;
     decl_var_instruction->ptr = ptr;
@@ -1661,8 +1703,8 @@ static IrInstruction *ir_build_var_decl_gen(IrAnalyze *ira, IrInstruction *sourc
 {
     IrInstructionDeclVarGen *decl_var_instruction = ir_build_instruction<IrInstructionDeclVarGen>(&ira->new_irb,
             source_instruction->scope, source_instruction->source_node);
-    decl_var_instruction->base.value.special = ConstValSpecialStatic;
-    decl_var_instruction->base.value.type = ira->codegen->builtin_types.entry_void;
+    decl_var_instruction->base.value->special = ConstValSpecialStatic;
+    decl_var_instruction->base.value->type = ira->codegen->builtin_types.entry_void;
     decl_var_instruction->var = var;
     decl_var_instruction->var_ptr = var_ptr;
 
@@ -1676,7 +1718,7 @@ static IrInstruction *ir_build_resize_slice(IrAnalyze *ira, IrInstruction *sourc
 {
     IrInstructionResizeSlice *instruction = ir_build_instruction<IrInstructionResizeSlice>(&ira->new_irb,
             source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = ty;
+    instruction->base.value->type = ty;
     instruction->operand = operand;
     instruction->result_loc = result_loc;
 
@@ -1691,8 +1733,8 @@ static IrInstruction *ir_build_export(IrBuilder *irb, Scope *scope, AstNode *sou
 {
     IrInstructionExport *export_instruction = ir_build_instruction<IrInstructionExport>(
             irb, scope, source_node);
-    export_instruction->base.value.special = ConstValSpecialStatic;
-    export_instruction->base.value.type = irb->codegen->builtin_types.entry_void;
+    export_instruction->base.value->special = ConstValSpecialStatic;
+    export_instruction->base.value->type = irb->codegen->builtin_types.entry_void;
     export_instruction->name = name;
     export_instruction->target = target;
     export_instruction->linkage = linkage;
@@ -1882,7 +1924,7 @@ static IrInstruction *ir_build_optional_wrap(IrAnalyze *ira, IrInstruction *sour
 {
     IrInstructionOptionalWrap *instruction = ir_build_instruction<IrInstructionOptionalWrap>(
             &ira->new_irb, source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = result_ty;
+    instruction->base.value->type = result_ty;
     instruction->operand = operand;
     instruction->result_loc = result_loc;
 
@@ -1897,7 +1939,7 @@ static IrInstruction *ir_build_err_wrap_payload(IrAnalyze *ira, IrInstruction *s
 {
     IrInstructionErrWrapPayload *instruction = ir_build_instruction<IrInstructionErrWrapPayload>(
             &ira->new_irb, source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = result_type;
+    instruction->base.value->type = result_type;
     instruction->operand = operand;
     instruction->result_loc = result_loc;
 
@@ -1912,7 +1954,7 @@ static IrInstruction *ir_build_err_wrap_code(IrAnalyze *ira, IrInstruction *sour
 {
     IrInstructionErrWrapCode *instruction = ir_build_instruction<IrInstructionErrWrapCode>(
             &ira->new_irb, source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = result_type;
+    instruction->base.value->type = result_type;
     instruction->operand = operand;
     instruction->result_loc = result_loc;
 
@@ -1982,8 +2024,8 @@ static IrInstructionSwitchBr *ir_build_switch_br(IrBuilder *irb, Scope *scope, A
         IrInstruction *switch_prongs_void)
 {
     IrInstructionSwitchBr *instruction = ir_build_instruction<IrInstructionSwitchBr>(irb, scope, source_node);
-    instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
-    instruction->base.value.special = ConstValSpecialStatic;
+    instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
+    instruction->base.value->special = ConstValSpecialStatic;
     instruction->target_value = target_value;
     instruction->else_block = else_block;
     instruction->case_count = case_count;
@@ -2079,7 +2121,7 @@ static IrInstruction *ir_build_ref_gen(IrAnalyze *ira, IrInstruction *source_ins
 {
     IrInstructionRefGen *instruction = ir_build_instruction<IrInstructionRefGen>(&ira->new_irb,
             source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = result_type;
+    instruction->base.value->type = result_type;
     instruction->operand = operand;
     instruction->result_loc = result_loc;
 
@@ -2194,7 +2236,7 @@ static IrInstruction *ir_build_cmpxchg_gen(IrAnalyze *ira, IrInstruction *source
 {
     IrInstructionCmpxchgGen *instruction = ir_build_instruction<IrInstructionCmpxchgGen>(&ira->new_irb,
             source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = result_type;
+    instruction->base.value->type = result_type;
     instruction->ptr = ptr;
     instruction->cmp_value = cmp_value;
     instruction->new_value = new_value;
@@ -2437,7 +2479,7 @@ static IrInstruction *ir_build_slice_gen(IrAnalyze *ira, IrInstruction *source_i
 {
     IrInstructionSliceGen *instruction = ir_build_instruction<IrInstructionSliceGen>(
             &ira->new_irb, source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = slice_type;
+    instruction->base.value->type = slice_type;
     instruction->ptr = ptr;
     instruction->start = start;
     instruction->end = end;
@@ -2622,7 +2664,7 @@ static IrInstruction *ir_build_test_err_gen(IrAnalyze *ira, IrInstruction *sourc
 {
     IrInstructionTestErrGen *instruction = ir_build_instruction<IrInstructionTestErrGen>(
             &ira->new_irb, source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = ira->codegen->builtin_types.entry_bool;
+    instruction->base.value->type = ira->codegen->builtin_types.entry_bool;
     instruction->err_union = err_union;
 
     ir_ref_instruction(err_union, ira->new_irb.current_basic_block);
@@ -2707,7 +2749,7 @@ static IrInstruction *ir_build_ptr_cast_gen(IrAnalyze *ira, IrInstruction *sourc
 {
     IrInstructionPtrCastGen *instruction = ir_build_instruction<IrInstructionPtrCastGen>(
             &ira->new_irb, source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = ptr_type;
+    instruction->base.value->type = ptr_type;
     instruction->ptr = ptr;
     instruction->safety_check_on = safety_check_on;
 
@@ -2721,7 +2763,7 @@ static IrInstruction *ir_build_load_ptr_gen(IrAnalyze *ira, IrInstruction *sourc
 {
     IrInstructionLoadPtrGen *instruction = ir_build_instruction<IrInstructionLoadPtrGen>(
             &ira->new_irb, source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = ty;
+    instruction->base.value->type = ty;
     instruction->ptr = ptr;
     instruction->result_loc = result_loc;
 
@@ -2748,7 +2790,7 @@ static IrInstruction *ir_build_bit_cast_gen(IrAnalyze *ira, IrInstruction *sourc
 {
     IrInstructionBitCastGen *instruction = ir_build_instruction<IrInstructionBitCastGen>(
             &ira->new_irb, source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = ty;
+    instruction->base.value->type = ty;
     instruction->operand = operand;
 
     ir_ref_instruction(operand, ira->new_irb.current_basic_block);
@@ -2900,8 +2942,8 @@ static IrInstruction *ir_build_decl_ref(IrBuilder *irb, Scope *scope, AstNode *s
 
 static IrInstruction *ir_build_panic(IrBuilder *irb, Scope *scope, AstNode *source_node, IrInstruction *msg) {
     IrInstructionPanic *instruction = ir_build_instruction<IrInstructionPanic>(irb, scope, source_node);
-    instruction->base.value.special = ConstValSpecialStatic;
-    instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
+    instruction->base.value->special = ConstValSpecialStatic;
+    instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
     instruction->msg = msg;
 
     ir_ref_instruction(msg, irb->current_basic_block);
@@ -3045,6 +3087,13 @@ static IrInstruction *ir_build_resolve_result(IrBuilder *irb, Scope *scope, AstN
     return &instruction->base;
 }
 
+template<typename T>
+static T *ir_create_result_loc(IrBuilder *irb) {
+    T *result_loc = allocate<T>(1);
+    irb->exec->result_loc_list.append(&result_loc->base);
+    return result_loc;
+}
+
 static IrInstruction *ir_build_reset_result(IrBuilder *irb, Scope *scope, AstNode *source_node,
         ResultLoc *result_loc)
 {
@@ -3173,8 +3222,8 @@ static IrInstruction *ir_build_coro_begin(IrBuilder *irb, Scope *scope, AstNode
 
 static IrInstruction *ir_build_coro_alloc_fail(IrBuilder *irb, Scope *scope, AstNode *source_node, IrInstruction *err_val) {
     IrInstructionCoroAllocFail *instruction = ir_build_instruction<IrInstructionCoroAllocFail>(irb, scope, source_node);
-    instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
-    instruction->base.value.special = ConstValSpecialStatic;
+    instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
+    instruction->base.value->special = ConstValSpecialStatic;
     instruction->err_val = err_val;
 
     ir_ref_instruction(err_val, irb->current_basic_block);
@@ -3416,7 +3465,7 @@ static IrInstruction *ir_build_vector_to_array(IrAnalyze *ira, IrInstruction *so
 {
     IrInstructionVectorToArray *instruction = ir_build_instruction<IrInstructionVectorToArray>(&ira->new_irb,
         source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = result_type;
+    instruction->base.value->type = result_type;
     instruction->vector = vector;
     instruction->result_loc = result_loc;
 
@@ -3431,7 +3480,7 @@ static IrInstruction *ir_build_ptr_of_array_to_slice(IrAnalyze *ira, IrInstructi
 {
     IrInstructionPtrOfArrayToSlice *instruction = ir_build_instruction<IrInstructionPtrOfArrayToSlice>(&ira->new_irb,
         source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = result_type;
+    instruction->base.value->type = result_type;
     instruction->operand = operand;
     instruction->result_loc = result_loc;
 
@@ -3446,7 +3495,7 @@ static IrInstruction *ir_build_array_to_vector(IrAnalyze *ira, IrInstruction *so
 {
     IrInstructionArrayToVector *instruction = ir_build_instruction<IrInstructionArrayToVector>(&ira->new_irb,
         source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = result_type;
+    instruction->base.value->type = result_type;
     instruction->array = array;
 
     ir_ref_instruction(array, ira->new_irb.current_basic_block);
@@ -3459,7 +3508,7 @@ static IrInstruction *ir_build_assert_zero(IrAnalyze *ira, IrInstruction *source
 {
     IrInstructionAssertZero *instruction = ir_build_instruction<IrInstructionAssertZero>(&ira->new_irb,
         source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = ira->codegen->builtin_types.entry_void;
+    instruction->base.value->type = ira->codegen->builtin_types.entry_void;
     instruction->target = target;
 
     ir_ref_instruction(target, ira->new_irb.current_basic_block);
@@ -3472,7 +3521,7 @@ static IrInstruction *ir_build_assert_non_null(IrAnalyze *ira, IrInstruction *so
 {
     IrInstructionAssertNonNull *instruction = ir_build_instruction<IrInstructionAssertNonNull>(&ira->new_irb,
         source_instruction->scope, source_instruction->source_node);
-    instruction->base.value.type = ira->codegen->builtin_types.entry_void;
+    instruction->base.value->type = ira->codegen->builtin_types.entry_void;
     instruction->target = target;
 
     ir_ref_instruction(target, ira->new_irb.current_basic_block);
@@ -3579,8 +3628,8 @@ static bool ir_gen_defers_for_block(IrBuilder *irb, Scope *inner_scope, Scope *o
                     Scope *defer_expr_scope = defer_node->data.defer.expr_scope;
                     IrInstruction *defer_expr_value = ir_gen_node(irb, defer_expr_node, defer_expr_scope);
                     if (defer_expr_value != irb->codegen->invalid_instruction) {
-                        if (defer_expr_value->value.type != nullptr &&
-                                defer_expr_value->value.type->id == ZigTypeIdUnreachable)
+                        if (defer_expr_value->value->type != nullptr &&
+                                defer_expr_value->value->type->id == ZigTypeIdUnreachable)
                         {
                             is_noreturn = true;
                         } else {
@@ -3732,7 +3781,7 @@ static IrInstruction *ir_gen_return(IrBuilder *irb, Scope *scope, AstNode *node,
     switch (node->data.return_expr.kind) {
         case ReturnKindUnconditional:
             {
-                ResultLocReturn *result_loc_ret = allocate<ResultLocReturn>(1);
+                ResultLocReturn *result_loc_ret = ir_create_result_loc<ResultLocReturn>(irb);
                 result_loc_ret->base.id = ResultLocIdReturn;
                 ir_build_reset_result(irb, scope, node, &result_loc_ret->base);
 
@@ -3825,7 +3874,7 @@ static IrInstruction *ir_gen_return(IrBuilder *irb, Scope *scope, AstNode *node,
                     IrInstruction *err_val_ptr = ir_build_unwrap_err_code(irb, scope, node, err_union_ptr);
                     IrInstruction *err_val = ir_build_load(irb, scope, node, err_val_ptr);
 
-                    ResultLocReturn *result_loc_ret = allocate<ResultLocReturn>(1);
+                    ResultLocReturn *result_loc_ret = ir_create_result_loc<ResultLocReturn>(irb);
                     result_loc_ret->base.id = ResultLocIdReturn;
                     ir_build_reset_result(irb, scope, node, &result_loc_ret->base);
                     ir_build_end_expr(irb, scope, node, err_val, &result_loc_ret->base);
@@ -3918,6 +3967,7 @@ static ZigVar *ir_create_var(IrBuilder *irb, AstNode *node, Scope *scope, Buf *n
     ZigVar *var = create_local_var(irb->codegen, node, scope,
             (is_underscored ? nullptr : name), src_is_const, gen_is_const,
             (is_underscored ? true : is_shadowable), is_comptime, false);
+    irb->exec->var_list.append(var);
     if (is_comptime != nullptr || gen_is_const) {
         var->mem_slot_index = exec_next_mem_slot(irb->exec);
         var->owner_exec = irb->exec;
@@ -3965,7 +4015,7 @@ static IrInstruction *ir_gen_block(IrBuilder *irb, Scope *parent_scope, AstNode
         scope_block->is_comptime = ir_build_const_bool(irb, parent_scope, block_node,
                 ir_should_inline(irb->exec, parent_scope));
 
-        scope_block->peer_parent = allocate<ResultLocPeerParent>(1);
+        scope_block->peer_parent = ir_create_result_loc<ResultLocPeerParent>(irb);
         scope_block->peer_parent->base.id = ResultLocIdPeerParent;
         scope_block->peer_parent->base.source_instruction = scope_block->is_comptime;
         scope_block->peer_parent->end_bb = scope_block->end_block;
@@ -4171,7 +4221,7 @@ static IrInstruction *ir_gen_bool_and(IrBuilder *irb, Scope *scope, AstNode *nod
 static ResultLocPeerParent *ir_build_result_peers(IrBuilder *irb, IrInstruction *cond_br_inst,
         IrBasicBlock *end_block, ResultLoc *parent, IrInstruction *is_comptime)
 {
-    ResultLocPeerParent *peer_parent = allocate<ResultLocPeerParent>(1);
+    ResultLocPeerParent *peer_parent = ir_create_result_loc<ResultLocPeerParent>(irb);
     peer_parent->base.id = ResultLocIdPeerParent;
     peer_parent->base.source_instruction = cond_br_inst;
     peer_parent->end_bb = end_block;
@@ -4409,7 +4459,7 @@ static void populate_invalid_variable_in_scope(CodeGen *g, Scope *scope, AstNode
     init_tld(&tld_var->base, TldIdVar, var_name, VisibModPub, node, &scope_decls->base);
     tld_var->base.resolution = TldResolutionInvalid;
     tld_var->var = add_variable(g, node, &scope_decls->base, var_name, false,
-            &g->invalid_instruction->value, &tld_var->base, g->builtin_types.entry_invalid);
+            g->invalid_instruction->value, &tld_var->base, g->builtin_types.entry_invalid);
     scope_decls->decl_table.put(var_name, &tld_var->base);
 }
 
@@ -4422,10 +4472,10 @@ static IrInstruction *ir_gen_symbol(IrBuilder *irb, Scope *scope, AstNode *node,
     if (buf_eql_str(variable_name, "_")) {
         if (lval == LValPtr) {
             IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, node);
-            const_instruction->base.value.type = get_pointer_to_type(irb->codegen,
+            const_instruction->base.value->type = get_pointer_to_type(irb->codegen,
                     irb->codegen->builtin_types.entry_void, false);
-            const_instruction->base.value.special = ConstValSpecialStatic;
-            const_instruction->base.value.data.x_ptr.special = ConstPtrSpecialDiscard;
+            const_instruction->base.value->special = ConstValSpecialStatic;
+            const_instruction->base.value->data.x_ptr.special = ConstPtrSpecialDiscard;
             return &const_instruction->base;
         } else {
             add_node_error(irb->codegen, node, buf_sprintf("`_` may only be used to assign things to"));
@@ -5351,7 +5401,7 @@ static IrInstruction *ir_gen_builtin_fn_call(IrBuilder *irb, Scope *scope, AstNo
                 if (dest_type == irb->codegen->invalid_instruction)
                     return dest_type;
 
-                ResultLocBitCast *result_loc_bit_cast = allocate<ResultLocBitCast>(1);
+                ResultLocBitCast *result_loc_bit_cast = ir_create_result_loc<ResultLocBitCast>(irb);
                 result_loc_bit_cast->base.id = ResultLocIdBitCast;
                 result_loc_bit_cast->base.source_instruction = dest_type;
                 ir_ref_instruction(dest_type, irb->current_basic_block);
@@ -6084,7 +6134,7 @@ static IrInstruction *ir_gen_union_init_expr(IrBuilder *irb, Scope *scope, AstNo
     IrInstruction *field_ptr = ir_build_field_ptr_instruction(irb, scope, source_node, container_ptr,
             field_name, true);
 
-    ResultLocInstruction *result_loc_inst = allocate<ResultLocInstruction>(1);
+    ResultLocInstruction *result_loc_inst = ir_create_result_loc<ResultLocInstruction>(irb);
     result_loc_inst->base.id = ResultLocIdInstruction;
     result_loc_inst->base.source_instruction = field_ptr;
     ir_ref_instruction(field_ptr, irb->current_basic_block);
@@ -6142,7 +6192,7 @@ static IrInstruction *ir_gen_container_init_expr(IrBuilder *irb, Scope *scope, A
                 AstNode *expr_node = entry_node->data.struct_val_field.expr;
 
                 IrInstruction *field_ptr = ir_build_field_ptr(irb, scope, entry_node, container_ptr, name, true);
-                ResultLocInstruction *result_loc_inst = allocate<ResultLocInstruction>(1);
+                ResultLocInstruction *result_loc_inst = ir_create_result_loc<ResultLocInstruction>(irb);
                 result_loc_inst->base.id = ResultLocIdInstruction;
                 result_loc_inst->base.source_instruction = field_ptr;
                 ir_ref_instruction(field_ptr, irb->current_basic_block);
@@ -6180,7 +6230,7 @@ static IrInstruction *ir_gen_container_init_expr(IrBuilder *irb, Scope *scope, A
                 IrInstruction *elem_index = ir_build_const_usize(irb, scope, expr_node, i);
                 IrInstruction *elem_ptr = ir_build_elem(irb, scope, expr_node, container_ptr, elem_index,
                         false, PtrLenSingle, container_type);
-                ResultLocInstruction *result_loc_inst = allocate<ResultLocInstruction>(1);
+                ResultLocInstruction *result_loc_inst = ir_create_result_loc<ResultLocInstruction>(irb);
                 result_loc_inst->base.id = ResultLocIdInstruction;
                 result_loc_inst->base.source_instruction = elem_ptr;
                 ir_ref_instruction(elem_ptr, irb->current_basic_block);
@@ -6202,7 +6252,7 @@ static IrInstruction *ir_gen_container_init_expr(IrBuilder *irb, Scope *scope, A
 }
 
 static ResultLocVar *ir_build_var_result_loc(IrBuilder *irb, IrInstruction *alloca, ZigVar *var) {
-    ResultLocVar *result_loc_var = allocate<ResultLocVar>(1);
+    ResultLocVar *result_loc_var = ir_create_result_loc<ResultLocVar>(irb);
     result_loc_var->base.id = ResultLocIdVar;
     result_loc_var->base.source_instruction = alloca;
     result_loc_var->var = var;
@@ -7326,7 +7376,7 @@ static IrInstruction *ir_gen_switch_expr(IrBuilder *irb, Scope *scope, AstNode *
 
     IrInstructionSwitchElseVar *switch_else_var = nullptr;
 
-    ResultLocPeerParent *peer_parent = allocate<ResultLocPeerParent>(1);
+    ResultLocPeerParent *peer_parent = ir_create_result_loc<ResultLocPeerParent>(irb);
     peer_parent->base.id = ResultLocIdPeerParent;
     peer_parent->end_bb = end_block;
     peer_parent->is_comptime = is_comptime;
@@ -8683,7 +8733,9 @@ static IrInstruction *ir_gen_node_extra(IrBuilder *irb, AstNode *node, Scope *sc
     if (result_loc == nullptr) {
         // Create a result location indicating there is none - but if one gets created
         // it will be properly distributed.
-        result_loc = no_result_loc();
+        ResultLocNone *result_loc_none = ir_create_result_loc<ResultLocNone>(irb);
+        result_loc_none->base.id = ResultLocIdNone;
+        result_loc = &result_loc_none->base;
         ir_build_reset_result(irb, scope, node, result_loc);
     }
     IrInstruction *result = ir_gen_node_raw(irb, node, scope, lval, result_loc);
@@ -8718,6 +8770,7 @@ bool ir_gen(CodeGen *codegen, AstNode *node, Scope *scope, IrExecutable *ir_exec
 
     irb->codegen = codegen;
     irb->exec = ir_executable;
+    irb->is_pass1 = true;
 
     IrBasicBlock *entry_block = ir_create_basic_block(irb, scope, "Entry");
     ir_set_cursor_at_end_and_append_block(irb, entry_block);
@@ -8830,6 +8883,7 @@ bool ir_gen(CodeGen *codegen, AstNode *node, Scope *scope, IrExecutable *ir_exec
 
     IrInstruction *result = ir_gen_node_extra(irb, node, scope, LValNone, nullptr);
     assert(result);
+    ir_assert_pass1_runtime_value_zeroed();
     if (irb->exec->invalid)
         return false;
 
@@ -8949,6 +9003,7 @@ bool ir_gen(CodeGen *codegen, AstNode *node, Scope *scope, IrExecutable *ir_exec
         ir_build_br(irb, scope, node, irb->exec->coro_suspend_block, const_bool_false);
     }
 
+    ir_assert_pass1_runtime_value_zeroed();
     return true;
 }
 
@@ -9039,12 +9094,12 @@ static ConstExprValue *ir_exec_const_result(CodeGen *codegen, IrExecutable *exec
         if (instruction->id == IrInstructionIdReturn) {
             IrInstructionReturn *ret_inst = (IrInstructionReturn *)instruction;
             IrInstruction *value = ret_inst->value;
-            if (value->value.special == ConstValSpecialRuntime) {
+            if (value->value->special == ConstValSpecialRuntime) {
                 exec_add_error_node(codegen, exec, value->source_node,
                         buf_sprintf("unable to evaluate constant expression"));
-                return &codegen->invalid_instruction->value;
+                return codegen->invalid_instruction->value;
             }
-            return &value->value;
+            return value->value;
         } else if (ir_has_side_effects(instruction)) {
             if (instr_is_comptime(instruction)) {
                 switch (instruction->id) {
@@ -9057,7 +9112,7 @@ static ConstExprValue *ir_exec_const_result(CodeGen *codegen, IrExecutable *exec
             }
             exec_add_error_node(codegen, exec, instruction->source_node,
                     buf_sprintf("unable to evaluate constant expression"));
-            return &codegen->invalid_instruction->value;
+            return codegen->invalid_instruction->value;
         }
     }
     zig_unreachable();
@@ -10406,13 +10461,13 @@ static ZigType *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_node, ZigT
     size_t i = 0;
     for (;;) {
         prev_inst = instructions[i];
-        if (type_is_invalid(prev_inst->value.type)) {
+        if (type_is_invalid(prev_inst->value->type)) {
             return ira->codegen->builtin_types.entry_invalid;
         }
-        if (prev_inst->value.type->id == ZigTypeIdUnreachable) {
+        if (prev_inst->value->type->id == ZigTypeIdUnreachable) {
             i += 1;
             if (i == instruction_count) {
-                return prev_inst->value.type;
+                return prev_inst->value->type;
             }
             continue;
         }
@@ -10421,14 +10476,14 @@ static ZigType *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_node, ZigT
     ErrorTableEntry **errors = nullptr;
     size_t errors_count = 0;
     ZigType *err_set_type = nullptr;
-    if (prev_inst->value.type->id == ZigTypeIdErrorSet) {
-        if (!resolve_inferred_error_set(ira->codegen, prev_inst->value.type, prev_inst->source_node)) {
+    if (prev_inst->value->type->id == ZigTypeIdErrorSet) {
+        if (!resolve_inferred_error_set(ira->codegen, prev_inst->value->type, prev_inst->source_node)) {
             return ira->codegen->builtin_types.entry_invalid;
         }
-        if (type_is_global_error_set(prev_inst->value.type)) {
+        if (type_is_global_error_set(prev_inst->value->type)) {
             err_set_type = ira->codegen->builtin_types.entry_global_error_set;
         } else {
-            err_set_type = prev_inst->value.type;
+            err_set_type = prev_inst->value->type;
             update_errors_helper(ira->codegen, &errors, &errors_count);
 
             for (uint32_t i = 0; i < err_set_type->data.error_set.err_count; i += 1) {
@@ -10439,12 +10494,12 @@ static ZigType *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_node, ZigT
         }
     }
 
-    bool any_are_null = (prev_inst->value.type->id == ZigTypeIdNull);
+    bool any_are_null = (prev_inst->value->type->id == ZigTypeIdNull);
     bool convert_to_const_slice = false;
     for (; i < instruction_count; i += 1) {
         IrInstruction *cur_inst = instructions[i];
-        ZigType *cur_type = cur_inst->value.type;
-        ZigType *prev_type = prev_inst->value.type;
+        ZigType *cur_type = cur_inst->value->type;
+        ZigType *prev_type = prev_inst->value->type;
 
         if (type_is_invalid(cur_type)) {
             return cur_type;
@@ -10730,20 +10785,20 @@ static ZigType *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_node, ZigT
         }
 
         if (prev_type->id == ZigTypeIdEnum && cur_type->id == ZigTypeIdEnumLiteral) {
-            TypeEnumField *field = find_enum_type_field(prev_type, cur_inst->value.data.x_enum_literal);
+            TypeEnumField *field = find_enum_type_field(prev_type, cur_inst->value->data.x_enum_literal);
             if (field != nullptr) {
                 continue;
             }
         }
         if (is_tagged_union(prev_type) && cur_type->id == ZigTypeIdEnumLiteral) {
-            TypeUnionField *field = find_union_type_field(prev_type, cur_inst->value.data.x_enum_literal);
+            TypeUnionField *field = find_union_type_field(prev_type, cur_inst->value->data.x_enum_literal);
             if (field != nullptr) {
                 continue;
             }
         }
 
         if (cur_type->id == ZigTypeIdEnum && prev_type->id == ZigTypeIdEnumLiteral) {
-            TypeEnumField *field = find_enum_type_field(cur_type, prev_inst->value.data.x_enum_literal);
+            TypeEnumField *field = find_enum_type_field(cur_type, prev_inst->value->data.x_enum_literal);
             if (field != nullptr) {
                 prev_inst = cur_inst;
                 continue;
@@ -10751,7 +10806,7 @@ static ZigType *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_node, ZigT
         }
 
         if (is_tagged_union(cur_type) && prev_type->id == ZigTypeIdEnumLiteral) {
-            TypeUnionField *field = find_union_type_field(cur_type, prev_inst->value.data.x_enum_literal);
+            TypeUnionField *field = find_union_type_field(cur_type, prev_inst->value->data.x_enum_literal);
             if (field != nullptr) {
                 prev_inst = cur_inst;
                 continue;
@@ -10984,9 +11039,9 @@ static ZigType *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_node, ZigT
     free(errors);
 
     if (convert_to_const_slice) {
-        assert(prev_inst->value.type->id == ZigTypeIdArray);
+        assert(prev_inst->value->type->id == ZigTypeIdArray);
         ZigType *ptr_type = get_pointer_to_type_extra(
-                ira->codegen, prev_inst->value.type->data.array.child_type,
+                ira->codegen, prev_inst->value->type->data.array.child_type,
                 true, false, PtrLenUnknown,
                 0, 0, 0, false);
         ZigType *slice_type = get_slice_type(ira->codegen, ptr_type);
@@ -10996,10 +11051,10 @@ static ZigType *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_node, ZigT
             return slice_type;
         }
     } else if (err_set_type != nullptr) {
-        if (prev_inst->value.type->id == ZigTypeIdErrorSet) {
+        if (prev_inst->value->type->id == ZigTypeIdErrorSet) {
             return err_set_type;
-        } else if (prev_inst->value.type->id == ZigTypeIdErrorUnion) {
-            ZigType *payload_type = prev_inst->value.type->data.error_union.payload_type;
+        } else if (prev_inst->value->type->id == ZigTypeIdErrorUnion) {
+            ZigType *payload_type = prev_inst->value->type->data.error_union.payload_type;
             if ((err = type_resolve(ira->codegen, payload_type, ResolveStatusSizeKnown)))
                 return ira->codegen->builtin_types.entry_invalid;
             return get_error_union_type(ira->codegen, err_set_type, payload_type);
@@ -11009,44 +11064,51 @@ static ZigType *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_node, ZigT
                 return ira->codegen->builtin_types.entry_invalid;
             return get_error_union_type(ira->codegen, err_set_type, payload_type);
         } else {
-            if (prev_inst->value.type->id == ZigTypeIdComptimeInt ||
-                prev_inst->value.type->id == ZigTypeIdComptimeFloat)
+            if (prev_inst->value->type->id == ZigTypeIdComptimeInt ||
+                prev_inst->value->type->id == ZigTypeIdComptimeFloat)
             {
                 ir_add_error_node(ira, source_node,
                     buf_sprintf("unable to make error union out of number literal"));
                 return ira->codegen->builtin_types.entry_invalid;
-            } else if (prev_inst->value.type->id == ZigTypeIdNull) {
+            } else if (prev_inst->value->type->id == ZigTypeIdNull) {
                 ir_add_error_node(ira, source_node,
                     buf_sprintf("unable to make error union out of null literal"));
                 return ira->codegen->builtin_types.entry_invalid;
             } else {
-                if ((err = type_resolve(ira->codegen, prev_inst->value.type, ResolveStatusSizeKnown)))
+                if ((err = type_resolve(ira->codegen, prev_inst->value->type, ResolveStatusSizeKnown)))
                     return ira->codegen->builtin_types.entry_invalid;
-                return get_error_union_type(ira->codegen, err_set_type, prev_inst->value.type);
+                return get_error_union_type(ira->codegen, err_set_type, prev_inst->value->type);
             }
         }
-    } else if (any_are_null && prev_inst->value.type->id != ZigTypeIdNull) {
-        if (prev_inst->value.type->id == ZigTypeIdComptimeInt ||
-            prev_inst->value.type->id == ZigTypeIdComptimeFloat)
+    } else if (any_are_null && prev_inst->value->type->id != ZigTypeIdNull) {
+        if (prev_inst->value->type->id == ZigTypeIdComptimeInt ||
+            prev_inst->value->type->id == ZigTypeIdComptimeFloat)
         {
             ir_add_error_node(ira, source_node,
                 buf_sprintf("unable to make maybe out of number literal"));
             return ira->codegen->builtin_types.entry_invalid;
-        } else if (prev_inst->value.type->id == ZigTypeIdOptional) {
-            return prev_inst->value.type;
+        } else if (prev_inst->value->type->id == ZigTypeIdOptional) {
+            return prev_inst->value->type;
         } else {
-            if ((err = type_resolve(ira->codegen, prev_inst->value.type, ResolveStatusSizeKnown)))
+            if ((err = type_resolve(ira->codegen, prev_inst->value->type, ResolveStatusSizeKnown)))
                 return ira->codegen->builtin_types.entry_invalid;
-            return get_optional_type(ira->codegen, prev_inst->value.type);
+            return get_optional_type(ira->codegen, prev_inst->value->type);
         }
     } else {
-        return prev_inst->value.type;
+        return prev_inst->value->type;
     }
 }
 
 static void copy_const_val(ConstExprValue *dest, ConstExprValue *src, bool same_global_refs) {
     ConstGlobalRefs *global_refs = dest->global_refs;
     memcpy(dest, src, sizeof(ConstExprValue));
+    if (src->special == ConstValSpecialStatic && src->type->id == ZigTypeIdArray &&
+        src->data.x_array.special == ConstArraySpecialBuf)
+    {
+        // Both arrays refer to the bytes now, so neither may write them in place.
+        src->data.x_array.buf_owner = nullptr;
+        dest->data.x_array.buf_owner = nullptr;
+    }
     if (!same_global_refs) {
         dest->global_refs = global_refs;
         if (src->special == ConstValSpecialUndef)
@@ -11060,6 +11122,17 @@ static void copy_const_val(ConstExprValue *dest, ConstExprValue *src, bool same_
     }
 }
 
+// Returns the bytes of a packed u8 array for writing, copying them first
+// unless the array already owns them.
+static Buf *ir_own_packed_bytes(ConstExprValue *array_val) {
+    assert(array_val->data.x_array.special == ConstArraySpecialBuf);
+    if (array_val->data.x_array.buf_owner != array_val) {
+        array_val->data.x_array.data.s_buf = buf_create_from_buf(array_val->data.x_array.data.s_buf);
+        array_val->data.x_array.buf_owner = array_val;
+    }
+    return array_val->data.x_array.data.s_buf;
+}
+
 static bool eval_const_expr_implicit_cast(IrAnalyze *ira, IrInstruction *source_instr,
         CastOp cast_op,
         ConstExprValue *other_val, ZigType *other_type,
@@ -11166,8 +11239,8 @@ static IrInstruction *ir_const(IrAnalyze *ira, IrInstruction *old_instruction, Z
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
             old_instruction->scope, old_instruction->source_node);
     IrInstruction *new_instruction = &const_instruction->base;
-    new_instruction->value.type = ty;
-    new_instruction->value.special = ConstValSpecialStatic;
+    new_instruction->value->type = ty;
+    new_instruction->value->special = ConstValSpecialStatic;
     return new_instruction;
 }
 
@@ -11176,15 +11249,15 @@ static IrInstruction *ir_resolve_cast(IrAnalyze *ira, IrInstruction *source_inst
 {
     if (instr_is_comptime(value) || !type_has_bits(wanted_type)) {
         IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-        if (!eval_const_expr_implicit_cast(ira, source_instr, cast_op, &value->value, value->value.type,
-            &result->value, wanted_type))
+        if (!eval_const_expr_implicit_cast(ira, source_instr, cast_op, value->value, value->value->type,
+            result->value, wanted_type))
         {
             return ira->codegen->invalid_instruction;
         }
         return result;
     } else {
         IrInstruction *result = ir_build_cast(&ira->new_irb, source_instr->scope, source_instr->source_node, wanted_type, value, cast_op);
-        result->value.type = wanted_type;
+        result->value->type = wanted_type;
         return result;
     }
 }
@@ -11192,36 +11265,36 @@ static IrInstruction *ir_resolve_cast(IrAnalyze *ira, IrInstruction *source_inst
 static IrInstruction *ir_resolve_ptr_of_array_to_unknown_len_ptr(IrAnalyze *ira, IrInstruction *source_instr,
         IrInstruction *value, ZigType *wanted_type)
 {
-    assert(value->value.type->id == ZigTypeIdPointer);
+    assert(value->value->type->id == ZigTypeIdPointer);
 
     Error err;
 
-    if ((err = type_resolve(ira->codegen, value->value.type->data.pointer.child_type,
+    if ((err = type_resolve(ira->codegen, value->value->type->data.pointer.child_type,
                     ResolveStatusAlignmentKnown)))
     {
         return ira->codegen->invalid_instruction;
     }
 
-    wanted_type = adjust_ptr_align(ira->codegen, wanted_type, get_ptr_align(ira->codegen, value->value.type));
+    wanted_type = adjust_ptr_align(ira->codegen, wanted_type, get_ptr_align(ira->codegen, value->value->type));
 
     if (instr_is_comptime(value)) {
-        ConstExprValue *pointee = const_ptr_pointee(ira, ira->codegen, &value->value, source_instr->source_node);
+        ConstExprValue *pointee = const_ptr_pointee(ira, ira->codegen, value->value, source_instr->source_node);
         if (pointee == nullptr)
             return ira->codegen->invalid_instruction;
         if (pointee->special != ConstValSpecialRuntime) {
             IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-            result->value.data.x_ptr.special = ConstPtrSpecialBaseArray;
-            result->value.data.x_ptr.mut = value->value.data.x_ptr.mut;
-            result->value.data.x_ptr.data.base_array.array_val = pointee;
-            result->value.data.x_ptr.data.base_array.elem_index = 0;
-            result->value.data.x_ptr.data.base_array.is_cstr = false;
+            result->value->data.x_ptr.special = ConstPtrSpecialBaseArray;
+            result->value->data.x_ptr.mut = value->value->data.x_ptr.mut;
+            result->value->data.x_ptr.data.base_array.array_val = pointee;
+            result->value->data.x_ptr.data.base_array.elem_index = 0;
+            result->value->data.x_ptr.data.base_array.is_cstr = false;
             return result;
         }
     }
 
     IrInstruction *result = ir_build_cast(&ira->new_irb, source_instr->scope, source_instr->source_node,
             wanted_type, value, CastOpBitCast);
-    result->value.type = wanted_type;
+    result->value->type = wanted_type;
     return result;
 }
 
@@ -11230,36 +11303,36 @@ static IrInstruction *ir_resolve_ptr_of_array_to_slice(IrAnalyze *ira, IrInstruc
 {
     Error err;
 
-    if ((err = type_resolve(ira->codegen, value->value.type->data.pointer.child_type,
+    if ((err = type_resolve(ira->codegen, value->value->type->data.pointer.child_type,
                     ResolveStatusAlignmentKnown)))
     {
         return ira->codegen->invalid_instruction;
     }
 
-    wanted_type = adjust_slice_align(ira->codegen, wanted_type, get_ptr_align(ira->codegen, value->value.type));
+    wanted_type = adjust_slice_align(ira->codegen, wanted_type, get_ptr_align(ira->codegen, value->value->type));
 
     if (instr_is_comptime(value)) {
-        ConstExprValue *pointee = const_ptr_pointee(ira, ira->codegen, &value->value, source_instr->source_node);
+        ConstExprValue *pointee = const_ptr_pointee(ira, ira->codegen, value->value, source_instr->source_node);
         if (pointee == nullptr)
             return ira->codegen->invalid_instruction;
         if (pointee->special != ConstValSpecialRuntime) {
-            assert(value->value.type->id == ZigTypeIdPointer);
-            ZigType *array_type = value->value.type->data.pointer.child_type;
+            assert(value->value->type->id == ZigTypeIdPointer);
+            ZigType *array_type = value->value->type->data.pointer.child_type;
             assert(is_slice(wanted_type));
             bool is_const = wanted_type->data.structure.fields[slice_ptr_index].type_entry->data.pointer.is_const;
 
             IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-            init_const_slice(ira->codegen, &result->value, pointee, 0, array_type->data.array.len, is_const);
-            result->value.data.x_struct.fields[slice_ptr_index].data.x_ptr.mut =
-                value->value.data.x_ptr.mut;
-            result->value.type = wanted_type;
+            init_const_slice(ira->codegen, result->value, pointee, 0, array_type->data.array.len, is_const);
+            result->value->data.x_struct.fields[slice_ptr_index].data.x_ptr.mut =
+                value->value->data.x_ptr.mut;
+            result->value->type = wanted_type;
             return result;
         }
     }
 
     if (result_loc == nullptr) result_loc = no_result_loc();
     IrInstruction *result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, wanted_type, nullptr, true, false);
-    if (type_is_invalid(result_loc_inst->value.type) || instr_is_unreachable(result_loc_inst)) {
+    if (type_is_invalid(result_loc_inst->value->type) || instr_is_unreachable(result_loc_inst)) {
         return result_loc_inst;
     }
     return ir_build_ptr_of_array_to_slice(ira, source_instr, wanted_type, value, result_loc_inst);
@@ -11441,6 +11514,7 @@ static bool ir_emit_backward_branch(IrAnalyze *ira, IrInstruction *source_instru
     }
 
     *bbc += 1;
+    ira->codegen->backward_branches += 1;
     if (*bbc > *quota) {
         ir_add_error(ira, source_instruction,
                 buf_sprintf("evaluation exceeded %" ZIG_PRI_usize " backwards branches", *quota));
@@ -11449,3660 +11523,5051 @@ static bool ir_emit_backward_branch(IrAnalyze *ira, IrInstruction *source_instru
     return true;
 }
 
-static IrInstruction *ir_inline_bb(IrAnalyze *ira, IrInstruction *source_instruction, IrBasicBlock *old_bb) {
-    if (old_bb->debug_id <= ira->old_irb.current_basic_block->debug_id) {
-        if (!ir_emit_backward_branch(ira, source_instruction))
-            return ir_unreach_error(ira);
-    }
+// Comptime loops that build tables spend most of their time in analysis,
+// creating a new constant for every instruction of every iteration. Once a
+// loop has run one iteration through normal analysis, the blocks that lead
+// back to its header are lowered to a small register program over the int
+// and bool vars the loop touches, and the arrays of ints and bools it
+// indexes, and the following iterations run there. Leaving the loop,
+// reaching anything the program can't express, or anything that would be a
+// compile error rolls back to the start of the current iteration, which
+// normal analysis then runs again.
+
+static const uint32_t comptime_loop_none = UINT32_MAX;
+
+enum ComptimeLoopOpId {
+    ComptimeLoopOpCopy,
+    ComptimeLoopOpStore,
+    ComptimeLoopOpBinOp,
+    ComptimeLoopOpCmp,
+    ComptimeLoopOpBoolNot,
+    ComptimeLoopOpPhi,
+    ComptimeLoopOpLoadElem,
+    ComptimeLoopOpStoreElem,
+    ComptimeLoopOpBr,
+    ComptimeLoopOpCondBr,
+};
 
-    old_bb->other = ira->old_irb.current_basic_block->other;
-    ir_start_bb(ira, old_bb, ira->old_irb.current_basic_block);
-    return ira->codegen->unreach_instruction;
-}
+struct ComptimeLoopOp {
+    ComptimeLoopOpId id;
+    IrBinOp bin_op;
+    uint32_t bits;
+    bool is_signed;
+    uint32_t dest;
+    // registers, except for branches where b and c are basic block indexes,
+    // for phis where a and b are a range of phi_entries, and for element
+    // loads and stores where a and c are an array index
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+    IrInstruction *source;
+};
 
-static IrInstruction *ir_finish_anal(IrAnalyze *ira, IrInstruction *instruction) {
-    if (instruction->value.type->id == ZigTypeIdUnreachable)
-        ir_finish_bb(ira);
-    return instruction;
-}
+struct ComptimeLoopPhiEntry {
+    uint32_t pred;
+    uint32_t reg;
+};
 
-static IrInstruction *ir_const_type(IrAnalyze *ira, IrInstruction *source_instruction, ZigType *ty) {
-    IrInstruction *result = ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_type);
-    result->value.data.x_type = ty;
-    return result;
-}
+struct ComptimeLoopBlock {
+    bool reachable;
+    bool in_region;
+    bool lowered;
+    size_t op_begin;
+    size_t op_end;
+};
 
-static IrInstruction *ir_const_bool(IrAnalyze *ira, IrInstruction *source_instruction, bool value) {
-    IrInstruction *result = ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_bool);
-    result->value.data.x_bool = value;
-    return result;
+struct ComptimeLoopVar {
+    // null for vars declared inside the loop, which live only in their register
+    ConstExprValue *storage;
+    ZigType *type;
+    uint32_t reg;
+    // Generated code, like the increment of a for loop index, may also store
+    // to comptime vars that are const in the source.
+    bool writable;
+    bool gen_writable;
+    bool written;
+};
+
+// An array of ints or bools declared outside the loop. Its elements are
+// copied out of the storage when the loop is lowered and written back when
+// the program stops.
+struct ComptimeLoopArray {
+    ConstExprValue *storage;
+    ZigType *elem_type;
+    size_t len;
+    uint64_t *elems;
+    bool *defined;
+    bool writable;
+    bool gen_writable;
+    bool written;
+};
+
+// A pointer to an array element, with the register that holds the index.
+struct ComptimeLoopElem {
+    uint32_t array;
+    uint32_t index;
+};
+
+// How to undo an element store of the current iteration.
+struct ComptimeLoopUndo {
+    uint32_t array;
+    size_t elem_index;
+    uint64_t value;
+    bool defined;
+};
+
+struct ComptimeLoop {
+    IrAnalyze *ira;
+    IrBasicBlock *header;
+    ComptimeLoopBlock *blocks;
+    ZigList<ComptimeLoopOp> ops;
+    ZigList<ComptimeLoopPhiEntry> phi_entries;
+    ZigList<ZigType *> reg_types;
+    ZigList<bool> reg_is_const;
+    ZigList<uint64_t> regs;
+    ZigList<ComptimeLoopVar> vars;
+    ZigList<ComptimeLoopArray> arrays;
+    ZigList<ComptimeLoopUndo> undo_log;
+    uint32_t void_reg;
+    // pass 1 instructions to registers
+    HashMap<const void *, uint32_t, ptr_hash, ptr_eq> values;
+    // VarPtr and DeclRef instructions to vars
+    HashMap<const void *, uint32_t, ptr_hash, ptr_eq> var_ptrs;
+    // pass 1 vars, and the storage of vars declared outside the loop, to vars
+    HashMap<const void *, uint32_t, ptr_hash, ptr_eq> var_table;
+    // VarPtr and DeclRef instructions to arrays
+    HashMap<const void *, uint32_t, ptr_hash, ptr_eq> array_ptrs;
+    // pass 1 vars, and the storage of arrays, to arrays
+    HashMap<const void *, uint32_t, ptr_hash, ptr_eq> array_table;
+    // Elem instructions to the elements they point at
+    HashMap<const void *, ComptimeLoopElem, ptr_hash, ptr_eq> elem_ptrs;
+};
+
+static bool comptime_loop_is_int(ZigType *type) {
+    if (type->id == ZigTypeIdComptimeInt)
+        return true;
+    return type->id == ZigTypeIdInt && type->data.integral.bit_count != 0 &&
+        type->data.integral.bit_count <= 64;
 }
 
-static IrInstruction *ir_const_undef(IrAnalyze *ira, IrInstruction *source_instruction, ZigType *ty) {
-    IrInstruction *result = ir_const(ira, source_instruction, ty);
-    result->value.special = ConstValSpecialUndef;
-    return result;
+static bool comptime_loop_type_ok(ZigType *type) {
+    return type->id == ZigTypeIdBool || comptime_loop_is_int(type);
 }
 
-static IrInstruction *ir_const_unreachable(IrAnalyze *ira, IrInstruction *source_instruction) {
-    IrInstruction *result = ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_unreachable);
-    result->value.special = ConstValSpecialStatic;
-    return result;
+// comptime_int values are kept as i64 and fall back to analysis when they grow past that.
+static uint32_t comptime_loop_int_bits(ZigType *type) {
+    return (type->id == ZigTypeIdComptimeInt) ? 64 : type->data.integral.bit_count;
 }
 
-static IrInstruction *ir_const_void(IrAnalyze *ira, IrInstruction *source_instruction) {
-    return ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_void);
+static bool comptime_loop_int_signed(ZigType *type) {
+    return type->id == ZigTypeIdComptimeInt || type->data.integral.is_signed;
 }
 
-static IrInstruction *ir_const_unsigned(IrAnalyze *ira, IrInstruction *source_instruction, uint64_t value) {
-    IrInstruction *result = ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_num_lit_int);
-    bigint_init_unsigned(&result->value.data.x_bigint, value);
-    return result;
+// Registers hold unsigned values zero extended and signed values sign extended to 64 bits.
+static uint64_t comptime_loop_truncate(uint64_t x, uint32_t bits, bool is_signed) {
+    if (bits == 64)
+        return x;
+    uint64_t mask = (((uint64_t)1) << bits) - 1;
+    x &= mask;
+    if (is_signed && (x >> (bits - 1)) != 0)
+        x |= ~mask;
+    return x;
 }
 
-static IrInstruction *ir_get_const_ptr(IrAnalyze *ira, IrInstruction *instruction,
-        ConstExprValue *pointee, ZigType *pointee_type,
-        ConstPtrMut ptr_mut, bool ptr_is_const, bool ptr_is_volatile, uint32_t ptr_align)
-{
-    ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, pointee_type,
-            ptr_is_const, ptr_is_volatile, PtrLenSingle, ptr_align, 0, 0, false);
-    IrInstruction *const_instr = ir_const(ira, instruction, ptr_type);
-    ConstExprValue *const_val = &const_instr->value;
-    const_val->data.x_ptr.special = ConstPtrSpecialRef;
-    const_val->data.x_ptr.mut = ptr_mut;
-    const_val->data.x_ptr.data.ref.pointee = pointee;
-    return const_instr;
+static bool comptime_loop_read_val(ConstExprValue *val, uint64_t *out) {
+    if (val->special != ConstValSpecialStatic)
+        return false;
+    if (val->type->id == ZigTypeIdBool) {
+        *out = val->data.x_bool ? 1 : 0;
+        return true;
+    }
+    if (!comptime_loop_is_int(val->type))
+        return false;
+    bool is_signed = comptime_loop_int_signed(val->type);
+    if (!bigint_fits_in_bits(&val->data.x_bigint, 64, is_signed))
+        return false;
+    *out = is_signed ? (uint64_t)bigint_as_signed(&val->data.x_bigint) : bigint_as_unsigned(&val->data.x_bigint);
+    return true;
 }
 
-static ConstExprValue *ir_resolve_const(IrAnalyze *ira, IrInstruction *value, UndefAllowed undef_allowed) {
-    switch (value->value.special) {
-        case ConstValSpecialStatic:
-            return &value->value;
-        case ConstValSpecialRuntime:
-            if (!type_has_bits(value->value.type)) {
-                return &value->value;
-            }
-            ir_add_error(ira, value, buf_sprintf("unable to evaluate constant expression"));
-            return nullptr;
-        case ConstValSpecialUndef:
-            if (undef_allowed == UndefOk) {
-                return &value->value;
-            } else {
-                ir_add_error(ira, value, buf_sprintf("use of undefined value here causes undefined behavior"));
-                return nullptr;
-            }
+static void comptime_loop_write_val(ConstExprValue *val, uint64_t x) {
+    if (val->type->id == ZigTypeIdBool) {
+        val->data.x_bool = (x != 0);
+    } else if (comptime_loop_int_signed(val->type)) {
+        bigint_init_signed(&val->data.x_bigint, (int64_t)x);
+    } else {
+        bigint_init_unsigned(&val->data.x_bigint, x);
     }
-    zig_unreachable();
 }
 
-ConstExprValue *ir_eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node,
-        ZigType *expected_type, size_t *backward_branch_count, size_t *backward_branch_quota,
-        ZigFn *fn_entry, Buf *c_import_buf, AstNode *source_node, Buf *exec_name,
-        IrExecutable *parent_exec, AstNode *expected_type_source_node)
-{
-    if (expected_type != nullptr && type_is_invalid(expected_type))
-        return &codegen->invalid_instruction->value;
-
-    IrExecutable *ir_executable = allocate<IrExecutable>(1);
-    ir_executable->source_node = source_node;
-    ir_executable->parent_exec = parent_exec;
-    ir_executable->name = exec_name;
-    ir_executable->is_inline = true;
-    ir_executable->fn_entry = fn_entry;
-    ir_executable->c_import_buf = c_import_buf;
-    ir_executable->begin_scope = scope;
-    ir_gen(codegen, node, scope, ir_executable);
+static uint32_t comptime_loop_add_reg(ComptimeLoop *loop, ZigType *type, bool is_const, uint64_t value) {
+    uint32_t reg = (uint32_t)loop->regs.length;
+    loop->reg_types.append(type);
+    loop->reg_is_const.append(is_const);
+    loop->regs.append(value);
+    return reg;
+}
 
-    if (ir_executable->invalid)
-        return &codegen->invalid_instruction->value;
+static void comptime_loop_emit(ComptimeLoop *loop, ComptimeLoopOpId id, uint32_t dest, uint32_t a,
+        uint32_t b, uint32_t c)
+{
+    ComptimeLoopOp *op = loop->ops.add_one();
+    memset(op, 0, sizeof(ComptimeLoopOp));
+    op->id = id;
+    op->dest = dest;
+    op->a = a;
+    op->b = b;
+    op->c = c;
+}
+
+static bool comptime_loop_in_region(ComptimeLoop *loop, IrBasicBlock *bb);
+
+// Constants, and values computed before the loop was entered, such as the
+// length in a for loop, become constant registers.
+static uint32_t comptime_loop_operand(ComptimeLoop *loop, IrInstruction *instruction) {
+    auto entry = loop->values.maybe_get(instruction);
+    if (entry != nullptr)
+        return entry->value;
+
+    ConstExprValue *value;
+    if (instruction->id == IrInstructionIdConst) {
+        value = instruction->value;
+    } else if (instruction->owner_bb != nullptr && !comptime_loop_in_region(loop, instruction->owner_bb) &&
+        instruction->child != nullptr && instr_is_comptime(instruction->child))
+    {
+        value = instruction->child->value;
+    } else {
+        return comptime_loop_none;
+    }
 
-    if (codegen->verbose_ir) {
-        fprintf(stderr, "\nSource: ");
-        ast_render(stderr, node, 4);
-        fprintf(stderr, "\n{ // (IR)\n");
-        ir_print(codegen, stderr, ir_executable, 2);
-        fprintf(stderr, "}\n");
+    ZigType *type = value->type;
+    uint32_t reg;
+    if (type->id == ZigTypeIdVoid) {
+        reg = loop->void_reg;
+    } else {
+        uint64_t x;
+        if (!comptime_loop_type_ok(type) || !comptime_loop_read_val(value, &x))
+            return comptime_loop_none;
+        reg = comptime_loop_add_reg(loop, type, true, x);
+    }
+    loop->values.put(instruction, reg);
+    return reg;
+}
+
+// Casts a comptime_int constant the way an implicit cast would.
+static uint32_t comptime_loop_coerce(ComptimeLoop *loop, uint32_t reg, ZigType *type) {
+    ZigType *reg_type = loop->reg_types.at(reg);
+    if (reg_type == type)
+        return reg;
+    if (reg_type->id != ZigTypeIdComptimeInt || !loop->reg_is_const.at(reg) ||
+        type->id != ZigTypeIdInt || !comptime_loop_is_int(type))
+    {
+        return comptime_loop_none;
     }
-    IrExecutable *analyzed_executable = allocate<IrExecutable>(1);
-    analyzed_executable->source_node = source_node;
-    analyzed_executable->parent_exec = parent_exec;
-    analyzed_executable->source_exec = ir_executable;
-    analyzed_executable->name = exec_name;
-    analyzed_executable->is_inline = true;
-    analyzed_executable->fn_entry = fn_entry;
-    analyzed_executable->c_import_buf = c_import_buf;
-    analyzed_executable->backward_branch_count = backward_branch_count;
-    analyzed_executable->backward_branch_quota = backward_branch_quota;
-    analyzed_executable->begin_scope = scope;
-    ZigType *result_type = ir_analyze(codegen, ir_executable, analyzed_executable, expected_type, expected_type_source_node);
-    if (type_is_invalid(result_type))
-        return &codegen->invalid_instruction->value;
+    uint64_t x = loop->regs.at(reg);
+    bool is_signed = type->data.integral.is_signed;
+    if (!is_signed && (int64_t)x < 0)
+        return comptime_loop_none;
+    if (comptime_loop_truncate(x, type->data.integral.bit_count, is_signed) != x)
+        return comptime_loop_none;
+    return comptime_loop_add_reg(loop, type, true, x);
+}
 
-    if (codegen->verbose_ir) {
-        fprintf(stderr, "{ // (analyzed)\n");
-        ir_print(codegen, stderr, analyzed_executable, 2);
-        fprintf(stderr, "}\n");
+static bool comptime_loop_unify(ComptimeLoop *loop, uint32_t *a, uint32_t *b) {
+    ZigType *type_a = loop->reg_types.at(*a);
+    ZigType *type_b = loop->reg_types.at(*b);
+    if (!comptime_loop_is_int(type_a) || !comptime_loop_is_int(type_b))
+        return false;
+    if (type_a == type_b)
+        return true;
+    if (type_a->id == ZigTypeIdComptimeInt) {
+        *a = comptime_loop_coerce(loop, *a, type_b);
+        return *a != comptime_loop_none;
     }
+    if (type_b->id == ZigTypeIdComptimeInt) {
+        *b = comptime_loop_coerce(loop, *b, type_a);
+        return *b != comptime_loop_none;
+    }
+    return false;
+}
 
-    return ir_exec_const_result(codegen, analyzed_executable);
+static ZigVar *comptime_loop_resolve_var(ZigVar *var) {
+    while (var->next_var != nullptr) {
+        var = var->next_var;
+    }
+    return var;
 }
 
-static ErrorTableEntry *ir_resolve_error(IrAnalyze *ira, IrInstruction *err_value) {
-    if (type_is_invalid(err_value->value.type))
+// Finds the storage of a var declared outside the loop the same way
+// ir_get_var_ptr does. Only comptime vars and comptime known consts qualify.
+static ConstExprValue *comptime_loop_storage(ZigVar *var) {
+    if (var->mem_slot_index != SIZE_MAX && var->owner_exec->analysis == nullptr)
         return nullptr;
-
-    if (err_value->value.type->id != ZigTypeIdErrorSet) {
-        ir_add_error(ira, err_value,
-                buf_sprintf("expected error, found '%s'", buf_ptr(&err_value->value.type->name)));
+    if (var->decl_node->data.variable_declaration.is_extern)
         return nullptr;
-    }
-
-    ConstExprValue *const_val = ir_resolve_const(ira, err_value, UndefBad);
-    if (!const_val)
+    if (!ir_get_var_is_comptime(var) && !var->gen_is_const)
         return nullptr;
 
-    assert(const_val->data.x_err_set != nullptr);
-    return const_val->data.x_err_set;
-}
-
-static ZigType *ir_resolve_type(IrAnalyze *ira, IrInstruction *type_value) {
-    if (type_is_invalid(type_value->value.type))
-        return ira->codegen->builtin_types.entry_invalid;
-
-    if (type_value->value.type->id != ZigTypeIdMetaType) {
-        ir_add_error(ira, type_value,
-                buf_sprintf("expected type 'type', found '%s'", buf_ptr(&type_value->value.type->name)));
-        return ira->codegen->builtin_types.entry_invalid;
+    ConstExprValue *storage = nullptr;
+    if (var->const_value->special == ConstValSpecialStatic) {
+        storage = var->const_value;
+    } else if (var->mem_slot_index != SIZE_MAX) {
+        storage = var->owner_exec->analysis->exec_context.mem_slot_list.at(var->mem_slot_index);
     }
+    if (storage == nullptr || storage->special != ConstValSpecialStatic || storage->type != var->var_type)
+        return nullptr;
+    return storage;
+}
+
+static uint32_t comptime_loop_var(ComptimeLoop *loop, ZigVar *src_var) {
+    auto entry = loop->var_table.maybe_get(src_var);
+    if (entry != nullptr)
+        return entry->value;
+
+    ZigVar *var = comptime_loop_resolve_var(src_var);
+    if (var->var_type == nullptr || type_is_invalid(var->var_type) || !comptime_loop_type_ok(var->var_type))
+        return comptime_loop_none;
+    ConstExprValue *storage = comptime_loop_storage(var);
+    if (storage == nullptr)
+        return comptime_loop_none;
+
+    bool is_comptime = ir_get_var_is_comptime(var);
+    bool writable = is_comptime && !var->src_is_const;
+    uint32_t var_index;
+    auto storage_entry = loop->var_table.maybe_get(storage);
+    if (storage_entry != nullptr) {
+        var_index = storage_entry->value;
+        ComptimeLoopVar *loop_var = &loop->vars.at(var_index);
+        if (loop_var->writable != writable || loop_var->gen_writable != is_comptime)
+            return comptime_loop_none;
+    } else {
+        uint64_t x;
+        if (!comptime_loop_read_val(storage, &x))
+            return comptime_loop_none;
+        var_index = (uint32_t)loop->vars.length;
+        ComptimeLoopVar *loop_var = loop->vars.add_one();
+        loop_var->storage = storage;
+        loop_var->type = var->var_type;
+        loop_var->reg = comptime_loop_add_reg(loop, var->var_type, false, x);
+        loop_var->writable = writable;
+        loop_var->gen_writable = is_comptime;
+        loop_var->written = false;
+        loop->var_table.put(storage, var_index);
+    }
+    loop->var_table.put(src_var, var_index);
+    return var_index;
+}
+
+// Like comptime_loop_var, for arrays of the types registers can hold.
+static uint32_t comptime_loop_array(ComptimeLoop *loop, ZigVar *src_var) {
+    auto entry = loop->array_table.maybe_get(src_var);
+    if (entry != nullptr)
+        return entry->value;
+
+    ZigVar *var = comptime_loop_resolve_var(src_var);
+    ZigType *type = var->var_type;
+    if (type == nullptr || type_is_invalid(type) || type->id != ZigTypeIdArray ||
+        !comptime_loop_type_ok(type->data.array.child_type))
+    {
+        return comptime_loop_none;
+    }
+    ConstExprValue *storage = comptime_loop_storage(var);
+    if (storage == nullptr || storage->data.x_array.special == ConstArraySpecialUndef)
+        return comptime_loop_none;
+
+    bool is_comptime = ir_get_var_is_comptime(var);
+    bool writable = is_comptime && !var->src_is_const;
+    uint32_t array_index;
+    auto storage_entry = loop->array_table.maybe_get(storage);
+    if (storage_entry != nullptr) {
+        array_index = storage_entry->value;
+        ComptimeLoopArray *loop_array = &loop->arrays.at(array_index);
+        if (loop_array->writable != writable || loop_array->gen_writable != is_comptime)
+            return comptime_loop_none;
+    } else {
+        size_t len = type->data.array.len;
+        uint64_t *elems = allocate_nonzero<uint64_t>(len);
+        bool *defined = allocate<bool>(len);
+        if (storage->data.x_array.special == ConstArraySpecialBuf) {
+            const char *bytes = buf_ptr(storage->data.x_array.data.s_buf);
+            for (size_t i = 0; i < len; i += 1) {
+                elems[i] = (uint8_t)bytes[i];
+                defined[i] = true;
+            }
+        } else {
+            ConstExprValue *elements = storage->data.x_array.data.s_none.elements;
+            for (size_t i = 0; i < len; i += 1) {
+                if (elements[i].special == ConstValSpecialUndef)
+                    continue;
+                if (!comptime_loop_read_val(&elements[i], &elems[i])) {
+                    free(elems);
+                    free(defined);
+                    return comptime_loop_none;
+                }
+                defined[i] = true;
+            }
+        }
+        array_index = (uint32_t)loop->arrays.length;
+        ComptimeLoopArray *loop_array = loop->arrays.add_one();
+        loop_array->storage = storage;
+        loop_array->elem_type = type->data.array.child_type;
+        loop_array->len = len;
+        loop_array->elems = elems;
+        loop_array->defined = defined;
+        loop_array->writable = writable;
+        loop_array->gen_writable = is_comptime;
+        loop_array->written = false;
+        loop->array_table.put(storage, array_index);
+    }
+    loop->array_table.put(src_var, array_index);
+    return array_index;
+}
+
+// Resolves a VarPtr or DeclRef pointer to a var or an array. A pointer made
+// before the loop was entered, like the array and index pointers of a for
+// loop, is resolved where it is used.
+static bool comptime_loop_var_ptr(ComptimeLoop *loop, IrInstruction *ptr) {
+    if (loop->var_ptrs.maybe_get(ptr) != nullptr || loop->array_ptrs.maybe_get(ptr) != nullptr)
+        return true;
 
-    ConstExprValue *const_val = ir_resolve_const(ira, type_value, UndefBad);
-    if (!const_val)
-        return ira->codegen->builtin_types.entry_invalid;
-
-    assert(const_val->data.x_type != nullptr);
-    return const_val->data.x_type;
-}
-
-static ZigType *ir_resolve_int_type(IrAnalyze *ira, IrInstruction *type_value) {
-    ZigType *ty = ir_resolve_type(ira, type_value);
-    if (type_is_invalid(ty))
-        return ira->codegen->builtin_types.entry_invalid;
-
-    if (ty->id != ZigTypeIdInt) {
-        ir_add_error(ira, type_value,
-            buf_sprintf("expected integer type, found '%s'", buf_ptr(&ty->name)));
-        return ira->codegen->builtin_types.entry_invalid;
+    ZigVar *var;
+    if (ptr->id == IrInstructionIdVarPtr) {
+        var = reinterpret_cast<IrInstructionVarPtr *>(ptr)->var;
+    } else if (ptr->id == IrInstructionIdDeclRef) {
+        IrInstructionDeclRef *decl_ref = reinterpret_cast<IrInstructionDeclRef *>(ptr);
+        Tld *tld = decl_ref->tld;
+        if (decl_ref->lval != LValPtr || tld->id != TldIdVar || tld->resolution != TldResolutionOk)
+            return false;
+        TldVar *tld_var = reinterpret_cast<TldVar *>(tld);
+        if (tld_var->var == nullptr || tld_var->extern_lib_name != nullptr)
+            return false;
+        var = tld_var->var;
+    } else {
+        return false;
     }
 
-    return ty;
+    uint32_t var_index = comptime_loop_var(loop, var);
+    if (var_index != comptime_loop_none) {
+        loop->var_ptrs.put(ptr, var_index);
+        return true;
+    }
+    uint32_t array_index = comptime_loop_array(loop, var);
+    if (array_index != comptime_loop_none) {
+        loop->array_ptrs.put(ptr, array_index);
+        return true;
+    }
+    return false;
 }
 
-static ZigType *ir_resolve_error_set_type(IrAnalyze *ira, IrInstruction *op_source, IrInstruction *type_value) {
-    if (type_is_invalid(type_value->value.type))
-        return ira->codegen->builtin_types.entry_invalid;
+static bool comptime_loop_ptr(ComptimeLoop *loop, IrInstruction *ptr) {
+    if (loop->elem_ptrs.maybe_get(ptr) != nullptr)
+        return true;
+    if (ptr->owner_bb != nullptr && comptime_loop_in_region(loop, ptr->owner_bb))
+        return loop->var_ptrs.maybe_get(ptr) != nullptr || loop->array_ptrs.maybe_get(ptr) != nullptr;
+    return comptime_loop_var_ptr(loop, ptr);
+}
 
-    if (type_value->value.type->id != ZigTypeIdMetaType) {
-        ErrorMsg *msg = ir_add_error(ira, type_value,
-                buf_sprintf("expected error set type, found '%s'", buf_ptr(&type_value->value.type->name)));
-        add_error_note(ira->codegen, msg, op_source->source_node,
-                buf_sprintf("`||` merges error sets; `or` performs boolean OR"));
-        return ira->codegen->builtin_types.entry_invalid;
+static uint32_t comptime_loop_local_var(ComptimeLoop *loop, ZigVar *var, ZigType *type) {
+    auto entry = loop->var_table.maybe_get(var);
+    if (entry != nullptr) {
+        ComptimeLoopVar *loop_var = &loop->vars.at(entry->value);
+        // A var used before its declaration was lowered belongs to the iteration
+        // that normal analysis started, so its declaration can't run here.
+        if (loop_var->storage != nullptr || loop_var->type != type)
+            return comptime_loop_none;
+        return entry->value;
+    }
+    if (!comptime_loop_type_ok(type))
+        return comptime_loop_none;
+    IrInstruction *is_comptime_inst = var->is_comptime;
+    bool is_comptime = is_comptime_inst != nullptr && is_comptime_inst->id == IrInstructionIdConst &&
+        is_comptime_inst->value->type->id == ZigTypeIdBool && is_comptime_inst->value->data.x_bool;
+    if (!is_comptime && !var->gen_is_const)
+        return comptime_loop_none;
+
+    uint32_t var_index = (uint32_t)loop->vars.length;
+    ComptimeLoopVar *loop_var = loop->vars.add_one();
+    loop_var->storage = nullptr;
+    loop_var->type = type;
+    loop_var->reg = comptime_loop_add_reg(loop, type, false, 0);
+    loop_var->writable = is_comptime && !var->src_is_const;
+    loop_var->gen_writable = is_comptime;
+    loop_var->written = false;
+    loop->var_table.put(var, var_index);
+    return var_index;
+}
+
+// An EndExpr in an inlined loop either drops the value or initializes a var.
+static bool comptime_loop_result_var(ResultLoc *result_loc, ResultLocVar **out) {
+    for (;;) {
+        switch (result_loc->id) {
+            case ResultLocIdNone:
+                *out = nullptr;
+                return true;
+            case ResultLocIdVar:
+                *out = reinterpret_cast<ResultLocVar *>(result_loc);
+                return true;
+            case ResultLocIdPeer: {
+                ResultLocPeerParent *peer_parent = reinterpret_cast<ResultLocPeer *>(result_loc)->parent;
+                if (peer_parent->peers.length == 1) {
+                    result_loc = peer_parent->parent;
+                    continue;
+                }
+                IrInstruction *is_comptime = peer_parent->is_comptime;
+                if (is_comptime->id == IrInstructionIdConst && is_comptime->value->type->id == ZigTypeIdBool &&
+                    is_comptime->value->data.x_bool)
+                {
+                    *out = nullptr;
+                    return true;
+                }
+                return false;
+            }
+            default:
+                return false;
+        }
     }
+}
 
-    ConstExprValue *const_val = ir_resolve_const(ira, type_value, UndefBad);
-    if (!const_val)
-        return ira->codegen->builtin_types.entry_invalid;
+static bool comptime_loop_in_region(ComptimeLoop *loop, IrBasicBlock *bb) {
+    ZigList<IrBasicBlock *> *bb_list = &loop->ira->old_irb.exec->basic_block_list;
+    return bb->index < bb_list->length && bb_list->at(bb->index) == bb && loop->blocks[bb->index].in_region;
+}
 
-    assert(const_val->data.x_type != nullptr);
-    ZigType *result_type = const_val->data.x_type;
-    if (result_type->id != ZigTypeIdErrorSet) {
-        ErrorMsg *msg = ir_add_error(ira, type_value,
-                buf_sprintf("expected error set type, found type '%s'", buf_ptr(&result_type->name)));
-        add_error_note(ira->codegen, msg, op_source->source_node,
-                buf_sprintf("`||` merges error sets; `or` performs boolean OR"));
-        return ira->codegen->builtin_types.entry_invalid;
-    }
-    return result_type;
+// Mirrors the choice ir_analyze_instruction_br and ir_analyze_instruction_cond_br
+// make between inlining the destination and emitting a runtime branch.
+static uint32_t comptime_loop_edge(ComptimeLoop *loop, IrBasicBlock *dest_block, IrInstruction *is_comptime) {
+    if (!comptime_loop_in_region(loop, dest_block))
+        return comptime_loop_none;
+    bool inline_dest = is_comptime != nullptr && is_comptime->id == IrInstructionIdConst &&
+        is_comptime->value->type->id == ZigTypeIdBool && is_comptime->value->data.x_bool;
+    if (!inline_dest && (dest_block->ref_count != 1 || dest_block->suspend_instruction_ref != nullptr))
+        return comptime_loop_none;
+    return (uint32_t)dest_block->index;
 }
 
-static ZigFn *ir_resolve_fn(IrAnalyze *ira, IrInstruction *fn_value) {
-    if (fn_value == ira->codegen->invalid_instruction)
-        return nullptr;
+static uint32_t comptime_loop_lower_bin_op(ComptimeLoop *loop, IrInstructionBinOp *bin_op) {
+    uint32_t op1 = comptime_loop_operand(loop, bin_op->op1);
+    uint32_t op2 = comptime_loop_operand(loop, bin_op->op2);
+    if (op1 == comptime_loop_none || op2 == comptime_loop_none)
+        return comptime_loop_none;
 
-    if (type_is_invalid(fn_value->value.type))
-        return nullptr;
-
-    if (fn_value->value.type->id != ZigTypeIdFn) {
-        ir_add_error_node(ira, fn_value->source_node,
-                buf_sprintf("expected function type, found '%s'", buf_ptr(&fn_value->value.type->name)));
-        return nullptr;
+    ZigType *bool_type = loop->ira->codegen->builtin_types.entry_bool;
+    ComptimeLoopOpId op_id;
+    ZigType *result_type;
+    switch (bin_op->op_id) {
+        case IrBinOpCmpEq:
+        case IrBinOpCmpNotEq:
+            if (loop->reg_types.at(op1) == bool_type && loop->reg_types.at(op2) == bool_type) {
+                op_id = ComptimeLoopOpCmp;
+                result_type = bool_type;
+                break;
+            }
+            // fallthrough
+        case IrBinOpCmpLessThan:
+        case IrBinOpCmpGreaterThan:
+        case IrBinOpCmpLessOrEq:
+        case IrBinOpCmpGreaterOrEq:
+            if (!comptime_loop_unify(loop, &op1, &op2))
+                return comptime_loop_none;
+            op_id = ComptimeLoopOpCmp;
+            result_type = bool_type;
+            break;
+        case IrBinOpBinOr:
+        case IrBinOpBinXor:
+        case IrBinOpBinAnd:
+        case IrBinOpAddWrap:
+        case IrBinOpSubWrap:
+        case IrBinOpMultWrap:
+            if (!comptime_loop_unify(loop, &op1, &op2) || loop->reg_types.at(op1)->id != ZigTypeIdInt)
+                return comptime_loop_none;
+            op_id = ComptimeLoopOpBinOp;
+            result_type = loop->reg_types.at(op1);
+            break;
+        case IrBinOpAdd:
+        case IrBinOpSub:
+        case IrBinOpMult:
+        case IrBinOpDivUnspecified:
+        case IrBinOpDivExact:
+        case IrBinOpDivTrunc:
+        case IrBinOpDivFloor:
+        case IrBinOpRemUnspecified:
+        case IrBinOpRemRem:
+        case IrBinOpRemMod:
+            if (!comptime_loop_unify(loop, &op1, &op2))
+                return comptime_loop_none;
+            op_id = ComptimeLoopOpBinOp;
+            result_type = loop->reg_types.at(op1);
+            break;
+        case IrBinOpBitShiftLeftLossy:
+        case IrBinOpBitShiftLeftExact:
+        case IrBinOpBitShiftRightLossy:
+        case IrBinOpBitShiftRightExact: {
+            result_type = loop->reg_types.at(op1);
+            if (result_type->id != ZigTypeIdInt || !comptime_loop_is_int(result_type))
+                return comptime_loop_none;
+            uint32_t bit_count = result_type->data.integral.bit_count;
+            ZigType *shift_type = loop->reg_types.at(op2);
+            if (shift_type->id == ZigTypeIdComptimeInt) {
+                int64_t amount = (int64_t)loop->regs.at(op2);
+                if (!loop->reg_is_const.at(op2) || amount < 0 || (uint64_t)amount >= bit_count)
+                    return comptime_loop_none;
+            } else {
+                // The amount must implicitly cast to the Log2Int of the shifted type.
+                uint32_t log2_bits = 0;
+                while ((((uint64_t)1) << log2_bits) < bit_count) {
+                    log2_bits += 1;
+                }
+                if (shift_type->id != ZigTypeIdInt || shift_type->data.integral.is_signed ||
+                    shift_type->data.integral.bit_count > log2_bits)
+                {
+                    return comptime_loop_none;
+                }
+            }
+            op_id = ComptimeLoopOpBinOp;
+            break;
+        }
+        default:
+            return comptime_loop_none;
     }
 
-    ConstExprValue *const_val = ir_resolve_const(ira, fn_value, UndefBad);
-    if (!const_val)
-        return nullptr;
-
-    assert(const_val->data.x_ptr.special == ConstPtrSpecialFunction);
-    return const_val->data.x_ptr.data.fn.fn_entry;
+    ZigType *operand_type = loop->reg_types.at(op1);
+    uint32_t dest = comptime_loop_add_reg(loop, result_type, false, 0);
+    comptime_loop_emit(loop, op_id, dest, op1, op2, 0);
+    ComptimeLoopOp *op = &loop->ops.last();
+    op->bin_op = bin_op->op_id;
+    if (operand_type != bool_type) {
+        op->bits = comptime_loop_int_bits(operand_type);
+        op->is_signed = comptime_loop_int_signed(operand_type);
+    } else {
+        op->bits = 64;
+    }
+    return dest;
 }
 
-static IrInstruction *ir_analyze_optional_wrap(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value,
-        ZigType *wanted_type, ResultLoc *result_loc)
-{
-    assert(wanted_type->id == ZigTypeIdOptional);
-
-    if (instr_is_comptime(value)) {
-        ZigType *payload_type = wanted_type->data.maybe.child_type;
-        IrInstruction *casted_payload = ir_implicit_cast(ira, value, payload_type);
-        if (type_is_invalid(casted_payload->value.type))
-            return ira->codegen->invalid_instruction;
-
-        ConstExprValue *val = ir_resolve_const(ira, casted_payload, UndefOk);
-        if (!val)
-            return ira->codegen->invalid_instruction;
-
-        IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
-                source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        if (types_have_same_zig_comptime_repr(wanted_type, payload_type)) {
-            copy_const_val(&const_instruction->base.value, val, val->data.x_ptr.mut == ConstPtrMutComptimeConst);
-        } else {
-            const_instruction->base.value.data.x_optional = val;
-        }
-        const_instruction->base.value.type = wanted_type;
-        return &const_instruction->base;
-    }
+static bool comptime_loop_lower_bb(ComptimeLoop *loop, IrBasicBlock *bb) {
+    ZigType *bool_type = loop->ira->codegen->builtin_types.entry_bool;
+    for (size_t i = 0; i < bb->instruction_list.length; i += 1) {
+        IrInstruction *instruction = bb->instruction_list.at(i);
+        if (instruction->ref_count == 0 && !ir_has_side_effects(instruction))
+            continue;
 
-    if (result_loc == nullptr && handle_is_ptr(wanted_type)) {
-        result_loc = no_result_loc();
-    }
-    IrInstruction *result_loc_inst = nullptr;
-    if (result_loc != nullptr) {
-        result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, wanted_type, nullptr, true, false);
-        if (type_is_invalid(result_loc_inst->value.type) || instr_is_unreachable(result_loc_inst)) {
-            return result_loc_inst;
+        uint32_t result = loop->void_reg;
+        switch (instruction->id) {
+            case IrInstructionIdConst:
+            case IrInstructionIdResetResult:
+                // constants are turned into registers where they are used
+                continue;
+            case IrInstructionIdVarPtr:
+                if (!comptime_loop_var_ptr(loop, instruction))
+                    return false;
+                continue;
+            case IrInstructionIdElem: {
+                IrInstructionElem *elem = reinterpret_cast<IrInstructionElem *>(instruction);
+                if (elem->init_array_type != nullptr || !comptime_loop_ptr(loop, elem->array_ptr))
+                    return false;
+                auto array_entry = loop->array_ptrs.maybe_get(elem->array_ptr);
+                if (array_entry == nullptr)
+                    return false;
+                // The index must implicitly cast to usize whatever its value.
+                uint32_t index = comptime_loop_operand(loop, elem->elem_index);
+                if (index == comptime_loop_none)
+                    return false;
+                ZigType *index_type = loop->reg_types.at(index);
+                if (index_type->id != ZigTypeIdComptimeInt &&
+                    (index_type->id != ZigTypeIdInt || index_type->data.integral.is_signed))
+                {
+                    return false;
+                }
+                ComptimeLoopElem loop_elem = {array_entry->value, index};
+                loop->elem_ptrs.put(instruction, loop_elem);
+                continue;
+            }
+            case IrInstructionIdLoad: {
+                IrInstructionLoad *load = reinterpret_cast<IrInstructionLoad *>(instruction);
+                if (!comptime_loop_ptr(loop, load->ptr))
+                    return false;
+                auto elem_entry = loop->elem_ptrs.maybe_get(load->ptr);
+                if (elem_entry != nullptr) {
+                    ComptimeLoopElem loop_elem = elem_entry->value;
+                    result = comptime_loop_add_reg(loop, loop->arrays.at(loop_elem.array).elem_type, false, 0);
+                    comptime_loop_emit(loop, ComptimeLoopOpLoadElem, result, loop_elem.array, loop_elem.index, 0);
+                    loop->ops.last().is_signed = comptime_loop_int_signed(loop->reg_types.at(loop_elem.index));
+                    break;
+                }
+                auto entry = loop->var_ptrs.maybe_get(load->ptr);
+                if (entry == nullptr)
+                    return false;
+                ComptimeLoopVar *loop_var = &loop->vars.at(entry->value);
+                result = comptime_loop_add_reg(loop, loop_var->type, false, 0);
+                comptime_loop_emit(loop, ComptimeLoopOpCopy, result, loop_var->reg, 0, 0);
+                break;
+            }
+            case IrInstructionIdStore: {
+                IrInstructionStore *store = reinterpret_cast<IrInstructionStore *>(instruction);
+                if (!comptime_loop_ptr(loop, store->ptr))
+                    return false;
+                uint32_t value = comptime_loop_operand(loop, store->value);
+                if (value == comptime_loop_none)
+                    return false;
+                auto elem_entry = loop->elem_ptrs.maybe_get(store->ptr);
+                if (elem_entry != nullptr) {
+                    ComptimeLoopElem loop_elem = elem_entry->value;
+                    ComptimeLoopArray *loop_array = &loop->arrays.at(loop_elem.array);
+                    if (!(instruction->is_gen ? loop_array->gen_writable : loop_array->writable))
+                        return false;
+                    value = comptime_loop_coerce(loop, value, loop_array->elem_type);
+                    if (value == comptime_loop_none)
+                        return false;
+                    loop_array->written = true;
+                    comptime_loop_emit(loop, ComptimeLoopOpStoreElem, 0, value, loop_elem.index, loop_elem.array);
+                    loop->ops.last().is_signed = comptime_loop_int_signed(loop->reg_types.at(loop_elem.index));
+                    loop->ops.last().source = instruction;
+                    break;
+                }
+                auto entry = loop->var_ptrs.maybe_get(store->ptr);
+                if (entry == nullptr)
+                    return false;
+                ComptimeLoopVar *loop_var = &loop->vars.at(entry->value);
+                if (!(instruction->is_gen ? loop_var->gen_writable : loop_var->writable))
+                    return false;
+                value = comptime_loop_coerce(loop, value, loop_var->type);
+                if (value == comptime_loop_none)
+                    return false;
+                loop_var->written = true;
+                comptime_loop_emit(loop, ComptimeLoopOpStore, loop_var->reg, value, 0, 0);
+                loop->ops.last().source = instruction;
+                break;
+            }
+            case IrInstructionIdDeclRef: {
+                IrInstructionDeclRef *decl_ref = reinterpret_cast<IrInstructionDeclRef *>(instruction);
+                if (decl_ref->lval == LValPtr) {
+                    if (!comptime_loop_var_ptr(loop, instruction))
+                        return false;
+                    continue;
+                }
+                Tld *tld = decl_ref->tld;
+                if (decl_ref->lval != LValNone || tld->id != TldIdVar || tld->resolution != TldResolutionOk)
+                    return false;
+                TldVar *tld_var = reinterpret_cast<TldVar *>(tld);
+                if (tld_var->var == nullptr || tld_var->extern_lib_name != nullptr)
+                    return false;
+                uint32_t var_index = comptime_loop_var(loop, tld_var->var);
+                if (var_index == comptime_loop_none)
+                    return false;
+                ComptimeLoopVar *loop_var = &loop->vars.at(var_index);
+                result = comptime_loop_add_reg(loop, loop_var->type, false, 0);
+                comptime_loop_emit(loop, ComptimeLoopOpCopy, result, loop_var->reg, 0, 0);
+                break;
+            }
+            case IrInstructionIdBinOp:
+                result = comptime_loop_lower_bin_op(loop, reinterpret_cast<IrInstructionBinOp *>(instruction));
+                if (result == comptime_loop_none)
+                    return false;
+                break;
+            case IrInstructionIdBoolNot: {
+                IrInstructionBoolNot *bool_not = reinterpret_cast<IrInstructionBoolNot *>(instruction);
+                uint32_t value = comptime_loop_operand(loop, bool_not->value);
+                if (value == comptime_loop_none || loop->reg_types.at(value) != bool_type)
+                    return false;
+                result = comptime_loop_add_reg(loop, bool_type, false, 0);
+                comptime_loop_emit(loop, ComptimeLoopOpBoolNot, result, value, 0, 0);
+                break;
+            }
+            case IrInstructionIdImplicitCast: {
+                IrInstructionImplicitCast *cast = reinterpret_cast<IrInstructionImplicitCast *>(instruction);
+                IrInstruction *dest_type = cast->dest_type;
+                if (dest_type->id != IrInstructionIdConst || dest_type->value->type->id != ZigTypeIdMetaType)
+                    return false;
+                uint32_t value = comptime_loop_operand(loop, cast->target);
+                if (value == comptime_loop_none)
+                    return false;
+                result = comptime_loop_coerce(loop, value, dest_type->value->data.x_type);
+                if (result == comptime_loop_none)
+                    return false;
+                break;
+            }
+            case IrInstructionIdEndExpr: {
+                IrInstructionEndExpr *end_expr = reinterpret_cast<IrInstructionEndExpr *>(instruction);
+                uint32_t value = comptime_loop_operand(loop, end_expr->value);
+                ResultLocVar *result_var;
+                if (value == comptime_loop_none || !comptime_loop_result_var(end_expr->result_loc, &result_var))
+                    return false;
+                if (result_var != nullptr) {
+                    uint32_t var_index = comptime_loop_local_var(loop, result_var->var, loop->reg_types.at(value));
+                    if (var_index == comptime_loop_none)
+                        return false;
+                    comptime_loop_emit(loop, ComptimeLoopOpCopy, loop->vars.at(var_index).reg, value, 0, 0);
+                }
+                break;
+            }
+            case IrInstructionIdAllocaSrc:
+                if (reinterpret_cast<IrInstructionAllocaSrc *>(instruction)->align != nullptr)
+                    return false;
+                continue;
+            case IrInstructionIdDeclVarSrc: {
+                IrInstructionDeclVarSrc *decl_var = reinterpret_cast<IrInstructionDeclVarSrc *>(instruction);
+                auto elem_entry = loop->elem_ptrs.maybe_get(decl_var->ptr);
+                if (elem_entry != nullptr) {
+                    // The element of a for loop. Analysis copies it into the var.
+                    ComptimeLoopElem loop_elem = elem_entry->value;
+                    ZigType *elem_type = loop->arrays.at(loop_elem.array).elem_type;
+                    if (decl_var->align_value != nullptr || decl_var->var_type != nullptr ||
+                        loop->var_table.maybe_get(decl_var->var) != nullptr)
+                    {
+                        return false;
+                    }
+                    uint32_t var_index = comptime_loop_local_var(loop, decl_var->var, elem_type);
+                    if (var_index == comptime_loop_none)
+                        return false;
+                    comptime_loop_emit(loop, ComptimeLoopOpLoadElem, loop->vars.at(var_index).reg,
+                            loop_elem.array, loop_elem.index, 0);
+                    loop->ops.last().is_signed = comptime_loop_int_signed(loop->reg_types.at(loop_elem.index));
+                    break;
+                }
+                auto entry = loop->var_table.maybe_get(decl_var->var);
+                if (decl_var->align_value != nullptr || entry == nullptr ||
+                    loop->vars.at(entry->value).storage != nullptr)
+                {
+                    return false;
+                }
+                break;
+            }
+            case IrInstructionIdCheckStatementIsVoid: {
+                IrInstructionCheckStatementIsVoid *check =
+                    reinterpret_cast<IrInstructionCheckStatementIsVoid *>(instruction);
+                if (comptime_loop_operand(loop, check->statement_value) != loop->void_reg)
+                    return false;
+                break;
+            }
+            case IrInstructionIdPhi: {
+                IrInstructionPhi *phi = reinterpret_cast<IrInstructionPhi *>(instruction);
+                ZigType *type = nullptr;
+                uint32_t entry_begin = (uint32_t)loop->phi_entries.length;
+                for (size_t j = 0; j < phi->incoming_count; j += 1) {
+                    if (!comptime_loop_in_region(loop, phi->incoming_blocks[j]))
+                        continue;
+                    // A predecessor that could not be lowered never branches here.
+                    uint32_t value = comptime_loop_operand(loop, phi->incoming_values[j]);
+                    if (value == comptime_loop_none)
+                        continue;
+                    if (type != nullptr && loop->reg_types.at(value) != type)
+                        return false;
+                    type = loop->reg_types.at(value);
+                    ComptimeLoopPhiEntry *phi_entry = loop->phi_entries.add_one();
+                    phi_entry->pred = (uint32_t)phi->incoming_blocks[j]->index;
+                    phi_entry->reg = value;
+                }
+                if (type == nullptr)
+                    return false;
+                result = (type->id == ZigTypeIdVoid) ? loop->void_reg : comptime_loop_add_reg(loop, type, false, 0);
+                comptime_loop_emit(loop, ComptimeLoopOpPhi, result, entry_begin,
+                        (uint32_t)loop->phi_entries.length - entry_begin, 0);
+                break;
+            }
+            case IrInstructionIdBr: {
+                IrInstructionBr *br = reinterpret_cast<IrInstructionBr *>(instruction);
+                comptime_loop_emit(loop, ComptimeLoopOpBr, 0, 0,
+                        comptime_loop_edge(loop, br->dest_block, br->is_comptime), 0);
+                continue;
+            }
+            case IrInstructionIdCondBr: {
+                IrInstructionCondBr *cond_br = reinterpret_cast<IrInstructionCondBr *>(instruction);
+                uint32_t condition = comptime_loop_operand(loop, cond_br->condition);
+                if (condition == comptime_loop_none || loop->reg_types.at(condition) != bool_type)
+                    return false;
+                comptime_loop_emit(loop, ComptimeLoopOpCondBr, 0, condition,
+                        comptime_loop_edge(loop, cond_br->then_block, cond_br->is_comptime),
+                        comptime_loop_edge(loop, cond_br->else_block, cond_br->is_comptime));
+                continue;
+            }
+            default:
+                return false;
         }
+        loop->values.put(instruction, result);
     }
-    IrInstruction *result = ir_build_optional_wrap(ira, source_instr, wanted_type, value, result_loc_inst);
-    result->value.data.rh_maybe = RuntimeHintOptionalNonNull;
-    return result;
+    return true;
 }
 
-static IrInstruction *ir_analyze_err_wrap_payload(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *value, ZigType *wanted_type, ResultLoc *result_loc)
-{
-    assert(wanted_type->id == ZigTypeIdErrorUnion);
-
-    ZigType *payload_type = wanted_type->data.error_union.payload_type;
-    ZigType *err_set_type = wanted_type->data.error_union.err_set_type;
-    if (instr_is_comptime(value)) {
-        IrInstruction *casted_payload = ir_implicit_cast(ira, value, payload_type);
-        if (type_is_invalid(casted_payload->value.type))
-            return ira->codegen->invalid_instruction;
-
-        ConstExprValue *val = ir_resolve_const(ira, casted_payload, UndefBad);
-        if (!val)
-            return ira->codegen->invalid_instruction;
-
-        ConstExprValue *err_set_val = create_const_vals(1);
-        err_set_val->type = err_set_type;
-        err_set_val->special = ConstValSpecialStatic;
-        err_set_val->data.x_err_set = nullptr;
-
-        IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
-                source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.type = wanted_type;
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        const_instruction->base.value.data.x_err_union.error_set = err_set_val;
-        const_instruction->base.value.data.x_err_union.payload = val;
-        return &const_instruction->base;
+static size_t comptime_loop_successors(ComptimeLoop *loop, IrBasicBlock *bb, IrBasicBlock **out) {
+    ZigList<IrBasicBlock *> *bb_list = &loop->ira->old_irb.exec->basic_block_list;
+    IrBasicBlock *succ[2];
+    size_t succ_count = 0;
+    if (bb->instruction_list.length == 0)
+        return 0;
+    IrInstruction *last = bb->instruction_list.last();
+    if (last->id == IrInstructionIdBr) {
+        succ[succ_count++] = reinterpret_cast<IrInstructionBr *>(last)->dest_block;
+    } else if (last->id == IrInstructionIdCondBr) {
+        succ[succ_count++] = reinterpret_cast<IrInstructionCondBr *>(last)->then_block;
+        succ[succ_count++] = reinterpret_cast<IrInstructionCondBr *>(last)->else_block;
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < succ_count; i += 1) {
+        if (succ[i]->index < bb_list->length && bb_list->at(succ[i]->index) == succ[i])
+            out[count++] = succ[i];
+    }
+    return count;
+}
+
+// The blocks of the loop are the ones reachable from the header that can get
+// back to it. They are lowered starting at the header, so a var used in the
+// loop but declared in an enclosing loop body resolves to its current storage.
+static bool comptime_loop_lower(ComptimeLoop *loop) {
+    ZigList<IrBasicBlock *> *bb_list = &loop->ira->old_irb.exec->basic_block_list;
+    size_t bb_count = bb_list->length;
+    IrBasicBlock *header = loop->header;
+    loop->blocks = allocate<ComptimeLoopBlock>(bb_count);
+
+    for (size_t i = 0; i < header->instruction_list.length; i += 1) {
+        if (header->instruction_list.at(i)->id == IrInstructionIdPhi)
+            return false;
     }
 
-    IrInstruction *result_loc_inst;
-    if (handle_is_ptr(wanted_type)) {
-        if (result_loc == nullptr) result_loc = no_result_loc();
-        result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, wanted_type, nullptr, true, false);
-        if (type_is_invalid(result_loc_inst->value.type) || instr_is_unreachable(result_loc_inst)) {
-            return result_loc_inst;
+    IrBasicBlock *succ[2];
+    ZigList<IrBasicBlock *> stack = {0};
+    loop->blocks[header->index].reachable = true;
+    stack.append(header);
+    while (stack.length != 0) {
+        IrBasicBlock *bb = stack.pop();
+        size_t succ_count = comptime_loop_successors(loop, bb, succ);
+        for (size_t i = 0; i < succ_count; i += 1) {
+            if (!loop->blocks[succ[i]->index].reachable) {
+                loop->blocks[succ[i]->index].reachable = true;
+                stack.append(succ[i]);
+            }
         }
-    } else {
-        result_loc_inst = nullptr;
     }
+    stack.deinit();
 
-    IrInstruction *result = ir_build_err_wrap_payload(ira, source_instr, wanted_type, value, result_loc_inst);
-    result->value.data.rh_error_union = RuntimeHintErrorUnionNonError;
-    return result;
-}
-
-static IrInstruction *ir_analyze_err_set_cast(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value,
-        ZigType *wanted_type)
-{
-    assert(value->value.type->id == ZigTypeIdErrorSet);
-    assert(wanted_type->id == ZigTypeIdErrorSet);
-
-    if (instr_is_comptime(value)) {
-        ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
-        if (!val)
-            return ira->codegen->invalid_instruction;
-
-        if (!resolve_inferred_error_set(ira->codegen, wanted_type, source_instr->source_node)) {
-            return ira->codegen->invalid_instruction;
-        }
-        if (!type_is_global_error_set(wanted_type)) {
-            bool subset = false;
-            for (uint32_t i = 0, count = wanted_type->data.error_set.err_count; i < count; i += 1) {
-                if (wanted_type->data.error_set.errors[i]->value == val->data.x_err_set->value) {
-                    subset = true;
+    loop->blocks[header->index].in_region = true;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = bb_count; i != 0; i -= 1) {
+            ComptimeLoopBlock *block = &loop->blocks[i - 1];
+            if (!block->reachable || block->in_region)
+                continue;
+            size_t succ_count = comptime_loop_successors(loop, bb_list->at(i - 1), succ);
+            for (size_t j = 0; j < succ_count; j += 1) {
+                if (loop->blocks[succ[j]->index].in_region) {
+                    block->in_region = true;
+                    changed = true;
                     break;
                 }
             }
-            if (!subset) {
-                ir_add_error(ira, source_instr,
-                    buf_sprintf("error.%s not a member of error set '%s'",
-                        buf_ptr(&val->data.x_err_set->name), buf_ptr(&wanted_type->name)));
-                return ira->codegen->invalid_instruction;
-            }
         }
-
-        IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
-                source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.type = wanted_type;
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        const_instruction->base.value.data.x_err_set = val->data.x_err_set;
-        return &const_instruction->base;
     }
 
-    IrInstruction *result = ir_build_cast(&ira->new_irb, source_instr->scope, source_instr->source_node, wanted_type, value, CastOpErrSet);
-    result->value.type = wanted_type;
-    return result;
+    loop->void_reg = comptime_loop_add_reg(loop, loop->ira->codegen->builtin_types.entry_void, true, 0);
+    for (size_t n = 0; n < bb_count; n += 1) {
+        size_t i = (header->index + n) % bb_count;
+        ComptimeLoopBlock *block = &loop->blocks[i];
+        if (!block->in_region)
+            continue;
+        block->op_begin = loop->ops.length;
+        block->lowered = comptime_loop_lower_bb(loop, bb_list->at(i));
+        block->op_end = loop->ops.length;
+    }
+    return loop->blocks[header->index].lowered;
 }
 
-static IrInstruction *ir_analyze_err_wrap_code(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value,
-        ZigType *wanted_type, ResultLoc *result_loc)
-{
-    assert(wanted_type->id == ZigTypeIdErrorUnion);
-
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, wanted_type->data.error_union.err_set_type);
-
-    if (instr_is_comptime(casted_value)) {
-        ConstExprValue *val = ir_resolve_const(ira, casted_value, UndefBad);
-        if (!val)
-            return ira->codegen->invalid_instruction;
-
-        ConstExprValue *err_set_val = create_const_vals(1);
-        err_set_val->special = ConstValSpecialStatic;
-        err_set_val->type = wanted_type->data.error_union.err_set_type;
-        err_set_val->data.x_err_set = val->data.x_err_set;
-
-        IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
-                source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.type = wanted_type;
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        const_instruction->base.value.data.x_err_union.error_set = err_set_val;
-        const_instruction->base.value.data.x_err_union.payload = nullptr;
-        return &const_instruction->base;
+static bool comptime_loop_mul(uint64_t a, uint64_t b, bool is_signed, uint64_t *out) {
+    if (!is_signed) {
+        if (a != 0 && b > UINT64_MAX / a)
+            return false;
+        *out = a * b;
+        return true;
+    }
+    bool a_negative = (int64_t)a < 0;
+    bool b_negative = (int64_t)b < 0;
+    uint64_t a_magnitude = a_negative ? (0 - a) : a;
+    uint64_t b_magnitude = b_negative ? (0 - b) : b;
+    if (a_magnitude != 0 && b_magnitude > UINT64_MAX / a_magnitude)
+        return false;
+    uint64_t magnitude = a_magnitude * b_magnitude;
+    if (a_negative != b_negative) {
+        if (magnitude > (((uint64_t)1) << 63))
+            return false;
+        *out = 0 - magnitude;
+    } else {
+        if (magnitude > (uint64_t)INT64_MAX)
+            return false;
+        *out = magnitude;
     }
+    return true;
+}
 
-    IrInstruction *result_loc_inst;
-    if (handle_is_ptr(wanted_type)) {
-        if (result_loc == nullptr) result_loc = no_result_loc();
-        result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, wanted_type, nullptr, true, false);
-        if (type_is_invalid(result_loc_inst->value.type) || instr_is_unreachable(result_loc_inst)) {
-            return result_loc_inst;
-        }
-    } else {
-        result_loc_inst = nullptr;
+// Returns false where analysis would report an error, or where the operands
+// are outside what is checked here, so that analysis runs the iteration.
+static bool comptime_loop_bin_op(const ComptimeLoopOp *op, uint64_t a, uint64_t b, uint64_t *out) {
+    uint32_t bits = op->bits;
+    bool is_signed = op->is_signed;
+    int64_t sa = (int64_t)a;
+    int64_t sb = (int64_t)b;
+    uint64_t r;
+    switch (op->bin_op) {
+        case IrBinOpAdd:
+            r = a + b;
+            if (is_signed ? (((sa ^ (int64_t)r) & (sb ^ (int64_t)r)) < 0) : (r < a))
+                return false;
+            break;
+        case IrBinOpSub:
+            r = a - b;
+            if (is_signed ? (((sa ^ sb) & (sa ^ (int64_t)r)) < 0) : (a < b))
+                return false;
+            break;
+        case IrBinOpMult:
+            if (!comptime_loop_mul(a, b, is_signed, &r))
+                return false;
+            break;
+        case IrBinOpAddWrap:
+            *out = comptime_loop_truncate(a + b, bits, is_signed);
+            return true;
+        case IrBinOpSubWrap:
+            *out = comptime_loop_truncate(a - b, bits, is_signed);
+            return true;
+        case IrBinOpMultWrap:
+            *out = comptime_loop_truncate(a * b, bits, is_signed);
+            return true;
+        case IrBinOpDivUnspecified:
+        case IrBinOpRemUnspecified:
+            if (b == 0 || (is_signed && (sa < 0 || sb <= 0)))
+                return false;
+            r = (op->bin_op == IrBinOpDivUnspecified) ? (a / b) : (a % b);
+            break;
+        case IrBinOpDivExact:
+        case IrBinOpDivTrunc:
+        case IrBinOpDivFloor:
+            if (b == 0)
+                return false;
+            if (!is_signed) {
+                if (op->bin_op == IrBinOpDivExact && a % b != 0)
+                    return false;
+                r = a / b;
+                break;
+            }
+            if (sa == INT64_MIN && sb == -1)
+                return false;
+            if (op->bin_op == IrBinOpDivExact && sa % sb != 0)
+                return false;
+            if (op->bin_op == IrBinOpDivFloor && sa % sb != 0 && ((sa < 0) != (sb < 0))) {
+                r = (uint64_t)(sa / sb - 1);
+            } else {
+                r = (uint64_t)(sa / sb);
+            }
+            break;
+        case IrBinOpRemRem:
+        case IrBinOpRemMod:
+            if (!is_signed) {
+                if (b == 0)
+                    return false;
+                r = a % b;
+                break;
+            }
+            if (sb <= 0)
+                return false;
+            if (op->bin_op == IrBinOpRemMod && sa % sb < 0) {
+                r = (uint64_t)(sa % sb + sb);
+            } else {
+                r = (uint64_t)(sa % sb);
+            }
+            break;
+        case IrBinOpBinOr:
+            r = a | b;
+            break;
+        case IrBinOpBinXor:
+            r = a ^ b;
+            break;
+        case IrBinOpBinAnd:
+            r = a & b;
+            break;
+        case IrBinOpBitShiftLeftLossy:
+        case IrBinOpBitShiftLeftExact:
+            if (b >= bits)
+                return false;
+            r = comptime_loop_truncate(a << b, bits, is_signed);
+            if (op->bin_op == IrBinOpBitShiftLeftExact &&
+                (is_signed ? (((int64_t)r >> b) != sa) : ((r >> b) != a)))
+            {
+                return false;
+            }
+            *out = r;
+            return true;
+        case IrBinOpBitShiftRightLossy:
+        case IrBinOpBitShiftRightExact:
+            if (b >= bits)
+                return false;
+            if (op->bin_op == IrBinOpBitShiftRightExact && (a & ((((uint64_t)1) << b) - 1)) != 0)
+                return false;
+            *out = is_signed ? (uint64_t)(sa >> b) : (a >> b);
+            return true;
+        default:
+            zig_unreachable();
     }
-
-
-    IrInstruction *result = ir_build_err_wrap_code(ira, source_instr, wanted_type, value, result_loc_inst);
-    result->value.data.rh_error_union = RuntimeHintErrorUnionError;
-    return result;
+    if (comptime_loop_truncate(r, bits, is_signed) != r)
+        return false;
+    *out = r;
+    return true;
 }
 
-static IrInstruction *ir_analyze_null_to_maybe(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value, ZigType *wanted_type) {
-    assert(wanted_type->id == ZigTypeIdOptional);
-    assert(instr_is_comptime(value));
-
-    ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
-    assert(val != nullptr);
-
-    IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-    result->value.special = ConstValSpecialStatic;
-    if (get_codegen_ptr_type(wanted_type) != nullptr) {
-        result->value.data.x_ptr.special = ConstPtrSpecialNull;
-    } else if (is_opt_err_set(wanted_type)) {
-        result->value.data.x_err_set = nullptr;
-    } else {
-        result->value.data.x_optional = nullptr;
+static bool comptime_loop_cmp(const ComptimeLoopOp *op, uint64_t a, uint64_t b) {
+    int64_t sa = (int64_t)a;
+    int64_t sb = (int64_t)b;
+    switch (op->bin_op) {
+        case IrBinOpCmpEq:
+            return a == b;
+        case IrBinOpCmpNotEq:
+            return a != b;
+        case IrBinOpCmpLessThan:
+            return op->is_signed ? (sa < sb) : (a < b);
+        case IrBinOpCmpGreaterThan:
+            return op->is_signed ? (sa > sb) : (a > b);
+        case IrBinOpCmpLessOrEq:
+            return op->is_signed ? (sa <= sb) : (a <= b);
+        case IrBinOpCmpGreaterOrEq:
+            return op->is_signed ? (sa >= sb) : (a >= b);
+        default:
+            zig_unreachable();
     }
-    return result;
 }
 
-static IrInstruction *ir_analyze_null_to_c_pointer(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *value, ZigType *wanted_type)
+static bool comptime_loop_elem_index(const ComptimeLoopOp *op, const ComptimeLoopArray *loop_array,
+        uint64_t index)
 {
-    assert(wanted_type->id == ZigTypeIdPointer);
-    assert(wanted_type->data.pointer.ptr_len == PtrLenC);
-    assert(instr_is_comptime(value));
-
-    ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
-    assert(val != nullptr);
-
-    IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-    result->value.data.x_ptr.special = ConstPtrSpecialNull;
-    result->value.data.x_ptr.mut = ConstPtrMutComptimeConst;
-    return result;
+    return !(op->is_signed && (int64_t)index < 0) && index < loop_array->len;
 }
 
-static IrInstruction *ir_get_ref(IrAnalyze *ira, IrInstruction *source_instruction, IrInstruction *value,
-        bool is_const, bool is_volatile)
-{
-    Error err;
-
-    if (type_is_invalid(value->value.type))
-        return ira->codegen->invalid_instruction;
+// Called after a backward branch to header has been counted. Runs as many
+// whole iterations as it can and leaves the comptime vars of the loop as
+// they were at the start of the first iteration it could not finish. A loop
+// that can't finish its first iteration here is not lowered again.
+static void ir_run_comptime_loop(IrAnalyze *ira, IrBasicBlock *header) {
+    if (header->comptime_loop_unsupported || ira->codegen->verbose_ir)
+        return;
 
-    if ((err = type_resolve(ira->codegen, value->value.type, ResolveStatusZeroBitsKnown)))
-        return ira->codegen->invalid_instruction;
+    CodeGen *g = ira->codegen;
+    ComptimeLoop *loop = allocate<ComptimeLoop>(1);
+    loop->ira = ira;
+    loop->header = header;
+    loop->values.init(64);
+    loop->var_ptrs.init(16);
+    loop->var_table.init(16);
+    loop->array_ptrs.init(16);
+    loop->array_table.init(16);
+    loop->elem_ptrs.init(16);
+
+    size_t iterations = 0;
+    bool unsupported = true;
+    if (comptime_loop_lower(loop)) {
+        IrBasicBlock **bb_items = ira->old_irb.exec->basic_block_list.items;
+        size_t *bbc = ira->new_irb.exec->backward_branch_count;
+        size_t *quota = ira->new_irb.exec->backward_branch_quota;
+        uint64_t *regs = loop->regs.items;
+        ComptimeLoopArray *arrays = loop->arrays.items;
+        uint64_t *saved_regs = allocate_nonzero<uint64_t>(loop->vars.length);
+        size_t saved_bbc = *bbc;
+        size_t saved_backward_branches = g->backward_branches;
+        IrInstruction *first_store = nullptr;
+        for (size_t i = 0; i < loop->vars.length; i += 1) {
+            saved_regs[i] = regs[loop->vars.at(i).reg];
+        }
+
+        uint32_t pred = comptime_loop_none;
+        uint32_t cur = (uint32_t)header->index;
+        for (;;) {
+            ComptimeLoopBlock *block = &loop->blocks[cur];
+            if (!block->lowered)
+                break;
+            uint32_t next = comptime_loop_none;
+            for (size_t op_i = block->op_begin; op_i < block->op_end; op_i += 1) {
+                const ComptimeLoopOp *op = &loop->ops.items[op_i];
+                switch (op->id) {
+                    case ComptimeLoopOpCopy:
+                        regs[op->dest] = regs[op->a];
+                        continue;
+                    case ComptimeLoopOpStore:
+                        regs[op->dest] = regs[op->a];
+                        if (first_store == nullptr)
+                            first_store = op->source;
+                        continue;
+                    case ComptimeLoopOpBinOp:
+                        if (!comptime_loop_bin_op(op, regs[op->a], regs[op->b], &regs[op->dest]))
+                            goto done;
+                        continue;
+                    case ComptimeLoopOpCmp:
+                        regs[op->dest] = comptime_loop_cmp(op, regs[op->a], regs[op->b]) ? 1 : 0;
+                        continue;
+                    case ComptimeLoopOpBoolNot:
+                        regs[op->dest] = regs[op->a] ^ 1;
+                        continue;
+                    case ComptimeLoopOpPhi: {
+                        const ComptimeLoopPhiEntry *entries = &loop->phi_entries.items[op->a];
+                        uint32_t j = 0;
+                        while (j < op->b && entries[j].pred != pred) {
+                            j += 1;
+                        }
+                        if (j == op->b)
+                            goto done;
+                        regs[op->dest] = regs[entries[j].reg];
+                        continue;
+                    }
+                    case ComptimeLoopOpLoadElem: {
+                        ComptimeLoopArray *loop_array = &arrays[op->a];
+                        uint64_t index = regs[op->b];
+                        if (!comptime_loop_elem_index(op, loop_array, index) || !loop_array->defined[index])
+                            goto done;
+                        regs[op->dest] = loop_array->elems[index];
+                        continue;
+                    }
+                    case ComptimeLoopOpStoreElem: {
+                        ComptimeLoopArray *loop_array = &arrays[op->c];
+                        uint64_t index = regs[op->b];
+                        if (!comptime_loop_elem_index(op, loop_array, index))
+                            goto done;
+                        ComptimeLoopUndo *undo = loop->undo_log.add_one();
+                        undo->array = op->c;
+                        undo->elem_index = index;
+                        undo->value = loop_array->elems[index];
+                        undo->defined = loop_array->defined[index];
+                        loop_array->elems[index] = regs[op->a];
+                        loop_array->defined[index] = true;
+                        if (first_store == nullptr)
+                            first_store = op->source;
+                        continue;
+                    }
+                    case ComptimeLoopOpBr:
+                        next = op->b;
+                        continue;
+                    case ComptimeLoopOpCondBr:
+                        next = (regs[op->a] != 0) ? op->b : op->c;
+                        continue;
+                }
+                zig_unreachable();
+            }
+            if (next == comptime_loop_none) {
+                unsupported = false;
+                break;
+            }
 
-    if (instr_is_comptime(value)) {
-        ConstExprValue *val = ir_resolve_const(ira, value, UndefOk);
-        if (!val)
-            return ira->codegen->invalid_instruction;
-        return ir_get_const_ptr(ira, source_instruction, val, value->value.type,
-                ConstPtrMutComptimeConst, is_const, is_volatile, 0);
+            if (bb_items[next]->debug_id <= bb_items[cur]->debug_id) {
+                // Leave the error for going over quota to ir_emit_backward_branch.
+                if (*bbc >= *quota) {
+                    unsupported = false;
+                    break;
+                }
+                *bbc += 1;
+                g->backward_branches += 1;
+            }
+            if (next == header->index) {
+                iterations += 1;
+                for (size_t i = 0; i < loop->vars.length; i += 1) {
+                    saved_regs[i] = regs[loop->vars.at(i).reg];
+                }
+                loop->undo_log.clear();
+                saved_bbc = *bbc;
+                saved_backward_branches = g->backward_branches;
+                IrBasicBlock *new_bb = ira->new_irb.current_basic_block;
+                if (first_store != nullptr && new_bb->must_be_comptime_source_instr == nullptr)
+                    new_bb->must_be_comptime_source_instr = first_store;
+            }
+            pred = cur;
+            cur = next;
+        }
+done:
+        *bbc = saved_bbc;
+        g->backward_branches = saved_backward_branches;
+        for (size_t i = 0; i < loop->vars.length; i += 1) {
+            ComptimeLoopVar *loop_var = &loop->vars.at(i);
+            if (loop_var->storage != nullptr && loop_var->written)
+                comptime_loop_write_val(loop_var->storage, saved_regs[i]);
+        }
+        for (size_t i = loop->undo_log.length; i != 0; i -= 1) {
+            ComptimeLoopUndo *undo = &loop->undo_log.at(i - 1);
+            arrays[undo->array].elems[undo->elem_index] = undo->value;
+            arrays[undo->array].defined[undo->elem_index] = undo->defined;
+        }
+        for (size_t i = 0; i < loop->arrays.length && iterations != 0; i += 1) {
+            ComptimeLoopArray *loop_array = &arrays[i];
+            if (!loop_array->written)
+                continue;
+            if (loop_array->storage->data.x_array.special == ConstArraySpecialBuf) {
+                Buf *bytes = ir_own_packed_bytes(loop_array->storage);
+                for (size_t j = 0; j < loop_array->len; j += 1) {
+                    buf_ptr(bytes)[j] = (char)loop_array->elems[j];
+                }
+                continue;
+            }
+            ConstExprValue *elements = loop_array->storage->data.x_array.data.s_none.elements;
+            for (size_t j = 0; j < loop_array->len; j += 1) {
+                if (!loop_array->defined[j])
+                    continue;
+                elements[j].special = ConstValSpecialStatic;
+                comptime_loop_write_val(&elements[j], loop_array->elems[j]);
+            }
+        }
+        free(saved_regs);
     }
 
-    ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, value->value.type,
-            is_const, is_volatile, PtrLenSingle, 0, 0, 0, false);
+    g->comptime_loop_iterations += iterations;
+    if (iterations == 0 && unsupported)
+        header->comptime_loop_unsupported = true;
 
-    IrInstruction *result_loc;
-    if (type_has_bits(ptr_type) && !handle_is_ptr(value->value.type)) {
-        result_loc = ir_resolve_result(ira, source_instruction, no_result_loc(), value->value.type, nullptr, true, false);
-    } else {
-        result_loc = nullptr;
+    loop->ops.deinit();
+    loop->phi_entries.deinit();
+    loop->reg_types.deinit();
+    loop->reg_is_const.deinit();
+    loop->regs.deinit();
+    loop->vars.deinit();
+    for (size_t i = 0; i < loop->arrays.length; i += 1) {
+        free(loop->arrays.at(i).elems);
+        free(loop->arrays.at(i).defined);
     }
-
-    IrInstruction *new_instruction = ir_build_ref_gen(ira, source_instruction, ptr_type, value, result_loc);
-    new_instruction->value.data.rh_ptr = RuntimeHintPtrStack;
-    return new_instruction;
+    loop->arrays.deinit();
+    loop->undo_log.deinit();
+    loop->values.deinit();
+    loop->var_ptrs.deinit();
+    loop->var_table.deinit();
+    loop->array_ptrs.deinit();
+    loop->array_table.deinit();
+    loop->elem_ptrs.deinit();
+    free(loop->blocks);
+    free(loop);
 }
 
-static IrInstruction *ir_analyze_array_to_slice(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *array_arg, ZigType *wanted_type, ResultLoc *result_loc)
-{
-    assert(is_slice(wanted_type));
-    // In this function we honor the const-ness of wanted_type, because
-    // we may be casting [0]T to []const T which is perfectly valid.
-
-    IrInstruction *array_ptr = nullptr;
-    IrInstruction *array;
-    if (array_arg->value.type->id == ZigTypeIdPointer) {
-        array = ir_get_deref(ira, source_instr, array_arg, nullptr);
-        array_ptr = array_arg;
-    } else {
-        array = array_arg;
+static IrInstruction *ir_inline_bb(IrAnalyze *ira, IrInstruction *source_instruction, IrBasicBlock *old_bb) {
+    if (old_bb->debug_id <= ira->old_irb.current_basic_block->debug_id) {
+        if (!ir_emit_backward_branch(ira, source_instruction))
+            return ir_unreach_error(ira);
+        ir_run_comptime_loop(ira, old_bb);
     }
-    ZigType *array_type = array->value.type;
-    assert(array_type->id == ZigTypeIdArray);
 
-    if (instr_is_comptime(array) || array_type->data.array.len == 0) {
-        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-        init_const_slice(ira->codegen, &result->value, &array->value, 0, array_type->data.array.len, true);
-        result->value.type = wanted_type;
-        return result;
-    }
+    old_bb->other = ira->old_irb.current_basic_block->other;
+    ir_start_bb(ira, old_bb, ira->old_irb.current_basic_block);
+    return ira->codegen->unreach_instruction;
+}
 
-    IrInstruction *start = ir_const(ira, source_instr, ira->codegen->builtin_types.entry_usize);
-    init_const_usize(ira->codegen, &start->value, 0);
+static IrInstruction *ir_finish_anal(IrAnalyze *ira, IrInstruction *instruction) {
+    if (instruction->value->type->id == ZigTypeIdUnreachable)
+        ir_finish_bb(ira);
+    return instruction;
+}
 
-    IrInstruction *end = ir_const(ira, source_instr, ira->codegen->builtin_types.entry_usize);
-    init_const_usize(ira->codegen, &end->value, array_type->data.array.len);
+static IrInstruction *ir_const_type(IrAnalyze *ira, IrInstruction *source_instruction, ZigType *ty) {
+    IrInstruction *result = ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_type);
+    result->value->data.x_type = ty;
+    return result;
+}
 
-    if (!array_ptr) array_ptr = ir_get_ref(ira, source_instr, array, true, false);
+static IrInstruction *ir_const_bool(IrAnalyze *ira, IrInstruction *source_instruction, bool value) {
+    IrInstruction *result = ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_bool);
+    result->value->data.x_bool = value;
+    return result;
+}
 
-    if (result_loc == nullptr) result_loc = no_result_loc();
-    IrInstruction *result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, wanted_type, nullptr, true, false);
-    if (type_is_invalid(result_loc_inst->value.type) || instr_is_unreachable(result_loc_inst)) {
-        return result_loc_inst;
-    }
-    IrInstruction *result = ir_build_slice_gen(ira, source_instr, wanted_type, array_ptr, start, end, false, result_loc_inst);
-    result->value.data.rh_slice.id = RuntimeHintSliceIdLen;
-    result->value.data.rh_slice.len = array_type->data.array.len;
+static IrInstruction *ir_const_undef(IrAnalyze *ira, IrInstruction *source_instruction, ZigType *ty) {
+    IrInstruction *result = ir_const(ira, source_instruction, ty);
+    result->value->special = ConstValSpecialUndef;
+    return result;
+}
 
+static IrInstruction *ir_const_unreachable(IrAnalyze *ira, IrInstruction *source_instruction) {
+    IrInstruction *result = ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_unreachable);
+    result->value->special = ConstValSpecialStatic;
     return result;
 }
 
-static ZigType *ir_resolve_union_tag_type(IrAnalyze *ira, IrInstruction *source_instr, ZigType *union_type) {
-    assert(union_type->id == ZigTypeIdUnion);
+static IrInstruction *ir_const_void(IrAnalyze *ira, IrInstruction *source_instruction) {
+    return ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_void);
+}
 
-    Error err;
-    if ((err = type_resolve(ira->codegen, union_type, ResolveStatusSizeKnown)))
-        return ira->codegen->builtin_types.entry_invalid;
+static IrInstruction *ir_const_unsigned(IrAnalyze *ira, IrInstruction *source_instruction, uint64_t value) {
+    IrInstruction *result = ir_const(ira, source_instruction, ira->codegen->builtin_types.entry_num_lit_int);
+    bigint_init_unsigned(&result->value->data.x_bigint, value);
+    return result;
+}
 
-    AstNode *decl_node = union_type->data.unionation.decl_node;
-    if (decl_node->data.container_decl.auto_enum || decl_node->data.container_decl.init_arg_expr != nullptr) {
-        assert(union_type->data.unionation.tag_type != nullptr);
-        return union_type->data.unionation.tag_type;
-    } else {
-        ErrorMsg *msg = ir_add_error(ira, source_instr, buf_sprintf("union '%s' has no tag",
-            buf_ptr(&union_type->name)));
-        add_error_note(ira->codegen, msg, decl_node, buf_sprintf("consider 'union(enum)' here"));
-        return ira->codegen->builtin_types.entry_invalid;
+static IrInstruction *ir_get_const_ptr(IrAnalyze *ira, IrInstruction *instruction,
+        ConstExprValue *pointee, ZigType *pointee_type,
+        ConstPtrMut ptr_mut, bool ptr_is_const, bool ptr_is_volatile, uint32_t ptr_align)
+{
+    ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, pointee_type,
+            ptr_is_const, ptr_is_volatile, PtrLenSingle, ptr_align, 0, 0, false);
+    IrInstruction *const_instr = ir_const(ira, instruction, ptr_type);
+    ConstExprValue *const_val = const_instr->value;
+    const_val->data.x_ptr.special = ConstPtrSpecialRef;
+    const_val->data.x_ptr.mut = ptr_mut;
+    const_val->data.x_ptr.data.ref.pointee = pointee;
+    return const_instr;
+}
+
+static ConstExprValue *ir_resolve_const(IrAnalyze *ira, IrInstruction *value, UndefAllowed undef_allowed) {
+    switch (value->value->special) {
+        case ConstValSpecialStatic:
+            return value->value;
+        case ConstValSpecialRuntime:
+            if (!type_has_bits(value->value->type)) {
+                return value->value;
+            }
+            ir_add_error(ira, value, buf_sprintf("unable to evaluate constant expression"));
+            return nullptr;
+        case ConstValSpecialUndef:
+            if (undef_allowed == UndefOk) {
+                return value->value;
+            } else {
+                ir_add_error(ira, value, buf_sprintf("use of undefined value here causes undefined behavior"));
+                return nullptr;
+            }
     }
+    zig_unreachable();
 }
 
-static IrInstruction *ir_analyze_enum_to_int(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *target) {
-    Error err;
+// ir_executable is the pass 1 IR of node in scope, or null to generate it here.
+static ConstExprValue *ir_eval_const_value_inner(CodeGen *codegen, Scope *scope, AstNode *node,
+        ZigType *expected_type, size_t *backward_branch_count, size_t *backward_branch_quota,
+        ZigFn *fn_entry, Buf *c_import_buf, AstNode *source_node, Buf *exec_name,
+        IrExecutable *parent_exec, AstNode *expected_type_source_node, IrExecutable *ir_executable)
+{
+    if (expected_type != nullptr && type_is_invalid(expected_type))
+        return codegen->invalid_instruction->value;
 
-    IrInstruction *enum_target;
-    ZigType *enum_type;
-    if (target->value.type->id == ZigTypeIdUnion) {
-        enum_type = ir_resolve_union_tag_type(ira, target, target->value.type);
-        if (type_is_invalid(enum_type))
-            return ira->codegen->invalid_instruction;
-        enum_target = ir_implicit_cast(ira, target, enum_type);
-        if (type_is_invalid(enum_target->value.type))
-            return ira->codegen->invalid_instruction;
-    } else if (target->value.type->id == ZigTypeIdEnum) {
-        enum_target = target;
-        enum_type = target->value.type;
-    } else {
-        ir_add_error(ira, target,
-            buf_sprintf("expected enum, found type '%s'", buf_ptr(&target->value.type->name)));
-        return ira->codegen->invalid_instruction;
+    if (ir_executable == nullptr) {
+        ir_executable = allocate<IrExecutable>(1);
+        ir_executable->source_node = source_node;
+        ir_executable->parent_exec = parent_exec;
+        ir_executable->name = exec_name;
+        ir_executable->is_inline = true;
+        ir_executable->fn_entry = fn_entry;
+        ir_executable->c_import_buf = c_import_buf;
+        ir_executable->begin_scope = scope;
+        ir_gen(codegen, node, scope, ir_executable);
     }
 
-    if ((err = type_resolve(ira->codegen, enum_type, ResolveStatusSizeKnown)))
-        return ira->codegen->invalid_instruction;
-
-    ZigType *tag_type = enum_type->data.enumeration.tag_int_type;
-    assert(tag_type->id == ZigTypeIdInt || tag_type->id == ZigTypeIdComptimeInt);
+    if (ir_executable->invalid)
+        return codegen->invalid_instruction->value;
 
-    // If there is only one possible tag, then we know at comptime what it is.
-    if (enum_type->data.enumeration.layout == ContainerLayoutAuto &&
-        enum_type->data.enumeration.src_field_count == 1)
-    {
-        assert(tag_type == ira->codegen->builtin_types.entry_num_lit_int);
-        IrInstruction *result = ir_const(ira, source_instr, tag_type);
-        init_const_bigint(&result->value, tag_type,
-                &enum_type->data.enumeration.fields[0].value);
-        return result;
+    if (codegen->verbose_ir) {
+        fprintf(stderr, "\nSource: ");
+        ast_render(stderr, node, 4);
+        fprintf(stderr, "\n{ // (IR)\n");
+        ir_print(codegen, stderr, ir_executable, 2);
+        fprintf(stderr, "}\n");
     }
+    IrExecutable *analyzed_executable = allocate<IrExecutable>(1);
+    analyzed_executable->source_node = source_node;
+    analyzed_executable->parent_exec = parent_exec;
+    analyzed_executable->source_exec = ir_executable;
+    analyzed_executable->name = exec_name;
+    analyzed_executable->is_inline = true;
+    analyzed_executable->fn_entry = fn_entry;
+    analyzed_executable->c_import_buf = c_import_buf;
+    analyzed_executable->backward_branch_count = backward_branch_count;
+    analyzed_executable->backward_branch_quota = backward_branch_quota;
+    analyzed_executable->begin_scope = scope;
+    ZigType *result_type = ir_analyze(codegen, ir_executable, analyzed_executable, expected_type, expected_type_source_node);
+    if (type_is_invalid(result_type))
+        return codegen->invalid_instruction->value;
 
-    if (instr_is_comptime(enum_target)) {
-        ConstExprValue *val = ir_resolve_const(ira, enum_target, UndefBad);
-        if (!val)
-            return ira->codegen->invalid_instruction;
-        IrInstruction *result = ir_const(ira, source_instr, tag_type);
-        init_const_bigint(&result->value, tag_type, &val->data.x_enum_tag);
-        return result;
+    if (codegen->verbose_ir) {
+        fprintf(stderr, "{ // (analyzed)\n");
+        ir_print(codegen, stderr, analyzed_executable, 2);
+        fprintf(stderr, "}\n");
     }
 
-    IrInstruction *result = ir_build_widen_or_shorten(&ira->new_irb, source_instr->scope,
-            source_instr->source_node, enum_target);
-    result->value.type = tag_type;
+    return ir_exec_const_result(codegen, analyzed_executable);
+}
+
+static ConstExprValue *ir_eval_const_value_exec(CodeGen *codegen, Scope *scope, AstNode *node,
+        ZigType *expected_type, size_t *backward_branch_count, size_t *backward_branch_quota,
+        ZigFn *fn_entry, Buf *c_import_buf, AstNode *source_node, Buf *exec_name,
+        IrExecutable *parent_exec, AstNode *expected_type_source_node, IrExecutable *ir_executable)
+{
+    size_t ir_bytes_start = ir_arena.bytes_used;
+    codegen->comptime_eval_count += 1;
+    codegen->comptime_eval_depth += 1;
+    static Buf *anonymous_exec_name = buf_create_from_str("comptime");
+    codegen_trace_begin(codegen, "comptime", (exec_name != nullptr) ? exec_name : anonymous_exec_name, node);
+    ConstExprValue *result = ir_eval_const_value_inner(codegen, scope, node, expected_type,
+            backward_branch_count, backward_branch_quota, fn_entry, c_import_buf, source_node,
+            exec_name, parent_exec, expected_type_source_node, ir_executable);
+    codegen_trace_end(codegen);
+    codegen->comptime_eval_depth -= 1;
+    if (codegen->comptime_eval_depth == 0) {
+        codegen->comptime_eval_ir_bytes += ir_arena.bytes_used - ir_bytes_start;
+    }
     return result;
 }
 
-static IrInstruction *ir_analyze_union_to_tag(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *target, ZigType *wanted_type)
+ConstExprValue *ir_eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node,
+        ZigType *expected_type, size_t *backward_branch_count, size_t *backward_branch_quota,
+        ZigFn *fn_entry, Buf *c_import_buf, AstNode *source_node, Buf *exec_name,
+        IrExecutable *parent_exec, AstNode *expected_type_source_node)
 {
-    assert(target->value.type->id == ZigTypeIdUnion);
-    assert(wanted_type->id == ZigTypeIdEnum);
-    assert(wanted_type == target->value.type->data.unionation.tag_type);
+    return ir_eval_const_value_exec(codegen, scope, node, expected_type, backward_branch_count,
+            backward_branch_quota, fn_entry, c_import_buf, source_node, exec_name, parent_exec,
+            expected_type_source_node, nullptr);
+}
 
-    if (instr_is_comptime(target)) {
-        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
-        if (!val)
-            return ira->codegen->invalid_instruction;
-        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-        result->value.special = ConstValSpecialStatic;
-        result->value.type = wanted_type;
-        bigint_init_bigint(&result->value.data.x_enum_tag, &val->data.x_union.tag);
-        return result;
+static ErrorTableEntry *ir_resolve_error(IrAnalyze *ira, IrInstruction *err_value) {
+    if (type_is_invalid(err_value->value->type))
+        return nullptr;
+
+    if (err_value->value->type->id != ZigTypeIdErrorSet) {
+        ir_add_error(ira, err_value,
+                buf_sprintf("expected error, found '%s'", buf_ptr(&err_value->value->type->name)));
+        return nullptr;
     }
 
-    // If there is only 1 possible tag, then we know at comptime what it is.
-    if (wanted_type->data.enumeration.layout == ContainerLayoutAuto &&
-        wanted_type->data.enumeration.src_field_count == 1)
-    {
-        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-        result->value.special = ConstValSpecialStatic;
-        result->value.type = wanted_type;
-        TypeEnumField *enum_field = target->value.type->data.unionation.fields[0].enum_field;
-        bigint_init_bigint(&result->value.data.x_enum_tag, &enum_field->value);
-        return result;
+    ConstExprValue *const_val = ir_resolve_const(ira, err_value, UndefBad);
+    if (!const_val)
+        return nullptr;
+
+    assert(const_val->data.x_err_set != nullptr);
+    return const_val->data.x_err_set;
+}
+
+static ZigType *ir_resolve_type(IrAnalyze *ira, IrInstruction *type_value) {
+    if (type_is_invalid(type_value->value->type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (type_value->value->type->id != ZigTypeIdMetaType) {
+        ir_add_error(ira, type_value,
+                buf_sprintf("expected type 'type', found '%s'", buf_ptr(&type_value->value->type->name)));
+        return ira->codegen->builtin_types.entry_invalid;
     }
 
-    IrInstruction *result = ir_build_union_tag(&ira->new_irb, source_instr->scope,
-            source_instr->source_node, target);
-    result->value.type = wanted_type;
-    return result;
+    ConstExprValue *const_val = ir_resolve_const(ira, type_value, UndefBad);
+    if (!const_val)
+        return ira->codegen->builtin_types.entry_invalid;
+
+    assert(const_val->data.x_type != nullptr);
+    return const_val->data.x_type;
 }
 
-static IrInstruction *ir_analyze_undefined_to_anything(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *target, ZigType *wanted_type)
-{
-    IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-    init_const_undefined(ira->codegen, &result->value);
-    return result;
+static ZigType *ir_resolve_int_type(IrAnalyze *ira, IrInstruction *type_value) {
+    ZigType *ty = ir_resolve_type(ira, type_value);
+    if (type_is_invalid(ty))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (ty->id != ZigTypeIdInt) {
+        ir_add_error(ira, type_value,
+            buf_sprintf("expected integer type, found '%s'", buf_ptr(&ty->name)));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    return ty;
 }
 
-static IrInstruction *ir_analyze_enum_to_union(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *uncasted_target, ZigType *wanted_type)
-{
-    Error err;
-    assert(wanted_type->id == ZigTypeIdUnion);
+static ZigType *ir_resolve_error_set_type(IrAnalyze *ira, IrInstruction *op_source, IrInstruction *type_value) {
+    if (type_is_invalid(type_value->value->type))
+        return ira->codegen->builtin_types.entry_invalid;
 
-    if ((err = type_resolve(ira->codegen, wanted_type, ResolveStatusZeroBitsKnown)))
-        return ira->codegen->invalid_instruction;
+    if (type_value->value->type->id != ZigTypeIdMetaType) {
+        ErrorMsg *msg = ir_add_error(ira, type_value,
+                buf_sprintf("expected error set type, found '%s'", buf_ptr(&type_value->value->type->name)));
+        add_error_note(ira->codegen, msg, op_source->source_node,
+                buf_sprintf("`||` merges error sets; `or` performs boolean OR"));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
 
-    IrInstruction *target = ir_implicit_cast(ira, uncasted_target, wanted_type->data.unionation.tag_type);
-    if (type_is_invalid(target->value.type))
-        return ira->codegen->invalid_instruction;
+    ConstExprValue *const_val = ir_resolve_const(ira, type_value, UndefBad);
+    if (!const_val)
+        return ira->codegen->builtin_types.entry_invalid;
 
-    if (instr_is_comptime(target)) {
-        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
-        if (!val)
+    assert(const_val->data.x_type != nullptr);
+    ZigType *result_type = const_val->data.x_type;
+    if (result_type->id != ZigTypeIdErrorSet) {
+        ErrorMsg *msg = ir_add_error(ira, type_value,
+                buf_sprintf("expected error set type, found type '%s'", buf_ptr(&result_type->name)));
+        add_error_note(ira->codegen, msg, op_source->source_node,
+                buf_sprintf("`||` merges error sets; `or` performs boolean OR"));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+    return result_type;
+}
+
+static ZigFn *ir_resolve_fn(IrAnalyze *ira, IrInstruction *fn_value) {
+    if (fn_value == ira->codegen->invalid_instruction)
+        return nullptr;
+
+    if (type_is_invalid(fn_value->value->type))
+        return nullptr;
+
+    if (fn_value->value->type->id != ZigTypeIdFn) {
+        ir_add_error_node(ira, fn_value->source_node,
+                buf_sprintf("expected function type, found '%s'", buf_ptr(&fn_value->value->type->name)));
+        return nullptr;
+    }
+
+    ConstExprValue *const_val = ir_resolve_const(ira, fn_value, UndefBad);
+    if (!const_val)
+        return nullptr;
+
+    assert(const_val->data.x_ptr.special == ConstPtrSpecialFunction);
+    return const_val->data.x_ptr.data.fn.fn_entry;
+}
+
+static IrInstruction *ir_analyze_optional_wrap(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value,
+        ZigType *wanted_type, ResultLoc *result_loc)
+{
+    assert(wanted_type->id == ZigTypeIdOptional);
+
+    if (instr_is_comptime(value)) {
+        ZigType *payload_type = wanted_type->data.maybe.child_type;
+        IrInstruction *casted_payload = ir_implicit_cast(ira, value, payload_type);
+        if (type_is_invalid(casted_payload->value->type))
             return ira->codegen->invalid_instruction;
-        TypeUnionField *union_field = find_union_field_by_tag(wanted_type, &val->data.x_enum_tag);
-        assert(union_field != nullptr);
-        if ((err = type_resolve(ira->codegen, union_field->type_entry, ResolveStatusZeroBitsKnown)))
+
+        ConstExprValue *val = ir_resolve_const(ira, casted_payload, UndefOk);
+        if (!val)
             return ira->codegen->invalid_instruction;
 
-        switch (type_has_one_possible_value(ira->codegen, union_field->type_entry)) {
-            case OnePossibleValueInvalid:
-                return ira->codegen->invalid_instruction;
-            case OnePossibleValueNo: {
-                AstNode *field_node = wanted_type->data.unionation.decl_node->data.container_decl.fields.at(
-                        union_field->enum_field->decl_index);
-                ErrorMsg *msg = ir_add_error(ira, source_instr,
-                        buf_sprintf("cast to union '%s' must initialize '%s' field '%s'",
-                            buf_ptr(&wanted_type->name),
-                            buf_ptr(&union_field->type_entry->name),
-                            buf_ptr(union_field->name)));
-                add_error_note(ira->codegen, msg, field_node,
-                        buf_sprintf("field '%s' declared here", buf_ptr(union_field->name)));
-                return ira->codegen->invalid_instruction;
-            }
-            case OnePossibleValueYes:
-                break;
+        IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
+                source_instr->scope, source_instr->source_node);
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        if (types_have_same_zig_comptime_repr(wanted_type, payload_type)) {
+            copy_const_val(const_instruction->base.value, val, val->data.x_ptr.mut == ConstPtrMutComptimeConst);
+        } else {
+            const_instruction->base.value->data.x_optional = val;
         }
-
-        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-        result->value.special = ConstValSpecialStatic;
-        result->value.type = wanted_type;
-        bigint_init_bigint(&result->value.data.x_union.tag, &val->data.x_enum_tag);
-        result->value.data.x_union.payload = create_const_vals(1);
-        result->value.data.x_union.payload->special = ConstValSpecialStatic;
-        result->value.data.x_union.payload->type = union_field->type_entry;
-        return result;
+        const_instruction->base.value->type = wanted_type;
+        return &const_instruction->base;
     }
 
-    // if the union has all fields 0 bits, we can do it
-    // and in fact it's a noop cast because the union value is just the enum value
-    if (wanted_type->data.unionation.gen_field_count == 0) {
-        IrInstruction *result = ir_build_cast(&ira->new_irb, target->scope, target->source_node, wanted_type, target, CastOpNoop);
-        result->value.type = wanted_type;
-        return result;
+    if (result_loc == nullptr && handle_is_ptr(wanted_type)) {
+        result_loc = no_result_loc();
     }
-
-    ErrorMsg *msg = ir_add_error(ira, source_instr,
-            buf_sprintf("runtime cast to union '%s' which has non-void fields",
-                buf_ptr(&wanted_type->name)));
-    for (uint32_t i = 0; i < wanted_type->data.unionation.src_field_count; i += 1) {
-        TypeUnionField *union_field = &wanted_type->data.unionation.fields[i];
-        if (type_has_bits(union_field->type_entry)) {
-            AstNode *field_node = wanted_type->data.unionation.decl_node->data.container_decl.fields.at(i);
-            add_error_note(ira->codegen, msg, field_node,
-                    buf_sprintf("field '%s' has type '%s'",
-                        buf_ptr(union_field->name),
-                        buf_ptr(&union_field->type_entry->name)));
+    IrInstruction *result_loc_inst = nullptr;
+    if (result_loc != nullptr) {
+        result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, wanted_type, nullptr, true, false);
+        if (type_is_invalid(result_loc_inst->value->type) || instr_is_unreachable(result_loc_inst)) {
+            return result_loc_inst;
         }
     }
-    return ira->codegen->invalid_instruction;
+    IrInstruction *result = ir_build_optional_wrap(ira, source_instr, wanted_type, value, result_loc_inst);
+    result->value->data.rh_maybe = RuntimeHintOptionalNonNull;
+    return result;
 }
 
-static IrInstruction *ir_analyze_widen_or_shorten(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *target, ZigType *wanted_type)
+static IrInstruction *ir_analyze_err_wrap_payload(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *value, ZigType *wanted_type, ResultLoc *result_loc)
 {
-    bool is_vector = wanted_type->id == ZigTypeIdVector;
-    ZigType *wanted_scalar_type = is_vector ? wanted_type->data.vector.elem_type : wanted_type;
-    assert(wanted_scalar_type->id == ZigTypeIdInt || wanted_scalar_type->id == ZigTypeIdFloat);
-    assert((target->value.type->id == ZigTypeIdVector) == is_vector);
-    if (is_vector) {
-        assert(target->value.type->data.vector.len == wanted_type->data.vector.len);
-    }
+    assert(wanted_type->id == ZigTypeIdErrorUnion);
 
-    if (instr_is_comptime(target)) {
-        ConstExprValue *val = ir_resolve_const(ira, target, UndefOk);
-        if (!val)
+    ZigType *payload_type = wanted_type->data.error_union.payload_type;
+    ZigType *err_set_type = wanted_type->data.error_union.err_set_type;
+    if (instr_is_comptime(value)) {
+        IrInstruction *casted_payload = ir_implicit_cast(ira, value, payload_type);
+        if (type_is_invalid(casted_payload->value->type))
             return ira->codegen->invalid_instruction;
-        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-        if (wanted_scalar_type->id == ZigTypeIdInt || wanted_scalar_type->id == ZigTypeIdFloat) {
-            uint32_t i = 0;
-            uint32_t vector_len = 1;
-            ConstExprValue *sval = val;
-            if (is_vector) {
-                vector_len = val->type->data.vector.len;
-                expand_undef_array(ira->codegen, &result->value);
-                result->value.data.x_array.data.s_none.elements =
-                    allocate<ConstExprValue>(vector_len);
-                sval = &val->data.x_array.data.s_none.elements[0];
-            }
-            while (i < vector_len) {
-                if (sval->special == ConstValSpecialUndef) {
-                    if (is_vector) {
-                        result->value.data.x_array.data.s_none.elements[i].special = ConstValSpecialUndef;
-                        sval = &val->data.x_array.data.s_none.elements[++i];
-                    } else {
-                        result->value.special = ConstValSpecialUndef;
-                    }
-                    continue;
-                }
-                if (wanted_scalar_type->id == ZigTypeIdInt) {
-                    if (bigint_cmp_zero(&sval->data.x_bigint) == CmpLT && !wanted_scalar_type->data.integral.is_signed) {
-                        ErrorMsg *msg = ir_add_error(ira, source_instr,
-                            buf_sprintf("attempt to cast negative value to unsigned integer"));
-                        if (is_vector) {
-                            add_error_note(ira->codegen, msg, source_instr->source_node,
-                                buf_sprintf("when computing vector element at index %" ZIG_PRI_usize, (uintptr_t)i));
-                        }
-                        return ira->codegen->invalid_instruction;
-                    }
-                    if (!bigint_fits_in_bits(&sval->data.x_bigint, wanted_scalar_type->data.integral.bit_count,
-                            wanted_scalar_type->data.integral.is_signed))
-                    {
-                        ErrorMsg *msg = ir_add_error(ira, source_instr,
-                            buf_sprintf("cast from '%s' to '%s' truncates bits",
-                                buf_ptr(&target->value.type->name), buf_ptr(&wanted_type->name)));
-                        if (is_vector) {
-                            add_error_note(ira->codegen, msg, source_instr->source_node,
-                                buf_sprintf("when computing vector element at index %" ZIG_PRI_usize, (uintptr_t)i));
-                        }
-                        return ira->codegen->invalid_instruction;
-                    }
-                }
-                if (is_vector) {
-                    // float_init_float requires this to be set
-                    result->value.data.x_array.data.s_none.elements[i].type = wanted_scalar_type;
-                    if (wanted_scalar_type->id == ZigTypeIdInt) {
-                        bigint_init_bigint(&result->value.data.x_array.data.s_none.elements[i].data.x_bigint,
-                            &sval->data.x_bigint);
-                    } else if (wanted_scalar_type->id == ZigTypeIdFloat) {
-                        float_init_float(&result->value.data.x_array.data.s_none.elements[i], sval);
-                    } else {
-                        zig_unreachable();
-                    }
-                    result->value.data.x_array.data.s_none.elements[i].special = ConstValSpecialStatic;
-                    sval = &val->data.x_array.data.s_none.elements[++i];
-                } else if (wanted_type->id == ZigTypeIdInt) {
-                    bigint_init_bigint(&result->value.data.x_bigint, &sval->data.x_bigint);
-                    break;
-                } else if (wanted_type->id == ZigTypeIdFloat) {
-                    float_init_float(&result->value, sval);
-                    break;
-                } else {
-                    zig_unreachable();
-                }
-            }
-        } else {
-            zig_unreachable();
-        }
-        result->value.type = wanted_type;
-        return result;
-    }
-
-    // If the destination integer type has no bits, then we can emit a comptime
-    // zero. However, we still want to emit a runtime safety check to make sure
-    // the target is zero.
-    if (!type_has_bits(wanted_type)) {
-        assert(wanted_type->id == ZigTypeIdInt);
-        assert(type_has_bits(target->value.type));
-        ir_build_assert_zero(ira, source_instr, target);
-        IrInstruction *result;
-        if (is_vector) {
-            result = ir_const_type(ira, source_instr, wanted_type);
-            result->value.data.x_array.data.s_none.elements =
-                    allocate<ConstExprValue>(wanted_type->data.vector.len);
-            for (uint32_t i = 0; i < wanted_type->data.vector.len; i++) {
-                bigint_init_unsigned(&result->value.data.x_array.data.s_none.elements[i].data.x_bigint, 0);
-            }
-        } else {
-            result = ir_const_unsigned(ira, source_instr, 0);
-        }
-        result->value.type = wanted_type;
-        return result;
-    }
-
-    IrInstruction *result = ir_build_widen_or_shorten(&ira->new_irb, source_instr->scope,
-            source_instr->source_node, target);
-    result->value.type = wanted_type;
-    return result;
-}
-
-static IrInstruction *ir_analyze_int_to_enum(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *target, ZigType *wanted_type)
-{
-    Error err;
-    assert(wanted_type->id == ZigTypeIdEnum);
-
-    ZigType *actual_type = target->value.type;
-
-    if ((err = ensure_complete_type(ira->codegen, wanted_type)))
-        return ira->codegen->invalid_instruction;
-
-    if (actual_type != wanted_type->data.enumeration.tag_int_type) {
-        ir_add_error(ira, source_instr,
-                buf_sprintf("integer to enum cast from '%s' instead of its tag type, '%s'",
-                    buf_ptr(&actual_type->name),
-                    buf_ptr(&wanted_type->data.enumeration.tag_int_type->name)));
-        return ira->codegen->invalid_instruction;
-    }
-
-    assert(actual_type->id == ZigTypeIdInt || actual_type->id == ZigTypeIdComptimeInt);
 
-    if (instr_is_comptime(target)) {
-        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+        ConstExprValue *val = ir_resolve_const(ira, casted_payload, UndefBad);
         if (!val)
             return ira->codegen->invalid_instruction;
 
-        TypeEnumField *field = find_enum_field_by_tag(wanted_type, &val->data.x_bigint);
-        if (field == nullptr) {
-            Buf *val_buf = buf_alloc();
-            bigint_append_buf(val_buf, &val->data.x_bigint, 10);
-            ErrorMsg *msg = ir_add_error(ira, source_instr,
-                buf_sprintf("enum '%s' has no tag matching integer value %s",
-                    buf_ptr(&wanted_type->name), buf_ptr(val_buf)));
-            add_error_note(ira->codegen, msg, wanted_type->data.enumeration.decl_node,
-                    buf_sprintf("'%s' declared here", buf_ptr(&wanted_type->name)));
-            return ira->codegen->invalid_instruction;
-        }
+        ConstExprValue *err_set_val = create_const_vals(1);
+        err_set_val->type = err_set_type;
+        err_set_val->special = ConstValSpecialStatic;
+        err_set_val->data.x_err_set = nullptr;
 
-        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-        bigint_init_bigint(&result->value.data.x_enum_tag, &val->data.x_bigint);
-        return result;
+        IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
+                source_instr->scope, source_instr->source_node);
+        const_instruction->base.value->type = wanted_type;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        const_instruction->base.value->data.x_err_union.error_set = err_set_val;
+        const_instruction->base.value->data.x_err_union.payload = val;
+        return &const_instruction->base;
     }
 
-    IrInstruction *result = ir_build_int_to_enum(&ira->new_irb, source_instr->scope,
-            source_instr->source_node, nullptr, target);
-    result->value.type = wanted_type;
-    return result;
-}
-
-static IrInstruction *ir_analyze_number_to_literal(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *target, ZigType *wanted_type)
-{
-    ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
-    if (!val)
-        return ira->codegen->invalid_instruction;
-
-    IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-    if (wanted_type->id == ZigTypeIdComptimeFloat) {
-        float_init_float(&result->value, val);
-    } else if (wanted_type->id == ZigTypeIdComptimeInt) {
-        bigint_init_bigint(&result->value.data.x_bigint, &val->data.x_bigint);
+    IrInstruction *result_loc_inst;
+    if (handle_is_ptr(wanted_type)) {
+        if (result_loc == nullptr) result_loc = no_result_loc();
+        result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, wanted_type, nullptr, true, false);
+        if (type_is_invalid(result_loc_inst->value->type) || instr_is_unreachable(result_loc_inst)) {
+            return result_loc_inst;
+        }
     } else {
-        zig_unreachable();
+        result_loc_inst = nullptr;
     }
+
+    IrInstruction *result = ir_build_err_wrap_payload(ira, source_instr, wanted_type, value, result_loc_inst);
+    result->value->data.rh_error_union = RuntimeHintErrorUnionNonError;
     return result;
 }
 
-static IrInstruction *ir_analyze_int_to_err(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *target,
-    ZigType *wanted_type)
+static IrInstruction *ir_analyze_err_set_cast(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value,
+        ZigType *wanted_type)
 {
-    assert(target->value.type->id == ZigTypeIdInt);
-    assert(!target->value.type->data.integral.is_signed);
+    assert(value->value->type->id == ZigTypeIdErrorSet);
     assert(wanted_type->id == ZigTypeIdErrorSet);
 
-    if (instr_is_comptime(target)) {
-        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+    if (instr_is_comptime(value)) {
+        ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
         if (!val)
             return ira->codegen->invalid_instruction;
 
-        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-
         if (!resolve_inferred_error_set(ira->codegen, wanted_type, source_instr->source_node)) {
             return ira->codegen->invalid_instruction;
         }
-
-        if (type_is_global_error_set(wanted_type)) {
-            BigInt err_count;
-            bigint_init_unsigned(&err_count, ira->codegen->errors_by_index.length);
-
-            if (bigint_cmp_zero(&val->data.x_bigint) == CmpEQ || bigint_cmp(&val->data.x_bigint, &err_count) != CmpLT) {
-                Buf *val_buf = buf_alloc();
-                bigint_append_buf(val_buf, &val->data.x_bigint, 10);
-                ir_add_error(ira, source_instr,
-                    buf_sprintf("integer value %s represents no error", buf_ptr(val_buf)));
-                return ira->codegen->invalid_instruction;
-            }
-
-            size_t index = bigint_as_unsigned(&val->data.x_bigint);
-            result->value.data.x_err_set = ira->codegen->errors_by_index.at(index);
-            return result;
-        } else {
-            ErrorTableEntry *err = nullptr;
-            BigInt err_int;
-
+        if (!type_is_global_error_set(wanted_type)) {
+            bool subset = false;
             for (uint32_t i = 0, count = wanted_type->data.error_set.err_count; i < count; i += 1) {
-                ErrorTableEntry *this_err = wanted_type->data.error_set.errors[i];
-                bigint_init_unsigned(&err_int, this_err->value);
-                if (bigint_cmp(&val->data.x_bigint, &err_int) == CmpEQ) {
-                    err = this_err;
+                if (wanted_type->data.error_set.errors[i]->value == val->data.x_err_set->value) {
+                    subset = true;
                     break;
                 }
             }
-
-            if (err == nullptr) {
-                Buf *val_buf = buf_alloc();
-                bigint_append_buf(val_buf, &val->data.x_bigint, 10);
+            if (!subset) {
                 ir_add_error(ira, source_instr,
-                    buf_sprintf("integer value %s represents no error in '%s'", buf_ptr(val_buf), buf_ptr(&wanted_type->name)));
+                    buf_sprintf("error.%s not a member of error set '%s'",
+                        buf_ptr(&val->data.x_err_set->name), buf_ptr(&wanted_type->name)));
                 return ira->codegen->invalid_instruction;
             }
-
-            result->value.data.x_err_set = err;
-            return result;
         }
+
+        IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
+                source_instr->scope, source_instr->source_node);
+        const_instruction->base.value->type = wanted_type;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        const_instruction->base.value->data.x_err_set = val->data.x_err_set;
+        return &const_instruction->base;
     }
 
-    IrInstruction *result = ir_build_int_to_err(&ira->new_irb, source_instr->scope, source_instr->source_node, target);
-    result->value.type = wanted_type;
+    IrInstruction *result = ir_build_cast(&ira->new_irb, source_instr->scope, source_instr->source_node, wanted_type, value, CastOpErrSet);
+    result->value->type = wanted_type;
     return result;
 }
 
-static IrInstruction *ir_analyze_err_to_int(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *target,
-        ZigType *wanted_type)
+static IrInstruction *ir_analyze_err_wrap_code(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value,
+        ZigType *wanted_type, ResultLoc *result_loc)
 {
-    assert(wanted_type->id == ZigTypeIdInt);
+    assert(wanted_type->id == ZigTypeIdErrorUnion);
 
-    ZigType *err_type = target->value.type;
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, wanted_type->data.error_union.err_set_type);
 
-    if (instr_is_comptime(target)) {
-        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+    if (instr_is_comptime(casted_value)) {
+        ConstExprValue *val = ir_resolve_const(ira, casted_value, UndefBad);
         if (!val)
             return ira->codegen->invalid_instruction;
 
-        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-
-        ErrorTableEntry *err;
-        if (err_type->id == ZigTypeIdErrorUnion) {
-            err = val->data.x_err_union.error_set->data.x_err_set;
-        } else if (err_type->id == ZigTypeIdErrorSet) {
-            err = val->data.x_err_set;
-        } else {
-            zig_unreachable();
-        }
-        result->value.type = wanted_type;
-        uint64_t err_value = err ? err->value : 0;
-        bigint_init_unsigned(&result->value.data.x_bigint, err_value);
-
-        if (!bigint_fits_in_bits(&result->value.data.x_bigint,
-            wanted_type->data.integral.bit_count, wanted_type->data.integral.is_signed))
-        {
-            ir_add_error_node(ira, source_instr->source_node,
-                    buf_sprintf("error code '%s' does not fit in '%s'",
-                        buf_ptr(&err->name), buf_ptr(&wanted_type->name)));
-            return ira->codegen->invalid_instruction;
-        }
+        ConstExprValue *err_set_val = create_const_vals(1);
+        err_set_val->special = ConstValSpecialStatic;
+        err_set_val->type = wanted_type->data.error_union.err_set_type;
+        err_set_val->data.x_err_set = val->data.x_err_set;
 
-        return result;
+        IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
+                source_instr->scope, source_instr->source_node);
+        const_instruction->base.value->type = wanted_type;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        const_instruction->base.value->data.x_err_union.error_set = err_set_val;
+        const_instruction->base.value->data.x_err_union.payload = nullptr;
+        return &const_instruction->base;
     }
 
-    ZigType *err_set_type;
-    if (err_type->id == ZigTypeIdErrorUnion) {
-        err_set_type = err_type->data.error_union.err_set_type;
-    } else if (err_type->id == ZigTypeIdErrorSet) {
-        err_set_type = err_type;
-    } else {
-        zig_unreachable();
-    }
-    if (!type_is_global_error_set(err_set_type)) {
-        if (!resolve_inferred_error_set(ira->codegen, err_set_type, source_instr->source_node)) {
-            return ira->codegen->invalid_instruction;
-        }
-        if (err_set_type->data.error_set.err_count == 0) {
-            IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-            bigint_init_unsigned(&result->value.data.x_bigint, 0);
-            return result;
-        } else if (err_set_type->data.error_set.err_count == 1) {
-            IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-            ErrorTableEntry *err = err_set_type->data.error_set.errors[0];
-            bigint_init_unsigned(&result->value.data.x_bigint, err->value);
-            return result;
+    IrInstruction *result_loc_inst;
+    if (handle_is_ptr(wanted_type)) {
+        if (result_loc == nullptr) result_loc = no_result_loc();
+        result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, wanted_type, nullptr, true, false);
+        if (type_is_invalid(result_loc_inst->value->type) || instr_is_unreachable(result_loc_inst)) {
+            return result_loc_inst;
         }
+    } else {
+        result_loc_inst = nullptr;
     }
 
-    BigInt bn;
-    bigint_init_unsigned(&bn, ira->codegen->errors_by_index.length);
-    if (!bigint_fits_in_bits(&bn, wanted_type->data.integral.bit_count, wanted_type->data.integral.is_signed)) {
-        ir_add_error_node(ira, source_instr->source_node,
-                buf_sprintf("too many error values to fit in '%s'", buf_ptr(&wanted_type->name)));
-        return ira->codegen->invalid_instruction;
-    }
 
-    IrInstruction *result = ir_build_err_to_int(&ira->new_irb, source_instr->scope, source_instr->source_node, target);
-    result->value.type = wanted_type;
+    IrInstruction *result = ir_build_err_wrap_code(ira, source_instr, wanted_type, value, result_loc_inst);
+    result->value->data.rh_error_union = RuntimeHintErrorUnionError;
     return result;
 }
 
-static IrInstruction *ir_analyze_ptr_to_array(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *target,
-        ZigType *wanted_type)
+static IrInstruction *ir_analyze_null_to_maybe(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value, ZigType *wanted_type) {
+    assert(wanted_type->id == ZigTypeIdOptional);
+    assert(instr_is_comptime(value));
+
+    ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
+    assert(val != nullptr);
+
+    IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+    result->value->special = ConstValSpecialStatic;
+    if (get_codegen_ptr_type(wanted_type) != nullptr) {
+        result->value->data.x_ptr.special = ConstPtrSpecialNull;
+    } else if (is_opt_err_set(wanted_type)) {
+        result->value->data.x_err_set = nullptr;
+    } else {
+        result->value->data.x_optional = nullptr;
+    }
+    return result;
+}
+
+static IrInstruction *ir_analyze_null_to_c_pointer(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *value, ZigType *wanted_type)
 {
     assert(wanted_type->id == ZigTypeIdPointer);
+    assert(wanted_type->data.pointer.ptr_len == PtrLenC);
+    assert(instr_is_comptime(value));
+
+    ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
+    assert(val != nullptr);
+
+    IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+    result->value->data.x_ptr.special = ConstPtrSpecialNull;
+    result->value->data.x_ptr.mut = ConstPtrMutComptimeConst;
+    return result;
+}
+
+static IrInstruction *ir_get_ref(IrAnalyze *ira, IrInstruction *source_instruction, IrInstruction *value,
+        bool is_const, bool is_volatile)
+{
     Error err;
-    if ((err = type_resolve(ira->codegen, target->value.type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
+
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
-    assert((wanted_type->data.pointer.is_const && target->value.type->data.pointer.is_const) || !target->value.type->data.pointer.is_const);
-    wanted_type = adjust_ptr_align(ira->codegen, wanted_type, get_ptr_align(ira->codegen, target->value.type));
-    ZigType *array_type = wanted_type->data.pointer.child_type;
-    assert(array_type->id == ZigTypeIdArray);
-    assert(array_type->data.array.len == 1);
 
-    if (instr_is_comptime(target)) {
-        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+    if ((err = type_resolve(ira->codegen, value->value->type, ResolveStatusZeroBitsKnown)))
+        return ira->codegen->invalid_instruction;
+
+    if (instr_is_comptime(value)) {
+        ConstExprValue *val = ir_resolve_const(ira, value, UndefOk);
         if (!val)
             return ira->codegen->invalid_instruction;
+        return ir_get_const_ptr(ira, source_instruction, val, value->value->type,
+                ConstPtrMutComptimeConst, is_const, is_volatile, 0);
+    }
 
-        assert(val->type->id == ZigTypeIdPointer);
-        ConstExprValue *pointee = const_ptr_pointee(ira, ira->codegen, val, source_instr->source_node);
-        if (pointee == nullptr)
-            return ira->codegen->invalid_instruction;
-        if (pointee->special != ConstValSpecialRuntime) {
-            ConstExprValue *array_val = create_const_vals(1);
-            array_val->special = ConstValSpecialStatic;
-            array_val->type = array_type;
-            array_val->data.x_array.special = ConstArraySpecialNone;
-            array_val->data.x_array.data.s_none.elements = pointee;
-            array_val->parent.id = ConstParentIdScalar;
-            array_val->parent.data.p_scalar.scalar_val = pointee;
+    ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, value->value->type,
+            is_const, is_volatile, PtrLenSingle, 0, 0, 0, false);
 
-            IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
-                    source_instr->scope, source_instr->source_node);
-            const_instruction->base.value.type = wanted_type;
-            const_instruction->base.value.special = ConstValSpecialStatic;
-            const_instruction->base.value.data.x_ptr.special = ConstPtrSpecialRef;
-            const_instruction->base.value.data.x_ptr.data.ref.pointee = array_val;
-            const_instruction->base.value.data.x_ptr.mut = val->data.x_ptr.mut;
-            return &const_instruction->base;
-        }
+    IrInstruction *result_loc;
+    if (type_has_bits(ptr_type) && !handle_is_ptr(value->value->type)) {
+        result_loc = ir_resolve_result(ira, source_instruction, no_result_loc(), value->value->type, nullptr, true, false);
+    } else {
+        result_loc = nullptr;
     }
 
-    // pointer to array and pointer to single item are represented the same way at runtime
-    IrInstruction *result = ir_build_cast(&ira->new_irb, target->scope, target->source_node,
-            wanted_type, target, CastOpBitCast);
-    result->value.type = wanted_type;
-    return result;
+    IrInstruction *new_instruction = ir_build_ref_gen(ira, source_instruction, ptr_type, value, result_loc);
+    new_instruction->value->data.rh_ptr = RuntimeHintPtrStack;
+    return new_instruction;
 }
 
-static void report_recursive_error(IrAnalyze *ira, AstNode *source_node, ConstCastOnly *cast_result,
-        ErrorMsg *parent_msg)
+static IrInstruction *ir_analyze_array_to_slice(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *array_arg, ZigType *wanted_type, ResultLoc *result_loc)
 {
-    switch (cast_result->id) {
-        case ConstCastResultIdOk:
-            zig_unreachable();
-        case ConstCastResultIdInvalid:
-            zig_unreachable();
-        case ConstCastResultIdOptionalChild: {
-            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
-                    buf_sprintf("optional type child '%s' cannot cast into optional type child '%s'",
-                        buf_ptr(&cast_result->data.optional->actual_child->name),
-                        buf_ptr(&cast_result->data.optional->wanted_child->name)));
-            report_recursive_error(ira, source_node, &cast_result->data.optional->child, msg);
-            break;
-        }
-        case ConstCastResultIdErrorUnionErrorSet: {
-            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
-                    buf_sprintf("error set '%s' cannot cast into error set '%s'",
-                        buf_ptr(&cast_result->data.error_union_error_set->actual_err_set->name),
-                        buf_ptr(&cast_result->data.error_union_error_set->wanted_err_set->name)));
-            report_recursive_error(ira, source_node, &cast_result->data.error_union_error_set->child, msg);
-            break;
-        }
-        case ConstCastResultIdErrSet: {
-            ZigList<ErrorTableEntry *> *missing_errors = &cast_result->data.error_set_mismatch->missing_errors;
-            for (size_t i = 0; i < missing_errors->length; i += 1) {
-                ErrorTableEntry *error_entry = missing_errors->at(i);
-                add_error_note(ira->codegen, parent_msg, error_entry->decl_node,
-                    buf_sprintf("'error.%s' not a member of destination error set", buf_ptr(&error_entry->name)));
-            }
-            break;
-        }
-        case ConstCastResultIdErrSetGlobal: {
-            add_error_note(ira->codegen, parent_msg, source_node,
-                    buf_sprintf("cannot cast global error set into smaller set"));
-            break;
-        }
-        case ConstCastResultIdPointerChild: {
-            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
-                    buf_sprintf("pointer type child '%s' cannot cast into pointer type child '%s'",
-                        buf_ptr(&cast_result->data.pointer_mismatch->actual_child->name),
-                        buf_ptr(&cast_result->data.pointer_mismatch->wanted_child->name)));
-            report_recursive_error(ira, source_node, &cast_result->data.pointer_mismatch->child, msg);
-            break;
-        }
-        case ConstCastResultIdSliceChild: {
-            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
-                    buf_sprintf("slice type child '%s' cannot cast into slice type child '%s'",
-                        buf_ptr(&cast_result->data.slice_mismatch->actual_child->name),
-                        buf_ptr(&cast_result->data.slice_mismatch->wanted_child->name)));
-            report_recursive_error(ira, source_node, &cast_result->data.slice_mismatch->child, msg);
-            break;
-        }
-        case ConstCastResultIdErrorUnionPayload: {
-            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
-                    buf_sprintf("error union payload '%s' cannot cast into error union payload '%s'",
-                        buf_ptr(&cast_result->data.error_union_payload->actual_payload->name),
-                        buf_ptr(&cast_result->data.error_union_payload->wanted_payload->name)));
-            report_recursive_error(ira, source_node, &cast_result->data.error_union_payload->child, msg);
-            break;
-        }
-        case ConstCastResultIdType: {
-            AstNode *wanted_decl_node = type_decl_node(cast_result->data.type_mismatch->wanted_type);
-            AstNode *actual_decl_node = type_decl_node(cast_result->data.type_mismatch->actual_type);
-            if (wanted_decl_node != nullptr) {
-                add_error_note(ira->codegen, parent_msg, wanted_decl_node,
-                    buf_sprintf("%s declared here",
-                        buf_ptr(&cast_result->data.type_mismatch->wanted_type->name)));
-            }
-            if (actual_decl_node != nullptr) {
-                add_error_note(ira->codegen, parent_msg, actual_decl_node,
-                    buf_sprintf("%s declared here",
-                        buf_ptr(&cast_result->data.type_mismatch->actual_type->name)));
-            }
-            break;
-        }
-        case ConstCastResultIdFnArg: {
-            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
-                    buf_sprintf("parameter %" ZIG_PRI_usize ": '%s' cannot cast into '%s'",
-                        cast_result->data.fn_arg.arg_index,
-                        buf_ptr(&cast_result->data.fn_arg.actual_param_type->name),
-                        buf_ptr(&cast_result->data.fn_arg.expected_param_type->name)));
-            report_recursive_error(ira, source_node, cast_result->data.fn_arg.child, msg);
-            break;
-        }
-        case ConstCastResultIdBadAllowsZero: {
-            ZigType *wanted_type = cast_result->data.bad_allows_zero->wanted_type;
-            ZigType *actual_type = cast_result->data.bad_allows_zero->actual_type;
-            bool wanted_allows_zero = ptr_allows_addr_zero(wanted_type);
-            bool actual_allows_zero = ptr_allows_addr_zero(actual_type);
-            if (actual_allows_zero && !wanted_allows_zero) {
-                add_error_note(ira->codegen, parent_msg, source_node,
-                        buf_sprintf("'%s' could have null values which are illegal in type '%s'",
-                            buf_ptr(&actual_type->name),
-                            buf_ptr(&wanted_type->name)));
-            } else {
-                add_error_note(ira->codegen, parent_msg, source_node,
-                        buf_sprintf("mutable '%s' allows illegal null values stored to type '%s'",
-                            buf_ptr(&wanted_type->name),
-                            buf_ptr(&actual_type->name)));
-            }
-            break;
-        }
-        case ConstCastResultIdFnIsGeneric:
-            add_error_note(ira->codegen, parent_msg, source_node,
-                    buf_sprintf("only one of the functions is generic"));
-            break;
-        case ConstCastResultIdFnAlign: // TODO
-        case ConstCastResultIdFnCC: // TODO
-        case ConstCastResultIdFnVarArgs: // TODO
-        case ConstCastResultIdFnReturnType: // TODO
-        case ConstCastResultIdFnArgCount: // TODO
-        case ConstCastResultIdFnGenericArgCount: // TODO
-        case ConstCastResultIdFnArgNoAlias: // TODO
-        case ConstCastResultIdUnresolvedInferredErrSet: // TODO
-        case ConstCastResultIdAsyncAllocatorType: // TODO
-            break;
-    }
-}
+    assert(is_slice(wanted_type));
+    // In this function we honor the const-ness of wanted_type, because
+    // we may be casting [0]T to []const T which is perfectly valid.
 
-static IrInstruction *ir_analyze_array_to_vector(IrAnalyze *ira, IrInstruction *source_instr,
-    IrInstruction *array, ZigType *vector_type)
-{
-    if (instr_is_comptime(array)) {
-        // arrays and vectors have the same ConstExprValue representation
-        IrInstruction *result = ir_const(ira, source_instr, vector_type);
-        copy_const_val(&result->value, &array->value, false);
-        result->value.type = vector_type;
-        return result;
+    IrInstruction *array_ptr = nullptr;
+    IrInstruction *array;
+    if (array_arg->value->type->id == ZigTypeIdPointer) {
+        array = ir_get_deref(ira, source_instr, array_arg, nullptr);
+        array_ptr = array_arg;
+    } else {
+        array = array_arg;
     }
-    return ir_build_array_to_vector(ira, source_instr, array, vector_type);
-}
+    ZigType *array_type = array->value->type;
+    assert(array_type->id == ZigTypeIdArray);
 
-static IrInstruction *ir_analyze_vector_to_array(IrAnalyze *ira, IrInstruction *source_instr,
-    IrInstruction *vector, ZigType *array_type, ResultLoc *result_loc)
-{
-    if (instr_is_comptime(vector)) {
-        // arrays and vectors have the same ConstExprValue representation
-        IrInstruction *result = ir_const(ira, source_instr, array_type);
-        copy_const_val(&result->value, &vector->value, false);
-        result->value.type = array_type;
+    if (instr_is_comptime(array) || array_type->data.array.len == 0) {
+        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+        init_const_slice(ira->codegen, result->value, array->value, 0, array_type->data.array.len, true);
+        result->value->type = wanted_type;
         return result;
     }
-    if (result_loc == nullptr) {
-        result_loc = no_result_loc();
-    }
-    IrInstruction *result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, array_type, nullptr, true, false);
-    if (type_is_invalid(result_loc_inst->value.type) || instr_is_unreachable(result_loc_inst)) {
-        return result_loc_inst;
-    }
-    return ir_build_vector_to_array(ira, source_instr, array_type, vector, result_loc_inst);
-}
 
-static IrInstruction *ir_analyze_int_to_c_ptr(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *integer, ZigType *dest_type)
-{
-    IrInstruction *unsigned_integer;
-    if (instr_is_comptime(integer)) {
-        unsigned_integer = integer;
-    } else {
-        assert(integer->value.type->id == ZigTypeIdInt);
+    IrInstruction *start = ir_const(ira, source_instr, ira->codegen->builtin_types.entry_usize);
+    init_const_usize(ira->codegen, start->value, 0);
 
-        if (integer->value.type->data.integral.bit_count >
-            ira->codegen->builtin_types.entry_usize->data.integral.bit_count)
-        {
-            ir_add_error(ira, source_instr,
-                buf_sprintf("integer type '%s' too big for implicit @intToPtr to type '%s'",
-                    buf_ptr(&integer->value.type->name),
-                    buf_ptr(&dest_type->name)));
-            return ira->codegen->invalid_instruction;
-        }
+    IrInstruction *end = ir_const(ira, source_instr, ira->codegen->builtin_types.entry_usize);
+    init_const_usize(ira->codegen, end->value, array_type->data.array.len);
 
-        if (integer->value.type->data.integral.is_signed) {
-            ZigType *unsigned_int_type = get_int_type(ira->codegen, false,
-                    integer->value.type->data.integral.bit_count);
-            unsigned_integer = ir_analyze_bit_cast(ira, source_instr, integer, unsigned_int_type);
-            if (type_is_invalid(unsigned_integer->value.type))
-                return ira->codegen->invalid_instruction;
-        } else {
-            unsigned_integer = integer;
-        }
+    if (!array_ptr) array_ptr = ir_get_ref(ira, source_instr, array, true, false);
+
+    if (result_loc == nullptr) result_loc = no_result_loc();
+    IrInstruction *result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, wanted_type, nullptr, true, false);
+    if (type_is_invalid(result_loc_inst->value->type) || instr_is_unreachable(result_loc_inst)) {
+        return result_loc_inst;
     }
+    IrInstruction *result = ir_build_slice_gen(ira, source_instr, wanted_type, array_ptr, start, end, false, result_loc_inst);
+    result->value->data.rh_slice.id = RuntimeHintSliceIdLen;
+    result->value->data.rh_slice.len = array_type->data.array.len;
 
-    return ir_analyze_int_to_ptr(ira, source_instr, unsigned_integer, dest_type);
+    return result;
 }
 
-static bool is_pointery_and_elem_is_not_pointery(ZigType *ty) {
-    if (ty->id == ZigTypeIdPointer) return ty->data.pointer.child_type->id != ZigTypeIdPointer;
-    if (ty->id == ZigTypeIdFn) return true;
-    if (ty->id == ZigTypeIdPromise) return true;
-    if (ty->id == ZigTypeIdOptional) {
-        ZigType *ptr_ty = ty->data.maybe.child_type;
-        if (ptr_ty->id == ZigTypeIdPointer) return ptr_ty->data.pointer.child_type->id != ZigTypeIdPointer;
-        if (ptr_ty->id == ZigTypeIdFn) return true;
-        if (ptr_ty->id == ZigTypeIdPromise) return true;
-    }
-    return false;
-}
+static ZigType *ir_resolve_union_tag_type(IrAnalyze *ira, IrInstruction *source_instr, ZigType *union_type) {
+    assert(union_type->id == ZigTypeIdUnion);
 
-static IrInstruction *ir_analyze_cast(IrAnalyze *ira, IrInstruction *source_instr,
-    ZigType *wanted_type, IrInstruction *value, ResultLoc *result_loc)
-{
     Error err;
-    ZigType *actual_type = value->value.type;
-    AstNode *source_node = source_instr->source_node;
+    if ((err = type_resolve(ira->codegen, union_type, ResolveStatusSizeKnown)))
+        return ira->codegen->builtin_types.entry_invalid;
 
-    if (type_is_invalid(wanted_type) || type_is_invalid(actual_type)) {
-        return ira->codegen->invalid_instruction;
+    AstNode *decl_node = union_type->data.unionation.decl_node;
+    if (decl_node->data.container_decl.auto_enum || decl_node->data.container_decl.init_arg_expr != nullptr) {
+        assert(union_type->data.unionation.tag_type != nullptr);
+        return union_type->data.unionation.tag_type;
+    } else {
+        ErrorMsg *msg = ir_add_error(ira, source_instr, buf_sprintf("union '%s' has no tag",
+            buf_ptr(&union_type->name)));
+        add_error_note(ira->codegen, msg, decl_node, buf_sprintf("consider 'union(enum)' here"));
+        return ira->codegen->builtin_types.entry_invalid;
     }
+}
 
-    bool actual_is_vector = actual_type->id == ZigTypeIdVector;
-    bool wanted_is_vector = wanted_type->id == ZigTypeIdVector;
-    ZigType *actual_scalar_type = actual_is_vector ? actual_type->data.vector.elem_type : actual_type;
-    ZigType *wanted_scalar_type = wanted_is_vector ? wanted_type->data.vector.elem_type : wanted_type;
+static IrInstruction *ir_analyze_enum_to_int(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *target) {
+    Error err;
 
-    // perfect match or non-const to const
-    ConstCastOnly const_cast_result = types_match_const_cast_only(ira, wanted_type, actual_type,
-            source_node, false);
-    if (const_cast_result.id == ConstCastResultIdInvalid)
+    IrInstruction *enum_target;
+    ZigType *enum_type;
+    if (target->value->type->id == ZigTypeIdUnion) {
+        enum_type = ir_resolve_union_tag_type(ira, target, target->value->type);
+        if (type_is_invalid(enum_type))
+            return ira->codegen->invalid_instruction;
+        enum_target = ir_implicit_cast(ira, target, enum_type);
+        if (type_is_invalid(enum_target->value->type))
+            return ira->codegen->invalid_instruction;
+    } else if (target->value->type->id == ZigTypeIdEnum) {
+        enum_target = target;
+        enum_type = target->value->type;
+    } else {
+        ir_add_error(ira, target,
+            buf_sprintf("expected enum, found type '%s'", buf_ptr(&target->value->type->name)));
         return ira->codegen->invalid_instruction;
-    if (const_cast_result.id == ConstCastResultIdOk) {
-        return ir_resolve_cast(ira, source_instr, value, wanted_type, CastOpNoop);
     }
 
-    // cast from T to ?T
-    // note that the *T to ?*T case is handled via the "ConstCastOnly" mechanism
-    if (wanted_type->id == ZigTypeIdOptional) {
-        ZigType *wanted_child_type = wanted_type->data.maybe.child_type;
-        if (types_match_const_cast_only(ira, wanted_child_type, actual_type, source_node,
-            false).id == ConstCastResultIdOk)
-        {
-            return ir_analyze_optional_wrap(ira, source_instr, value, wanted_type, result_loc);
-        } else if (actual_type->id == ZigTypeIdComptimeInt ||
-                   actual_type->id == ZigTypeIdComptimeFloat)
-        {
-            if (ir_num_lit_fits_in_other_type(ira, value, wanted_child_type, true)) {
-                return ir_analyze_optional_wrap(ira, source_instr, value, wanted_type, result_loc);
-            } else {
-                return ira->codegen->invalid_instruction;
-            }
-        } else if (
-            wanted_child_type->id == ZigTypeIdPointer &&
-            wanted_child_type->data.pointer.ptr_len == PtrLenUnknown &&
-            actual_type->id == ZigTypeIdPointer &&
-            actual_type->data.pointer.ptr_len == PtrLenSingle &&
-            actual_type->data.pointer.child_type->id == ZigTypeIdArray)
-        {
-            if ((err = type_resolve(ira->codegen, actual_type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
-                return ira->codegen->invalid_instruction;
-            if ((err = type_resolve(ira->codegen, wanted_child_type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
-                return ira->codegen->invalid_instruction;
-            if (get_ptr_align(ira->codegen, actual_type) >= get_ptr_align(ira->codegen, wanted_child_type) &&
-                types_match_const_cast_only(ira, wanted_child_type->data.pointer.child_type,
-                actual_type->data.pointer.child_type->data.array.child_type, source_node,
-                !wanted_child_type->data.pointer.is_const).id == ConstCastResultIdOk)
-            {
-                IrInstruction *cast1 = ir_resolve_ptr_of_array_to_unknown_len_ptr(ira, source_instr, value,
-                        wanted_child_type);
-                if (type_is_invalid(cast1->value.type))
-                    return ira->codegen->invalid_instruction;
-                return ir_analyze_optional_wrap(ira, source_instr, cast1, wanted_type, result_loc);
-            }
-        }
-    }
+    if ((err = type_resolve(ira->codegen, enum_type, ResolveStatusSizeKnown)))
+        return ira->codegen->invalid_instruction;
 
-    // T to E!T
-    if (wanted_type->id == ZigTypeIdErrorUnion) {
-        if (types_match_const_cast_only(ira, wanted_type->data.error_union.payload_type, actual_type,
-            source_node, false).id == ConstCastResultIdOk)
-        {
-            return ir_analyze_err_wrap_payload(ira, source_instr, value, wanted_type, result_loc);
-        } else if (actual_type->id == ZigTypeIdComptimeInt ||
-                   actual_type->id == ZigTypeIdComptimeFloat)
-        {
-            if (ir_num_lit_fits_in_other_type(ira, value, wanted_type->data.error_union.payload_type, true)) {
-                return ir_analyze_err_wrap_payload(ira, source_instr, value, wanted_type, result_loc);
-            } else {
-                return ira->codegen->invalid_instruction;
-            }
-        }
-    }
+    ZigType *tag_type = enum_type->data.enumeration.tag_int_type;
+    assert(tag_type->id == ZigTypeIdInt || tag_type->id == ZigTypeIdComptimeInt);
 
-    // cast from T to E!?T
-    if (wanted_type->id == ZigTypeIdErrorUnion &&
-        wanted_type->data.error_union.payload_type->id == ZigTypeIdOptional &&
-        actual_type->id != ZigTypeIdOptional)
+    // If there is only one possible tag, then we know at comptime what it is.
+    if (enum_type->data.enumeration.layout == ContainerLayoutAuto &&
+        enum_type->data.enumeration.src_field_count == 1)
     {
-        ZigType *wanted_child_type = wanted_type->data.error_union.payload_type->data.maybe.child_type;
-        if (types_match_const_cast_only(ira, wanted_child_type, actual_type, source_node, false).id == ConstCastResultIdOk ||
-            actual_type->id == ZigTypeIdNull ||
-            actual_type->id == ZigTypeIdComptimeInt ||
-            actual_type->id == ZigTypeIdComptimeFloat)
-        {
-            IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.error_union.payload_type, value, nullptr);
-            if (type_is_invalid(cast1->value.type))
-                return ira->codegen->invalid_instruction;
-
-            IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1, result_loc);
-            if (type_is_invalid(cast2->value.type))
-                return ira->codegen->invalid_instruction;
+        assert(tag_type == ira->codegen->builtin_types.entry_num_lit_int);
+        IrInstruction *result = ir_const(ira, source_instr, tag_type);
+        init_const_bigint(result->value, tag_type,
+                &enum_type->data.enumeration.fields[0].value);
+        return result;
+    }
 
-            return cast2;
-        }
+    if (instr_is_comptime(enum_target)) {
+        ConstExprValue *val = ir_resolve_const(ira, enum_target, UndefBad);
+        if (!val)
+            return ira->codegen->invalid_instruction;
+        IrInstruction *result = ir_const(ira, source_instr, tag_type);
+        init_const_bigint(result->value, tag_type, &val->data.x_enum_tag);
+        return result;
     }
 
+    IrInstruction *result = ir_build_widen_or_shorten(&ira->new_irb, source_instr->scope,
+            source_instr->source_node, enum_target);
+    result->value->type = tag_type;
+    return result;
+}
 
-    // cast from comptime-known number to another number type
-    if (instr_is_comptime(value) &&
-        (actual_type->id == ZigTypeIdInt || actual_type->id == ZigTypeIdComptimeInt ||
-        actual_type->id == ZigTypeIdFloat || actual_type->id == ZigTypeIdComptimeFloat) &&
-        (wanted_type->id == ZigTypeIdInt || wanted_type->id == ZigTypeIdComptimeInt ||
-        wanted_type->id == ZigTypeIdFloat || wanted_type->id == ZigTypeIdComptimeFloat))
-    {
-        if (value->value.special == ConstValSpecialUndef) {
-            IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-            result->value.special = ConstValSpecialUndef;
-            return result;
-        }
-        if (ir_num_lit_fits_in_other_type(ira, value, wanted_type, true)) {
-            if (wanted_type->id == ZigTypeIdComptimeInt || wanted_type->id == ZigTypeIdInt) {
-                IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-                if (actual_type->id == ZigTypeIdComptimeInt || actual_type->id == ZigTypeIdInt) {
-                    bigint_init_bigint(&result->value.data.x_bigint, &value->value.data.x_bigint);
-                } else {
-                    float_init_bigint(&result->value.data.x_bigint, &value->value);
-                }
-                return result;
-            } else if (wanted_type->id == ZigTypeIdComptimeFloat || wanted_type->id == ZigTypeIdFloat) {
-                IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-                if (actual_type->id == ZigTypeIdComptimeInt || actual_type->id == ZigTypeIdInt) {
-                    BigFloat bf;
-                    bigfloat_init_bigint(&bf, &value->value.data.x_bigint);
-                    float_init_bigfloat(&result->value, &bf);
-                } else {
-                    float_init_float(&result->value, &value->value);
-                }
-                return result;
-            }
-            zig_unreachable();
-        } else {
+static IrInstruction *ir_analyze_union_to_tag(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *target, ZigType *wanted_type)
+{
+    assert(target->value->type->id == ZigTypeIdUnion);
+    assert(wanted_type->id == ZigTypeIdEnum);
+    assert(wanted_type == target->value->type->data.unionation.tag_type);
+
+    if (instr_is_comptime(target)) {
+        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+        if (!val)
             return ira->codegen->invalid_instruction;
-        }
+        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+        result->value->special = ConstValSpecialStatic;
+        result->value->type = wanted_type;
+        bigint_init_bigint(&result->value->data.x_enum_tag, &val->data.x_union.tag);
+        return result;
     }
 
-    // widening conversion
-    if (wanted_type->id == ZigTypeIdInt &&
-        actual_type->id == ZigTypeIdInt &&
-        wanted_type->data.integral.is_signed == actual_type->data.integral.is_signed &&
-        wanted_type->data.integral.bit_count >= actual_type->data.integral.bit_count)
+    // If there is only 1 possible tag, then we know at comptime what it is.
+    if (wanted_type->data.enumeration.layout == ContainerLayoutAuto &&
+        wanted_type->data.enumeration.src_field_count == 1)
     {
-        return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
+        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+        result->value->special = ConstValSpecialStatic;
+        result->value->type = wanted_type;
+        TypeEnumField *enum_field = target->value->type->data.unionation.fields[0].enum_field;
+        bigint_init_bigint(&result->value->data.x_enum_tag, &enum_field->value);
+        return result;
     }
 
-    // small enough unsigned ints can get casted to large enough signed ints
-    if (wanted_type->id == ZigTypeIdInt && wanted_type->data.integral.is_signed &&
-        actual_type->id == ZigTypeIdInt && !actual_type->data.integral.is_signed &&
-        wanted_type->data.integral.bit_count > actual_type->data.integral.bit_count)
-    {
-        return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
-    }
+    IrInstruction *result = ir_build_union_tag(&ira->new_irb, source_instr->scope,
+            source_instr->source_node, target);
+    result->value->type = wanted_type;
+    return result;
+}
 
-    // float widening conversion
-    if (wanted_type->id == ZigTypeIdFloat &&
-        actual_type->id == ZigTypeIdFloat &&
-        wanted_type->data.floating.bit_count >= actual_type->data.floating.bit_count)
-    {
-        return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
-    }
+static IrInstruction *ir_analyze_undefined_to_anything(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *target, ZigType *wanted_type)
+{
+    IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+    init_const_undefined(ira->codegen, result->value);
+    return result;
+}
 
-    // widening of vectors
-    // These are separate (while identical) as I am still not sure if this should not implicitely cast,
-    // but only explicitely cast. (i.e. with @cast, or @as, or @Vector(4, i32)(foo)),
-    // as they are more expensive than scalar zext/sext/fext operations.
-    if (wanted_is_vector &&
-        actual_is_vector) {
-        if (wanted_scalar_type->id == ZigTypeIdInt &&
-            actual_scalar_type->id == ZigTypeIdInt) {
-            if (wanted_scalar_type->data.integral.is_signed == actual_scalar_type->data.integral.is_signed &&
-                wanted_scalar_type->data.integral.bit_count >= actual_scalar_type->data.integral.bit_count) {
-                return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
-            }
-            if (wanted_scalar_type->data.integral.is_signed &&
-                !actual_scalar_type->data.integral.is_signed &&
-                wanted_scalar_type->data.integral.bit_count > actual_scalar_type->data.integral.bit_count) {
-                return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
-            }
-        }
-        if (wanted_scalar_type->id == ZigTypeIdFloat &&
-            actual_scalar_type->id == ZigTypeIdFloat &&
-            wanted_scalar_type->data.floating.bit_count >= actual_scalar_type->data.floating.bit_count) {
-            return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
-        }
-    }
-
-    // cast from [N]T to []const T
-    // TODO: once https://github.com/ziglang/zig/issues/265 lands, remove this
-    if (is_slice(wanted_type) && actual_type->id == ZigTypeIdArray) {
-        ZigType *ptr_type = wanted_type->data.structure.fields[slice_ptr_index].type_entry;
-        assert(ptr_type->id == ZigTypeIdPointer);
-        if ((ptr_type->data.pointer.is_const || actual_type->data.array.len == 0) &&
-            types_match_const_cast_only(ira, ptr_type->data.pointer.child_type, actual_type->data.array.child_type,
-                source_node, false).id == ConstCastResultIdOk)
-        {
-            return ir_analyze_array_to_slice(ira, source_instr, value, wanted_type, result_loc);
-        }
-    }
-
-    // cast from [N]T to ?[]const T
-    // TODO: once https://github.com/ziglang/zig/issues/265 lands, remove this
-    if (wanted_type->id == ZigTypeIdOptional &&
-        is_slice(wanted_type->data.maybe.child_type) &&
-        actual_type->id == ZigTypeIdArray)
-    {
-        ZigType *ptr_type =
-            wanted_type->data.maybe.child_type->data.structure.fields[slice_ptr_index].type_entry;
-        assert(ptr_type->id == ZigTypeIdPointer);
-        if ((ptr_type->data.pointer.is_const || actual_type->data.array.len == 0) &&
-            types_match_const_cast_only(ira, ptr_type->data.pointer.child_type, actual_type->data.array.child_type,
-                source_node, false).id == ConstCastResultIdOk)
-        {
-            IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.maybe.child_type, value, nullptr);
-            if (type_is_invalid(cast1->value.type))
-                return ira->codegen->invalid_instruction;
+static IrInstruction *ir_analyze_enum_to_union(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *uncasted_target, ZigType *wanted_type)
+{
+    Error err;
+    assert(wanted_type->id == ZigTypeIdUnion);
 
-            IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1, result_loc);
-            if (type_is_invalid(cast2->value.type))
-                return ira->codegen->invalid_instruction;
+    if ((err = type_resolve(ira->codegen, wanted_type, ResolveStatusZeroBitsKnown)))
+        return ira->codegen->invalid_instruction;
 
-            return cast2;
-        }
-    }
+    IrInstruction *target = ir_implicit_cast(ira, uncasted_target, wanted_type->data.unionation.tag_type);
+    if (type_is_invalid(target->value->type))
+        return ira->codegen->invalid_instruction;
 
-    // *[N]T to [*]T and [*c]T
-    if (wanted_type->id == ZigTypeIdPointer &&
-        (wanted_type->data.pointer.ptr_len == PtrLenUnknown || wanted_type->data.pointer.ptr_len == PtrLenC) &&
-        actual_type->id == ZigTypeIdPointer &&
-        actual_type->data.pointer.ptr_len == PtrLenSingle &&
-        actual_type->data.pointer.child_type->id == ZigTypeIdArray)
-    {
-        if ((err = type_resolve(ira->codegen, actual_type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
+    if (instr_is_comptime(target)) {
+        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+        if (!val)
             return ira->codegen->invalid_instruction;
-        if ((err = type_resolve(ira->codegen, wanted_type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
+        TypeUnionField *union_field = find_union_field_by_tag(wanted_type, &val->data.x_enum_tag);
+        assert(union_field != nullptr);
+        if ((err = type_resolve(ira->codegen, union_field->type_entry, ResolveStatusZeroBitsKnown)))
             return ira->codegen->invalid_instruction;
-        if (get_ptr_align(ira->codegen, actual_type) >= get_ptr_align(ira->codegen, wanted_type) &&
-            types_match_const_cast_only(ira, wanted_type->data.pointer.child_type,
-                actual_type->data.pointer.child_type->data.array.child_type, source_node,
-                !wanted_type->data.pointer.is_const).id == ConstCastResultIdOk)
-        {
-            return ir_resolve_ptr_of_array_to_unknown_len_ptr(ira, source_instr, value, wanted_type);
-        }
-    }
-
-    // *[N]T to []T
-    if (is_slice(wanted_type) &&
-        actual_type->id == ZigTypeIdPointer &&
-        actual_type->data.pointer.ptr_len == PtrLenSingle &&
-        actual_type->data.pointer.child_type->id == ZigTypeIdArray)
-    {
-        ZigType *slice_ptr_type = wanted_type->data.structure.fields[slice_ptr_index].type_entry;
-        assert(slice_ptr_type->id == ZigTypeIdPointer);
-        ZigType *array_type = actual_type->data.pointer.child_type;
-        bool const_ok = (slice_ptr_type->data.pointer.is_const || array_type->data.array.len == 0
-                || !actual_type->data.pointer.is_const);
-        if (const_ok && types_match_const_cast_only(ira, slice_ptr_type->data.pointer.child_type,
-            array_type->data.array.child_type, source_node,
-            !slice_ptr_type->data.pointer.is_const).id == ConstCastResultIdOk)
-        {
-            return ir_resolve_ptr_of_array_to_slice(ira, source_instr, value, wanted_type, result_loc);
-        }
-    }
-
-
-    // cast from null literal to maybe type
-    if (wanted_type->id == ZigTypeIdOptional &&
-        actual_type->id == ZigTypeIdNull)
-    {
-        return ir_analyze_null_to_maybe(ira, source_instr, value, wanted_type);
-    }
-
-    // cast from null literal to C pointer
-    if (wanted_type->id == ZigTypeIdPointer && wanted_type->data.pointer.ptr_len == PtrLenC &&
-        actual_type->id == ZigTypeIdNull)
-    {
-        return ir_analyze_null_to_c_pointer(ira, source_instr, value, wanted_type);
-    }
 
-    // cast from [N]T to E![]const T
-    if (wanted_type->id == ZigTypeIdErrorUnion &&
-        is_slice(wanted_type->data.error_union.payload_type) &&
-        actual_type->id == ZigTypeIdArray)
-    {
-        ZigType *ptr_type =
-            wanted_type->data.error_union.payload_type->data.structure.fields[slice_ptr_index].type_entry;
-        assert(ptr_type->id == ZigTypeIdPointer);
-        if ((ptr_type->data.pointer.is_const || actual_type->data.array.len == 0) &&
-            types_match_const_cast_only(ira, ptr_type->data.pointer.child_type, actual_type->data.array.child_type,
-                source_node, false).id == ConstCastResultIdOk)
-        {
-            IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.error_union.payload_type, value, nullptr);
-            if (type_is_invalid(cast1->value.type))
+        switch (type_has_one_possible_value(ira->codegen, union_field->type_entry)) {
+            case OnePossibleValueInvalid:
                 return ira->codegen->invalid_instruction;
-
-            IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1, result_loc);
-            if (type_is_invalid(cast2->value.type))
+            case OnePossibleValueNo: {
+                AstNode *field_node = wanted_type->data.unionation.decl_node->data.container_decl.fields.at(
+                        union_field->enum_field->decl_index);
+                ErrorMsg *msg = ir_add_error(ira, source_instr,
+                        buf_sprintf("cast to union '%s' must initialize '%s' field '%s'",
+                            buf_ptr(&wanted_type->name),
+                            buf_ptr(&union_field->type_entry->name),
+                            buf_ptr(union_field->name)));
+                add_error_note(ira->codegen, msg, field_node,
+                        buf_sprintf("field '%s' declared here", buf_ptr(union_field->name)));
                 return ira->codegen->invalid_instruction;
-
-            return cast2;
+            }
+            case OnePossibleValueYes:
+                break;
         }
-    }
-
-    // cast from E to E!T
-    if (wanted_type->id == ZigTypeIdErrorUnion &&
-        actual_type->id == ZigTypeIdErrorSet)
-    {
-        return ir_analyze_err_wrap_code(ira, source_instr, value, wanted_type, result_loc);
-    }
-
-    // cast from typed number to integer or float literal.
-    // works when the number is known at compile time
-    if (instr_is_comptime(value) &&
-        ((actual_type->id == ZigTypeIdInt && wanted_type->id == ZigTypeIdComptimeInt) ||
-        (actual_type->id == ZigTypeIdFloat && wanted_type->id == ZigTypeIdComptimeFloat)))
-    {
-        return ir_analyze_number_to_literal(ira, source_instr, value, wanted_type);
-    }
-
-    // cast from enum literal to enum with matching field name
-    if (actual_type->id == ZigTypeIdEnumLiteral && wanted_type->id == ZigTypeIdEnum) {
-        if ((err = type_resolve(ira->codegen, wanted_type, ResolveStatusZeroBitsKnown)))
-            return ira->codegen->invalid_instruction;
 
-        TypeEnumField *field = find_enum_type_field(wanted_type, value->value.data.x_enum_literal);
-        if (field == nullptr) {
-            ErrorMsg *msg = ir_add_error(ira, source_instr, buf_sprintf("enum '%s' has no field named '%s'",
-                    buf_ptr(&wanted_type->name), buf_ptr(value->value.data.x_enum_literal)));
-            add_error_note(ira->codegen, msg, wanted_type->data.enumeration.decl_node,
-                    buf_sprintf("'%s' declared here", buf_ptr(&wanted_type->name)));
-            return ira->codegen->invalid_instruction;
-        }
         IrInstruction *result = ir_const(ira, source_instr, wanted_type);
-        bigint_init_bigint(&result->value.data.x_enum_tag, &field->value);
+        result->value->special = ConstValSpecialStatic;
+        result->value->type = wanted_type;
+        bigint_init_bigint(&result->value->data.x_union.tag, &val->data.x_enum_tag);
+        result->value->data.x_union.payload = create_const_vals(1);
+        result->value->data.x_union.payload->special = ConstValSpecialStatic;
+        result->value->data.x_union.payload->type = union_field->type_entry;
         return result;
     }
 
-    // cast from union to the enum type of the union
-    if (actual_type->id == ZigTypeIdUnion && wanted_type->id == ZigTypeIdEnum) {
-        if ((err = type_resolve(ira->codegen, actual_type, ResolveStatusZeroBitsKnown)))
-            return ira->codegen->invalid_instruction;
+    // if the union has all fields 0 bits, we can do it
+    // and in fact it's a noop cast because the union value is just the enum value
+    if (wanted_type->data.unionation.gen_field_count == 0) {
+        IrInstruction *result = ir_build_cast(&ira->new_irb, target->scope, target->source_node, wanted_type, target, CastOpNoop);
+        result->value->type = wanted_type;
+        return result;
+    }
 
-        if (actual_type->data.unionation.tag_type == wanted_type) {
-            return ir_analyze_union_to_tag(ira, source_instr, value, wanted_type);
+    ErrorMsg *msg = ir_add_error(ira, source_instr,
+            buf_sprintf("runtime cast to union '%s' which has non-void fields",
+                buf_ptr(&wanted_type->name)));
+    for (uint32_t i = 0; i < wanted_type->data.unionation.src_field_count; i += 1) {
+        TypeUnionField *union_field = &wanted_type->data.unionation.fields[i];
+        if (type_has_bits(union_field->type_entry)) {
+            AstNode *field_node = wanted_type->data.unionation.decl_node->data.container_decl.fields.at(i);
+            add_error_note(ira->codegen, msg, field_node,
+                    buf_sprintf("field '%s' has type '%s'",
+                        buf_ptr(union_field->name),
+                        buf_ptr(&union_field->type_entry->name)));
         }
     }
+    return ira->codegen->invalid_instruction;
+}
 
-    // enum to union which has the enum as the tag type, or
-    // enum literal to union which has a matching enum as the tag type
-    if (is_tagged_union(wanted_type) && (actual_type->id == ZigTypeIdEnum ||
-                actual_type->id == ZigTypeIdEnumLiteral))
-    {
-        return ir_analyze_enum_to_union(ira, source_instr, value, wanted_type);
+static IrInstruction *ir_analyze_widen_or_shorten(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *target, ZigType *wanted_type)
+{
+    bool is_vector = wanted_type->id == ZigTypeIdVector;
+    ZigType *wanted_scalar_type = is_vector ? wanted_type->data.vector.elem_type : wanted_type;
+    assert(wanted_scalar_type->id == ZigTypeIdInt || wanted_scalar_type->id == ZigTypeIdFloat);
+    assert((target->value->type->id == ZigTypeIdVector) == is_vector);
+    if (is_vector) {
+        assert(target->value->type->data.vector.len == wanted_type->data.vector.len);
     }
 
-    // cast from *T to *[1]T
-    if (wanted_type->id == ZigTypeIdPointer && wanted_type->data.pointer.ptr_len == PtrLenSingle &&
-        actual_type->id == ZigTypeIdPointer && actual_type->data.pointer.ptr_len == PtrLenSingle)
-    {
-        ZigType *array_type = wanted_type->data.pointer.child_type;
-        if (array_type->id == ZigTypeIdArray && array_type->data.array.len == 1 &&
-            types_match_const_cast_only(ira, array_type->data.array.child_type,
-            actual_type->data.pointer.child_type, source_node,
-            !wanted_type->data.pointer.is_const).id == ConstCastResultIdOk &&
-            // This should be the job of `types_match_const_cast_only`
-            // but `types_match_const_cast_only` only gets info for child_types
-            ((wanted_type->data.pointer.is_const && actual_type->data.pointer.is_const) ||
-            !actual_type->data.pointer.is_const))
-        {
-            if ((err = type_resolve(ira->codegen, wanted_type->data.pointer.child_type,
-                            ResolveStatusAlignmentKnown)))
-            {
-                return ira->codegen->invalid_instruction;
-            }
-            if ((err = type_resolve(ira->codegen, actual_type->data.pointer.child_type,
-                            ResolveStatusAlignmentKnown)))
-            {
-                return ira->codegen->invalid_instruction;
+    if (instr_is_comptime(target)) {
+        ConstExprValue *val = ir_resolve_const(ira, target, UndefOk);
+        if (!val)
+            return ira->codegen->invalid_instruction;
+        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+        if (wanted_scalar_type->id == ZigTypeIdInt || wanted_scalar_type->id == ZigTypeIdFloat) {
+            uint32_t i = 0;
+            uint32_t vector_len = 1;
+            ConstExprValue *sval = val;
+            if (is_vector) {
+                vector_len = val->type->data.vector.len;
+                expand_undef_array(ira->codegen, result->value);
+                result->value->data.x_array.data.s_none.elements =
+                    allocate<ConstExprValue>(vector_len);
+                sval = &val->data.x_array.data.s_none.elements[0];
             }
-            uint32_t wanted_align = get_ptr_align(ira->codegen, wanted_type);
-            uint32_t actual_align = get_ptr_align(ira->codegen, actual_type);
-            if (wanted_align > actual_align) {
-                ErrorMsg *msg = ir_add_error(ira, source_instr, buf_sprintf("cast increases pointer alignment"));
-                add_error_note(ira->codegen, msg, value->source_node,
-                        buf_sprintf("'%s' has alignment %" PRIu32, buf_ptr(&actual_type->name), actual_align));
-                add_error_note(ira->codegen, msg, source_instr->source_node,
-                        buf_sprintf("'%s' has alignment %" PRIu32, buf_ptr(&wanted_type->name), wanted_align));
-                return ira->codegen->invalid_instruction;
+            while (i < vector_len) {
+                if (sval->special == ConstValSpecialUndef) {
+                    if (is_vector) {
+                        result->value->data.x_array.data.s_none.elements[i].special = ConstValSpecialUndef;
+                        sval = &val->data.x_array.data.s_none.elements[++i];
+                    } else {
+                        result->value->special = ConstValSpecialUndef;
+                    }
+                    continue;
+                }
+                if (wanted_scalar_type->id == ZigTypeIdInt) {
+                    if (bigint_cmp_zero(&sval->data.x_bigint) == CmpLT && !wanted_scalar_type->data.integral.is_signed) {
+                        ErrorMsg *msg = ir_add_error(ira, source_instr,
+                            buf_sprintf("attempt to cast negative value to unsigned integer"));
+                        if (is_vector) {
+                            add_error_note(ira->codegen, msg, source_instr->source_node,
+                                buf_sprintf("when computing vector element at index %" ZIG_PRI_usize, (uintptr_t)i));
+                        }
+                        return ira->codegen->invalid_instruction;
+                    }
+                    if (!bigint_fits_in_bits(&sval->data.x_bigint, wanted_scalar_type->data.integral.bit_count,
+                            wanted_scalar_type->data.integral.is_signed))
+                    {
+                        ErrorMsg *msg = ir_add_error(ira, source_instr,
+                            buf_sprintf("cast from '%s' to '%s' truncates bits",
+                                buf_ptr(&target->value->type->name), buf_ptr(&wanted_type->name)));
+                        if (is_vector) {
+                            add_error_note(ira->codegen, msg, source_instr->source_node,
+                                buf_sprintf("when computing vector element at index %" ZIG_PRI_usize, (uintptr_t)i));
+                        }
+                        return ira->codegen->invalid_instruction;
+                    }
+                }
+                if (is_vector) {
+                    // float_init_float requires this to be set
+                    result->value->data.x_array.data.s_none.elements[i].type = wanted_scalar_type;
+                    if (wanted_scalar_type->id == ZigTypeIdInt) {
+                        bigint_init_bigint(&result->value->data.x_array.data.s_none.elements[i].data.x_bigint,
+                            &sval->data.x_bigint);
+                    } else if (wanted_scalar_type->id == ZigTypeIdFloat) {
+                        float_init_float(&result->value->data.x_array.data.s_none.elements[i], sval);
+                    } else {
+                        zig_unreachable();
+                    }
+                    result->value->data.x_array.data.s_none.elements[i].special = ConstValSpecialStatic;
+                    sval = &val->data.x_array.data.s_none.elements[++i];
+                } else if (wanted_type->id == ZigTypeIdInt) {
+                    bigint_init_bigint(&result->value->data.x_bigint, &sval->data.x_bigint);
+                    break;
+                } else if (wanted_type->id == ZigTypeIdFloat) {
+                    float_init_float(result->value, sval);
+                    break;
+                } else {
+                    zig_unreachable();
+                }
             }
-            return ir_analyze_ptr_to_array(ira, source_instr, value, wanted_type);
+        } else {
+            zig_unreachable();
         }
+        result->value->type = wanted_type;
+        return result;
     }
 
-    // cast from *T and [*]T to *c_void and ?*c_void
-    // but don't do it if the actual type is a double pointer
-    if (is_pointery_and_elem_is_not_pointery(actual_type)) {
-        ZigType *dest_ptr_type = nullptr;
-        if (wanted_type->id == ZigTypeIdPointer &&
-            wanted_type->data.pointer.child_type == ira->codegen->builtin_types.entry_c_void)
-        {
-            dest_ptr_type = wanted_type;
-        } else if (wanted_type->id == ZigTypeIdOptional &&
-            wanted_type->data.maybe.child_type->id == ZigTypeIdPointer &&
-            wanted_type->data.maybe.child_type->data.pointer.child_type == ira->codegen->builtin_types.entry_c_void)
-        {
-            dest_ptr_type = wanted_type->data.maybe.child_type;
-        }
-        if (dest_ptr_type != nullptr) {
-            return ir_analyze_ptr_cast(ira, source_instr, value, wanted_type, source_instr, true);
+    // If the destination integer type has no bits, then we can emit a comptime
+    // zero. However, we still want to emit a runtime safety check to make sure
+    // the target is zero.
+    if (!type_has_bits(wanted_type)) {
+        assert(wanted_type->id == ZigTypeIdInt);
+        assert(type_has_bits(target->value->type));
+        ir_build_assert_zero(ira, source_instr, target);
+        IrInstruction *result;
+        if (is_vector) {
+            result = ir_const_type(ira, source_instr, wanted_type);
+            result->value->data.x_array.data.s_none.elements =
+                    allocate<ConstExprValue>(wanted_type->data.vector.len);
+            for (uint32_t i = 0; i < wanted_type->data.vector.len; i++) {
+                bigint_init_unsigned(&result->value->data.x_array.data.s_none.elements[i].data.x_bigint, 0);
+            }
+        } else {
+            result = ir_const_unsigned(ira, source_instr, 0);
         }
+        result->value->type = wanted_type;
+        return result;
     }
 
-    // cast from T to *T where T is zero bits
-    if (wanted_type->id == ZigTypeIdPointer && wanted_type->data.pointer.ptr_len == PtrLenSingle &&
-        types_match_const_cast_only(ira, wanted_type->data.pointer.child_type,
-            actual_type, source_node, !wanted_type->data.pointer.is_const).id == ConstCastResultIdOk)
-    {
-        if ((err = type_resolve(ira->codegen, actual_type, ResolveStatusZeroBitsKnown))) {
-            return ira->codegen->invalid_instruction;
-        }
-        if (!type_has_bits(actual_type)) {
-            return ir_get_ref(ira, source_instr, value, false, false);
-        }
-    }
+    IrInstruction *result = ir_build_widen_or_shorten(&ira->new_irb, source_instr->scope,
+            source_instr->source_node, target);
+    result->value->type = wanted_type;
+    return result;
+}
 
-    // cast from @Vector(N, T) to [N]T
-    if (wanted_type->id == ZigTypeIdArray && actual_type->id == ZigTypeIdVector &&
-        wanted_type->data.array.len == actual_type->data.vector.len &&
-        types_match_const_cast_only(ira, wanted_type->data.array.child_type,
-            actual_type->data.vector.elem_type, source_node, false).id == ConstCastResultIdOk)
-    {
-        return ir_analyze_vector_to_array(ira, source_instr, value, wanted_type, result_loc);
-    }
+static IrInstruction *ir_analyze_int_to_enum(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *target, ZigType *wanted_type)
+{
+    Error err;
+    assert(wanted_type->id == ZigTypeIdEnum);
 
-    // cast from [N]T to @Vector(N, T)
-    if (actual_type->id == ZigTypeIdArray && wanted_type->id == ZigTypeIdVector &&
-        actual_type->data.array.len == wanted_type->data.vector.len &&
-        types_match_const_cast_only(ira, actual_type->data.array.child_type,
-            wanted_type->data.vector.elem_type, source_node, false).id == ConstCastResultIdOk)
-    {
-        return ir_analyze_array_to_vector(ira, source_instr, value, wanted_type);
-    }
+    ZigType *actual_type = target->value->type;
 
-    // casting between C pointers and normal pointers
-    if (wanted_type->id == ZigTypeIdPointer && actual_type->id == ZigTypeIdPointer &&
-        (wanted_type->data.pointer.ptr_len == PtrLenC || actual_type->data.pointer.ptr_len == PtrLenC) &&
-        types_match_const_cast_only(ira, wanted_type->data.pointer.child_type,
-            actual_type->data.pointer.child_type, source_node,
-            !wanted_type->data.pointer.is_const).id == ConstCastResultIdOk)
-    {
-        return ir_analyze_ptr_cast(ira, source_instr, value, wanted_type, source_instr, true);
-    }
+    if ((err = ensure_complete_type(ira->codegen, wanted_type)))
+        return ira->codegen->invalid_instruction;
 
-    // cast from integer to C pointer
-    if (wanted_type->id == ZigTypeIdPointer && wanted_type->data.pointer.ptr_len == PtrLenC &&
-        (actual_type->id == ZigTypeIdInt || actual_type->id == ZigTypeIdComptimeInt))
-    {
-        return ir_analyze_int_to_c_ptr(ira, source_instr, value, wanted_type);
+    if (actual_type != wanted_type->data.enumeration.tag_int_type) {
+        ir_add_error(ira, source_instr,
+                buf_sprintf("integer to enum cast from '%s' instead of its tag type, '%s'",
+                    buf_ptr(&actual_type->name),
+                    buf_ptr(&wanted_type->data.enumeration.tag_int_type->name)));
+        return ira->codegen->invalid_instruction;
     }
 
-    // cast from undefined to anything
-    if (actual_type->id == ZigTypeIdUndefined) {
-        return ir_analyze_undefined_to_anything(ira, source_instr, value, wanted_type);
-    }
+    assert(actual_type->id == ZigTypeIdInt || actual_type->id == ZigTypeIdComptimeInt);
 
-    ErrorMsg *parent_msg = ir_add_error_node(ira, source_instr->source_node,
-        buf_sprintf("expected type '%s', found '%s'",
-            buf_ptr(&wanted_type->name),
-            buf_ptr(&actual_type->name)));
-    report_recursive_error(ira, source_instr->source_node, &const_cast_result, parent_msg);
-    return ira->codegen->invalid_instruction;
-}
+    if (instr_is_comptime(target)) {
+        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+        if (!val)
+            return ira->codegen->invalid_instruction;
 
-static IrInstruction *ir_implicit_cast_with_result(IrAnalyze *ira, IrInstruction *value, ZigType *expected_type,
-        ResultLoc *result_loc)
-{
-    assert(value);
-    assert(value != ira->codegen->invalid_instruction);
-    assert(!expected_type || !type_is_invalid(expected_type));
-    assert(value->value.type);
-    assert(!type_is_invalid(value->value.type));
-    if (expected_type == nullptr)
-        return value; // anything will do
-    if (expected_type == value->value.type)
-        return value; // match
-    if (value->value.type->id == ZigTypeIdUnreachable)
-        return value;
+        TypeEnumField *field = find_enum_field_by_tag(wanted_type, &val->data.x_bigint);
+        if (field == nullptr) {
+            Buf *val_buf = buf_alloc();
+            bigint_append_buf(val_buf, &val->data.x_bigint, 10);
+            ErrorMsg *msg = ir_add_error(ira, source_instr,
+                buf_sprintf("enum '%s' has no tag matching integer value %s",
+                    buf_ptr(&wanted_type->name), buf_ptr(val_buf)));
+            add_error_note(ira->codegen, msg, wanted_type->data.enumeration.decl_node,
+                    buf_sprintf("'%s' declared here", buf_ptr(&wanted_type->name)));
+            return ira->codegen->invalid_instruction;
+        }
 
-    return ir_analyze_cast(ira, value, expected_type, value, result_loc);
-}
+        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+        bigint_init_bigint(&result->value->data.x_enum_tag, &val->data.x_bigint);
+        return result;
+    }
 
-static IrInstruction *ir_implicit_cast(IrAnalyze *ira, IrInstruction *value, ZigType *expected_type) {
-    return ir_implicit_cast_with_result(ira, value, expected_type, nullptr);
+    IrInstruction *result = ir_build_int_to_enum(&ira->new_irb, source_instr->scope,
+            source_instr->source_node, nullptr, target);
+    result->value->type = wanted_type;
+    return result;
 }
 
-static IrInstruction *ir_get_deref(IrAnalyze *ira, IrInstruction *source_instruction, IrInstruction *ptr,
-        ResultLoc *result_loc)
+static IrInstruction *ir_analyze_number_to_literal(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *target, ZigType *wanted_type)
 {
-    Error err;
-    ZigType *type_entry = ptr->value.type;
-    if (type_is_invalid(type_entry))
+    ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+    if (!val)
         return ira->codegen->invalid_instruction;
 
-    if (type_entry->id != ZigTypeIdPointer) {
-        ir_add_error_node(ira, source_instruction->source_node,
-            buf_sprintf("attempt to dereference non-pointer type '%s'",
-                buf_ptr(&type_entry->name)));
-        return ira->codegen->invalid_instruction;
+    IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+    if (wanted_type->id == ZigTypeIdComptimeFloat) {
+        float_init_float(result->value, val);
+    } else if (wanted_type->id == ZigTypeIdComptimeInt) {
+        bigint_init_bigint(&result->value->data.x_bigint, &val->data.x_bigint);
+    } else {
+        zig_unreachable();
     }
+    return result;
+}
 
-    ZigType *child_type = type_entry->data.pointer.child_type;
-    // if the child type has one possible value, the deref is comptime
-    switch (type_has_one_possible_value(ira->codegen, child_type)) {
-        case OnePossibleValueInvalid:
+static IrInstruction *ir_analyze_int_to_err(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *target,
+    ZigType *wanted_type)
+{
+    assert(target->value->type->id == ZigTypeIdInt);
+    assert(!target->value->type->data.integral.is_signed);
+    assert(wanted_type->id == ZigTypeIdErrorSet);
+
+    if (instr_is_comptime(target)) {
+        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+        if (!val)
             return ira->codegen->invalid_instruction;
-        case OnePossibleValueYes:
-            return ir_const(ira, source_instruction, child_type);
-        case OnePossibleValueNo:
-            break;
-    }
-    if (instr_is_comptime(ptr)) {
-        if (ptr->value.special == ConstValSpecialUndef) {
-            ir_add_error(ira, ptr, buf_sprintf("attempt to dereference undefined value"));
+
+        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+
+        if (!resolve_inferred_error_set(ira->codegen, wanted_type, source_instr->source_node)) {
             return ira->codegen->invalid_instruction;
         }
-        if (ptr->value.data.x_ptr.mut != ConstPtrMutRuntimeVar) {
-            ConstExprValue *pointee = const_ptr_pointee_unchecked(ira->codegen, &ptr->value);
-            if (pointee->special != ConstValSpecialRuntime) {
-                IrInstruction *result = ir_const(ira, source_instruction, child_type);
 
-                if ((err = ir_read_const_ptr(ira, ira->codegen, source_instruction->source_node, &result->value,
-                                &ptr->value)))
-                {
-                    return ira->codegen->invalid_instruction;
-                }
-                result->value.type = child_type;
-                return result;
-            }
-        }
-    }
-    // if the instruction is a const ref instruction we can skip it
-    if (ptr->id == IrInstructionIdRef) {
-        IrInstructionRef *ref_inst = reinterpret_cast<IrInstructionRef *>(ptr);
-        return ref_inst->value;
-    }
+        if (type_is_global_error_set(wanted_type)) {
+            BigInt err_count;
+            bigint_init_unsigned(&err_count, ira->codegen->errors_by_index.length);
 
-    IrInstruction *result_loc_inst;
-    if (type_entry->data.pointer.host_int_bytes != 0 && handle_is_ptr(child_type)) {
-        if (result_loc == nullptr) result_loc = no_result_loc();
-        result_loc_inst = ir_resolve_result(ira, source_instruction, result_loc, child_type, nullptr, true, false);
-        if (type_is_invalid(result_loc_inst->value.type) || instr_is_unreachable(result_loc_inst)) {
-            return result_loc_inst;
-        }
-    } else {
-        result_loc_inst = nullptr;
-    }
-
-    return ir_build_load_ptr_gen(ira, source_instruction, ptr, child_type, result_loc_inst);
-}
-
-static bool ir_resolve_align(IrAnalyze *ira, IrInstruction *value, uint32_t *out) {
-    if (type_is_invalid(value->value.type))
-        return false;
+            if (bigint_cmp_zero(&val->data.x_bigint) == CmpEQ || bigint_cmp(&val->data.x_bigint, &err_count) != CmpLT) {
+                Buf *val_buf = buf_alloc();
+                bigint_append_buf(val_buf, &val->data.x_bigint, 10);
+                ir_add_error(ira, source_instr,
+                    buf_sprintf("integer value %s represents no error", buf_ptr(val_buf)));
+                return ira->codegen->invalid_instruction;
+            }
 
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, get_align_amt_type(ira->codegen));
-    if (type_is_invalid(casted_value->value.type))
-        return false;
+            size_t index = bigint_as_unsigned(&val->data.x_bigint);
+            result->value->data.x_err_set = ira->codegen->errors_by_index.at(index);
+            return result;
+        } else {
+            ErrorTableEntry *err = nullptr;
+            BigInt err_int;
 
-    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
-    if (!const_val)
-        return false;
+            for (uint32_t i = 0, count = wanted_type->data.error_set.err_count; i < count; i += 1) {
+                ErrorTableEntry *this_err = wanted_type->data.error_set.errors[i];
+                bigint_init_unsigned(&err_int, this_err->value);
+                if (bigint_cmp(&val->data.x_bigint, &err_int) == CmpEQ) {
+                    err = this_err;
+                    break;
+                }
+            }
 
-    uint32_t align_bytes = bigint_as_unsigned(&const_val->data.x_bigint);
-    if (align_bytes == 0) {
-        ir_add_error(ira, value, buf_sprintf("alignment must be >= 1"));
-        return false;
-    }
+            if (err == nullptr) {
+                Buf *val_buf = buf_alloc();
+                bigint_append_buf(val_buf, &val->data.x_bigint, 10);
+                ir_add_error(ira, source_instr,
+                    buf_sprintf("integer value %s represents no error in '%s'", buf_ptr(val_buf), buf_ptr(&wanted_type->name)));
+                return ira->codegen->invalid_instruction;
+            }
 
-    if (!is_power_of_2(align_bytes)) {
-        ir_add_error(ira, value, buf_sprintf("alignment value %" PRIu32 " is not a power of 2", align_bytes));
-        return false;
+            result->value->data.x_err_set = err;
+            return result;
+        }
     }
 
-    *out = align_bytes;
-    return true;
+    IrInstruction *result = ir_build_int_to_err(&ira->new_irb, source_instr->scope, source_instr->source_node, target);
+    result->value->type = wanted_type;
+    return result;
 }
 
-static bool ir_resolve_unsigned(IrAnalyze *ira, IrInstruction *value, ZigType *int_type, uint64_t *out) {
-    if (type_is_invalid(value->value.type))
-        return false;
-
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, int_type);
-    if (type_is_invalid(casted_value->value.type))
-        return false;
-
-    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
-    if (!const_val)
-        return false;
-
-    *out = bigint_as_unsigned(&const_val->data.x_bigint);
-    return true;
-}
+static IrInstruction *ir_analyze_err_to_int(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *target,
+        ZigType *wanted_type)
+{
+    assert(wanted_type->id == ZigTypeIdInt);
 
-static bool ir_resolve_usize(IrAnalyze *ira, IrInstruction *value, uint64_t *out) {
-    return ir_resolve_unsigned(ira, value, ira->codegen->builtin_types.entry_usize, out);
-}
+    ZigType *err_type = target->value->type;
 
-static bool ir_resolve_bool(IrAnalyze *ira, IrInstruction *value, bool *out) {
-    if (type_is_invalid(value->value.type))
-        return false;
+    if (instr_is_comptime(target)) {
+        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+        if (!val)
+            return ira->codegen->invalid_instruction;
 
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, ira->codegen->builtin_types.entry_bool);
-    if (type_is_invalid(casted_value->value.type))
-        return false;
+        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
 
-    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
-    if (!const_val)
-        return false;
+        ErrorTableEntry *err;
+        if (err_type->id == ZigTypeIdErrorUnion) {
+            err = val->data.x_err_union.error_set->data.x_err_set;
+        } else if (err_type->id == ZigTypeIdErrorSet) {
+            err = val->data.x_err_set;
+        } else {
+            zig_unreachable();
+        }
+        result->value->type = wanted_type;
+        uint64_t err_value = err ? err->value : 0;
+        bigint_init_unsigned(&result->value->data.x_bigint, err_value);
 
-    *out = const_val->data.x_bool;
-    return true;
-}
+        if (!bigint_fits_in_bits(&result->value->data.x_bigint,
+            wanted_type->data.integral.bit_count, wanted_type->data.integral.is_signed))
+        {
+            ir_add_error_node(ira, source_instr->source_node,
+                    buf_sprintf("error code '%s' does not fit in '%s'",
+                        buf_ptr(&err->name), buf_ptr(&wanted_type->name)));
+            return ira->codegen->invalid_instruction;
+        }
 
-static bool ir_resolve_comptime(IrAnalyze *ira, IrInstruction *value, bool *out) {
-    if (!value) {
-        *out = false;
-        return true;
+        return result;
     }
-    return ir_resolve_bool(ira, value, out);
-}
-
-static bool ir_resolve_atomic_order(IrAnalyze *ira, IrInstruction *value, AtomicOrder *out) {
-    if (type_is_invalid(value->value.type))
-        return false;
-
-    ConstExprValue *atomic_order_val = get_builtin_value(ira->codegen, "AtomicOrder");
-    assert(atomic_order_val->type->id == ZigTypeIdMetaType);
-    ZigType *atomic_order_type = atomic_order_val->data.x_type;
-
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, atomic_order_type);
-    if (type_is_invalid(casted_value->value.type))
-        return false;
 
-    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
-    if (!const_val)
-        return false;
-
-    *out = (AtomicOrder)bigint_as_unsigned(&const_val->data.x_enum_tag);
-    return true;
-}
-
-static bool ir_resolve_atomic_rmw_op(IrAnalyze *ira, IrInstruction *value, AtomicRmwOp *out) {
-    if (type_is_invalid(value->value.type))
-        return false;
-
-    ConstExprValue *atomic_rmw_op_val = get_builtin_value(ira->codegen, "AtomicRmwOp");
-    assert(atomic_rmw_op_val->type->id == ZigTypeIdMetaType);
-    ZigType *atomic_rmw_op_type = atomic_rmw_op_val->data.x_type;
-
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, atomic_rmw_op_type);
-    if (type_is_invalid(casted_value->value.type))
-        return false;
-
-    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
-    if (!const_val)
-        return false;
-
-    *out = (AtomicRmwOp)bigint_as_unsigned(&const_val->data.x_enum_tag);
-    return true;
-}
-
-static bool ir_resolve_global_linkage(IrAnalyze *ira, IrInstruction *value, GlobalLinkageId *out) {
-    if (type_is_invalid(value->value.type))
-        return false;
-
-    ConstExprValue *global_linkage_val = get_builtin_value(ira->codegen, "GlobalLinkage");
-    assert(global_linkage_val->type->id == ZigTypeIdMetaType);
-    ZigType *global_linkage_type = global_linkage_val->data.x_type;
-
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, global_linkage_type);
-    if (type_is_invalid(casted_value->value.type))
-        return false;
+    ZigType *err_set_type;
+    if (err_type->id == ZigTypeIdErrorUnion) {
+        err_set_type = err_type->data.error_union.err_set_type;
+    } else if (err_type->id == ZigTypeIdErrorSet) {
+        err_set_type = err_type;
+    } else {
+        zig_unreachable();
+    }
+    if (!type_is_global_error_set(err_set_type)) {
+        if (!resolve_inferred_error_set(ira->codegen, err_set_type, source_instr->source_node)) {
+            return ira->codegen->invalid_instruction;
+        }
+        if (err_set_type->data.error_set.err_count == 0) {
+            IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+            bigint_init_unsigned(&result->value->data.x_bigint, 0);
+            return result;
+        } else if (err_set_type->data.error_set.err_count == 1) {
+            IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+            ErrorTableEntry *err = err_set_type->data.error_set.errors[0];
+            bigint_init_unsigned(&result->value->data.x_bigint, err->value);
+            return result;
+        }
+    }
 
-    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
-    if (!const_val)
-        return false;
+    BigInt bn;
+    bigint_init_unsigned(&bn, ira->codegen->errors_by_index.length);
+    if (!bigint_fits_in_bits(&bn, wanted_type->data.integral.bit_count, wanted_type->data.integral.is_signed)) {
+        ir_add_error_node(ira, source_instr->source_node,
+                buf_sprintf("too many error values to fit in '%s'", buf_ptr(&wanted_type->name)));
+        return ira->codegen->invalid_instruction;
+    }
 
-    *out = (GlobalLinkageId)bigint_as_unsigned(&const_val->data.x_enum_tag);
-    return true;
+    IrInstruction *result = ir_build_err_to_int(&ira->new_irb, source_instr->scope, source_instr->source_node, target);
+    result->value->type = wanted_type;
+    return result;
 }
 
-static bool ir_resolve_float_mode(IrAnalyze *ira, IrInstruction *value, FloatMode *out) {
-    if (type_is_invalid(value->value.type))
-        return false;
+static IrInstruction *ir_analyze_ptr_to_array(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *target,
+        ZigType *wanted_type)
+{
+    assert(wanted_type->id == ZigTypeIdPointer);
+    Error err;
+    if ((err = type_resolve(ira->codegen, target->value->type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
+        return ira->codegen->invalid_instruction;
+    assert((wanted_type->data.pointer.is_const && target->value->type->data.pointer.is_const) || !target->value->type->data.pointer.is_const);
+    wanted_type = adjust_ptr_align(ira->codegen, wanted_type, get_ptr_align(ira->codegen, target->value->type));
+    ZigType *array_type = wanted_type->data.pointer.child_type;
+    assert(array_type->id == ZigTypeIdArray);
+    assert(array_type->data.array.len == 1);
 
-    ConstExprValue *float_mode_val = get_builtin_value(ira->codegen, "FloatMode");
-    assert(float_mode_val->type->id == ZigTypeIdMetaType);
-    ZigType *float_mode_type = float_mode_val->data.x_type;
+    if (instr_is_comptime(target)) {
+        ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
+        if (!val)
+            return ira->codegen->invalid_instruction;
 
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, float_mode_type);
-    if (type_is_invalid(casted_value->value.type))
-        return false;
+        assert(val->type->id == ZigTypeIdPointer);
+        ConstExprValue *pointee = const_ptr_pointee(ira, ira->codegen, val, source_instr->source_node);
+        if (pointee == nullptr)
+            return ira->codegen->invalid_instruction;
+        if (pointee->special != ConstValSpecialRuntime) {
+            ConstExprValue *array_val = create_const_vals(1);
+            array_val->special = ConstValSpecialStatic;
+            array_val->type = array_type;
+            array_val->data.x_array.special = ConstArraySpecialNone;
+            array_val->data.x_array.data.s_none.elements = pointee;
+            array_val->parent.id = ConstParentIdScalar;
+            array_val->parent.data.p_scalar.scalar_val = pointee;
 
-    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
-    if (!const_val)
-        return false;
+            IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
+                    source_instr->scope, source_instr->source_node);
+            const_instruction->base.value->type = wanted_type;
+            const_instruction->base.value->special = ConstValSpecialStatic;
+            const_instruction->base.value->data.x_ptr.special = ConstPtrSpecialRef;
+            const_instruction->base.value->data.x_ptr.data.ref.pointee = array_val;
+            const_instruction->base.value->data.x_ptr.mut = val->data.x_ptr.mut;
+            return &const_instruction->base;
+        }
+    }
 
-    *out = (FloatMode)bigint_as_unsigned(&const_val->data.x_enum_tag);
-    return true;
+    // pointer to array and pointer to single item are represented the same way at runtime
+    IrInstruction *result = ir_build_cast(&ira->new_irb, target->scope, target->source_node,
+            wanted_type, target, CastOpBitCast);
+    result->value->type = wanted_type;
+    return result;
 }
 
-
-static Buf *ir_resolve_str(IrAnalyze *ira, IrInstruction *value) {
-    if (type_is_invalid(value->value.type))
-        return nullptr;
-
-    ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, ira->codegen->builtin_types.entry_u8,
-            true, false, PtrLenUnknown, 0, 0, 0, false);
-    ZigType *str_type = get_slice_type(ira->codegen, ptr_type);
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, str_type);
-    if (type_is_invalid(casted_value->value.type))
-        return nullptr;
-
-    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
-    if (!const_val)
-        return nullptr;
-
-    ConstExprValue *ptr_field = &const_val->data.x_struct.fields[slice_ptr_index];
-    ConstExprValue *len_field = &const_val->data.x_struct.fields[slice_len_index];
-
-    assert(ptr_field->data.x_ptr.special == ConstPtrSpecialBaseArray);
-    ConstExprValue *array_val = ptr_field->data.x_ptr.data.base_array.array_val;
-    if (array_val->data.x_array.special == ConstArraySpecialBuf) {
-        return array_val->data.x_array.data.s_buf;
-    }
-    expand_undef_array(ira->codegen, array_val);
-    size_t len = bigint_as_unsigned(&len_field->data.x_bigint);
-    Buf *result = buf_alloc();
-    buf_resize(result, len);
-    for (size_t i = 0; i < len; i += 1) {
-        size_t new_index = ptr_field->data.x_ptr.data.base_array.elem_index + i;
-        ConstExprValue *char_val = &array_val->data.x_array.data.s_none.elements[new_index];
-        if (char_val->special == ConstValSpecialUndef) {
-            ir_add_error(ira, casted_value, buf_sprintf("use of undefined value"));
-            return nullptr;
+static void report_recursive_error(IrAnalyze *ira, AstNode *source_node, ConstCastOnly *cast_result,
+        ErrorMsg *parent_msg)
+{
+    switch (cast_result->id) {
+        case ConstCastResultIdOk:
+            zig_unreachable();
+        case ConstCastResultIdInvalid:
+            zig_unreachable();
+        case ConstCastResultIdOptionalChild: {
+            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
+                    buf_sprintf("optional type child '%s' cannot cast into optional type child '%s'",
+                        buf_ptr(&cast_result->data.optional->actual_child->name),
+                        buf_ptr(&cast_result->data.optional->wanted_child->name)));
+            report_recursive_error(ira, source_node, &cast_result->data.optional->child, msg);
+            break;
         }
-        uint64_t big_c = bigint_as_unsigned(&char_val->data.x_bigint);
-        assert(big_c <= UINT8_MAX);
-        uint8_t c = (uint8_t)big_c;
-        buf_ptr(result)[i] = c;
+        case ConstCastResultIdErrorUnionErrorSet: {
+            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
+                    buf_sprintf("error set '%s' cannot cast into error set '%s'",
+                        buf_ptr(&cast_result->data.error_union_error_set->actual_err_set->name),
+                        buf_ptr(&cast_result->data.error_union_error_set->wanted_err_set->name)));
+            report_recursive_error(ira, source_node, &cast_result->data.error_union_error_set->child, msg);
+            break;
+        }
+        case ConstCastResultIdErrSet: {
+            ZigList<ErrorTableEntry *> *missing_errors = &cast_result->data.error_set_mismatch->missing_errors;
+            for (size_t i = 0; i < missing_errors->length; i += 1) {
+                ErrorTableEntry *error_entry = missing_errors->at(i);
+                add_error_note(ira->codegen, parent_msg, error_entry->decl_node,
+                    buf_sprintf("'error.%s' not a member of destination error set", buf_ptr(&error_entry->name)));
+            }
+            break;
+        }
+        case ConstCastResultIdErrSetGlobal: {
+            add_error_note(ira->codegen, parent_msg, source_node,
+                    buf_sprintf("cannot cast global error set into smaller set"));
+            break;
+        }
+        case ConstCastResultIdPointerChild: {
+            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
+                    buf_sprintf("pointer type child '%s' cannot cast into pointer type child '%s'",
+                        buf_ptr(&cast_result->data.pointer_mismatch->actual_child->name),
+                        buf_ptr(&cast_result->data.pointer_mismatch->wanted_child->name)));
+            report_recursive_error(ira, source_node, &cast_result->data.pointer_mismatch->child, msg);
+            break;
+        }
+        case ConstCastResultIdSliceChild: {
+            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
+                    buf_sprintf("slice type child '%s' cannot cast into slice type child '%s'",
+                        buf_ptr(&cast_result->data.slice_mismatch->actual_child->name),
+                        buf_ptr(&cast_result->data.slice_mismatch->wanted_child->name)));
+            report_recursive_error(ira, source_node, &cast_result->data.slice_mismatch->child, msg);
+            break;
+        }
+        case ConstCastResultIdErrorUnionPayload: {
+            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
+                    buf_sprintf("error union payload '%s' cannot cast into error union payload '%s'",
+                        buf_ptr(&cast_result->data.error_union_payload->actual_payload->name),
+                        buf_ptr(&cast_result->data.error_union_payload->wanted_payload->name)));
+            report_recursive_error(ira, source_node, &cast_result->data.error_union_payload->child, msg);
+            break;
+        }
+        case ConstCastResultIdType: {
+            AstNode *wanted_decl_node = type_decl_node(cast_result->data.type_mismatch->wanted_type);
+            AstNode *actual_decl_node = type_decl_node(cast_result->data.type_mismatch->actual_type);
+            if (wanted_decl_node != nullptr) {
+                add_error_note(ira->codegen, parent_msg, wanted_decl_node,
+                    buf_sprintf("%s declared here",
+                        buf_ptr(&cast_result->data.type_mismatch->wanted_type->name)));
+            }
+            if (actual_decl_node != nullptr) {
+                add_error_note(ira->codegen, parent_msg, actual_decl_node,
+                    buf_sprintf("%s declared here",
+                        buf_ptr(&cast_result->data.type_mismatch->actual_type->name)));
+            }
+            break;
+        }
+        case ConstCastResultIdFnArg: {
+            ErrorMsg *msg = add_error_note(ira->codegen, parent_msg, source_node,
+                    buf_sprintf("parameter %" ZIG_PRI_usize ": '%s' cannot cast into '%s'",
+                        cast_result->data.fn_arg.arg_index,
+                        buf_ptr(&cast_result->data.fn_arg.actual_param_type->name),
+                        buf_ptr(&cast_result->data.fn_arg.expected_param_type->name)));
+            report_recursive_error(ira, source_node, cast_result->data.fn_arg.child, msg);
+            break;
+        }
+        case ConstCastResultIdBadAllowsZero: {
+            ZigType *wanted_type = cast_result->data.bad_allows_zero->wanted_type;
+            ZigType *actual_type = cast_result->data.bad_allows_zero->actual_type;
+            bool wanted_allows_zero = ptr_allows_addr_zero(wanted_type);
+            bool actual_allows_zero = ptr_allows_addr_zero(actual_type);
+            if (actual_allows_zero && !wanted_allows_zero) {
+                add_error_note(ira->codegen, parent_msg, source_node,
+                        buf_sprintf("'%s' could have null values which are illegal in type '%s'",
+                            buf_ptr(&actual_type->name),
+                            buf_ptr(&wanted_type->name)));
+            } else {
+                add_error_note(ira->codegen, parent_msg, source_node,
+                        buf_sprintf("mutable '%s' allows illegal null values stored to type '%s'",
+                            buf_ptr(&wanted_type->name),
+                            buf_ptr(&actual_type->name)));
+            }
+            break;
+        }
+        case ConstCastResultIdFnIsGeneric:
+            add_error_note(ira->codegen, parent_msg, source_node,
+                    buf_sprintf("only one of the functions is generic"));
+            break;
+        case ConstCastResultIdFnAlign: // TODO
+        case ConstCastResultIdFnCC: // TODO
+        case ConstCastResultIdFnVarArgs: // TODO
+        case ConstCastResultIdFnReturnType: // TODO
+        case ConstCastResultIdFnArgCount: // TODO
+        case ConstCastResultIdFnGenericArgCount: // TODO
+        case ConstCastResultIdFnArgNoAlias: // TODO
+        case ConstCastResultIdUnresolvedInferredErrSet: // TODO
+        case ConstCastResultIdAsyncAllocatorType: // TODO
+            break;
     }
-    return result;
 }
 
-static IrInstruction *ir_analyze_instruction_add_implicit_return_type(IrAnalyze *ira,
-        IrInstructionAddImplicitReturnType *instruction)
+static IrInstruction *ir_analyze_array_to_vector(IrAnalyze *ira, IrInstruction *source_instr,
+    IrInstruction *array, ZigType *vector_type)
 {
-    IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
-        return ir_unreach_error(ira);
-
-    ira->src_implicit_return_type_list.append(value);
+    if (instr_is_comptime(array)) {
+        // arrays and vectors have the same ConstExprValue representation
+        IrInstruction *result = ir_const(ira, source_instr, vector_type);
+        copy_const_val(result->value, array->value, false);
+        result->value->type = vector_type;
+        return result;
+    }
+    return ir_build_array_to_vector(ira, source_instr, array, vector_type);
+}
 
-    return ir_const_void(ira, &instruction->base);
+static IrInstruction *ir_analyze_vector_to_array(IrAnalyze *ira, IrInstruction *source_instr,
+    IrInstruction *vector, ZigType *array_type, ResultLoc *result_loc)
+{
+    if (instr_is_comptime(vector)) {
+        // arrays and vectors have the same ConstExprValue representation
+        IrInstruction *result = ir_const(ira, source_instr, array_type);
+        copy_const_val(result->value, vector->value, false);
+        result->value->type = array_type;
+        return result;
+    }
+    if (result_loc == nullptr) {
+        result_loc = no_result_loc();
+    }
+    IrInstruction *result_loc_inst = ir_resolve_result(ira, source_instr, result_loc, array_type, nullptr, true, false);
+    if (type_is_invalid(result_loc_inst->value->type) || instr_is_unreachable(result_loc_inst)) {
+        return result_loc_inst;
+    }
+    return ir_build_vector_to_array(ira, source_instr, array_type, vector, result_loc_inst);
 }
 
-static IrInstruction *ir_analyze_instruction_return(IrAnalyze *ira, IrInstructionReturn *instruction) {
-    IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
-        return ir_unreach_error(ira);
+static IrInstruction *ir_analyze_int_to_c_ptr(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *integer, ZigType *dest_type)
+{
+    IrInstruction *unsigned_integer;
+    if (instr_is_comptime(integer)) {
+        unsigned_integer = integer;
+    } else {
+        assert(integer->value->type->id == ZigTypeIdInt);
 
-    if (!instr_is_comptime(value) && handle_is_ptr(ira->explicit_return_type)) {
-        // result location mechanism took care of it.
-        IrInstruction *result = ir_build_return(&ira->new_irb, instruction->base.scope,
-                instruction->base.source_node, nullptr);
-        result->value.type = ira->codegen->builtin_types.entry_unreachable;
-        return ir_finish_anal(ira, result);
-    }
+        if (integer->value->type->data.integral.bit_count >
+            ira->codegen->builtin_types.entry_usize->data.integral.bit_count)
+        {
+            ir_add_error(ira, source_instr,
+                buf_sprintf("integer type '%s' too big for implicit @intToPtr to type '%s'",
+                    buf_ptr(&integer->value->type->name),
+                    buf_ptr(&dest_type->name)));
+            return ira->codegen->invalid_instruction;
+        }
 
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, ira->explicit_return_type);
-    if (type_is_invalid(casted_value->value.type)) {
-        AstNode *source_node = ira->explicit_return_type_source_node;
-        if (source_node != nullptr) {
-            ErrorMsg *msg = ira->codegen->errors.last();
-            add_error_note(ira->codegen, msg, source_node,
-                buf_sprintf("return type declared here"));
+        if (integer->value->type->data.integral.is_signed) {
+            ZigType *unsigned_int_type = get_int_type(ira->codegen, false,
+                    integer->value->type->data.integral.bit_count);
+            unsigned_integer = ir_analyze_bit_cast(ira, source_instr, integer, unsigned_int_type);
+            if (type_is_invalid(unsigned_integer->value->type))
+                return ira->codegen->invalid_instruction;
+        } else {
+            unsigned_integer = integer;
         }
-        return ir_unreach_error(ira);
     }
 
-    if (casted_value->value.special == ConstValSpecialRuntime &&
-        casted_value->value.type->id == ZigTypeIdPointer &&
-        casted_value->value.data.rh_ptr == RuntimeHintPtrStack)
-    {
-        ir_add_error(ira, casted_value, buf_sprintf("function returns address of local variable"));
-        return ir_unreach_error(ira);
-    }
-    IrInstruction *result = ir_build_return(&ira->new_irb, instruction->base.scope,
-            instruction->base.source_node, casted_value);
-    result->value.type = ira->codegen->builtin_types.entry_unreachable;
-    return ir_finish_anal(ira, result);
+    return ir_analyze_int_to_ptr(ira, source_instr, unsigned_integer, dest_type);
 }
 
-static IrInstruction *ir_analyze_instruction_const(IrAnalyze *ira, IrInstructionConst *instruction) {
-    IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
-    copy_const_val(&result->value, &instruction->base.value, true);
-    return result;
+static bool is_pointery_and_elem_is_not_pointery(ZigType *ty) {
+    if (ty->id == ZigTypeIdPointer) return ty->data.pointer.child_type->id != ZigTypeIdPointer;
+    if (ty->id == ZigTypeIdFn) return true;
+    if (ty->id == ZigTypeIdPromise) return true;
+    if (ty->id == ZigTypeIdOptional) {
+        ZigType *ptr_ty = ty->data.maybe.child_type;
+        if (ptr_ty->id == ZigTypeIdPointer) return ptr_ty->data.pointer.child_type->id != ZigTypeIdPointer;
+        if (ptr_ty->id == ZigTypeIdFn) return true;
+        if (ptr_ty->id == ZigTypeIdPromise) return true;
+    }
+    return false;
 }
 
-static IrInstruction *ir_analyze_bin_op_bool(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
-    IrInstruction *op1 = bin_op_instruction->op1->child;
-    if (type_is_invalid(op1->value.type))
-        return ira->codegen->invalid_instruction;
+static IrInstruction *ir_analyze_cast(IrAnalyze *ira, IrInstruction *source_instr,
+    ZigType *wanted_type, IrInstruction *value, ResultLoc *result_loc)
+{
+    Error err;
+    ZigType *actual_type = value->value->type;
+    AstNode *source_node = source_instr->source_node;
 
-    IrInstruction *op2 = bin_op_instruction->op2->child;
-    if (type_is_invalid(op2->value.type))
+    if (type_is_invalid(wanted_type) || type_is_invalid(actual_type)) {
         return ira->codegen->invalid_instruction;
+    }
 
-    ZigType *bool_type = ira->codegen->builtin_types.entry_bool;
+    bool actual_is_vector = actual_type->id == ZigTypeIdVector;
+    bool wanted_is_vector = wanted_type->id == ZigTypeIdVector;
+    ZigType *actual_scalar_type = actual_is_vector ? actual_type->data.vector.elem_type : actual_type;
+    ZigType *wanted_scalar_type = wanted_is_vector ? wanted_type->data.vector.elem_type : wanted_type;
 
-    IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, bool_type);
-    if (casted_op1 == ira->codegen->invalid_instruction)
+    // perfect match or non-const to const
+    ConstCastOnly const_cast_result = types_match_const_cast_only(ira, wanted_type, actual_type,
+            source_node, false);
+    if (const_cast_result.id == ConstCastResultIdInvalid)
         return ira->codegen->invalid_instruction;
+    if (const_cast_result.id == ConstCastResultIdOk) {
+        return ir_resolve_cast(ira, source_instr, value, wanted_type, CastOpNoop);
+    }
 
-    IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, bool_type);
-    if (casted_op2 == ira->codegen->invalid_instruction)
-        return ira->codegen->invalid_instruction;
-
-    if (instr_is_comptime(casted_op1) && instr_is_comptime(casted_op2)) {
-        ConstExprValue *op1_val = ir_resolve_const(ira, casted_op1, UndefBad);
-        if (op1_val == nullptr)
-            return ira->codegen->invalid_instruction;
-
-        ConstExprValue *op2_val = ir_resolve_const(ira, casted_op2, UndefBad);
-        if (op2_val == nullptr)
-            return ira->codegen->invalid_instruction;
-
-        assert(casted_op1->value.type->id == ZigTypeIdBool);
-        assert(casted_op2->value.type->id == ZigTypeIdBool);
-        bool result_bool;
-        if (bin_op_instruction->op_id == IrBinOpBoolOr) {
-            result_bool = op1_val->data.x_bool || op2_val->data.x_bool;
-        } else if (bin_op_instruction->op_id == IrBinOpBoolAnd) {
-            result_bool = op1_val->data.x_bool && op2_val->data.x_bool;
-        } else {
-            zig_unreachable();
+    // cast from T to ?T
+    // note that the *T to ?*T case is handled via the "ConstCastOnly" mechanism
+    if (wanted_type->id == ZigTypeIdOptional) {
+        ZigType *wanted_child_type = wanted_type->data.maybe.child_type;
+        if (types_match_const_cast_only(ira, wanted_child_type, actual_type, source_node,
+            false).id == ConstCastResultIdOk)
+        {
+            return ir_analyze_optional_wrap(ira, source_instr, value, wanted_type, result_loc);
+        } else if (actual_type->id == ZigTypeIdComptimeInt ||
+                   actual_type->id == ZigTypeIdComptimeFloat)
+        {
+            if (ir_num_lit_fits_in_other_type(ira, value, wanted_child_type, true)) {
+                return ir_analyze_optional_wrap(ira, source_instr, value, wanted_type, result_loc);
+            } else {
+                return ira->codegen->invalid_instruction;
+            }
+        } else if (
+            wanted_child_type->id == ZigTypeIdPointer &&
+            wanted_child_type->data.pointer.ptr_len == PtrLenUnknown &&
+            actual_type->id == ZigTypeIdPointer &&
+            actual_type->data.pointer.ptr_len == PtrLenSingle &&
+            actual_type->data.pointer.child_type->id == ZigTypeIdArray)
+        {
+            if ((err = type_resolve(ira->codegen, actual_type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
+                return ira->codegen->invalid_instruction;
+            if ((err = type_resolve(ira->codegen, wanted_child_type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
+                return ira->codegen->invalid_instruction;
+            if (get_ptr_align(ira->codegen, actual_type) >= get_ptr_align(ira->codegen, wanted_child_type) &&
+                types_match_const_cast_only(ira, wanted_child_type->data.pointer.child_type,
+                actual_type->data.pointer.child_type->data.array.child_type, source_node,
+                !wanted_child_type->data.pointer.is_const).id == ConstCastResultIdOk)
+            {
+                IrInstruction *cast1 = ir_resolve_ptr_of_array_to_unknown_len_ptr(ira, source_instr, value,
+                        wanted_child_type);
+                if (type_is_invalid(cast1->value->type))
+                    return ira->codegen->invalid_instruction;
+                return ir_analyze_optional_wrap(ira, source_instr, cast1, wanted_type, result_loc);
+            }
         }
-        return ir_const_bool(ira, &bin_op_instruction->base, result_bool);
-    }
-
-    IrInstruction *result = ir_build_bin_op(&ira->new_irb,
-            bin_op_instruction->base.scope, bin_op_instruction->base.source_node,
-            bin_op_instruction->op_id, casted_op1, casted_op2, bin_op_instruction->safety_check_on);
-    result->value.type = bool_type;
-    return result;
-}
-
-static bool resolve_cmp_op_id(IrBinOp op_id, Cmp cmp) {
-    switch (op_id) {
-        case IrBinOpCmpEq:
-            return cmp == CmpEQ;
-        case IrBinOpCmpNotEq:
-            return cmp != CmpEQ;
-        case IrBinOpCmpLessThan:
-            return cmp == CmpLT;
-        case IrBinOpCmpGreaterThan:
-            return cmp == CmpGT;
-        case IrBinOpCmpLessOrEq:
-            return cmp != CmpGT;
-        case IrBinOpCmpGreaterOrEq:
-            return cmp != CmpLT;
-        default:
-            zig_unreachable();
     }
-}
 
-static bool optional_value_is_null(ConstExprValue *val) {
-    assert(val->special == ConstValSpecialStatic);
-    if (get_codegen_ptr_type(val->type) != nullptr) {
-        if (val->data.x_ptr.special == ConstPtrSpecialNull) {
-            return true;
-        } else if (val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr) {
-            return val->data.x_ptr.data.hard_coded_addr.addr == 0;
-        } else {
-            return false;
+    // T to E!T
+    if (wanted_type->id == ZigTypeIdErrorUnion) {
+        if (types_match_const_cast_only(ira, wanted_type->data.error_union.payload_type, actual_type,
+            source_node, false).id == ConstCastResultIdOk)
+        {
+            return ir_analyze_err_wrap_payload(ira, source_instr, value, wanted_type, result_loc);
+        } else if (actual_type->id == ZigTypeIdComptimeInt ||
+                   actual_type->id == ZigTypeIdComptimeFloat)
+        {
+            if (ir_num_lit_fits_in_other_type(ira, value, wanted_type->data.error_union.payload_type, true)) {
+                return ir_analyze_err_wrap_payload(ira, source_instr, value, wanted_type, result_loc);
+            } else {
+                return ira->codegen->invalid_instruction;
+            }
         }
-    } else if (is_opt_err_set(val->type)) {
-        return val->data.x_err_set == nullptr;
-    } else {
-        return val->data.x_optional == nullptr;
     }
-}
-
-static IrInstruction *ir_analyze_bin_op_cmp(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
-    IrInstruction *op1 = bin_op_instruction->op1->child;
-    if (type_is_invalid(op1->value.type))
-        return ira->codegen->invalid_instruction;
-
-    IrInstruction *op2 = bin_op_instruction->op2->child;
-    if (type_is_invalid(op2->value.type))
-        return ira->codegen->invalid_instruction;
-
-    AstNode *source_node = bin_op_instruction->base.source_node;
 
-    IrBinOp op_id = bin_op_instruction->op_id;
-    bool is_equality_cmp = (op_id == IrBinOpCmpEq || op_id == IrBinOpCmpNotEq);
-    if (is_equality_cmp && op1->value.type->id == ZigTypeIdNull && op2->value.type->id == ZigTypeIdNull) {
-        return ir_const_bool(ira, &bin_op_instruction->base, (op_id == IrBinOpCmpEq));
-    } else if (is_equality_cmp &&
-        ((op1->value.type->id == ZigTypeIdNull && op2->value.type->id == ZigTypeIdOptional) ||
-        (op2->value.type->id == ZigTypeIdNull && op1->value.type->id == ZigTypeIdOptional)))
+    // cast from T to E!?T
+    if (wanted_type->id == ZigTypeIdErrorUnion &&
+        wanted_type->data.error_union.payload_type->id == ZigTypeIdOptional &&
+        actual_type->id != ZigTypeIdOptional)
     {
-        IrInstruction *maybe_op;
-        if (op1->value.type->id == ZigTypeIdNull) {
-            maybe_op = op2;
-        } else if (op2->value.type->id == ZigTypeIdNull) {
-            maybe_op = op1;
-        } else {
-            zig_unreachable();
-        }
-        if (instr_is_comptime(maybe_op)) {
-            ConstExprValue *maybe_val = ir_resolve_const(ira, maybe_op, UndefBad);
-            if (!maybe_val)
+        ZigType *wanted_child_type = wanted_type->data.error_union.payload_type->data.maybe.child_type;
+        if (types_match_const_cast_only(ira, wanted_child_type, actual_type, source_node, false).id == ConstCastResultIdOk ||
+            actual_type->id == ZigTypeIdNull ||
+            actual_type->id == ZigTypeIdComptimeInt ||
+            actual_type->id == ZigTypeIdComptimeFloat)
+        {
+            IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.error_union.payload_type, value, nullptr);
+            if (type_is_invalid(cast1->value->type))
                 return ira->codegen->invalid_instruction;
-            bool is_null = optional_value_is_null(maybe_val);
-            bool bool_result = (op_id == IrBinOpCmpEq) ? is_null : !is_null;
-            return ir_const_bool(ira, &bin_op_instruction->base, bool_result);
-        }
-
-        IrInstruction *is_non_null = ir_build_test_nonnull(&ira->new_irb, bin_op_instruction->base.scope,
-            source_node, maybe_op);
-        is_non_null->value.type = ira->codegen->builtin_types.entry_bool;
 
-        if (op_id == IrBinOpCmpEq) {
-            IrInstruction *result = ir_build_bool_not(&ira->new_irb, bin_op_instruction->base.scope,
-                bin_op_instruction->base.source_node, is_non_null);
-            result->value.type = ira->codegen->builtin_types.entry_bool;
-            return result;
-        } else {
-            return is_non_null;
-        }
-    } else if (is_equality_cmp &&
-        ((op1->value.type->id == ZigTypeIdNull && op2->value.type->id == ZigTypeIdPointer &&
-            op2->value.type->data.pointer.ptr_len == PtrLenC) ||
-        (op2->value.type->id == ZigTypeIdNull && op1->value.type->id == ZigTypeIdPointer &&
-            op1->value.type->data.pointer.ptr_len == PtrLenC)))
-    {
-        IrInstruction *c_ptr_op;
-        if (op1->value.type->id == ZigTypeIdNull) {
-            c_ptr_op = op2;
-        } else if (op2->value.type->id == ZigTypeIdNull) {
-            c_ptr_op = op1;
-        } else {
-            zig_unreachable();
-        }
-        if (instr_is_comptime(c_ptr_op)) {
-            ConstExprValue *c_ptr_val = ir_resolve_const(ira, c_ptr_op, UndefOk);
-            if (!c_ptr_val)
+            IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1, result_loc);
+            if (type_is_invalid(cast2->value->type))
                 return ira->codegen->invalid_instruction;
-            if (c_ptr_val->special == ConstValSpecialUndef)
-                return ir_const_undef(ira, &bin_op_instruction->base, ira->codegen->builtin_types.entry_bool);
-            bool is_null = c_ptr_val->data.x_ptr.special == ConstPtrSpecialNull ||
-                (c_ptr_val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr &&
-                    c_ptr_val->data.x_ptr.data.hard_coded_addr.addr == 0);
-            bool bool_result = (op_id == IrBinOpCmpEq) ? is_null : !is_null;
-            return ir_const_bool(ira, &bin_op_instruction->base, bool_result);
-        }
-        IrInstruction *is_non_null = ir_build_test_nonnull(&ira->new_irb, bin_op_instruction->base.scope,
-            source_node, c_ptr_op);
-        is_non_null->value.type = ira->codegen->builtin_types.entry_bool;
 
-        if (op_id == IrBinOpCmpEq) {
-            IrInstruction *result = ir_build_bool_not(&ira->new_irb, bin_op_instruction->base.scope,
-                bin_op_instruction->base.source_node, is_non_null);
-            result->value.type = ira->codegen->builtin_types.entry_bool;
-            return result;
-        } else {
-            return is_non_null;
+            return cast2;
         }
-    } else if (op1->value.type->id == ZigTypeIdNull || op2->value.type->id == ZigTypeIdNull) {
-        ZigType *non_null_type = (op1->value.type->id == ZigTypeIdNull) ? op2->value.type : op1->value.type;
-        ir_add_error_node(ira, source_node, buf_sprintf("comparison of '%s' with null",
-            buf_ptr(&non_null_type->name)));
-        return ira->codegen->invalid_instruction;
     }
 
-    if (op1->value.type->id == ZigTypeIdErrorSet && op2->value.type->id == ZigTypeIdErrorSet) {
-        if (!is_equality_cmp) {
-            ir_add_error_node(ira, source_node, buf_sprintf("operator not allowed for errors"));
-            return ira->codegen->invalid_instruction;
-        }
-        ZigType *intersect_type = get_error_set_intersection(ira, op1->value.type, op2->value.type, source_node);
-        if (type_is_invalid(intersect_type)) {
-            return ira->codegen->invalid_instruction;
-        }
-
-        if (!resolve_inferred_error_set(ira->codegen, intersect_type, source_node)) {
-            return ira->codegen->invalid_instruction;
-        }
 
-        // exception if one of the operators has the type of the empty error set, we allow the comparison
-        // (and make it comptime known)
-        // this is a function which is evaluated at comptime and returns an inferred error set will have an empty
-        // error set.
-        if (op1->value.type->data.error_set.err_count == 0 || op2->value.type->data.error_set.err_count == 0) {
-            bool are_equal = false;
-            bool answer;
-            if (op_id == IrBinOpCmpEq) {
-                answer = are_equal;
-            } else if (op_id == IrBinOpCmpNotEq) {
-                answer = !are_equal;
-            } else {
-                zig_unreachable();
-            }
-            return ir_const_bool(ira, &bin_op_instruction->base, answer);
+    // cast from comptime-known number to another number type
+    if (instr_is_comptime(value) &&
+        (actual_type->id == ZigTypeIdInt || actual_type->id == ZigTypeIdComptimeInt ||
+        actual_type->id == ZigTypeIdFloat || actual_type->id == ZigTypeIdComptimeFloat) &&
+        (wanted_type->id == ZigTypeIdInt || wanted_type->id == ZigTypeIdComptimeInt ||
+        wanted_type->id == ZigTypeIdFloat || wanted_type->id == ZigTypeIdComptimeFloat))
+    {
+        if (value->value->special == ConstValSpecialUndef) {
+            IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+            result->value->special = ConstValSpecialUndef;
+            return result;
         }
-
-        if (!type_is_global_error_set(intersect_type)) {
-            if (intersect_type->data.error_set.err_count == 0) {
-                ir_add_error_node(ira, source_node,
-                    buf_sprintf("error sets '%s' and '%s' have no common errors",
-                        buf_ptr(&op1->value.type->name), buf_ptr(&op2->value.type->name)));
-                return ira->codegen->invalid_instruction;
-            }
-            if (op1->value.type->data.error_set.err_count == 1 && op2->value.type->data.error_set.err_count == 1) {
-                bool are_equal = true;
-                bool answer;
-                if (op_id == IrBinOpCmpEq) {
-                    answer = are_equal;
-                } else if (op_id == IrBinOpCmpNotEq) {
-                    answer = !are_equal;
+        if (ir_num_lit_fits_in_other_type(ira, value, wanted_type, true)) {
+            if (wanted_type->id == ZigTypeIdComptimeInt || wanted_type->id == ZigTypeIdInt) {
+                IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+                if (actual_type->id == ZigTypeIdComptimeInt || actual_type->id == ZigTypeIdInt) {
+                    bigint_init_bigint(&result->value->data.x_bigint, &value->value->data.x_bigint);
                 } else {
-                    zig_unreachable();
+                    float_init_bigint(&result->value->data.x_bigint, value->value);
                 }
-                return ir_const_bool(ira, &bin_op_instruction->base, answer);
+                return result;
+            } else if (wanted_type->id == ZigTypeIdComptimeFloat || wanted_type->id == ZigTypeIdFloat) {
+                IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+                if (actual_type->id == ZigTypeIdComptimeInt || actual_type->id == ZigTypeIdInt) {
+                    BigFloat bf;
+                    bigfloat_init_bigint(&bf, &value->value->data.x_bigint);
+                    float_init_bigfloat(result->value, &bf);
+                } else {
+                    float_init_float(result->value, value->value);
+                }
+                return result;
             }
+            zig_unreachable();
+        } else {
+            return ira->codegen->invalid_instruction;
         }
+    }
 
-        if (instr_is_comptime(op1) && instr_is_comptime(op2)) {
-            ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
-            if (op1_val == nullptr)
+    // widening conversion
+    if (wanted_type->id == ZigTypeIdInt &&
+        actual_type->id == ZigTypeIdInt &&
+        wanted_type->data.integral.is_signed == actual_type->data.integral.is_signed &&
+        wanted_type->data.integral.bit_count >= actual_type->data.integral.bit_count)
+    {
+        return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
+    }
+
+    // small enough unsigned ints can get casted to large enough signed ints
+    if (wanted_type->id == ZigTypeIdInt && wanted_type->data.integral.is_signed &&
+        actual_type->id == ZigTypeIdInt && !actual_type->data.integral.is_signed &&
+        wanted_type->data.integral.bit_count > actual_type->data.integral.bit_count)
+    {
+        return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
+    }
+
+    // float widening conversion
+    if (wanted_type->id == ZigTypeIdFloat &&
+        actual_type->id == ZigTypeIdFloat &&
+        wanted_type->data.floating.bit_count >= actual_type->data.floating.bit_count)
+    {
+        return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
+    }
+
+    // widening of vectors
+    // These are separate (while identical) as I am still not sure if this should not implicitely cast,
+    // but only explicitely cast. (i.e. with @cast, or @as, or @Vector(4, i32)(foo)),
+    // as they are more expensive than scalar zext/sext/fext operations.
+    if (wanted_is_vector &&
+        actual_is_vector) {
+        if (wanted_scalar_type->id == ZigTypeIdInt &&
+            actual_scalar_type->id == ZigTypeIdInt) {
+            if (wanted_scalar_type->data.integral.is_signed == actual_scalar_type->data.integral.is_signed &&
+                wanted_scalar_type->data.integral.bit_count >= actual_scalar_type->data.integral.bit_count) {
+                return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
+            }
+            if (wanted_scalar_type->data.integral.is_signed &&
+                !actual_scalar_type->data.integral.is_signed &&
+                wanted_scalar_type->data.integral.bit_count > actual_scalar_type->data.integral.bit_count) {
+                return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
+            }
+        }
+        if (wanted_scalar_type->id == ZigTypeIdFloat &&
+            actual_scalar_type->id == ZigTypeIdFloat &&
+            wanted_scalar_type->data.floating.bit_count >= actual_scalar_type->data.floating.bit_count) {
+            return ir_analyze_widen_or_shorten(ira, source_instr, value, wanted_type);
+        }
+    }
+
+    // cast from [N]T to []const T
+    // TODO: once https://github.com/ziglang/zig/issues/265 lands, remove this
+    if (is_slice(wanted_type) && actual_type->id == ZigTypeIdArray) {
+        ZigType *ptr_type = wanted_type->data.structure.fields[slice_ptr_index].type_entry;
+        assert(ptr_type->id == ZigTypeIdPointer);
+        if ((ptr_type->data.pointer.is_const || actual_type->data.array.len == 0) &&
+            types_match_const_cast_only(ira, ptr_type->data.pointer.child_type, actual_type->data.array.child_type,
+                source_node, false).id == ConstCastResultIdOk)
+        {
+            return ir_analyze_array_to_slice(ira, source_instr, value, wanted_type, result_loc);
+        }
+    }
+
+    // cast from [N]T to ?[]const T
+    // TODO: once https://github.com/ziglang/zig/issues/265 lands, remove this
+    if (wanted_type->id == ZigTypeIdOptional &&
+        is_slice(wanted_type->data.maybe.child_type) &&
+        actual_type->id == ZigTypeIdArray)
+    {
+        ZigType *ptr_type =
+            wanted_type->data.maybe.child_type->data.structure.fields[slice_ptr_index].type_entry;
+        assert(ptr_type->id == ZigTypeIdPointer);
+        if ((ptr_type->data.pointer.is_const || actual_type->data.array.len == 0) &&
+            types_match_const_cast_only(ira, ptr_type->data.pointer.child_type, actual_type->data.array.child_type,
+                source_node, false).id == ConstCastResultIdOk)
+        {
+            IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.maybe.child_type, value, nullptr);
+            if (type_is_invalid(cast1->value->type))
                 return ira->codegen->invalid_instruction;
-            ConstExprValue *op2_val = ir_resolve_const(ira, op2, UndefBad);
-            if (op2_val == nullptr)
+
+            IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1, result_loc);
+            if (type_is_invalid(cast2->value->type))
                 return ira->codegen->invalid_instruction;
 
-            bool answer;
-            bool are_equal = op1_val->data.x_err_set->value == op2_val->data.x_err_set->value;
-            if (op_id == IrBinOpCmpEq) {
-                answer = are_equal;
-            } else if (op_id == IrBinOpCmpNotEq) {
-                answer = !are_equal;
-            } else {
-                zig_unreachable();
-            }
+            return cast2;
+        }
+    }
 
-            return ir_const_bool(ira, &bin_op_instruction->base, answer);
+    // *[N]T to [*]T and [*c]T
+    if (wanted_type->id == ZigTypeIdPointer &&
+        (wanted_type->data.pointer.ptr_len == PtrLenUnknown || wanted_type->data.pointer.ptr_len == PtrLenC) &&
+        actual_type->id == ZigTypeIdPointer &&
+        actual_type->data.pointer.ptr_len == PtrLenSingle &&
+        actual_type->data.pointer.child_type->id == ZigTypeIdArray)
+    {
+        if ((err = type_resolve(ira->codegen, actual_type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
+            return ira->codegen->invalid_instruction;
+        if ((err = type_resolve(ira->codegen, wanted_type->data.pointer.child_type, ResolveStatusAlignmentKnown)))
+            return ira->codegen->invalid_instruction;
+        if (get_ptr_align(ira->codegen, actual_type) >= get_ptr_align(ira->codegen, wanted_type) &&
+            types_match_const_cast_only(ira, wanted_type->data.pointer.child_type,
+                actual_type->data.pointer.child_type->data.array.child_type, source_node,
+                !wanted_type->data.pointer.is_const).id == ConstCastResultIdOk)
+        {
+            return ir_resolve_ptr_of_array_to_unknown_len_ptr(ira, source_instr, value, wanted_type);
         }
+    }
 
-        IrInstruction *result = ir_build_bin_op(&ira->new_irb,
-                bin_op_instruction->base.scope, bin_op_instruction->base.source_node,
-                op_id, op1, op2, bin_op_instruction->safety_check_on);
-        result->value.type = ira->codegen->builtin_types.entry_bool;
-        return result;
+    // *[N]T to []T
+    if (is_slice(wanted_type) &&
+        actual_type->id == ZigTypeIdPointer &&
+        actual_type->data.pointer.ptr_len == PtrLenSingle &&
+        actual_type->data.pointer.child_type->id == ZigTypeIdArray)
+    {
+        ZigType *slice_ptr_type = wanted_type->data.structure.fields[slice_ptr_index].type_entry;
+        assert(slice_ptr_type->id == ZigTypeIdPointer);
+        ZigType *array_type = actual_type->data.pointer.child_type;
+        bool const_ok = (slice_ptr_type->data.pointer.is_const || array_type->data.array.len == 0
+                || !actual_type->data.pointer.is_const);
+        if (const_ok && types_match_const_cast_only(ira, slice_ptr_type->data.pointer.child_type,
+            array_type->data.array.child_type, source_node,
+            !slice_ptr_type->data.pointer.is_const).id == ConstCastResultIdOk)
+        {
+            return ir_resolve_ptr_of_array_to_slice(ira, source_instr, value, wanted_type, result_loc);
+        }
     }
 
-    IrInstruction *instructions[] = {op1, op2};
-    ZigType *resolved_type = ir_resolve_peer_types(ira, source_node, nullptr, instructions, 2);
-    if (type_is_invalid(resolved_type))
-        return ira->codegen->invalid_instruction;
 
-    bool operator_allowed;
-    switch (resolved_type->id) {
-        case ZigTypeIdInvalid:
-            zig_unreachable(); // handled above
+    // cast from null literal to maybe type
+    if (wanted_type->id == ZigTypeIdOptional &&
+        actual_type->id == ZigTypeIdNull)
+    {
+        return ir_analyze_null_to_maybe(ira, source_instr, value, wanted_type);
+    }
 
-        case ZigTypeIdComptimeFloat:
-        case ZigTypeIdComptimeInt:
-        case ZigTypeIdInt:
-        case ZigTypeIdFloat:
-        case ZigTypeIdVector:
-            operator_allowed = true;
-            break;
+    // cast from null literal to C pointer
+    if (wanted_type->id == ZigTypeIdPointer && wanted_type->data.pointer.ptr_len == PtrLenC &&
+        actual_type->id == ZigTypeIdNull)
+    {
+        return ir_analyze_null_to_c_pointer(ira, source_instr, value, wanted_type);
+    }
 
-        case ZigTypeIdBool:
-        case ZigTypeIdMetaType:
-        case ZigTypeIdVoid:
-        case ZigTypeIdErrorSet:
-        case ZigTypeIdFn:
-        case ZigTypeIdOpaque:
-        case ZigTypeIdBoundFn:
-        case ZigTypeIdArgTuple:
-        case ZigTypeIdPromise:
-        case ZigTypeIdEnum:
-        case ZigTypeIdEnumLiteral:
-            operator_allowed = is_equality_cmp;
-            break;
+    // cast from [N]T to E![]const T
+    if (wanted_type->id == ZigTypeIdErrorUnion &&
+        is_slice(wanted_type->data.error_union.payload_type) &&
+        actual_type->id == ZigTypeIdArray)
+    {
+        ZigType *ptr_type =
+            wanted_type->data.error_union.payload_type->data.structure.fields[slice_ptr_index].type_entry;
+        assert(ptr_type->id == ZigTypeIdPointer);
+        if ((ptr_type->data.pointer.is_const || actual_type->data.array.len == 0) &&
+            types_match_const_cast_only(ira, ptr_type->data.pointer.child_type, actual_type->data.array.child_type,
+                source_node, false).id == ConstCastResultIdOk)
+        {
+            IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.error_union.payload_type, value, nullptr);
+            if (type_is_invalid(cast1->value->type))
+                return ira->codegen->invalid_instruction;
 
-        case ZigTypeIdPointer:
-            operator_allowed = is_equality_cmp || (resolved_type->data.pointer.ptr_len == PtrLenC);
-            break;
+            IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1, result_loc);
+            if (type_is_invalid(cast2->value->type))
+                return ira->codegen->invalid_instruction;
 
-        case ZigTypeIdUnreachable:
-        case ZigTypeIdArray:
-        case ZigTypeIdStruct:
-        case ZigTypeIdUndefined:
-        case ZigTypeIdNull:
-        case ZigTypeIdErrorUnion:
-        case ZigTypeIdUnion:
-            operator_allowed = false;
-            break;
-        case ZigTypeIdOptional:
-            operator_allowed = is_equality_cmp && get_codegen_ptr_type(resolved_type) != nullptr;
-            break;
+            return cast2;
+        }
     }
-    if (!operator_allowed) {
-        ir_add_error_node(ira, source_node,
-            buf_sprintf("operator not allowed for type '%s'", buf_ptr(&resolved_type->name)));
-        return ira->codegen->invalid_instruction;
+
+    // cast from E to E!T
+    if (wanted_type->id == ZigTypeIdErrorUnion &&
+        actual_type->id == ZigTypeIdErrorSet)
+    {
+        return ir_analyze_err_wrap_code(ira, source_instr, value, wanted_type, result_loc);
     }
 
-    IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, resolved_type);
-    if (casted_op1 == ira->codegen->invalid_instruction)
-        return ira->codegen->invalid_instruction;
+    // cast from typed number to integer or float literal.
+    // works when the number is known at compile time
+    if (instr_is_comptime(value) &&
+        ((actual_type->id == ZigTypeIdInt && wanted_type->id == ZigTypeIdComptimeInt) ||
+        (actual_type->id == ZigTypeIdFloat && wanted_type->id == ZigTypeIdComptimeFloat)))
+    {
+        return ir_analyze_number_to_literal(ira, source_instr, value, wanted_type);
+    }
 
-    IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, resolved_type);
-    if (casted_op2 == ira->codegen->invalid_instruction)
-        return ira->codegen->invalid_instruction;
+    // cast from enum literal to enum with matching field name
+    if (actual_type->id == ZigTypeIdEnumLiteral && wanted_type->id == ZigTypeIdEnum) {
+        if ((err = type_resolve(ira->codegen, wanted_type, ResolveStatusZeroBitsKnown)))
+            return ira->codegen->invalid_instruction;
 
-    bool one_possible_value;
-    switch (type_has_one_possible_value(ira->codegen, resolved_type)) {
-        case OnePossibleValueInvalid:
+        TypeEnumField *field = find_enum_type_field(wanted_type, value->value->data.x_enum_literal);
+        if (field == nullptr) {
+            ErrorMsg *msg = ir_add_error(ira, source_instr, buf_sprintf("enum '%s' has no field named '%s'",
+                    buf_ptr(&wanted_type->name), buf_ptr(value->value->data.x_enum_literal)));
+            add_error_note(ira->codegen, msg, wanted_type->data.enumeration.decl_node,
+                    buf_sprintf("'%s' declared here", buf_ptr(&wanted_type->name)));
             return ira->codegen->invalid_instruction;
-        case OnePossibleValueYes:
-            one_possible_value = true;
-            break;
-        case OnePossibleValueNo:
-            one_possible_value = false;
-            break;
+        }
+        IrInstruction *result = ir_const(ira, source_instr, wanted_type);
+        bigint_init_bigint(&result->value->data.x_enum_tag, &field->value);
+        return result;
     }
 
-    if (one_possible_value || (instr_is_comptime(casted_op1) && instr_is_comptime(casted_op2))) {
-        ConstExprValue *op1_val = one_possible_value ? &casted_op1->value : ir_resolve_const(ira, casted_op1, UndefBad);
-        if (op1_val == nullptr)
-            return ira->codegen->invalid_instruction;
-        ConstExprValue *op2_val = one_possible_value ? &casted_op2->value : ir_resolve_const(ira, casted_op2, UndefBad);
-        if (op2_val == nullptr)
+    // cast from union to the enum type of the union
+    if (actual_type->id == ZigTypeIdUnion && wanted_type->id == ZigTypeIdEnum) {
+        if ((err = type_resolve(ira->codegen, actual_type, ResolveStatusZeroBitsKnown)))
             return ira->codegen->invalid_instruction;
 
-        if (resolved_type->id == ZigTypeIdComptimeFloat || resolved_type->id == ZigTypeIdFloat) {
-            if (float_is_nan(op1_val) || float_is_nan(op2_val)) {
-                return ir_const_bool(ira, &bin_op_instruction->base, op_id == IrBinOpCmpNotEq);
+        if (actual_type->data.unionation.tag_type == wanted_type) {
+            return ir_analyze_union_to_tag(ira, source_instr, value, wanted_type);
+        }
+    }
+
+    // enum to union which has the enum as the tag type, or
+    // enum literal to union which has a matching enum as the tag type
+    if (is_tagged_union(wanted_type) && (actual_type->id == ZigTypeIdEnum ||
+                actual_type->id == ZigTypeIdEnumLiteral))
+    {
+        return ir_analyze_enum_to_union(ira, source_instr, value, wanted_type);
+    }
+
+    // cast from *T to *[1]T
+    if (wanted_type->id == ZigTypeIdPointer && wanted_type->data.pointer.ptr_len == PtrLenSingle &&
+        actual_type->id == ZigTypeIdPointer && actual_type->data.pointer.ptr_len == PtrLenSingle)
+    {
+        ZigType *array_type = wanted_type->data.pointer.child_type;
+        if (array_type->id == ZigTypeIdArray && array_type->data.array.len == 1 &&
+            types_match_const_cast_only(ira, array_type->data.array.child_type,
+            actual_type->data.pointer.child_type, source_node,
+            !wanted_type->data.pointer.is_const).id == ConstCastResultIdOk &&
+            // This should be the job of `types_match_const_cast_only`
+            // but `types_match_const_cast_only` only gets info for child_types
+            ((wanted_type->data.pointer.is_const && actual_type->data.pointer.is_const) ||
+            !actual_type->data.pointer.is_const))
+        {
+            if ((err = type_resolve(ira->codegen, wanted_type->data.pointer.child_type,
+                            ResolveStatusAlignmentKnown)))
+            {
+                return ira->codegen->invalid_instruction;
             }
-            Cmp cmp_result = float_cmp(op1_val, op2_val);
-            bool answer = resolve_cmp_op_id(op_id, cmp_result);
-            return ir_const_bool(ira, &bin_op_instruction->base, answer);
-        } else if (resolved_type->id == ZigTypeIdComptimeInt || resolved_type->id == ZigTypeIdInt) {
-            Cmp cmp_result = bigint_cmp(&op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            bool answer = resolve_cmp_op_id(op_id, cmp_result);
-            return ir_const_bool(ira, &bin_op_instruction->base, answer);
-        } else if (resolved_type->id == ZigTypeIdPointer && op_id != IrBinOpCmpEq && op_id != IrBinOpCmpNotEq) {
-            if ((op1_val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr ||
-                    op1_val->data.x_ptr.special == ConstPtrSpecialNull) &&
-                (op2_val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr ||
-                    op2_val->data.x_ptr.special == ConstPtrSpecialNull))
+            if ((err = type_resolve(ira->codegen, actual_type->data.pointer.child_type,
+                            ResolveStatusAlignmentKnown)))
             {
-                uint64_t op1_addr = op1_val->data.x_ptr.special == ConstPtrSpecialNull ?
-                    0 : op1_val->data.x_ptr.data.hard_coded_addr.addr;
-                uint64_t op2_addr = op2_val->data.x_ptr.special == ConstPtrSpecialNull ?
-                    0 : op2_val->data.x_ptr.data.hard_coded_addr.addr;
-                Cmp cmp_result;
-                if (op1_addr > op2_addr) {
-                    cmp_result = CmpGT;
-                } else if (op1_addr < op2_addr) {
-                    cmp_result = CmpLT;
-                } else {
-                    cmp_result = CmpEQ;
-                }
-                bool answer = resolve_cmp_op_id(op_id, cmp_result);
-                return ir_const_bool(ira, &bin_op_instruction->base, answer);
+                return ira->codegen->invalid_instruction;
             }
-        } else {
-            bool are_equal = one_possible_value || const_values_equal(ira->codegen, op1_val, op2_val);
-            bool answer;
-            if (op_id == IrBinOpCmpEq) {
-                answer = are_equal;
-            } else if (op_id == IrBinOpCmpNotEq) {
-                answer = !are_equal;
-            } else {
-                zig_unreachable();
+            uint32_t wanted_align = get_ptr_align(ira->codegen, wanted_type);
+            uint32_t actual_align = get_ptr_align(ira->codegen, actual_type);
+            if (wanted_align > actual_align) {
+                ErrorMsg *msg = ir_add_error(ira, source_instr, buf_sprintf("cast increases pointer alignment"));
+                add_error_note(ira->codegen, msg, value->source_node,
+                        buf_sprintf("'%s' has alignment %" PRIu32, buf_ptr(&actual_type->name), actual_align));
+                add_error_note(ira->codegen, msg, source_instr->source_node,
+                        buf_sprintf("'%s' has alignment %" PRIu32, buf_ptr(&wanted_type->name), wanted_align));
+                return ira->codegen->invalid_instruction;
             }
-            return ir_const_bool(ira, &bin_op_instruction->base, answer);
+            return ir_analyze_ptr_to_array(ira, source_instr, value, wanted_type);
         }
     }
 
-    // some comparisons with unsigned numbers can be evaluated
-    if (resolved_type->id == ZigTypeIdInt && !resolved_type->data.integral.is_signed) {
-        ConstExprValue *known_left_val;
-        IrBinOp flipped_op_id;
-        if (instr_is_comptime(casted_op1)) {
-            known_left_val = ir_resolve_const(ira, casted_op1, UndefBad);
-            if (known_left_val == nullptr)
-                return ira->codegen->invalid_instruction;
-
-            flipped_op_id = op_id;
-        } else if (instr_is_comptime(casted_op2)) {
-            known_left_val = ir_resolve_const(ira, casted_op2, UndefBad);
-            if (known_left_val == nullptr)
-                return ira->codegen->invalid_instruction;
+    // cast from *T and [*]T to *c_void and ?*c_void
+    // but don't do it if the actual type is a double pointer
+    if (is_pointery_and_elem_is_not_pointery(actual_type)) {
+        ZigType *dest_ptr_type = nullptr;
+        if (wanted_type->id == ZigTypeIdPointer &&
+            wanted_type->data.pointer.child_type == ira->codegen->builtin_types.entry_c_void)
+        {
+            dest_ptr_type = wanted_type;
+        } else if (wanted_type->id == ZigTypeIdOptional &&
+            wanted_type->data.maybe.child_type->id == ZigTypeIdPointer &&
+            wanted_type->data.maybe.child_type->data.pointer.child_type == ira->codegen->builtin_types.entry_c_void)
+        {
+            dest_ptr_type = wanted_type->data.maybe.child_type;
+        }
+        if (dest_ptr_type != nullptr) {
+            return ir_analyze_ptr_cast(ira, source_instr, value, wanted_type, source_instr, true);
+        }
+    }
 
-            if (op_id == IrBinOpCmpLessThan) {
-                flipped_op_id = IrBinOpCmpGreaterThan;
-            } else if (op_id == IrBinOpCmpGreaterThan) {
-                flipped_op_id = IrBinOpCmpLessThan;
-            } else if (op_id == IrBinOpCmpLessOrEq) {
-                flipped_op_id = IrBinOpCmpGreaterOrEq;
-            } else if (op_id == IrBinOpCmpGreaterOrEq) {
-                flipped_op_id = IrBinOpCmpLessOrEq;
-            } else {
-                flipped_op_id = op_id;
-            }
-        } else {
-            known_left_val = nullptr;
+    // cast from T to *T where T is zero bits
+    if (wanted_type->id == ZigTypeIdPointer && wanted_type->data.pointer.ptr_len == PtrLenSingle &&
+        types_match_const_cast_only(ira, wanted_type->data.pointer.child_type,
+            actual_type, source_node, !wanted_type->data.pointer.is_const).id == ConstCastResultIdOk)
+    {
+        if ((err = type_resolve(ira->codegen, actual_type, ResolveStatusZeroBitsKnown))) {
+            return ira->codegen->invalid_instruction;
         }
-        if (known_left_val != nullptr && bigint_cmp_zero(&known_left_val->data.x_bigint) == CmpEQ &&
-            (flipped_op_id == IrBinOpCmpLessOrEq || flipped_op_id == IrBinOpCmpGreaterThan))
-        {
-            bool answer = (flipped_op_id == IrBinOpCmpLessOrEq);
-            return ir_const_bool(ira, &bin_op_instruction->base, answer);
+        if (!type_has_bits(actual_type)) {
+            return ir_get_ref(ira, source_instr, value, false, false);
         }
     }
 
-    IrInstruction *result = ir_build_bin_op(&ira->new_irb,
-            bin_op_instruction->base.scope, bin_op_instruction->base.source_node,
-            op_id, casted_op1, casted_op2, bin_op_instruction->safety_check_on);
-    result->value.type = ira->codegen->builtin_types.entry_bool;
-    return result;
-}
+    // cast from @Vector(N, T) to [N]T
+    if (wanted_type->id == ZigTypeIdArray && actual_type->id == ZigTypeIdVector &&
+        wanted_type->data.array.len == actual_type->data.vector.len &&
+        types_match_const_cast_only(ira, wanted_type->data.array.child_type,
+            actual_type->data.vector.elem_type, source_node, false).id == ConstCastResultIdOk)
+    {
+        return ir_analyze_vector_to_array(ira, source_instr, value, wanted_type, result_loc);
+    }
 
-static ErrorMsg *ir_eval_math_op_scalar(IrAnalyze *ira, IrInstruction *source_instr, ZigType *type_entry,
-        ConstExprValue *op1_val, IrBinOp op_id, ConstExprValue *op2_val, ConstExprValue *out_val)
-{
-    bool is_int;
-    bool is_float;
-    Cmp op2_zcmp;
-    if (type_entry->id == ZigTypeIdInt || type_entry->id == ZigTypeIdComptimeInt) {
-        is_int = true;
-        is_float = false;
-        op2_zcmp = bigint_cmp_zero(&op2_val->data.x_bigint);
-    } else if (type_entry->id == ZigTypeIdFloat ||
-                type_entry->id == ZigTypeIdComptimeFloat)
+    // cast from [N]T to @Vector(N, T)
+    if (actual_type->id == ZigTypeIdArray && wanted_type->id == ZigTypeIdVector &&
+        actual_type->data.array.len == wanted_type->data.vector.len &&
+        types_match_const_cast_only(ira, actual_type->data.array.child_type,
+            wanted_type->data.vector.elem_type, source_node, false).id == ConstCastResultIdOk)
     {
-        is_int = false;
-        is_float = true;
-        op2_zcmp = float_cmp_zero(op2_val);
-    } else {
-        zig_unreachable();
+        return ir_analyze_array_to_vector(ira, source_instr, value, wanted_type);
     }
 
-    if ((op_id == IrBinOpDivUnspecified || op_id == IrBinOpRemRem || op_id == IrBinOpRemMod ||
-        op_id == IrBinOpDivTrunc || op_id == IrBinOpDivFloor) && op2_zcmp == CmpEQ)
+    // casting between C pointers and normal pointers
+    if (wanted_type->id == ZigTypeIdPointer && actual_type->id == ZigTypeIdPointer &&
+        (wanted_type->data.pointer.ptr_len == PtrLenC || actual_type->data.pointer.ptr_len == PtrLenC) &&
+        types_match_const_cast_only(ira, wanted_type->data.pointer.child_type,
+            actual_type->data.pointer.child_type, source_node,
+            !wanted_type->data.pointer.is_const).id == ConstCastResultIdOk)
     {
-        return ir_add_error(ira, source_instr, buf_sprintf("division by zero"));
+        return ir_analyze_ptr_cast(ira, source_instr, value, wanted_type, source_instr, true);
     }
-    if ((op_id == IrBinOpRemRem || op_id == IrBinOpRemMod) && op2_zcmp == CmpLT) {
-        return ir_add_error(ira, source_instr, buf_sprintf("negative denominator"));
+
+    // cast from integer to C pointer
+    if (wanted_type->id == ZigTypeIdPointer && wanted_type->data.pointer.ptr_len == PtrLenC &&
+        (actual_type->id == ZigTypeIdInt || actual_type->id == ZigTypeIdComptimeInt))
+    {
+        return ir_analyze_int_to_c_ptr(ira, source_instr, value, wanted_type);
     }
 
-    switch (op_id) {
-        case IrBinOpInvalid:
-        case IrBinOpBoolOr:
-        case IrBinOpBoolAnd:
-        case IrBinOpCmpEq:
-        case IrBinOpCmpNotEq:
-        case IrBinOpCmpLessThan:
-        case IrBinOpCmpGreaterThan:
-        case IrBinOpCmpLessOrEq:
-        case IrBinOpCmpGreaterOrEq:
-        case IrBinOpArrayCat:
-        case IrBinOpArrayMult:
-        case IrBinOpRemUnspecified:
-        case IrBinOpMergeErrorSets:
-            zig_unreachable();
-        case IrBinOpBinOr:
-            assert(is_int);
-            bigint_or(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            break;
-        case IrBinOpBinXor:
-            assert(is_int);
-            bigint_xor(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            break;
-        case IrBinOpBinAnd:
-            assert(is_int);
-            bigint_and(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            break;
-        case IrBinOpBitShiftLeftExact:
-            assert(is_int);
-            bigint_shl(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            break;
-        case IrBinOpBitShiftLeftLossy:
-            assert(type_entry->id == ZigTypeIdInt);
-            bigint_shl_trunc(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint,
-                    type_entry->data.integral.bit_count, type_entry->data.integral.is_signed);
-            break;
-        case IrBinOpBitShiftRightExact:
-            {
-                assert(is_int);
-                bigint_shr(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-                BigInt orig_bigint;
-                bigint_shl(&orig_bigint, &out_val->data.x_bigint, &op2_val->data.x_bigint);
-                if (bigint_cmp(&op1_val->data.x_bigint, &orig_bigint) != CmpEQ) {
-                    return ir_add_error(ira, source_instr, buf_sprintf("exact shift shifted out 1 bits"));
-                }
-                break;
-            }
-        case IrBinOpBitShiftRightLossy:
-            assert(is_int);
-            bigint_shr(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            break;
-        case IrBinOpAdd:
-            if (is_int) {
-                bigint_add(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            } else {
-                float_add(out_val, op1_val, op2_val);
-            }
-            break;
-        case IrBinOpAddWrap:
-            assert(type_entry->id == ZigTypeIdInt);
-            bigint_add_wrap(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint,
-                    type_entry->data.integral.bit_count, type_entry->data.integral.is_signed);
-            break;
-        case IrBinOpSub:
-            if (is_int) {
-                bigint_sub(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            } else {
-                float_sub(out_val, op1_val, op2_val);
-            }
-            break;
-        case IrBinOpSubWrap:
-            assert(type_entry->id == ZigTypeIdInt);
-            bigint_sub_wrap(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint,
-                    type_entry->data.integral.bit_count, type_entry->data.integral.is_signed);
-            break;
-        case IrBinOpMult:
-            if (is_int) {
-                bigint_mul(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            } else {
-                float_mul(out_val, op1_val, op2_val);
-            }
-            break;
-        case IrBinOpMultWrap:
-            assert(type_entry->id == ZigTypeIdInt);
-            bigint_mul_wrap(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint,
-                    type_entry->data.integral.bit_count, type_entry->data.integral.is_signed);
-            break;
-        case IrBinOpDivUnspecified:
-            assert(is_float);
-            float_div(out_val, op1_val, op2_val);
-            break;
-        case IrBinOpDivTrunc:
-            if (is_int) {
-                bigint_div_trunc(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            } else {
-                float_div_trunc(out_val, op1_val, op2_val);
-            }
-            break;
-        case IrBinOpDivFloor:
-            if (is_int) {
-                bigint_div_floor(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            } else {
-                float_div_floor(out_val, op1_val, op2_val);
-            }
-            break;
-        case IrBinOpDivExact:
-            if (is_int) {
-                bigint_div_trunc(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-                BigInt remainder;
-                bigint_rem(&remainder, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-                if (bigint_cmp_zero(&remainder) != CmpEQ) {
-                    return ir_add_error(ira, source_instr, buf_sprintf("exact division had a remainder"));
-                }
-            } else {
-                float_div_trunc(out_val, op1_val, op2_val);
-                ConstExprValue remainder = {};
-                float_rem(&remainder, op1_val, op2_val);
-                if (float_cmp_zero(&remainder) != CmpEQ) {
-                    return ir_add_error(ira, source_instr, buf_sprintf("exact division had a remainder"));
-                }
-            }
-            break;
-        case IrBinOpRemRem:
-            if (is_int) {
-                bigint_rem(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            } else {
-                float_rem(out_val, op1_val, op2_val);
-            }
-            break;
-        case IrBinOpRemMod:
-            if (is_int) {
-                bigint_mod(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            } else {
-                float_mod(out_val, op1_val, op2_val);
-            }
-            break;
-    }
-
-    if (type_entry->id == ZigTypeIdInt) {
-        if (!bigint_fits_in_bits(&out_val->data.x_bigint, type_entry->data.integral.bit_count,
-                type_entry->data.integral.is_signed))
-        {
-            return ir_add_error(ira, source_instr, buf_sprintf("operation caused overflow"));
-        }
+    // cast from undefined to anything
+    if (actual_type->id == ZigTypeIdUndefined) {
+        return ir_analyze_undefined_to_anything(ira, source_instr, value, wanted_type);
     }
 
-    out_val->type = type_entry;
-    out_val->special = ConstValSpecialStatic;
-    return nullptr;
+    ErrorMsg *parent_msg = ir_add_error_node(ira, source_instr->source_node,
+        buf_sprintf("expected type '%s', found '%s'",
+            buf_ptr(&wanted_type->name),
+            buf_ptr(&actual_type->name)));
+    report_recursive_error(ira, source_instr->source_node, &const_cast_result, parent_msg);
+    return ira->codegen->invalid_instruction;
 }
 
-// This works on operands that have already been checked to be comptime known.
-static IrInstruction *ir_analyze_math_op(IrAnalyze *ira, IrInstruction *source_instr,
-        ZigType *type_entry, ConstExprValue *op1_val, IrBinOp op_id, ConstExprValue *op2_val)
+static IrInstruction *ir_implicit_cast_with_result(IrAnalyze *ira, IrInstruction *value, ZigType *expected_type,
+        ResultLoc *result_loc)
 {
-    IrInstruction *result_instruction = ir_const(ira, source_instr, type_entry);
-    ConstExprValue *out_val = &result_instruction->value;
-    if (type_entry->id == ZigTypeIdVector) {
-        expand_undef_array(ira->codegen, op1_val);
-        expand_undef_array(ira->codegen, op2_val);
-        out_val->special = ConstValSpecialUndef;
-        expand_undef_array(ira->codegen, out_val);
-        size_t len = type_entry->data.vector.len;
-        ZigType *scalar_type = type_entry->data.vector.elem_type;
-        for (size_t i = 0; i < len; i += 1) {
-            ConstExprValue *scalar_op1_val = &op1_val->data.x_array.data.s_none.elements[i];
-            ConstExprValue *scalar_op2_val = &op2_val->data.x_array.data.s_none.elements[i];
-            ConstExprValue *scalar_out_val = &out_val->data.x_array.data.s_none.elements[i];
-            assert(scalar_op1_val->type == scalar_type);
-            assert(scalar_op2_val->type == scalar_type);
-            assert(scalar_out_val->type == scalar_type);
-            ErrorMsg *msg = ir_eval_math_op_scalar(ira, source_instr, scalar_type,
-                    scalar_op1_val, op_id, scalar_op2_val, scalar_out_val);
-            if (msg != nullptr) {
-                add_error_note(ira->codegen, msg, source_instr->source_node,
-                    buf_sprintf("when computing vector element at index %" ZIG_PRI_usize, i));
-                return ira->codegen->invalid_instruction;
-            }
-        }
-        out_val->type = type_entry;
-        out_val->special = ConstValSpecialStatic;
-    } else {
-        if (ir_eval_math_op_scalar(ira, source_instr, type_entry, op1_val, op_id, op2_val, out_val) != nullptr) {
-            return ira->codegen->invalid_instruction;
-        }
-    }
-    return ir_implicit_cast(ira, result_instruction, type_entry);
+    assert(value);
+    assert(value != ira->codegen->invalid_instruction);
+    assert(!expected_type || !type_is_invalid(expected_type));
+    assert(value->value->type);
+    assert(!type_is_invalid(value->value->type));
+    if (expected_type == nullptr)
+        return value; // anything will do
+    if (expected_type == value->value->type)
+        return value; // match
+    if (value->value->type->id == ZigTypeIdUnreachable)
+        return value;
+
+    return ir_analyze_cast(ira, value, expected_type, value, result_loc);
 }
 
-static IrInstruction *ir_analyze_bit_shift(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
-    IrInstruction *op1 = bin_op_instruction->op1->child;
-    if (type_is_invalid(op1->value.type))
-        return ira->codegen->invalid_instruction;
+static IrInstruction *ir_implicit_cast(IrAnalyze *ira, IrInstruction *value, ZigType *expected_type) {
+    return ir_implicit_cast_with_result(ira, value, expected_type, nullptr);
+}
 
-    if (op1->value.type->id != ZigTypeIdInt && op1->value.type->id != ZigTypeIdComptimeInt) {
-        ir_add_error(ira, &bin_op_instruction->base,
-            buf_sprintf("bit shifting operation expected integer type, found '%s'",
-                buf_ptr(&op1->value.type->name)));
+static IrInstruction *ir_get_deref(IrAnalyze *ira, IrInstruction *source_instruction, IrInstruction *ptr,
+        ResultLoc *result_loc)
+{
+    Error err;
+    ZigType *type_entry = ptr->value->type;
+    if (type_is_invalid(type_entry))
         return ira->codegen->invalid_instruction;
-    }
 
-    IrInstruction *op2 = bin_op_instruction->op2->child;
-    if (type_is_invalid(op2->value.type))
+    if (type_entry->id != ZigTypeIdPointer) {
+        ir_add_error_node(ira, source_instruction->source_node,
+            buf_sprintf("attempt to dereference non-pointer type '%s'",
+                buf_ptr(&type_entry->name)));
         return ira->codegen->invalid_instruction;
+    }
 
-    IrInstruction *casted_op2;
-    IrBinOp op_id = bin_op_instruction->op_id;
-    if (op1->value.type->id == ZigTypeIdComptimeInt) {
-        casted_op2 = op2;
-
-        if (op_id == IrBinOpBitShiftLeftLossy) {
-            op_id = IrBinOpBitShiftLeftExact;
-        }
-
-        if (casted_op2->value.data.x_bigint.is_negative) {
-            Buf *val_buf = buf_alloc();
-            bigint_append_buf(val_buf, &casted_op2->value.data.x_bigint, 10);
-            ir_add_error(ira, casted_op2, buf_sprintf("shift by negative value %s", buf_ptr(val_buf)));
+    ZigType *child_type = type_entry->data.pointer.child_type;
+    // if the child type has one possible value, the deref is comptime
+    switch (type_has_one_possible_value(ira->codegen, child_type)) {
+        case OnePossibleValueInvalid:
+            return ira->codegen->invalid_instruction;
+        case OnePossibleValueYes:
+            return ir_const(ira, source_instruction, child_type);
+        case OnePossibleValueNo:
+            break;
+    }
+    if (instr_is_comptime(ptr)) {
+        if (ptr->value->special == ConstValSpecialUndef) {
+            ir_add_error(ira, ptr, buf_sprintf("attempt to dereference undefined value"));
             return ira->codegen->invalid_instruction;
         }
-    } else {
-        ZigType *shift_amt_type = get_smallest_unsigned_int_type(ira->codegen,
-                op1->value.type->data.integral.bit_count - 1);
-        if (bin_op_instruction->op_id == IrBinOpBitShiftLeftLossy &&
-            op2->value.type->id == ZigTypeIdComptimeInt) {
-            if (!bigint_fits_in_bits(&op2->value.data.x_bigint,
-                                     shift_amt_type->data.integral.bit_count,
-                                     op2->value.data.x_bigint.is_negative)) {
-                Buf *val_buf = buf_alloc();
-                bigint_append_buf(val_buf, &op2->value.data.x_bigint, 10);
-                ErrorMsg* msg = ir_add_error(ira,
-                    &bin_op_instruction->base,
-                    buf_sprintf("RHS of shift is too large for LHS type"));
-                add_error_note(
-                    ira->codegen,
-                    msg,
-                    op2->source_node,
-                    buf_sprintf("value %s cannot fit into type %s",
-                        buf_ptr(val_buf),
-                        buf_ptr(&shift_amt_type->name)));
-                return ira->codegen->invalid_instruction;
+        if (ptr->value->data.x_ptr.mut != ConstPtrMutRuntimeVar) {
+            // Read an element of a packed u8 array without expanding it.
+            if (ptr->value->data.x_ptr.special == ConstPtrSpecialBaseArray &&
+                child_type == ira->codegen->builtin_types.entry_u8)
+            {
+                ConstExprValue *array_val = ptr->value->data.x_ptr.data.base_array.array_val;
+                if (array_val->special == ConstValSpecialStatic &&
+                    array_val->data.x_array.special == ConstArraySpecialBuf)
+                {
+                    Buf *bytes = array_val->data.x_array.data.s_buf;
+                    size_t elem_index = ptr->value->data.x_ptr.data.base_array.elem_index;
+                    assert(elem_index < buf_len(bytes));
+                    IrInstruction *result = ir_const(ira, source_instruction, child_type);
+                    bigint_init_unsigned(&result->value->data.x_bigint, (uint8_t)buf_ptr(bytes)[elem_index]);
+                    return result;
+                }
             }
-        }
+            ConstExprValue *pointee = const_ptr_pointee_unchecked(ira->codegen, ptr->value);
+            if (pointee->special != ConstValSpecialRuntime) {
+                IrInstruction *result = ir_const(ira, source_instruction, child_type);
 
-        casted_op2 = ir_implicit_cast(ira, op2, shift_amt_type);
-        if (casted_op2 == ira->codegen->invalid_instruction)
-            return ira->codegen->invalid_instruction;
+                if ((err = ir_read_const_ptr(ira, ira->codegen, source_instruction->source_node, result->value,
+                                ptr->value)))
+                {
+                    return ira->codegen->invalid_instruction;
+                }
+                result->value->type = child_type;
+                return result;
+            }
+        }
+    }
+    // if the instruction is a const ref instruction we can skip it
+    if (ptr->id == IrInstructionIdRef) {
+        IrInstructionRef *ref_inst = reinterpret_cast<IrInstructionRef *>(ptr);
+        return ref_inst->value;
     }
 
-    if (instr_is_comptime(op1) && instr_is_comptime(casted_op2)) {
-        ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
-        if (op1_val == nullptr)
-            return ira->codegen->invalid_instruction;
-
-        ConstExprValue *op2_val = ir_resolve_const(ira, casted_op2, UndefBad);
-        if (op2_val == nullptr)
-            return ira->codegen->invalid_instruction;
-
-        return ir_analyze_math_op(ira, &bin_op_instruction->base, op1->value.type, op1_val, op_id, op2_val);
-    } else if (op1->value.type->id == ZigTypeIdComptimeInt) {
-        ir_add_error(ira, &bin_op_instruction->base,
-                buf_sprintf("LHS of shift must be an integer type, or RHS must be compile-time known"));
-        return ira->codegen->invalid_instruction;
-    } else if (instr_is_comptime(casted_op2) && bigint_cmp_zero(&casted_op2->value.data.x_bigint) == CmpEQ) {
-        IrInstruction *result = ir_build_cast(&ira->new_irb, bin_op_instruction->base.scope,
-                bin_op_instruction->base.source_node, op1->value.type, op1, CastOpNoop);
-        result->value.type = op1->value.type;
-        return result;
+    IrInstruction *result_loc_inst;
+    if (type_entry->data.pointer.host_int_bytes != 0 && handle_is_ptr(child_type)) {
+        if (result_loc == nullptr) result_loc = no_result_loc();
+        result_loc_inst = ir_resolve_result(ira, source_instruction, result_loc, child_type, nullptr, true, false);
+        if (type_is_invalid(result_loc_inst->value->type) || instr_is_unreachable(result_loc_inst)) {
+            return result_loc_inst;
+        }
+    } else {
+        result_loc_inst = nullptr;
     }
 
-    IrInstruction *result = ir_build_bin_op(&ira->new_irb, bin_op_instruction->base.scope,
-            bin_op_instruction->base.source_node, op_id,
-            op1, casted_op2, bin_op_instruction->safety_check_on);
-    result->value.type = op1->value.type;
-    return result;
+    return ir_build_load_ptr_gen(ira, source_instruction, ptr, child_type, result_loc_inst);
 }
 
-static bool ok_float_op(IrBinOp op) {
-    switch (op) {
-        case IrBinOpInvalid:
-            zig_unreachable();
-        case IrBinOpAdd:
-        case IrBinOpSub:
-        case IrBinOpMult:
-        case IrBinOpDivUnspecified:
-        case IrBinOpDivTrunc:
-        case IrBinOpDivFloor:
-        case IrBinOpDivExact:
-        case IrBinOpRemRem:
-        case IrBinOpRemMod:
-            return true;
+static bool ir_resolve_align(IrAnalyze *ira, IrInstruction *value, uint32_t *out) {
+    if (type_is_invalid(value->value->type))
+        return false;
 
-        case IrBinOpBoolOr:
-        case IrBinOpBoolAnd:
-        case IrBinOpCmpEq:
-        case IrBinOpCmpNotEq:
-        case IrBinOpCmpLessThan:
-        case IrBinOpCmpGreaterThan:
-        case IrBinOpCmpLessOrEq:
-        case IrBinOpCmpGreaterOrEq:
-        case IrBinOpBinOr:
-        case IrBinOpBinXor:
-        case IrBinOpBinAnd:
-        case IrBinOpBitShiftLeftLossy:
-        case IrBinOpBitShiftLeftExact:
-        case IrBinOpBitShiftRightLossy:
-        case IrBinOpBitShiftRightExact:
-        case IrBinOpAddWrap:
-        case IrBinOpSubWrap:
-        case IrBinOpMultWrap:
-        case IrBinOpRemUnspecified:
-        case IrBinOpArrayCat:
-        case IrBinOpArrayMult:
-        case IrBinOpMergeErrorSets:
-            return false;
-    }
-    zig_unreachable();
-}
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, get_align_amt_type(ira->codegen));
+    if (type_is_invalid(casted_value->value->type))
+        return false;
 
-static bool is_pointer_arithmetic_allowed(ZigType *lhs_type, IrBinOp op) {
-    if (lhs_type->id != ZigTypeIdPointer)
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return false;
+
+    uint32_t align_bytes = bigint_as_unsigned(&const_val->data.x_bigint);
+    if (align_bytes == 0) {
+        ir_add_error(ira, value, buf_sprintf("alignment must be >= 1"));
         return false;
-    switch (op) {
-        case IrBinOpAdd:
-        case IrBinOpSub:
-            break;
-        default:
-            return false;
     }
-    switch (lhs_type->data.pointer.ptr_len) {
-        case PtrLenSingle:
-            return false;
-        case PtrLenUnknown:
-        case PtrLenC:
-            break;
+
+    if (!is_power_of_2(align_bytes)) {
+        ir_add_error(ira, value, buf_sprintf("alignment value %" PRIu32 " is not a power of 2", align_bytes));
+        return false;
     }
+
+    *out = align_bytes;
     return true;
 }
 
-static IrInstruction *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp *instruction) {
-    Error err;
+static bool ir_resolve_unsigned(IrAnalyze *ira, IrInstruction *value, ZigType *int_type, uint64_t *out) {
+    if (type_is_invalid(value->value->type))
+        return false;
 
-    IrInstruction *op1 = instruction->op1->child;
-    if (type_is_invalid(op1->value.type))
-        return ira->codegen->invalid_instruction;
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, int_type);
+    if (type_is_invalid(casted_value->value->type))
+        return false;
 
-    IrInstruction *op2 = instruction->op2->child;
-    if (type_is_invalid(op2->value.type))
-        return ira->codegen->invalid_instruction;
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return false;
 
-    IrBinOp op_id = instruction->op_id;
+    *out = bigint_as_unsigned(&const_val->data.x_bigint);
+    return true;
+}
 
-    // look for pointer math
-    if (is_pointer_arithmetic_allowed(op1->value.type, op_id)) {
-        IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, ira->codegen->builtin_types.entry_usize);
-        if (type_is_invalid(casted_op2->value.type))
-            return ira->codegen->invalid_instruction;
+static bool ir_resolve_usize(IrAnalyze *ira, IrInstruction *value, uint64_t *out) {
+    return ir_resolve_unsigned(ira, value, ira->codegen->builtin_types.entry_usize, out);
+}
 
-        if (op1->value.special == ConstValSpecialUndef || casted_op2->value.special == ConstValSpecialUndef) {
-            IrInstruction *result = ir_const(ira, &instruction->base, op1->value.type);
-            result->value.special = ConstValSpecialUndef;
-            return result;
-        }
-        if (casted_op2->value.special == ConstValSpecialStatic && op1->value.special == ConstValSpecialStatic &&
-            (op1->value.data.x_ptr.special == ConstPtrSpecialHardCodedAddr ||
-            op1->value.data.x_ptr.special == ConstPtrSpecialNull))
-        {
-            uint64_t start_addr = (op1->value.data.x_ptr.special == ConstPtrSpecialNull) ?
-                0 : op1->value.data.x_ptr.data.hard_coded_addr.addr;
-            uint64_t elem_offset;
-            if (!ir_resolve_usize(ira, casted_op2, &elem_offset))
-                return ira->codegen->invalid_instruction;
-            ZigType *elem_type = op1->value.type->data.pointer.child_type;
-            if ((err = type_resolve(ira->codegen, elem_type, ResolveStatusSizeKnown)))
-                return ira->codegen->invalid_instruction;
-            uint64_t byte_offset = type_size(ira->codegen, elem_type) * elem_offset;
-            uint64_t new_addr;
-            if (op_id == IrBinOpAdd) {
-                new_addr = start_addr + byte_offset;
-            } else if (op_id == IrBinOpSub) {
-                new_addr = start_addr - byte_offset;
-            } else {
-                zig_unreachable();
-            }
-            IrInstruction *result = ir_const(ira, &instruction->base, op1->value.type);
-            result->value.data.x_ptr.special = ConstPtrSpecialHardCodedAddr;
-            result->value.data.x_ptr.mut = ConstPtrMutRuntimeVar;
-            result->value.data.x_ptr.data.hard_coded_addr.addr = new_addr;
-            return result;
-        }
+static bool ir_resolve_bool(IrAnalyze *ira, IrInstruction *value, bool *out) {
+    if (type_is_invalid(value->value->type))
+        return false;
 
-        IrInstruction *result = ir_build_bin_op(&ira->new_irb, instruction->base.scope,
-                instruction->base.source_node, op_id, op1, casted_op2, true);
-        result->value.type = op1->value.type;
-        return result;
-    }
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, ira->codegen->builtin_types.entry_bool);
+    if (type_is_invalid(casted_value->value->type))
+        return false;
 
-    IrInstruction *instructions[] = {op1, op2};
-    ZigType *resolved_type = ir_resolve_peer_types(ira, instruction->base.source_node, nullptr, instructions, 2);
-    if (type_is_invalid(resolved_type))
-        return ira->codegen->invalid_instruction;
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return false;
 
-    bool is_int = resolved_type->id == ZigTypeIdInt || resolved_type->id == ZigTypeIdComptimeInt;
-    bool is_float = resolved_type->id == ZigTypeIdFloat || resolved_type->id == ZigTypeIdComptimeFloat;
-    bool is_signed_div = (
-        (resolved_type->id == ZigTypeIdInt && resolved_type->data.integral.is_signed) ||
-        resolved_type->id == ZigTypeIdFloat ||
-        (resolved_type->id == ZigTypeIdComptimeFloat &&
-            ((bigfloat_cmp_zero(&op1->value.data.x_bigfloat) != CmpGT) !=
-             (bigfloat_cmp_zero(&op2->value.data.x_bigfloat) != CmpGT))) ||
-        (resolved_type->id == ZigTypeIdComptimeInt &&
-            ((bigint_cmp_zero(&op1->value.data.x_bigint) != CmpGT) !=
-             (bigint_cmp_zero(&op2->value.data.x_bigint) != CmpGT)))
-    );
-    if (op_id == IrBinOpDivUnspecified && is_int) {
-        if (is_signed_div) {
-            bool ok = false;
-            if (instr_is_comptime(op1) && instr_is_comptime(op2)) {
-                ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
-                if (op1_val == nullptr)
-                    return ira->codegen->invalid_instruction;
+    *out = const_val->data.x_bool;
+    return true;
+}
 
-                ConstExprValue *op2_val = ir_resolve_const(ira, op2, UndefBad);
-                if (op2_val == nullptr)
-                    return ira->codegen->invalid_instruction;
+static bool ir_resolve_comptime(IrAnalyze *ira, IrInstruction *value, bool *out) {
+    if (!value) {
+        *out = false;
+        return true;
+    }
+    return ir_resolve_bool(ira, value, out);
+}
 
-                if (bigint_cmp_zero(&op2_val->data.x_bigint) == CmpEQ) {
-                    // the division by zero error will be caught later, but we don't have a
-                    // division function ambiguity problem.
-                    op_id = IrBinOpDivTrunc;
-                    ok = true;
-                } else {
-                    BigInt trunc_result;
-                    BigInt floor_result;
-                    bigint_div_trunc(&trunc_result, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-                    bigint_div_floor(&floor_result, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-                    if (bigint_cmp(&trunc_result, &floor_result) == CmpEQ) {
-                        ok = true;
-                        op_id = IrBinOpDivTrunc;
-                    }
-                }
-            }
-            if (!ok) {
-                ir_add_error(ira, &instruction->base,
-                    buf_sprintf("division with '%s' and '%s': signed integers must use @divTrunc, @divFloor, or @divExact",
-                        buf_ptr(&op1->value.type->name),
-                        buf_ptr(&op2->value.type->name)));
-                return ira->codegen->invalid_instruction;
-            }
-        } else {
-            op_id = IrBinOpDivTrunc;
-        }
-    } else if (op_id == IrBinOpRemUnspecified) {
-        if (is_signed_div && (is_int || is_float)) {
-            bool ok = false;
-            if (instr_is_comptime(op1) && instr_is_comptime(op2)) {
-                ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
-                if (op1_val == nullptr)
-                    return ira->codegen->invalid_instruction;
+static bool ir_resolve_atomic_order(IrAnalyze *ira, IrInstruction *value, AtomicOrder *out) {
+    if (type_is_invalid(value->value->type))
+        return false;
 
-                if (is_int) {
-                    ConstExprValue *op2_val = ir_resolve_const(ira, op2, UndefBad);
-                    if (op2_val == nullptr)
-                        return ira->codegen->invalid_instruction;
+    ConstExprValue *atomic_order_val = get_builtin_value(ira->codegen, "AtomicOrder");
+    assert(atomic_order_val->type->id == ZigTypeIdMetaType);
+    ZigType *atomic_order_type = atomic_order_val->data.x_type;
 
-                    if (bigint_cmp_zero(&op2->value.data.x_bigint) == CmpEQ) {
-                        // the division by zero error will be caught later, but we don't
-                        // have a remainder function ambiguity problem
-                        ok = true;
-                    } else {
-                        BigInt rem_result;
-                        BigInt mod_result;
-                        bigint_rem(&rem_result, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-                        bigint_mod(&mod_result, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
-                        ok = bigint_cmp(&rem_result, &mod_result) == CmpEQ;
-                    }
-                } else {
-                    IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, resolved_type);
-                    if (casted_op2 == ira->codegen->invalid_instruction)
-                        return ira->codegen->invalid_instruction;
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, atomic_order_type);
+    if (type_is_invalid(casted_value->value->type))
+        return false;
 
-                    ConstExprValue *op2_val = ir_resolve_const(ira, casted_op2, UndefBad);
-                    if (op2_val == nullptr)
-                        return ira->codegen->invalid_instruction;
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return false;
 
-                    if (float_cmp_zero(&casted_op2->value) == CmpEQ) {
-                        // the division by zero error will be caught later, but we don't
-                        // have a remainder function ambiguity problem
-                        ok = true;
-                    } else {
-                        ConstExprValue rem_result = {};
-                        ConstExprValue mod_result = {};
-                        float_rem(&rem_result, op1_val, op2_val);
-                        float_mod(&mod_result, op1_val, op2_val);
-                        ok = float_cmp(&rem_result, &mod_result) == CmpEQ;
-                    }
-                }
-            }
-            if (!ok) {
-                ir_add_error(ira, &instruction->base,
-                    buf_sprintf("remainder division with '%s' and '%s': signed integers and floats must use @rem or @mod",
-                        buf_ptr(&op1->value.type->name),
-                        buf_ptr(&op2->value.type->name)));
-                return ira->codegen->invalid_instruction;
-            }
-        }
-        op_id = IrBinOpRemRem;
-    }
+    *out = (AtomicOrder)bigint_as_unsigned(&const_val->data.x_enum_tag);
+    return true;
+}
 
-    bool ok = false;
-    if (is_int) {
-        ok = true;
-    } else if (is_float && ok_float_op(op_id)) {
-        ok = true;
-    } else if (resolved_type->id == ZigTypeIdVector) {
-        ZigType *elem_type = resolved_type->data.vector.elem_type;
-        if (elem_type->id == ZigTypeIdInt || elem_type->id == ZigTypeIdComptimeInt) {
-            ok = true;
-        } else if ((elem_type->id == ZigTypeIdFloat || elem_type->id == ZigTypeIdComptimeFloat) && ok_float_op(op_id)) {
-            ok = true;
-        }
-    }
-    if (!ok) {
-        AstNode *source_node = instruction->base.source_node;
-        ir_add_error_node(ira, source_node,
-            buf_sprintf("invalid operands to binary expression: '%s' and '%s'",
-                buf_ptr(&op1->value.type->name),
-                buf_ptr(&op2->value.type->name)));
-        return ira->codegen->invalid_instruction;
-    }
+static bool ir_resolve_atomic_rmw_op(IrAnalyze *ira, IrInstruction *value, AtomicRmwOp *out) {
+    if (type_is_invalid(value->value->type))
+        return false;
 
-    if (resolved_type->id == ZigTypeIdComptimeInt) {
-        if (op_id == IrBinOpAddWrap) {
-            op_id = IrBinOpAdd;
-        } else if (op_id == IrBinOpSubWrap) {
-            op_id = IrBinOpSub;
-        } else if (op_id == IrBinOpMultWrap) {
-            op_id = IrBinOpMult;
-        }
-    }
-
-    IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, resolved_type);
-    if (casted_op1 == ira->codegen->invalid_instruction)
-        return ira->codegen->invalid_instruction;
-
-    IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, resolved_type);
-    if (casted_op2 == ira->codegen->invalid_instruction)
-        return ira->codegen->invalid_instruction;
+    ConstExprValue *atomic_rmw_op_val = get_builtin_value(ira->codegen, "AtomicRmwOp");
+    assert(atomic_rmw_op_val->type->id == ZigTypeIdMetaType);
+    ZigType *atomic_rmw_op_type = atomic_rmw_op_val->data.x_type;
 
-    if (instr_is_comptime(casted_op1) && instr_is_comptime(casted_op2)) {
-        ConstExprValue *op1_val = ir_resolve_const(ira, casted_op1, UndefBad);
-        if (op1_val == nullptr)
-            return ira->codegen->invalid_instruction;
-        ConstExprValue *op2_val = ir_resolve_const(ira, casted_op2, UndefBad);
-        if (op2_val == nullptr)
-            return ira->codegen->invalid_instruction;
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, atomic_rmw_op_type);
+    if (type_is_invalid(casted_value->value->type))
+        return false;
 
-        return ir_analyze_math_op(ira, &instruction->base, resolved_type, op1_val, op_id, op2_val);
-    }
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return false;
 
-    IrInstruction *result = ir_build_bin_op(&ira->new_irb, instruction->base.scope,
-            instruction->base.source_node, op_id, casted_op1, casted_op2, instruction->safety_check_on);
-    result->value.type = resolved_type;
-    return result;
+    *out = (AtomicRmwOp)bigint_as_unsigned(&const_val->data.x_enum_tag);
+    return true;
 }
 
-static IrInstruction *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *instruction) {
-    IrInstruction *op1 = instruction->op1->child;
-    ZigType *op1_type = op1->value.type;
-    if (type_is_invalid(op1_type))
-        return ira->codegen->invalid_instruction;
-
-    IrInstruction *op2 = instruction->op2->child;
-    ZigType *op2_type = op2->value.type;
-    if (type_is_invalid(op2_type))
-        return ira->codegen->invalid_instruction;
+static bool ir_resolve_global_linkage(IrAnalyze *ira, IrInstruction *value, GlobalLinkageId *out) {
+    if (type_is_invalid(value->value->type))
+        return false;
 
-    ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
-    if (!op1_val)
-        return ira->codegen->invalid_instruction;
+    ConstExprValue *global_linkage_val = get_builtin_value(ira->codegen, "GlobalLinkage");
+    assert(global_linkage_val->type->id == ZigTypeIdMetaType);
+    ZigType *global_linkage_type = global_linkage_val->data.x_type;
 
-    ConstExprValue *op2_val = ir_resolve_const(ira, op2, UndefBad);
-    if (!op2_val)
-        return ira->codegen->invalid_instruction;
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, global_linkage_type);
+    if (type_is_invalid(casted_value->value->type))
+        return false;
 
-    ConstExprValue *op1_array_val;
-    size_t op1_array_index;
-    size_t op1_array_end;
-    ZigType *child_type;
-    if (op1_type->id == ZigTypeIdArray) {
-        child_type = op1_type->data.array.child_type;
-        op1_array_val = op1_val;
-        op1_array_index = 0;
-        op1_array_end = op1_type->data.array.len;
-    } else if (op1_type->id == ZigTypeIdPointer &&
-        op1_type->data.pointer.child_type == ira->codegen->builtin_types.entry_u8 &&
-        op1_val->data.x_ptr.special == ConstPtrSpecialBaseArray &&
-        op1_val->data.x_ptr.data.base_array.is_cstr)
-    {
-        child_type = op1_type->data.pointer.child_type;
-        op1_array_val = op1_val->data.x_ptr.data.base_array.array_val;
-        op1_array_index = op1_val->data.x_ptr.data.base_array.elem_index;
-        op1_array_end = op1_array_val->type->data.array.len - 1;
-    } else if (is_slice(op1_type)) {
-        ZigType *ptr_type = op1_type->data.structure.fields[slice_ptr_index].type_entry;
-        child_type = ptr_type->data.pointer.child_type;
-        ConstExprValue *ptr_val = &op1_val->data.x_struct.fields[slice_ptr_index];
-        assert(ptr_val->data.x_ptr.special == ConstPtrSpecialBaseArray);
-        op1_array_val = ptr_val->data.x_ptr.data.base_array.array_val;
-        op1_array_index = ptr_val->data.x_ptr.data.base_array.elem_index;
-        ConstExprValue *len_val = &op1_val->data.x_struct.fields[slice_len_index];
-        op1_array_end = op1_array_index + bigint_as_unsigned(&len_val->data.x_bigint);
-    } else {
-        ir_add_error(ira, op1,
-            buf_sprintf("expected array or C string literal, found '%s'", buf_ptr(&op1->value.type->name)));
-        return ira->codegen->invalid_instruction;
-    }
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return false;
 
-    ConstExprValue *op2_array_val;
-    size_t op2_array_index;
-    size_t op2_array_end;
-    bool op2_type_valid;
-    if (op2_type->id == ZigTypeIdArray) {
-        op2_type_valid = op2_type->data.array.child_type == child_type;
-        op2_array_val = op2_val;
-        op2_array_index = 0;
-        op2_array_end = op2_array_val->type->data.array.len;
-    } else if (op2_type->id == ZigTypeIdPointer &&
-        op2_type->data.pointer.child_type == ira->codegen->builtin_types.entry_u8 &&
-        op2_val->data.x_ptr.special == ConstPtrSpecialBaseArray &&
-        op2_val->data.x_ptr.data.base_array.is_cstr)
-    {
-        op2_type_valid = child_type == ira->codegen->builtin_types.entry_u8;
-        op2_array_val = op2_val->data.x_ptr.data.base_array.array_val;
-        op2_array_index = op2_val->data.x_ptr.data.base_array.elem_index;
-        op2_array_end = op2_array_val->type->data.array.len - 1;
-    } else if (is_slice(op2_type)) {
-        ZigType *ptr_type = op2_type->data.structure.fields[slice_ptr_index].type_entry;
-        op2_type_valid = ptr_type->data.pointer.child_type == child_type;
-        ConstExprValue *ptr_val = &op2_val->data.x_struct.fields[slice_ptr_index];
-        assert(ptr_val->data.x_ptr.special == ConstPtrSpecialBaseArray);
-        op2_array_val = ptr_val->data.x_ptr.data.base_array.array_val;
-        op2_array_index = ptr_val->data.x_ptr.data.base_array.elem_index;
-        ConstExprValue *len_val = &op2_val->data.x_struct.fields[slice_len_index];
-        op2_array_end = op2_array_index + bigint_as_unsigned(&len_val->data.x_bigint);
-    } else {
-        ir_add_error(ira, op2,
-            buf_sprintf("expected array or C string literal, found '%s'", buf_ptr(&op2->value.type->name)));
-        return ira->codegen->invalid_instruction;
-    }
-    if (!op2_type_valid) {
-        ir_add_error(ira, op2, buf_sprintf("expected array of type '%s', found '%s'",
-                    buf_ptr(&child_type->name),
-                    buf_ptr(&op2->value.type->name)));
-        return ira->codegen->invalid_instruction;
-    }
+    *out = (GlobalLinkageId)bigint_as_unsigned(&const_val->data.x_enum_tag);
+    return true;
+}
 
-    // The type of result is populated in the following if blocks
-    IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
-    ConstExprValue *out_val = &result->value;
+static bool ir_resolve_float_mode(IrAnalyze *ira, IrInstruction *value, FloatMode *out) {
+    if (type_is_invalid(value->value->type))
+        return false;
 
-    ConstExprValue *out_array_val;
-    size_t new_len = (op1_array_end - op1_array_index) + (op2_array_end - op2_array_index);
-    if (op1_type->id == ZigTypeIdArray || op2_type->id == ZigTypeIdArray) {
-        result->value.type = get_array_type(ira->codegen, child_type, new_len);
+    ConstExprValue *float_mode_val = get_builtin_value(ira->codegen, "FloatMode");
+    assert(float_mode_val->type->id == ZigTypeIdMetaType);
+    ZigType *float_mode_type = float_mode_val->data.x_type;
 
-        out_array_val = out_val;
-    } else if (is_slice(op1_type) || is_slice(op2_type)) {
-        ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, child_type,
-                true, false, PtrLenUnknown, 0, 0, 0, false);
-        result->value.type = get_slice_type(ira->codegen, ptr_type);
-        out_array_val = create_const_vals(1);
-        out_array_val->special = ConstValSpecialStatic;
-        out_array_val->type = get_array_type(ira->codegen, child_type, new_len);
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, float_mode_type);
+    if (type_is_invalid(casted_value->value->type))
+        return false;
 
-        out_val->data.x_struct.fields = create_const_vals(2);
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return false;
 
-        out_val->data.x_struct.fields[slice_ptr_index].type = ptr_type;
-        out_val->data.x_struct.fields[slice_ptr_index].special = ConstValSpecialStatic;
-        out_val->data.x_struct.fields[slice_ptr_index].data.x_ptr.special = ConstPtrSpecialBaseArray;
-        out_val->data.x_struct.fields[slice_ptr_index].data.x_ptr.data.base_array.array_val = out_array_val;
-        out_val->data.x_struct.fields[slice_ptr_index].data.x_ptr.data.base_array.elem_index = 0;
+    *out = (FloatMode)bigint_as_unsigned(&const_val->data.x_enum_tag);
+    return true;
+}
 
-        out_val->data.x_struct.fields[slice_len_index].type = ira->codegen->builtin_types.entry_usize;
-        out_val->data.x_struct.fields[slice_len_index].special = ConstValSpecialStatic;
-        bigint_init_unsigned(&out_val->data.x_struct.fields[slice_len_index].data.x_bigint, new_len);
-    } else {
-        new_len += 1; // null byte
 
-        // TODO make this `[*]null T` instead of `[*]T`
-        result->value.type = get_pointer_to_type_extra(ira->codegen, child_type, true, false, PtrLenUnknown, 0, 0, 0, false);
+static Buf *ir_resolve_str(IrAnalyze *ira, IrInstruction *value) {
+    if (type_is_invalid(value->value->type))
+        return nullptr;
 
-        out_array_val = create_const_vals(1);
-        out_array_val->special = ConstValSpecialStatic;
-        out_array_val->type = get_array_type(ira->codegen, child_type, new_len);
-        out_val->data.x_ptr.special = ConstPtrSpecialBaseArray;
-        out_val->data.x_ptr.data.base_array.is_cstr = true;
-        out_val->data.x_ptr.data.base_array.array_val = out_array_val;
-        out_val->data.x_ptr.data.base_array.elem_index = 0;
-    }
+    ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, ira->codegen->builtin_types.entry_u8,
+            true, false, PtrLenUnknown, 0, 0, 0, false);
+    ZigType *str_type = get_slice_type(ira->codegen, ptr_type);
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, str_type);
+    if (type_is_invalid(casted_value->value->type))
+        return nullptr;
 
-    if (op1_array_val->data.x_array.special == ConstArraySpecialUndef &&
-        op2_array_val->data.x_array.special == ConstArraySpecialUndef) {
-        out_array_val->data.x_array.special = ConstArraySpecialUndef;
-        return result;
-    }
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return nullptr;
 
-    out_array_val->data.x_array.data.s_none.elements = create_const_vals(new_len);
-    // TODO handle the buf case here for an optimization
-    expand_undef_array(ira->codegen, op1_array_val);
-    expand_undef_array(ira->codegen, op2_array_val);
+    ConstExprValue *ptr_field = &const_val->data.x_struct.fields[slice_ptr_index];
+    ConstExprValue *len_field = &const_val->data.x_struct.fields[slice_len_index];
 
-    size_t next_index = 0;
-    for (size_t i = op1_array_index; i < op1_array_end; i += 1, next_index += 1) {
-        copy_const_val(&out_array_val->data.x_array.data.s_none.elements[next_index],
-                &op1_array_val->data.x_array.data.s_none.elements[i], true);
-    }
-    for (size_t i = op2_array_index; i < op2_array_end; i += 1, next_index += 1) {
-        copy_const_val(&out_array_val->data.x_array.data.s_none.elements[next_index],
-                &op2_array_val->data.x_array.data.s_none.elements[i], true);
+    assert(ptr_field->data.x_ptr.special == ConstPtrSpecialBaseArray);
+    ConstExprValue *array_val = ptr_field->data.x_ptr.data.base_array.array_val;
+    if (array_val->data.x_array.special == ConstArraySpecialBuf) {
+        return array_val->data.x_array.data.s_buf;
     }
-    if (next_index < new_len) {
-        ConstExprValue *null_byte = &out_array_val->data.x_array.data.s_none.elements[next_index];
-        init_const_unsigned_negative(null_byte, child_type, 0, false);
-        next_index += 1;
+    expand_undef_array(ira->codegen, array_val);
+    size_t len = bigint_as_unsigned(&len_field->data.x_bigint);
+    Buf *result = buf_alloc();
+    buf_resize(result, len);
+    for (size_t i = 0; i < len; i += 1) {
+        size_t new_index = ptr_field->data.x_ptr.data.base_array.elem_index + i;
+        ConstExprValue *char_val = &array_val->data.x_array.data.s_none.elements[new_index];
+        if (char_val->special == ConstValSpecialUndef) {
+            ir_add_error(ira, casted_value, buf_sprintf("use of undefined value"));
+            return nullptr;
+        }
+        uint64_t big_c = bigint_as_unsigned(&char_val->data.x_bigint);
+        assert(big_c <= UINT8_MAX);
+        uint8_t c = (uint8_t)big_c;
+        buf_ptr(result)[i] = c;
     }
-    assert(next_index == new_len);
-
     return result;
 }
 
-static IrInstruction *ir_analyze_array_mult(IrAnalyze *ira, IrInstructionBinOp *instruction) {
-    IrInstruction *op1 = instruction->op1->child;
-    if (type_is_invalid(op1->value.type))
-        return ira->codegen->invalid_instruction;
-
-    IrInstruction *op2 = instruction->op2->child;
-    if (type_is_invalid(op2->value.type))
-        return ira->codegen->invalid_instruction;
+static IrInstruction *ir_analyze_instruction_add_implicit_return_type(IrAnalyze *ira,
+        IrInstructionAddImplicitReturnType *instruction)
+{
+    IrInstruction *value = instruction->value->child;
+    if (type_is_invalid(value->value->type))
+        return ir_unreach_error(ira);
 
-    ConstExprValue *array_val = ir_resolve_const(ira, op1, UndefBad);
-    if (!array_val)
-        return ira->codegen->invalid_instruction;
+    ira->src_implicit_return_type_list.append(value);
 
-    uint64_t mult_amt;
-    if (!ir_resolve_usize(ira, op2, &mult_amt))
-        return ira->codegen->invalid_instruction;
+    return ir_const_void(ira, &instruction->base);
+}
 
-    ZigType *array_type = op1->value.type;
-    if (array_type->id != ZigTypeIdArray) {
-        ir_add_error(ira, op1, buf_sprintf("expected array type, found '%s'", buf_ptr(&op1->value.type->name)));
-        return ira->codegen->invalid_instruction;
-    }
+static IrInstruction *ir_analyze_instruction_return(IrAnalyze *ira, IrInstructionReturn *instruction) {
+    IrInstruction *value = instruction->value->child;
+    if (type_is_invalid(value->value->type))
+        return ir_unreach_error(ira);
 
-    uint64_t old_array_len = array_type->data.array.len;
-    uint64_t new_array_len;
-
-    if (mul_u64_overflow(old_array_len, mult_amt, &new_array_len))
-    {
-        ir_add_error(ira, &instruction->base, buf_sprintf("operation results in overflow"));
-        return ira->codegen->invalid_instruction;
+    if (!instr_is_comptime(value) && handle_is_ptr(ira->explicit_return_type)) {
+        // result location mechanism took care of it.
+        IrInstruction *result = ir_build_return(&ira->new_irb, instruction->base.scope,
+                instruction->base.source_node, nullptr);
+        result->value->type = ira->codegen->builtin_types.entry_unreachable;
+        return ir_finish_anal(ira, result);
     }
 
-    ZigType *child_type = array_type->data.array.child_type;
-
-    IrInstruction *result = ir_const(ira, &instruction->base,
-        get_array_type(ira->codegen, child_type, new_array_len));
-    ConstExprValue *out_val = &result->value;
-    if (array_val->data.x_array.special == ConstArraySpecialUndef) {
-        out_val->data.x_array.special = ConstArraySpecialUndef;
-        return result;
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, ira->explicit_return_type);
+    if (type_is_invalid(casted_value->value->type)) {
+        AstNode *source_node = ira->explicit_return_type_source_node;
+        if (source_node != nullptr) {
+            ErrorMsg *msg = ira->codegen->errors.last();
+            add_error_note(ira->codegen, msg, source_node,
+                buf_sprintf("return type declared here"));
+        }
+        return ir_unreach_error(ira);
     }
 
-    // TODO optimize the buf case
-    expand_undef_array(ira->codegen, array_val);
-    out_val->data.x_array.data.s_none.elements = create_const_vals(new_array_len);
-
-    uint64_t i = 0;
-    for (uint64_t x = 0; x < mult_amt; x += 1) {
-        for (uint64_t y = 0; y < old_array_len; y += 1) {
-            copy_const_val(&out_val->data.x_array.data.s_none.elements[i],
-                &array_val->data.x_array.data.s_none.elements[y], false);
-            i += 1;
-        }
+    if (casted_value->value->special == ConstValSpecialRuntime &&
+        casted_value->value->type->id == ZigTypeIdPointer &&
+        casted_value->value->data.rh_ptr == RuntimeHintPtrStack)
+    {
+        ir_add_error(ira, casted_value, buf_sprintf("function returns address of local variable"));
+        return ir_unreach_error(ira);
     }
-    assert(i == new_array_len);
+    IrInstruction *result = ir_build_return(&ira->new_irb, instruction->base.scope,
+            instruction->base.source_node, casted_value);
+    result->value->type = ira->codegen->builtin_types.entry_unreachable;
+    return ir_finish_anal(ira, result);
+}
 
+static IrInstruction *ir_analyze_instruction_const(IrAnalyze *ira, IrInstructionConst *instruction) {
+    IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
+    copy_const_val(result->value, instruction->base.value, true);
     return result;
 }
 
-static IrInstruction *ir_analyze_merge_error_sets(IrAnalyze *ira, IrInstructionBinOp *instruction) {
-    ZigType *op1_type = ir_resolve_error_set_type(ira, &instruction->base, instruction->op1->child);
-    if (type_is_invalid(op1_type))
+static IrInstruction *ir_analyze_bin_op_bool(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
+    IrInstruction *op1 = bin_op_instruction->op1->child;
+    if (type_is_invalid(op1->value->type))
         return ira->codegen->invalid_instruction;
 
-    ZigType *op2_type = ir_resolve_error_set_type(ira, &instruction->base, instruction->op2->child);
-    if (type_is_invalid(op2_type))
+    IrInstruction *op2 = bin_op_instruction->op2->child;
+    if (type_is_invalid(op2->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (type_is_global_error_set(op1_type) ||
-        type_is_global_error_set(op2_type))
-    {
-        return ir_const_type(ira, &instruction->base, ira->codegen->builtin_types.entry_global_error_set);
-    }
+    ZigType *bool_type = ira->codegen->builtin_types.entry_bool;
 
-    if (!resolve_inferred_error_set(ira->codegen, op1_type, instruction->op1->child->source_node)) {
+    IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, bool_type);
+    if (casted_op1 == ira->codegen->invalid_instruction)
         return ira->codegen->invalid_instruction;
-    }
 
-    if (!resolve_inferred_error_set(ira->codegen, op2_type, instruction->op2->child->source_node)) {
+    IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, bool_type);
+    if (casted_op2 == ira->codegen->invalid_instruction)
         return ira->codegen->invalid_instruction;
-    }
 
-    ErrorTableEntry **errors = allocate<ErrorTableEntry *>(ira->codegen->errors_by_index.length);
-    for (uint32_t i = 0, count = op1_type->data.error_set.err_count; i < count; i += 1) {
-        ErrorTableEntry *error_entry = op1_type->data.error_set.errors[i];
-        assert(errors[error_entry->value] == nullptr);
-        errors[error_entry->value] = error_entry;
+    if (instr_is_comptime(casted_op1) && instr_is_comptime(casted_op2)) {
+        ConstExprValue *op1_val = ir_resolve_const(ira, casted_op1, UndefBad);
+        if (op1_val == nullptr)
+            return ira->codegen->invalid_instruction;
+
+        ConstExprValue *op2_val = ir_resolve_const(ira, casted_op2, UndefBad);
+        if (op2_val == nullptr)
+            return ira->codegen->invalid_instruction;
+
+        assert(casted_op1->value->type->id == ZigTypeIdBool);
+        assert(casted_op2->value->type->id == ZigTypeIdBool);
+        bool result_bool;
+        if (bin_op_instruction->op_id == IrBinOpBoolOr) {
+            result_bool = op1_val->data.x_bool || op2_val->data.x_bool;
+        } else if (bin_op_instruction->op_id == IrBinOpBoolAnd) {
+            result_bool = op1_val->data.x_bool && op2_val->data.x_bool;
+        } else {
+            zig_unreachable();
+        }
+        return ir_const_bool(ira, &bin_op_instruction->base, result_bool);
     }
-    ZigType *result_type = get_error_set_union(ira->codegen, errors, op1_type, op2_type);
-    free(errors);
 
-    return ir_const_type(ira, &instruction->base, result_type);
+    IrInstruction *result = ir_build_bin_op(&ira->new_irb,
+            bin_op_instruction->base.scope, bin_op_instruction->base.source_node,
+            bin_op_instruction->op_id, casted_op1, casted_op2, bin_op_instruction->safety_check_on);
+    result->value->type = bool_type;
+    return result;
 }
 
-static IrInstruction *ir_analyze_instruction_bin_op(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
-    IrBinOp op_id = bin_op_instruction->op_id;
+static bool resolve_cmp_op_id(IrBinOp op_id, Cmp cmp) {
     switch (op_id) {
-        case IrBinOpInvalid:
-            zig_unreachable();
-        case IrBinOpBoolOr:
-        case IrBinOpBoolAnd:
-            return ir_analyze_bin_op_bool(ira, bin_op_instruction);
         case IrBinOpCmpEq:
+            return cmp == CmpEQ;
         case IrBinOpCmpNotEq:
+            return cmp != CmpEQ;
         case IrBinOpCmpLessThan:
+            return cmp == CmpLT;
         case IrBinOpCmpGreaterThan:
+            return cmp == CmpGT;
         case IrBinOpCmpLessOrEq:
+            return cmp != CmpGT;
         case IrBinOpCmpGreaterOrEq:
-            return ir_analyze_bin_op_cmp(ira, bin_op_instruction);
-        case IrBinOpBitShiftLeftLossy:
-        case IrBinOpBitShiftLeftExact:
-        case IrBinOpBitShiftRightLossy:
-        case IrBinOpBitShiftRightExact:
-            return ir_analyze_bit_shift(ira, bin_op_instruction);
-        case IrBinOpBinOr:
-        case IrBinOpBinXor:
-        case IrBinOpBinAnd:
-        case IrBinOpAdd:
-        case IrBinOpAddWrap:
-        case IrBinOpSub:
-        case IrBinOpSubWrap:
-        case IrBinOpMult:
-        case IrBinOpMultWrap:
-        case IrBinOpDivUnspecified:
-        case IrBinOpDivTrunc:
-        case IrBinOpDivFloor:
-        case IrBinOpDivExact:
-        case IrBinOpRemUnspecified:
-        case IrBinOpRemRem:
-        case IrBinOpRemMod:
-            return ir_analyze_bin_op_math(ira, bin_op_instruction);
-        case IrBinOpArrayCat:
-            return ir_analyze_array_cat(ira, bin_op_instruction);
-        case IrBinOpArrayMult:
-            return ir_analyze_array_mult(ira, bin_op_instruction);
-        case IrBinOpMergeErrorSets:
-            return ir_analyze_merge_error_sets(ira, bin_op_instruction);
+            return cmp != CmpLT;
+        default:
+            zig_unreachable();
     }
-    zig_unreachable();
 }
 
-static IrInstruction *ir_analyze_instruction_decl_var(IrAnalyze *ira,
-        IrInstructionDeclVarSrc *decl_var_instruction)
-{
-    Error err;
-    ZigVar *var = decl_var_instruction->var;
-
-    ZigType *explicit_type = nullptr;
-    IrInstruction *var_type = nullptr;
-    if (decl_var_instruction->var_type != nullptr) {
-        var_type = decl_var_instruction->var_type->child;
-        ZigType *proposed_type = ir_resolve_type(ira, var_type);
-        explicit_type = validate_var_type(ira->codegen, var_type->source_node, proposed_type);
-        if (type_is_invalid(explicit_type)) {
-            var->var_type = ira->codegen->builtin_types.entry_invalid;
-            return ira->codegen->invalid_instruction;
+static bool optional_value_is_null(ConstExprValue *val) {
+    assert(val->special == ConstValSpecialStatic);
+    if (get_codegen_ptr_type(val->type) != nullptr) {
+        if (val->data.x_ptr.special == ConstPtrSpecialNull) {
+            return true;
+        } else if (val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr) {
+            return val->data.x_ptr.data.hard_coded_addr.addr == 0;
+        } else {
+            return false;
         }
+    } else if (is_opt_err_set(val->type)) {
+        return val->data.x_err_set == nullptr;
+    } else {
+        return val->data.x_optional == nullptr;
     }
+}
 
-    AstNode *source_node = decl_var_instruction->base.source_node;
-
-    bool is_comptime_var = ir_get_var_is_comptime(var);
-
-    bool var_class_requires_const = false;
-
-    IrInstruction *var_ptr = decl_var_instruction->ptr->child;
-    // if this is null, a compiler error happened and did not initialize the variable.
-    // if there are no compile errors there may be a missing ir_expr_wrap in pass1 IR generation.
-    if (var_ptr == nullptr || type_is_invalid(var_ptr->value.type)) {
-        ir_assert(var_ptr != nullptr || ira->codegen->errors.length != 0, &decl_var_instruction->base);
-        var->var_type = ira->codegen->builtin_types.entry_invalid;
+static IrInstruction *ir_analyze_bin_op_cmp(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
+    IrInstruction *op1 = bin_op_instruction->op1->child;
+    if (type_is_invalid(op1->value->type))
         return ira->codegen->invalid_instruction;
-    }
 
-    // The ir_build_var_decl_src call is supposed to pass a pointer to the allocation, not an initialization value.
-    ir_assert(var_ptr->value.type->id == ZigTypeIdPointer, &decl_var_instruction->base);
-
-    ZigType *result_type = var_ptr->value.type->data.pointer.child_type;
-    if (type_is_invalid(result_type)) {
-        result_type = ira->codegen->builtin_types.entry_invalid;
-    } else if (result_type->id == ZigTypeIdUnreachable || result_type->id == ZigTypeIdOpaque) {
-        zig_unreachable();
-    }
+    IrInstruction *op2 = bin_op_instruction->op2->child;
+    if (type_is_invalid(op2->value->type))
+        return ira->codegen->invalid_instruction;
 
-    ConstExprValue *init_val = nullptr;
-    if (instr_is_comptime(var_ptr) && var_ptr->value.data.x_ptr.mut != ConstPtrMutRuntimeVar) {
-        init_val = const_ptr_pointee(ira, ira->codegen, &var_ptr->value, decl_var_instruction->base.source_node);
-        if (is_comptime_var) {
-            if (var->gen_is_const) {
-                var->const_value = init_val;
-            } else {
-                var->const_value = create_const_vals(1);
-                copy_const_val(var->const_value, init_val, false);
-            }
-        }
-    }
+    AstNode *source_node = bin_op_instruction->base.source_node;
 
-    switch (type_requires_comptime(ira->codegen, result_type)) {
-    case ReqCompTimeInvalid:
-        result_type = ira->codegen->builtin_types.entry_invalid;
-        break;
-    case ReqCompTimeYes:
-        var_class_requires_const = true;
-        if (!var->gen_is_const && !is_comptime_var) {
-            ir_add_error_node(ira, source_node,
-                buf_sprintf("variable of type '%s' must be const or comptime",
-                    buf_ptr(&result_type->name)));
-            result_type = ira->codegen->builtin_types.entry_invalid;
+    IrBinOp op_id = bin_op_instruction->op_id;
+    bool is_equality_cmp = (op_id == IrBinOpCmpEq || op_id == IrBinOpCmpNotEq);
+    if (is_equality_cmp && op1->value->type->id == ZigTypeIdNull && op2->value->type->id == ZigTypeIdNull) {
+        return ir_const_bool(ira, &bin_op_instruction->base, (op_id == IrBinOpCmpEq));
+    } else if (is_equality_cmp &&
+        ((op1->value->type->id == ZigTypeIdNull && op2->value->type->id == ZigTypeIdOptional) ||
+        (op2->value->type->id == ZigTypeIdNull && op1->value->type->id == ZigTypeIdOptional)))
+    {
+        IrInstruction *maybe_op;
+        if (op1->value->type->id == ZigTypeIdNull) {
+            maybe_op = op2;
+        } else if (op2->value->type->id == ZigTypeIdNull) {
+            maybe_op = op1;
+        } else {
+            zig_unreachable();
         }
-        break;
-    case ReqCompTimeNo:
-        if (init_val != nullptr) {
-            if (init_val->special == ConstValSpecialStatic &&
-                init_val->type->id == ZigTypeIdFn &&
-                init_val->data.x_ptr.special != ConstPtrSpecialHardCodedAddr &&
-                init_val->data.x_ptr.data.fn.fn_entry->fn_inline == FnInlineAlways)
-            {
-                var_class_requires_const = true;
-                if (!var->src_is_const && !is_comptime_var) {
-                    ErrorMsg *msg = ir_add_error_node(ira, source_node,
-                        buf_sprintf("functions marked inline must be stored in const or comptime var"));
-                    AstNode *proto_node = init_val->data.x_ptr.data.fn.fn_entry->proto_node;
-                    add_error_note(ira->codegen, msg, proto_node, buf_sprintf("declared here"));
-                    result_type = ira->codegen->builtin_types.entry_invalid;
-                }
-            }
+        if (instr_is_comptime(maybe_op)) {
+            ConstExprValue *maybe_val = ir_resolve_const(ira, maybe_op, UndefBad);
+            if (!maybe_val)
+                return ira->codegen->invalid_instruction;
+            bool is_null = optional_value_is_null(maybe_val);
+            bool bool_result = (op_id == IrBinOpCmpEq) ? is_null : !is_null;
+            return ir_const_bool(ira, &bin_op_instruction->base, bool_result);
         }
-        break;
-    }
 
-    if (var->var_type != nullptr && !is_comptime_var) {
-        // This is at least the second time we've seen this variable declaration during analysis.
-        // This means that this is actually a different variable due to, e.g. an inline while loop.
-        // We make a new variable so that it can hold a different type, and so the debug info can
-        // be distinct.
-        ZigVar *new_var = create_local_var(ira->codegen, var->decl_node, var->child_scope,
-            &var->name, var->src_is_const, var->gen_is_const, var->shadowable, var->is_comptime, true);
-        new_var->owner_exec = var->owner_exec;
-        new_var->align_bytes = var->align_bytes;
-        if (var->mem_slot_index != SIZE_MAX) {
-            ConstExprValue *vals = create_const_vals(1);
-            new_var->mem_slot_index = ira->exec_context.mem_slot_list.length;
-            ira->exec_context.mem_slot_list.append(vals);
+        IrInstruction *is_non_null = ir_build_test_nonnull(&ira->new_irb, bin_op_instruction->base.scope,
+            source_node, maybe_op);
+        is_non_null->value->type = ira->codegen->builtin_types.entry_bool;
+
+        if (op_id == IrBinOpCmpEq) {
+            IrInstruction *result = ir_build_bool_not(&ira->new_irb, bin_op_instruction->base.scope,
+                bin_op_instruction->base.source_node, is_non_null);
+            result->value->type = ira->codegen->builtin_types.entry_bool;
+            return result;
+        } else {
+            return is_non_null;
+        }
+    } else if (is_equality_cmp &&
+        ((op1->value->type->id == ZigTypeIdNull && op2->value->type->id == ZigTypeIdPointer &&
+            op2->value->type->data.pointer.ptr_len == PtrLenC) ||
+        (op2->value->type->id == ZigTypeIdNull && op1->value->type->id == ZigTypeIdPointer &&
+            op1->value->type->data.pointer.ptr_len == PtrLenC)))
+    {
+        IrInstruction *c_ptr_op;
+        if (op1->value->type->id == ZigTypeIdNull) {
+            c_ptr_op = op2;
+        } else if (op2->value->type->id == ZigTypeIdNull) {
+            c_ptr_op = op1;
+        } else {
+            zig_unreachable();
+        }
+        if (instr_is_comptime(c_ptr_op)) {
+            ConstExprValue *c_ptr_val = ir_resolve_const(ira, c_ptr_op, UndefOk);
+            if (!c_ptr_val)
+                return ira->codegen->invalid_instruction;
+            if (c_ptr_val->special == ConstValSpecialUndef)
+                return ir_const_undef(ira, &bin_op_instruction->base, ira->codegen->builtin_types.entry_bool);
+            bool is_null = c_ptr_val->data.x_ptr.special == ConstPtrSpecialNull ||
+                (c_ptr_val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr &&
+                    c_ptr_val->data.x_ptr.data.hard_coded_addr.addr == 0);
+            bool bool_result = (op_id == IrBinOpCmpEq) ? is_null : !is_null;
+            return ir_const_bool(ira, &bin_op_instruction->base, bool_result);
         }
+        IrInstruction *is_non_null = ir_build_test_nonnull(&ira->new_irb, bin_op_instruction->base.scope,
+            source_node, c_ptr_op);
+        is_non_null->value->type = ira->codegen->builtin_types.entry_bool;
 
-        var->next_var = new_var;
-        var = new_var;
+        if (op_id == IrBinOpCmpEq) {
+            IrInstruction *result = ir_build_bool_not(&ira->new_irb, bin_op_instruction->base.scope,
+                bin_op_instruction->base.source_node, is_non_null);
+            result->value->type = ira->codegen->builtin_types.entry_bool;
+            return result;
+        } else {
+            return is_non_null;
+        }
+    } else if (op1->value->type->id == ZigTypeIdNull || op2->value->type->id == ZigTypeIdNull) {
+        ZigType *non_null_type = (op1->value->type->id == ZigTypeIdNull) ? op2->value->type : op1->value->type;
+        ir_add_error_node(ira, source_node, buf_sprintf("comparison of '%s' with null",
+            buf_ptr(&non_null_type->name)));
+        return ira->codegen->invalid_instruction;
     }
 
-    // This must be done after possibly creating a new variable above
-    var->ref_count = 0;
-
-    var->var_type = result_type;
-    assert(var->var_type);
-
-    if (type_is_invalid(result_type)) {
-        return ir_const_void(ira, &decl_var_instruction->base);
-    }
+    if (op1->value->type->id == ZigTypeIdErrorSet && op2->value->type->id == ZigTypeIdErrorSet) {
+        if (!is_equality_cmp) {
+            ir_add_error_node(ira, source_node, buf_sprintf("operator not allowed for errors"));
+            return ira->codegen->invalid_instruction;
+        }
+        ZigType *intersect_type = get_error_set_intersection(ira, op1->value->type, op2->value->type, source_node);
+        if (type_is_invalid(intersect_type)) {
+            return ira->codegen->invalid_instruction;
+        }
 
-    if (decl_var_instruction->align_value == nullptr) {
-        if ((err = type_resolve(ira->codegen, result_type, ResolveStatusAlignmentKnown))) {
-            var->var_type = ira->codegen->builtin_types.entry_invalid;
-            return ir_const_void(ira, &decl_var_instruction->base);
+        if (!resolve_inferred_error_set(ira->codegen, intersect_type, source_node)) {
+            return ira->codegen->invalid_instruction;
         }
-        var->align_bytes = get_abi_alignment(ira->codegen, result_type);
-    } else {
-        if (!ir_resolve_align(ira, decl_var_instruction->align_value->child, &var->align_bytes)) {
-            var->var_type = ira->codegen->builtin_types.entry_invalid;
+
+        // exception if one of the operators has the type of the empty error set, we allow the comparison
+        // (and make it comptime known)
+        // this is a function which is evaluated at comptime and returns an inferred error set will have an empty
+        // error set.
+        if (op1->value->type->data.error_set.err_count == 0 || op2->value->type->data.error_set.err_count == 0) {
+            bool are_equal = false;
+            bool answer;
+            if (op_id == IrBinOpCmpEq) {
+                answer = are_equal;
+            } else if (op_id == IrBinOpCmpNotEq) {
+                answer = !are_equal;
+            } else {
+                zig_unreachable();
+            }
+            return ir_const_bool(ira, &bin_op_instruction->base, answer);
         }
-    }
 
-    if (init_val != nullptr && init_val->special != ConstValSpecialRuntime) {
-        // Resolve ConstPtrMutInfer
-        if (var->gen_is_const) {
-            var_ptr->value.data.x_ptr.mut = ConstPtrMutComptimeConst;
-        } else if (is_comptime_var) {
-            var_ptr->value.data.x_ptr.mut = ConstPtrMutComptimeVar;
-        } else {
-            // we need a runtime ptr but we have a comptime val.
-            // since it's a comptime val there are no instructions for it.
-            // we memcpy the init value here
-            IrInstruction *deref = ir_get_deref(ira, var_ptr, var_ptr, nullptr);
-            // If this assertion trips, something is wrong with the IR instructions, because
-            // we expected the above deref to return a constant value, but it created a runtime
-            // instruction.
-            assert(deref->value.special != ConstValSpecialRuntime);
-            var_ptr->value.special = ConstValSpecialRuntime;
-            ir_analyze_store_ptr(ira, var_ptr, var_ptr, deref);
+        if (!type_is_global_error_set(intersect_type)) {
+            if (intersect_type->data.error_set.err_count == 0) {
+                ir_add_error_node(ira, source_node,
+                    buf_sprintf("error sets '%s' and '%s' have no common errors",
+                        buf_ptr(&op1->value->type->name), buf_ptr(&op2->value->type->name)));
+                return ira->codegen->invalid_instruction;
+            }
+            if (op1->value->type->data.error_set.err_count == 1 && op2->value->type->data.error_set.err_count == 1) {
+                bool are_equal = true;
+                bool answer;
+                if (op_id == IrBinOpCmpEq) {
+                    answer = are_equal;
+                } else if (op_id == IrBinOpCmpNotEq) {
+                    answer = !are_equal;
+                } else {
+                    zig_unreachable();
+                }
+                return ir_const_bool(ira, &bin_op_instruction->base, answer);
+            }
         }
 
-        if (var_ptr->value.special == ConstValSpecialStatic && var->mem_slot_index != SIZE_MAX) {
-            assert(var->mem_slot_index < ira->exec_context.mem_slot_list.length);
-            ConstExprValue *mem_slot = ira->exec_context.mem_slot_list.at(var->mem_slot_index);
-            copy_const_val(mem_slot, init_val, !is_comptime_var || var->gen_is_const);
+        if (instr_is_comptime(op1) && instr_is_comptime(op2)) {
+            ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
+            if (op1_val == nullptr)
+                return ira->codegen->invalid_instruction;
+            ConstExprValue *op2_val = ir_resolve_const(ira, op2, UndefBad);
+            if (op2_val == nullptr)
+                return ira->codegen->invalid_instruction;
 
-            if (is_comptime_var || (var_class_requires_const && var->gen_is_const)) {
-                return ir_const_void(ira, &decl_var_instruction->base);
+            bool answer;
+            bool are_equal = op1_val->data.x_err_set->value == op2_val->data.x_err_set->value;
+            if (op_id == IrBinOpCmpEq) {
+                answer = are_equal;
+            } else if (op_id == IrBinOpCmpNotEq) {
+                answer = !are_equal;
+            } else {
+                zig_unreachable();
             }
+
+            return ir_const_bool(ira, &bin_op_instruction->base, answer);
         }
-    } else if (is_comptime_var) {
-        ir_add_error(ira, &decl_var_instruction->base,
-                buf_sprintf("cannot store runtime value in compile time variable"));
-        var->var_type = ira->codegen->builtin_types.entry_invalid;
-        return ira->codegen->invalid_instruction;
+
+        IrInstruction *result = ir_build_bin_op(&ira->new_irb,
+                bin_op_instruction->base.scope, bin_op_instruction->base.source_node,
+                op_id, op1, op2, bin_op_instruction->safety_check_on);
+        result->value->type = ira->codegen->builtin_types.entry_bool;
+        return result;
     }
 
-    ZigFn *fn_entry = exec_fn_entry(ira->new_irb.exec);
-    if (fn_entry)
-        fn_entry->variable_list.append(var);
+    IrInstruction *instructions[] = {op1, op2};
+    ZigType *resolved_type = ir_resolve_peer_types(ira, source_node, nullptr, instructions, 2);
+    if (type_is_invalid(resolved_type))
+        return ira->codegen->invalid_instruction;
 
-    return ir_build_var_decl_gen(ira, &decl_var_instruction->base, var, var_ptr);
-}
+    bool operator_allowed;
+    switch (resolved_type->id) {
+        case ZigTypeIdInvalid:
+            zig_unreachable(); // handled above
 
-static IrInstruction *ir_analyze_instruction_export(IrAnalyze *ira, IrInstructionExport *instruction) {
-    IrInstruction *name = instruction->name->child;
-    Buf *symbol_name = ir_resolve_str(ira, name);
-    if (symbol_name == nullptr) {
+        case ZigTypeIdComptimeFloat:
+        case ZigTypeIdComptimeInt:
+        case ZigTypeIdInt:
+        case ZigTypeIdFloat:
+        case ZigTypeIdVector:
+            operator_allowed = true;
+            break;
+
+        case ZigTypeIdBool:
+        case ZigTypeIdMetaType:
+        case ZigTypeIdVoid:
+        case ZigTypeIdErrorSet:
+        case ZigTypeIdFn:
+        case ZigTypeIdOpaque:
+        case ZigTypeIdBoundFn:
+        case ZigTypeIdArgTuple:
+        case ZigTypeIdPromise:
+        case ZigTypeIdEnum:
+        case ZigTypeIdEnumLiteral:
+            operator_allowed = is_equality_cmp;
+            break;
+
+        case ZigTypeIdPointer:
+            operator_allowed = is_equality_cmp || (resolved_type->data.pointer.ptr_len == PtrLenC);
+            break;
+
+        case ZigTypeIdUnreachable:
+        case ZigTypeIdArray:
+        case ZigTypeIdStruct:
+        case ZigTypeIdUndefined:
+        case ZigTypeIdNull:
+        case ZigTypeIdErrorUnion:
+        case ZigTypeIdUnion:
+            operator_allowed = false;
+            break;
+        case ZigTypeIdOptional:
+            operator_allowed = is_equality_cmp && get_codegen_ptr_type(resolved_type) != nullptr;
+            break;
+    }
+    if (!operator_allowed) {
+        ir_add_error_node(ira, source_node,
+            buf_sprintf("operator not allowed for type '%s'", buf_ptr(&resolved_type->name)));
         return ira->codegen->invalid_instruction;
     }
 
-    IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type)) {
+    IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, resolved_type);
+    if (casted_op1 == ira->codegen->invalid_instruction)
         return ira->codegen->invalid_instruction;
-    }
 
-    GlobalLinkageId global_linkage_id = GlobalLinkageIdStrong;
-    if (instruction->linkage != nullptr) {
-        IrInstruction *linkage_value = instruction->linkage->child;
-        if (!ir_resolve_global_linkage(ira, linkage_value, &global_linkage_id)) {
+    IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, resolved_type);
+    if (casted_op2 == ira->codegen->invalid_instruction)
+        return ira->codegen->invalid_instruction;
+
+    bool one_possible_value;
+    switch (type_has_one_possible_value(ira->codegen, resolved_type)) {
+        case OnePossibleValueInvalid:
             return ira->codegen->invalid_instruction;
-        }
+        case OnePossibleValueYes:
+            one_possible_value = true;
+            break;
+        case OnePossibleValueNo:
+            one_possible_value = false;
+            break;
     }
 
-    // TODO: This function needs to be audited.
-    // It's not clear how all the different types are supposed to be handled.
-    // Need comprehensive tests for exporting one thing in one file and declaring an extern var
-    // in another file.
-    TldFn *tld_fn = allocate<TldFn>(1);
-    tld_fn->base.id = TldIdFn;
-    tld_fn->base.source_node = instruction->base.source_node;
+    if (one_possible_value || (instr_is_comptime(casted_op1) && instr_is_comptime(casted_op2))) {
+        ConstExprValue *op1_val = one_possible_value ? casted_op1->value : ir_resolve_const(ira, casted_op1, UndefBad);
+        if (op1_val == nullptr)
+            return ira->codegen->invalid_instruction;
+        ConstExprValue *op2_val = one_possible_value ? casted_op2->value : ir_resolve_const(ira, casted_op2, UndefBad);
+        if (op2_val == nullptr)
+            return ira->codegen->invalid_instruction;
 
-    auto entry = ira->codegen->exported_symbol_names.put_unique(symbol_name, &tld_fn->base);
-    if (entry) {
-        AstNode *other_export_node = entry->value->source_node;
-        ErrorMsg *msg = ir_add_error(ira, &instruction->base,
+        if (resolved_type->id == ZigTypeIdComptimeFloat || resolved_type->id == ZigTypeIdFloat) {
+            if (float_is_nan(op1_val) || float_is_nan(op2_val)) {
+                return ir_const_bool(ira, &bin_op_instruction->base, op_id == IrBinOpCmpNotEq);
+            }
+            Cmp cmp_result = float_cmp(op1_val, op2_val);
+            bool answer = resolve_cmp_op_id(op_id, cmp_result);
+            return ir_const_bool(ira, &bin_op_instruction->base, answer);
+        } else if (resolved_type->id == ZigTypeIdComptimeInt || resolved_type->id == ZigTypeIdInt) {
+            Cmp cmp_result = bigint_cmp(&op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            bool answer = resolve_cmp_op_id(op_id, cmp_result);
+            return ir_const_bool(ira, &bin_op_instruction->base, answer);
+        } else if (resolved_type->id == ZigTypeIdPointer && op_id != IrBinOpCmpEq && op_id != IrBinOpCmpNotEq) {
+            if ((op1_val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr ||
+                    op1_val->data.x_ptr.special == ConstPtrSpecialNull) &&
+                (op2_val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr ||
+                    op2_val->data.x_ptr.special == ConstPtrSpecialNull))
+            {
+                uint64_t op1_addr = op1_val->data.x_ptr.special == ConstPtrSpecialNull ?
+                    0 : op1_val->data.x_ptr.data.hard_coded_addr.addr;
+                uint64_t op2_addr = op2_val->data.x_ptr.special == ConstPtrSpecialNull ?
+                    0 : op2_val->data.x_ptr.data.hard_coded_addr.addr;
+                Cmp cmp_result;
+                if (op1_addr > op2_addr) {
+                    cmp_result = CmpGT;
+                } else if (op1_addr < op2_addr) {
+                    cmp_result = CmpLT;
+                } else {
+                    cmp_result = CmpEQ;
+                }
+                bool answer = resolve_cmp_op_id(op_id, cmp_result);
+                return ir_const_bool(ira, &bin_op_instruction->base, answer);
+            }
+        } else {
+            bool are_equal = one_possible_value || const_values_equal(ira->codegen, op1_val, op2_val);
+            bool answer;
+            if (op_id == IrBinOpCmpEq) {
+                answer = are_equal;
+            } else if (op_id == IrBinOpCmpNotEq) {
+                answer = !are_equal;
+            } else {
+                zig_unreachable();
+            }
+            return ir_const_bool(ira, &bin_op_instruction->base, answer);
+        }
+    }
+
+    // some comparisons with unsigned numbers can be evaluated
+    if (resolved_type->id == ZigTypeIdInt && !resolved_type->data.integral.is_signed) {
+        ConstExprValue *known_left_val;
+        IrBinOp flipped_op_id;
+        if (instr_is_comptime(casted_op1)) {
+            known_left_val = ir_resolve_const(ira, casted_op1, UndefBad);
+            if (known_left_val == nullptr)
+                return ira->codegen->invalid_instruction;
+
+            flipped_op_id = op_id;
+        } else if (instr_is_comptime(casted_op2)) {
+            known_left_val = ir_resolve_const(ira, casted_op2, UndefBad);
+            if (known_left_val == nullptr)
+                return ira->codegen->invalid_instruction;
+
+            if (op_id == IrBinOpCmpLessThan) {
+                flipped_op_id = IrBinOpCmpGreaterThan;
+            } else if (op_id == IrBinOpCmpGreaterThan) {
+                flipped_op_id = IrBinOpCmpLessThan;
+            } else if (op_id == IrBinOpCmpLessOrEq) {
+                flipped_op_id = IrBinOpCmpGreaterOrEq;
+            } else if (op_id == IrBinOpCmpGreaterOrEq) {
+                flipped_op_id = IrBinOpCmpLessOrEq;
+            } else {
+                flipped_op_id = op_id;
+            }
+        } else {
+            known_left_val = nullptr;
+        }
+        if (known_left_val != nullptr && bigint_cmp_zero(&known_left_val->data.x_bigint) == CmpEQ &&
+            (flipped_op_id == IrBinOpCmpLessOrEq || flipped_op_id == IrBinOpCmpGreaterThan))
+        {
+            bool answer = (flipped_op_id == IrBinOpCmpLessOrEq);
+            return ir_const_bool(ira, &bin_op_instruction->base, answer);
+        }
+    }
+
+    IrInstruction *result = ir_build_bin_op(&ira->new_irb,
+            bin_op_instruction->base.scope, bin_op_instruction->base.source_node,
+            op_id, casted_op1, casted_op2, bin_op_instruction->safety_check_on);
+    result->value->type = ira->codegen->builtin_types.entry_bool;
+    return result;
+}
+
+static ErrorMsg *ir_eval_math_op_scalar(IrAnalyze *ira, IrInstruction *source_instr, ZigType *type_entry,
+        ConstExprValue *op1_val, IrBinOp op_id, ConstExprValue *op2_val, ConstExprValue *out_val)
+{
+    bool is_int;
+    bool is_float;
+    Cmp op2_zcmp;
+    if (type_entry->id == ZigTypeIdInt || type_entry->id == ZigTypeIdComptimeInt) {
+        is_int = true;
+        is_float = false;
+        op2_zcmp = bigint_cmp_zero(&op2_val->data.x_bigint);
+    } else if (type_entry->id == ZigTypeIdFloat ||
+                type_entry->id == ZigTypeIdComptimeFloat)
+    {
+        is_int = false;
+        is_float = true;
+        op2_zcmp = float_cmp_zero(op2_val);
+    } else {
+        zig_unreachable();
+    }
+
+    if ((op_id == IrBinOpDivUnspecified || op_id == IrBinOpRemRem || op_id == IrBinOpRemMod ||
+        op_id == IrBinOpDivTrunc || op_id == IrBinOpDivFloor) && op2_zcmp == CmpEQ)
+    {
+        return ir_add_error(ira, source_instr, buf_sprintf("division by zero"));
+    }
+    if ((op_id == IrBinOpRemRem || op_id == IrBinOpRemMod) && op2_zcmp == CmpLT) {
+        return ir_add_error(ira, source_instr, buf_sprintf("negative denominator"));
+    }
+
+    switch (op_id) {
+        case IrBinOpInvalid:
+        case IrBinOpBoolOr:
+        case IrBinOpBoolAnd:
+        case IrBinOpCmpEq:
+        case IrBinOpCmpNotEq:
+        case IrBinOpCmpLessThan:
+        case IrBinOpCmpGreaterThan:
+        case IrBinOpCmpLessOrEq:
+        case IrBinOpCmpGreaterOrEq:
+        case IrBinOpArrayCat:
+        case IrBinOpArrayMult:
+        case IrBinOpRemUnspecified:
+        case IrBinOpMergeErrorSets:
+            zig_unreachable();
+        case IrBinOpBinOr:
+            assert(is_int);
+            bigint_or(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            break;
+        case IrBinOpBinXor:
+            assert(is_int);
+            bigint_xor(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            break;
+        case IrBinOpBinAnd:
+            assert(is_int);
+            bigint_and(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            break;
+        case IrBinOpBitShiftLeftExact:
+            assert(is_int);
+            bigint_shl(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            break;
+        case IrBinOpBitShiftLeftLossy:
+            assert(type_entry->id == ZigTypeIdInt);
+            bigint_shl_trunc(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint,
+                    type_entry->data.integral.bit_count, type_entry->data.integral.is_signed);
+            break;
+        case IrBinOpBitShiftRightExact:
+            {
+                assert(is_int);
+                bigint_shr(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+                BigInt orig_bigint;
+                bigint_shl(&orig_bigint, &out_val->data.x_bigint, &op2_val->data.x_bigint);
+                if (bigint_cmp(&op1_val->data.x_bigint, &orig_bigint) != CmpEQ) {
+                    return ir_add_error(ira, source_instr, buf_sprintf("exact shift shifted out 1 bits"));
+                }
+                break;
+            }
+        case IrBinOpBitShiftRightLossy:
+            assert(is_int);
+            bigint_shr(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            break;
+        case IrBinOpAdd:
+            if (is_int) {
+                bigint_add(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            } else {
+                float_add(out_val, op1_val, op2_val);
+            }
+            break;
+        case IrBinOpAddWrap:
+            assert(type_entry->id == ZigTypeIdInt);
+            bigint_add_wrap(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint,
+                    type_entry->data.integral.bit_count, type_entry->data.integral.is_signed);
+            break;
+        case IrBinOpSub:
+            if (is_int) {
+                bigint_sub(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            } else {
+                float_sub(out_val, op1_val, op2_val);
+            }
+            break;
+        case IrBinOpSubWrap:
+            assert(type_entry->id == ZigTypeIdInt);
+            bigint_sub_wrap(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint,
+                    type_entry->data.integral.bit_count, type_entry->data.integral.is_signed);
+            break;
+        case IrBinOpMult:
+            if (is_int) {
+                bigint_mul(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            } else {
+                float_mul(out_val, op1_val, op2_val);
+            }
+            break;
+        case IrBinOpMultWrap:
+            assert(type_entry->id == ZigTypeIdInt);
+            bigint_mul_wrap(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint,
+                    type_entry->data.integral.bit_count, type_entry->data.integral.is_signed);
+            break;
+        case IrBinOpDivUnspecified:
+            assert(is_float);
+            float_div(out_val, op1_val, op2_val);
+            break;
+        case IrBinOpDivTrunc:
+            if (is_int) {
+                bigint_div_trunc(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            } else {
+                float_div_trunc(out_val, op1_val, op2_val);
+            }
+            break;
+        case IrBinOpDivFloor:
+            if (is_int) {
+                bigint_div_floor(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            } else {
+                float_div_floor(out_val, op1_val, op2_val);
+            }
+            break;
+        case IrBinOpDivExact:
+            if (is_int) {
+                bigint_div_trunc(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+                BigInt remainder;
+                bigint_rem(&remainder, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+                if (bigint_cmp_zero(&remainder) != CmpEQ) {
+                    return ir_add_error(ira, source_instr, buf_sprintf("exact division had a remainder"));
+                }
+            } else {
+                float_div_trunc(out_val, op1_val, op2_val);
+                ConstExprValue remainder = {};
+                float_rem(&remainder, op1_val, op2_val);
+                if (float_cmp_zero(&remainder) != CmpEQ) {
+                    return ir_add_error(ira, source_instr, buf_sprintf("exact division had a remainder"));
+                }
+            }
+            break;
+        case IrBinOpRemRem:
+            if (is_int) {
+                bigint_rem(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            } else {
+                float_rem(out_val, op1_val, op2_val);
+            }
+            break;
+        case IrBinOpRemMod:
+            if (is_int) {
+                bigint_mod(&out_val->data.x_bigint, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+            } else {
+                float_mod(out_val, op1_val, op2_val);
+            }
+            break;
+    }
+
+    if (type_entry->id == ZigTypeIdInt) {
+        if (!bigint_fits_in_bits(&out_val->data.x_bigint, type_entry->data.integral.bit_count,
+                type_entry->data.integral.is_signed))
+        {
+            return ir_add_error(ira, source_instr, buf_sprintf("operation caused overflow"));
+        }
+    }
+
+    out_val->type = type_entry;
+    out_val->special = ConstValSpecialStatic;
+    return nullptr;
+}
+
+// This works on operands that have already been checked to be comptime known.
+static IrInstruction *ir_analyze_math_op(IrAnalyze *ira, IrInstruction *source_instr,
+        ZigType *type_entry, ConstExprValue *op1_val, IrBinOp op_id, ConstExprValue *op2_val)
+{
+    IrInstruction *result_instruction = ir_const(ira, source_instr, type_entry);
+    ConstExprValue *out_val = result_instruction->value;
+    if (type_entry->id == ZigTypeIdVector) {
+        expand_undef_array(ira->codegen, op1_val);
+        expand_undef_array(ira->codegen, op2_val);
+        out_val->special = ConstValSpecialUndef;
+        expand_undef_array(ira->codegen, out_val);
+        size_t len = type_entry->data.vector.len;
+        ZigType *scalar_type = type_entry->data.vector.elem_type;
+        for (size_t i = 0; i < len; i += 1) {
+            ConstExprValue *scalar_op1_val = &op1_val->data.x_array.data.s_none.elements[i];
+            ConstExprValue *scalar_op2_val = &op2_val->data.x_array.data.s_none.elements[i];
+            ConstExprValue *scalar_out_val = &out_val->data.x_array.data.s_none.elements[i];
+            assert(scalar_op1_val->type == scalar_type);
+            assert(scalar_op2_val->type == scalar_type);
+            assert(scalar_out_val->type == scalar_type);
+            ErrorMsg *msg = ir_eval_math_op_scalar(ira, source_instr, scalar_type,
+                    scalar_op1_val, op_id, scalar_op2_val, scalar_out_val);
+            if (msg != nullptr) {
+                add_error_note(ira->codegen, msg, source_instr->source_node,
+                    buf_sprintf("when computing vector element at index %" ZIG_PRI_usize, i));
+                return ira->codegen->invalid_instruction;
+            }
+        }
+        out_val->type = type_entry;
+        out_val->special = ConstValSpecialStatic;
+    } else {
+        if (ir_eval_math_op_scalar(ira, source_instr, type_entry, op1_val, op_id, op2_val, out_val) != nullptr) {
+            return ira->codegen->invalid_instruction;
+        }
+    }
+    return ir_implicit_cast(ira, result_instruction, type_entry);
+}
+
+static IrInstruction *ir_analyze_bit_shift(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
+    IrInstruction *op1 = bin_op_instruction->op1->child;
+    if (type_is_invalid(op1->value->type))
+        return ira->codegen->invalid_instruction;
+
+    if (op1->value->type->id != ZigTypeIdInt && op1->value->type->id != ZigTypeIdComptimeInt) {
+        ir_add_error(ira, &bin_op_instruction->base,
+            buf_sprintf("bit shifting operation expected integer type, found '%s'",
+                buf_ptr(&op1->value->type->name)));
+        return ira->codegen->invalid_instruction;
+    }
+
+    IrInstruction *op2 = bin_op_instruction->op2->child;
+    if (type_is_invalid(op2->value->type))
+        return ira->codegen->invalid_instruction;
+
+    IrInstruction *casted_op2;
+    IrBinOp op_id = bin_op_instruction->op_id;
+    if (op1->value->type->id == ZigTypeIdComptimeInt) {
+        casted_op2 = op2;
+
+        if (op_id == IrBinOpBitShiftLeftLossy) {
+            op_id = IrBinOpBitShiftLeftExact;
+        }
+
+        if (casted_op2->value->data.x_bigint.is_negative) {
+            Buf *val_buf = buf_alloc();
+            bigint_append_buf(val_buf, &casted_op2->value->data.x_bigint, 10);
+            ir_add_error(ira, casted_op2, buf_sprintf("shift by negative value %s", buf_ptr(val_buf)));
+            return ira->codegen->invalid_instruction;
+        }
+    } else {
+        ZigType *shift_amt_type = get_smallest_unsigned_int_type(ira->codegen,
+                op1->value->type->data.integral.bit_count - 1);
+        if (bin_op_instruction->op_id == IrBinOpBitShiftLeftLossy &&
+            op2->value->type->id == ZigTypeIdComptimeInt) {
+            if (!bigint_fits_in_bits(&op2->value->data.x_bigint,
+                                     shift_amt_type->data.integral.bit_count,
+                                     op2->value->data.x_bigint.is_negative)) {
+                Buf *val_buf = buf_alloc();
+                bigint_append_buf(val_buf, &op2->value->data.x_bigint, 10);
+                ErrorMsg* msg = ir_add_error(ira,
+                    &bin_op_instruction->base,
+                    buf_sprintf("RHS of shift is too large for LHS type"));
+                add_error_note(
+                    ira->codegen,
+                    msg,
+                    op2->source_node,
+                    buf_sprintf("value %s cannot fit into type %s",
+                        buf_ptr(val_buf),
+                        buf_ptr(&shift_amt_type->name)));
+                return ira->codegen->invalid_instruction;
+            }
+        }
+
+        casted_op2 = ir_implicit_cast(ira, op2, shift_amt_type);
+        if (casted_op2 == ira->codegen->invalid_instruction)
+            return ira->codegen->invalid_instruction;
+    }
+
+    if (instr_is_comptime(op1) && instr_is_comptime(casted_op2)) {
+        ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
+        if (op1_val == nullptr)
+            return ira->codegen->invalid_instruction;
+
+        ConstExprValue *op2_val = ir_resolve_const(ira, casted_op2, UndefBad);
+        if (op2_val == nullptr)
+            return ira->codegen->invalid_instruction;
+
+        return ir_analyze_math_op(ira, &bin_op_instruction->base, op1->value->type, op1_val, op_id, op2_val);
+    } else if (op1->value->type->id == ZigTypeIdComptimeInt) {
+        ir_add_error(ira, &bin_op_instruction->base,
+                buf_sprintf("LHS of shift must be an integer type, or RHS must be compile-time known"));
+        return ira->codegen->invalid_instruction;
+    } else if (instr_is_comptime(casted_op2) && bigint_cmp_zero(&casted_op2->value->data.x_bigint) == CmpEQ) {
+        IrInstruction *result = ir_build_cast(&ira->new_irb, bin_op_instruction->base.scope,
+                bin_op_instruction->base.source_node, op1->value->type, op1, CastOpNoop);
+        result->value->type = op1->value->type;
+        return result;
+    }
+
+    IrInstruction *result = ir_build_bin_op(&ira->new_irb, bin_op_instruction->base.scope,
+            bin_op_instruction->base.source_node, op_id,
+            op1, casted_op2, bin_op_instruction->safety_check_on);
+    result->value->type = op1->value->type;
+    return result;
+}
+
+static bool ok_float_op(IrBinOp op) {
+    switch (op) {
+        case IrBinOpInvalid:
+            zig_unreachable();
+        case IrBinOpAdd:
+        case IrBinOpSub:
+        case IrBinOpMult:
+        case IrBinOpDivUnspecified:
+        case IrBinOpDivTrunc:
+        case IrBinOpDivFloor:
+        case IrBinOpDivExact:
+        case IrBinOpRemRem:
+        case IrBinOpRemMod:
+            return true;
+
+        case IrBinOpBoolOr:
+        case IrBinOpBoolAnd:
+        case IrBinOpCmpEq:
+        case IrBinOpCmpNotEq:
+        case IrBinOpCmpLessThan:
+        case IrBinOpCmpGreaterThan:
+        case IrBinOpCmpLessOrEq:
+        case IrBinOpCmpGreaterOrEq:
+        case IrBinOpBinOr:
+        case IrBinOpBinXor:
+        case IrBinOpBinAnd:
+        case IrBinOpBitShiftLeftLossy:
+        case IrBinOpBitShiftLeftExact:
+        case IrBinOpBitShiftRightLossy:
+        case IrBinOpBitShiftRightExact:
+        case IrBinOpAddWrap:
+        case IrBinOpSubWrap:
+        case IrBinOpMultWrap:
+        case IrBinOpRemUnspecified:
+        case IrBinOpArrayCat:
+        case IrBinOpArrayMult:
+        case IrBinOpMergeErrorSets:
+            return false;
+    }
+    zig_unreachable();
+}
+
+static bool is_pointer_arithmetic_allowed(ZigType *lhs_type, IrBinOp op) {
+    if (lhs_type->id != ZigTypeIdPointer)
+        return false;
+    switch (op) {
+        case IrBinOpAdd:
+        case IrBinOpSub:
+            break;
+        default:
+            return false;
+    }
+    switch (lhs_type->data.pointer.ptr_len) {
+        case PtrLenSingle:
+            return false;
+        case PtrLenUnknown:
+        case PtrLenC:
+            break;
+    }
+    return true;
+}
+
+static IrInstruction *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp *instruction) {
+    Error err;
+
+    IrInstruction *op1 = instruction->op1->child;
+    if (type_is_invalid(op1->value->type))
+        return ira->codegen->invalid_instruction;
+
+    IrInstruction *op2 = instruction->op2->child;
+    if (type_is_invalid(op2->value->type))
+        return ira->codegen->invalid_instruction;
+
+    IrBinOp op_id = instruction->op_id;
+
+    // look for pointer math
+    if (is_pointer_arithmetic_allowed(op1->value->type, op_id)) {
+        IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, ira->codegen->builtin_types.entry_usize);
+        if (type_is_invalid(casted_op2->value->type))
+            return ira->codegen->invalid_instruction;
+
+        if (op1->value->special == ConstValSpecialUndef || casted_op2->value->special == ConstValSpecialUndef) {
+            IrInstruction *result = ir_const(ira, &instruction->base, op1->value->type);
+            result->value->special = ConstValSpecialUndef;
+            return result;
+        }
+        if (casted_op2->value->special == ConstValSpecialStatic && op1->value->special == ConstValSpecialStatic &&
+            (op1->value->data.x_ptr.special == ConstPtrSpecialHardCodedAddr ||
+            op1->value->data.x_ptr.special == ConstPtrSpecialNull))
+        {
+            uint64_t start_addr = (op1->value->data.x_ptr.special == ConstPtrSpecialNull) ?
+                0 : op1->value->data.x_ptr.data.hard_coded_addr.addr;
+            uint64_t elem_offset;
+            if (!ir_resolve_usize(ira, casted_op2, &elem_offset))
+                return ira->codegen->invalid_instruction;
+            ZigType *elem_type = op1->value->type->data.pointer.child_type;
+            if ((err = type_resolve(ira->codegen, elem_type, ResolveStatusSizeKnown)))
+                return ira->codegen->invalid_instruction;
+            uint64_t byte_offset = type_size(ira->codegen, elem_type) * elem_offset;
+            uint64_t new_addr;
+            if (op_id == IrBinOpAdd) {
+                new_addr = start_addr + byte_offset;
+            } else if (op_id == IrBinOpSub) {
+                new_addr = start_addr - byte_offset;
+            } else {
+                zig_unreachable();
+            }
+            IrInstruction *result = ir_const(ira, &instruction->base, op1->value->type);
+            result->value->data.x_ptr.special = ConstPtrSpecialHardCodedAddr;
+            result->value->data.x_ptr.mut = ConstPtrMutRuntimeVar;
+            result->value->data.x_ptr.data.hard_coded_addr.addr = new_addr;
+            return result;
+        }
+
+        IrInstruction *result = ir_build_bin_op(&ira->new_irb, instruction->base.scope,
+                instruction->base.source_node, op_id, op1, casted_op2, true);
+        result->value->type = op1->value->type;
+        return result;
+    }
+
+    IrInstruction *instructions[] = {op1, op2};
+    ZigType *resolved_type = ir_resolve_peer_types(ira, instruction->base.source_node, nullptr, instructions, 2);
+    if (type_is_invalid(resolved_type))
+        return ira->codegen->invalid_instruction;
+
+    bool is_int = resolved_type->id == ZigTypeIdInt || resolved_type->id == ZigTypeIdComptimeInt;
+    bool is_float = resolved_type->id == ZigTypeIdFloat || resolved_type->id == ZigTypeIdComptimeFloat;
+    bool is_signed_div = (
+        (resolved_type->id == ZigTypeIdInt && resolved_type->data.integral.is_signed) ||
+        resolved_type->id == ZigTypeIdFloat ||
+        (resolved_type->id == ZigTypeIdComptimeFloat &&
+            ((bigfloat_cmp_zero(&op1->value->data.x_bigfloat) != CmpGT) !=
+             (bigfloat_cmp_zero(&op2->value->data.x_bigfloat) != CmpGT))) ||
+        (resolved_type->id == ZigTypeIdComptimeInt &&
+            ((bigint_cmp_zero(&op1->value->data.x_bigint) != CmpGT) !=
+             (bigint_cmp_zero(&op2->value->data.x_bigint) != CmpGT)))
+    );
+    if (op_id == IrBinOpDivUnspecified && is_int) {
+        if (is_signed_div) {
+            bool ok = false;
+            if (instr_is_comptime(op1) && instr_is_comptime(op2)) {
+                ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
+                if (op1_val == nullptr)
+                    return ira->codegen->invalid_instruction;
+
+                ConstExprValue *op2_val = ir_resolve_const(ira, op2, UndefBad);
+                if (op2_val == nullptr)
+                    return ira->codegen->invalid_instruction;
+
+                if (bigint_cmp_zero(&op2_val->data.x_bigint) == CmpEQ) {
+                    // the division by zero error will be caught later, but we don't have a
+                    // division function ambiguity problem.
+                    op_id = IrBinOpDivTrunc;
+                    ok = true;
+                } else {
+                    BigInt trunc_result;
+                    BigInt floor_result;
+                    bigint_div_trunc(&trunc_result, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+                    bigint_div_floor(&floor_result, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+                    if (bigint_cmp(&trunc_result, &floor_result) == CmpEQ) {
+                        ok = true;
+                        op_id = IrBinOpDivTrunc;
+                    }
+                }
+            }
+            if (!ok) {
+                ir_add_error(ira, &instruction->base,
+                    buf_sprintf("division with '%s' and '%s': signed integers must use @divTrunc, @divFloor, or @divExact",
+                        buf_ptr(&op1->value->type->name),
+                        buf_ptr(&op2->value->type->name)));
+                return ira->codegen->invalid_instruction;
+            }
+        } else {
+            op_id = IrBinOpDivTrunc;
+        }
+    } else if (op_id == IrBinOpRemUnspecified) {
+        if (is_signed_div && (is_int || is_float)) {
+            bool ok = false;
+            if (instr_is_comptime(op1) && instr_is_comptime(op2)) {
+                ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
+                if (op1_val == nullptr)
+                    return ira->codegen->invalid_instruction;
+
+                if (is_int) {
+                    ConstExprValue *op2_val = ir_resolve_const(ira, op2, UndefBad);
+                    if (op2_val == nullptr)
+                        return ira->codegen->invalid_instruction;
+
+                    if (bigint_cmp_zero(&op2->value->data.x_bigint) == CmpEQ) {
+                        // the division by zero error will be caught later, but we don't
+                        // have a remainder function ambiguity problem
+                        ok = true;
+                    } else {
+                        BigInt rem_result;
+                        BigInt mod_result;
+                        bigint_rem(&rem_result, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+                        bigint_mod(&mod_result, &op1_val->data.x_bigint, &op2_val->data.x_bigint);
+                        ok = bigint_cmp(&rem_result, &mod_result) == CmpEQ;
+                    }
+                } else {
+                    IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, resolved_type);
+                    if (casted_op2 == ira->codegen->invalid_instruction)
+                        return ira->codegen->invalid_instruction;
+
+                    ConstExprValue *op2_val = ir_resolve_const(ira, casted_op2, UndefBad);
+                    if (op2_val == nullptr)
+                        return ira->codegen->invalid_instruction;
+
+                    if (float_cmp_zero(casted_op2->value) == CmpEQ) {
+                        // the division by zero error will be caught later, but we don't
+                        // have a remainder function ambiguity problem
+                        ok = true;
+                    } else {
+                        ConstExprValue rem_result = {};
+                        ConstExprValue mod_result = {};
+                        float_rem(&rem_result, op1_val, op2_val);
+                        float_mod(&mod_result, op1_val, op2_val);
+                        ok = float_cmp(&rem_result, &mod_result) == CmpEQ;
+                    }
+                }
+            }
+            if (!ok) {
+                ir_add_error(ira, &instruction->base,
+                    buf_sprintf("remainder division with '%s' and '%s': signed integers and floats must use @rem or @mod",
+                        buf_ptr(&op1->value->type->name),
+                        buf_ptr(&op2->value->type->name)));
+                return ira->codegen->invalid_instruction;
+            }
+        }
+        op_id = IrBinOpRemRem;
+    }
+
+    bool ok = false;
+    if (is_int) {
+        ok = true;
+    } else if (is_float && ok_float_op(op_id)) {
+        ok = true;
+    } else if (resolved_type->id == ZigTypeIdVector) {
+        ZigType *elem_type = resolved_type->data.vector.elem_type;
+        if (elem_type->id == ZigTypeIdInt || elem_type->id == ZigTypeIdComptimeInt) {
+            ok = true;
+        } else if ((elem_type->id == ZigTypeIdFloat || elem_type->id == ZigTypeIdComptimeFloat) && ok_float_op(op_id)) {
+            ok = true;
+        }
+    }
+    if (!ok) {
+        AstNode *source_node = instruction->base.source_node;
+        ir_add_error_node(ira, source_node,
+            buf_sprintf("invalid operands to binary expression: '%s' and '%s'",
+                buf_ptr(&op1->value->type->name),
+                buf_ptr(&op2->value->type->name)));
+        return ira->codegen->invalid_instruction;
+    }
+
+    if (resolved_type->id == ZigTypeIdComptimeInt) {
+        if (op_id == IrBinOpAddWrap) {
+            op_id = IrBinOpAdd;
+        } else if (op_id == IrBinOpSubWrap) {
+            op_id = IrBinOpSub;
+        } else if (op_id == IrBinOpMultWrap) {
+            op_id = IrBinOpMult;
+        }
+    }
+
+    IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, resolved_type);
+    if (casted_op1 == ira->codegen->invalid_instruction)
+        return ira->codegen->invalid_instruction;
+
+    IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, resolved_type);
+    if (casted_op2 == ira->codegen->invalid_instruction)
+        return ira->codegen->invalid_instruction;
+
+    if (instr_is_comptime(casted_op1) && instr_is_comptime(casted_op2)) {
+        ConstExprValue *op1_val = ir_resolve_const(ira, casted_op1, UndefBad);
+        if (op1_val == nullptr)
+            return ira->codegen->invalid_instruction;
+        ConstExprValue *op2_val = ir_resolve_const(ira, casted_op2, UndefBad);
+        if (op2_val == nullptr)
+            return ira->codegen->invalid_instruction;
+
+        return ir_analyze_math_op(ira, &instruction->base, resolved_type, op1_val, op_id, op2_val);
+    }
+
+    IrInstruction *result = ir_build_bin_op(&ira->new_irb, instruction->base.scope,
+            instruction->base.source_node, op_id, casted_op1, casted_op2, instruction->safety_check_on);
+    result->value->type = resolved_type;
+    return result;
+}
+
+static IrInstruction *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *instruction) {
+    IrInstruction *op1 = instruction->op1->child;
+    ZigType *op1_type = op1->value->type;
+    if (type_is_invalid(op1_type))
+        return ira->codegen->invalid_instruction;
+
+    IrInstruction *op2 = instruction->op2->child;
+    ZigType *op2_type = op2->value->type;
+    if (type_is_invalid(op2_type))
+        return ira->codegen->invalid_instruction;
+
+    ConstExprValue *op1_val = ir_resolve_const(ira, op1, UndefBad);
+    if (!op1_val)
+        return ira->codegen->invalid_instruction;
+
+    ConstExprValue *op2_val = ir_resolve_const(ira, op2, UndefBad);
+    if (!op2_val)
+        return ira->codegen->invalid_instruction;
+
+    ConstExprValue *op1_array_val;
+    size_t op1_array_index;
+    size_t op1_array_end;
+    ZigType *child_type;
+    if (op1_type->id == ZigTypeIdArray) {
+        child_type = op1_type->data.array.child_type;
+        op1_array_val = op1_val;
+        op1_array_index = 0;
+        op1_array_end = op1_type->data.array.len;
+    } else if (op1_type->id == ZigTypeIdPointer &&
+        op1_type->data.pointer.child_type == ira->codegen->builtin_types.entry_u8 &&
+        op1_val->data.x_ptr.special == ConstPtrSpecialBaseArray &&
+        op1_val->data.x_ptr.data.base_array.is_cstr)
+    {
+        child_type = op1_type->data.pointer.child_type;
+        op1_array_val = op1_val->data.x_ptr.data.base_array.array_val;
+        op1_array_index = op1_val->data.x_ptr.data.base_array.elem_index;
+        op1_array_end = op1_array_val->type->data.array.len - 1;
+    } else if (is_slice(op1_type)) {
+        ZigType *ptr_type = op1_type->data.structure.fields[slice_ptr_index].type_entry;
+        child_type = ptr_type->data.pointer.child_type;
+        ConstExprValue *ptr_val = &op1_val->data.x_struct.fields[slice_ptr_index];
+        assert(ptr_val->data.x_ptr.special == ConstPtrSpecialBaseArray);
+        op1_array_val = ptr_val->data.x_ptr.data.base_array.array_val;
+        op1_array_index = ptr_val->data.x_ptr.data.base_array.elem_index;
+        ConstExprValue *len_val = &op1_val->data.x_struct.fields[slice_len_index];
+        op1_array_end = op1_array_index + bigint_as_unsigned(&len_val->data.x_bigint);
+    } else {
+        ir_add_error(ira, op1,
+            buf_sprintf("expected array or C string literal, found '%s'", buf_ptr(&op1->value->type->name)));
+        return ira->codegen->invalid_instruction;
+    }
+
+    ConstExprValue *op2_array_val;
+    size_t op2_array_index;
+    size_t op2_array_end;
+    bool op2_type_valid;
+    if (op2_type->id == ZigTypeIdArray) {
+        op2_type_valid = op2_type->data.array.child_type == child_type;
+        op2_array_val = op2_val;
+        op2_array_index = 0;
+        op2_array_end = op2_array_val->type->data.array.len;
+    } else if (op2_type->id == ZigTypeIdPointer &&
+        op2_type->data.pointer.child_type == ira->codegen->builtin_types.entry_u8 &&
+        op2_val->data.x_ptr.special == ConstPtrSpecialBaseArray &&
+        op2_val->data.x_ptr.data.base_array.is_cstr)
+    {
+        op2_type_valid = child_type == ira->codegen->builtin_types.entry_u8;
+        op2_array_val = op2_val->data.x_ptr.data.base_array.array_val;
+        op2_array_index = op2_val->data.x_ptr.data.base_array.elem_index;
+        op2_array_end = op2_array_val->type->data.array.len - 1;
+    } else if (is_slice(op2_type)) {
+        ZigType *ptr_type = op2_type->data.structure.fields[slice_ptr_index].type_entry;
+        op2_type_valid = ptr_type->data.pointer.child_type == child_type;
+        ConstExprValue *ptr_val = &op2_val->data.x_struct.fields[slice_ptr_index];
+        assert(ptr_val->data.x_ptr.special == ConstPtrSpecialBaseArray);
+        op2_array_val = ptr_val->data.x_ptr.data.base_array.array_val;
+        op2_array_index = ptr_val->data.x_ptr.data.base_array.elem_index;
+        ConstExprValue *len_val = &op2_val->data.x_struct.fields[slice_len_index];
+        op2_array_end = op2_array_index + bigint_as_unsigned(&len_val->data.x_bigint);
+    } else {
+        ir_add_error(ira, op2,
+            buf_sprintf("expected array or C string literal, found '%s'", buf_ptr(&op2->value->type->name)));
+        return ira->codegen->invalid_instruction;
+    }
+    if (!op2_type_valid) {
+        ir_add_error(ira, op2, buf_sprintf("expected array of type '%s', found '%s'",
+                    buf_ptr(&child_type->name),
+                    buf_ptr(&op2->value->type->name)));
+        return ira->codegen->invalid_instruction;
+    }
+
+    // The type of result is populated in the following if blocks
+    IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
+    ConstExprValue *out_val = result->value;
+
+    ConstExprValue *out_array_val;
+    size_t new_len = (op1_array_end - op1_array_index) + (op2_array_end - op2_array_index);
+    if (op1_type->id == ZigTypeIdArray || op2_type->id == ZigTypeIdArray) {
+        result->value->type = get_array_type(ira->codegen, child_type, new_len);
+
+        out_array_val = out_val;
+    } else if (is_slice(op1_type) || is_slice(op2_type)) {
+        ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, child_type,
+                true, false, PtrLenUnknown, 0, 0, 0, false);
+        result->value->type = get_slice_type(ira->codegen, ptr_type);
+        out_array_val = create_const_vals(1);
+        out_array_val->special = ConstValSpecialStatic;
+        out_array_val->type = get_array_type(ira->codegen, child_type, new_len);
+
+        out_val->data.x_struct.fields = create_const_vals(2);
+
+        out_val->data.x_struct.fields[slice_ptr_index].type = ptr_type;
+        out_val->data.x_struct.fields[slice_ptr_index].special = ConstValSpecialStatic;
+        out_val->data.x_struct.fields[slice_ptr_index].data.x_ptr.special = ConstPtrSpecialBaseArray;
+        out_val->data.x_struct.fields[slice_ptr_index].data.x_ptr.data.base_array.array_val = out_array_val;
+        out_val->data.x_struct.fields[slice_ptr_index].data.x_ptr.data.base_array.elem_index = 0;
+
+        out_val->data.x_struct.fields[slice_len_index].type = ira->codegen->builtin_types.entry_usize;
+        out_val->data.x_struct.fields[slice_len_index].special = ConstValSpecialStatic;
+        bigint_init_unsigned(&out_val->data.x_struct.fields[slice_len_index].data.x_bigint, new_len);
+    } else {
+        new_len += 1; // null byte
+
+        // TODO make this `[*]null T` instead of `[*]T`
+        result->value->type = get_pointer_to_type_extra(ira->codegen, child_type, true, false, PtrLenUnknown, 0, 0, 0, false);
+
+        out_array_val = create_const_vals(1);
+        out_array_val->special = ConstValSpecialStatic;
+        out_array_val->type = get_array_type(ira->codegen, child_type, new_len);
+        out_val->data.x_ptr.special = ConstPtrSpecialBaseArray;
+        out_val->data.x_ptr.data.base_array.is_cstr = true;
+        out_val->data.x_ptr.data.base_array.array_val = out_array_val;
+        out_val->data.x_ptr.data.base_array.elem_index = 0;
+    }
+
+    if (op1_array_val->data.x_array.special == ConstArraySpecialUndef &&
+        op2_array_val->data.x_array.special == ConstArraySpecialUndef) {
+        out_array_val->data.x_array.special = ConstArraySpecialUndef;
+        return result;
+    }
+
+    if (op1_array_val->special == ConstValSpecialStatic &&
+        op1_array_val->data.x_array.special == ConstArraySpecialBuf &&
+        op2_array_val->special == ConstValSpecialStatic &&
+        op2_array_val->data.x_array.special == ConstArraySpecialBuf)
+    {
+        Buf *bytes = buf_alloc();
+        buf_append_mem(bytes, buf_ptr(op1_array_val->data.x_array.data.s_buf) + op1_array_index,
+                op1_array_end - op1_array_index);
+        buf_append_mem(bytes, buf_ptr(op2_array_val->data.x_array.data.s_buf) + op2_array_index,
+                op2_array_end - op2_array_index);
+        if (buf_len(bytes) < new_len) {
+            // null byte
+            buf_append_char(bytes, 0);
+        }
+        assert(buf_len(bytes) == new_len);
+        out_array_val->data.x_array.special = ConstArraySpecialBuf;
+        out_array_val->data.x_array.data.s_buf = bytes;
+        return result;
+    }
+
+    out_array_val->data.x_array.data.s_none.elements = create_const_vals(new_len);
+    expand_undef_array(ira->codegen, op1_array_val);
+    expand_undef_array(ira->codegen, op2_array_val);
+
+    size_t next_index = 0;
+    for (size_t i = op1_array_index; i < op1_array_end; i += 1, next_index += 1) {
+        copy_const_val(&out_array_val->data.x_array.data.s_none.elements[next_index],
+                &op1_array_val->data.x_array.data.s_none.elements[i], true);
+    }
+    for (size_t i = op2_array_index; i < op2_array_end; i += 1, next_index += 1) {
+        copy_const_val(&out_array_val->data.x_array.data.s_none.elements[next_index],
+                &op2_array_val->data.x_array.data.s_none.elements[i], true);
+    }
+    if (next_index < new_len) {
+        ConstExprValue *null_byte = &out_array_val->data.x_array.data.s_none.elements[next_index];
+        init_const_unsigned_negative(null_byte, child_type, 0, false);
+        next_index += 1;
+    }
+    assert(next_index == new_len);
+
+    return result;
+}
+
+static IrInstruction *ir_analyze_array_mult(IrAnalyze *ira, IrInstructionBinOp *instruction) {
+    IrInstruction *op1 = instruction->op1->child;
+    if (type_is_invalid(op1->value->type))
+        return ira->codegen->invalid_instruction;
+
+    IrInstruction *op2 = instruction->op2->child;
+    if (type_is_invalid(op2->value->type))
+        return ira->codegen->invalid_instruction;
+
+    ConstExprValue *array_val = ir_resolve_const(ira, op1, UndefBad);
+    if (!array_val)
+        return ira->codegen->invalid_instruction;
+
+    uint64_t mult_amt;
+    if (!ir_resolve_usize(ira, op2, &mult_amt))
+        return ira->codegen->invalid_instruction;
+
+    ZigType *array_type = op1->value->type;
+    if (array_type->id != ZigTypeIdArray) {
+        ir_add_error(ira, op1, buf_sprintf("expected array type, found '%s'", buf_ptr(&op1->value->type->name)));
+        return ira->codegen->invalid_instruction;
+    }
+
+    uint64_t old_array_len = array_type->data.array.len;
+    uint64_t new_array_len;
+
+    if (mul_u64_overflow(old_array_len, mult_amt, &new_array_len))
+    {
+        ir_add_error(ira, &instruction->base, buf_sprintf("operation results in overflow"));
+        return ira->codegen->invalid_instruction;
+    }
+
+    ZigType *child_type = array_type->data.array.child_type;
+
+    IrInstruction *result = ir_const(ira, &instruction->base,
+        get_array_type(ira->codegen, child_type, new_array_len));
+    ConstExprValue *out_val = result->value;
+    if (array_val->data.x_array.special == ConstArraySpecialUndef) {
+        out_val->data.x_array.special = ConstArraySpecialUndef;
+        return result;
+    }
+
+    if (array_val->data.x_array.special == ConstArraySpecialBuf) {
+        Buf *src_bytes = array_val->data.x_array.data.s_buf;
+        Buf *bytes = buf_alloc();
+        buf_resize(bytes, new_array_len);
+        for (uint64_t x = 0; x < mult_amt; x += 1) {
+            memcpy(buf_ptr(bytes) + x * old_array_len, buf_ptr(src_bytes), old_array_len);
+        }
+        out_val->data.x_array.special = ConstArraySpecialBuf;
+        out_val->data.x_array.data.s_buf = bytes;
+        return result;
+    }
+
+    expand_undef_array(ira->codegen, array_val);
+    out_val->data.x_array.data.s_none.elements = create_const_vals(new_array_len);
+
+    uint64_t i = 0;
+    for (uint64_t x = 0; x < mult_amt; x += 1) {
+        for (uint64_t y = 0; y < old_array_len; y += 1) {
+            copy_const_val(&out_val->data.x_array.data.s_none.elements[i],
+                &array_val->data.x_array.data.s_none.elements[y], false);
+            i += 1;
+        }
+    }
+    assert(i == new_array_len);
+
+    return result;
+}
+
+static IrInstruction *ir_analyze_merge_error_sets(IrAnalyze *ira, IrInstructionBinOp *instruction) {
+    ZigType *op1_type = ir_resolve_error_set_type(ira, &instruction->base, instruction->op1->child);
+    if (type_is_invalid(op1_type))
+        return ira->codegen->invalid_instruction;
+
+    ZigType *op2_type = ir_resolve_error_set_type(ira, &instruction->base, instruction->op2->child);
+    if (type_is_invalid(op2_type))
+        return ira->codegen->invalid_instruction;
+
+    if (type_is_global_error_set(op1_type) ||
+        type_is_global_error_set(op2_type))
+    {
+        return ir_const_type(ira, &instruction->base, ira->codegen->builtin_types.entry_global_error_set);
+    }
+
+    if (!resolve_inferred_error_set(ira->codegen, op1_type, instruction->op1->child->source_node)) {
+        return ira->codegen->invalid_instruction;
+    }
+
+    if (!resolve_inferred_error_set(ira->codegen, op2_type, instruction->op2->child->source_node)) {
+        return ira->codegen->invalid_instruction;
+    }
+
+    ErrorTableEntry **errors = allocate<ErrorTableEntry *>(ira->codegen->errors_by_index.length);
+    for (uint32_t i = 0, count = op1_type->data.error_set.err_count; i < count; i += 1) {
+        ErrorTableEntry *error_entry = op1_type->data.error_set.errors[i];
+        assert(errors[error_entry->value] == nullptr);
+        errors[error_entry->value] = error_entry;
+    }
+    ZigType *result_type = get_error_set_union(ira->codegen, errors, op1_type, op2_type);
+    free(errors);
+
+    return ir_const_type(ira, &instruction->base, result_type);
+}
+
+static IrInstruction *ir_analyze_instruction_bin_op(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
+    IrBinOp op_id = bin_op_instruction->op_id;
+    switch (op_id) {
+        case IrBinOpInvalid:
+            zig_unreachable();
+        case IrBinOpBoolOr:
+        case IrBinOpBoolAnd:
+            return ir_analyze_bin_op_bool(ira, bin_op_instruction);
+        case IrBinOpCmpEq:
+        case IrBinOpCmpNotEq:
+        case IrBinOpCmpLessThan:
+        case IrBinOpCmpGreaterThan:
+        case IrBinOpCmpLessOrEq:
+        case IrBinOpCmpGreaterOrEq:
+            return ir_analyze_bin_op_cmp(ira, bin_op_instruction);
+        case IrBinOpBitShiftLeftLossy:
+        case IrBinOpBitShiftLeftExact:
+        case IrBinOpBitShiftRightLossy:
+        case IrBinOpBitShiftRightExact:
+            return ir_analyze_bit_shift(ira, bin_op_instruction);
+        case IrBinOpBinOr:
+        case IrBinOpBinXor:
+        case IrBinOpBinAnd:
+        case IrBinOpAdd:
+        case IrBinOpAddWrap:
+        case IrBinOpSub:
+        case IrBinOpSubWrap:
+        case IrBinOpMult:
+        case IrBinOpMultWrap:
+        case IrBinOpDivUnspecified:
+        case IrBinOpDivTrunc:
+        case IrBinOpDivFloor:
+        case IrBinOpDivExact:
+        case IrBinOpRemUnspecified:
+        case IrBinOpRemRem:
+        case IrBinOpRemMod:
+            return ir_analyze_bin_op_math(ira, bin_op_instruction);
+        case IrBinOpArrayCat:
+            return ir_analyze_array_cat(ira, bin_op_instruction);
+        case IrBinOpArrayMult:
+            return ir_analyze_array_mult(ira, bin_op_instruction);
+        case IrBinOpMergeErrorSets:
+            return ir_analyze_merge_error_sets(ira, bin_op_instruction);
+    }
+    zig_unreachable();
+}
+
+static IrInstruction *ir_analyze_instruction_decl_var(IrAnalyze *ira,
+        IrInstructionDeclVarSrc *decl_var_instruction)
+{
+    Error err;
+    ZigVar *var = decl_var_instruction->var;
+
+    ZigType *explicit_type = nullptr;
+    IrInstruction *var_type = nullptr;
+    if (decl_var_instruction->var_type != nullptr) {
+        var_type = decl_var_instruction->var_type->child;
+        ZigType *proposed_type = ir_resolve_type(ira, var_type);
+        explicit_type = validate_var_type(ira->codegen, var_type->source_node, proposed_type);
+        if (type_is_invalid(explicit_type)) {
+            var->var_type = ira->codegen->builtin_types.entry_invalid;
+            return ira->codegen->invalid_instruction;
+        }
+    }
+
+    AstNode *source_node = decl_var_instruction->base.source_node;
+
+    bool is_comptime_var = ir_get_var_is_comptime(var);
+
+    bool var_class_requires_const = false;
+
+    IrInstruction *var_ptr = decl_var_instruction->ptr->child;
+    // if this is null, a compiler error happened and did not initialize the variable.
+    // if there are no compile errors there may be a missing ir_expr_wrap in pass1 IR generation.
+    if (var_ptr == nullptr || type_is_invalid(var_ptr->value->type)) {
+        ir_assert(var_ptr != nullptr || ira->codegen->errors.length != 0, &decl_var_instruction->base);
+        var->var_type = ira->codegen->builtin_types.entry_invalid;
+        return ira->codegen->invalid_instruction;
+    }
+
+    // The ir_build_var_decl_src call is supposed to pass a pointer to the allocation, not an initialization value.
+    ir_assert(var_ptr->value->type->id == ZigTypeIdPointer, &decl_var_instruction->base);
+
+    ZigType *result_type = var_ptr->value->type->data.pointer.child_type;
+    if (type_is_invalid(result_type)) {
+        result_type = ira->codegen->builtin_types.entry_invalid;
+    } else if (result_type->id == ZigTypeIdUnreachable || result_type->id == ZigTypeIdOpaque) {
+        zig_unreachable();
+    }
+
+    ConstExprValue *init_val = nullptr;
+    if (instr_is_comptime(var_ptr) && var_ptr->value->data.x_ptr.mut != ConstPtrMutRuntimeVar) {
+        init_val = const_ptr_pointee(ira, ira->codegen, var_ptr->value, decl_var_instruction->base.source_node);
+        if (is_comptime_var) {
+            if (var->gen_is_const) {
+                var->const_value = init_val;
+            } else {
+                var->const_value = create_const_vals(1);
+                copy_const_val(var->const_value, init_val, false);
+            }
+        }
+    }
+
+    switch (type_requires_comptime(ira->codegen, result_type)) {
+    case ReqCompTimeInvalid:
+        result_type = ira->codegen->builtin_types.entry_invalid;
+        break;
+    case ReqCompTimeYes:
+        var_class_requires_const = true;
+        if (!var->gen_is_const && !is_comptime_var) {
+            ir_add_error_node(ira, source_node,
+                buf_sprintf("variable of type '%s' must be const or comptime",
+                    buf_ptr(&result_type->name)));
+            result_type = ira->codegen->builtin_types.entry_invalid;
+        }
+        break;
+    case ReqCompTimeNo:
+        if (init_val != nullptr) {
+            if (init_val->special == ConstValSpecialStatic &&
+                init_val->type->id == ZigTypeIdFn &&
+                init_val->data.x_ptr.special != ConstPtrSpecialHardCodedAddr &&
+                init_val->data.x_ptr.data.fn.fn_entry->fn_inline == FnInlineAlways)
+            {
+                var_class_requires_const = true;
+                if (!var->src_is_const && !is_comptime_var) {
+                    ErrorMsg *msg = ir_add_error_node(ira, source_node,
+                        buf_sprintf("functions marked inline must be stored in const or comptime var"));
+                    AstNode *proto_node = init_val->data.x_ptr.data.fn.fn_entry->proto_node;
+                    add_error_note(ira->codegen, msg, proto_node, buf_sprintf("declared here"));
+                    result_type = ira->codegen->builtin_types.entry_invalid;
+                }
+            }
+        }
+        break;
+    }
+
+    if (var->var_type != nullptr && !is_comptime_var) {
+        // This is at least the second time we've seen this variable declaration during analysis.
+        // This means that this is actually a different variable due to, e.g. an inline while loop.
+        // We make a new variable so that it can hold a different type, and so the debug info can
+        // be distinct.
+        ZigVar *new_var = create_local_var(ira->codegen, var->decl_node, var->child_scope,
+            &var->name, var->src_is_const, var->gen_is_const, var->shadowable, var->is_comptime, true);
+        new_var->owner_exec = var->owner_exec;
+        new_var->align_bytes = var->align_bytes;
+        if (var->mem_slot_index != SIZE_MAX) {
+            ConstExprValue *vals = create_const_vals(1);
+            new_var->mem_slot_index = ira->exec_context.mem_slot_list.length;
+            ira->exec_context.mem_slot_list.append(vals);
+        }
+
+        var->next_var = new_var;
+        var = new_var;
+    }
+
+    // This must be done after possibly creating a new variable above
+    var->ref_count = 0;
+
+    var->var_type = result_type;
+    assert(var->var_type);
+
+    if (type_is_invalid(result_type)) {
+        return ir_const_void(ira, &decl_var_instruction->base);
+    }
+
+    if (decl_var_instruction->align_value == nullptr) {
+        if ((err = type_resolve(ira->codegen, result_type, ResolveStatusAlignmentKnown))) {
+            var->var_type = ira->codegen->builtin_types.entry_invalid;
+            return ir_const_void(ira, &decl_var_instruction->base);
+        }
+        var->align_bytes = get_abi_alignment(ira->codegen, result_type);
+    } else {
+        if (!ir_resolve_align(ira, decl_var_instruction->align_value->child, &var->align_bytes)) {
+            var->var_type = ira->codegen->builtin_types.entry_invalid;
+        }
+    }
+
+    if (init_val != nullptr && init_val->special != ConstValSpecialRuntime) {
+        // Resolve ConstPtrMutInfer
+        if (var->gen_is_const) {
+            var_ptr->value->data.x_ptr.mut = ConstPtrMutComptimeConst;
+        } else if (is_comptime_var) {
+            var_ptr->value->data.x_ptr.mut = ConstPtrMutComptimeVar;
+        } else {
+            // we need a runtime ptr but we have a comptime val.
+            // since it's a comptime val there are no instructions for it.
+            // we memcpy the init value here
+            IrInstruction *deref = ir_get_deref(ira, var_ptr, var_ptr, nullptr);
+            // If this assertion trips, something is wrong with the IR instructions, because
+            // we expected the above deref to return a constant value, but it created a runtime
+            // instruction.
+            assert(deref->value->special != ConstValSpecialRuntime);
+            var_ptr->value->special = ConstValSpecialRuntime;
+            ir_analyze_store_ptr(ira, var_ptr, var_ptr, deref);
+        }
+
+        if (var_ptr->value->special == ConstValSpecialStatic && var->mem_slot_index != SIZE_MAX) {
+            assert(var->mem_slot_index < ira->exec_context.mem_slot_list.length);
+            ConstExprValue *mem_slot = ira->exec_context.mem_slot_list.at(var->mem_slot_index);
+            copy_const_val(mem_slot, init_val, !is_comptime_var || var->gen_is_const);
+
+            if (is_comptime_var || (var_class_requires_const && var->gen_is_const)) {
+                return ir_const_void(ira, &decl_var_instruction->base);
+            }
+        }
+    } else if (is_comptime_var) {
+        ir_add_error(ira, &decl_var_instruction->base,
+                buf_sprintf("cannot store runtime value in compile time variable"));
+        var->var_type = ira->codegen->builtin_types.entry_invalid;
+        return ira->codegen->invalid_instruction;
+    }
+
+    ZigFn *fn_entry = exec_fn_entry(ira->new_irb.exec);
+    if (fn_entry)
+        fn_entry->variable_list.append(var);
+
+    return ir_build_var_decl_gen(ira, &decl_var_instruction->base, var, var_ptr);
+}
+
+static IrInstruction *ir_analyze_instruction_export(IrAnalyze *ira, IrInstructionExport *instruction) {
+    IrInstruction *name = instruction->name->child;
+    Buf *symbol_name = ir_resolve_str(ira, name);
+    if (symbol_name == nullptr) {
+        return ira->codegen->invalid_instruction;
+    }
+
+    IrInstruction *target = instruction->target->child;
+    if (type_is_invalid(target->value->type)) {
+        return ira->codegen->invalid_instruction;
+    }
+
+    GlobalLinkageId global_linkage_id = GlobalLinkageIdStrong;
+    if (instruction->linkage != nullptr) {
+        IrInstruction *linkage_value = instruction->linkage->child;
+        if (!ir_resolve_global_linkage(ira, linkage_value, &global_linkage_id)) {
+            return ira->codegen->invalid_instruction;
+        }
+    }
+
+    // TODO: This function needs to be audited.
+    // It's not clear how all the different types are supposed to be handled.
+    // Need comprehensive tests for exporting one thing in one file and declaring an extern var
+    // in another file.
+    TldFn *tld_fn = allocate<TldFn>(1);
+    tld_fn->base.id = TldIdFn;
+    tld_fn->base.source_node = instruction->base.source_node;
+
+    auto entry = ira->codegen->exported_symbol_names.put_unique(symbol_name, &tld_fn->base);
+    if (entry) {
+        AstNode *other_export_node = entry->value->source_node;
+        ErrorMsg *msg = ir_add_error(ira, &instruction->base,
                 buf_sprintf("exported symbol collision: '%s'", buf_ptr(symbol_name)));
         add_error_note(ira->codegen, msg, other_export_node, buf_sprintf("other symbol is here"));
         return ira->codegen->invalid_instruction;
     }
 
     bool want_var_export = false;
-    switch (target->value.type->id) {
+    switch (target->value->type->id) {
         case ZigTypeIdInvalid:
         case ZigTypeIdUnreachable:
             zig_unreachable();
         case ZigTypeIdFn: {
-            assert(target->value.data.x_ptr.special == ConstPtrSpecialFunction);
-            ZigFn *fn_entry = target->value.data.x_ptr.data.fn.fn_entry;
+            assert(target->value->data.x_ptr.special == ConstPtrSpecialFunction);
+            ZigFn *fn_entry = target->value->data.x_ptr.data.fn.fn_entry;
             tld_fn->fn_entry = fn_entry;
             CallingConvention cc = fn_entry->type_entry->data.fn.fn_type_id.cc;
             switch (cc) {
@@ -15125,46 +16590,46 @@ static IrInstruction *ir_analyze_instruction_export(IrAnalyze *ira, IrInstructio
             }
         } break;
         case ZigTypeIdStruct:
-            if (is_slice(target->value.type)) {
+            if (is_slice(target->value->type)) {
                 ir_add_error(ira, target,
-                    buf_sprintf("unable to export value of type '%s'", buf_ptr(&target->value.type->name)));
-            } else if (target->value.type->data.structure.layout != ContainerLayoutExtern) {
+                    buf_sprintf("unable to export value of type '%s'", buf_ptr(&target->value->type->name)));
+            } else if (target->value->type->data.structure.layout != ContainerLayoutExtern) {
                 ErrorMsg *msg = ir_add_error(ira, target,
                     buf_sprintf("exported struct value must be declared extern"));
-                add_error_note(ira->codegen, msg, target->value.type->data.structure.decl_node, buf_sprintf("declared here"));
+                add_error_note(ira->codegen, msg, target->value->type->data.structure.decl_node, buf_sprintf("declared here"));
             } else {
                 want_var_export = true;
             }
             break;
         case ZigTypeIdUnion:
-            if (target->value.type->data.unionation.layout != ContainerLayoutExtern) {
+            if (target->value->type->data.unionation.layout != ContainerLayoutExtern) {
                 ErrorMsg *msg = ir_add_error(ira, target,
                     buf_sprintf("exported union value must be declared extern"));
-                add_error_note(ira->codegen, msg, target->value.type->data.unionation.decl_node, buf_sprintf("declared here"));
+                add_error_note(ira->codegen, msg, target->value->type->data.unionation.decl_node, buf_sprintf("declared here"));
             } else {
                 want_var_export = true;
             }
             break;
         case ZigTypeIdEnum:
-            if (target->value.type->data.enumeration.layout != ContainerLayoutExtern) {
+            if (target->value->type->data.enumeration.layout != ContainerLayoutExtern) {
                 ErrorMsg *msg = ir_add_error(ira, target,
                     buf_sprintf("exported enum value must be declared extern"));
-                add_error_note(ira->codegen, msg, target->value.type->data.enumeration.decl_node, buf_sprintf("declared here"));
+                add_error_note(ira->codegen, msg, target->value->type->data.enumeration.decl_node, buf_sprintf("declared here"));
             } else {
                 want_var_export = true;
             }
             break;
         case ZigTypeIdArray:
-            if (!type_allowed_in_extern(ira->codegen, target->value.type->data.array.child_type)) {
+            if (!type_allowed_in_extern(ira->codegen, target->value->type->data.array.child_type)) {
                 ir_add_error(ira, target,
                     buf_sprintf("array element type '%s' not extern-compatible",
-                        buf_ptr(&target->value.type->data.array.child_type->name)));
+                        buf_ptr(&target->value->type->data.array.child_type->name)));
             } else {
                 want_var_export = true;
             }
             break;
         case ZigTypeIdMetaType: {
-            ZigType *type_value = target->value.data.x_type;
+            ZigType *type_value = target->value->data.x_type;
             switch (type_value->id) {
                 case ZigTypeIdInvalid:
                     zig_unreachable();
@@ -15239,14 +16704,14 @@ static IrInstruction *ir_analyze_instruction_export(IrAnalyze *ira, IrInstructio
         case ZigTypeIdErrorUnion:
         case ZigTypeIdErrorSet:
         case ZigTypeIdVector:
-            zig_panic("TODO export const value of type %s", buf_ptr(&target->value.type->name));
+            zig_panic("TODO export const value of type %s", buf_ptr(&target->value->type->name));
         case ZigTypeIdBoundFn:
         case ZigTypeIdArgTuple:
         case ZigTypeIdOpaque:
         case ZigTypeIdPromise:
         case ZigTypeIdEnumLiteral:
             ir_add_error(ira, target,
-                    buf_sprintf("invalid export target type '%s'", buf_ptr(&target->value.type->name)));
+                    buf_sprintf("invalid export target type '%s'", buf_ptr(&target->value->type->name)));
             break;
     }
 
@@ -15276,7 +16741,7 @@ static IrInstruction *ir_analyze_instruction_error_return_trace(IrAnalyze *ira,
         ZigType *optional_type = get_optional_type(ira->codegen, ptr_to_stack_trace_type);
         if (!exec_has_err_ret_trace(ira->codegen, ira->new_irb.exec)) {
             IrInstruction *result = ir_const(ira, &instruction->base, optional_type);
-            ConstExprValue *out_val = &result->value;
+            ConstExprValue *out_val = result->value;
             assert(get_codegen_ptr_type(optional_type) != nullptr);
             out_val->data.x_ptr.special = ConstPtrSpecialHardCodedAddr;
             out_val->data.x_ptr.data.hard_coded_addr.addr = 0;
@@ -15284,13 +16749,13 @@ static IrInstruction *ir_analyze_instruction_error_return_trace(IrAnalyze *ira,
         }
         IrInstruction *new_instruction = ir_build_error_return_trace(&ira->new_irb, instruction->base.scope,
                 instruction->base.source_node, instruction->optional);
-        new_instruction->value.type = optional_type;
+        new_instruction->value->type = optional_type;
         return new_instruction;
     } else {
         assert(ira->codegen->have_err_ret_tracing);
         IrInstruction *new_instruction = ir_build_error_return_trace(&ira->new_irb, instruction->base.scope,
                 instruction->base.source_node, instruction->optional);
-        new_instruction->value.type = get_ptr_to_stack_trace_type(ira->codegen);
+        new_instruction->value->type = get_ptr_to_stack_trace_type(ira->codegen);
         return new_instruction;
     }
 }
@@ -15315,829 +16780,1626 @@ static IrInstruction *ir_analyze_instruction_error_union(IrAnalyze *ira,
         return ira->codegen->invalid_instruction;
     }
 
-    if ((err = type_resolve(ira->codegen, payload_type, ResolveStatusSizeKnown)))
-        return ira->codegen->invalid_instruction;
-    ZigType *result_type = get_error_union_type(ira->codegen, err_set_type, payload_type);
+    if ((err = type_resolve(ira->codegen, payload_type, ResolveStatusSizeKnown)))
+        return ira->codegen->invalid_instruction;
+    ZigType *result_type = get_error_union_type(ira->codegen, err_set_type, payload_type);
+
+    return ir_const_type(ira, &instruction->base, result_type);
+}
+
+IrInstruction *ir_get_implicit_allocator(IrAnalyze *ira, IrInstruction *source_instr, ImplicitAllocatorId id) {
+    ZigFn *parent_fn_entry = exec_fn_entry(ira->new_irb.exec);
+    if (parent_fn_entry == nullptr) {
+        ir_add_error(ira, source_instr, buf_sprintf("no implicit allocator available"));
+        return ira->codegen->invalid_instruction;
+    }
+
+    FnTypeId *parent_fn_type = &parent_fn_entry->type_entry->data.fn.fn_type_id;
+    if (parent_fn_type->cc != CallingConventionAsync) {
+        ir_add_error(ira, source_instr, buf_sprintf("async function call from non-async caller requires allocator parameter"));
+        return ira->codegen->invalid_instruction;
+    }
+
+    assert(parent_fn_type->async_allocator_type != nullptr);
+
+    switch (id) {
+        case ImplicitAllocatorIdArg:
+            {
+                IrInstruction *result = ir_build_get_implicit_allocator(&ira->new_irb, source_instr->scope,
+                        source_instr->source_node, ImplicitAllocatorIdArg);
+                result->value->type = parent_fn_type->async_allocator_type;
+                return result;
+            }
+        case ImplicitAllocatorIdLocalVar:
+            {
+                ZigVar *coro_allocator_var = ira->old_irb.exec->coro_allocator_var;
+                assert(coro_allocator_var != nullptr);
+                IrInstruction *var_ptr_inst = ir_get_var_ptr(ira, source_instr, coro_allocator_var);
+                IrInstruction *result = ir_get_deref(ira, source_instr, var_ptr_inst, nullptr);
+                assert(result->value->type != nullptr);
+                return result;
+            }
+    }
+    zig_unreachable();
+}
+
+static IrInstruction *ir_analyze_alloca(IrAnalyze *ira, IrInstruction *source_inst, ZigType *var_type,
+        uint32_t align, const char *name_hint, bool force_comptime)
+{
+    Error err;
+
+    ConstExprValue *pointee = create_const_vals(1);
+    pointee->special = ConstValSpecialUndef;
+
+    IrInstructionAllocaGen *result = ir_create_alloca_gen(ira, source_inst, align, name_hint);
+    result->base.value->special = ConstValSpecialStatic;
+    result->base.value->data.x_ptr.special = ConstPtrSpecialRef;
+    result->base.value->data.x_ptr.mut = force_comptime ? ConstPtrMutComptimeVar : ConstPtrMutInfer;
+    result->base.value->data.x_ptr.data.ref.pointee = pointee;
+
+    if ((err = type_resolve(ira->codegen, var_type, ResolveStatusZeroBitsKnown)))
+        return ira->codegen->invalid_instruction;
+    assert(result->base.value->data.x_ptr.special != ConstPtrSpecialInvalid);
+
+    pointee->type = var_type;
+    result->base.value->type = get_pointer_to_type_extra(ira->codegen, var_type, false, false,
+            PtrLenSingle, align, 0, 0, false);
+
+    ZigFn *fn_entry = exec_fn_entry(ira->new_irb.exec);
+    if (fn_entry != nullptr) {
+        fn_entry->alloca_gen_list.append(result);
+    }
+    result->base.is_gen = true;
+    return &result->base;
+}
+
+static ZigType *ir_result_loc_expected_type(IrAnalyze *ira, IrInstruction *suspend_source_instr,
+        ResultLoc *result_loc)
+{
+    switch (result_loc->id) {
+        case ResultLocIdInvalid:
+        case ResultLocIdPeerParent:
+            zig_unreachable();
+        case ResultLocIdNone:
+        case ResultLocIdVar:
+        case ResultLocIdBitCast:
+            return nullptr;
+        case ResultLocIdInstruction:
+            return result_loc->source_instruction->child->value->type;
+        case ResultLocIdReturn:
+            return ira->explicit_return_type;
+        case ResultLocIdPeer:
+            return reinterpret_cast<ResultLocPeer*>(result_loc)->parent->resolved_type;
+    }
+    zig_unreachable();
+}
+
+static bool type_can_bit_cast(ZigType *t) {
+    switch (t->id) {
+        case ZigTypeIdInvalid:
+            zig_unreachable();
+        case ZigTypeIdMetaType:
+        case ZigTypeIdOpaque:
+        case ZigTypeIdBoundFn:
+        case ZigTypeIdArgTuple:
+        case ZigTypeIdUnreachable:
+        case ZigTypeIdComptimeFloat:
+        case ZigTypeIdComptimeInt:
+        case ZigTypeIdEnumLiteral:
+        case ZigTypeIdUndefined:
+        case ZigTypeIdNull:
+        case ZigTypeIdPointer:
+            return false;
+        default:
+            // TODO list these types out explicitly, there are probably some other invalid ones here
+            return true;
+    }
+}
+
+static void set_up_result_loc_for_inferred_comptime(IrInstruction *ptr) {
+    ConstExprValue *undef_child = create_const_vals(1);
+    undef_child->type = ptr->value->type->data.pointer.child_type;
+    undef_child->special = ConstValSpecialUndef;
+    ptr->value->special = ConstValSpecialStatic;
+    ptr->value->data.x_ptr.mut = ConstPtrMutInfer;
+    ptr->value->data.x_ptr.special = ConstPtrSpecialRef;
+    ptr->value->data.x_ptr.data.ref.pointee = undef_child;
+}
+
+// when calling this function, at the callsite must check for result type noreturn and propagate it up
+static IrInstruction *ir_resolve_result_raw(IrAnalyze *ira, IrInstruction *suspend_source_instr,
+        ResultLoc *result_loc, ZigType *value_type, IrInstruction *value, bool force_runtime, bool non_null_comptime)
+{
+    Error err;
+    if (result_loc->resolved_loc != nullptr) {
+        // allow to redo the result location if the value is known and comptime and the previous one isn't
+        if (value == nullptr || !instr_is_comptime(value) || instr_is_comptime(result_loc->resolved_loc)) {
+            return result_loc->resolved_loc;
+        }
+    }
+    result_loc->gen_instruction = value;
+    result_loc->implicit_elem_type = value_type;
+    switch (result_loc->id) {
+        case ResultLocIdInvalid:
+        case ResultLocIdPeerParent:
+            zig_unreachable();
+        case ResultLocIdNone: {
+            if (value != nullptr) {
+                return nullptr;
+            }
+            // need to return a result location and don't have one. use a stack allocation
+            IrInstructionAllocaGen *alloca_gen = ir_create_alloca_gen(ira, suspend_source_instr, 0, "");
+            if ((err = type_resolve(ira->codegen, value_type, ResolveStatusZeroBitsKnown)))
+                return ira->codegen->invalid_instruction;
+            alloca_gen->base.value->type = get_pointer_to_type_extra(ira->codegen, value_type, false, false,
+                    PtrLenSingle, 0, 0, 0, false);
+            set_up_result_loc_for_inferred_comptime(&alloca_gen->base);
+            ZigFn *fn_entry = exec_fn_entry(ira->new_irb.exec);
+            if (fn_entry != nullptr) {
+                fn_entry->alloca_gen_list.append(alloca_gen);
+            }
+            result_loc->written = true;
+            result_loc->resolved_loc = &alloca_gen->base;
+            return result_loc->resolved_loc;
+        }
+        case ResultLocIdVar: {
+            ResultLocVar *result_loc_var = reinterpret_cast<ResultLocVar *>(result_loc);
+            assert(result_loc->source_instruction->id == IrInstructionIdAllocaSrc);
+
+            if (value_type->id == ZigTypeIdUnreachable || value_type->id == ZigTypeIdOpaque) {
+                ir_add_error(ira, result_loc->source_instruction,
+                    buf_sprintf("variable of type '%s' not allowed", buf_ptr(&value_type->name)));
+                return ira->codegen->invalid_instruction;
+            }
+
+            IrInstructionAllocaSrc *alloca_src =
+                reinterpret_cast<IrInstructionAllocaSrc *>(result_loc->source_instruction);
+            bool force_comptime;
+            if (!ir_resolve_comptime(ira, alloca_src->is_comptime->child, &force_comptime))
+                return ira->codegen->invalid_instruction;
+            bool is_comptime = force_comptime || (value != nullptr &&
+                    value->value->special != ConstValSpecialRuntime && result_loc_var->var->gen_is_const);
+
+            if (alloca_src->base.child == nullptr || is_comptime) {
+                uint32_t align = 0;
+                if (alloca_src->align != nullptr && !ir_resolve_align(ira, alloca_src->align->child, &align)) {
+                    return ira->codegen->invalid_instruction;
+                }
+                IrInstruction *alloca_gen;
+                if (is_comptime && value != nullptr) {
+                    if (align > value->value->global_refs->align) {
+                        value->value->global_refs->align = align;
+                    }
+                    alloca_gen = ir_get_ref(ira, result_loc->source_instruction, value, true, false);
+                } else {
+                    alloca_gen = ir_analyze_alloca(ira, result_loc->source_instruction, value_type, align,
+                            alloca_src->name_hint, force_comptime);
+                }
+                if (alloca_src->base.child != nullptr) {
+                    alloca_src->base.child->ref_count = 0;
+                }
+                alloca_src->base.child = alloca_gen;
+            }
+            result_loc->written = true;
+            result_loc->resolved_loc = is_comptime ? nullptr : alloca_src->base.child;
+            return result_loc->resolved_loc;
+        }
+        case ResultLocIdInstruction: {
+            result_loc->written = true;
+            result_loc->resolved_loc = result_loc->source_instruction->child;
+            return result_loc->resolved_loc;
+        }
+        case ResultLocIdReturn: {
+            if (!non_null_comptime) {
+                bool is_comptime = value != nullptr && value->value->special != ConstValSpecialRuntime;
+                if (is_comptime)
+                    return nullptr;
+            }
+            if ((err = type_resolve(ira->codegen, ira->explicit_return_type, ResolveStatusZeroBitsKnown))) {
+                return ira->codegen->invalid_instruction;
+            }
+            if (!type_has_bits(ira->explicit_return_type) || !handle_is_ptr(ira->explicit_return_type))
+                return nullptr;
+
+            ZigType *ptr_return_type = get_pointer_to_type(ira->codegen, ira->explicit_return_type, false);
+            result_loc->written = true;
+            result_loc->resolved_loc = ir_build_return_ptr(ira, result_loc->source_instruction, ptr_return_type);
+            if (ir_should_inline(ira->old_irb.exec, result_loc->source_instruction->scope)) {
+                set_up_result_loc_for_inferred_comptime(result_loc->resolved_loc);
+            }
+            return result_loc->resolved_loc;
+        }
+        case ResultLocIdPeer: {
+            ResultLocPeer *result_peer = reinterpret_cast<ResultLocPeer *>(result_loc);
+            ResultLocPeerParent *peer_parent = result_peer->parent;
+
+            if (peer_parent->peers.length == 1) {
+                IrInstruction *parent_result_loc = ir_resolve_result(ira, suspend_source_instr, peer_parent->parent,
+                        value_type, value, force_runtime, non_null_comptime);
+                result_peer->suspend_pos.basic_block_index = SIZE_MAX;
+                result_peer->suspend_pos.instruction_index = SIZE_MAX;
+                if (parent_result_loc == nullptr || type_is_invalid(parent_result_loc->value->type) ||
+                    parent_result_loc->value->type->id == ZigTypeIdUnreachable)
+                {
+                    return parent_result_loc;
+                }
+                result_loc->written = true;
+                result_loc->resolved_loc = parent_result_loc;
+                return result_loc->resolved_loc;
+            }
+
+            bool is_comptime;
+            if (!ir_resolve_comptime(ira, peer_parent->is_comptime->child, &is_comptime))
+                return ira->codegen->invalid_instruction;
+            peer_parent->skipped = is_comptime;
+            if (peer_parent->skipped) {
+                if (non_null_comptime) {
+                    return ir_resolve_result(ira, suspend_source_instr, peer_parent->parent,
+                            value_type, value, force_runtime, non_null_comptime);
+                }
+                return nullptr;
+            }
+
+            if (peer_parent->resolved_type == nullptr) {
+                if (peer_parent->end_bb->suspend_instruction_ref == nullptr) {
+                    peer_parent->end_bb->suspend_instruction_ref = suspend_source_instr;
+                }
+                IrInstruction *unreach_inst = ira_suspend(ira, suspend_source_instr, result_peer->next_bb,
+                        &result_peer->suspend_pos);
+                if (result_peer->next_bb == nullptr) {
+                    ir_start_next_bb(ira);
+                }
+                return unreach_inst;
+            }
+
+            IrInstruction *parent_result_loc = ir_resolve_result(ira, suspend_source_instr, peer_parent->parent,
+                    peer_parent->resolved_type, nullptr, force_runtime, non_null_comptime);
+            if (parent_result_loc == nullptr || type_is_invalid(parent_result_loc->value->type) ||
+                parent_result_loc->value->type->id == ZigTypeIdUnreachable)
+            {
+                return parent_result_loc;
+            }
+            // because is_comptime is false, we mark this a runtime pointer
+            parent_result_loc->value->special = ConstValSpecialRuntime;
+            result_loc->written = true;
+            result_loc->resolved_loc = parent_result_loc;
+            return result_loc->resolved_loc;
+        }
+        case ResultLocIdBitCast: {
+            ResultLocBitCast *result_bit_cast = reinterpret_cast<ResultLocBitCast *>(result_loc);
+            ZigType *dest_type = ir_resolve_type(ira, result_bit_cast->base.source_instruction->child);
+            if (type_is_invalid(dest_type))
+                return ira->codegen->invalid_instruction;
+
+            if (get_codegen_ptr_type(dest_type) != nullptr) {
+                ir_add_error(ira, result_loc->source_instruction,
+                        buf_sprintf("unable to @bitCast to pointer type '%s'", buf_ptr(&dest_type->name)));
+                return ira->codegen->invalid_instruction;
+            }
 
-    return ir_const_type(ira, &instruction->base, result_type);
-}
+            if (!type_can_bit_cast(dest_type)) {
+                ir_add_error(ira, result_loc->source_instruction,
+                        buf_sprintf("unable to @bitCast to type '%s'", buf_ptr(&dest_type->name)));
+                return ira->codegen->invalid_instruction;
+            }
 
-IrInstruction *ir_get_implicit_allocator(IrAnalyze *ira, IrInstruction *source_instr, ImplicitAllocatorId id) {
-    ZigFn *parent_fn_entry = exec_fn_entry(ira->new_irb.exec);
-    if (parent_fn_entry == nullptr) {
-        ir_add_error(ira, source_instr, buf_sprintf("no implicit allocator available"));
-        return ira->codegen->invalid_instruction;
-    }
+            if (get_codegen_ptr_type(value_type) != nullptr) {
+                ir_add_error(ira, suspend_source_instr,
+                    buf_sprintf("unable to @bitCast from pointer type '%s'", buf_ptr(&value_type->name)));
+                return ira->codegen->invalid_instruction;
+            }
 
-    FnTypeId *parent_fn_type = &parent_fn_entry->type_entry->data.fn.fn_type_id;
-    if (parent_fn_type->cc != CallingConventionAsync) {
-        ir_add_error(ira, source_instr, buf_sprintf("async function call from non-async caller requires allocator parameter"));
-        return ira->codegen->invalid_instruction;
-    }
+            if (!type_can_bit_cast(value_type)) {
+                ir_add_error(ira, suspend_source_instr,
+                        buf_sprintf("unable to @bitCast from type '%s'", buf_ptr(&value_type->name)));
+                return ira->codegen->invalid_instruction;
+            }
 
-    assert(parent_fn_type->async_allocator_type != nullptr);
+            IrInstruction *bitcasted_value;
+            if (value != nullptr) {
+                bitcasted_value = ir_analyze_bit_cast(ira, result_loc->source_instruction, value, dest_type);
+            } else {
+                bitcasted_value = nullptr;
+            }
 
-    switch (id) {
-        case ImplicitAllocatorIdArg:
+            IrInstruction *parent_result_loc = ir_resolve_result(ira, suspend_source_instr, result_bit_cast->parent,
+                    dest_type, bitcasted_value, force_runtime, non_null_comptime);
+            if (parent_result_loc == nullptr || type_is_invalid(parent_result_loc->value->type) ||
+                parent_result_loc->value->type->id == ZigTypeIdUnreachable)
             {
-                IrInstruction *result = ir_build_get_implicit_allocator(&ira->new_irb, source_instr->scope,
-                        source_instr->source_node, ImplicitAllocatorIdArg);
-                result->value.type = parent_fn_type->async_allocator_type;
-                return result;
+                return parent_result_loc;
             }
-        case ImplicitAllocatorIdLocalVar:
+            ZigType *parent_ptr_type = parent_result_loc->value->type;
+            assert(parent_ptr_type->id == ZigTypeIdPointer);
+            if ((err = type_resolve(ira->codegen, parent_ptr_type->data.pointer.child_type,
+                            ResolveStatusAlignmentKnown)))
             {
-                ZigVar *coro_allocator_var = ira->old_irb.exec->coro_allocator_var;
-                assert(coro_allocator_var != nullptr);
-                IrInstruction *var_ptr_inst = ir_get_var_ptr(ira, source_instr, coro_allocator_var);
-                IrInstruction *result = ir_get_deref(ira, source_instr, var_ptr_inst, nullptr);
-                assert(result->value.type != nullptr);
-                return result;
+                return ira->codegen->invalid_instruction;
             }
+            uint64_t parent_ptr_align = get_ptr_align(ira->codegen, parent_ptr_type);
+            ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, value_type,
+                    parent_ptr_type->data.pointer.is_const, parent_ptr_type->data.pointer.is_volatile, PtrLenSingle,
+                    parent_ptr_align, 0, 0, parent_ptr_type->data.pointer.allow_zero);
+
+            result_loc->written = true;
+            result_loc->resolved_loc = ir_analyze_ptr_cast(ira, suspend_source_instr, parent_result_loc,
+                    ptr_type, result_bit_cast->base.source_instruction, false);
+            return result_loc->resolved_loc;
+        }
     }
     zig_unreachable();
 }
 
-static IrInstruction *ir_analyze_alloca(IrAnalyze *ira, IrInstruction *source_inst, ZigType *var_type,
-        uint32_t align, const char *name_hint, bool force_comptime)
+static IrInstruction *ir_resolve_result(IrAnalyze *ira, IrInstruction *suspend_source_instr,
+        ResultLoc *result_loc_pass1, ZigType *value_type, IrInstruction *value, bool force_runtime,
+        bool non_null_comptime)
 {
-    Error err;
+    IrInstruction *result_loc = ir_resolve_result_raw(ira, suspend_source_instr, result_loc_pass1, value_type,
+            value, force_runtime, non_null_comptime);
+    if (result_loc == nullptr || (instr_is_unreachable(result_loc) || type_is_invalid(result_loc->value->type)))
+        return result_loc;
 
-    ConstExprValue *pointee = create_const_vals(1);
-    pointee->special = ConstValSpecialUndef;
+    if ((force_runtime || (value != nullptr && !instr_is_comptime(value))) &&
+        result_loc_pass1->written && result_loc->value->data.x_ptr.mut == ConstPtrMutInfer)
+    {
+        result_loc->value->special = ConstValSpecialRuntime;
+    }
 
-    IrInstructionAllocaGen *result = ir_create_alloca_gen(ira, source_inst, align, name_hint);
-    result->base.value.special = ConstValSpecialStatic;
-    result->base.value.data.x_ptr.special = ConstPtrSpecialRef;
-    result->base.value.data.x_ptr.mut = force_comptime ? ConstPtrMutComptimeVar : ConstPtrMutInfer;
-    result->base.value.data.x_ptr.data.ref.pointee = pointee;
+    ir_assert(result_loc->value->type->id == ZigTypeIdPointer, suspend_source_instr);
+    ZigType *actual_elem_type = result_loc->value->type->data.pointer.child_type;
+    if (actual_elem_type->id == ZigTypeIdOptional && value_type->id != ZigTypeIdOptional &&
+            value_type->id != ZigTypeIdNull)
+    {
+        return ir_analyze_unwrap_optional_payload(ira, suspend_source_instr, result_loc, false, true);
+    } else if (actual_elem_type->id == ZigTypeIdErrorUnion && value_type->id != ZigTypeIdErrorUnion) {
+        if (value_type->id == ZigTypeIdErrorSet) {
+            return ir_analyze_unwrap_err_code(ira, suspend_source_instr, result_loc, true);
+        } else {
+            IrInstruction *unwrapped_err_ptr = ir_analyze_unwrap_error_payload(ira, suspend_source_instr,
+                    result_loc, false, true);
+            ZigType *actual_payload_type = actual_elem_type->data.error_union.payload_type;
+            if (actual_payload_type->id == ZigTypeIdOptional && value_type->id != ZigTypeIdOptional) {
+                return ir_analyze_unwrap_optional_payload(ira, suspend_source_instr, unwrapped_err_ptr, false, true);
+            } else {
+                return unwrapped_err_ptr;
+            }
+        }
+    } else if (is_slice(actual_elem_type) && value_type->id == ZigTypeIdArray) {
+        // need to allow EndExpr to do the implicit cast from array to slice
+        result_loc_pass1->written = false;
+    }
+    return result_loc;
+}
 
-    if ((err = type_resolve(ira->codegen, var_type, ResolveStatusZeroBitsKnown)))
+static IrInstruction *ir_analyze_instruction_implicit_cast(IrAnalyze *ira, IrInstructionImplicitCast *instruction) {
+    ZigType *dest_type = ir_resolve_type(ira, instruction->dest_type->child);
+    if (type_is_invalid(dest_type))
         return ira->codegen->invalid_instruction;
-    assert(result->base.value.data.x_ptr.special != ConstPtrSpecialInvalid);
 
-    pointee->type = var_type;
-    result->base.value.type = get_pointer_to_type_extra(ira->codegen, var_type, false, false,
-            PtrLenSingle, align, 0, 0, false);
+    IrInstruction *target = instruction->target->child;
+    if (type_is_invalid(target->value->type))
+        return ira->codegen->invalid_instruction;
 
-    ZigFn *fn_entry = exec_fn_entry(ira->new_irb.exec);
-    if (fn_entry != nullptr) {
-        fn_entry->alloca_gen_list.append(result);
+    return ir_implicit_cast_with_result(ira, target, dest_type, instruction->result_loc);
+}
+
+static IrInstruction *ir_analyze_instruction_resolve_result(IrAnalyze *ira, IrInstructionResolveResult *instruction) {
+    ZigType *implicit_elem_type = ir_resolve_type(ira, instruction->ty->child);
+    if (type_is_invalid(implicit_elem_type))
+        return ira->codegen->invalid_instruction;
+    IrInstruction *result_loc = ir_resolve_result(ira, &instruction->base, instruction->result_loc,
+            implicit_elem_type, nullptr, false, true);
+    if (result_loc != nullptr)
+        return result_loc;
+
+    ZigFn *fn = exec_fn_entry(ira->new_irb.exec);
+    if (fn != nullptr && fn->type_entry->data.fn.fn_type_id.cc == CallingConventionAsync &&
+            instruction->result_loc->id == ResultLocIdReturn)
+    {
+        result_loc = ir_resolve_result(ira, &instruction->base, no_result_loc(),
+                implicit_elem_type, nullptr, false, true);
+        if (result_loc != nullptr &&
+                (type_is_invalid(result_loc->value->type) || instr_is_unreachable(result_loc)))
+        {
+            return result_loc;
+        }
+        result_loc->value->special = ConstValSpecialRuntime;
+        return result_loc;
     }
-    result->base.is_gen = true;
-    return &result->base;
+
+    IrInstruction *result = ir_const(ira, &instruction->base, implicit_elem_type);
+    result->value->special = ConstValSpecialUndef;
+    IrInstruction *ptr = ir_get_ref(ira, &instruction->base, result, false, false);
+    ptr->value->data.x_ptr.mut = ConstPtrMutComptimeVar;
+    return ptr;
 }
 
-static ZigType *ir_result_loc_expected_type(IrAnalyze *ira, IrInstruction *suspend_source_instr,
-        ResultLoc *result_loc)
-{
+static void ir_reset_result(ResultLoc *result_loc) {
+    result_loc->written = false;
+    result_loc->resolved_loc = nullptr;
+    result_loc->gen_instruction = nullptr;
+    result_loc->implicit_elem_type = nullptr;
     switch (result_loc->id) {
         case ResultLocIdInvalid:
-        case ResultLocIdPeerParent:
             zig_unreachable();
+        case ResultLocIdPeerParent: {
+            ResultLocPeerParent *peer_parent = reinterpret_cast<ResultLocPeerParent *>(result_loc);
+            peer_parent->skipped = false;
+            peer_parent->done_resuming = false;
+            peer_parent->resolved_type = nullptr;
+            for (size_t i = 0; i < peer_parent->peers.length; i += 1) {
+                ir_reset_result(&peer_parent->peers.at(i)->base);
+            }
+            break;
+        }
+        case ResultLocIdVar: {
+            IrInstructionAllocaSrc *alloca_src =
+                reinterpret_cast<IrInstructionAllocaSrc *>(result_loc->source_instruction);
+            alloca_src->base.child = nullptr;
+            break;
+        }
+        case ResultLocIdPeer:
         case ResultLocIdNone:
-        case ResultLocIdVar:
-        case ResultLocIdBitCast:
-            return nullptr;
-        case ResultLocIdInstruction:
-            return result_loc->source_instruction->child->value.type;
         case ResultLocIdReturn:
-            return ira->explicit_return_type;
-        case ResultLocIdPeer:
-            return reinterpret_cast<ResultLocPeer*>(result_loc)->parent->resolved_type;
+        case ResultLocIdInstruction:
+        case ResultLocIdBitCast:
+            break;
     }
-    zig_unreachable();
 }
 
-static bool type_can_bit_cast(ZigType *t) {
-    switch (t->id) {
-        case ZigTypeIdInvalid:
-            zig_unreachable();
-        case ZigTypeIdMetaType:
-        case ZigTypeIdOpaque:
-        case ZigTypeIdBoundFn:
-        case ZigTypeIdArgTuple:
-        case ZigTypeIdUnreachable:
-        case ZigTypeIdComptimeFloat:
-        case ZigTypeIdComptimeInt:
-        case ZigTypeIdEnumLiteral:
-        case ZigTypeIdUndefined:
-        case ZigTypeIdNull:
-        case ZigTypeIdPointer:
-            return false;
-        default:
-            // TODO list these types out explicitly, there are probably some other invalid ones here
-            return true;
-    }
+static IrInstruction *ir_analyze_instruction_reset_result(IrAnalyze *ira, IrInstructionResetResult *instruction) {
+    ir_reset_result(instruction->result_loc);
+    return ir_const_void(ira, &instruction->base);
 }
 
-static void set_up_result_loc_for_inferred_comptime(IrInstruction *ptr) {
-    ConstExprValue *undef_child = create_const_vals(1);
-    undef_child->type = ptr->value.type->data.pointer.child_type;
-    undef_child->special = ConstValSpecialUndef;
-    ptr->value.special = ConstValSpecialStatic;
-    ptr->value.data.x_ptr.mut = ConstPtrMutInfer;
-    ptr->value.data.x_ptr.special = ConstPtrSpecialRef;
-    ptr->value.data.x_ptr.data.ref.pointee = undef_child;
+static IrInstruction *ir_analyze_async_call(IrAnalyze *ira, IrInstructionCallSrc *call_instruction, ZigFn *fn_entry,
+        ZigType *fn_type, IrInstruction *fn_ref, IrInstruction **casted_args, size_t arg_count,
+        IrInstruction *async_allocator_inst)
+{
+    Buf *realloc_field_name = buf_create_from_str(ASYNC_REALLOC_FIELD_NAME);
+    ir_assert(async_allocator_inst->value->type->id == ZigTypeIdPointer, &call_instruction->base);
+    ZigType *container_type = async_allocator_inst->value->type->data.pointer.child_type;
+    IrInstruction *field_ptr_inst = ir_analyze_container_field_ptr(ira, realloc_field_name, &call_instruction->base,
+            async_allocator_inst, container_type, false);
+    if (type_is_invalid(field_ptr_inst->value->type)) {
+        return ira->codegen->invalid_instruction;
+    }
+    ZigType *ptr_to_realloc_fn_type = field_ptr_inst->value->type;
+    ir_assert(ptr_to_realloc_fn_type->id == ZigTypeIdPointer, &call_instruction->base);
+
+    ZigType *realloc_fn_type = ptr_to_realloc_fn_type->data.pointer.child_type;
+    if (realloc_fn_type->id != ZigTypeIdFn) {
+        ir_add_error(ira, &call_instruction->base,
+                buf_sprintf("expected reallocation function, found '%s'", buf_ptr(&realloc_fn_type->name)));
+        return ira->codegen->invalid_instruction;
+    }
+
+    ZigType *realloc_fn_return_type = realloc_fn_type->data.fn.fn_type_id.return_type;
+    if (realloc_fn_return_type->id != ZigTypeIdErrorUnion) {
+        ir_add_error(ira, fn_ref,
+            buf_sprintf("expected allocation function to return error union, but it returns '%s'", buf_ptr(&realloc_fn_return_type->name)));
+        return ira->codegen->invalid_instruction;
+    }
+    ZigType *alloc_fn_error_set_type = realloc_fn_return_type->data.error_union.err_set_type;
+    ZigType *return_type = fn_type->data.fn.fn_type_id.return_type;
+    ZigType *promise_type = get_promise_type(ira->codegen, return_type);
+    ZigType *async_return_type = get_error_union_type(ira->codegen, alloc_fn_error_set_type, promise_type);
+
+    IrInstruction *result_loc = ir_resolve_result(ira, &call_instruction->base, no_result_loc(),
+            async_return_type, nullptr, true, true);
+    if (type_is_invalid(result_loc->value->type) || instr_is_unreachable(result_loc)) {
+        return result_loc;
+    }
+
+    return ir_build_call_gen(ira, &call_instruction->base, fn_entry, fn_ref, arg_count,
+            casted_args, FnInlineAuto, true, async_allocator_inst, nullptr, result_loc,
+            async_return_type);
 }
 
-// when calling this function, at the callsite must check for result type noreturn and propagate it up
-static IrInstruction *ir_resolve_result_raw(IrAnalyze *ira, IrInstruction *suspend_source_instr,
-        ResultLoc *result_loc, ZigType *value_type, IrInstruction *value, bool force_runtime, bool non_null_comptime)
+static void comptime_fn_ir_scan(AstNode **node_ptr, void *context) {
+    bool *cacheable = reinterpret_cast<bool *>(context);
+    AstNode *node = *node_ptr;
+    if (!*cacheable)
+        return;
+    // These create a new type while the IR is generated, and each call must get its own.
+    if (node->type == NodeTypeContainerDecl || node->type == NodeTypeErrorSetDecl) {
+        *cacheable = false;
+        return;
+    }
+    ast_visit_node_children(node, comptime_fn_ir_scan, context);
+}
+
+// Clears what the previous analysis of old_exec left in it. var_init holds
+// the variables of old_exec as pass 1 left them.
+static void ir_reset_exec(IrExecutable *old_exec, ZigVar *var_init) {
+    for (size_t bb_i = 0; bb_i < old_exec->basic_block_list.length; bb_i += 1) {
+        IrBasicBlock *old_bb = old_exec->basic_block_list.at(bb_i);
+        old_bb->other = nullptr;
+        old_bb->suspend_instruction_ref = nullptr;
+        old_bb->suspended = false;
+        old_bb->in_resume_stack = false;
+        for (size_t instr_i = 0; instr_i < old_bb->instruction_list.length; instr_i += 1) {
+            old_bb->instruction_list.at(instr_i)->child = nullptr;
+        }
+    }
+    for (size_t i = 0; i < old_exec->result_loc_list.length; i += 1) {
+        ir_reset_result(old_exec->result_loc_list.at(i));
+    }
+    // Analysis of a declaration sets const_value, var_type, next_var,
+    // ref_count and align_bytes, and @export appends to export_list. Codegen
+    // sets value_ref and di_loc_var. mem_slot_index, owner_exec and
+    // gen_is_const come from pass 1. Every field goes back to its pass 1
+    // value, except that the constant value is allocated anew because
+    // analysis may have written through the old one.
+    for (size_t i = 0; i < old_exec->var_list.length; i += 1) {
+        ZigVar *var = old_exec->var_list.at(i);
+        *var = var_init[i];
+        var->const_value = create_const_vals(1);
+    }
+}
+
+// Comptime calls to the same function share the pass 1 IR of its body. It is
+// generated once in a private copy of the parameter scopes, whose variables
+// then take the arguments of each call. Returns null if this call must
+// generate its own IR, which is the case for recursive calls. Otherwise
+// *scope is set to the parameter scope of the IR, and the caller must clear
+// comptime_ir_in_use once analysis is done.
+static IrExecutable *ir_acquire_comptime_fn_ir(IrAnalyze *ira, ZigFn *fn_entry, Scope **scope,
+        AstNode *source_node)
 {
-    Error err;
-    if (result_loc->resolved_loc != nullptr) {
-        // allow to redo the result location if the value is known and comptime and the previous one isn't
-        if (value == nullptr || !instr_is_comptime(value) || instr_is_comptime(result_loc->resolved_loc)) {
-            return result_loc->resolved_loc;
+    if (fn_entry->comptime_ir_in_use || fn_entry->comptime_ir_uncacheable)
+        return nullptr;
+
+    if (fn_entry->comptime_ir == nullptr) {
+        bool cacheable = true;
+        comptime_fn_ir_scan(&fn_entry->body_node, &cacheable);
+        if (!cacheable) {
+            fn_entry->comptime_ir_uncacheable = true;
+            return nullptr;
         }
-    }
-    result_loc->gen_instruction = value;
-    result_loc->implicit_elem_type = value_type;
-    switch (result_loc->id) {
-        case ResultLocIdInvalid:
-        case ResultLocIdPeerParent:
-            zig_unreachable();
-        case ResultLocIdNone: {
-            if (value != nullptr) {
-                return nullptr;
-            }
-            // need to return a result location and don't have one. use a stack allocation
-            IrInstructionAllocaGen *alloca_gen = ir_create_alloca_gen(ira, suspend_source_instr, 0, "");
-            if ((err = type_resolve(ira->codegen, value_type, ResolveStatusZeroBitsKnown)))
-                return ira->codegen->invalid_instruction;
-            alloca_gen->base.value.type = get_pointer_to_type_extra(ira->codegen, value_type, false, false,
-                    PtrLenSingle, 0, 0, 0, false);
-            set_up_result_loc_for_inferred_comptime(&alloca_gen->base);
-            ZigFn *fn_entry = exec_fn_entry(ira->new_irb.exec);
-            if (fn_entry != nullptr) {
-                fn_entry->alloca_gen_list.append(alloca_gen);
-            }
-            result_loc->written = true;
-            result_loc->resolved_loc = &alloca_gen->base;
-            return result_loc->resolved_loc;
+
+        ZigList<ZigVar *> params = {0};
+        for (Scope *it = *scope; it->id == ScopeIdVarDecl; it = it->parent) {
+            params.append(reinterpret_cast<ScopeVarDecl *>(it)->var);
+        }
+        Scope *param_scope = &fn_entry->fndef_scope->base;
+        for (size_t i = params.length; i > 0; i -= 1) {
+            ZigVar *var = allocate<ZigVar>(1);
+            *var = *params.at(i - 1);
+            var->parent_scope = param_scope;
+            var->child_scope = create_var_scope(ira->codegen, var->decl_node, param_scope, var);
+            param_scope = var->child_scope;
+        }
+        params.deinit();
+
+        // Pass 1 errors report the call that generates the IR.
+        IrExecutable *ir_executable = allocate<IrExecutable>(1);
+        ir_executable->source_node = source_node;
+        ir_executable->parent_exec = ira->new_irb.exec;
+        ir_executable->is_inline = true;
+        ir_executable->fn_entry = fn_entry;
+        ir_executable->begin_scope = param_scope;
+        ir_gen(ira->codegen, fn_entry->body_node, param_scope, ir_executable);
+        ZigVar *var_init = allocate<ZigVar>(ir_executable->var_list.length);
+        for (size_t i = 0; i < ir_executable->var_list.length; i += 1) {
+            var_init[i] = *ir_executable->var_list.at(i);
+        }
+        fn_entry->comptime_ir = ir_executable;
+        fn_entry->comptime_ir_scope = param_scope;
+        fn_entry->comptime_ir_vars = var_init;
+    } else {
+        // A failed analysis invalidates its source IR. Leave later calls to
+        // generate their own, as they did before the IR was shared.
+        if (fn_entry->comptime_ir->invalid) {
+            fn_entry->comptime_ir_uncacheable = true;
+            return nullptr;
         }
-        case ResultLocIdVar: {
-            ResultLocVar *result_loc_var = reinterpret_cast<ResultLocVar *>(result_loc);
-            assert(result_loc->source_instruction->id == IrInstructionIdAllocaSrc);
+        ir_reset_exec(fn_entry->comptime_ir, fn_entry->comptime_ir_vars);
+        ira->codegen->comptime_ir_reused += 1;
+    }
 
-            if (value_type->id == ZigTypeIdUnreachable || value_type->id == ZigTypeIdOpaque) {
-                ir_add_error(ira, result_loc->source_instruction,
-                    buf_sprintf("variable of type '%s' not allowed", buf_ptr(&value_type->name)));
-                return ira->codegen->invalid_instruction;
-            }
+    Scope *param_scope = fn_entry->comptime_ir_scope;
+    for (Scope *it = *scope; it->id == ScopeIdVarDecl; it = it->parent) {
+        assert(param_scope->id == ScopeIdVarDecl);
+        ZigVar *arg_var = reinterpret_cast<ScopeVarDecl *>(it)->var;
+        ZigVar *param_var = reinterpret_cast<ScopeVarDecl *>(param_scope)->var;
+        // The copy takes every field of the argument but its place in the scopes.
+        Scope *parent_scope = param_var->parent_scope;
+        Scope *child_scope = param_var->child_scope;
+        *param_var = *arg_var;
+        param_var->parent_scope = parent_scope;
+        param_var->child_scope = child_scope;
+        param_scope = param_scope->parent;
+    }
 
-            IrInstructionAllocaSrc *alloca_src =
-                reinterpret_cast<IrInstructionAllocaSrc *>(result_loc->source_instruction);
-            bool force_comptime;
-            if (!ir_resolve_comptime(ira, alloca_src->is_comptime->child, &force_comptime))
-                return ira->codegen->invalid_instruction;
-            bool is_comptime = force_comptime || (value != nullptr &&
-                    value->value.special != ConstValSpecialRuntime && result_loc_var->var->gen_is_const);
+    // Anything reported against the shared IR from here on belongs to this
+    // call, not to the one that generated it.
+    fn_entry->comptime_ir->source_node = source_node;
+    fn_entry->comptime_ir->parent_exec = ira->new_irb.exec;
+    fn_entry->comptime_ir_in_use = true;
+    *scope = fn_entry->comptime_ir_scope;
+    return fn_entry->comptime_ir;
+}
 
-            if (alloca_src->base.child == nullptr || is_comptime) {
-                uint32_t align = 0;
-                if (alloca_src->align != nullptr && !ir_resolve_align(ira, alloca_src->align->child, &align)) {
-                    return ira->codegen->invalid_instruction;
-                }
-                IrInstruction *alloca_gen;
-                if (is_comptime && value != nullptr) {
-                    if (align > value->value.global_refs->align) {
-                        value->value.global_refs->align = align;
-                    }
-                    alloca_gen = ir_get_ref(ira, result_loc->source_instruction, value, true, false);
-                } else {
-                    alloca_gen = ir_analyze_alloca(ira, result_loc->source_instruction, value_type, align,
-                            alloca_src->name_hint, force_comptime);
-                }
-                if (alloca_src->base.child != nullptr) {
-                    alloca_src->base.child->ref_count = 0;
-                }
-                alloca_src->base.child = alloca_gen;
-            }
-            result_loc->written = true;
-            result_loc->resolved_loc = is_comptime ? nullptr : alloca_src->base.child;
-            return result_loc->resolved_loc;
-        }
-        case ResultLocIdInstruction: {
-            result_loc->written = true;
-            result_loc->resolved_loc = result_loc->source_instruction->child;
-            return result_loc->resolved_loc;
-        }
-        case ResultLocIdReturn: {
-            if (!non_null_comptime) {
-                bool is_comptime = value != nullptr && value->value.special != ConstValSpecialRuntime;
-                if (is_comptime)
-                    return nullptr;
-            }
-            if ((err = type_resolve(ira->codegen, ira->explicit_return_type, ResolveStatusZeroBitsKnown))) {
-                return ira->codegen->invalid_instruction;
-            }
-            if (!type_has_bits(ira->explicit_return_type) || !handle_is_ptr(ira->explicit_return_type))
-                return nullptr;
+static bool ir_analyze_fn_call_inline_arg(IrAnalyze *ira, AstNode *fn_proto_node,
+    IrInstruction *arg, Scope **exec_scope, size_t *next_proto_i)
+{
+    AstNode *param_decl_node = fn_proto_node->data.fn_proto.params.at(*next_proto_i);
+    assert(param_decl_node->type == NodeTypeParamDecl);
 
-            ZigType *ptr_return_type = get_pointer_to_type(ira->codegen, ira->explicit_return_type, false);
-            result_loc->written = true;
-            result_loc->resolved_loc = ir_build_return_ptr(ira, result_loc->source_instruction, ptr_return_type);
-            if (ir_should_inline(ira->old_irb.exec, result_loc->source_instruction->scope)) {
-                set_up_result_loc_for_inferred_comptime(result_loc->resolved_loc);
-            }
-            return result_loc->resolved_loc;
-        }
-        case ResultLocIdPeer: {
-            ResultLocPeer *result_peer = reinterpret_cast<ResultLocPeer *>(result_loc);
-            ResultLocPeerParent *peer_parent = result_peer->parent;
+    IrInstruction *casted_arg;
+    if (param_decl_node->data.param_decl.var_token == nullptr) {
+        AstNode *param_type_node = param_decl_node->data.param_decl.type;
+        ZigType *param_type = ir_analyze_type_expr(ira, *exec_scope, param_type_node);
+        if (type_is_invalid(param_type))
+            return false;
 
-            if (peer_parent->peers.length == 1) {
-                IrInstruction *parent_result_loc = ir_resolve_result(ira, suspend_source_instr, peer_parent->parent,
-                        value_type, value, force_runtime, non_null_comptime);
-                result_peer->suspend_pos.basic_block_index = SIZE_MAX;
-                result_peer->suspend_pos.instruction_index = SIZE_MAX;
-                if (parent_result_loc == nullptr || type_is_invalid(parent_result_loc->value.type) ||
-                    parent_result_loc->value.type->id == ZigTypeIdUnreachable)
-                {
-                    return parent_result_loc;
-                }
-                result_loc->written = true;
-                result_loc->resolved_loc = parent_result_loc;
-                return result_loc->resolved_loc;
-            }
+        casted_arg = ir_implicit_cast(ira, arg, param_type);
+        if (type_is_invalid(casted_arg->value->type))
+            return false;
+    } else {
+        casted_arg = arg;
+    }
 
-            bool is_comptime;
-            if (!ir_resolve_comptime(ira, peer_parent->is_comptime->child, &is_comptime))
-                return ira->codegen->invalid_instruction;
-            peer_parent->skipped = is_comptime;
-            if (peer_parent->skipped) {
-                if (non_null_comptime) {
-                    return ir_resolve_result(ira, suspend_source_instr, peer_parent->parent,
-                            value_type, value, force_runtime, non_null_comptime);
-                }
-                return nullptr;
-            }
+    ConstExprValue *arg_val = ir_resolve_const(ira, casted_arg, UndefOk);
+    if (!arg_val)
+        return false;
 
-            if (peer_parent->resolved_type == nullptr) {
-                if (peer_parent->end_bb->suspend_instruction_ref == nullptr) {
-                    peer_parent->end_bb->suspend_instruction_ref = suspend_source_instr;
-                }
-                IrInstruction *unreach_inst = ira_suspend(ira, suspend_source_instr, result_peer->next_bb,
-                        &result_peer->suspend_pos);
-                if (result_peer->next_bb == nullptr) {
-                    ir_start_next_bb(ira);
-                }
-                return unreach_inst;
-            }
+    Buf *param_name = param_decl_node->data.param_decl.name;
+    ZigVar *var = add_variable(ira->codegen, param_decl_node,
+        *exec_scope, param_name, true, arg_val, nullptr, arg_val->type);
+    *exec_scope = var->child_scope;
+    *next_proto_i += 1;
 
-            IrInstruction *parent_result_loc = ir_resolve_result(ira, suspend_source_instr, peer_parent->parent,
-                    peer_parent->resolved_type, nullptr, force_runtime, non_null_comptime);
-            if (parent_result_loc == nullptr || type_is_invalid(parent_result_loc->value.type) ||
-                parent_result_loc->value.type->id == ZigTypeIdUnreachable)
-            {
-                return parent_result_loc;
-            }
-            // because is_comptime is false, we mark this a runtime pointer
-            parent_result_loc->value.special = ConstValSpecialRuntime;
-            result_loc->written = true;
-            result_loc->resolved_loc = parent_result_loc;
-            return result_loc->resolved_loc;
+    return true;
+}
+
+static bool ir_analyze_fn_call_generic_arg(IrAnalyze *ira, AstNode *fn_proto_node,
+    IrInstruction *arg, Scope **child_scope, size_t *next_proto_i,
+    GenericFnTypeId *generic_id, FnTypeId *fn_type_id, IrInstruction **casted_args,
+    ZigFn *impl_fn)
+{
+    AstNode *param_decl_node = fn_proto_node->data.fn_proto.params.at(*next_proto_i);
+    assert(param_decl_node->type == NodeTypeParamDecl);
+    bool is_var_args = param_decl_node->data.param_decl.is_var_args;
+    bool arg_part_of_generic_id = false;
+    IrInstruction *casted_arg;
+    if (is_var_args) {
+        arg_part_of_generic_id = true;
+        casted_arg = arg;
+    } else {
+        if (param_decl_node->data.param_decl.var_token == nullptr) {
+            AstNode *param_type_node = param_decl_node->data.param_decl.type;
+            ZigType *param_type = ir_analyze_type_expr(ira, *child_scope, param_type_node);
+            if (type_is_invalid(param_type))
+                return false;
+
+            casted_arg = ir_implicit_cast(ira, arg, param_type);
+            if (type_is_invalid(casted_arg->value->type))
+                return false;
+        } else {
+            arg_part_of_generic_id = true;
+            casted_arg = arg;
         }
-        case ResultLocIdBitCast: {
-            ResultLocBitCast *result_bit_cast = reinterpret_cast<ResultLocBitCast *>(result_loc);
-            ZigType *dest_type = ir_resolve_type(ira, result_bit_cast->base.source_instruction->child);
-            if (type_is_invalid(dest_type))
-                return ira->codegen->invalid_instruction;
+    }
 
-            if (get_codegen_ptr_type(dest_type) != nullptr) {
-                ir_add_error(ira, result_loc->source_instruction,
-                        buf_sprintf("unable to @bitCast to pointer type '%s'", buf_ptr(&dest_type->name)));
-                return ira->codegen->invalid_instruction;
-            }
+    bool comptime_arg = param_decl_node->data.param_decl.is_inline ||
+        casted_arg->value->type->id == ZigTypeIdComptimeInt || casted_arg->value->type->id == ZigTypeIdComptimeFloat;
 
-            if (!type_can_bit_cast(dest_type)) {
-                ir_add_error(ira, result_loc->source_instruction,
-                        buf_sprintf("unable to @bitCast to type '%s'", buf_ptr(&dest_type->name)));
-                return ira->codegen->invalid_instruction;
-            }
+    ConstExprValue *arg_val;
 
-            if (get_codegen_ptr_type(value_type) != nullptr) {
-                ir_add_error(ira, suspend_source_instr,
-                    buf_sprintf("unable to @bitCast from pointer type '%s'", buf_ptr(&value_type->name)));
-                return ira->codegen->invalid_instruction;
-            }
+    if (comptime_arg) {
+        arg_part_of_generic_id = true;
+        arg_val = ir_resolve_const(ira, casted_arg, UndefBad);
+        if (!arg_val)
+            return false;
+    } else {
+        arg_val = create_const_runtime(casted_arg->value->type);
+    }
+    if (arg_part_of_generic_id) {
+        copy_const_val(&generic_id->params[generic_id->param_count], arg_val, true);
+        generic_id->param_count += 1;
+    }
+
+    Buf *param_name = param_decl_node->data.param_decl.name;
+    if (!param_name) return false;
+    if (!is_var_args) {
+        ZigVar *var = add_variable(ira->codegen, param_decl_node,
+            *child_scope, param_name, true, arg_val, nullptr, arg_val->type);
+        *child_scope = var->child_scope;
+        var->shadowable = !comptime_arg;
+
+        *next_proto_i += 1;
+    } else if (casted_arg->value->type->id == ZigTypeIdComptimeInt ||
+            casted_arg->value->type->id == ZigTypeIdComptimeFloat)
+    {
+        ir_add_error(ira, casted_arg,
+            buf_sprintf("compiler bug: integer and float literals in var args function must be casted. https://github.com/ziglang/zig/issues/557"));
+        return false;
+    }
 
-            if (!type_can_bit_cast(value_type)) {
-                ir_add_error(ira, suspend_source_instr,
-                        buf_sprintf("unable to @bitCast from type '%s'", buf_ptr(&value_type->name)));
-                return ira->codegen->invalid_instruction;
-            }
+    if (!comptime_arg) {
+        switch (type_requires_comptime(ira->codegen, casted_arg->value->type)) {
+        case ReqCompTimeYes:
+            ir_add_error(ira, casted_arg,
+                buf_sprintf("parameter of type '%s' requires comptime", buf_ptr(&casted_arg->value->type->name)));
+            return false;
+        case ReqCompTimeInvalid:
+            return false;
+        case ReqCompTimeNo:
+            break;
+        }
 
-            IrInstruction *bitcasted_value;
-            if (value != nullptr) {
-                bitcasted_value = ir_analyze_bit_cast(ira, result_loc->source_instruction, value, dest_type);
-            } else {
-                bitcasted_value = nullptr;
-            }
+        casted_args[fn_type_id->param_count] = casted_arg;
+        FnTypeParamInfo *param_info = &fn_type_id->param_info[fn_type_id->param_count];
+        param_info->type = casted_arg->value->type;
+        param_info->is_noalias = param_decl_node->data.param_decl.is_noalias;
+        impl_fn->param_source_nodes[fn_type_id->param_count] = param_decl_node;
+        fn_type_id->param_count += 1;
+    }
 
-            IrInstruction *parent_result_loc = ir_resolve_result(ira, suspend_source_instr, result_bit_cast->parent,
-                    dest_type, bitcasted_value, force_runtime, non_null_comptime);
-            if (parent_result_loc == nullptr || type_is_invalid(parent_result_loc->value.type) ||
-                parent_result_loc->value.type->id == ZigTypeIdUnreachable)
-            {
-                return parent_result_loc;
-            }
-            ZigType *parent_ptr_type = parent_result_loc->value.type;
-            assert(parent_ptr_type->id == ZigTypeIdPointer);
-            if ((err = type_resolve(ira->codegen, parent_ptr_type->data.pointer.child_type,
-                            ResolveStatusAlignmentKnown)))
-            {
-                return ira->codegen->invalid_instruction;
-            }
-            uint64_t parent_ptr_align = get_ptr_align(ira->codegen, parent_ptr_type);
-            ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, value_type,
-                    parent_ptr_type->data.pointer.is_const, parent_ptr_type->data.pointer.is_volatile, PtrLenSingle,
-                    parent_ptr_align, 0, 0, parent_ptr_type->data.pointer.allow_zero);
+    return true;
+}
 
-            result_loc->written = true;
-            result_loc->resolved_loc = ir_analyze_ptr_cast(ira, suspend_source_instr, parent_result_loc,
-                    ptr_type, result_bit_cast->base.source_instruction, false);
-            return result_loc->resolved_loc;
+static ZigVar *get_fn_var_by_index(ZigFn *fn_entry, size_t index) {
+    FnTypeParamInfo *src_param_info = &fn_entry->type_entry->data.fn.fn_type_id.param_info[index];
+    if (!type_has_bits(src_param_info->type))
+        return nullptr;
+
+    size_t next_var_i = 0;
+    for (size_t param_i = 0; param_i < index; param_i += 1) {
+        FnTypeParamInfo *src_param_info = &fn_entry->type_entry->data.fn.fn_type_id.param_info[param_i];
+        if (!type_has_bits(src_param_info->type)) {
+            continue;
         }
+
+        next_var_i += 1;
     }
-    zig_unreachable();
+    return fn_entry->variable_list.at(next_var_i);
 }
 
-static IrInstruction *ir_resolve_result(IrAnalyze *ira, IrInstruction *suspend_source_instr,
-        ResultLoc *result_loc_pass1, ZigType *value_type, IrInstruction *value, bool force_runtime,
-        bool non_null_comptime)
-{
-    IrInstruction *result_loc = ir_resolve_result_raw(ira, suspend_source_instr, result_loc_pass1, value_type,
-            value, force_runtime, non_null_comptime);
-    if (result_loc == nullptr || (instr_is_unreachable(result_loc) || type_is_invalid(result_loc->value.type)))
-        return result_loc;
+static IrInstruction *ir_get_var_ptr(IrAnalyze *ira, IrInstruction *instruction, ZigVar *var) {
+    while (var->next_var != nullptr) {
+        var = var->next_var;
+    }
 
-    if ((force_runtime || (value != nullptr && !instr_is_comptime(value))) &&
-        result_loc_pass1->written && result_loc->value.data.x_ptr.mut == ConstPtrMutInfer)
-    {
-        result_loc->value.special = ConstValSpecialRuntime;
+    if (var->mem_slot_index != SIZE_MAX && var->owner_exec->analysis == nullptr) {
+        assert(ira->codegen->errors.length != 0);
+        return ira->codegen->invalid_instruction;
     }
+    if (var->var_type == nullptr || type_is_invalid(var->var_type))
+        return ira->codegen->invalid_instruction;
 
-    ir_assert(result_loc->value.type->id == ZigTypeIdPointer, suspend_source_instr);
-    ZigType *actual_elem_type = result_loc->value.type->data.pointer.child_type;
-    if (actual_elem_type->id == ZigTypeIdOptional && value_type->id != ZigTypeIdOptional &&
-            value_type->id != ZigTypeIdNull)
-    {
-        return ir_analyze_unwrap_optional_payload(ira, suspend_source_instr, result_loc, false, true);
-    } else if (actual_elem_type->id == ZigTypeIdErrorUnion && value_type->id != ZigTypeIdErrorUnion) {
-        if (value_type->id == ZigTypeIdErrorSet) {
-            return ir_analyze_unwrap_err_code(ira, suspend_source_instr, result_loc, true);
-        } else {
-            IrInstruction *unwrapped_err_ptr = ir_analyze_unwrap_error_payload(ira, suspend_source_instr,
-                    result_loc, false, true);
-            ZigType *actual_payload_type = actual_elem_type->data.error_union.payload_type;
-            if (actual_payload_type->id == ZigTypeIdOptional && value_type->id != ZigTypeIdOptional) {
-                return ir_analyze_unwrap_optional_payload(ira, suspend_source_instr, unwrapped_err_ptr, false, true);
-            } else {
-                return unwrapped_err_ptr;
+    ConstExprValue *mem_slot = nullptr;
+
+    bool comptime_var_mem = ir_get_var_is_comptime(var);
+    bool linkage_makes_it_runtime = var->decl_node->data.variable_declaration.is_extern;
+    bool is_const = var->src_is_const;
+    bool is_volatile = false;
+
+    if (linkage_makes_it_runtime)
+        goto no_mem_slot;
+
+    if (var->const_value->special == ConstValSpecialStatic) {
+        mem_slot = var->const_value;
+    } else {
+        if (var->mem_slot_index != SIZE_MAX && (comptime_var_mem || var->gen_is_const)) {
+            // find the relevant exec_context
+            assert(var->owner_exec != nullptr);
+            assert(var->owner_exec->analysis != nullptr);
+            IrExecContext *exec_context = &var->owner_exec->analysis->exec_context;
+            assert(var->mem_slot_index < exec_context->mem_slot_list.length);
+            mem_slot = exec_context->mem_slot_list.at(var->mem_slot_index);
+        }
+    }
+
+    if (mem_slot != nullptr) {
+        switch (mem_slot->special) {
+            case ConstValSpecialRuntime:
+                goto no_mem_slot;
+            case ConstValSpecialStatic: // fallthrough
+            case ConstValSpecialUndef: {
+                ConstPtrMut ptr_mut;
+                if (comptime_var_mem) {
+                    ptr_mut = ConstPtrMutComptimeVar;
+                } else if (var->gen_is_const) {
+                    ptr_mut = ConstPtrMutComptimeConst;
+                } else {
+                    assert(!comptime_var_mem);
+                    ptr_mut = ConstPtrMutRuntimeVar;
+                }
+                return ir_get_const_ptr(ira, instruction, mem_slot, var->var_type,
+                        ptr_mut, is_const, is_volatile, var->align_bytes);
             }
         }
-    } else if (is_slice(actual_elem_type) && value_type->id == ZigTypeIdArray) {
-        // need to allow EndExpr to do the implicit cast from array to slice
-        result_loc_pass1->written = false;
+        zig_unreachable();
     }
-    return result_loc;
-}
 
-static IrInstruction *ir_analyze_instruction_implicit_cast(IrAnalyze *ira, IrInstructionImplicitCast *instruction) {
-    ZigType *dest_type = ir_resolve_type(ira, instruction->dest_type->child);
-    if (type_is_invalid(dest_type))
-        return ira->codegen->invalid_instruction;
+no_mem_slot:
 
-    IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
-        return ira->codegen->invalid_instruction;
+    IrInstruction *var_ptr_instruction = ir_build_var_ptr(&ira->new_irb,
+            instruction->scope, instruction->source_node, var);
+    var_ptr_instruction->value->type = get_pointer_to_type_extra(ira->codegen, var->var_type,
+            var->src_is_const, is_volatile, PtrLenSingle, var->align_bytes, 0, 0, false);
 
-    return ir_implicit_cast_with_result(ira, target, dest_type, instruction->result_loc);
-}
+    bool in_fn_scope = (scope_fn_entry(var->parent_scope) != nullptr);
+    var_ptr_instruction->value->data.rh_ptr = in_fn_scope ? RuntimeHintPtrStack : RuntimeHintPtrNonStack;
 
-static IrInstruction *ir_analyze_instruction_resolve_result(IrAnalyze *ira, IrInstructionResolveResult *instruction) {
-    ZigType *implicit_elem_type = ir_resolve_type(ira, instruction->ty->child);
-    if (type_is_invalid(implicit_elem_type))
-        return ira->codegen->invalid_instruction;
-    IrInstruction *result_loc = ir_resolve_result(ira, &instruction->base, instruction->result_loc,
-            implicit_elem_type, nullptr, false, true);
-    if (result_loc != nullptr)
-        return result_loc;
+    return var_ptr_instruction;
+}
 
-    ZigFn *fn = exec_fn_entry(ira->new_irb.exec);
-    if (fn != nullptr && fn->type_entry->data.fn.fn_type_id.cc == CallingConventionAsync &&
-            instruction->result_loc->id == ResultLocIdReturn)
+// Stores a byte into an element of a packed u8 array without expanding the
+// array. Returns false for any other store.
+static bool ir_store_packed_byte(CodeGen *g, ConstExprValue *ptr_val, ConstExprValue *value) {
+    if (ptr_val->data.x_ptr.special != ConstPtrSpecialBaseArray ||
+        ptr_val->type->data.pointer.child_type != g->builtin_types.entry_u8 ||
+        value->special != ConstValSpecialStatic)
     {
-        result_loc = ir_resolve_result(ira, &instruction->base, no_result_loc(),
-                implicit_elem_type, nullptr, false, true);
-        if (result_loc != nullptr &&
-                (type_is_invalid(result_loc->value.type) || instr_is_unreachable(result_loc)))
+        return false;
+    }
+    ConstExprValue *array_val = ptr_val->data.x_ptr.data.base_array.array_val;
+    if (array_val->special != ConstValSpecialStatic || array_val->data.x_array.special != ConstArraySpecialBuf)
+        return false;
+    size_t elem_index = ptr_val->data.x_ptr.data.base_array.elem_index;
+    if (elem_index >= buf_len(array_val->data.x_array.data.s_buf))
+        return false;
+    Buf *bytes = ir_own_packed_bytes(array_val);
+    buf_ptr(bytes)[elem_index] = (char)bigint_as_unsigned(&value->data.x_bigint);
+    return true;
+}
+
+static IrInstruction *ir_analyze_store_ptr(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *ptr, IrInstruction *uncasted_value)
+{
+    assert(ptr->value->type->id == ZigTypeIdPointer);
+
+    if (ptr->value->data.x_ptr.special == ConstPtrSpecialDiscard) {
+        if (uncasted_value->value->type->id == ZigTypeIdErrorUnion ||
+            uncasted_value->value->type->id == ZigTypeIdErrorSet)
         {
-            return result_loc;
+            ir_add_error(ira, source_instr, buf_sprintf("error is discarded"));
+            return ira->codegen->invalid_instruction;
         }
-        result_loc->value.special = ConstValSpecialRuntime;
-        return result_loc;
+        return ir_const_void(ira, source_instr);
     }
 
-    IrInstruction *result = ir_const(ira, &instruction->base, implicit_elem_type);
-    result->value.special = ConstValSpecialUndef;
-    IrInstruction *ptr = ir_get_ref(ira, &instruction->base, result, false, false);
-    ptr->value.data.x_ptr.mut = ConstPtrMutComptimeVar;
-    return ptr;
-}
+    ZigType *child_type = ptr->value->type->data.pointer.child_type;
 
-static void ir_reset_result(ResultLoc *result_loc) {
-    result_loc->written = false;
-    result_loc->resolved_loc = nullptr;
-    result_loc->gen_instruction = nullptr;
-    result_loc->implicit_elem_type = nullptr;
-    switch (result_loc->id) {
-        case ResultLocIdInvalid:
-            zig_unreachable();
-        case ResultLocIdPeerParent: {
-            ResultLocPeerParent *peer_parent = reinterpret_cast<ResultLocPeerParent *>(result_loc);
-            peer_parent->skipped = false;
-            peer_parent->done_resuming = false;
-            peer_parent->resolved_type = nullptr;
-            for (size_t i = 0; i < peer_parent->peers.length; i += 1) {
-                ir_reset_result(&peer_parent->peers.at(i)->base);
-            }
+    if (ptr->value->type->data.pointer.is_const && !source_instr->is_gen) {
+        ir_add_error(ira, source_instr, buf_sprintf("cannot assign to constant"));
+        return ira->codegen->invalid_instruction;
+    }
+
+    IrInstruction *value = ir_implicit_cast(ira, uncasted_value, child_type);
+    if (value == ira->codegen->invalid_instruction)
+        return ira->codegen->invalid_instruction;
+
+    switch (type_has_one_possible_value(ira->codegen, child_type)) {
+        case OnePossibleValueInvalid:
+            return ira->codegen->invalid_instruction;
+        case OnePossibleValueYes:
+            return ir_const_void(ira, source_instr);
+        case OnePossibleValueNo:
             break;
+    }
+
+    if (instr_is_comptime(ptr) && ptr->value->data.x_ptr.special != ConstPtrSpecialHardCodedAddr) {
+        if (ptr->value->data.x_ptr.mut == ConstPtrMutComptimeConst) {
+            ir_add_error(ira, source_instr, buf_sprintf("cannot assign to constant"));
+            return ira->codegen->invalid_instruction;
         }
-        case ResultLocIdVar: {
-            IrInstructionAllocaSrc *alloca_src =
-                reinterpret_cast<IrInstructionAllocaSrc *>(result_loc->source_instruction);
-            alloca_src->base.child = nullptr;
-            break;
+        if (ptr->value->data.x_ptr.mut == ConstPtrMutComptimeVar ||
+            ptr->value->data.x_ptr.mut == ConstPtrMutInfer)
+        {
+            if (instr_is_comptime(value)) {
+                bool stored = ir_store_packed_byte(ira->codegen, ptr->value, value->value);
+                ConstExprValue *dest_val = nullptr;
+                if (!stored) {
+                    dest_val = const_ptr_pointee(ira, ira->codegen, ptr->value, source_instr->source_node);
+                    if (dest_val == nullptr)
+                        return ira->codegen->invalid_instruction;
+                }
+                if (stored || dest_val->special != ConstValSpecialRuntime) {
+                    if (!stored) {
+                        // TODO this allows a value stored to have the original value modified and then
+                        // have that affect what should be a copy. We need some kind of advanced copy-on-write
+                        // system to make these two tests pass at the same time:
+                        // * "string literal used as comptime slice is memoized"
+                        // * "comptime modification of const struct field" - except modified to avoid
+                        //   ConstPtrMutComptimeVar, thus defeating the logic below.
+                        bool same_global_refs = ptr->value->data.x_ptr.mut != ConstPtrMutComptimeVar;
+                        copy_const_val(dest_val, value->value, same_global_refs);
+                    }
+                    if (ptr->value->data.x_ptr.mut == ConstPtrMutComptimeVar &&
+                        !ira->new_irb.current_basic_block->must_be_comptime_source_instr)
+                    {
+                        ira->new_irb.current_basic_block->must_be_comptime_source_instr = source_instr;
+                    }
+                    return ir_const_void(ira, source_instr);
+                }
+            }
+            if (ptr->value->data.x_ptr.mut == ConstPtrMutInfer) {
+                ptr->value->special = ConstValSpecialRuntime;
+            } else {
+                ir_add_error(ira, source_instr,
+                        buf_sprintf("cannot store runtime value in compile time variable"));
+                ConstExprValue *dest_val = const_ptr_pointee_unchecked(ira->codegen, ptr->value);
+                dest_val->type = ira->codegen->builtin_types.entry_invalid;
+
+                return ira->codegen->invalid_instruction;
+            }
         }
-        case ResultLocIdPeer:
-        case ResultLocIdNone:
-        case ResultLocIdReturn:
-        case ResultLocIdInstruction:
-        case ResultLocIdBitCast:
+    }
+
+    switch (type_requires_comptime(ira->codegen, child_type)) {
+        case ReqCompTimeInvalid:
+            return ira->codegen->invalid_instruction;
+        case ReqCompTimeYes:
+            switch (type_has_one_possible_value(ira->codegen, ptr->value->type)) {
+                case OnePossibleValueInvalid:
+                    return ira->codegen->invalid_instruction;
+                case OnePossibleValueNo:
+                    ir_add_error(ira, source_instr,
+                            buf_sprintf("cannot store runtime value in type '%s'", buf_ptr(&child_type->name)));
+                    return ira->codegen->invalid_instruction;
+                case OnePossibleValueYes:
+                    return ir_const_void(ira, source_instr);
+            }
+            zig_unreachable();
+        case ReqCompTimeNo:
             break;
     }
+
+    IrInstruction *result = ir_build_store(&ira->new_irb, source_instr->scope, source_instr->source_node,
+        ptr, value);
+    result->value->type = ira->codegen->builtin_types.entry_void;
+    return result;
 }
 
-static IrInstruction *ir_analyze_instruction_reset_result(IrAnalyze *ira, IrInstructionResetResult *instruction) {
-    ir_reset_result(instruction->result_loc);
-    return ir_const_void(ira, &instruction->base);
+// Results of cacheable comptime calls are also kept in the cache directory,
+// so that a later build with the same input parameters can skip the call.
+// An entry lists the files the call depends on: the file that declares the
+// function, the files that declare the types in its key and result, and
+// every file these fetched with @import or @embedFile, transitively. The
+// entry is only used while each of them has the same contents.
+// Entries are never invalidated, only replaced, so once a build has stored
+// some, the least recently used beyond comptime_cache_max_entries are deleted.
+static const uint32_t comptime_cache_magic = 0x5a434532;
+static const size_t comptime_cache_max_entries = 16384;
+static const int64_t comptime_cache_min_age_sec = 60 * 60;
+
+struct ComptimeCacheReader {
+    const uint8_t *ptr;
+    size_t len;
+    size_t pos;
+};
+
+// Where the result of a call is kept, and the imports its key refers to.
+struct ComptimeCacheEntry {
+    Buf *path;
+    ZigList<ZigType *> imports;
+};
+
+// What a comptime call must leave unchanged for its result to be stored.
+struct ComptimeCacheMark {
+    size_t backward_branch_count;
+    size_t backward_branch_quota;
+    size_t errors_by_index_len;
+    size_t fn_defs_len;
+    size_t global_vars_len;
+    size_t resolve_queue_len;
+    int exported_symbol_count;
+};
+
+static void comptime_cache_write(Buf *out, const void *ptr, size_t len) {
+    buf_append_mem(out, (const char *)ptr, len);
 }
 
-static IrInstruction *ir_analyze_async_call(IrAnalyze *ira, IrInstructionCallSrc *call_instruction, ZigFn *fn_entry,
-        ZigType *fn_type, IrInstruction *fn_ref, IrInstruction **casted_args, size_t arg_count,
-        IrInstruction *async_allocator_inst)
-{
-    Buf *realloc_field_name = buf_create_from_str(ASYNC_REALLOC_FIELD_NAME);
-    ir_assert(async_allocator_inst->value.type->id == ZigTypeIdPointer, &call_instruction->base);
-    ZigType *container_type = async_allocator_inst->value.type->data.pointer.child_type;
-    IrInstruction *field_ptr_inst = ir_analyze_container_field_ptr(ira, realloc_field_name, &call_instruction->base,
-            async_allocator_inst, container_type, false);
-    if (type_is_invalid(field_ptr_inst->value.type)) {
-        return ira->codegen->invalid_instruction;
-    }
-    ZigType *ptr_to_realloc_fn_type = field_ptr_inst->value.type;
-    ir_assert(ptr_to_realloc_fn_type->id == ZigTypeIdPointer, &call_instruction->base);
+static void comptime_cache_write_u64(Buf *out, uint64_t x) {
+    comptime_cache_write(out, &x, sizeof(x));
+}
 
-    ZigType *realloc_fn_type = ptr_to_realloc_fn_type->data.pointer.child_type;
-    if (realloc_fn_type->id != ZigTypeIdFn) {
-        ir_add_error(ira, &call_instruction->base,
-                buf_sprintf("expected reallocation function, found '%s'", buf_ptr(&realloc_fn_type->name)));
-        return ira->codegen->invalid_instruction;
+static bool comptime_cache_read(ComptimeCacheReader *r, void *dest, size_t len) {
+    if (r->len - r->pos < len)
+        return false;
+    memcpy(dest, r->ptr + r->pos, len);
+    r->pos += len;
+    return true;
+}
+
+static bool comptime_cache_skip_str(ComptimeCacheReader *r) {
+    const void *end = memchr(r->ptr + r->pos, '\0', r->len - r->pos);
+    if (end == nullptr)
+        return false;
+    r->pos = (const uint8_t *)end - r->ptr + 1;
+    return true;
+}
+
+static void comptime_cache_write_bigint(Buf *out, const BigInt *bigint) {
+    comptime_cache_write_u64(out, bigint->digit_count);
+    comptime_cache_write_u64(out, bigint->is_negative);
+    if (bigint->digit_count != 0)
+        comptime_cache_write(out, bigint_ptr(bigint), bigint->digit_count * sizeof(uint64_t));
+}
+
+static bool comptime_cache_read_bigint(ComptimeCacheReader *r, BigInt *bigint) {
+    uint64_t digit_count;
+    uint64_t is_negative;
+    if (!comptime_cache_read(r, &digit_count, sizeof(digit_count)) ||
+        !comptime_cache_read(r, &is_negative, sizeof(is_negative)) ||
+        digit_count > (r->len - r->pos) / sizeof(uint64_t))
+    {
+        return false;
     }
+    uint64_t *digits = allocate_nonzero<uint64_t>(digit_count);
+    comptime_cache_read(r, digits, digit_count * sizeof(uint64_t));
+    bigint_init_data(bigint, digits, digit_count, is_negative != 0);
+    free(digits);
+    return true;
+}
 
-    ZigType *realloc_fn_return_type = realloc_fn_type->data.fn.fn_type_id.return_type;
-    if (realloc_fn_return_type->id != ZigTypeIdErrorUnion) {
-        ir_add_error(ira, fn_ref,
-            buf_sprintf("expected allocation function to return error union, but it returns '%s'", buf_ptr(&realloc_fn_return_type->name)));
-        return ira->codegen->invalid_instruction;
+static void comptime_cache_add_import(ZigList<ZigType *> *imports, ZigType *import) {
+    for (size_t i = 0; i < imports->length; i += 1) {
+        if (imports->at(i) == import)
+            return;
     }
-    ZigType *alloc_fn_error_set_type = realloc_fn_return_type->data.error_union.err_set_type;
-    ZigType *return_type = fn_type->data.fn.fn_type_id.return_type;
-    ZigType *promise_type = get_promise_type(ira->codegen, return_type);
-    ZigType *async_return_type = get_error_union_type(ira->codegen, alloc_fn_error_set_type, promise_type);
+    imports->append(import);
+}
 
-    IrInstruction *result_loc = ir_resolve_result(ira, &call_instruction->base, no_result_loc(),
-            async_return_type, nullptr, true, true);
-    if (type_is_invalid(result_loc->value.type) || instr_is_unreachable(result_loc)) {
-        return result_loc;
+// A container is identified by where it is declared. That is only enough when
+// no function body, and so no generic instantiation, encloses the declaration.
+// The file it is declared in becomes an input of the entry.
+static bool comptime_cache_write_decl(Buf *out, ZigList<ZigType *> *imports, Scope *scope) {
+    for (Scope *it = scope->parent; it != nullptr; it = it->parent) {
+        if (it->id != ScopeIdDecls)
+            return false;
     }
+    ZigType *import = get_scope_import(scope);
+    buf_appendf(out, "%s:%" ZIG_PRI_usize ":%" ZIG_PRI_usize, buf_ptr(import->data.structure.root_struct->path),
+            scope->source_node->line, scope->source_node->column);
+    buf_append_char(out, '\0');
+    comptime_cache_add_import(imports, import);
+    return true;
+}
 
-    return ir_build_call_gen(ira, &call_instruction->base, fn_entry, fn_ref, arg_count,
-            casted_args, FnInlineAuto, true, async_allocator_inst, nullptr, result_loc,
-            async_return_type);
+static bool comptime_cache_write_type(Buf *out, ZigList<ZigType *> *imports, ZigType *type) {
+    buf_append_buf(out, &type->name);
+    buf_append_char(out, '\0');
+    switch (type->id) {
+        case ZigTypeIdStruct:
+            // The elements of a slice identify their own types.
+            if (type->data.structure.is_slice)
+                return true;
+            return type->data.structure.decls_scope != nullptr &&
+                comptime_cache_write_decl(out, imports, &type->data.structure.decls_scope->base);
+        case ZigTypeIdEnum:
+            return type->data.enumeration.decls_scope != nullptr &&
+                comptime_cache_write_decl(out, imports, &type->data.enumeration.decls_scope->base);
+        default:
+            return true;
+    }
 }
 
-static bool ir_analyze_fn_call_inline_arg(IrAnalyze *ira, AstNode *fn_proto_node,
-    IrInstruction *arg, Scope **exec_scope, size_t *next_proto_i)
-{
-    AstNode *param_decl_node = fn_proto_node->data.fn_proto.params.at(*next_proto_i);
-    assert(param_decl_node->type == NodeTypeParamDecl);
+// The payload of these optionals is not stored in x_optional.
+static bool comptime_cache_optional_ok(ZigType *type) {
+    ZigType *child_type = type->data.maybe.child_type;
+    return get_codegen_ptr_type(type) == nullptr && child_type->id != ZigTypeIdErrorSet;
+}
 
-    IrInstruction *casted_arg;
-    if (param_decl_node->data.param_decl.var_token == nullptr) {
-        AstNode *param_type_node = param_decl_node->data.param_decl.type;
-        ZigType *param_type = ir_analyze_type_expr(ira, *exec_scope, param_type_node);
-        if (type_is_invalid(param_type))
-            return false;
+static bool comptime_cache_write_val(Buf *out, ZigList<ZigType *> *imports, ConstExprValue *val);
 
-        casted_arg = ir_implicit_cast(ira, arg, param_type);
-        if (type_is_invalid(casted_arg->value.type))
+static bool comptime_cache_write_elems(Buf *out, ZigList<ZigType *> *imports, ConstExprValue *array_val,
+        size_t start, size_t len)
+{
+    switch (array_val->data.x_array.special) {
+        case ConstArraySpecialUndef:
             return false;
-    } else {
-        casted_arg = arg;
+        case ConstArraySpecialBuf:
+            buf_append_char(out, 1);
+            buf_append_mem(out, buf_ptr(array_val->data.x_array.data.s_buf) + start, len);
+            return true;
+        case ConstArraySpecialNone:
+            buf_append_char(out, 0);
+            for (size_t i = start; i < start + len; i += 1) {
+                if (!comptime_cache_write_val(out, imports, &array_val->data.x_array.data.s_none.elements[i]))
+                    return false;
+            }
+            return true;
     }
+    zig_unreachable();
+}
 
-    ConstExprValue *arg_val = ir_resolve_const(ira, casted_arg, UndefOk);
-    if (!arg_val)
+// A slice is stored as its length and the elements it refers to. Read back,
+// it refers to a new array of just those elements.
+static bool comptime_cache_write_slice(Buf *out, ZigList<ZigType *> *imports, ConstExprValue *val) {
+    ConstExprValue *ptr_val = &val->data.x_struct.fields[slice_ptr_index];
+    ConstExprValue *len_val = &val->data.x_struct.fields[slice_len_index];
+    if (ptr_val->special != ConstValSpecialStatic || len_val->special != ConstValSpecialStatic)
         return false;
-
-    Buf *param_name = param_decl_node->data.param_decl.name;
-    ZigVar *var = add_variable(ira->codegen, param_decl_node,
-        *exec_scope, param_name, true, arg_val, nullptr, arg_val->type);
-    *exec_scope = var->child_scope;
-    *next_proto_i += 1;
-
-    return true;
+    if (ptr_val->data.x_ptr.special != ConstPtrSpecialBaseArray || ptr_val->data.x_ptr.data.base_array.is_cstr)
+        return false;
+    if (ptr_val->data.x_ptr.mut != ConstPtrMutComptimeConst && ptr_val->data.x_ptr.mut != ConstPtrMutComptimeVar)
+        return false;
+    ConstExprValue *array_val = ptr_val->data.x_ptr.data.base_array.array_val;
+    if (array_val->special != ConstValSpecialStatic || array_val->type->id != ZigTypeIdArray)
+        return false;
+    size_t start = ptr_val->data.x_ptr.data.base_array.elem_index;
+    uint64_t len = bigint_as_unsigned(&len_val->data.x_bigint);
+    if (start > array_val->type->data.array.len || len > array_val->type->data.array.len - start)
+        return false;
+    comptime_cache_write_u64(out, len);
+    return comptime_cache_write_elems(out, imports, array_val, start, len);
 }
 
-static bool ir_analyze_fn_call_generic_arg(IrAnalyze *ira, AstNode *fn_proto_node,
-    IrInstruction *arg, Scope **child_scope, size_t *next_proto_i,
-    GenericFnTypeId *generic_id, FnTypeId *fn_type_id, IrInstruction **casted_args,
-    ZigFn *impl_fn)
-{
-    AstNode *param_decl_node = fn_proto_node->data.fn_proto.params.at(*next_proto_i);
-    assert(param_decl_node->type == NodeTypeParamDecl);
-    bool is_var_args = param_decl_node->data.param_decl.is_var_args;
-    bool arg_part_of_generic_id = false;
-    IrInstruction *casted_arg;
-    if (is_var_args) {
-        arg_part_of_generic_id = true;
-        casted_arg = arg;
-    } else {
-        if (param_decl_node->data.param_decl.var_token == nullptr) {
-            AstNode *param_type_node = param_decl_node->data.param_decl.type;
-            ZigType *param_type = ir_analyze_type_expr(ira, *child_scope, param_type_node);
-            if (type_is_invalid(param_type))
+// Writes the value, or returns false if it has a part that cannot be stored.
+static bool comptime_cache_write_val(Buf *out, ZigList<ZigType *> *imports, ConstExprValue *val) {
+    if (val->special != ConstValSpecialStatic)
+        return false;
+    ZigType *type = val->type;
+    switch (type->id) {
+        case ZigTypeIdVoid:
+            return true;
+        case ZigTypeIdBool:
+            buf_append_char(out, val->data.x_bool ? 1 : 0);
+            return true;
+        case ZigTypeIdInt:
+        case ZigTypeIdComptimeInt:
+            comptime_cache_write_bigint(out, &val->data.x_bigint);
+            return true;
+        case ZigTypeIdEnum:
+            if (!comptime_cache_write_type(out, imports, type))
+                return false;
+            comptime_cache_write_bigint(out, &val->data.x_enum_tag);
+            return true;
+        case ZigTypeIdFloat: {
+            uint8_t bytes[16];
+            float_write_ieee597(val, bytes, false);
+            comptime_cache_write(out, bytes, type->data.floating.bit_count / 8);
+            return true;
+        }
+        case ZigTypeIdComptimeFloat:
+            comptime_cache_write(out, &val->data.x_bigfloat, sizeof(BigFloat));
+            return true;
+        case ZigTypeIdOptional:
+            if (!comptime_cache_optional_ok(type))
+                return false;
+            buf_append_char(out, val->data.x_optional == nullptr ? 0 : 1);
+            return val->data.x_optional == nullptr || comptime_cache_write_val(out, imports, val->data.x_optional);
+        case ZigTypeIdArray:
+            return comptime_cache_write_elems(out, imports, val, 0, type->data.array.len);
+        case ZigTypeIdVector:
+            return comptime_cache_write_elems(out, imports, val, 0, type->data.vector.len);
+        case ZigTypeIdStruct:
+            if (type->data.structure.is_slice)
+                return comptime_cache_write_slice(out, imports, val);
+            if (!comptime_cache_write_type(out, imports, type))
                 return false;
+            for (size_t i = 0; i < type->data.structure.src_field_count; i += 1) {
+                if (!comptime_cache_write_val(out, imports, &val->data.x_struct.fields[i]))
+                    return false;
+            }
+            return true;
+        default:
+            return false;
+    }
+}
 
-            casted_arg = ir_implicit_cast(ira, arg, param_type);
-            if (type_is_invalid(casted_arg->value.type))
+// Only the types that comptime_cache_read_val can build are stored as results.
+static bool comptime_cache_result_type_ok(ZigType *type) {
+    switch (type->id) {
+        case ZigTypeIdVoid:
+        case ZigTypeIdBool:
+        case ZigTypeIdInt:
+        case ZigTypeIdComptimeInt:
+        case ZigTypeIdEnum:
+        case ZigTypeIdFloat:
+        case ZigTypeIdComptimeFloat:
+            return true;
+        case ZigTypeIdOptional:
+            return comptime_cache_optional_ok(type) &&
+                comptime_cache_result_type_ok(type->data.maybe.child_type);
+        case ZigTypeIdArray:
+            return comptime_cache_result_type_ok(type->data.array.child_type);
+        case ZigTypeIdVector:
+            return comptime_cache_result_type_ok(type->data.vector.elem_type);
+        case ZigTypeIdStruct: {
+            if (type->data.structure.is_slice) {
+                // Read back, the slice is made by init_const_slice, so its
+                // pointer type must be the one that makes.
+                ZigType *ptr_type = type->data.structure.fields[slice_ptr_index].type_entry;
+                ZigType *elem_type = ptr_type->data.pointer.child_type;
+                return ptr_type->data.pointer.is_const && !ptr_type->data.pointer.is_volatile &&
+                    !ptr_type->data.pointer.allow_zero && ptr_type->data.pointer.explicit_alignment == 0 &&
+                    ptr_type->data.pointer.host_int_bytes == 0 &&
+                    type_is_resolved(elem_type, ResolveStatusSizeKnown) &&
+                    comptime_cache_result_type_ok(elem_type);
+            }
+            if (!type_is_resolved(type, ResolveStatusSizeKnown))
                 return false;
-        } else {
-            arg_part_of_generic_id = true;
-            casted_arg = arg;
+            for (size_t i = 0; i < type->data.structure.src_field_count; i += 1) {
+                if (!comptime_cache_result_type_ok(type->data.structure.fields[i].type_entry))
+                    return false;
+            }
+            return true;
         }
+        default:
+            return false;
     }
+}
 
-    bool comptime_arg = param_decl_node->data.param_decl.is_inline ||
-        casted_arg->value.type->id == ZigTypeIdComptimeInt || casted_arg->value.type->id == ZigTypeIdComptimeFloat;
-
-    ConstExprValue *arg_val;
+static bool comptime_cache_read_val(CodeGen *g, ComptimeCacheReader *r, ConstExprValue *val);
 
-    if (comptime_arg) {
-        arg_part_of_generic_id = true;
-        arg_val = ir_resolve_const(ira, casted_arg, UndefBad);
-        if (!arg_val)
-            return false;
+// Reads the elements of an array or vector value whose type is set.
+static bool comptime_cache_read_elems(CodeGen *g, ComptimeCacheReader *r, ConstExprValue *val) {
+    ZigType *type = val->type;
+    size_t len;
+    ZigType *elem_type;
+    if (type->id == ZigTypeIdArray) {
+        len = type->data.array.len;
+        elem_type = type->data.array.child_type;
     } else {
-        arg_val = create_const_runtime(casted_arg->value.type);
+        len = type->data.vector.len;
+        elem_type = type->data.vector.elem_type;
     }
-    if (arg_part_of_generic_id) {
-        copy_const_val(&generic_id->params[generic_id->param_count], arg_val, true);
-        generic_id->param_count += 1;
+    uint8_t special;
+    if (!comptime_cache_read(r, &special, 1))
+        return false;
+    if (special == 1) {
+        if (type->id != ZigTypeIdArray || elem_type != g->builtin_types.entry_u8 || len > r->len - r->pos)
+            return false;
+        val->data.x_array.special = ConstArraySpecialBuf;
+        val->data.x_array.data.s_buf = buf_create_from_mem((const char *)r->ptr + r->pos, len);
+        r->pos += len;
+        return true;
+    }
+    if (special != 0)
+        return false;
+    val->data.x_array.special = ConstArraySpecialNone;
+    val->data.x_array.data.s_none.elements = create_const_vals(len);
+    for (size_t i = 0; i < len; i += 1) {
+        ConstExprValue *elem = &val->data.x_array.data.s_none.elements[i];
+        elem->type = elem_type;
+        elem->parent.id = ConstParentIdArray;
+        elem->parent.data.p_array.array_val = val;
+        elem->parent.data.p_array.elem_index = i;
+        if (!comptime_cache_read_val(g, r, elem))
+            return false;
     }
+    return true;
+}
 
-    Buf *param_name = param_decl_node->data.param_decl.name;
-    if (!param_name) return false;
-    if (!is_var_args) {
-        ZigVar *var = add_variable(ira->codegen, param_decl_node,
-            *child_scope, param_name, true, arg_val, nullptr, arg_val->type);
-        *child_scope = var->child_scope;
-        var->shadowable = !comptime_arg;
+static bool comptime_cache_read_slice(CodeGen *g, ComptimeCacheReader *r, ConstExprValue *val) {
+    uint64_t len;
+    if (!comptime_cache_read(r, &len, sizeof(len)) || len > r->len - r->pos)
+        return false;
+    ZigType *slice_type = val->type;
+    ZigType *ptr_type = slice_type->data.structure.fields[slice_ptr_index].type_entry;
+    ConstExprValue *array_val = create_const_vals(1);
+    array_val->special = ConstValSpecialStatic;
+    array_val->type = get_array_type(g, ptr_type->data.pointer.child_type, len);
+    if (!comptime_cache_read_elems(g, r, array_val))
+        return false;
+    init_const_slice(g, val, array_val, 0, len, true);
+    assert(val->type == slice_type);
+    return true;
+}
 
-        *next_proto_i += 1;
-    } else if (casted_arg->value.type->id == ZigTypeIdComptimeInt ||
-            casted_arg->value.type->id == ZigTypeIdComptimeFloat)
-    {
-        ir_add_error(ira, casted_arg,
-            buf_sprintf("compiler bug: integer and float literals in var args function must be casted. https://github.com/ziglang/zig/issues/557"));
+static bool comptime_cache_read_val(CodeGen *g, ComptimeCacheReader *r, ConstExprValue *val) {
+    ZigType *type = val->type;
+    val->special = ConstValSpecialStatic;
+    switch (type->id) {
+        case ZigTypeIdVoid:
+            return true;
+        case ZigTypeIdBool: {
+            uint8_t byte;
+            if (!comptime_cache_read(r, &byte, 1))
+                return false;
+            val->data.x_bool = (byte != 0);
+            return true;
+        }
+        case ZigTypeIdInt:
+        case ZigTypeIdComptimeInt:
+            return comptime_cache_read_bigint(r, &val->data.x_bigint);
+        case ZigTypeIdEnum:
+            // The type follows from the return type, so its identity only needs skipping.
+            if (!comptime_cache_skip_str(r) || !comptime_cache_skip_str(r))
+                return false;
+            return comptime_cache_read_bigint(r, &val->data.x_enum_tag);
+        case ZigTypeIdFloat: {
+            uint8_t bytes[16];
+            if (!comptime_cache_read(r, bytes, type->data.floating.bit_count / 8))
+                return false;
+            float_read_ieee597(val, bytes, false);
+            return true;
+        }
+        case ZigTypeIdComptimeFloat:
+            return comptime_cache_read(r, &val->data.x_bigfloat, sizeof(BigFloat));
+        case ZigTypeIdOptional: {
+            uint8_t non_null;
+            if (!comptime_cache_read(r, &non_null, 1))
+                return false;
+            if (non_null == 0) {
+                val->data.x_optional = nullptr;
+                return true;
+            }
+            ConstExprValue *payload = create_const_vals(1);
+            payload->type = type->data.maybe.child_type;
+            val->data.x_optional = payload;
+            return comptime_cache_read_val(g, r, payload);
+        }
+        case ZigTypeIdArray:
+        case ZigTypeIdVector:
+            return comptime_cache_read_elems(g, r, val);
+        case ZigTypeIdStruct: {
+            if (type->data.structure.is_slice)
+                return comptime_cache_read_slice(g, r, val);
+            if (!comptime_cache_skip_str(r) || !comptime_cache_skip_str(r))
+                return false;
+            size_t field_count = type->data.structure.src_field_count;
+            val->data.x_struct.fields = create_const_vals(field_count);
+            for (size_t i = 0; i < field_count; i += 1) {
+                ConstExprValue *field = &val->data.x_struct.fields[i];
+                field->type = type->data.structure.fields[i].type_entry;
+                field->parent.id = ConstParentIdStruct;
+                field->parent.data.p_struct.struct_val = val;
+                field->parent.data.p_struct.field_index = i;
+                if (!comptime_cache_read_val(g, r, field))
+                    return false;
+            }
+            return true;
+        }
+        default:
+            zig_unreachable();
+    }
+}
+
+// Finds the cache entry for this call. Returns false if the call cannot take
+// part in the comptime cache.
+static bool ir_comptime_cache_entry(CodeGen *g, ZigFn *fn_entry, Scope *exec_scope, ZigType *return_type,
+        ComptimeCacheEntry *entry)
+{
+    if (!g->enable_cache || buf_len(&g->cache_hash.b64_digest) == 0)
+        return false;
+    if (!comptime_cache_result_type_ok(return_type))
         return false;
-    }
 
-    if (!comptime_arg) {
-        switch (type_requires_comptime(ira->codegen, casted_arg->value.type)) {
-        case ReqCompTimeYes:
-            ir_add_error(ira, casted_arg,
-                buf_sprintf("parameter of type '%s' requires comptime", buf_ptr(&casted_arg->value.type->name)));
+    Buf *key = buf_alloc();
+    Scope *scope = exec_scope;
+    for (; scope->id == ScopeIdVarDecl; scope = scope->parent) {
+        ZigVar *var = reinterpret_cast<ScopeVarDecl *>(scope)->var;
+        if (var->const_value->type != var->var_type)
             return false;
-        case ReqCompTimeInvalid:
+        if (!comptime_cache_write_type(key, &entry->imports, var->var_type) ||
+            !comptime_cache_write_val(key, &entry->imports, var->const_value))
+        {
             return false;
-        case ReqCompTimeNo:
-            break;
         }
-
-        casted_args[fn_type_id->param_count] = casted_arg;
-        FnTypeParamInfo *param_info = &fn_type_id->param_info[fn_type_id->param_count];
-        param_info->type = casted_arg->value.type;
-        param_info->is_noalias = param_decl_node->data.param_decl.is_noalias;
-        impl_fn->param_source_nodes[fn_type_id->param_count] = param_decl_node;
-        fn_type_id->param_count += 1;
     }
+    assert(scope->id == ScopeIdFnDef);
+    if (!comptime_cache_write_decl(key, &entry->imports, scope))
+        return false;
+    buf_append_buf(key, &fn_entry->symbol_name);
+    buf_append_char(key, '\0');
+    if (!comptime_cache_write_type(key, &entry->imports, return_type))
+        return false;
 
+    if (g->comptime_cache_dir == nullptr) {
+        Buf *dir = buf_sprintf("%s" OS_SEP CACHE_COMPTIME_SUBDIR, buf_ptr(g->cache_dir));
+        if (os_make_path(dir) != ErrorNone)
+            return false;
+        g->comptime_cache_dir = dir;
+    }
+    Buf digest = BUF_INIT;
+    cache_mem_digest(&g->cache_hash, buf_ptr(key), buf_len(key), &digest);
+    entry->path = buf_alloc();
+    os_path_join(g->comptime_cache_dir, &digest, entry->path);
+    buf_deinit(&digest);
     return true;
 }
 
-static ZigVar *get_fn_var_by_index(ZigFn *fn_entry, size_t index) {
-    FnTypeParamInfo *src_param_info = &fn_entry->type_entry->data.fn.fn_type_id.param_info[index];
-    if (!type_has_bits(src_param_info->type))
-        return nullptr;
-
-    size_t next_var_i = 0;
-    for (size_t param_i = 0; param_i < index; param_i += 1) {
-        FnTypeParamInfo *src_param_info = &fn_entry->type_entry->data.fn.fn_type_id.param_info[param_i];
-        if (!type_has_bits(src_param_info->type)) {
-            continue;
+// The digest of the file as this compilation sees it: as it was loaded, or as
+// it is on disk if it has not been loaded.
+static bool comptime_cache_file_digest(CodeGen *g, Buf *path, uint8_t *bin_digest, bool *out_loaded) {
+    ZigList<CacheHashFile> *files = &g->cache_hash.files;
+    for (; g->comptime_cache_files_indexed < files->length; g->comptime_cache_files_indexed += 1) {
+        size_t i = g->comptime_cache_files_indexed;
+        g->comptime_cache_file_table.put(files->at(i).path, i);
+    }
+    auto entry = g->comptime_cache_file_table.maybe_get(path);
+    if (entry != nullptr) {
+        memcpy(bin_digest, files->at(entry->value).bin_digest, 48);
+        *out_loaded = true;
+        return true;
+    }
+    *out_loaded = false;
+    return cache_file_digest(path, bin_digest) == ErrorNone;
+}
+
+// Collects the files of the imports and everything they fetched, following
+// the fetched imports. Returns false if one of them used @cImport: its output
+// depends on headers that are not recorded here.
+static bool comptime_cache_collect_files(ZigList<ZigType *> *imports, ZigList<Buf *> *files) {
+    HashMap<const ZigType *, bool, type_ptr_hash, type_ptr_eql> seen_imports = {};
+    seen_imports.init(imports->length * 2);
+    HashMap<Buf *, bool, buf_hash, buf_eql_buf> seen_files = {};
+    seen_files.init(imports->length * 2);
+    ZigList<ZigType *> pending = {};
+    for (size_t i = 0; i < imports->length; i += 1) {
+        if (seen_imports.put_unique(imports->at(i), true) == nullptr)
+            pending.append(imports->at(i));
+    }
+    bool ok = true;
+    while (pending.length != 0) {
+        RootStruct *root_struct = pending.pop()->data.structure.root_struct;
+        if (root_struct->uses_c_import) {
+            ok = false;
+            break;
+        }
+        files->append(root_struct->path);
+        for (size_t i = 0; i < root_struct->fetched_imports.length; i += 1) {
+            ZigType *fetched = root_struct->fetched_imports.at(i);
+            if (seen_imports.put_unique(fetched, true) == nullptr)
+                pending.append(fetched);
+        }
+        for (size_t i = 0; i < root_struct->embedded_files.length; i += 1) {
+            Buf *path = root_struct->embedded_files.at(i);
+            if (seen_files.put_unique(path, true) == nullptr)
+                files->append(path);
         }
-
-        next_var_i += 1;
     }
-    return fn_entry->variable_list.at(next_var_i);
+    pending.deinit();
+    seen_files.deinit();
+    seen_imports.deinit();
+    return ok;
 }
 
-static IrInstruction *ir_get_var_ptr(IrAnalyze *ira, IrInstruction *instruction, ZigVar *var) {
-    while (var->next_var != nullptr) {
-        var = var->next_var;
-    }
+static ConstExprValue *ir_comptime_cache_load(IrAnalyze *ira, ComptimeCacheEntry *entry, ZigType *return_type) {
+    CodeGen *g = ira->codegen;
+    Buf *contents = buf_alloc();
+    if (os_fetch_file_path(entry->path, contents) != ErrorNone)
+        return nullptr;
 
-    if (var->mem_slot_index != SIZE_MAX && var->owner_exec->analysis == nullptr) {
-        assert(ira->codegen->errors.length != 0);
-        return ira->codegen->invalid_instruction;
+    ComptimeCacheReader r = {(const uint8_t *)buf_ptr(contents), buf_len(contents), 0};
+    uint32_t magic;
+    uint64_t quota;
+    uint64_t branch_count;
+    uint64_t file_count;
+    if (!comptime_cache_read(&r, &magic, sizeof(magic)) || magic != comptime_cache_magic ||
+        !comptime_cache_read(&r, &quota, sizeof(quota)) ||
+        !comptime_cache_read(&r, &branch_count, sizeof(branch_count)) ||
+        !comptime_cache_read(&r, &file_count, sizeof(file_count)))
+    {
+        return nullptr;
     }
-    if (var->var_type == nullptr || type_is_invalid(var->var_type))
-        return ira->codegen->invalid_instruction;
-
-    ConstExprValue *mem_slot = nullptr;
-
-    bool comptime_var_mem = ir_get_var_is_comptime(var);
-    bool linkage_makes_it_runtime = var->decl_node->data.variable_declaration.is_extern;
-    bool is_const = var->src_is_const;
-    bool is_volatile = false;
 
-    if (linkage_makes_it_runtime)
-        goto no_mem_slot;
+    // A call that ran under a higher quota may have raised it with
+    // @setEvalBranchQuota, which is not replayed here.
+    size_t *bbc = ira->new_irb.exec->backward_branch_count;
+    size_t *bb_quota = ira->new_irb.exec->backward_branch_quota;
+    if (quota > *bb_quota || *bbc > *bb_quota || branch_count > *bb_quota - *bbc)
+        return nullptr;
 
-    if (var->const_value->special == ConstValSpecialStatic) {
-        mem_slot = var->const_value;
-    } else {
-        if (var->mem_slot_index != SIZE_MAX && (comptime_var_mem || var->gen_is_const)) {
-            // find the relevant exec_context
-            assert(var->owner_exec != nullptr);
-            assert(var->owner_exec->analysis != nullptr);
-            IrExecContext *exec_context = &var->owner_exec->analysis->exec_context;
-            assert(var->mem_slot_index < exec_context->mem_slot_list.length);
-            mem_slot = exec_context->mem_slot_list.at(var->mem_slot_index);
+    // Files the call would have loaded itself, such as the target of an
+    // @embedFile in it, are checked on disk.
+    ZigList<Buf *> unloaded_files = {};
+    for (uint64_t i = 0; i < file_count; i += 1) {
+        uint64_t path_len;
+        if (!comptime_cache_read(&r, &path_len, sizeof(path_len)) || path_len > r.len - r.pos)
+            return nullptr;
+        Buf *path = buf_create_from_mem((const char *)r.ptr + r.pos, path_len);
+        r.pos += path_len;
+        uint8_t stored_digest[48];
+        uint8_t bin_digest[48];
+        bool loaded;
+        if (!comptime_cache_read(&r, stored_digest, 48) ||
+            !comptime_cache_file_digest(g, path, bin_digest, &loaded) ||
+            memcmp(stored_digest, bin_digest, 48) != 0)
+        {
+            unloaded_files.deinit();
+            return nullptr;
         }
+        if (!loaded)
+            unloaded_files.append(path);
     }
 
-    if (mem_slot != nullptr) {
-        switch (mem_slot->special) {
-            case ConstValSpecialRuntime:
-                goto no_mem_slot;
-            case ConstValSpecialStatic: // fallthrough
-            case ConstValSpecialUndef: {
-                ConstPtrMut ptr_mut;
-                if (comptime_var_mem) {
-                    ptr_mut = ConstPtrMutComptimeVar;
-                } else if (var->gen_is_const) {
-                    ptr_mut = ConstPtrMutComptimeConst;
-                } else {
-                    assert(!comptime_var_mem);
-                    ptr_mut = ConstPtrMutRuntimeVar;
-                }
-                return ir_get_const_ptr(ira, instruction, mem_slot, var->var_type,
-                        ptr_mut, is_const, is_volatile, var->align_bytes);
-            }
-        }
-        zig_unreachable();
+    ConstExprValue *result = create_const_vals(1);
+    result->type = return_type;
+    if (!comptime_cache_read_val(g, &r, result) || r.pos != r.len) {
+        unloaded_files.deinit();
+        return nullptr;
     }
 
-no_mem_slot:
+    // The build as a whole still depends on them, as it did when the call ran.
+    for (size_t i = 0; i < unloaded_files.length; i += 1) {
+        if (cache_add_file(&g->cache_hash, unloaded_files.at(i)) != ErrorNone) {
+            unloaded_files.deinit();
+            return nullptr;
+        }
+    }
+    unloaded_files.deinit();
 
-    IrInstruction *var_ptr_instruction = ir_build_var_ptr(&ira->new_irb,
-            instruction->scope, instruction->source_node, var);
-    var_ptr_instruction->value.type = get_pointer_to_type_extra(ira->codegen, var->var_type,
-            var->src_is_const, is_volatile, PtrLenSingle, var->align_bytes, 0, 0, false);
+    // Marks the entry as recently used for ir_comptime_cache_collect.
+    os_file_touch(entry->path);
 
-    bool in_fn_scope = (scope_fn_entry(var->parent_scope) != nullptr);
-    var_ptr_instruction->value.data.rh_ptr = in_fn_scope ? RuntimeHintPtrStack : RuntimeHintPtrNonStack;
+    *bbc += branch_count;
+    g->backward_branches += branch_count;
+    g->comptime_cache_hits += 1;
+    return result;
+}
 
-    return var_ptr_instruction;
+static void ir_comptime_cache_mark(IrAnalyze *ira, ComptimeCacheMark *mark) {
+    CodeGen *g = ira->codegen;
+    mark->backward_branch_count = *ira->new_irb.exec->backward_branch_count;
+    mark->backward_branch_quota = *ira->new_irb.exec->backward_branch_quota;
+    mark->errors_by_index_len = g->errors_by_index.length;
+    mark->fn_defs_len = g->fn_defs.length;
+    mark->global_vars_len = g->global_vars.length;
+    mark->resolve_queue_len = g->resolve_queue.length;
+    mark->exported_symbol_count = g->exported_symbol_names.size();
 }
 
-static IrInstruction *ir_analyze_store_ptr(IrAnalyze *ira, IrInstruction *source_instr,
-        IrInstruction *ptr, IrInstruction *uncasted_value)
+static void ir_comptime_cache_store(IrAnalyze *ira, ComptimeCacheEntry *entry, ConstExprValue *result,
+        const ComptimeCacheMark *mark)
 {
-    assert(ptr->value.type->id == ZigTypeIdPointer);
-
-    if (ptr->value.data.x_ptr.special == ConstPtrSpecialDiscard) {
-        if (uncasted_value->value.type->id == ZigTypeIdErrorUnion ||
-            uncasted_value->value.type->id == ZigTypeIdErrorSet)
-        {
-            ir_add_error(ira, source_instr, buf_sprintf("error is discarded"));
-            return ira->codegen->invalid_instruction;
-        }
-        return ir_const_void(ira, source_instr);
-    }
-
-    ZigType *child_type = ptr->value.type->data.pointer.child_type;
-
-    if (ptr->value.type->data.pointer.is_const && !source_instr->is_gen) {
-        ir_add_error(ira, source_instr, buf_sprintf("cannot assign to constant"));
-        return ira->codegen->invalid_instruction;
+    CodeGen *g = ira->codegen;
+    // Skipping the call on a later build must not change anything else about
+    // the compilation, so calls with other effects are not stored.
+    if (type_is_invalid(result->type) || g->errors.length != 0 ||
+        *ira->new_irb.exec->backward_branch_quota != mark->backward_branch_quota ||
+        g->errors_by_index.length != mark->errors_by_index_len ||
+        g->fn_defs.length != mark->fn_defs_len ||
+        g->global_vars.length != mark->global_vars_len ||
+        g->resolve_queue.length != mark->resolve_queue_len ||
+        g->exported_symbol_names.size() != mark->exported_symbol_count)
+    {
+        return;
     }
 
-    IrInstruction *value = ir_implicit_cast(ira, uncasted_value, child_type);
-    if (value == ira->codegen->invalid_instruction)
-        return ira->codegen->invalid_instruction;
+    Buf *result_contents = buf_alloc();
+    if (!comptime_cache_write_val(result_contents, &entry->imports, result))
+        return;
 
-    switch (type_has_one_possible_value(ira->codegen, child_type)) {
-        case OnePossibleValueInvalid:
-            return ira->codegen->invalid_instruction;
-        case OnePossibleValueYes:
-            return ir_const_void(ira, source_instr);
-        case OnePossibleValueNo:
-            break;
+    // Collected after the call, which may have added imports and embedded files.
+    ZigList<Buf *> files = {};
+    if (!comptime_cache_collect_files(&entry->imports, &files)) {
+        files.deinit();
+        return;
     }
 
-    if (instr_is_comptime(ptr) && ptr->value.data.x_ptr.special != ConstPtrSpecialHardCodedAddr) {
-        if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst) {
-            ir_add_error(ira, source_instr, buf_sprintf("cannot assign to constant"));
-            return ira->codegen->invalid_instruction;
-        }
-        if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar ||
-            ptr->value.data.x_ptr.mut == ConstPtrMutInfer)
-        {
-            if (instr_is_comptime(value)) {
-                ConstExprValue *dest_val = const_ptr_pointee(ira, ira->codegen, &ptr->value, source_instr->source_node);
-                if (dest_val == nullptr)
-                    return ira->codegen->invalid_instruction;
-                if (dest_val->special != ConstValSpecialRuntime) {
-                    // TODO this allows a value stored to have the original value modified and then
-                    // have that affect what should be a copy. We need some kind of advanced copy-on-write
-                    // system to make these two tests pass at the same time:
-                    // * "string literal used as comptime slice is memoized"
-                    // * "comptime modification of const struct field" - except modified to avoid
-                    //   ConstPtrMutComptimeVar, thus defeating the logic below.
-                    bool same_global_refs = ptr->value.data.x_ptr.mut != ConstPtrMutComptimeVar;
-                    copy_const_val(dest_val, &value->value, same_global_refs);
-                    if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar &&
-                        !ira->new_irb.current_basic_block->must_be_comptime_source_instr)
-                    {
-                        ira->new_irb.current_basic_block->must_be_comptime_source_instr = source_instr;
-                    }
-                    return ir_const_void(ira, source_instr);
-                }
-            }
-            if (ptr->value.data.x_ptr.mut == ConstPtrMutInfer) {
-                ptr->value.special = ConstValSpecialRuntime;
-            } else {
-                ir_add_error(ira, source_instr,
-                        buf_sprintf("cannot store runtime value in compile time variable"));
-                ConstExprValue *dest_val = const_ptr_pointee_unchecked(ira->codegen, &ptr->value);
-                dest_val->type = ira->codegen->builtin_types.entry_invalid;
-
-                return ira->codegen->invalid_instruction;
-            }
+    Buf *contents = buf_alloc();
+    comptime_cache_write(contents, &comptime_cache_magic, sizeof(comptime_cache_magic));
+    comptime_cache_write_u64(contents, mark->backward_branch_quota);
+    comptime_cache_write_u64(contents, *ira->new_irb.exec->backward_branch_count - mark->backward_branch_count);
+    comptime_cache_write_u64(contents, files.length);
+    for (size_t i = 0; i < files.length; i += 1) {
+        Buf *path = files.at(i);
+        uint8_t bin_digest[48];
+        bool loaded;
+        if (!comptime_cache_file_digest(g, path, bin_digest, &loaded)) {
+            files.deinit();
+            return;
         }
+        comptime_cache_write_u64(contents, buf_len(path));
+        buf_append_buf(contents, path);
+        comptime_cache_write(contents, bin_digest, 48);
     }
+    files.deinit();
+    buf_append_buf(contents, result_contents);
 
-    switch (type_requires_comptime(ira->codegen, child_type)) {
-        case ReqCompTimeInvalid:
-            return ira->codegen->invalid_instruction;
-        case ReqCompTimeYes:
-            switch (type_has_one_possible_value(ira->codegen, ptr->value.type)) {
-                case OnePossibleValueInvalid:
-                    return ira->codegen->invalid_instruction;
-                case OnePossibleValueNo:
-                    ir_add_error(ira, source_instr,
-                            buf_sprintf("cannot store runtime value in type '%s'", buf_ptr(&child_type->name)));
-                    return ira->codegen->invalid_instruction;
-                case OnePossibleValueYes:
-                    return ir_const_void(ira, source_instr);
-            }
-            zig_unreachable();
-        case ReqCompTimeNo:
-            break;
-    }
+    Buf *tmp_path = buf_alloc();
+    if (get_tmp_filename(g, tmp_path, buf_create_from_str("comptime")) != ErrorNone)
+        return;
+    if (os_write_file(tmp_path, contents) != ErrorNone)
+        return;
+    if (os_rename(tmp_path, entry->path) != ErrorNone)
+        return;
+    g->comptime_cache_stores += 1;
+}
 
-    IrInstruction *result = ir_build_store(&ira->new_irb, source_instr->scope, source_instr->source_node,
-        ptr, value);
-    result->value.type = ira->codegen->builtin_types.entry_void;
-    return result;
+void ir_comptime_cache_collect(CodeGen *g) {
+    if (g->comptime_cache_stores == 0)
+        return;
+    cache_collect_dir(g->comptime_cache_dir, comptime_cache_max_entries, comptime_cache_min_age_sec);
 }
 
 static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *call_instruction,
@@ -16160,7 +18422,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
 
     size_t call_param_count = call_instruction->arg_count + first_arg_1_or_0;
     for (size_t i = 0; i < call_instruction->arg_count; i += 1) {
-        ConstExprValue *arg_tuple_value = &call_instruction->args[i]->child->value;
+        ConstExprValue *arg_tuple_value = call_instruction->args[i]->child->value;
         if (arg_tuple_value->type->id == ZigTypeIdArgTuple) {
             call_param_count -= 1;
             call_param_count += arg_tuple_value->data.x_arg_tuple.end_index -
@@ -16229,7 +18491,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
 
         size_t next_proto_i = 0;
         if (first_arg_ptr) {
-            assert(first_arg_ptr->value.type->id == ZigTypeIdPointer);
+            assert(first_arg_ptr->value->type->id == ZigTypeIdPointer);
 
             bool first_arg_known_bare = false;
             if (fn_type_id->next_param_index >= 1) {
@@ -16240,11 +18502,11 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
             }
 
             IrInstruction *first_arg;
-            if (!first_arg_known_bare && handle_is_ptr(first_arg_ptr->value.type->data.pointer.child_type)) {
+            if (!first_arg_known_bare && handle_is_ptr(first_arg_ptr->value->type->data.pointer.child_type)) {
                 first_arg = first_arg_ptr;
             } else {
                 first_arg = ir_get_deref(ira, first_arg_ptr, first_arg_ptr, nullptr);
-                if (type_is_invalid(first_arg->value.type))
+                if (type_is_invalid(first_arg->value->type))
                     return ira->codegen->invalid_instruction;
             }
 
@@ -16261,7 +18523,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
 
         for (size_t call_i = 0; call_i < call_instruction->arg_count; call_i += 1) {
             IrInstruction *old_arg = call_instruction->args[call_i]->child;
-            if (type_is_invalid(old_arg->value.type))
+            if (type_is_invalid(old_arg->value->type))
                 return ira->codegen->invalid_instruction;
 
             if (!ir_analyze_fn_call_inline_arg(ira, fn_proto_node, old_arg, &exec_scope, &next_proto_i))
@@ -16291,12 +18553,36 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
                 result = entry->value;
         }
 
+        ComptimeCacheEntry cache_entry = {};
+        bool use_comptime_cache = false;
+        if (result == nullptr && cacheable && inferred_err_set_type == nullptr) {
+            use_comptime_cache = ir_comptime_cache_entry(ira->codegen, fn_entry, exec_scope, return_type,
+                    &cache_entry);
+            if (use_comptime_cache) {
+                result = ir_comptime_cache_load(ira, &cache_entry, return_type);
+                if (result != nullptr)
+                    ira->codegen->memoized_fn_eval_table.put(exec_scope, result);
+            }
+        }
+
         if (result == nullptr) {
+            ComptimeCacheMark cache_mark;
+            if (use_comptime_cache) {
+                ir_comptime_cache_mark(ira, &cache_mark);
+            }
+
             // Analyze the fn body block like any other constant expression.
             AstNode *body_node = fn_entry->body_node;
-            result = ir_eval_const_value(ira->codegen, exec_scope, body_node, return_type,
+            Scope *body_scope = exec_scope;
+            IrExecutable *body_exec = ir_acquire_comptime_fn_ir(ira, fn_entry, &body_scope,
+                    call_instruction->base.source_node);
+            result = ir_eval_const_value_exec(ira->codegen, body_scope, body_node, return_type,
                 ira->new_irb.exec->backward_branch_count, ira->new_irb.exec->backward_branch_quota, fn_entry,
-                nullptr, call_instruction->base.source_node, nullptr, ira->new_irb.exec, return_type_node);
+                nullptr, call_instruction->base.source_node, nullptr, ira->new_irb.exec, return_type_node,
+                body_exec);
+            if (body_exec != nullptr) {
+                fn_entry->comptime_ir_in_use = false;
+            }
 
             if (inferred_err_set_type != nullptr) {
                 inferred_err_set_type->data.error_set.infer_fn = nullptr;
@@ -16319,14 +18605,17 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
             if (cacheable) {
                 ira->codegen->memoized_fn_eval_table.put(exec_scope, result);
             }
+            if (use_comptime_cache) {
+                ir_comptime_cache_store(ira, &cache_entry, result, &cache_mark);
+            }
 
             if (type_is_invalid(result->type))
                 return ira->codegen->invalid_instruction;
         }
 
         IrInstruction *new_instruction = ir_const(ira, &call_instruction->base, result->type);
-        copy_const_val(&new_instruction->value, result, true);
-        new_instruction->value.type = return_type;
+        copy_const_val(new_instruction->value, result, true);
+        new_instruction->value->type = return_type;
         return ir_finish_anal(ira, new_instruction);
     }
 
@@ -16336,11 +18625,11 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
                 false, false, PtrLenUnknown, 0, 0, 0, false);
         ZigType *u8_slice = get_slice_type(ira->codegen, u8_ptr);
         IrInstruction *new_stack = call_instruction->new_stack->child;
-        if (type_is_invalid(new_stack->value.type))
+        if (type_is_invalid(new_stack->value->type))
             return ira->codegen->invalid_instruction;
 
         casted_new_stack = ir_implicit_cast(ira, new_stack, u8_slice);
-        if (type_is_invalid(casted_new_stack->value.type))
+        if (type_is_invalid(casted_new_stack->value->type))
             return ira->codegen->invalid_instruction;
     }
 
@@ -16355,11 +18644,11 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
         size_t new_fn_arg_count = first_arg_1_or_0;
         for (size_t call_i = 0; call_i < call_instruction->arg_count; call_i += 1) {
             IrInstruction *arg = call_instruction->args[call_i]->child;
-            if (type_is_invalid(arg->value.type))
+            if (type_is_invalid(arg->value->type))
                 return ira->codegen->invalid_instruction;
 
-            if (arg->value.type->id == ZigTypeIdArgTuple) {
-                new_fn_arg_count += arg->value.data.x_arg_tuple.end_index - arg->value.data.x_arg_tuple.start_index;
+            if (arg->value->type->id == ZigTypeIdArgTuple) {
+                new_fn_arg_count += arg->value->data.x_arg_tuple.end_index - arg->value->data.x_arg_tuple.start_index;
             } else {
                 new_fn_arg_count += 1;
             }
@@ -16388,7 +18677,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
         size_t next_proto_i = 0;
 
         if (first_arg_ptr) {
-            assert(first_arg_ptr->value.type->id == ZigTypeIdPointer);
+            assert(first_arg_ptr->value->type->id == ZigTypeIdPointer);
 
             bool first_arg_known_bare = false;
             if (fn_type_id->next_param_index >= 1) {
@@ -16399,11 +18688,11 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
             }
 
             IrInstruction *first_arg;
-            if (!first_arg_known_bare && handle_is_ptr(first_arg_ptr->value.type->data.pointer.child_type)) {
+            if (!first_arg_known_bare && handle_is_ptr(first_arg_ptr->value->type->data.pointer.child_type)) {
                 first_arg = first_arg_ptr;
             } else {
                 first_arg = ir_get_deref(ira, first_arg_ptr, first_arg_ptr, nullptr);
-                if (type_is_invalid(first_arg->value.type))
+                if (type_is_invalid(first_arg->value->type))
                     return ira->codegen->invalid_instruction;
             }
 
@@ -16421,12 +18710,12 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
         assert(parent_fn_entry);
         for (size_t call_i = 0; call_i < call_instruction->arg_count; call_i += 1) {
             IrInstruction *arg = call_instruction->args[call_i]->child;
-            if (type_is_invalid(arg->value.type))
+            if (type_is_invalid(arg->value->type))
                 return ira->codegen->invalid_instruction;
 
-            if (arg->value.type->id == ZigTypeIdArgTuple) {
-                for (size_t arg_tuple_i = arg->value.data.x_arg_tuple.start_index;
-                    arg_tuple_i < arg->value.data.x_arg_tuple.end_index; arg_tuple_i += 1)
+            if (arg->value->type->id == ZigTypeIdArgTuple) {
+                for (size_t arg_tuple_i = arg->value->data.x_arg_tuple.start_index;
+                    arg_tuple_i < arg->value->data.x_arg_tuple.end_index; arg_tuple_i += 1)
                 {
                     AstNode *param_decl_node = fn_proto_node->data.fn_proto.params.at(next_proto_i);
                     assert(param_decl_node->type == NodeTypeParamDecl);
@@ -16443,11 +18732,11 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
                         return ira->codegen->invalid_instruction;
                     }
                     IrInstruction *arg_var_ptr_inst = ir_get_var_ptr(ira, arg, arg_var);
-                    if (type_is_invalid(arg_var_ptr_inst->value.type))
+                    if (type_is_invalid(arg_var_ptr_inst->value->type))
                         return ira->codegen->invalid_instruction;
 
                     IrInstruction *arg_tuple_arg = ir_get_deref(ira, arg, arg_var_ptr_inst, nullptr);
-                    if (type_is_invalid(arg_tuple_arg->value.type))
+                    if (type_is_invalid(arg_tuple_arg->value->type))
                         return ira->codegen->invalid_instruction;
 
                     if (!ir_analyze_fn_call_generic_arg(ira, fn_proto_node, arg_tuple_arg, &impl_fn->child_scope,
@@ -16495,7 +18784,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
                     nullptr, nullptr, fn_proto_node->data.fn_proto.align_expr, nullptr, ira->new_irb.exec, nullptr);
             IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
                     impl_fn->child_scope, fn_proto_node->data.fn_proto.align_expr);
-            copy_const_val(&const_instruction->base.value, align_result, true);
+            copy_const_val(const_instruction->base.value, align_result, true);
 
             uint32_t align_bytes = 0;
             ir_resolve_align(ira, &const_instruction->base, &align_bytes);
@@ -16541,18 +18830,18 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
             if (call_instruction->async_allocator == nullptr) {
                 uncasted_async_allocator_inst = ir_get_implicit_allocator(ira, &call_instruction->base,
                         ImplicitAllocatorIdLocalVar);
-                if (type_is_invalid(uncasted_async_allocator_inst->value.type))
+                if (type_is_invalid(uncasted_async_allocator_inst->value->type))
                     return ira->codegen->invalid_instruction;
             } else {
                 uncasted_async_allocator_inst = call_instruction->async_allocator->child;
-                if (type_is_invalid(uncasted_async_allocator_inst->value.type))
+                if (type_is_invalid(uncasted_async_allocator_inst->value->type))
                     return ira->codegen->invalid_instruction;
             }
             if (inst_fn_type_id.async_allocator_type == nullptr) {
-                inst_fn_type_id.async_allocator_type = uncasted_async_allocator_inst->value.type;
+                inst_fn_type_id.async_allocator_type = uncasted_async_allocator_inst->value->type;
             }
             async_allocator_inst = ir_implicit_cast(ira, uncasted_async_allocator_inst, inst_fn_type_id.async_allocator_type);
-            if (type_is_invalid(async_allocator_inst->value.type))
+            if (type_is_invalid(async_allocator_inst->value->type))
                 return ira->codegen->invalid_instruction;
         }
 
@@ -16581,7 +18870,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
         if (handle_is_ptr(impl_fn_type_id->return_type)) {
             result_loc = ir_resolve_result(ira, &call_instruction->base, call_instruction->result_loc,
                     impl_fn_type_id->return_type, nullptr, true, true);
-            if (result_loc != nullptr && (type_is_invalid(result_loc->value.type) ||
+            if (result_loc != nullptr && (type_is_invalid(result_loc->value->type) ||
                         instr_is_unreachable(result_loc)))
             {
                 return result_loc;
@@ -16621,7 +18910,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
     IrInstruction **casted_args = allocate<IrInstruction *>(call_param_count);
     size_t next_arg_index = 0;
     if (first_arg_ptr) {
-        assert(first_arg_ptr->value.type->id == ZigTypeIdPointer);
+        assert(first_arg_ptr->value->type->id == ZigTypeIdPointer);
 
         ZigType *param_type = fn_type_id->param_info[next_arg_index].type;
         if (type_is_invalid(param_type))
@@ -16629,17 +18918,17 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
 
         IrInstruction *first_arg;
         if (param_type->id == ZigTypeIdPointer &&
-            handle_is_ptr(first_arg_ptr->value.type->data.pointer.child_type))
+            handle_is_ptr(first_arg_ptr->value->type->data.pointer.child_type))
         {
             first_arg = first_arg_ptr;
         } else {
             first_arg = ir_get_deref(ira, first_arg_ptr, first_arg_ptr, nullptr);
-            if (type_is_invalid(first_arg->value.type))
+            if (type_is_invalid(first_arg->value->type))
                 return ira->codegen->invalid_instruction;
         }
 
         IrInstruction *casted_arg = ir_implicit_cast(ira, first_arg, param_type);
-        if (type_is_invalid(casted_arg->value.type))
+        if (type_is_invalid(casted_arg->value->type))
             return ira->codegen->invalid_instruction;
 
         casted_args[next_arg_index] = casted_arg;
@@ -16647,7 +18936,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
     }
     for (size_t call_i = 0; call_i < call_instruction->arg_count; call_i += 1) {
         IrInstruction *old_arg = call_instruction->args[call_i]->child;
-        if (type_is_invalid(old_arg->value.type))
+        if (type_is_invalid(old_arg->value->type))
             return ira->codegen->invalid_instruction;
         IrInstruction *casted_arg;
         if (next_arg_index < src_param_count) {
@@ -16655,7 +18944,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
             if (type_is_invalid(param_type))
                 return ira->codegen->invalid_instruction;
             casted_arg = ir_implicit_cast(ira, old_arg, param_type);
-            if (type_is_invalid(casted_arg->value.type))
+            if (type_is_invalid(casted_arg->value->type))
                 return ira->codegen->invalid_instruction;
         } else {
             casted_arg = old_arg;
@@ -16676,16 +18965,16 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
         if (call_instruction->async_allocator == nullptr) {
             uncasted_async_allocator_inst = ir_get_implicit_allocator(ira, &call_instruction->base,
                     ImplicitAllocatorIdLocalVar);
-            if (type_is_invalid(uncasted_async_allocator_inst->value.type))
+            if (type_is_invalid(uncasted_async_allocator_inst->value->type))
                 return ira->codegen->invalid_instruction;
         } else {
             uncasted_async_allocator_inst = call_instruction->async_allocator->child;
-            if (type_is_invalid(uncasted_async_allocator_inst->value.type))
+            if (type_is_invalid(uncasted_async_allocator_inst->value->type))
                 return ira->codegen->invalid_instruction;
 
         }
         IrInstruction *async_allocator_inst = ir_implicit_cast(ira, uncasted_async_allocator_inst, fn_type_id->async_allocator_type);
-        if (type_is_invalid(async_allocator_inst->value.type))
+        if (type_is_invalid(async_allocator_inst->value->type))
             return ira->codegen->invalid_instruction;
 
         IrInstruction *result = ir_analyze_async_call(ira, call_instruction, fn_entry, fn_type, fn_ref,
@@ -16703,7 +18992,7 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
     if (handle_is_ptr(return_type)) {
         result_loc = ir_resolve_result(ira, &call_instruction->base, call_instruction->result_loc,
                 return_type, nullptr, true, true);
-        if (result_loc != nullptr && (type_is_invalid(result_loc->value.type) || instr_is_unreachable(result_loc))) {
+        if (result_loc != nullptr && (type_is_invalid(result_loc->value->type) || instr_is_unreachable(result_loc))) {
             return result_loc;
         }
     } else {
@@ -16718,14 +19007,14 @@ static IrInstruction *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCallSrc *c
 
 static IrInstruction *ir_analyze_instruction_call(IrAnalyze *ira, IrInstructionCallSrc *call_instruction) {
     IrInstruction *fn_ref = call_instruction->fn_ref->child;
-    if (type_is_invalid(fn_ref->value.type))
+    if (type_is_invalid(fn_ref->value->type))
         return ira->codegen->invalid_instruction;
 
     bool is_comptime = call_instruction->is_comptime ||
         ir_should_inline(ira->new_irb.exec, call_instruction->base.scope);
 
     if (is_comptime || instr_is_comptime(fn_ref)) {
-        if (fn_ref->value.type->id == ZigTypeIdMetaType) {
+        if (fn_ref->value->type->id == ZigTypeIdMetaType) {
             ZigType *dest_type = ir_resolve_type(ira, fn_ref);
             if (type_is_invalid(dest_type))
                 return ira->codegen->invalid_instruction;
@@ -16742,34 +19031,34 @@ static IrInstruction *ir_analyze_instruction_call(IrAnalyze *ira, IrInstructionC
 
             IrInstruction *cast_instruction = ir_analyze_cast(ira, &call_instruction->base, dest_type, arg,
                     call_instruction->result_loc);
-            if (type_is_invalid(cast_instruction->value.type))
+            if (type_is_invalid(cast_instruction->value->type))
                 return ira->codegen->invalid_instruction;
             return ir_finish_anal(ira, cast_instruction);
-        } else if (fn_ref->value.type->id == ZigTypeIdFn) {
+        } else if (fn_ref->value->type->id == ZigTypeIdFn) {
             ZigFn *fn_table_entry = ir_resolve_fn(ira, fn_ref);
             if (fn_table_entry == nullptr)
                 return ira->codegen->invalid_instruction;
             return ir_analyze_fn_call(ira, call_instruction, fn_table_entry, fn_table_entry->type_entry,
                 fn_ref, nullptr, is_comptime, call_instruction->fn_inline);
-        } else if (fn_ref->value.type->id == ZigTypeIdBoundFn) {
-            assert(fn_ref->value.special == ConstValSpecialStatic);
-            ZigFn *fn_table_entry = fn_ref->value.data.x_bound_fn.fn;
-            IrInstruction *first_arg_ptr = fn_ref->value.data.x_bound_fn.first_arg;
+        } else if (fn_ref->value->type->id == ZigTypeIdBoundFn) {
+            assert(fn_ref->value->special == ConstValSpecialStatic);
+            ZigFn *fn_table_entry = fn_ref->value->data.x_bound_fn.fn;
+            IrInstruction *first_arg_ptr = fn_ref->value->data.x_bound_fn.first_arg;
             return ir_analyze_fn_call(ira, call_instruction, fn_table_entry, fn_table_entry->type_entry,
                 fn_ref, first_arg_ptr, is_comptime, call_instruction->fn_inline);
         } else {
             ir_add_error_node(ira, fn_ref->source_node,
-                buf_sprintf("type '%s' not a function", buf_ptr(&fn_ref->value.type->name)));
+                buf_sprintf("type '%s' not a function", buf_ptr(&fn_ref->value->type->name)));
             return ira->codegen->invalid_instruction;
         }
     }
 
-    if (fn_ref->value.type->id == ZigTypeIdFn) {
-        return ir_analyze_fn_call(ira, call_instruction, nullptr, fn_ref->value.type,
+    if (fn_ref->value->type->id == ZigTypeIdFn) {
+        return ir_analyze_fn_call(ira, call_instruction, nullptr, fn_ref->value->type,
             fn_ref, nullptr, false, FnInlineAuto);
     } else {
         ir_add_error_node(ira, fn_ref->source_node,
-            buf_sprintf("type '%s' not a function", buf_ptr(&fn_ref->value.type->name)));
+            buf_sprintf("type '%s' not a function", buf_ptr(&fn_ref->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 }
@@ -16940,7 +19229,7 @@ static ErrorMsg *ir_eval_negation_scalar(IrAnalyze *ira, IrInstruction *source_i
 
 static IrInstruction *ir_analyze_negation(IrAnalyze *ira, IrInstructionUnOp *instruction) {
     IrInstruction *value = instruction->value->child;
-    ZigType *expr_type = value->value.type;
+    ZigType *expr_type = value->value->type;
     if (type_is_invalid(expr_type))
         return ira->codegen->invalid_instruction;
 
@@ -16954,7 +19243,7 @@ static IrInstruction *ir_analyze_negation(IrAnalyze *ira, IrInstructionUnOp *ins
             return ira->codegen->invalid_instruction;
 
         IrInstruction *result_instruction = ir_const(ira, &instruction->base, expr_type);
-        ConstExprValue *out_val = &result_instruction->value;
+        ConstExprValue *out_val = result_instruction->value;
         if (expr_type->id == ZigTypeIdVector) {
             expand_undef_array(ira->codegen, operand_val);
             out_val->special = ConstValSpecialUndef;
@@ -16988,13 +19277,13 @@ static IrInstruction *ir_analyze_negation(IrAnalyze *ira, IrInstructionUnOp *ins
     IrInstruction *result = ir_build_un_op(&ira->new_irb,
             instruction->base.scope, instruction->base.source_node,
             instruction->op_id, value);
-    result->value.type = expr_type;
+    result->value->type = expr_type;
     return result;
 }
 
 static IrInstruction *ir_analyze_bin_not(IrAnalyze *ira, IrInstructionUnOp *instruction) {
     IrInstruction *value = instruction->value->child;
-    ZigType *expr_type = value->value.type;
+    ZigType *expr_type = value->value->type;
     if (type_is_invalid(expr_type))
         return ira->codegen->invalid_instruction;
 
@@ -17005,14 +19294,14 @@ static IrInstruction *ir_analyze_bin_not(IrAnalyze *ira, IrInstructionUnOp *inst
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *result = ir_const(ira, &instruction->base, expr_type);
-            bigint_not(&result->value.data.x_bigint, &target_const_val->data.x_bigint,
+            bigint_not(&result->value->data.x_bigint, &target_const_val->data.x_bigint,
                     expr_type->data.integral.bit_count, expr_type->data.integral.is_signed);
             return result;
         }
 
         IrInstruction *result = ir_build_un_op(&ira->new_irb, instruction->base.scope,
                 instruction->base.source_node, IrUnOpBinNot, value);
-        result->value.type = expr_type;
+        result->value->type = expr_type;
         return result;
     }
 
@@ -17033,9 +19322,9 @@ static IrInstruction *ir_analyze_instruction_un_op(IrAnalyze *ira, IrInstruction
             return ir_analyze_negation(ira, instruction);
         case IrUnOpDereference: {
             IrInstruction *ptr = instruction->value->child;
-            if (type_is_invalid(ptr->value.type))
+            if (type_is_invalid(ptr->value->type))
                 return ira->codegen->invalid_instruction;
-            ZigType *ptr_type = ptr->value.type;
+            ZigType *ptr_type = ptr->value->type;
             if (ptr_type->id == ZigTypeIdPointer && ptr_type->data.pointer.ptr_len == PtrLenUnknown) {
                 ir_add_error_node(ira, instruction->base.source_node,
                     buf_sprintf("index syntax required for unknown-length pointer type '%s'",
@@ -17048,9 +19337,9 @@ static IrInstruction *ir_analyze_instruction_un_op(IrAnalyze *ira, IrInstruction
                 return ira->codegen->invalid_instruction;
 
             // If the result needs to be an lvalue, type check it
-            if (instruction->lval == LValPtr && result->value.type->id != ZigTypeIdPointer) {
+            if (instruction->lval == LValPtr && result->value->type->id != ZigTypeIdPointer) {
                 ir_add_error(ira, &instruction->base,
-                    buf_sprintf("attempt to dereference non-pointer type '%s'", buf_ptr(&result->value.type->name)));
+                    buf_sprintf("attempt to dereference non-pointer type '%s'", buf_ptr(&result->value->type->name)));
                 return ira->codegen->invalid_instruction;
             }
 
@@ -17093,13 +19382,13 @@ static IrInstruction *ir_analyze_instruction_br(IrAnalyze *ira, IrInstructionBr
 
     IrInstruction *result = ir_build_br(&ira->new_irb,
             br_instruction->base.scope, br_instruction->base.source_node, new_bb, nullptr);
-    result->value.type = ira->codegen->builtin_types.entry_unreachable;
+    result->value->type = ira->codegen->builtin_types.entry_unreachable;
     return ir_finish_anal(ira, result);
 }
 
 static IrInstruction *ir_analyze_instruction_cond_br(IrAnalyze *ira, IrInstructionCondBr *cond_br_instruction) {
     IrInstruction *condition = cond_br_instruction->condition->child;
-    if (type_is_invalid(condition->value.type))
+    if (type_is_invalid(condition->value->type))
         return ir_unreach_error(ira);
 
     bool is_comptime;
@@ -17108,7 +19397,7 @@ static IrInstruction *ir_analyze_instruction_cond_br(IrAnalyze *ira, IrInstructi
 
     ZigType *bool_type = ira->codegen->builtin_types.entry_bool;
     IrInstruction *casted_condition = ir_implicit_cast(ira, condition, bool_type);
-    if (type_is_invalid(casted_condition->value.type))
+    if (type_is_invalid(casted_condition->value->type))
         return ir_unreach_error(ira);
 
     if (is_comptime || instr_is_comptime(casted_condition)) {
@@ -17130,7 +19419,7 @@ static IrInstruction *ir_analyze_instruction_cond_br(IrAnalyze *ira, IrInstructi
 
         IrInstruction *result = ir_build_br(&ira->new_irb,
             cond_br_instruction->base.scope, cond_br_instruction->base.source_node, new_dest_block, nullptr);
-        result->value.type = ira->codegen->builtin_types.entry_unreachable;
+        result->value->type = ira->codegen->builtin_types.entry_unreachable;
         return ir_finish_anal(ira, result);
     }
 
@@ -17149,7 +19438,7 @@ static IrInstruction *ir_analyze_instruction_cond_br(IrAnalyze *ira, IrInstructi
     IrInstruction *result = ir_build_cond_br(&ira->new_irb,
             cond_br_instruction->base.scope, cond_br_instruction->base.source_node,
             casted_condition, new_then_block, new_else_block, nullptr);
-    result->value.type = ira->codegen->builtin_types.entry_unreachable;
+    result->value->type = ira->codegen->builtin_types.entry_unreachable;
     return ir_finish_anal(ira, result);
 }
 
@@ -17158,7 +19447,7 @@ static IrInstruction *ir_analyze_instruction_unreachable(IrAnalyze *ira,
 {
     IrInstruction *result = ir_build_unreachable(&ira->new_irb,
             unreachable_instruction->base.scope, unreachable_instruction->base.source_node);
-    result->value.type = ira->codegen->builtin_types.entry_unreachable;
+    result->value->type = ira->codegen->builtin_types.entry_unreachable;
     return ir_finish_anal(ira, result);
 }
 
@@ -17169,13 +19458,13 @@ static IrInstruction *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionPh
             if (predecessor != ira->const_predecessor_bb)
                 continue;
             IrInstruction *value = phi_instruction->incoming_values[i]->child;
-            assert(value->value.type);
-            if (type_is_invalid(value->value.type))
+            assert(value->value->type);
+            if (type_is_invalid(value->value->type))
                 return ira->codegen->invalid_instruction;
 
-            if (value->value.special != ConstValSpecialRuntime) {
+            if (value->value->special != ConstValSpecialRuntime) {
                 IrInstruction *result = ir_const(ira, &phi_instruction->base, nullptr);
-                copy_const_val(&result->value, &value->value, true);
+                copy_const_val(result->value, value->value, true);
                 return result;
             } else {
                 return value;
@@ -17201,7 +19490,7 @@ static IrInstruction *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionPh
                     } else {
                         instructions[i] = ir_const(ira, this_peer->base.source_instruction,
                                 this_peer->base.implicit_elem_type);
-                        instructions[i]->value.special = ConstValSpecialRuntime;
+                        instructions[i]->value->special = ConstValSpecialRuntime;
                     }
                 } else {
                     instructions[i] = gen_instruction;
@@ -17220,7 +19509,7 @@ static IrInstruction *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionPh
             IrInstruction *parent_result_loc = ir_resolve_result(ira, &phi_instruction->base, peer_parent->parent,
                     peer_parent->resolved_type, nullptr, false, false);
             if (parent_result_loc != nullptr &&
-                (type_is_invalid(parent_result_loc->value.type) || instr_is_unreachable(parent_result_loc)))
+                (type_is_invalid(parent_result_loc->value->type) || instr_is_unreachable(parent_result_loc)))
             {
                 return parent_result_loc;
             }
@@ -17233,7 +19522,7 @@ static IrInstruction *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionPh
             if (instrs_to_move.length != 0) {
                 IrBasicBlock *predecessor = peer_parent->base.source_instruction->child->owner_bb;
                 IrInstruction *branch_instruction = predecessor->instruction_list.pop();
-                ir_assert(branch_instruction->value.type->id == ZigTypeIdUnreachable, &phi_instruction->base);
+                ir_assert(branch_instruction->value->type->id == ZigTypeIdUnreachable, &phi_instruction->base);
                 while (instrs_to_move.length != 0) {
                     predecessor->instruction_list.append(instrs_to_move.pop());
                 }
@@ -17270,10 +19559,10 @@ static IrInstruction *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionPh
         IrInstruction *old_value = phi_instruction->incoming_values[i];
         assert(old_value);
         IrInstruction *new_value = old_value->child;
-        if (!new_value || new_value->value.type->id == ZigTypeIdUnreachable || predecessor->other == nullptr)
+        if (!new_value || new_value->value->type->id == ZigTypeIdUnreachable || predecessor->other == nullptr)
             continue;
 
-        if (type_is_invalid(new_value->value.type))
+        if (type_is_invalid(new_value->value->type))
             return ira->codegen->invalid_instruction;
 
 
@@ -17285,7 +19574,7 @@ static IrInstruction *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionPh
     if (new_incoming_blocks.length == 0) {
         IrInstruction *result = ir_build_unreachable(&ira->new_irb,
             phi_instruction->base.scope, phi_instruction->base.source_node);
-        result->value.type = ira->codegen->builtin_types.entry_unreachable;
+        result->value->type = ira->codegen->builtin_types.entry_unreachable;
         return ir_finish_anal(ira, result);
     }
 
@@ -17331,14 +19620,14 @@ static IrInstruction *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionPh
         IrInstruction *branch_instruction = predecessor->instruction_list.pop();
         ir_set_cursor_at_end(&ira->new_irb, predecessor);
         IrInstruction *casted_value = ir_implicit_cast(ira, new_value, resolved_type);
-        if (type_is_invalid(casted_value->value.type)) {
+        if (type_is_invalid(casted_value->value->type)) {
             return ira->codegen->invalid_instruction;
         }
         new_incoming_values.items[i] = casted_value;
         predecessor->instruction_list.append(branch_instruction);
 
-        if (all_stack_ptrs && (casted_value->value.special != ConstValSpecialRuntime ||
-            casted_value->value.data.rh_ptr != RuntimeHintPtrStack))
+        if (all_stack_ptrs && (casted_value->value->special != ConstValSpecialRuntime ||
+            casted_value->value->data.rh_ptr != RuntimeHintPtrStack))
         {
             all_stack_ptrs = false;
         }
@@ -17348,11 +19637,11 @@ static IrInstruction *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionPh
     IrInstruction *result = ir_build_phi(&ira->new_irb,
         phi_instruction->base.scope, phi_instruction->base.source_node,
         new_incoming_blocks.length, new_incoming_blocks.items, new_incoming_values.items, nullptr);
-    result->value.type = resolved_type;
+    result->value->type = resolved_type;
 
     if (all_stack_ptrs) {
-        assert(result->value.special == ConstValSpecialRuntime);
-        result->value.data.rh_ptr = RuntimeHintPtrStack;
+        assert(result->value->special == ConstValSpecialRuntime);
+        result->value->data.rh_ptr = RuntimeHintPtrStack;
     }
 
     return result;
@@ -17405,13 +19694,13 @@ static ZigType *adjust_ptr_len(CodeGen *g, ZigType *ptr_type, PtrLen ptr_len) {
 static IrInstruction *ir_analyze_instruction_elem(IrAnalyze *ira, IrInstructionElem *elem_ptr_instruction) {
     Error err;
     IrInstruction *array_ptr = elem_ptr_instruction->array_ptr->child;
-    if (type_is_invalid(array_ptr->value.type))
+    if (type_is_invalid(array_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
-    ConstExprValue *orig_array_ptr_val = &array_ptr->value;
+    ConstExprValue *orig_array_ptr_val = array_ptr->value;
 
     IrInstruction *elem_index = elem_ptr_instruction->elem_index->child;
-    if (type_is_invalid(elem_index->value.type))
+    if (type_is_invalid(elem_index->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *ptr_type = orig_array_ptr_val->type;
@@ -17513,7 +19802,7 @@ static IrInstruction *ir_analyze_instruction_elem(IrAnalyze *ira, IrInstructionE
         IrInstruction *result = ir_build_extractinsert(&ira->new_irb, elem_ptr_instruction->base.scope,
             elem_ptr_instruction->base.source_node,
             agg, elem_ptr_instruction->elem_index->child, nullptr, elem_ptr_instruction->array_ptr->child);
-        result->value.type = array_type;
+        result->value->type = array_type;
         return result;
     } else {
         ir_add_error_node(ira, elem_ptr_instruction->base.source_node,
@@ -17534,7 +19823,7 @@ static IrInstruction *ir_analyze_instruction_elem(IrAnalyze *ira, IrInstructionE
     uint64_t abi_align = get_abi_alignment(ira->codegen, return_type->data.pointer.child_type);
     uint64_t ptr_align = get_ptr_align(ira->codegen, return_type);
     if (instr_is_comptime(casted_elem_index)) {
-        uint64_t index = bigint_as_unsigned(&casted_elem_index->value.data.x_bigint);
+        uint64_t index = bigint_as_unsigned(&casted_elem_index->value->data.x_bigint);
         if (array_type->id == ZigTypeIdArray) {
             uint64_t array_len = array_type->data.array.len;
             if (index >= array_len) {
@@ -17627,7 +19916,7 @@ static IrInstruction *ir_analyze_instruction_elem(IrAnalyze *ira, IrInstructionE
             {
                 if (array_type->id == ZigTypeIdPointer) {
                     IrInstruction *result = ir_const(ira, &elem_ptr_instruction->base, return_type);
-                    ConstExprValue *out_val = &result->value;
+                    ConstExprValue *out_val = result->value;
                     out_val->data.x_ptr.mut = array_ptr_val->data.x_ptr.mut;
                     size_t new_index;
                     size_t mem_size;
@@ -17689,12 +19978,12 @@ static IrInstruction *ir_analyze_instruction_elem(IrAnalyze *ira, IrInstructionE
                         IrInstruction *result = ir_build_elem(&ira->new_irb, elem_ptr_instruction->base.scope,
                                 elem_ptr_instruction->base.source_node, array_ptr, casted_elem_index, false,
                                 elem_ptr_instruction->ptr_len, nullptr);
-                        result->value.type = return_type;
+                        result->value->type = return_type;
                         return result;
                     }
                     ConstExprValue *len_field = &array_ptr_val->data.x_struct.fields[slice_len_index];
                     IrInstruction *result = ir_const(ira, &elem_ptr_instruction->base, return_type);
-                    ConstExprValue *out_val = &result->value;
+                    ConstExprValue *out_val = result->value;
                     uint64_t slice_len = bigint_as_unsigned(&len_field->data.x_bigint);
                     if (index >= slice_len) {
                         ir_add_error_node(ira, elem_ptr_instruction->base.source_node,
@@ -17746,12 +20035,12 @@ static IrInstruction *ir_analyze_instruction_elem(IrAnalyze *ira, IrInstructionE
                         result = ir_build_elem(&ira->new_irb, elem_ptr_instruction->base.scope,
                                 elem_ptr_instruction->base.source_node, array_ptr, casted_elem_index,
                                 false, elem_ptr_instruction->ptr_len, elem_ptr_instruction->init_array_type);
-                        result->value.type = return_type;
-                        result->value.special = ConstValSpecialStatic;
+                        result->value->type = return_type;
+                        result->value->special = ConstValSpecialStatic;
                     } else {
                         result = ir_const(ira, &elem_ptr_instruction->base, return_type);
                     }
-                    ConstExprValue *out_val = &result->value;
+                    ConstExprValue *out_val = result->value;
                     out_val->data.x_ptr.special = ConstPtrSpecialBaseArray;
                     out_val->data.x_ptr.mut = orig_array_ptr_val->data.x_ptr.mut;
                     out_val->data.x_ptr.data.base_array.array_val = array_ptr_val;
@@ -17790,7 +20079,7 @@ static IrInstruction *ir_analyze_instruction_elem(IrAnalyze *ira, IrInstructionE
     IrInstruction *result = ir_build_elem(&ira->new_irb, elem_ptr_instruction->base.scope,
             elem_ptr_instruction->base.source_node, array_ptr, casted_elem_index, safety_check_on,
             elem_ptr_instruction->ptr_len, elem_ptr_instruction->init_array_type);
-    result->value.type = return_type;
+    result->value->type = return_type;
     return result;
 }
 
@@ -17847,15 +20136,15 @@ static IrInstruction *ir_analyze_struct_field_ptr(IrAnalyze *ira, IrInstruction
         case OnePossibleValueNo:
             break;
     }
-    assert(struct_ptr->value.type->id == ZigTypeIdPointer);
+    assert(struct_ptr->value->type->id == ZigTypeIdPointer);
     bool is_packed = (struct_type->data.structure.layout == ContainerLayoutPacked);
     uint32_t align_bytes = is_packed ? 1 : get_abi_alignment(ira->codegen, field->type_entry);
-    uint32_t ptr_bit_offset = struct_ptr->value.type->data.pointer.bit_offset_in_host;
-    uint32_t ptr_host_int_bytes = struct_ptr->value.type->data.pointer.host_int_bytes;
+    uint32_t ptr_bit_offset = struct_ptr->value->type->data.pointer.bit_offset_in_host;
+    uint32_t ptr_host_int_bytes = struct_ptr->value->type->data.pointer.host_int_bytes;
     uint32_t host_int_bytes_for_result_type = (ptr_host_int_bytes == 0) ?
         get_host_int_bytes(ira->codegen, struct_type, field) : ptr_host_int_bytes;
-    bool is_const = struct_ptr->value.type->data.pointer.is_const;
-    bool is_volatile = struct_ptr->value.type->data.pointer.is_volatile;
+    bool is_const = struct_ptr->value->type->data.pointer.is_const;
+    bool is_volatile = struct_ptr->value->type->data.pointer.is_volatile;
     ZigType *ptr_type = get_pointer_to_type_extra(ira->codegen, field->type_entry,
             is_const, is_volatile, PtrLenSingle, align_bytes,
             (uint32_t)(ptr_bit_offset + field->bit_offset_in_host),
@@ -17887,12 +20176,12 @@ static IrInstruction *ir_analyze_struct_field_ptr(IrAnalyze *ira, IrInstruction
             if (ptr_val->data.x_ptr.mut == ConstPtrMutInfer) {
                 result = ir_build_struct_field_ptr(&ira->new_irb, source_instr->scope,
                         source_instr->source_node, struct_ptr, field);
-                result->value.type = ptr_type;
-                result->value.special = ConstValSpecialStatic;
+                result->value->type = ptr_type;
+                result->value->special = ConstValSpecialStatic;
             } else {
                 result = ir_const(ira, source_instr, ptr_type);
             }
-            ConstExprValue *const_val = &result->value;
+            ConstExprValue *const_val = result->value;
             const_val->data.x_ptr.special = ConstPtrSpecialBaseStruct;
             const_val->data.x_ptr.mut = ptr_val->data.x_ptr.mut;
             const_val->data.x_ptr.data.base_struct.struct_val = struct_val;
@@ -17902,7 +20191,7 @@ static IrInstruction *ir_analyze_struct_field_ptr(IrAnalyze *ira, IrInstruction
     }
     IrInstruction *result = ir_build_struct_field_ptr(&ira->new_irb, source_instr->scope, source_instr->source_node,
             struct_ptr, field);
-    result->value.type = ptr_type;
+    result->value->type = ptr_type;
     return result;
 }
 
@@ -17915,7 +20204,7 @@ static IrInstruction *ir_analyze_container_field_ptr(IrAnalyze *ira, Buf *field_
     if ((err = ensure_complete_type(ira->codegen, bare_type)))
         return ira->codegen->invalid_instruction;
 
-    assert(container_ptr->value.type->id == ZigTypeIdPointer);
+    assert(container_ptr->value->type->id == ZigTypeIdPointer);
     if (bare_type->id == ZigTypeIdStruct) {
         TypeStructField *field = find_struct_type_field(bare_type, field_name);
         if (field != nullptr) {
@@ -17932,8 +20221,8 @@ static IrInstruction *ir_analyze_container_field_ptr(IrAnalyze *ira, Buf *field_
     }
 
     if (bare_type->id == ZigTypeIdUnion) {
-        bool is_const = container_ptr->value.type->data.pointer.is_const;
-        bool is_volatile = container_ptr->value.type->data.pointer.is_volatile;
+        bool is_const = container_ptr->value->type->data.pointer.is_const;
+        bool is_volatile = container_ptr->value->type->data.pointer.is_volatile;
 
         TypeUnionField *field = find_union_type_field(bare_type, field_name);
         if (field == nullptr) {
@@ -17984,14 +20273,14 @@ static IrInstruction *ir_analyze_container_field_ptr(IrAnalyze *ira, Buf *field_
                 if (ptr_val->data.x_ptr.mut == ConstPtrMutInfer) {
                     result = ir_build_union_field_ptr(&ira->new_irb, source_instr->scope,
                             source_instr->source_node, container_ptr, field, true, initializing);
-                    result->value.type = ptr_type;
-                    result->value.special = ConstValSpecialStatic;
+                    result->value->type = ptr_type;
+                    result->value->special = ConstValSpecialStatic;
                 } else {
                     result = ir_const(ira, source_instr, ptr_type);
                 }
-                ConstExprValue *const_val = &result->value;
+                ConstExprValue *const_val = result->value;
                 const_val->data.x_ptr.special = ConstPtrSpecialRef;
-                const_val->data.x_ptr.mut = container_ptr->value.data.x_ptr.mut;
+                const_val->data.x_ptr.mut = container_ptr->value->data.x_ptr.mut;
                 const_val->data.x_ptr.data.ref.pointee = payload_val;
                 return result;
             }
@@ -17999,7 +20288,7 @@ static IrInstruction *ir_analyze_container_field_ptr(IrAnalyze *ira, Buf *field_
 
         IrInstruction *result = ir_build_union_field_ptr(&ira->new_irb, source_instr->scope,
                 source_instr->source_node, container_ptr, field, true, initializing);
-        result->value.type = ptr_type;
+        result->value->type = ptr_type;
         return result;
     }
 
@@ -18105,10 +20394,10 @@ static ErrorTableEntry *find_err_table_entry(ZigType *err_set_type, Buf *field_n
 static IrInstruction *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstructionFieldPtr *field_ptr_instruction) {
     Error err;
     IrInstruction *container_ptr = field_ptr_instruction->container_ptr->child;
-    if (type_is_invalid(container_ptr->value.type))
+    if (type_is_invalid(container_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
-    ZigType *container_type = container_ptr->value.type->data.pointer.child_type;
+    ZigType *container_type = container_ptr->value->type->data.pointer.child_type;
 
     Buf *field_name = field_ptr_instruction->field_name_buffer;
     if (!field_name) {
@@ -18124,7 +20413,7 @@ static IrInstruction *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstruc
     if (type_is_invalid(container_type)) {
         return ira->codegen->invalid_instruction;
     } else if (is_slice(container_type) || is_container_ref(container_type)) {
-        assert(container_ptr->value.type->id == ZigTypeIdPointer);
+        assert(container_ptr->value->type->id == ZigTypeIdPointer);
         if (container_type->id == ZigTypeIdPointer) {
             ZigType *bare_type = container_ref_type(container_type);
             IrInstruction *container_child = ir_get_deref(ira, &field_ptr_instruction->base, container_ptr, nullptr);
@@ -18159,7 +20448,7 @@ static IrInstruction *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstruc
         if (!container_ptr_val)
             return ira->codegen->invalid_instruction;
 
-        assert(container_ptr->value.type->id == ZigTypeIdPointer);
+        assert(container_ptr->value->type->id == ZigTypeIdPointer);
         ConstExprValue *child_val = const_ptr_pointee(ira, ira->codegen, container_ptr_val, source_node);
         if (child_val == nullptr)
             return ira->codegen->invalid_instruction;
@@ -18200,7 +20489,7 @@ static IrInstruction *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstruc
         if (!container_ptr_val)
             return ira->codegen->invalid_instruction;
 
-        assert(container_ptr->value.type->id == ZigTypeIdPointer);
+        assert(container_ptr->value->type->id == ZigTypeIdPointer);
         ConstExprValue *child_val = const_ptr_pointee(ira, ira->codegen, container_ptr_val, source_node);
         if (child_val == nullptr)
             return ira->codegen->invalid_instruction;
@@ -18492,20 +20781,20 @@ static IrInstruction *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstruc
 
 static IrInstruction *ir_analyze_instruction_store(IrAnalyze *ira, IrInstructionStore *instruction) {
     IrInstruction *ptr = instruction->ptr->child;
-    if (type_is_invalid(ptr->value.type))
+    if (type_is_invalid(ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
     if (ptr->id == IrInstructionIdExtractInsert) {
         IrInstructionExtractInsert *result = (IrInstructionExtractInsert *)ptr;
-        ZigType *vector_type = result->agg->value.type;
-        assert(result->base.value.type == vector_type);
+        ZigType *vector_type = result->agg->value->type;
+        assert(result->base.value->type == vector_type);
 
         if (!instr_is_comptime(result->index)) {
-            assert(ptr->value.type->id == ZigTypeIdVector);
+            assert(ptr->value->type->id == ZigTypeIdVector);
             ir_add_error_node(ira, result->index->source_node,
                 buf_sprintf("Vector indices must be comptime."));
             return ira->codegen->invalid_instruction;
@@ -18526,15 +20815,15 @@ static IrInstruction *ir_analyze_instruction_store(IrAnalyze *ira, IrInstruction
             return ira->codegen->invalid_instruction;
         }
 
-        result->value = ir_implicit_cast(ira, value, result->agg->value.type->data.vector.elem_type);
+        result->value = ir_implicit_cast(ira, value, result->agg->value->type->data.vector.elem_type);
         if (!result->value)
             return ira->codegen->invalid_instruction;
 
         if (instr_is_comptime(result->agg) && instr_is_comptime(result->index) &&
             instr_is_comptime(result->result_loc)) {
-            result->agg->value.data.x_array.data.s_none.elements[index_int] = result->value->value;
-            result->base.value.type = ira->codegen->builtin_types.entry_void;
-            result->base.value.special = ConstValSpecialStatic;
+            result->agg->value->data.x_array.data.s_none.elements[index_int] = *result->value->value;
+            result->base.value->type = ira->codegen->builtin_types.entry_void;
+            result->base.value->special = ConstValSpecialStatic;
             return &result->base;
         }
 
@@ -18548,18 +20837,18 @@ static IrInstruction *ir_analyze_instruction_store(IrAnalyze *ira, IrInstruction
 
 static IrInstruction *ir_analyze_instruction_load(IrAnalyze *ira, IrInstructionLoad *instruction) {
     IrInstruction *ptr = instruction->ptr->child;
-    if (type_is_invalid(ptr->value.type))
+    if (type_is_invalid(ptr->value->type))
         return ira->codegen->invalid_instruction;
     if (ptr->id == IrInstructionIdExtractInsert) {
         // We just subsume the other instruction
         IrInstructionExtractInsert *result = (IrInstructionExtractInsert *)ptr;
         assert(result->value == nullptr && "Is this suppose to be a store?");
-        ZigType *vector_type = result->agg->value.type;
-        assert(result->base.value.type == vector_type);
-        result->base.value.type = vector_type->data.vector.elem_type;
+        ZigType *vector_type = result->agg->value->type;
+        assert(result->base.value->type == vector_type);
+        result->base.value->type = vector_type->data.vector.elem_type;
 
         if (!instr_is_comptime(result->index)) {
-            assert(ptr->value.type->id == ZigTypeIdVector);
+            assert(ptr->value->type->id == ZigTypeIdVector);
             ir_add_error_node(ira, result->index->source_node,
                 buf_sprintf("Vector indices must be comptime."));
             return ira->codegen->invalid_instruction;
@@ -18581,9 +20870,9 @@ static IrInstruction *ir_analyze_instruction_load(IrAnalyze *ira, IrInstructionL
         }
 
         if (instr_is_comptime(result->agg) && instr_is_comptime(result->index)) {
-            IrInstruction *comptime_result = ir_const_type(ira, &instruction->base, result->base.value.type);
+            IrInstruction *comptime_result = ir_const_type(ira, &instruction->base, result->base.value->type);
             ConstExprValue *vector_val = ir_resolve_const(ira, result->agg, UndefOk);
-            comptime_result->value = vector_val->data.x_array.data.s_none.elements[index_int];
+            *comptime_result->value = vector_val->data.x_array.data.s_none.elements[index_int];
             return comptime_result;
         }
 
@@ -18594,7 +20883,7 @@ static IrInstruction *ir_analyze_instruction_load(IrAnalyze *ira, IrInstructionL
 
 static IrInstruction *ir_analyze_instruction_typeof(IrAnalyze *ira, IrInstructionTypeOf *typeof_instruction) {
     IrInstruction *expr_value = typeof_instruction->value->child;
-    ZigType *type_entry = expr_value->value.type;
+    ZigType *type_entry = expr_value->value->type;
     if (type_is_invalid(type_entry))
         return ira->codegen->invalid_instruction;
     return ir_const_type(ira, &typeof_instruction->base, type_entry);
@@ -18835,14 +21124,14 @@ static IrInstruction *ir_analyze_instruction_asm(IrAnalyze *ira, IrInstructionAs
 
     for (size_t i = 0; i < asm_expr->input_list.length; i += 1) {
         IrInstruction *const input_value = asm_instruction->input_list[i]->child;
-        if (type_is_invalid(input_value->value.type))
+        if (type_is_invalid(input_value->value->type))
             return ira->codegen->invalid_instruction;
 
         if (instr_is_comptime(input_value) &&
-            (input_value->value.type->id == ZigTypeIdComptimeInt ||
-            input_value->value.type->id == ZigTypeIdComptimeFloat)) {
+            (input_value->value->type->id == ZigTypeIdComptimeInt ||
+            input_value->value->type->id == ZigTypeIdComptimeFloat)) {
             ir_add_error_node(ira, input_value->source_node,
-                buf_sprintf("expected sized integer or sized float, found %s", buf_ptr(&input_value->value.type->name)));
+                buf_sprintf("expected sized integer or sized float, found %s", buf_ptr(&input_value->value->type->name)));
             return ira->codegen->invalid_instruction;
         }
 
@@ -18854,7 +21143,7 @@ static IrInstruction *ir_analyze_instruction_asm(IrAnalyze *ira, IrInstructionAs
         asm_instruction->asm_template, asm_instruction->token_list, asm_instruction->token_list_len,
         input_list, output_types, asm_instruction->output_vars, asm_instruction->return_count,
         asm_instruction->has_side_effects);
-    result->value.type = return_type;
+    result->value->type = return_type;
     return result;
 }
 
@@ -18979,7 +21268,7 @@ static IrInstruction *ir_analyze_instruction_size_of(IrAnalyze *ira,
 }
 
 static IrInstruction *ir_analyze_test_non_null(IrAnalyze *ira, IrInstruction *source_inst, IrInstruction *value) {
-    ZigType *type_entry = value->value.type;
+    ZigType *type_entry = value->value->type;
 
     if (type_entry->id == ZigTypeIdPointer && type_entry->data.pointer.allow_zero) {
         if (instr_is_comptime(value)) {
@@ -18996,7 +21285,7 @@ static IrInstruction *ir_analyze_test_non_null(IrAnalyze *ira, IrInstruction *so
 
         IrInstruction *result = ir_build_test_nonnull(&ira->new_irb,
             source_inst->scope, source_inst->source_node, value);
-        result->value.type = ira->codegen->builtin_types.entry_bool;
+        result->value->type = ira->codegen->builtin_types.entry_bool;
         return result;
     } else if (type_entry->id == ZigTypeIdOptional) {
         if (instr_is_comptime(value)) {
@@ -19011,7 +21300,7 @@ static IrInstruction *ir_analyze_test_non_null(IrAnalyze *ira, IrInstruction *so
 
         IrInstruction *result = ir_build_test_nonnull(&ira->new_irb,
             source_inst->scope, source_inst->source_node, value);
-        result->value.type = ira->codegen->builtin_types.entry_bool;
+        result->value->type = ira->codegen->builtin_types.entry_bool;
         return result;
     } else if (type_entry->id == ZigTypeIdNull) {
         return ir_const_bool(ira, source_inst, false);
@@ -19022,7 +21311,7 @@ static IrInstruction *ir_analyze_test_non_null(IrAnalyze *ira, IrInstruction *so
 
 static IrInstruction *ir_analyze_instruction_test_non_null(IrAnalyze *ira, IrInstructionTestNonNull *instruction) {
     IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_analyze_test_non_null(ira, &instruction->base, value);
@@ -19031,7 +21320,7 @@ static IrInstruction *ir_analyze_instruction_test_non_null(IrAnalyze *ira, IrIns
 static IrInstruction *ir_analyze_unwrap_optional_payload(IrAnalyze *ira, IrInstruction *source_instr,
         IrInstruction *base_ptr, bool safety_check_on, bool initializing)
 {
-    ZigType *ptr_type = base_ptr->value.type;
+    ZigType *ptr_type = base_ptr->value->type;
     assert(ptr_type->id == ZigTypeIdPointer);
 
     ZigType *type_entry = ptr_type->data.pointer.child_type;
@@ -19122,12 +21411,12 @@ static IrInstruction *ir_analyze_unwrap_optional_payload(IrAnalyze *ira, IrInstr
             if (ptr_val->data.x_ptr.mut == ConstPtrMutInfer) {
                 result = ir_build_optional_unwrap_ptr(&ira->new_irb, source_instr->scope,
                         source_instr->source_node, base_ptr, false, initializing);
-                result->value.type = result_type;
-                result->value.special = ConstValSpecialStatic;
+                result->value->type = result_type;
+                result->value->special = ConstValSpecialStatic;
             } else {
                 result = ir_const(ira, source_instr, result_type);
             }
-            ConstExprValue *result_val = &result->value;
+            ConstExprValue *result_val = result->value;
             result_val->data.x_ptr.special = ConstPtrSpecialRef;
             result_val->data.x_ptr.mut = ptr_val->data.x_ptr.mut;
             switch (type_has_one_possible_value(ira->codegen, child_type)) {
@@ -19152,7 +21441,7 @@ static IrInstruction *ir_analyze_unwrap_optional_payload(IrAnalyze *ira, IrInstr
 
     IrInstruction *result = ir_build_optional_unwrap_ptr(&ira->new_irb, source_instr->scope,
             source_instr->source_node, base_ptr, safety_check_on, initializing);
-    result->value.type = result_type;
+    result->value->type = result_type;
     return result;
 }
 
@@ -19160,7 +21449,7 @@ static IrInstruction *ir_analyze_instruction_optional_unwrap_ptr(IrAnalyze *ira,
         IrInstructionOptionalUnwrapPtr *instruction)
 {
     IrInstruction *base_ptr = instruction->base_ptr->child;
-    if (type_is_invalid(base_ptr->value.type))
+    if (type_is_invalid(base_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_analyze_unwrap_optional_payload(ira, &instruction->base, base_ptr,
@@ -19173,7 +21462,7 @@ static IrInstruction *ir_analyze_instruction_ctz(IrAnalyze *ira, IrInstructionCt
         return ira->codegen->invalid_instruction;
 
     IrInstruction *op = ir_implicit_cast(ira, instruction->op->child, int_type);
-    if (type_is_invalid(op->value.type))
+    if (type_is_invalid(op->value->type))
         return ira->codegen->invalid_instruction;
 
     if (int_type->data.integral.bit_count == 0)
@@ -19185,14 +21474,14 @@ static IrInstruction *ir_analyze_instruction_ctz(IrAnalyze *ira, IrInstructionCt
             return ira->codegen->invalid_instruction;
         if (val->special == ConstValSpecialUndef)
             return ir_const_undef(ira, &instruction->base, ira->codegen->builtin_types.entry_num_lit_int);
-        size_t result_usize = bigint_ctz(&op->value.data.x_bigint, int_type->data.integral.bit_count);
+        size_t result_usize = bigint_ctz(&op->value->data.x_bigint, int_type->data.integral.bit_count);
         return ir_const_unsigned(ira, &instruction->base, result_usize);
     }
 
     ZigType *return_type = get_smallest_unsigned_int_type(ira->codegen, int_type->data.integral.bit_count);
     IrInstruction *result = ir_build_ctz(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, op);
-    result->value.type = return_type;
+    result->value->type = return_type;
     return result;
 }
 
@@ -19202,7 +21491,7 @@ static IrInstruction *ir_analyze_instruction_clz(IrAnalyze *ira, IrInstructionCl
         return ira->codegen->invalid_instruction;
 
     IrInstruction *op = ir_implicit_cast(ira, instruction->op->child, int_type);
-    if (type_is_invalid(op->value.type))
+    if (type_is_invalid(op->value->type))
         return ira->codegen->invalid_instruction;
 
     if (int_type->data.integral.bit_count == 0)
@@ -19214,14 +21503,14 @@ static IrInstruction *ir_analyze_instruction_clz(IrAnalyze *ira, IrInstructionCl
             return ira->codegen->invalid_instruction;
         if (val->special == ConstValSpecialUndef)
             return ir_const_undef(ira, &instruction->base, ira->codegen->builtin_types.entry_num_lit_int);
-        size_t result_usize = bigint_clz(&op->value.data.x_bigint, int_type->data.integral.bit_count);
+        size_t result_usize = bigint_clz(&op->value->data.x_bigint, int_type->data.integral.bit_count);
         return ir_const_unsigned(ira, &instruction->base, result_usize);
     }
 
     ZigType *return_type = get_smallest_unsigned_int_type(ira->codegen, int_type->data.integral.bit_count);
     IrInstruction *result = ir_build_clz(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, op);
-    result->value.type = return_type;
+    result->value->type = return_type;
     return result;
 }
 
@@ -19231,7 +21520,7 @@ static IrInstruction *ir_analyze_instruction_pop_count(IrAnalyze *ira, IrInstruc
         return ira->codegen->invalid_instruction;
 
     IrInstruction *op = ir_implicit_cast(ira, instruction->op->child, int_type);
-    if (type_is_invalid(op->value.type))
+    if (type_is_invalid(op->value->type))
         return ira->codegen->invalid_instruction;
 
     if (int_type->data.integral.bit_count == 0)
@@ -19255,33 +21544,33 @@ static IrInstruction *ir_analyze_instruction_pop_count(IrAnalyze *ira, IrInstruc
     ZigType *return_type = get_smallest_unsigned_int_type(ira->codegen, int_type->data.integral.bit_count);
     IrInstruction *result = ir_build_pop_count(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, op);
-    result->value.type = return_type;
+    result->value->type = return_type;
     return result;
 }
 
 static IrInstruction *ir_analyze_union_tag(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value) {
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (value->value.type->id == ZigTypeIdEnum) {
+    if (value->value->type->id == ZigTypeIdEnum) {
         return value;
     }
 
-    if (value->value.type->id != ZigTypeIdUnion) {
+    if (value->value->type->id != ZigTypeIdUnion) {
         ir_add_error(ira, value,
-            buf_sprintf("expected enum or union type, found '%s'", buf_ptr(&value->value.type->name)));
+            buf_sprintf("expected enum or union type, found '%s'", buf_ptr(&value->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
-    if (!value->value.type->data.unionation.have_explicit_tag_type && !source_instr->is_gen) {
+    if (!value->value->type->data.unionation.have_explicit_tag_type && !source_instr->is_gen) {
         ErrorMsg *msg = ir_add_error(ira, source_instr, buf_sprintf("union has no associated enum"));
-        if (value->value.type->data.unionation.decl_node != nullptr) {
-            add_error_note(ira->codegen, msg, value->value.type->data.unionation.decl_node,
+        if (value->value->type->data.unionation.decl_node != nullptr) {
+            add_error_note(ira->codegen, msg, value->value->type->data.unionation.decl_node,
                     buf_sprintf("declared here"));
         }
         return ira->codegen->invalid_instruction;
     }
 
-    ZigType *tag_type = value->value.type->data.unionation.tag_type;
+    ZigType *tag_type = value->value->type->data.unionation.tag_type;
     assert(tag_type->id == ZigTypeIdEnum);
 
     if (instr_is_comptime(value)) {
@@ -19291,14 +21580,14 @@ static IrInstruction *ir_analyze_union_tag(IrAnalyze *ira, IrInstruction *source
 
         IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
                 source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.type = tag_type;
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        bigint_init_bigint(&const_instruction->base.value.data.x_enum_tag, &val->data.x_union.tag);
+        const_instruction->base.value->type = tag_type;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        bigint_init_bigint(&const_instruction->base.value->data.x_enum_tag, &val->data.x_union.tag);
         return &const_instruction->base;
     }
 
     IrInstruction *result = ir_build_union_tag(&ira->new_irb, source_instr->scope, source_instr->source_node, value);
-    result->value.type = tag_type;
+    result->value->type = tag_type;
     return result;
 }
 
@@ -19306,11 +21595,11 @@ static IrInstruction *ir_analyze_instruction_switch_br(IrAnalyze *ira,
         IrInstructionSwitchBr *switch_br_instruction)
 {
     IrInstruction *target_value = switch_br_instruction->target_value->child;
-    if (type_is_invalid(target_value->value.type))
+    if (type_is_invalid(target_value->value->type))
         return ir_unreach_error(ira);
 
     if (switch_br_instruction->switch_prongs_void != nullptr) {
-        if (type_is_invalid(switch_br_instruction->switch_prongs_void->child->value.type)) {
+        if (type_is_invalid(switch_br_instruction->switch_prongs_void->child->value->type)) {
             return ir_unreach_error(ira);
         }
     }
@@ -19331,17 +21620,17 @@ static IrInstruction *ir_analyze_instruction_switch_br(IrAnalyze *ira,
         for (size_t i = 0; i < case_count; i += 1) {
             IrInstructionSwitchBrCase *old_case = &switch_br_instruction->cases[i];
             IrInstruction *case_value = old_case->value->child;
-            if (type_is_invalid(case_value->value.type))
+            if (type_is_invalid(case_value->value->type))
                 return ir_unreach_error(ira);
 
-            if (case_value->value.type->id == ZigTypeIdEnum) {
+            if (case_value->value->type->id == ZigTypeIdEnum) {
                 case_value = ir_analyze_union_tag(ira, &switch_br_instruction->base, case_value);
-                if (type_is_invalid(case_value->value.type))
+                if (type_is_invalid(case_value->value->type))
                     return ir_unreach_error(ira);
             }
 
-            IrInstruction *casted_case_value = ir_implicit_cast(ira, case_value, target_value->value.type);
-            if (type_is_invalid(casted_case_value->value.type))
+            IrInstruction *casted_case_value = ir_implicit_cast(ira, case_value, target_value->value->type);
+            if (type_is_invalid(casted_case_value->value->type))
                 return ir_unreach_error(ira);
 
             ConstExprValue *case_val = ir_resolve_const(ira, casted_case_value, UndefBad);
@@ -19361,7 +21650,7 @@ static IrInstruction *ir_analyze_instruction_switch_br(IrAnalyze *ira,
             IrInstruction *result = ir_build_br(&ira->new_irb,
                 switch_br_instruction->base.scope, switch_br_instruction->base.source_node,
                 new_dest_block, nullptr);
-            result->value.type = ira->codegen->builtin_types.entry_unreachable;
+            result->value->type = ira->codegen->builtin_types.entry_unreachable;
             return ir_finish_anal(ira, result);
         }
     }
@@ -19381,17 +21670,17 @@ static IrInstruction *ir_analyze_instruction_switch_br(IrAnalyze *ira,
 
         IrInstruction *old_value = old_case->value;
         IrInstruction *new_value = old_value->child;
-        if (type_is_invalid(new_value->value.type))
+        if (type_is_invalid(new_value->value->type))
             continue;
 
-        if (new_value->value.type->id == ZigTypeIdEnum) {
+        if (new_value->value->type->id == ZigTypeIdEnum) {
             new_value = ir_analyze_union_tag(ira, &switch_br_instruction->base, new_value);
-            if (type_is_invalid(new_value->value.type))
+            if (type_is_invalid(new_value->value->type))
                 continue;
         }
 
-        IrInstruction *casted_new_value = ir_implicit_cast(ira, new_value, target_value->value.type);
-        if (type_is_invalid(casted_new_value->value.type))
+        IrInstruction *casted_new_value = ir_implicit_cast(ira, new_value, target_value->value->type);
+        if (type_is_invalid(casted_new_value->value->type))
             continue;
 
         if (!ir_resolve_const(ira, casted_new_value, UndefBad))
@@ -19411,7 +21700,7 @@ static IrInstruction *ir_analyze_instruction_switch_br(IrAnalyze *ira,
     IrInstructionSwitchBr *switch_br = ir_build_switch_br(&ira->new_irb,
         switch_br_instruction->base.scope, switch_br_instruction->base.source_node,
         target_value, new_else_block, case_count, cases, nullptr, nullptr);
-    switch_br->base.value.type = ira->codegen->builtin_types.entry_unreachable;
+    switch_br->base.value->type = ira->codegen->builtin_types.entry_unreachable;
     return ir_finish_anal(ira, &switch_br->base);
 }
 
@@ -19420,20 +21709,20 @@ static IrInstruction *ir_analyze_instruction_switch_target(IrAnalyze *ira,
 {
     Error err;
     IrInstruction *target_value_ptr = switch_target_instruction->target_value_ptr->child;
-    if (type_is_invalid(target_value_ptr->value.type))
+    if (type_is_invalid(target_value_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (target_value_ptr->value.type->id == ZigTypeIdMetaType) {
+    if (target_value_ptr->value->type->id == ZigTypeIdMetaType) {
         assert(instr_is_comptime(target_value_ptr));
-        ZigType *ptr_type = target_value_ptr->value.data.x_type;
+        ZigType *ptr_type = target_value_ptr->value->data.x_type;
         assert(ptr_type->id == ZigTypeIdPointer);
         return ir_const_type(ira, &switch_target_instruction->base, ptr_type->data.pointer.child_type);
     }
 
-    ZigType *target_type = target_value_ptr->value.type->data.pointer.child_type;
+    ZigType *target_type = target_value_ptr->value->type->data.pointer.child_type;
     ConstExprValue *pointee_val = nullptr;
     if (instr_is_comptime(target_value_ptr)) {
-        pointee_val = const_ptr_pointee(ira, ira->codegen, &target_value_ptr->value, target_value_ptr->source_node);
+        pointee_val = const_ptr_pointee(ira, ira->codegen, target_value_ptr->value, target_value_ptr->source_node);
         if (pointee_val == nullptr)
             return ira->codegen->invalid_instruction;
 
@@ -19460,13 +21749,13 @@ static IrInstruction *ir_analyze_instruction_switch_target(IrAnalyze *ira,
         case ZigTypeIdErrorSet: {
             if (pointee_val) {
                 IrInstruction *result = ir_const(ira, &switch_target_instruction->base, nullptr);
-                copy_const_val(&result->value, pointee_val, true);
-                result->value.type = target_type;
+                copy_const_val(result->value, pointee_val, true);
+                result->value->type = target_type;
                 return result;
             }
 
             IrInstruction *result = ir_get_deref(ira, &switch_target_instruction->base, target_value_ptr, nullptr);
-            result->value.type = target_type;
+            result->value->type = target_type;
             return result;
         }
         case ZigTypeIdUnion: {
@@ -19485,22 +21774,22 @@ static IrInstruction *ir_analyze_instruction_switch_target(IrAnalyze *ira,
             assert(tag_type->id == ZigTypeIdEnum);
             if (pointee_val) {
                 IrInstruction *result = ir_const(ira, &switch_target_instruction->base, tag_type);
-                bigint_init_bigint(&result->value.data.x_enum_tag, &pointee_val->data.x_union.tag);
+                bigint_init_bigint(&result->value->data.x_enum_tag, &pointee_val->data.x_union.tag);
                 return result;
             }
             if (tag_type->data.enumeration.src_field_count == 1) {
                 IrInstruction *result = ir_const(ira, &switch_target_instruction->base, tag_type);
                 TypeEnumField *only_field = &tag_type->data.enumeration.fields[0];
-                bigint_init_bigint(&result->value.data.x_enum_tag, &only_field->value);
+                bigint_init_bigint(&result->value->data.x_enum_tag, &only_field->value);
                 return result;
             }
 
             IrInstruction *union_value = ir_get_deref(ira, &switch_target_instruction->base, target_value_ptr, nullptr);
-            union_value->value.type = target_type;
+            union_value->value->type = target_type;
 
             IrInstruction *union_tag_inst = ir_build_union_tag(&ira->new_irb, switch_target_instruction->base.scope,
                     switch_target_instruction->base.source_node, union_value);
-            union_tag_inst->value.type = tag_type;
+            union_tag_inst->value->type = tag_type;
             return union_tag_inst;
         }
         case ZigTypeIdEnum: {
@@ -19509,18 +21798,18 @@ static IrInstruction *ir_analyze_instruction_switch_target(IrAnalyze *ira,
             if (target_type->data.enumeration.src_field_count < 2) {
                 TypeEnumField *only_field = &target_type->data.enumeration.fields[0];
                 IrInstruction *result = ir_const(ira, &switch_target_instruction->base, target_type);
-                bigint_init_bigint(&result->value.data.x_enum_tag, &only_field->value);
+                bigint_init_bigint(&result->value->data.x_enum_tag, &only_field->value);
                 return result;
             }
 
             if (pointee_val) {
                 IrInstruction *result = ir_const(ira, &switch_target_instruction->base, target_type);
-                bigint_init_bigint(&result->value.data.x_enum_tag, &pointee_val->data.x_enum_tag);
+                bigint_init_bigint(&result->value->data.x_enum_tag, &pointee_val->data.x_enum_tag);
                 return result;
             }
 
             IrInstruction *enum_value = ir_get_deref(ira, &switch_target_instruction->base, target_value_ptr, nullptr);
-            enum_value->value.type = target_type;
+            enum_value->value->type = target_type;
             return enum_value;
         }
         case ZigTypeIdErrorUnion:
@@ -19543,12 +21832,12 @@ static IrInstruction *ir_analyze_instruction_switch_target(IrAnalyze *ira,
 
 static IrInstruction *ir_analyze_instruction_switch_var(IrAnalyze *ira, IrInstructionSwitchVar *instruction) {
     IrInstruction *target_value_ptr = instruction->target_value_ptr->child;
-    if (type_is_invalid(target_value_ptr->value.type))
+    if (type_is_invalid(target_value_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
-    ZigType *ref_type = target_value_ptr->value.type;
+    ZigType *ref_type = target_value_ptr->value->type;
     assert(ref_type->id == ZigTypeIdPointer);
-    ZigType *target_type = target_value_ptr->value.type->data.pointer.child_type;
+    ZigType *target_type = target_value_ptr->value->type->data.pointer.child_type;
     if (target_type->id == ZigTypeIdUnion) {
         ZigType *enum_type = target_type->data.unionation.tag_type;
         assert(enum_type != nullptr);
@@ -19556,11 +21845,11 @@ static IrInstruction *ir_analyze_instruction_switch_var(IrAnalyze *ira, IrInstru
         assert(instruction->prongs_len > 0);
 
         IrInstruction *first_prong_value = instruction->prongs_ptr[0]->child;
-        if (type_is_invalid(first_prong_value->value.type))
+        if (type_is_invalid(first_prong_value->value->type))
             return ira->codegen->invalid_instruction;
 
         IrInstruction *first_casted_prong_value = ir_implicit_cast(ira, first_prong_value, enum_type);
-        if (type_is_invalid(first_casted_prong_value->value.type))
+        if (type_is_invalid(first_casted_prong_value->value->type))
             return ira->codegen->invalid_instruction;
 
         ConstExprValue *first_prong_val = ir_resolve_const(ira, first_casted_prong_value, UndefBad);
@@ -19572,11 +21861,11 @@ static IrInstruction *ir_analyze_instruction_switch_var(IrAnalyze *ira, IrInstru
         ErrorMsg *invalid_payload_msg = nullptr;
         for (size_t prong_i = 1; prong_i < instruction->prongs_len; prong_i += 1) {
             IrInstruction *this_prong_inst = instruction->prongs_ptr[prong_i]->child;
-            if (type_is_invalid(this_prong_inst->value.type))
+            if (type_is_invalid(this_prong_inst->value->type))
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *this_casted_prong_value = ir_implicit_cast(ira, this_prong_inst, enum_type);
-            if (type_is_invalid(this_casted_prong_value->value.type))
+            if (type_is_invalid(this_casted_prong_value->value->type))
                 return ira->codegen->invalid_instruction;
 
             ConstExprValue *this_prong = ir_resolve_const(ira, this_casted_prong_value, UndefBad);
@@ -19613,7 +21902,7 @@ static IrInstruction *ir_analyze_instruction_switch_var(IrAnalyze *ira, IrInstru
             IrInstruction *result = ir_const(ira, &instruction->base,
                     get_pointer_to_type(ira->codegen, first_field->type_entry,
                     target_val_ptr->type->data.pointer.is_const));
-            ConstExprValue *out_val = &result->value;
+            ConstExprValue *out_val = result->value;
             out_val->data.x_ptr.special = ConstPtrSpecialRef;
             out_val->data.x_ptr.mut = target_val_ptr->data.x_ptr.mut;
             out_val->data.x_ptr.data.ref.pointee = pointee_val->data.x_union.payload;
@@ -19622,8 +21911,8 @@ static IrInstruction *ir_analyze_instruction_switch_var(IrAnalyze *ira, IrInstru
 
         IrInstruction *result = ir_build_union_field_ptr(&ira->new_irb,
             instruction->base.scope, instruction->base.source_node, target_value_ptr, first_field, false, false);
-        result->value.type = get_pointer_to_type(ira->codegen, first_field->type_entry,
-                target_value_ptr->value.type->data.pointer.is_const);
+        result->value->type = get_pointer_to_type(ira->codegen, first_field->type_entry,
+                target_value_ptr->value->type->data.pointer.is_const);
         return result;
     } else if (target_type->id == ZigTypeIdErrorSet) {
         // construct an error set from the prong values
@@ -19666,12 +21955,12 @@ static IrInstruction *ir_analyze_instruction_switch_else_var(IrAnalyze *ira,
         IrInstructionSwitchElseVar *instruction)
 {
     IrInstruction *target_value_ptr = instruction->target_value_ptr->child;
-    if (type_is_invalid(target_value_ptr->value.type))
+    if (type_is_invalid(target_value_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
-    ZigType *ref_type = target_value_ptr->value.type;
+    ZigType *ref_type = target_value_ptr->value->type;
     assert(ref_type->id == ZigTypeIdPointer);
-    ZigType *target_type = target_value_ptr->value.type->data.pointer.child_type;
+    ZigType *target_type = target_value_ptr->value->type->data.pointer.child_type;
     if (target_type->id == ZigTypeIdErrorSet) {
         //  make a new set that has the other cases removed
         if (!resolve_inferred_error_set(ira->codegen, target_type, instruction->base.source_node)) {
@@ -19687,12 +21976,12 @@ static IrInstruction *ir_analyze_instruction_switch_else_var(IrAnalyze *ira,
         for (size_t case_i = 0; case_i < instruction->switch_br->case_count; case_i += 1) {
             IrInstructionSwitchBrCase *br_case = &instruction->switch_br->cases[case_i];
             IrInstruction *case_expr = br_case->value->child;
-            if (case_expr->value.type->id == ZigTypeIdErrorSet) {
+            if (case_expr->value->type->id == ZigTypeIdErrorSet) {
                 ErrorTableEntry *err = ir_resolve_error(ira, case_expr);
                 if (err == nullptr)
                     return ira->codegen->invalid_instruction;
                 errors[err->value] = err;
-            } else if (case_expr->value.type->id == ZigTypeIdMetaType) {
+            } else if (case_expr->value->type->id == ZigTypeIdMetaType) {
                 ZigType *err_set_type = ir_resolve_type(ira, case_expr);
                 if (type_is_invalid(err_set_type))
                     return ira->codegen->invalid_instruction;
@@ -19746,6 +22035,15 @@ static IrInstruction *ir_analyze_instruction_union_tag(IrAnalyze *ira, IrInstruc
     return ir_analyze_union_tag(ira, &instruction->base, value);
 }
 
+static void ir_record_fetched_import(ZigType *importer, ZigType *import) {
+    ZigList<ZigType *> *fetched = &importer->data.structure.root_struct->fetched_imports;
+    for (size_t i = 0; i < fetched->length; i += 1) {
+        if (fetched->at(i) == import)
+            return;
+    }
+    fetched->append(import);
+}
+
 static IrInstruction *ir_analyze_instruction_import(IrAnalyze *ira, IrInstructionImport *import_instruction) {
     Error err;
 
@@ -19791,6 +22089,7 @@ static IrInstruction *ir_analyze_instruction_import(IrAnalyze *ira, IrInstructio
 
     auto import_entry = ira->codegen->import_table.maybe_get(resolved_path);
     if (import_entry) {
+        ir_record_fetched_import(import, import_entry->value);
         return ir_const_type(ira, &import_instruction->base, import_entry->value);
     }
 
@@ -19819,13 +22118,14 @@ static IrInstruction *ir_analyze_instruction_import(IrAnalyze *ira, IrInstructio
     }
 
     ZigType *target_import = add_source_file(ira->codegen, target_package, resolved_path, import_code, source_kind);
+    ir_record_fetched_import(import, target_import);
 
     return ir_const_type(ira, &import_instruction->base, target_import);
 }
 
 static IrInstruction *ir_analyze_instruction_ref(IrAnalyze *ira, IrInstructionRef *ref_instruction) {
     IrInstruction *value = ref_instruction->value->child;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
     return ir_get_ref(ira, &ref_instruction->base, value, ref_instruction->is_const, ref_instruction->is_volatile);
 }
@@ -19851,13 +22151,13 @@ static IrInstruction *ir_analyze_union_init(IrAnalyze *ira, IrInstruction *sourc
     if (type_is_invalid(type_field->type_entry))
         return ira->codegen->invalid_instruction;
 
-    if (result_loc->value.data.x_ptr.mut == ConstPtrMutInfer) {
+    if (result_loc->value->data.x_ptr.mut == ConstPtrMutInfer) {
         if (instr_is_comptime(field_result_loc) &&
-            field_result_loc->value.data.x_ptr.mut != ConstPtrMutRuntimeVar)
+            field_result_loc->value->data.x_ptr.mut != ConstPtrMutRuntimeVar)
         {
             // nothing
         } else {
-            result_loc->value.special = ConstValSpecialRuntime;
+            result_loc->value->special = ConstValSpecialRuntime;
         }
     }
 
@@ -19886,7 +22186,7 @@ static IrInstruction *ir_analyze_container_init_fields(IrAnalyze *ira, IrInstruc
         }
         IrInstructionContainerInitFieldsField *field = &fields[0];
         IrInstruction *field_result_loc = field->result_loc->child;
-        if (type_is_invalid(field_result_loc->value.type))
+        if (type_is_invalid(field_result_loc->value->type))
             return ira->codegen->invalid_instruction;
 
         return ir_analyze_union_init(ira, instruction, field->source_node, container_type, field->name,
@@ -19928,7 +22228,7 @@ static IrInstruction *ir_analyze_container_init_fields(IrAnalyze *ira, IrInstruc
         IrInstructionContainerInitFieldsField *field = &fields[i];
 
         IrInstruction *field_result_loc = field->result_loc->child;
-        if (type_is_invalid(field_result_loc->value.type))
+        if (type_is_invalid(field_result_loc->value->type))
             return ira->codegen->invalid_instruction;
 
         TypeStructField *type_field = find_struct_type_field(container_type, field->name);
@@ -19952,7 +22252,7 @@ static IrInstruction *ir_analyze_container_init_fields(IrAnalyze *ira, IrInstruc
         field_assign_nodes[field_index] = field->source_node;
 
         if (instr_is_comptime(field_result_loc) &&
-            field_result_loc->value.data.x_ptr.mut != ConstPtrMutRuntimeVar)
+            field_result_loc->value->data.x_ptr.mut != ConstPtrMutRuntimeVar)
         {
             const_ptrs.append(field_result_loc);
         } else {
@@ -19986,12 +22286,12 @@ static IrInstruction *ir_analyze_container_init_fields(IrAnalyze *ira, IrInstruc
             return ira->codegen->invalid_instruction;
 
         IrInstruction *runtime_inst = ir_const(ira, instruction, field->init_val->type);
-        copy_const_val(&runtime_inst->value, field->init_val, true);
+        copy_const_val(runtime_inst->value, field->init_val, true);
 
         IrInstruction *field_ptr = ir_analyze_struct_field_ptr(ira, instruction, field, result_loc,
                 container_type, true);
         ir_analyze_store_ptr(ira, instruction, field_ptr, runtime_inst);
-        if (instr_is_comptime(field_ptr) && field_ptr->value.data.x_ptr.mut != ConstPtrMutRuntimeVar) {
+        if (instr_is_comptime(field_ptr) && field_ptr->value->data.x_ptr.mut != ConstPtrMutRuntimeVar) {
             const_ptrs.append(field_ptr);
         } else {
             first_non_const_instruction = result_loc;
@@ -20000,13 +22300,13 @@ static IrInstruction *ir_analyze_container_init_fields(IrAnalyze *ira, IrInstruc
     if (any_missing)
         return ira->codegen->invalid_instruction;
 
-    if (result_loc->value.data.x_ptr.mut == ConstPtrMutInfer) {
+    if (result_loc->value->data.x_ptr.mut == ConstPtrMutInfer) {
         if (const_ptrs.length != actual_field_count) {
-            result_loc->value.special = ConstValSpecialRuntime;
+            result_loc->value->special = ConstValSpecialRuntime;
             for (size_t i = 0; i < const_ptrs.length; i += 1) {
                 IrInstruction *field_result_loc = const_ptrs.at(i);
                 IrInstruction *deref = ir_get_deref(ira, field_result_loc, field_result_loc, nullptr);
-                field_result_loc->value.special = ConstValSpecialRuntime;
+                field_result_loc->value->special = ConstValSpecialRuntime;
                 ir_analyze_store_ptr(ira, field_result_loc, field_result_loc, deref);
             }
         }
@@ -20050,7 +22350,7 @@ static IrInstruction *ir_analyze_instruction_container_init_list(IrAnalyze *ira,
     if (container_type->id == ZigTypeIdStruct && elem_count == 0) {
         ir_assert(instruction->result_loc != nullptr, &instruction->base);
         IrInstruction *result_loc = instruction->result_loc->child;
-        if (type_is_invalid(result_loc->value.type))
+        if (type_is_invalid(result_loc->value->type))
             return result_loc;
         return ir_analyze_container_init_fields(ira, &instruction->base, container_type, 0, nullptr, result_loc);
     }
@@ -20064,9 +22364,9 @@ static IrInstruction *ir_analyze_instruction_container_init_list(IrAnalyze *ira,
 
     ir_assert(instruction->result_loc != nullptr, &instruction->base);
     IrInstruction *result_loc = instruction->result_loc->child;
-    if (type_is_invalid(result_loc->value.type))
+    if (type_is_invalid(result_loc->value->type))
         return result_loc;
-    ir_assert(result_loc->value.type->id == ZigTypeIdPointer, &instruction->base);
+    ir_assert(result_loc->value->type->id == ZigTypeIdPointer, &instruction->base);
 
     ZigType *child_type = container_type->data.array.child_type;
     if (container_type->data.array.len != elem_count) {
@@ -20112,13 +22412,13 @@ static IrInstruction *ir_analyze_instruction_container_init_list(IrAnalyze *ira,
 
     for (size_t i = 0; i < elem_count; i += 1) {
         IrInstruction *elem_result_loc = instruction->elem_result_loc_list[i]->child;
-        if (type_is_invalid(elem_result_loc->value.type))
+        if (type_is_invalid(elem_result_loc->value->type))
             return ira->codegen->invalid_instruction;
 
-        assert(elem_result_loc->value.type->id == ZigTypeIdPointer);
+        assert(elem_result_loc->value->type->id == ZigTypeIdPointer);
 
         if (instr_is_comptime(elem_result_loc) &&
-            elem_result_loc->value.data.x_ptr.mut != ConstPtrMutRuntimeVar)
+            elem_result_loc->value->data.x_ptr.mut != ConstPtrMutRuntimeVar)
         {
             const_ptrs.append(elem_result_loc);
         } else {
@@ -20126,14 +22426,14 @@ static IrInstruction *ir_analyze_instruction_container_init_list(IrAnalyze *ira,
         }
     }
 
-    if (result_loc->value.data.x_ptr.mut == ConstPtrMutInfer) {
+    if (result_loc->value->data.x_ptr.mut == ConstPtrMutInfer) {
         if (const_ptrs.length != elem_count) {
-            result_loc->value.special = ConstValSpecialRuntime;
+            result_loc->value->special = ConstValSpecialRuntime;
             for (size_t i = 0; i < const_ptrs.length; i += 1) {
                 IrInstruction *elem_result_loc = const_ptrs.at(i);
-                assert(elem_result_loc->value.special == ConstValSpecialStatic);
+                assert(elem_result_loc->value->special == ConstValSpecialStatic);
                 IrInstruction *deref = ir_get_deref(ira, elem_result_loc, elem_result_loc, nullptr);
-                elem_result_loc->value.special = ConstValSpecialRuntime;
+                elem_result_loc->value->special = ConstValSpecialRuntime;
                 ir_analyze_store_ptr(ira, elem_result_loc, elem_result_loc, deref);
             }
         }
@@ -20149,7 +22449,7 @@ static IrInstruction *ir_analyze_instruction_container_init_list(IrAnalyze *ira,
         return ira->codegen->invalid_instruction;
     }
 
-    ZigType *result_elem_type = result_loc->value.type->data.pointer.child_type;
+    ZigType *result_elem_type = result_loc->value->type->data.pointer.child_type;
     if (is_slice(result_elem_type)) {
         ErrorMsg *msg = ir_add_error(ira, &instruction->base,
             buf_sprintf("runtime-initialized array cannot be casted to slice type '%s'",
@@ -20171,7 +22471,7 @@ static IrInstruction *ir_analyze_instruction_container_init_fields(IrAnalyze *ir
 
     ir_assert(instruction->result_loc != nullptr, &instruction->base);
     IrInstruction *result_loc = instruction->result_loc->child;
-    if (type_is_invalid(result_loc->value.type))
+    if (type_is_invalid(result_loc->value->type))
         return result_loc;
 
     return ir_analyze_container_init_fields(ira, &instruction->base, container_type,
@@ -20197,10 +22497,10 @@ static IrInstruction *ir_analyze_instruction_compile_log(IrAnalyze *ira, IrInstr
     fprintf(stderr, "| ");
     for (size_t i = 0; i < instruction->msg_count; i += 1) {
         IrInstruction *msg = instruction->msg_list[i]->child;
-        if (type_is_invalid(msg->value.type))
+        if (type_is_invalid(msg->value->type))
             return ira->codegen->invalid_instruction;
         buf_resize(&buf, 0);
-        render_const_value(ira->codegen, &buf, &msg->value);
+        render_const_value(ira->codegen, &buf, msg->value);
         const char *comma_str = (i != 0) ? ", " : "";
         fprintf(stderr, "%s%s", comma_str, buf_ptr(&buf));
     }
@@ -20219,25 +22519,25 @@ static IrInstruction *ir_analyze_instruction_compile_log(IrAnalyze *ira, IrInstr
 
 static IrInstruction *ir_analyze_instruction_err_name(IrAnalyze *ira, IrInstructionErrName *instruction) {
     IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_value = ir_implicit_cast(ira, value, ira->codegen->builtin_types.entry_global_error_set);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *u8_ptr_type = get_pointer_to_type_extra(ira->codegen, ira->codegen->builtin_types.entry_u8,
             true, false, PtrLenUnknown, 0, 0, 0, false);
     ZigType *str_type = get_slice_type(ira->codegen, u8_ptr_type);
-    if (casted_value->value.special == ConstValSpecialStatic) {
-        ErrorTableEntry *err = casted_value->value.data.x_err_set;
+    if (casted_value->value->special == ConstValSpecialStatic) {
+        ErrorTableEntry *err = casted_value->value->data.x_err_set;
         if (!err->cached_error_name_val) {
             ConstExprValue *array_val = create_const_str_lit(ira->codegen, &err->name);
             err->cached_error_name_val = create_const_slice(ira->codegen, array_val, 0, buf_len(&err->name), true);
         }
         IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
-        copy_const_val(&result->value, err->cached_error_name_val, true);
-        result->value.type = str_type;
+        copy_const_val(result->value, err->cached_error_name_val, true);
+        result->value->type = str_type;
         return result;
     }
 
@@ -20245,25 +22545,25 @@ static IrInstruction *ir_analyze_instruction_err_name(IrAnalyze *ira, IrInstruct
 
     IrInstruction *result = ir_build_err_name(&ira->new_irb,
         instruction->base.scope, instruction->base.source_node, value);
-    result->value.type = str_type;
+    result->value->type = str_type;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_enum_tag_name(IrAnalyze *ira, IrInstructionTagName *instruction) {
     Error err;
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
-    assert(target->value.type->id == ZigTypeIdEnum);
+    assert(target->value->type->id == ZigTypeIdEnum);
 
     if (instr_is_comptime(target)) {
-        if ((err = type_resolve(ira->codegen, target->value.type, ResolveStatusZeroBitsKnown)))
+        if ((err = type_resolve(ira->codegen, target->value->type, ResolveStatusZeroBitsKnown)))
             return ira->codegen->invalid_instruction;
-        TypeEnumField *field = find_enum_field_by_tag(target->value.type, &target->value.data.x_bigint);
+        TypeEnumField *field = find_enum_field_by_tag(target->value->type, &target->value->data.x_bigint);
         ConstExprValue *array_val = create_const_str_lit(ira->codegen, field->name);
         IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
-        init_const_slice(ira->codegen, &result->value, array_val, 0, buf_len(field->name), true);
+        init_const_slice(ira->codegen, result->value, array_val, 0, buf_len(field->name), true);
         return result;
     }
 
@@ -20273,7 +22573,7 @@ static IrInstruction *ir_analyze_instruction_enum_tag_name(IrAnalyze *ira, IrIns
             ira->codegen, ira->codegen->builtin_types.entry_u8,
             true, false, PtrLenUnknown,
             0, 0, 0, false);
-    result->value.type = get_slice_type(ira->codegen, u8_ptr_type);
+    result->value->type = get_slice_type(ira->codegen, u8_ptr_type);
     return result;
 }
 
@@ -20292,7 +22592,7 @@ static IrInstruction *ir_analyze_instruction_field_parent_ptr(IrAnalyze *ira,
         return ira->codegen->invalid_instruction;
 
     IrInstruction *field_ptr = instruction->field_ptr->child;
-    if (type_is_invalid(field_ptr->value.type))
+    if (type_is_invalid(field_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     if (container_type->id != ZigTypeIdStruct) {
@@ -20312,9 +22612,9 @@ static IrInstruction *ir_analyze_instruction_field_parent_ptr(IrAnalyze *ira,
         return ira->codegen->invalid_instruction;
     }
 
-    if (field_ptr->value.type->id != ZigTypeIdPointer) {
+    if (field_ptr->value->type->id != ZigTypeIdPointer) {
         ir_add_error(ira, field_ptr,
-                buf_sprintf("expected pointer, found '%s'", buf_ptr(&field_ptr->value.type->name)));
+                buf_sprintf("expected pointer, found '%s'", buf_ptr(&field_ptr->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
@@ -20323,17 +22623,17 @@ static IrInstruction *ir_analyze_instruction_field_parent_ptr(IrAnalyze *ira,
     uint32_t parent_ptr_align = is_packed ? 1 : get_abi_alignment(ira->codegen, container_type);
 
     ZigType *field_ptr_type = get_pointer_to_type_extra(ira->codegen, field->type_entry,
-            field_ptr->value.type->data.pointer.is_const,
-            field_ptr->value.type->data.pointer.is_volatile,
+            field_ptr->value->type->data.pointer.is_const,
+            field_ptr->value->type->data.pointer.is_volatile,
             PtrLenSingle,
             field_ptr_align, 0, 0, false);
     IrInstruction *casted_field_ptr = ir_implicit_cast(ira, field_ptr, field_ptr_type);
-    if (type_is_invalid(casted_field_ptr->value.type))
+    if (type_is_invalid(casted_field_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *result_type = get_pointer_to_type_extra(ira->codegen, container_type,
-            casted_field_ptr->value.type->data.pointer.is_const,
-            casted_field_ptr->value.type->data.pointer.is_volatile,
+            casted_field_ptr->value->type->data.pointer.is_const,
+            casted_field_ptr->value->type->data.pointer.is_volatile,
             PtrLenSingle,
             parent_ptr_align, 0, 0, false);
 
@@ -20357,7 +22657,7 @@ static IrInstruction *ir_analyze_instruction_field_parent_ptr(IrAnalyze *ira,
         }
 
         IrInstruction *result = ir_const(ira, &instruction->base, result_type);
-        ConstExprValue *out_val = &result->value;
+        ConstExprValue *out_val = result->value;
         out_val->data.x_ptr.special = ConstPtrSpecialRef;
         out_val->data.x_ptr.data.ref.pointee = field_ptr_val->data.x_ptr.data.base_struct.struct_val;
         out_val->data.x_ptr.mut = field_ptr_val->data.x_ptr.mut;
@@ -20366,7 +22666,7 @@ static IrInstruction *ir_analyze_instruction_field_parent_ptr(IrAnalyze *ira,
 
     IrInstruction *result = ir_build_field_parent_ptr(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, type_value, field_name_value, casted_field_ptr, field);
-    result->value.type = result_type;
+    result->value->type = result_type;
     return result;
 }
 
@@ -20416,7 +22716,7 @@ static IrInstruction *ir_analyze_instruction_byte_offset_of(IrAnalyze *ira,
         IrInstructionByteOffsetOf *instruction)
 {
     IrInstruction *type_value = instruction->type_value->child;
-    if (type_is_invalid(type_value->value.type))
+    if (type_is_invalid(type_value->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *field_name_value = instruction->field_name->child;
@@ -20432,7 +22732,7 @@ static IrInstruction *ir_analyze_instruction_bit_offset_of(IrAnalyze *ira,
         IrInstructionBitOffsetOf *instruction)
 {
     IrInstruction *type_value = instruction->type_value->child;
-    if (type_is_invalid(type_value->value.type))
+    if (type_is_invalid(type_value->value->type))
         return ira->codegen->invalid_instruction;
     IrInstruction *field_name_value = instruction->field_name->child;
     size_t byte_offset = 0;
@@ -20491,6 +22791,24 @@ static ZigType *ir_type_info_get_type(IrAnalyze *ira, const char *type_name, Zig
     return var->const_value->data.x_type;
 }
 
+static int type_info_decl_cmp(const void *a, const void *b) {
+    const Tld *a_tld = *reinterpret_cast<Tld *const *>(a);
+    const Tld *b_tld = *reinterpret_cast<Tld *const *>(b);
+    if (a_tld->import != b_tld->import) {
+        int path_cmp = strcmp(buf_ptr(a_tld->import->data.structure.root_struct->path),
+                buf_ptr(b_tld->import->data.structure.root_struct->path));
+        if (path_cmp != 0)
+            return path_cmp;
+    }
+    const AstNode *a_node = a_tld->source_node;
+    const AstNode *b_node = b_tld->source_node;
+    if (a_node->line != b_node->line)
+        return (a_node->line > b_node->line) - (a_node->line < b_node->line);
+    if (a_node->column != b_node->column)
+        return (a_node->column > b_node->column) - (a_node->column < b_node->column);
+    return strcmp(buf_ptr(a_tld->name), buf_ptr(b_tld->name));
+}
+
 static Error ir_make_type_info_decls(IrAnalyze *ira, IrInstruction *source_instr, ConstExprValue *out_val,
         ScopeDecls *decls_scope)
 {
@@ -20515,31 +22833,42 @@ static Error ir_make_type_info_decls(IrAnalyze *ira, IrInstruction *source_instr
     if ((err = ensure_complete_type(ira->codegen, type_info_fn_decl_inline_type)))
         return err;
 
-    // Loop through our declarations once to figure out how many declarations we will generate info for.
+    // Loop through our declarations once to resolve them and collect the ones we will generate info for.
+    // Resolving a declaration may add entries to the table, so the entries are copied out first.
+    ZigList<Tld *> decls = {};
     auto decl_it = decls_scope->decl_table.entry_iterator();
     decltype(decls_scope->decl_table)::Entry *curr_entry = nullptr;
-    int declaration_count = 0;
-
     while ((curr_entry = decl_it.next()) != nullptr) {
+        decls.append(curr_entry->value);
+    }
+
+    size_t declaration_count = 0;
+    for (size_t i = 0; i < decls.length; i += 1) {
+        Tld *tld = decls.at(i);
         // If the declaration is unresolved, force it to be resolved again.
-        if (curr_entry->value->resolution == TldResolutionUnresolved) {
-            resolve_top_level_decl(ira->codegen, curr_entry->value, curr_entry->value->source_node);
-            if (curr_entry->value->resolution != TldResolutionOk) {
+        if (tld->resolution == TldResolutionUnresolved) {
+            resolve_top_level_decl(ira->codegen, tld, tld->source_node);
+            if (tld->resolution != TldResolutionOk) {
                 return ErrorSemanticAnalyzeFail;
             }
         }
 
         // Skip comptime blocks and test functions.
-        if (curr_entry->value->id != TldIdCompTime) {
-            if (curr_entry->value->id == TldIdFn) {
-                ZigFn *fn_entry = ((TldFn *)curr_entry->value)->fn_entry;
-                if (fn_entry->is_test)
-                    continue;
-            }
-
-            declaration_count += 1;
+        if (tld->id == TldIdCompTime) {
+            continue;
+        } else if (tld->id == TldIdFn) {
+            ZigFn *fn_entry = ((TldFn *)tld)->fn_entry;
+            if (fn_entry->is_test)
+                continue;
         }
+
+        decls.items[declaration_count] = tld;
+        declaration_count += 1;
     }
+    decls.resize(declaration_count);
+
+    // The table order depends on the hash function, so report declarations in source order.
+    qsort(decls.items, decls.length, sizeof(Tld *), type_info_decl_cmp);
 
     ConstExprValue *declaration_array = create_const_vals(1);
     declaration_array->special = ConstValSpecialStatic;
@@ -20549,40 +22878,29 @@ static Error ir_make_type_info_decls(IrAnalyze *ira, IrInstruction *source_instr
     init_const_slice(ira->codegen, out_val, declaration_array, 0, declaration_count, false);
 
     // Loop through the declarations and generate info.
-    decl_it = decls_scope->decl_table.entry_iterator();
-    curr_entry = nullptr;
-    int declaration_index = 0;
-    while ((curr_entry = decl_it.next()) != nullptr) {
-        // Skip comptime blocks and test functions.
-        if (curr_entry->value->id == TldIdCompTime) {
-            continue;
-        } else if (curr_entry->value->id == TldIdFn) {
-            ZigFn *fn_entry = ((TldFn *)curr_entry->value)->fn_entry;
-            if (fn_entry->is_test)
-                continue;
-        }
-
+    for (size_t declaration_index = 0; declaration_index < decls.length; declaration_index += 1) {
+        Tld *tld = decls.at(declaration_index);
         ConstExprValue *declaration_val = &declaration_array->data.x_array.data.s_none.elements[declaration_index];
 
         declaration_val->special = ConstValSpecialStatic;
         declaration_val->type = type_info_declaration_type;
 
         ConstExprValue *inner_fields = create_const_vals(3);
-        ConstExprValue *name = create_const_str_lit(ira->codegen, curr_entry->key);
-        init_const_slice(ira->codegen, &inner_fields[0], name, 0, buf_len(curr_entry->key), true);
+        ConstExprValue *name = create_const_str_lit(ira->codegen, tld->name);
+        init_const_slice(ira->codegen, &inner_fields[0], name, 0, buf_len(tld->name), true);
         inner_fields[1].special = ConstValSpecialStatic;
         inner_fields[1].type = ira->codegen->builtin_types.entry_bool;
-        inner_fields[1].data.x_bool = curr_entry->value->visib_mod == VisibModPub;
+        inner_fields[1].data.x_bool = tld->visib_mod == VisibModPub;
         inner_fields[2].special = ConstValSpecialStatic;
         inner_fields[2].type = type_info_declaration_data_type;
         inner_fields[2].parent.id = ConstParentIdStruct;
         inner_fields[2].parent.data.p_struct.struct_val = declaration_val;
         inner_fields[2].parent.data.p_struct.field_index = 1;
 
-        switch (curr_entry->value->id) {
+        switch (tld->id) {
             case TldIdVar:
                 {
-                    ZigVar *var = ((TldVar *)curr_entry->value)->var;
+                    ZigVar *var = ((TldVar *)tld)->var;
                     if ((err = ensure_complete_type(ira->codegen, var->const_value->type)))
                         return ErrorSemanticAnalyzeFail;
 
@@ -20610,7 +22928,7 @@ static Error ir_make_type_info_decls(IrAnalyze *ira, IrInstruction *source_instr
                     // 2: Data.Fn: Data.FnDecl
                     bigint_init_unsigned(&inner_fields[2].data.x_union.tag, 2);
 
-                    ZigFn *fn_entry = ((TldFn *)curr_entry->value)->fn_entry;
+                    ZigFn *fn_entry = ((TldFn *)tld)->fn_entry;
                     assert(!fn_entry->is_test);
 
                     if (fn_entry->type_entry == nullptr) {
@@ -20708,7 +23026,7 @@ static Error ir_make_type_info_decls(IrAnalyze *ira, IrInstruction *source_instr
                 }
             case TldIdContainer:
                 {
-                    ZigType *type_entry = ((TldContainer *)curr_entry->value)->type_entry;
+                    ZigType *type_entry = ((TldContainer *)tld)->type_entry;
                     if ((err = ensure_complete_type(ira->codegen, type_entry)))
                         return ErrorSemanticAnalyzeFail;
 
@@ -20728,10 +23046,9 @@ static Error ir_make_type_info_decls(IrAnalyze *ira, IrInstruction *source_instr
         }
 
         declaration_val->data.x_struct.fields = inner_fields;
-        declaration_index++;
     }
 
-    assert(declaration_index == declaration_count);
+    decls.deinit();
     return ErrorNone;
 }
 
@@ -21437,7 +23754,7 @@ static IrInstruction *ir_analyze_instruction_type_info(IrAnalyze *ira,
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_const(ira, &instruction->base, result_type);
-    ConstExprValue *out_val = &result->value;
+    ConstExprValue *out_val = result->value;
     bigint_init_unsigned(&out_val->data.x_union.tag, type_id_index(type_entry));
     out_val->data.x_union.payload = payload;
 
@@ -21462,7 +23779,7 @@ static IrInstruction *ir_analyze_instruction_type_id(IrAnalyze *ira,
     ZigType *result_type = var_value->data.x_type;
 
     IrInstruction *result = ir_const(ira, &instruction->base, result_type);
-    bigint_init_unsigned(&result->value.data.x_enum_tag, type_id_index(type_entry));
+    bigint_init_unsigned(&result->value->data.x_enum_tag, type_id_index(type_entry));
     return result;
 }
 
@@ -21490,7 +23807,7 @@ static IrInstruction *ir_analyze_instruction_type_name(IrAnalyze *ira, IrInstruc
         type_entry->cached_const_name_val = create_const_str_lit(ira->codegen, type_bare_name(type_entry));
     }
     IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
-    copy_const_val(&result->value, type_entry->cached_const_name_val, true);
+    copy_const_val(result->value, type_entry->cached_const_name_val, true);
     return result;
 }
 
@@ -21508,6 +23825,7 @@ static IrInstruction *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruct
     AstNode *block_node = node->data.fn_call_expr.params.at(0);
 
     ScopeCImport *cimport_scope = create_cimport_scope(ira->codegen, node, instruction->base.scope);
+    get_scope_import(instruction->base.scope)->data.structure.root_struct->uses_c_import = true;
 
     // Execute the C import block like an inline function
     ZigType *void_type = ira->codegen->builtin_types.entry_void;
@@ -21534,7 +23852,10 @@ static IrInstruction *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruct
     cache_buf(cache_hash, &cimport_scope->buf);
 
     // Set this because we're not adding any files before checking for a hit.
-    cache_hash->force_check_manifest = true;
+    // A lazy import has no translation to cache and only wants the digest,
+    // which without the manifest always takes the miss path below.
+    bool lazy = ira->codegen->lazy_cimport;
+    cache_hash->force_check_manifest = !lazy;
 
     Buf tmp_c_file_digest = BUF_INIT;
     buf_resize(&tmp_c_file_digest, 0);
@@ -21544,7 +23865,9 @@ static IrInstruction *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruct
             return ira->codegen->invalid_instruction;
         }
     }
-    ira->codegen->caches_to_release.append(cache_hash);
+    if (!lazy) {
+        ira->codegen->caches_to_release.append(cache_hash);
+    }
 
     Buf *out_zig_dir = buf_alloc();
     Buf *out_zig_path = buf_alloc();
@@ -21589,15 +23912,21 @@ static IrInstruction *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruct
 
         clang_argv.append(nullptr); // to make the [start...end] argument work
 
-        AstNode *root_node;
+        AstNode *root_node = nullptr;
+        CImportLazy *c_import_lazy = nullptr;
         Stage2ErrorMsg *errors_ptr;
         size_t errors_len;
 
         const char *resources_path = buf_ptr(ira->codegen->zig_c_headers_dir);
 
-        if ((err = parse_h_file(ira->codegen, &root_node, &errors_ptr, &errors_len,
-            &clang_argv.at(0), &clang_argv.last(), Stage2TranslateModeImport, resources_path)))
-        {
+        if (lazy) {
+            err = parse_h_file_lazy(ira->codegen, &c_import_lazy, &errors_ptr, &errors_len,
+                &clang_argv.at(0), &clang_argv.last(), resources_path);
+        } else {
+            err = parse_h_file(ira->codegen, &root_node, &errors_ptr, &errors_len,
+                &clang_argv.at(0), &clang_argv.last(), Stage2TranslateModeImport, resources_path);
+        }
+        if (err) {
             if (err != ErrorCCompileErrors) {
                 ir_add_error_node(ira, node, buf_sprintf("C import failed: %s", err_str(err)));
                 return ira->codegen->invalid_instruction;
@@ -21624,6 +23953,23 @@ static IrInstruction *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruct
             fprintf(stderr, "@cImport .d file: %s\n", buf_ptr(tmp_dep_file));
         }
 
+        if (lazy) {
+            // Nothing is rendered for the build to fetch, so the headers
+            // themselves are its inputs.
+            if (ira->codegen->enable_cache &&
+                (err = cache_add_dep_file(&ira->codegen->cache_hash, tmp_dep_file, false)))
+            {
+                ir_add_error_node(ira, node,
+                        buf_sprintf("C import failed: unable to parse .d file: %s", err_str(err)));
+                return ira->codegen->invalid_instruction;
+            }
+            Buf *lazy_zig_path = buf_sprintf("%s.zig", buf_ptr(&tmp_c_file_path));
+            ZigType *child_import = add_source_file(ira->codegen, cimport_pkg, lazy_zig_path,
+                    buf_alloc(), SourceKindCImport);
+            child_import->data.structure.root_struct->c_import_lazy = c_import_lazy;
+            return ir_const_type(ira, &instruction->base, child_import);
+        }
+
         if ((err = cache_add_dep_file(cache_hash, tmp_dep_file, false))) {
             ir_add_error_node(ira, node, buf_sprintf("C import failed: unable to parse .d file: %s", err_str(err)));
             return ira->codegen->invalid_instruction;
@@ -21676,7 +24022,7 @@ static IrInstruction *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruct
 
 static IrInstruction *ir_analyze_instruction_c_include(IrAnalyze *ira, IrInstructionCInclude *instruction) {
     IrInstruction *name_value = instruction->name->child;
-    if (type_is_invalid(name_value->value.type))
+    if (type_is_invalid(name_value->value->type))
         return ira->codegen->invalid_instruction;
 
     Buf *include_name = ir_resolve_str(ira, name_value);
@@ -21694,7 +24040,7 @@ static IrInstruction *ir_analyze_instruction_c_include(IrAnalyze *ira, IrInstruc
 
 static IrInstruction *ir_analyze_instruction_c_define(IrAnalyze *ira, IrInstructionCDefine *instruction) {
     IrInstruction *name = instruction->name->child;
-    if (type_is_invalid(name->value.type))
+    if (type_is_invalid(name->value->type))
         return ira->codegen->invalid_instruction;
 
     Buf *define_name = ir_resolve_str(ira, name);
@@ -21702,7 +24048,7 @@ static IrInstruction *ir_analyze_instruction_c_define(IrAnalyze *ira, IrInstruct
         return ira->codegen->invalid_instruction;
 
     IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
     Buf *define_value = ir_resolve_str(ira, value);
@@ -21720,7 +24066,7 @@ static IrInstruction *ir_analyze_instruction_c_define(IrAnalyze *ira, IrInstruct
 
 static IrInstruction *ir_analyze_instruction_c_undef(IrAnalyze *ira, IrInstructionCUndef *instruction) {
     IrInstruction *name = instruction->name->child;
-    if (type_is_invalid(name->value.type))
+    if (type_is_invalid(name->value->type))
         return ira->codegen->invalid_instruction;
 
     Buf *undef_name = ir_resolve_str(ira, name);
@@ -21738,7 +24084,7 @@ static IrInstruction *ir_analyze_instruction_c_undef(IrAnalyze *ira, IrInstructi
 
 static IrInstruction *ir_analyze_instruction_embed_file(IrAnalyze *ira, IrInstructionEmbedFile *instruction) {
     IrInstruction *name = instruction->name->child;
-    if (type_is_invalid(name->value.type))
+    if (type_is_invalid(name->value->type))
         return ira->codegen->invalid_instruction;
 
     Buf *rel_file_path = ir_resolve_str(ira, name);
@@ -21769,11 +24115,22 @@ static IrInstruction *ir_analyze_instruction_embed_file(IrAnalyze *ira, IrInstru
             return ira->codegen->invalid_instruction;
         }
     }
+    ZigList<Buf *> *embedded_files = &import->data.structure.root_struct->embedded_files;
+    bool already_embedded = false;
+    for (size_t i = 0; i < embedded_files->length; i += 1) {
+        if (buf_eql_buf(embedded_files->at(i), file_path)) {
+            already_embedded = true;
+            break;
+        }
+    }
+    if (!already_embedded) {
+        embedded_files->append(file_path);
+    }
 
     ZigType *result_type = get_array_type(ira->codegen,
             ira->codegen->builtin_types.entry_u8, buf_len(file_contents));
     IrInstruction *result = ir_const(ira, &instruction->base, result_type);
-    init_const_str_lit(ira->codegen, &result->value, file_contents);
+    init_const_str_lit(ira->codegen, result->value, file_contents);
     return result;
 }
 
@@ -21783,25 +24140,25 @@ static IrInstruction *ir_analyze_instruction_cmpxchg(IrAnalyze *ira, IrInstructi
         return ira->codegen->invalid_instruction;
 
     IrInstruction *ptr = instruction->ptr->child;
-    if (type_is_invalid(ptr->value.type))
+    if (type_is_invalid(ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     // TODO let this be volatile
     ZigType *ptr_type = get_pointer_to_type(ira->codegen, operand_type, false);
     IrInstruction *casted_ptr = ir_implicit_cast(ira, ptr, ptr_type);
-    if (type_is_invalid(casted_ptr->value.type))
+    if (type_is_invalid(casted_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *cmp_value = instruction->cmp_value->child;
-    if (type_is_invalid(cmp_value->value.type))
+    if (type_is_invalid(cmp_value->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *new_value = instruction->new_value->child;
-    if (type_is_invalid(new_value->value.type))
+    if (type_is_invalid(new_value->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *success_order_value = instruction->success_order_value->child;
-    if (type_is_invalid(success_order_value->value.type))
+    if (type_is_invalid(success_order_value->value->type))
         return ira->codegen->invalid_instruction;
 
     AtomicOrder success_order;
@@ -21809,7 +24166,7 @@ static IrInstruction *ir_analyze_instruction_cmpxchg(IrAnalyze *ira, IrInstructi
         return ira->codegen->invalid_instruction;
 
     IrInstruction *failure_order_value = instruction->failure_order_value->child;
-    if (type_is_invalid(failure_order_value->value.type))
+    if (type_is_invalid(failure_order_value->value->type))
         return ira->codegen->invalid_instruction;
 
     AtomicOrder failure_order;
@@ -21817,11 +24174,11 @@ static IrInstruction *ir_analyze_instruction_cmpxchg(IrAnalyze *ira, IrInstructi
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_cmp_value = ir_implicit_cast(ira, cmp_value, operand_type);
-    if (type_is_invalid(casted_cmp_value->value.type))
+    if (type_is_invalid(casted_cmp_value->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_new_value = ir_implicit_cast(ira, new_value, operand_type);
-    if (type_is_invalid(casted_new_value->value.type))
+    if (type_is_invalid(casted_new_value->value->type))
         return ira->codegen->invalid_instruction;
 
     if (success_order < AtomicOrderMonotonic) {
@@ -21854,7 +24211,7 @@ static IrInstruction *ir_analyze_instruction_cmpxchg(IrAnalyze *ira, IrInstructi
     if (handle_is_ptr(result_type)) {
         result_loc = ir_resolve_result(ira, &instruction->base, instruction->result_loc,
                 result_type, nullptr, true, false);
-        if (type_is_invalid(result_loc->value.type) || instr_is_unreachable(result_loc)) {
+        if (type_is_invalid(result_loc->value->type) || instr_is_unreachable(result_loc)) {
             return result_loc;
         }
     } else {
@@ -21868,7 +24225,7 @@ static IrInstruction *ir_analyze_instruction_cmpxchg(IrAnalyze *ira, IrInstructi
 
 static IrInstruction *ir_analyze_instruction_fence(IrAnalyze *ira, IrInstructionFence *instruction) {
     IrInstruction *order_value = instruction->order_value->child;
-    if (type_is_invalid(order_value->value.type))
+    if (type_is_invalid(order_value->value->type))
         return ira->codegen->invalid_instruction;
 
     AtomicOrder order;
@@ -21877,7 +24234,7 @@ static IrInstruction *ir_analyze_instruction_fence(IrAnalyze *ira, IrInstruction
 
     IrInstruction *result = ir_build_fence(&ira->new_irb,
         instruction->base.scope, instruction->base.source_node, order_value, order);
-    result->value.type = ira->codegen->builtin_types.entry_void;
+    result->value->type = ira->codegen->builtin_types.entry_void;
     return result;
 }
 
@@ -21899,7 +24256,7 @@ static IrInstruction *ir_analyze_instruction_truncate(IrAnalyze *ira, IrInstruct
     }
 
     IrInstruction *target = instruction->target->child;
-    ZigType *src_type = target->value.type;
+    ZigType *src_type = target->value->type;
     if (type_is_invalid(src_type))
         return ira->codegen->invalid_instruction;
 
@@ -21935,11 +24292,11 @@ static IrInstruction *ir_analyze_instruction_truncate(IrAnalyze *ira, IrInstruct
 
         IrInstruction *result = ir_const(ira, &instruction->base, dest_type);
         if (is_vector) {
-            result->value.data.x_array.data.s_none.elements =
+            result->value->data.x_array.data.s_none.elements =
                 allocate<ConstExprValue>(dest_type->data.vector.len);
             for (uint32_t i = 0; i < dest_type->data.vector.len; i++) {
-                ConstExprValue *val = &target->value.data.x_array.data.s_none.elements[i];
-                ConstExprValue *result_val = &result->value.data.x_array.data.s_none.elements[i];
+                ConstExprValue *val = &target->value->data.x_array.data.s_none.elements[i];
+                ConstExprValue *result_val = &result->value->data.x_array.data.s_none.elements[i];
                 bigint_truncate(&result_val->data.x_bigint,
                     &val->data.x_bigint,
                     dest_scalar_type->data.integral.bit_count,
@@ -21948,7 +24305,7 @@ static IrInstruction *ir_analyze_instruction_truncate(IrAnalyze *ira, IrInstruct
                 result_val->type = dest_scalar_type;
             }
         } else {
-            bigint_truncate(&result->value.data.x_bigint, &val->data.x_bigint,
+            bigint_truncate(&result->value->data.x_bigint, &val->data.x_bigint,
                     dest_type->data.integral.bit_count, dest_type->data.integral.is_signed);
         }
         return result;
@@ -21957,16 +24314,16 @@ static IrInstruction *ir_analyze_instruction_truncate(IrAnalyze *ira, IrInstruct
     if (src_scalar_type->data.integral.bit_count == 0 || dest_scalar_type->data.integral.bit_count == 0) {
         IrInstruction *result = ir_const(ira, &instruction->base, dest_type);
         if (is_vector) {
-            result->value.data.x_array.data.s_none.elements =
+            result->value->data.x_array.data.s_none.elements =
                 allocate<ConstExprValue>(dest_type->data.vector.len);
             for (uint32_t i = 0; i < dest_type->data.vector.len; i++) {
-                ConstExprValue *result_val = &result->value.data.x_array.data.s_none.elements[i];
+                ConstExprValue *result_val = &result->value->data.x_array.data.s_none.elements[i];
                 bigint_init_unsigned(&result_val->data.x_bigint, 0);
                 result_val->special = ConstValSpecialStatic;
                 result_val->type = dest_scalar_type;
             }
         } else {
-            bigint_init_unsigned(&result->value.data.x_bigint, 0);
+            bigint_init_unsigned(&result->value->data.x_bigint, 0);
         }
         return result;
     }
@@ -21984,7 +24341,7 @@ static IrInstruction *ir_analyze_instruction_truncate(IrAnalyze *ira, IrInstruct
 
     IrInstruction *new_instruction = ir_build_truncate(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, dest_type_value, target);
-    new_instruction->value.type = dest_type;
+    new_instruction->value->type = dest_type;
     return new_instruction;
 }
 
@@ -21999,12 +24356,12 @@ static IrInstruction *ir_analyze_instruction_int_cast(IrAnalyze *ira, IrInstruct
     }
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (target->value.type->id != ZigTypeIdInt && target->value.type->id != ZigTypeIdComptimeInt) {
+    if (target->value->type->id != ZigTypeIdInt && target->value->type->id != ZigTypeIdComptimeInt) {
         ir_add_error(ira, instruction->target, buf_sprintf("expected integer type, found '%s'",
-                    buf_ptr(&target->value.type->name)));
+                    buf_ptr(&target->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
@@ -22033,15 +24390,15 @@ static IrInstruction *ir_analyze_instruction_float_cast(IrAnalyze *ira, IrInstru
     }
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (target->value.type->id == ZigTypeIdComptimeInt ||
-        target->value.type->id == ZigTypeIdComptimeFloat)
+    if (target->value->type->id == ZigTypeIdComptimeInt ||
+        target->value->type->id == ZigTypeIdComptimeFloat)
     {
         if (ir_num_lit_fits_in_other_type(ira, target, dest_type, true)) {
             CastOp op;
-            if (target->value.type->id == ZigTypeIdComptimeInt) {
+            if (target->value->type->id == ZigTypeIdComptimeInt) {
                 op = CastOpIntToFloat;
             } else {
                 op = CastOpNumLitToConcrete;
@@ -22052,9 +24409,9 @@ static IrInstruction *ir_analyze_instruction_float_cast(IrAnalyze *ira, IrInstru
         }
     }
 
-    if (target->value.type->id != ZigTypeIdFloat) {
+    if (target->value->type->id != ZigTypeIdFloat) {
         ir_add_error(ira, instruction->target, buf_sprintf("expected float type, found '%s'",
-                    buf_ptr(&target->value.type->name)));
+                    buf_ptr(&target->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
@@ -22073,12 +24430,12 @@ static IrInstruction *ir_analyze_instruction_err_set_cast(IrAnalyze *ira, IrInst
     }
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (target->value.type->id != ZigTypeIdErrorSet) {
+    if (target->value->type->id != ZigTypeIdErrorSet) {
         ir_add_error(ira, instruction->target,
-                buf_sprintf("expected error set type, found '%s'", buf_ptr(&target->value.type->name)));
+                buf_sprintf("expected error set type, found '%s'", buf_ptr(&target->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
@@ -22093,20 +24450,20 @@ static IrInstruction *ir_analyze_instruction_from_bytes(IrAnalyze *ira, IrInstru
         return ira->codegen->invalid_instruction;
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
     bool src_ptr_const;
     bool src_ptr_volatile;
     uint32_t src_ptr_align;
-    if (target->value.type->id == ZigTypeIdPointer) {
-        src_ptr_const = target->value.type->data.pointer.is_const;
-        src_ptr_volatile = target->value.type->data.pointer.is_volatile;
+    if (target->value->type->id == ZigTypeIdPointer) {
+        src_ptr_const = target->value->type->data.pointer.is_const;
+        src_ptr_volatile = target->value->type->data.pointer.is_volatile;
 
-        if ((err = resolve_ptr_align(ira, target->value.type, &src_ptr_align)))
+        if ((err = resolve_ptr_align(ira, target->value->type, &src_ptr_align)))
             return ira->codegen->invalid_instruction;
-    } else if (is_slice(target->value.type)) {
-        ZigType *src_ptr_type = target->value.type->data.structure.fields[slice_ptr_index].type_entry;
+    } else if (is_slice(target->value->type)) {
+        ZigType *src_ptr_type = target->value->type->data.structure.fields[slice_ptr_index].type_entry;
         src_ptr_const = src_ptr_type->data.pointer.is_const;
         src_ptr_volatile = src_ptr_type->data.pointer.is_volatile;
 
@@ -22116,10 +24473,10 @@ static IrInstruction *ir_analyze_instruction_from_bytes(IrAnalyze *ira, IrInstru
         src_ptr_const = true;
         src_ptr_volatile = false;
 
-        if ((err = type_resolve(ira->codegen, target->value.type, ResolveStatusAlignmentKnown)))
+        if ((err = type_resolve(ira->codegen, target->value->type, ResolveStatusAlignmentKnown)))
             return ira->codegen->invalid_instruction;
 
-        src_ptr_align = get_abi_alignment(ira->codegen, target->value.type);
+        src_ptr_align = get_abi_alignment(ira->codegen, target->value->type);
     }
 
     if ((err = type_resolve(ira->codegen, dest_child_type, ResolveStatusSizeKnown)))
@@ -22136,7 +24493,7 @@ static IrInstruction *ir_analyze_instruction_from_bytes(IrAnalyze *ira, IrInstru
     ZigType *u8_slice = get_slice_type(ira->codegen, u8_ptr);
 
     IrInstruction *casted_value = ir_implicit_cast(ira, target, u8_slice);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return ira->codegen->invalid_instruction;
 
     bool have_known_len = false;
@@ -22156,12 +24513,12 @@ static IrInstruction *ir_analyze_instruction_from_bytes(IrAnalyze *ira, IrInstru
 
     IrInstruction *result_loc = ir_resolve_result(ira, &instruction->base, instruction->result_loc,
             dest_slice_type, nullptr, true, false);
-    if (result_loc != nullptr && (type_is_invalid(result_loc->value.type) || instr_is_unreachable(result_loc))) {
+    if (result_loc != nullptr && (type_is_invalid(result_loc->value->type) || instr_is_unreachable(result_loc))) {
         return result_loc;
     }
 
-    if (casted_value->value.data.rh_slice.id == RuntimeHintSliceIdLen) {
-        known_len = casted_value->value.data.rh_slice.len;
+    if (casted_value->value->data.rh_slice.id == RuntimeHintSliceIdLen) {
+        known_len = casted_value->value->data.rh_slice.len;
         have_known_len = true;
     }
 
@@ -22186,16 +24543,16 @@ static IrInstruction *ir_analyze_instruction_to_bytes(IrAnalyze *ira, IrInstruct
     Error err;
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (!is_slice(target->value.type)) {
+    if (!is_slice(target->value->type)) {
         ir_add_error(ira, instruction->target,
-                buf_sprintf("expected slice, found '%s'", buf_ptr(&target->value.type->name)));
+                buf_sprintf("expected slice, found '%s'", buf_ptr(&target->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
-    ZigType *src_ptr_type = target->value.type->data.structure.fields[slice_ptr_index].type_entry;
+    ZigType *src_ptr_type = target->value->type->data.structure.fields[slice_ptr_index].type_entry;
 
     uint32_t alignment;
     if ((err = resolve_ptr_align(ira, src_ptr_type, &alignment)))
@@ -22212,14 +24569,14 @@ static IrInstruction *ir_analyze_instruction_to_bytes(IrAnalyze *ira, IrInstruct
             return ira->codegen->invalid_instruction;
 
         IrInstruction *result = ir_const(ira, &instruction->base, dest_slice_type);
-        result->value.data.x_struct.fields = create_const_vals(2);
+        result->value->data.x_struct.fields = create_const_vals(2);
 
-        ConstExprValue *ptr_val = &result->value.data.x_struct.fields[slice_ptr_index];
+        ConstExprValue *ptr_val = &result->value->data.x_struct.fields[slice_ptr_index];
         ConstExprValue *target_ptr_val = &target_val->data.x_struct.fields[slice_ptr_index];
         copy_const_val(ptr_val, target_ptr_val, false);
         ptr_val->type = dest_ptr_type;
 
-        ConstExprValue *len_val = &result->value.data.x_struct.fields[slice_len_index];
+        ConstExprValue *len_val = &result->value->data.x_struct.fields[slice_len_index];
         len_val->special = ConstValSpecialStatic;
         len_val->type = ira->codegen->builtin_types.entry_usize;
         ConstExprValue *target_len_val = &target_val->data.x_struct.fields[slice_len_index];
@@ -22233,7 +24590,7 @@ static IrInstruction *ir_analyze_instruction_to_bytes(IrAnalyze *ira, IrInstruct
 
     IrInstruction *result_loc = ir_resolve_result(ira, &instruction->base, instruction->result_loc,
             dest_slice_type, nullptr, true, false);
-    if (type_is_invalid(result_loc->value.type) || instr_is_unreachable(result_loc)) {
+    if (type_is_invalid(result_loc->value->type) || instr_is_unreachable(result_loc)) {
         return result_loc;
     }
 
@@ -22260,12 +24617,12 @@ static IrInstruction *ir_analyze_instruction_int_to_float(IrAnalyze *ira, IrInst
         return ira->codegen->invalid_instruction;
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (target->value.type->id != ZigTypeIdInt && target->value.type->id != ZigTypeIdComptimeInt) {
+    if (target->value->type->id != ZigTypeIdInt && target->value->type->id != ZigTypeIdComptimeInt) {
         ir_add_error(ira, instruction->target, buf_sprintf("expected int type, found '%s'",
-                    buf_ptr(&target->value.type->name)));
+                    buf_ptr(&target->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
@@ -22278,16 +24635,16 @@ static IrInstruction *ir_analyze_instruction_float_to_int(IrAnalyze *ira, IrInst
         return ira->codegen->invalid_instruction;
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (target->value.type->id == ZigTypeIdComptimeInt) {
+    if (target->value->type->id == ZigTypeIdComptimeInt) {
         return ir_implicit_cast(ira, target, dest_type);
     }
 
-    if (target->value.type->id != ZigTypeIdFloat && target->value.type->id != ZigTypeIdComptimeFloat) {
+    if (target->value->type->id != ZigTypeIdFloat && target->value->type->id != ZigTypeIdComptimeFloat) {
         ir_add_error(ira, instruction->target, buf_sprintf("expected float type, found '%s'",
-                    buf_ptr(&target->value.type->name)));
+                    buf_ptr(&target->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
@@ -22296,15 +24653,15 @@ static IrInstruction *ir_analyze_instruction_float_to_int(IrAnalyze *ira, IrInst
 
 static IrInstruction *ir_analyze_instruction_err_to_int(IrAnalyze *ira, IrInstructionErrToInt *instruction) {
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_target;
-    if (target->value.type->id == ZigTypeIdErrorSet) {
+    if (target->value->type->id == ZigTypeIdErrorSet) {
         casted_target = target;
     } else {
         casted_target = ir_implicit_cast(ira, target, ira->codegen->builtin_types.entry_global_error_set);
-        if (type_is_invalid(casted_target->value.type))
+        if (type_is_invalid(casted_target->value->type))
             return ira->codegen->invalid_instruction;
     }
 
@@ -22313,11 +24670,11 @@ static IrInstruction *ir_analyze_instruction_err_to_int(IrAnalyze *ira, IrInstru
 
 static IrInstruction *ir_analyze_instruction_int_to_err(IrAnalyze *ira, IrInstructionIntToErr *instruction) {
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_target = ir_implicit_cast(ira, target, ira->codegen->err_tag_type);
-    if (type_is_invalid(casted_target->value.type))
+    if (type_is_invalid(casted_target->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_analyze_int_to_err(ira, &instruction->base, casted_target, ira->codegen->builtin_types.entry_global_error_set);
@@ -22325,7 +24682,7 @@ static IrInstruction *ir_analyze_instruction_int_to_err(IrAnalyze *ira, IrInstru
 
 static IrInstruction *ir_analyze_bool_to_int(IrAnalyze *ira, IrInstruction *source_instr,
     IrInstruction *target) {
-    ZigType *target_type = target->value.type;
+    ZigType *target_type = target->value->type;
     bool is_vector = target_type->id == ZigTypeIdVector;
     ZigType *scalar_type = is_vector ? target_type->data.vector.elem_type : target_type;
 
@@ -22345,16 +24702,16 @@ static IrInstruction *ir_analyze_bool_to_int(IrAnalyze *ira, IrInstruction *sour
         if (is_vector) {
             IrInstruction *result = ir_const_undef(ira, source_instr,
                 get_vector_type(ira->codegen, target_type->data.vector.len, u1_type));
-            result->value.data.x_array.data.s_none.elements =
+            result->value->data.x_array.data.s_none.elements =
                 allocate<ConstExprValue>(target_type->data.vector.len);
             for (size_t i = 0; i < target_type->data.vector.len; i++) {
-                uint64_t is_true = target->value.data.x_array.data.s_none.elements[i].data.x_bool;
-                ConstExprValue *res = &result->value.data.x_array.data.s_none.elements[i];
+                uint64_t is_true = target->value->data.x_array.data.s_none.elements[i].data.x_bool;
+                ConstExprValue *res = &result->value->data.x_array.data.s_none.elements[i];
                 bigint_init_unsigned(&res->data.x_bigint, is_true);
                 res->special = ConstValSpecialStatic;
                 res->type = u1_type;
             }
-            result->value.special = ConstValSpecialStatic;
+            result->value->special = ConstValSpecialStatic;
             return result;
         } else {
             bool is_true;
@@ -22370,7 +24727,7 @@ static IrInstruction *ir_analyze_bool_to_int(IrAnalyze *ira, IrInstruction *sour
 
 static IrInstruction *ir_analyze_instruction_bool_to_int(IrAnalyze *ira, IrInstructionBoolToInt *instruction) {
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_analyze_bool_to_int(ira, &instruction->base, target);
@@ -22432,7 +24789,7 @@ static IrInstruction *ir_analyze_instruction_shuffle_vector(IrAnalyze *ira, IrIn
         return ira->codegen->invalid_instruction;
     }
 
-    ZigType *mask_type = mask->value.type;
+    ZigType *mask_type = mask->value->type;
     if (type_is_invalid(mask_type))
         return ira->codegen->invalid_instruction;
 
@@ -22444,126 +24801,128 @@ static IrInstruction *ir_analyze_instruction_shuffle_vector(IrAnalyze *ira, IrIn
         cast->data.vector.len = mask_type->data.array.len;
         cast->data.vector.elem_type = mask_type->data.array.child_type;
         mask = ir_implicit_cast(ira, mask, cast);
-        if (type_is_invalid(mask->value.type)) {
+        if (type_is_invalid(mask->value->type)) {
             ir_add_error(ira, mask,
-                buf_sprintf(shuffle_mask_fail_fmt, buf_ptr(&mask->value.type->name)));
+                buf_sprintf(shuffle_mask_fail_fmt, buf_ptr(&mask->value->type->name)));
             return ira->codegen->invalid_instruction;
         }
-        mask_type = mask->value.type;
+        mask_type = mask->value->type;
     }
 
     if (mask_type->id != ZigTypeIdVector) {
         ir_add_error(ira, mask,
-            buf_sprintf(shuffle_mask_fail_fmt, buf_ptr(&mask->value.type->name)));
+            buf_sprintf(shuffle_mask_fail_fmt, buf_ptr(&mask->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
     ZigType *mask_scalar_type = mask_type->data.array.child_type;
     if (mask_scalar_type->id != ZigTypeIdInt) {
         ir_add_error(ira, mask,
-            buf_sprintf(shuffle_mask_fail_fmt, buf_ptr(&mask->value.type->name)));
+            buf_sprintf(shuffle_mask_fail_fmt, buf_ptr(&mask->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
     if (mask_scalar_type->data.integral.bit_count != 32 ||
         mask_scalar_type->data.integral.is_signed == false) {
         ir_add_error(ira, mask,
-            buf_sprintf(shuffle_mask_fail_fmt, buf_ptr(&mask->value.type->name)));
+            buf_sprintf(shuffle_mask_fail_fmt, buf_ptr(&mask->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
-    uint64_t len_a, len_b, len_c = mask->value.type->data.vector.len;
-    if (a->value.type->id != ZigTypeIdVector) {
-        if (a->value.type->id != ZigTypeIdUndefined) {
+    uint64_t len_a, len_b, len_c = mask->value->type->data.vector.len;
+    if (a->value->type->id != ZigTypeIdVector) {
+        if (a->value->type->id != ZigTypeIdUndefined) {
             ir_add_error(ira, a,
                 buf_sprintf("expected vector of element type '%s' got '%s'",
                     buf_ptr(&scalar_type->name),
-                    buf_ptr(&a->value.type->name)));
+                    buf_ptr(&a->value->type->name)));
             return ira->codegen->invalid_instruction;
         }
     } else {
-        len_a = a->value.type->data.vector.len;
+        len_a = a->value->type->data.vector.len;
     }
 
-    if (b->value.type->id != ZigTypeIdVector) {
-        if (b->value.type->id != ZigTypeIdUndefined) {
+    if (b->value->type->id != ZigTypeIdVector) {
+        if (b->value->type->id != ZigTypeIdUndefined) {
             ir_add_error(ira, b,
                 buf_sprintf("expected vector of element type '%s' got '%s'",
                     buf_ptr(&scalar_type->name),
-                    buf_ptr(&b->value.type->name)));
+                    buf_ptr(&b->value->type->name)));
             return ira->codegen->invalid_instruction;
         }
     } else {
-        len_b = b->value.type->data.vector.len;
+        len_b = b->value->type->data.vector.len;
     }
 
-    if (a->value.type->id == ZigTypeIdUndefined && b->value.type->id == ZigTypeIdUndefined) {
+    if (a->value->type->id == ZigTypeIdUndefined && b->value->type->id == ZigTypeIdUndefined) {
         return ir_const_undef(ira, a, get_vector_type(ira->codegen, len_c, scalar_type));
     }
 
     // undefined is a vector up to length of the other vector.
-    if (a->value.type->id == ZigTypeIdUndefined) {
-        a = ir_const_undef(ira, a, b->value.type);
-        len_a = b->value.type->data.vector.len;
-    } else if (b->value.type->id == ZigTypeIdUndefined) {
-        b = ir_const_undef(ira, b, a->value.type);
-        len_b = a->value.type->data.vector.len;
+    if (a->value->type->id == ZigTypeIdUndefined) {
+        a = ir_const_undef(ira, a, b->value->type);
+        len_a = b->value->type->data.vector.len;
+    } else if (b->value->type->id == ZigTypeIdUndefined) {
+        b = ir_const_undef(ira, b, a->value->type);
+        len_b = a->value->type->data.vector.len;
     }
 
     // FIXME I think this needs to be more sophisticated
-    if (a->value.type->data.vector.elem_type != scalar_type) {
+    if (a->value->type->data.vector.elem_type != scalar_type) {
         ir_add_error(ira, a,
             buf_sprintf("element type '%s' does not match '%s'",
-                buf_ptr(&a->value.type->data.vector.elem_type->name),
+                buf_ptr(&a->value->type->data.vector.elem_type->name),
                 buf_ptr(&scalar_type->name)));
         return ira->codegen->invalid_instruction;
     }
-    if (b->value.type->data.vector.elem_type != scalar_type) {
+    if (b->value->type->data.vector.elem_type != scalar_type) {
         ir_add_error(ira, b,
             buf_sprintf("element type '%s' does not match '%s'",
-                buf_ptr(&b->value.type->data.vector.elem_type->name),
+                buf_ptr(&b->value->type->data.vector.elem_type->name),
                 buf_ptr(&scalar_type->name)));
         return ira->codegen->invalid_instruction;
     }
 
-    if (a->value.type != b->value.type) {
+    if (a->value->type != b->value->type) {
         assert(len_a != len_b);
         uint32_t len_max = max(len_a, len_b), len_min = min(len_a, len_b);
         bool expand_b = len_b < len_a;
         IrInstruction *expand_mask = ir_const(ira, &instruction->base,
             get_vector_type(ira->codegen, len_max, ira->codegen->builtin_types.entry_i32));
-        expand_mask->value.data.x_array.data.s_none.elements = create_const_vals(len_max);
+        expand_mask->value->data.x_array.data.s_none.elements = create_const_vals(len_max);
         uint32_t i = 0;
         for (; i < len_min; i++)
-            bigint_init_unsigned(&expand_mask->value.data.x_array.data.s_none.elements[i].data.x_bigint, i);
+            bigint_init_unsigned(&expand_mask->value->data.x_array.data.s_none.elements[i].data.x_bigint, i);
         for (; i < len_max; i++)
-            bigint_init_signed(&expand_mask->value.data.x_array.data.s_none.elements[i].data.x_bigint, -1);
+            bigint_init_signed(&expand_mask->value->data.x_array.data.s_none.elements[i].data.x_bigint, -1);
         IrInstruction *undef = ir_const_undef(ira, &instruction->base,
             get_vector_type(ira->codegen, len_min, scalar_type));
         if (expand_b) {
             if (instr_is_comptime(b)) {
-                b->value.data.x_array.data.s_none.elements =
-                    reallocate<ConstExprValue>(b->value.data.x_array.data.s_none.elements,
-                    b->value.type->data.vector.len, len_a);
+                ConstExprValue *old_elements = b->value->data.x_array.data.s_none.elements;
+                b->value->data.x_array.data.s_none.elements = create_const_vals(len_max);
+                memcpy(b->value->data.x_array.data.s_none.elements, old_elements,
+                    b->value->type->data.vector.len * sizeof(ConstExprValue));
             } else {
                 b = ir_build_shuffle_vector(&ira->new_irb,
                     instruction->base.scope, instruction->base.source_node,
                     instruction->scalar_type, b, undef, expand_mask);
-                b->value.special = ConstValSpecialRuntime;
+                b->value->special = ConstValSpecialRuntime;
             }
-            b->value.type = get_vector_type(ira->codegen, len_max, scalar_type);
+            b->value->type = get_vector_type(ira->codegen, len_max, scalar_type);
         } else {
             if (instr_is_comptime(a)) {
-                a->value.data.x_array.data.s_none.elements =
-                    reallocate<ConstExprValue>(a->value.data.x_array.data.s_none.elements,
-                    a->value.type->data.vector.len, len_b);
+                ConstExprValue *old_elements = a->value->data.x_array.data.s_none.elements;
+                a->value->data.x_array.data.s_none.elements = create_const_vals(len_max);
+                memcpy(a->value->data.x_array.data.s_none.elements, old_elements,
+                    a->value->type->data.vector.len * sizeof(ConstExprValue));
             } else {
                 a = ir_build_shuffle_vector(&ira->new_irb,
                     instruction->base.scope, instruction->base.source_node,
                     instruction->scalar_type, a, undef, expand_mask);
-                a->value.special = ConstValSpecialRuntime;
+                a->value->special = ConstValSpecialRuntime;
             }
-            a->value.type = get_vector_type(ira->codegen, len_max, scalar_type);
+            a->value->type = get_vector_type(ira->codegen, len_max, scalar_type);
         }
     }
     ConstExprValue *mask_val = ir_resolve_const(ira, mask, UndefOk);
@@ -22572,10 +24931,10 @@ static IrInstruction *ir_analyze_instruction_shuffle_vector(IrAnalyze *ira, IrIn
             buf_sprintf("mask must be comptime"));
         return ira->codegen->invalid_instruction;
     }
-    for (uint32_t i = 0;i < mask->value.type->data.vector.len;i++) {
-        if (mask->value.data.x_array.data.s_none.elements[i].special == ConstValSpecialUndef)
+    for (uint32_t i = 0;i < mask->value->type->data.vector.len;i++) {
+        if (mask->value->data.x_array.data.s_none.elements[i].special == ConstValSpecialUndef)
             continue;
-        int64_t v = bigint_as_signed(&mask->value.data.x_array.data.s_none.elements[i].data.x_bigint);
+        int64_t v = bigint_as_signed(&mask->value->data.x_array.data.s_none.elements[i].data.x_bigint);
         if (v >= 0 && (uint64_t)v + 1 > len_a) {
             ErrorMsg *msg = ir_add_error(ira, mask,
                 buf_sprintf("mask index out of bounds"));
@@ -22599,24 +24958,24 @@ static IrInstruction *ir_analyze_instruction_shuffle_vector(IrAnalyze *ira, IrIn
     if (instr_is_comptime(a) &&
         instr_is_comptime(b)) {
         IrInstruction *result = ir_const(ira, &instruction->base, result_type);
-        result->value.data.x_array.data.s_none.elements = create_const_vals(len_c);
-        for (uint32_t i = 0;i < mask->value.type->data.vector.len;i++) {
-            if (mask->value.data.x_array.data.s_none.elements[i].special == ConstValSpecialUndef)
-                result->value.data.x_array.data.s_none.elements[i].special =
+        result->value->data.x_array.data.s_none.elements = create_const_vals(len_c);
+        for (uint32_t i = 0;i < mask->value->type->data.vector.len;i++) {
+            if (mask->value->data.x_array.data.s_none.elements[i].special == ConstValSpecialUndef)
+                result->value->data.x_array.data.s_none.elements[i].special =
                     ConstValSpecialUndef;
-            int64_t v = bigint_as_signed(&mask->value.data.x_array.data.s_none.elements[i].data.x_bigint);
+            int64_t v = bigint_as_signed(&mask->value->data.x_array.data.s_none.elements[i].data.x_bigint);
             if (v >= 0)
-                result->value.data.x_array.data.s_none.elements[i] =
-                    a->value.data.x_array.data.s_none.elements[v];
+                result->value->data.x_array.data.s_none.elements[i] =
+                    a->value->data.x_array.data.s_none.elements[v];
             else if (v < 0)
-                result->value.data.x_array.data.s_none.elements[i] =
-                    b->value.data.x_array.data.s_none.elements[~v];
+                result->value->data.x_array.data.s_none.elements[i] =
+                    b->value->data.x_array.data.s_none.elements[~v];
             else
                 zig_unreachable();
-            result->value.data.x_array.data.s_none.elements[i].special =
+            result->value->data.x_array.data.s_none.elements[i].special =
                 ConstValSpecialStatic;
         }
-        result->value.special = ConstValSpecialStatic;
+        result->value->special = ConstValSpecialStatic;
         return result;
     }
 
@@ -22624,18 +24983,18 @@ static IrInstruction *ir_analyze_instruction_shuffle_vector(IrAnalyze *ira, IrIn
     IrInstruction *result = ir_build_shuffle_vector(&ira->new_irb,
         instruction->base.scope, instruction->base.source_node,
         instruction->scalar_type, a, b, mask);
-    result->value.type = result_type;
-    result->value.special = ConstValSpecialRuntime;
+    result->value->type = result_type;
+    result->value->special = ConstValSpecialRuntime;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_splat(IrAnalyze *ira, IrInstructionSplat *instruction) {
     IrInstruction *len = instruction->len->child;
-    if (type_is_invalid(len->value.type))
+    if (type_is_invalid(len->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *scalar = instruction->scalar->child;
-    if (type_is_invalid(scalar->value.type))
+    if (type_is_invalid(scalar->value->type))
         return ira->codegen->invalid_instruction;
 
     uint64_t len_int;
@@ -22645,37 +25004,37 @@ static IrInstruction *ir_analyze_instruction_splat(IrAnalyze *ira, IrInstruction
         return ira->codegen->invalid_instruction;
     }
 
-    ZigType *return_type = get_vector_type(ira->codegen, len_int, scalar->value.type);
+    ZigType *return_type = get_vector_type(ira->codegen, len_int, scalar->value->type);
 
     if (instr_is_comptime(scalar)) {
         IrInstruction *result = ir_const_undef(ira, scalar, return_type);
-        result->value.data.x_array.data.s_none.elements =
+        result->value->data.x_array.data.s_none.elements =
             allocate<ConstExprValue>(len_int);
         for (uint32_t i = 0; i < len_int; i++) {
-            result->value.data.x_array.data.s_none.elements[i] =
-                scalar->value;
+            result->value->data.x_array.data.s_none.elements[i] =
+                *scalar->value;
         }
-        result->value.type = return_type;
+        result->value->type = return_type;
         return result;
     }
 
     IrInstruction *result = ir_build_splat(&ira->new_irb,
         instruction->base.scope, instruction->base.source_node,
         instruction->len->child, instruction->scalar->child);
-    result->value.type = return_type;
-    result->value.special = ConstValSpecialRuntime;
+    result->value->type = return_type;
+    result->value->special = ConstValSpecialRuntime;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_bool_not(IrAnalyze *ira, IrInstructionBoolNot *instruction) {
     IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *bool_type = ira->codegen->builtin_types.entry_bool;
 
     IrInstruction *casted_value = ir_implicit_cast(ira, value, bool_type);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return ira->codegen->invalid_instruction;
 
     if (instr_is_comptime(casted_value)) {
@@ -22688,26 +25047,63 @@ static IrInstruction *ir_analyze_instruction_bool_not(IrAnalyze *ira, IrInstruct
 
     IrInstruction *result = ir_build_bool_not(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, casted_value);
-    result->value.type = bool_type;
+    result->value->type = bool_type;
     return result;
 }
 
+// Memset and memcpy keep a u8 array packed when it already is, or when it is
+// undefined and every byte gets written. Returns a copy of the bytes to
+// modify, since the old Buf may be shared, or null if the array must be
+// expanded instead.
+static Buf *ir_packed_dest_bytes(CodeGen *g, ConstExprValue *array_val, size_t start, size_t count) {
+    if (array_val->type->id != ZigTypeIdArray ||
+        array_val->type->data.array.child_type != g->builtin_types.entry_u8)
+    {
+        return nullptr;
+    }
+    size_t len = array_val->type->data.array.len;
+    if (start + count > len) {
+        // Leave the error to the general path.
+        return nullptr;
+    }
+    if (array_val->special == ConstValSpecialStatic &&
+        array_val->data.x_array.special == ConstArraySpecialBuf)
+    {
+        return buf_create_from_buf(array_val->data.x_array.data.s_buf);
+    }
+    bool is_undef = array_val->special == ConstValSpecialUndef ||
+        (array_val->special == ConstValSpecialStatic && array_val->data.x_array.special == ConstArraySpecialUndef);
+    if (is_undef && start == 0 && count == len) {
+        Buf *bytes = buf_alloc();
+        buf_resize(bytes, len);
+        return bytes;
+    }
+    return nullptr;
+}
+
+static void ir_set_packed_bytes(ConstExprValue *array_val, Buf *bytes) {
+    array_val->special = ConstValSpecialStatic;
+    array_val->data.x_array.special = ConstArraySpecialBuf;
+    array_val->data.x_array.data.s_buf = bytes;
+    array_val->data.x_array.buf_owner = array_val;
+}
+
 static IrInstruction *ir_analyze_instruction_memset(IrAnalyze *ira, IrInstructionMemset *instruction) {
     Error err;
 
     IrInstruction *dest_ptr = instruction->dest_ptr->child;
-    if (type_is_invalid(dest_ptr->value.type))
+    if (type_is_invalid(dest_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *byte_value = instruction->byte->child;
-    if (type_is_invalid(byte_value->value.type))
+    if (type_is_invalid(byte_value->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *count_value = instruction->count->child;
-    if (type_is_invalid(count_value->value.type))
+    if (type_is_invalid(count_value->value->type))
         return ira->codegen->invalid_instruction;
 
-    ZigType *dest_uncasted_type = dest_ptr->value.type;
+    ZigType *dest_uncasted_type = dest_ptr->value->type;
     bool dest_is_volatile = (dest_uncasted_type->id == ZigTypeIdPointer) &&
         dest_uncasted_type->data.pointer.is_volatile;
 
@@ -22724,25 +25120,38 @@ static IrInstruction *ir_analyze_instruction_memset(IrAnalyze *ira, IrInstructio
             PtrLenUnknown, dest_align, 0, 0, false);
 
     IrInstruction *casted_dest_ptr = ir_implicit_cast(ira, dest_ptr, u8_ptr);
-    if (type_is_invalid(casted_dest_ptr->value.type))
+    if (type_is_invalid(casted_dest_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_byte = ir_implicit_cast(ira, byte_value, u8);
-    if (type_is_invalid(casted_byte->value.type))
+    if (type_is_invalid(casted_byte->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_count = ir_implicit_cast(ira, count_value, usize);
-    if (type_is_invalid(casted_count->value.type))
+    if (type_is_invalid(casted_count->value->type))
         return ira->codegen->invalid_instruction;
 
     // TODO test this at comptime with u8 and non-u8 types
-    if (casted_dest_ptr->value.special == ConstValSpecialStatic &&
-        casted_byte->value.special == ConstValSpecialStatic &&
-        casted_count->value.special == ConstValSpecialStatic &&
-        casted_dest_ptr->value.data.x_ptr.special != ConstPtrSpecialHardCodedAddr &&
-        casted_dest_ptr->value.data.x_ptr.mut != ConstPtrMutRuntimeVar)
+    if (casted_dest_ptr->value->special == ConstValSpecialStatic &&
+        casted_byte->value->special == ConstValSpecialStatic &&
+        casted_count->value->special == ConstValSpecialStatic &&
+        casted_dest_ptr->value->data.x_ptr.special != ConstPtrSpecialHardCodedAddr &&
+        casted_dest_ptr->value->data.x_ptr.mut != ConstPtrMutRuntimeVar)
     {
-        ConstExprValue *dest_ptr_val = &casted_dest_ptr->value;
+        ConstExprValue *dest_ptr_val = casted_dest_ptr->value;
+
+        if (dest_ptr_val->data.x_ptr.special == ConstPtrSpecialBaseArray) {
+            ConstExprValue *array_val = dest_ptr_val->data.x_ptr.data.base_array.array_val;
+            size_t start = dest_ptr_val->data.x_ptr.data.base_array.elem_index;
+            size_t count = bigint_as_unsigned(&casted_count->value->data.x_bigint);
+            Buf *bytes = ir_packed_dest_bytes(ira->codegen, array_val, start, count);
+            if (bytes != nullptr) {
+                uint8_t byte = (uint8_t)bigint_as_unsigned(&casted_byte->value->data.x_bigint);
+                memset(buf_ptr(bytes) + start, byte, count);
+                ir_set_packed_bytes(array_val, bytes);
+                return ir_const_void(ira, &instruction->base);
+            }
+        }
 
         ConstExprValue *dest_elements;
         size_t start;
@@ -22781,14 +25190,14 @@ static IrInstruction *ir_analyze_instruction_memset(IrAnalyze *ira, IrInstructio
                 zig_panic("TODO memset on null ptr");
         }
 
-        size_t count = bigint_as_unsigned(&casted_count->value.data.x_bigint);
+        size_t count = bigint_as_unsigned(&casted_count->value->data.x_bigint);
         size_t end = start + count;
         if (end > bound_end) {
             ir_add_error(ira, count_value, buf_sprintf("out of bounds pointer access"));
             return ira->codegen->invalid_instruction;
         }
 
-        ConstExprValue *byte_val = &casted_byte->value;
+        ConstExprValue *byte_val = casted_byte->value;
         for (size_t i = start; i < end; i += 1) {
             copy_const_val(&dest_elements[i], byte_val, true);
         }
@@ -22798,7 +25207,7 @@ static IrInstruction *ir_analyze_instruction_memset(IrAnalyze *ira, IrInstructio
 
     IrInstruction *result = ir_build_memset(&ira->new_irb, instruction->base.scope, instruction->base.source_node,
             casted_dest_ptr, casted_byte, casted_count);
-    result->value.type = ira->codegen->builtin_types.entry_void;
+    result->value->type = ira->codegen->builtin_types.entry_void;
     return result;
 }
 
@@ -22806,20 +25215,20 @@ static IrInstruction *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructio
     Error err;
 
     IrInstruction *dest_ptr = instruction->dest_ptr->child;
-    if (type_is_invalid(dest_ptr->value.type))
+    if (type_is_invalid(dest_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *src_ptr = instruction->src_ptr->child;
-    if (type_is_invalid(src_ptr->value.type))
+    if (type_is_invalid(src_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *count_value = instruction->count->child;
-    if (type_is_invalid(count_value->value.type))
+    if (type_is_invalid(count_value->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *u8 = ira->codegen->builtin_types.entry_u8;
-    ZigType *dest_uncasted_type = dest_ptr->value.type;
-    ZigType *src_uncasted_type = src_ptr->value.type;
+    ZigType *dest_uncasted_type = dest_ptr->value->type;
+    ZigType *src_uncasted_type = src_ptr->value->type;
     bool dest_is_volatile = (dest_uncasted_type->id == ZigTypeIdPointer) &&
         dest_uncasted_type->data.pointer.is_volatile;
     bool src_is_volatile = (src_uncasted_type->id == ZigTypeIdPointer) &&
@@ -22848,27 +25257,49 @@ static IrInstruction *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructio
             PtrLenUnknown, src_align, 0, 0, false);
 
     IrInstruction *casted_dest_ptr = ir_implicit_cast(ira, dest_ptr, u8_ptr_mut);
-    if (type_is_invalid(casted_dest_ptr->value.type))
+    if (type_is_invalid(casted_dest_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_src_ptr = ir_implicit_cast(ira, src_ptr, u8_ptr_const);
-    if (type_is_invalid(casted_src_ptr->value.type))
+    if (type_is_invalid(casted_src_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_count = ir_implicit_cast(ira, count_value, usize);
-    if (type_is_invalid(casted_count->value.type))
+    if (type_is_invalid(casted_count->value->type))
         return ira->codegen->invalid_instruction;
 
     // TODO test this at comptime with u8 and non-u8 types
     // TODO test with dest ptr being a global runtime variable
-    if (casted_dest_ptr->value.special == ConstValSpecialStatic &&
-        casted_src_ptr->value.special == ConstValSpecialStatic &&
-        casted_count->value.special == ConstValSpecialStatic &&
-        casted_dest_ptr->value.data.x_ptr.special != ConstPtrSpecialHardCodedAddr)
+    if (casted_dest_ptr->value->special == ConstValSpecialStatic &&
+        casted_src_ptr->value->special == ConstValSpecialStatic &&
+        casted_count->value->special == ConstValSpecialStatic &&
+        casted_dest_ptr->value->data.x_ptr.special != ConstPtrSpecialHardCodedAddr)
     {
-        size_t count = bigint_as_unsigned(&casted_count->value.data.x_bigint);
+        size_t count = bigint_as_unsigned(&casted_count->value->data.x_bigint);
 
-        ConstExprValue *dest_ptr_val = &casted_dest_ptr->value;
+        ConstExprValue *dest_ptr_val = casted_dest_ptr->value;
+        ConstExprValue *src_ptr_val = casted_src_ptr->value;
+
+        if (dest_ptr_val->data.x_ptr.special == ConstPtrSpecialBaseArray &&
+            src_ptr_val->data.x_ptr.special == ConstPtrSpecialBaseArray)
+        {
+            ConstExprValue *src_array_val = src_ptr_val->data.x_ptr.data.base_array.array_val;
+            size_t src_start = src_ptr_val->data.x_ptr.data.base_array.elem_index;
+            if (src_array_val->special == ConstValSpecialStatic &&
+                src_array_val->data.x_array.special == ConstArraySpecialBuf &&
+                src_start + count <= buf_len(src_array_val->data.x_array.data.s_buf))
+            {
+                ConstExprValue *dest_array_val = dest_ptr_val->data.x_ptr.data.base_array.array_val;
+                size_t dest_start = dest_ptr_val->data.x_ptr.data.base_array.elem_index;
+                Buf *bytes = ir_packed_dest_bytes(ira->codegen, dest_array_val, dest_start, count);
+                if (bytes != nullptr) {
+                    memcpy(buf_ptr(bytes) + dest_start,
+                            buf_ptr(src_array_val->data.x_array.data.s_buf) + src_start, count);
+                    ir_set_packed_bytes(dest_array_val, bytes);
+                    return ir_const_void(ira, &instruction->base);
+                }
+            }
+        }
         ConstExprValue *dest_elements;
         size_t dest_start;
         size_t dest_end;
@@ -22911,7 +25342,6 @@ static IrInstruction *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructio
             return ira->codegen->invalid_instruction;
         }
 
-        ConstExprValue *src_ptr_val = &casted_src_ptr->value;
         ConstExprValue *src_elements;
         size_t src_start;
         size_t src_end;
@@ -22966,35 +25396,35 @@ static IrInstruction *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructio
 
     IrInstruction *result = ir_build_memcpy(&ira->new_irb, instruction->base.scope, instruction->base.source_node,
             casted_dest_ptr, casted_src_ptr, casted_count);
-    result->value.type = ira->codegen->builtin_types.entry_void;
+    result->value->type = ira->codegen->builtin_types.entry_void;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstructionSliceSrc *instruction) {
     IrInstruction *ptr_ptr = instruction->ptr->child;
-    if (type_is_invalid(ptr_ptr->value.type))
+    if (type_is_invalid(ptr_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
-    ZigType *ptr_ptr_type = ptr_ptr->value.type;
+    ZigType *ptr_ptr_type = ptr_ptr->value->type;
     assert(ptr_ptr_type->id == ZigTypeIdPointer);
     ZigType *array_type = ptr_ptr_type->data.pointer.child_type;
 
     IrInstruction *start = instruction->start->child;
-    if (type_is_invalid(start->value.type))
+    if (type_is_invalid(start->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *usize = ira->codegen->builtin_types.entry_usize;
     IrInstruction *casted_start = ir_implicit_cast(ira, start, usize);
-    if (type_is_invalid(casted_start->value.type))
+    if (type_is_invalid(casted_start->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *end;
     if (instruction->end) {
         end = instruction->end->child;
-        if (type_is_invalid(end->value.type))
+        if (type_is_invalid(end->value->type))
             return ira->codegen->invalid_instruction;
         end = ir_implicit_cast(ira, end, usize);
-        if (type_is_invalid(end->value.type))
+        if (type_is_invalid(end->value->type))
             return ira->codegen->invalid_instruction;
     } else {
         end = nullptr;
@@ -23003,8 +25433,8 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
     ZigType *return_type;
 
     if (array_type->id == ZigTypeIdArray) {
-        bool is_comptime_const = ptr_ptr->value.special == ConstValSpecialStatic &&
-            ptr_ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst;
+        bool is_comptime_const = ptr_ptr->value->special == ConstValSpecialStatic &&
+            ptr_ptr->value->data.x_ptr.mut == ConstPtrMutComptimeConst;
         ZigType *slice_ptr_type = get_pointer_to_type_extra(ira->codegen, array_type->data.array.child_type,
             ptr_ptr_type->data.pointer.is_const || is_comptime_const,
             ptr_ptr_type->data.pointer.is_volatile,
@@ -23045,8 +25475,8 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
     }
 
     if (instr_is_comptime(ptr_ptr) &&
-        value_is_comptime(&casted_start->value) &&
-        (!end || value_is_comptime(&end->value)))
+        value_is_comptime(casted_start->value) &&
+        (!end || value_is_comptime(end->value)))
     {
         ConstExprValue *array_val;
         ConstExprValue *parent_ptr;
@@ -23059,7 +25489,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
             if (array_type->id == ZigTypeIdPointer) {
                 ZigType *child_array_type = array_type->data.pointer.child_type;
                 assert(child_array_type->id == ZigTypeIdArray);
-                parent_ptr = const_ptr_pointee(ira, ira->codegen, &ptr_ptr->value, instruction->base.source_node);
+                parent_ptr = const_ptr_pointee(ira, ira->codegen, ptr_ptr->value, instruction->base.source_node);
                 if (parent_ptr == nullptr)
                     return ira->codegen->invalid_instruction;
 
@@ -23070,7 +25500,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
                 rel_end = child_array_type->data.array.len;
                 abs_offset = 0;
             } else {
-                array_val = const_ptr_pointee(ira, ira->codegen, &ptr_ptr->value, instruction->base.source_node);
+                array_val = const_ptr_pointee(ira, ira->codegen, ptr_ptr->value, instruction->base.source_node);
                 if (array_val == nullptr)
                     return ira->codegen->invalid_instruction;
                 rel_end = array_type->data.array.len;
@@ -23079,7 +25509,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
             }
         } else if (array_type->id == ZigTypeIdPointer) {
             assert(array_type->data.pointer.ptr_len == PtrLenUnknown);
-            parent_ptr = const_ptr_pointee(ira, ira->codegen, &ptr_ptr->value, instruction->base.source_node);
+            parent_ptr = const_ptr_pointee(ira, ira->codegen, ptr_ptr->value, instruction->base.source_node);
             if (parent_ptr == nullptr)
                 return ira->codegen->invalid_instruction;
 
@@ -23127,7 +25557,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
                     zig_panic("TODO slice of null ptr");
             }
         } else if (is_slice(array_type)) {
-            ConstExprValue *slice_ptr = const_ptr_pointee(ira, ira->codegen, &ptr_ptr->value, instruction->base.source_node);
+            ConstExprValue *slice_ptr = const_ptr_pointee(ira, ira->codegen, ptr_ptr->value, instruction->base.source_node);
             if (slice_ptr == nullptr)
                 return ira->codegen->invalid_instruction;
 
@@ -23175,7 +25605,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
             zig_unreachable();
         }
 
-        uint64_t start_scalar = bigint_as_unsigned(&casted_start->value.data.x_bigint);
+        uint64_t start_scalar = bigint_as_unsigned(&casted_start->value->data.x_bigint);
         if (!ptr_is_undef && start_scalar > rel_end) {
             ir_add_error(ira, &instruction->base, buf_sprintf("out of bounds slice"));
             return ira->codegen->invalid_instruction;
@@ -23183,7 +25613,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
 
         uint64_t end_scalar;
         if (end) {
-            end_scalar = bigint_as_unsigned(&end->value.data.x_bigint);
+            end_scalar = bigint_as_unsigned(&end->value->data.x_bigint);
         } else {
             end_scalar = rel_end;
         }
@@ -23203,7 +25633,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
         }
 
         IrInstruction *result = ir_const(ira, &instruction->base, return_type);
-        ConstExprValue *out_val = &result->value;
+        ConstExprValue *out_val = result->value;
         out_val->data.x_struct.fields = create_const_vals(2);
 
         ConstExprValue *ptr_val = &out_val->data.x_struct.fields[slice_ptr_index];
@@ -23213,7 +25643,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
             bool is_const = slice_is_const(return_type);
             init_const_ptr_array(ira->codegen, ptr_val, array_val, index, is_const, PtrLenUnknown);
             if (array_type->id == ZigTypeIdArray) {
-                ptr_val->data.x_ptr.mut = ptr_ptr->value.data.x_ptr.mut;
+                ptr_val->data.x_ptr.mut = ptr_ptr->value->data.x_ptr.mut;
             } else if (is_slice(array_type)) {
                 ptr_val->data.x_ptr.mut = parent_ptr->data.x_ptr.mut;
             } else if (array_type->id == ZigTypeIdPointer) {
@@ -23261,7 +25691,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
 
     IrInstruction *result_loc = ir_resolve_result(ira, &instruction->base, instruction->result_loc,
             return_type, nullptr, true, false);
-    if (type_is_invalid(result_loc->value.type) || instr_is_unreachable(result_loc)) {
+    if (type_is_invalid(result_loc->value->type) || instr_is_unreachable(result_loc)) {
         return result_loc;
     }
     return ir_build_slice_gen(ira, &instruction->base, return_type,
@@ -23271,7 +25701,7 @@ static IrInstruction *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstruction
 static IrInstruction *ir_analyze_instruction_member_count(IrAnalyze *ira, IrInstructionMemberCount *instruction) {
     Error err;
     IrInstruction *container = instruction->container->child;
-    if (type_is_invalid(container->value.type))
+    if (type_is_invalid(container->value->type))
         return ira->codegen->invalid_instruction;
     ZigType *container_type = ir_resolve_type(ira, container);
 
@@ -23372,7 +25802,7 @@ static IrInstruction *ir_analyze_instruction_member_name(IrAnalyze *ira, IrInstr
         TypeStructField *field = &container_type->data.structure.fields[member_index];
 
         IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
-        init_const_str_lit(ira->codegen, &result->value, field->name);
+        init_const_str_lit(ira->codegen, result->value, field->name);
         return result;
     } else if (container_type->id == ZigTypeIdEnum) {
         if (member_index >= container_type->data.enumeration.src_field_count) {
@@ -23384,7 +25814,7 @@ static IrInstruction *ir_analyze_instruction_member_name(IrAnalyze *ira, IrInstr
         TypeEnumField *field = &container_type->data.enumeration.fields[member_index];
 
         IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
-        init_const_str_lit(ira->codegen, &result->value, field->name);
+        init_const_str_lit(ira->codegen, result->value, field->name);
         return result;
     } else if (container_type->id == ZigTypeIdUnion) {
         if (member_index >= container_type->data.unionation.src_field_count) {
@@ -23396,7 +25826,7 @@ static IrInstruction *ir_analyze_instruction_member_name(IrAnalyze *ira, IrInstr
         TypeUnionField *field = &container_type->data.unionation.fields[member_index];
 
         IrInstruction *result = ir_const(ira, &instruction->base, nullptr);
-        init_const_str_lit(ira->codegen, &result->value, field->name);
+        init_const_str_lit(ira->codegen, result->value, field->name);
         return result;
     } else {
         ir_add_error(ira, container_type_value,
@@ -23436,21 +25866,21 @@ static IrInstruction *ir_analyze_instruction_has_field(IrAnalyze *ira, IrInstruc
 static IrInstruction *ir_analyze_instruction_breakpoint(IrAnalyze *ira, IrInstructionBreakpoint *instruction) {
     IrInstruction *result = ir_build_breakpoint(&ira->new_irb,
         instruction->base.scope, instruction->base.source_node);
-    result->value.type = ira->codegen->builtin_types.entry_void;
+    result->value->type = ira->codegen->builtin_types.entry_void;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_return_address(IrAnalyze *ira, IrInstructionReturnAddress *instruction) {
     IrInstruction *result = ir_build_return_address(&ira->new_irb,
         instruction->base.scope, instruction->base.source_node);
-    result->value.type = ira->codegen->builtin_types.entry_usize;
+    result->value->type = ira->codegen->builtin_types.entry_usize;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_frame_address(IrAnalyze *ira, IrInstructionFrameAddress *instruction) {
     IrInstruction *result = ir_build_frame_address(&ira->new_irb,
             instruction->base.scope, instruction->base.source_node);
-    result->value.type = ira->codegen->builtin_types.entry_usize;
+    result->value->type = ira->codegen->builtin_types.entry_usize;
     return result;
 }
 
@@ -23458,14 +25888,14 @@ static IrInstruction *ir_analyze_instruction_handle(IrAnalyze *ira, IrInstructio
     IrInstruction *result = ir_build_handle(&ira->new_irb, instruction->base.scope, instruction->base.source_node);
     ZigFn *fn_entry = exec_fn_entry(ira->new_irb.exec);
     assert(fn_entry != nullptr);
-    result->value.type = get_promise_type(ira->codegen, fn_entry->type_entry->data.fn.fn_type_id.return_type);
+    result->value->type = get_promise_type(ira->codegen, fn_entry->type_entry->data.fn.fn_type_id.return_type);
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_align_of(IrAnalyze *ira, IrInstructionAlignOf *instruction) {
     Error err;
     IrInstruction *type_value = instruction->type_value->child;
-    if (type_is_invalid(type_value->value.type))
+    if (type_is_invalid(type_value->value->type))
         return ira->codegen->invalid_instruction;
     ZigType *type_entry = ir_resolve_type(ira, type_value);
 
@@ -23515,7 +25945,7 @@ static IrInstruction *ir_analyze_instruction_overflow_op(IrAnalyze *ira, IrInstr
     Error err;
 
     IrInstruction *type_value = instruction->type_value->child;
-    if (type_is_invalid(type_value->value.type))
+    if (type_is_invalid(type_value->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *dest_type = ir_resolve_type(ira, type_value);
@@ -23529,15 +25959,15 @@ static IrInstruction *ir_analyze_instruction_overflow_op(IrAnalyze *ira, IrInstr
     }
 
     IrInstruction *op1 = instruction->op1->child;
-    if (type_is_invalid(op1->value.type))
+    if (type_is_invalid(op1->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, dest_type);
-    if (type_is_invalid(casted_op1->value.type))
+    if (type_is_invalid(casted_op1->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *op2 = instruction->op2->child;
-    if (type_is_invalid(op2->value.type))
+    if (type_is_invalid(op2->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_op2;
@@ -23548,20 +25978,20 @@ static IrInstruction *ir_analyze_instruction_overflow_op(IrAnalyze *ira, IrInstr
     } else {
         casted_op2 = ir_implicit_cast(ira, op2, dest_type);
     }
-    if (type_is_invalid(casted_op2->value.type))
+    if (type_is_invalid(casted_op2->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result_ptr = instruction->result_ptr->child;
-    if (type_is_invalid(result_ptr->value.type))
+    if (type_is_invalid(result_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *expected_ptr_type;
-    if (result_ptr->value.type->id == ZigTypeIdPointer) {
+    if (result_ptr->value->type->id == ZigTypeIdPointer) {
         uint32_t alignment;
-        if ((err = resolve_ptr_align(ira, result_ptr->value.type, &alignment)))
+        if ((err = resolve_ptr_align(ira, result_ptr->value->type, &alignment)))
             return ira->codegen->invalid_instruction;
         expected_ptr_type = get_pointer_to_type_extra(ira->codegen, dest_type,
-                false, result_ptr->value.type->data.pointer.is_volatile,
+                false, result_ptr->value->type->data.pointer.is_volatile,
                 PtrLenSingle,
                 alignment, 0, 0, false);
     } else {
@@ -23569,16 +25999,16 @@ static IrInstruction *ir_analyze_instruction_overflow_op(IrAnalyze *ira, IrInstr
     }
 
     IrInstruction *casted_result_ptr = ir_implicit_cast(ira, result_ptr, expected_ptr_type);
-    if (type_is_invalid(casted_result_ptr->value.type))
+    if (type_is_invalid(casted_result_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (casted_op1->value.special == ConstValSpecialStatic &&
-        casted_op2->value.special == ConstValSpecialStatic &&
-        casted_result_ptr->value.special == ConstValSpecialStatic)
+    if (casted_op1->value->special == ConstValSpecialStatic &&
+        casted_op2->value->special == ConstValSpecialStatic &&
+        casted_result_ptr->value->special == ConstValSpecialStatic)
     {
-        BigInt *op1_bigint = &casted_op1->value.data.x_bigint;
-        BigInt *op2_bigint = &casted_op2->value.data.x_bigint;
-        ConstExprValue *pointee_val = const_ptr_pointee(ira, ira->codegen, &casted_result_ptr->value, casted_result_ptr->source_node);
+        BigInt *op1_bigint = &casted_op1->value->data.x_bigint;
+        BigInt *op2_bigint = &casted_op2->value->data.x_bigint;
+        ConstExprValue *pointee_val = const_ptr_pointee(ira, ira->codegen, casted_result_ptr->value, casted_result_ptr->source_node);
         if (pointee_val == nullptr)
             return ira->codegen->invalid_instruction;
         BigInt *dest_bigint = &pointee_val->data.x_bigint;
@@ -23613,13 +26043,13 @@ static IrInstruction *ir_analyze_instruction_overflow_op(IrAnalyze *ira, IrInstr
     IrInstruction *result = ir_build_overflow_op(&ira->new_irb,
             instruction->base.scope, instruction->base.source_node,
             instruction->op, type_value, casted_op1, casted_op2, casted_result_ptr, dest_type);
-    result->value.type = ira->codegen->builtin_types.entry_bool;
+    result->value->type = ira->codegen->builtin_types.entry_bool;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_result_ptr(IrAnalyze *ira, IrInstructionResultPtr *instruction) {
     IrInstruction *result = instruction->result->child;
-    if (type_is_invalid(result->value.type))
+    if (type_is_invalid(result->value->type))
         return result;
 
     if (instruction->result_loc->written && instruction->result_loc->resolved_loc != nullptr &&
@@ -23659,7 +26089,7 @@ static void ir_eval_mul_add(IrAnalyze *ira, IrInstructionMulAdd *source_instr, Z
 
 static IrInstruction *ir_analyze_instruction_mul_add(IrAnalyze *ira, IrInstructionMulAdd *instruction) {
     IrInstruction *type_value = instruction->type_value->child;
-    if (type_is_invalid(type_value->value.type))
+    if (type_is_invalid(type_value->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *expr_type = ir_resolve_type(ira, type_value);
@@ -23675,27 +26105,27 @@ static IrInstruction *ir_analyze_instruction_mul_add(IrAnalyze *ira, IrInstructi
     }
 
     IrInstruction *op1 = instruction->op1->child;
-    if (type_is_invalid(op1->value.type))
+    if (type_is_invalid(op1->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, expr_type);
-    if (type_is_invalid(casted_op1->value.type))
+    if (type_is_invalid(casted_op1->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *op2 = instruction->op2->child;
-    if (type_is_invalid(op2->value.type))
+    if (type_is_invalid(op2->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, expr_type);
-    if (type_is_invalid(casted_op2->value.type))
+    if (type_is_invalid(casted_op2->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *op3 = instruction->op3->child;
-    if (type_is_invalid(op3->value.type))
+    if (type_is_invalid(op3->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_op3 = ir_implicit_cast(ira, op3, expr_type);
-    if (type_is_invalid(casted_op3->value.type))
+    if (type_is_invalid(casted_op3->value->type))
         return ira->codegen->invalid_instruction;
 
     if (instr_is_comptime(casted_op1) &&
@@ -23712,7 +26142,7 @@ static IrInstruction *ir_analyze_instruction_mul_add(IrAnalyze *ira, IrInstructi
             return ira->codegen->invalid_instruction;
 
         IrInstruction *result = ir_const(ira, &instruction->base, expr_type);
-        ConstExprValue *out_val = &result->value;
+        ConstExprValue *out_val = result->value;
 
         if (expr_type->id == ZigTypeIdVector) {
             expand_undef_array(ira->codegen, op1_const);
@@ -23745,17 +26175,17 @@ static IrInstruction *ir_analyze_instruction_mul_add(IrAnalyze *ira, IrInstructi
     IrInstruction *result = ir_build_mul_add(&ira->new_irb,
             instruction->base.scope, instruction->base.source_node,
             type_value, casted_op1, casted_op2, casted_op3);
-    result->value.type = expr_type;
+    result->value->type = expr_type;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_test_err(IrAnalyze *ira, IrInstructionTestErrSrc *instruction) {
     IrInstruction *base_ptr = instruction->base_ptr->child;
-    if (type_is_invalid(base_ptr->value.type))
+    if (type_is_invalid(base_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *value = ir_get_deref(ira, &instruction->base, base_ptr, nullptr);
-    ZigType *type_entry = value->value.type;
+    ZigType *type_entry = value->value->type;
     if (type_is_invalid(type_entry))
         return ira->codegen->invalid_instruction;
 
@@ -23795,7 +26225,7 @@ static IrInstruction *ir_analyze_instruction_test_err(IrAnalyze *ira, IrInstruct
 static IrInstruction *ir_analyze_unwrap_err_code(IrAnalyze *ira, IrInstruction *source_instr,
         IrInstruction *base_ptr, bool initializing)
 {
-    ZigType *ptr_type = base_ptr->value.type;
+    ZigType *ptr_type = base_ptr->value->type;
 
     // This will be a pointer type because unwrap err payload IR instruction operates on a pointer to a thing.
     assert(ptr_type->id == ZigTypeIdPointer);
@@ -23851,12 +26281,12 @@ static IrInstruction *ir_analyze_unwrap_err_code(IrAnalyze *ira, IrInstruction *
             if (ptr_val->data.x_ptr.mut == ConstPtrMutInfer) {
                 result = ir_build_unwrap_err_code(&ira->new_irb, source_instr->scope,
                         source_instr->source_node, base_ptr);
-                result->value.type = result_type;
-                result->value.special = ConstValSpecialStatic;
+                result->value->type = result_type;
+                result->value->special = ConstValSpecialStatic;
             } else {
                 result = ir_const(ira, source_instr, result_type);
             }
-            ConstExprValue *const_val = &result->value;
+            ConstExprValue *const_val = result->value;
             const_val->data.x_ptr.special = ConstPtrSpecialBaseErrorUnionCode;
             const_val->data.x_ptr.data.base_err_union_code.err_union_val = err_union_val;
             const_val->data.x_ptr.mut = ptr_val->data.x_ptr.mut;
@@ -23866,7 +26296,7 @@ static IrInstruction *ir_analyze_unwrap_err_code(IrAnalyze *ira, IrInstruction *
 
     IrInstruction *result = ir_build_unwrap_err_code(&ira->new_irb,
         source_instr->scope, source_instr->source_node, base_ptr);
-    result->value.type = result_type;
+    result->value->type = result_type;
     return result;
 }
 
@@ -23874,7 +26304,7 @@ static IrInstruction *ir_analyze_instruction_unwrap_err_code(IrAnalyze *ira,
         IrInstructionUnwrapErrCode *instruction)
 {
     IrInstruction *base_ptr = instruction->err_union_ptr->child;
-    if (type_is_invalid(base_ptr->value.type))
+    if (type_is_invalid(base_ptr->value->type))
         return ira->codegen->invalid_instruction;
     return ir_analyze_unwrap_err_code(ira, &instruction->base, base_ptr, false);
 }
@@ -23882,7 +26312,7 @@ static IrInstruction *ir_analyze_instruction_unwrap_err_code(IrAnalyze *ira,
 static IrInstruction *ir_analyze_unwrap_error_payload(IrAnalyze *ira, IrInstruction *source_instr,
         IrInstruction *base_ptr, bool safety_check_on, bool initializing)
 {
-    ZigType *ptr_type = base_ptr->value.type;
+    ZigType *ptr_type = base_ptr->value->type;
 
     // This will be a pointer type because unwrap err payload IR instruction operates on a pointer to a thing.
     assert(ptr_type->id == ZigTypeIdPointer);
@@ -23941,14 +26371,14 @@ static IrInstruction *ir_analyze_unwrap_error_payload(IrAnalyze *ira, IrInstruct
                 if (ptr_val->data.x_ptr.mut == ConstPtrMutInfer) {
                     result = ir_build_unwrap_err_payload(&ira->new_irb, source_instr->scope,
                         source_instr->source_node, base_ptr, safety_check_on, initializing);
-                    result->value.type = result_type;
-                    result->value.special = ConstValSpecialStatic;
+                    result->value->type = result_type;
+                    result->value->special = ConstValSpecialStatic;
                 } else {
                     result = ir_const(ira, source_instr, result_type);
                 }
-                result->value.data.x_ptr.special = ConstPtrSpecialRef;
-                result->value.data.x_ptr.data.ref.pointee = err_union_val->data.x_err_union.payload;
-                result->value.data.x_ptr.mut = ptr_val->data.x_ptr.mut;
+                result->value->data.x_ptr.special = ConstPtrSpecialRef;
+                result->value->data.x_ptr.data.ref.pointee = err_union_val->data.x_err_union.payload;
+                result->value->data.x_ptr.mut = ptr_val->data.x_ptr.mut;
                 return result;
             }
         }
@@ -23956,7 +26386,7 @@ static IrInstruction *ir_analyze_unwrap_error_payload(IrAnalyze *ira, IrInstruct
 
     IrInstruction *result = ir_build_unwrap_err_payload(&ira->new_irb, source_instr->scope,
             source_instr->source_node, base_ptr, safety_check_on, initializing);
-    result->value.type = result_type;
+    result->value->type = result_type;
     return result;
 }
 
@@ -23965,7 +26395,7 @@ static IrInstruction *ir_analyze_instruction_unwrap_err_payload(IrAnalyze *ira,
 {
     assert(instruction->value->child);
     IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_analyze_unwrap_error_payload(ira, &instruction->base, value, instruction->safety_check_on, false);
@@ -24007,7 +26437,7 @@ static IrInstruction *ir_analyze_instruction_fn_proto(IrAnalyze *ira, IrInstruct
             return ir_const_type(ira, &instruction->base, get_generic_fn_type(ira->codegen, &fn_type_id));
         } else {
             IrInstruction *param_type_value = instruction->param_types[fn_type_id.next_param_index]->child;
-            if (type_is_invalid(param_type_value->value.type))
+            if (type_is_invalid(param_type_value->value->type))
                 return ira->codegen->invalid_instruction;
             ZigType *param_type = ir_resolve_type(ira, param_type_value);
             switch (type_requires_comptime(ira->codegen, param_type)) {
@@ -24069,7 +26499,7 @@ static IrInstruction *ir_analyze_instruction_fn_proto(IrAnalyze *ira, IrInstruct
 
 static IrInstruction *ir_analyze_instruction_test_comptime(IrAnalyze *ira, IrInstructionTestComptime *instruction) {
     IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_const_bool(ira, &instruction->base, instr_is_comptime(value));
@@ -24079,7 +26509,7 @@ static IrInstruction *ir_analyze_instruction_check_switch_prongs(IrAnalyze *ira,
         IrInstructionCheckSwitchProngs *instruction)
 {
     IrInstruction *target_value = instruction->target_value->child;
-    ZigType *switch_type = target_value->value.type;
+    ZigType *switch_type = target_value->value->type;
     if (type_is_invalid(switch_type))
         return ira->codegen->invalid_instruction;
 
@@ -24091,25 +26521,25 @@ static IrInstruction *ir_analyze_instruction_check_switch_prongs(IrAnalyze *ira,
             IrInstructionCheckSwitchProngsRange *range = &instruction->ranges[range_i];
 
             IrInstruction *start_value_uncasted = range->start->child;
-            if (type_is_invalid(start_value_uncasted->value.type))
+            if (type_is_invalid(start_value_uncasted->value->type))
                 return ira->codegen->invalid_instruction;
             IrInstruction *start_value = ir_implicit_cast(ira, start_value_uncasted, switch_type);
-            if (type_is_invalid(start_value->value.type))
+            if (type_is_invalid(start_value->value->type))
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *end_value_uncasted = range->end->child;
-            if (type_is_invalid(end_value_uncasted->value.type))
+            if (type_is_invalid(end_value_uncasted->value->type))
                 return ira->codegen->invalid_instruction;
             IrInstruction *end_value = ir_implicit_cast(ira, end_value_uncasted, switch_type);
-            if (type_is_invalid(end_value->value.type))
+            if (type_is_invalid(end_value->value->type))
                 return ira->codegen->invalid_instruction;
 
             BigInt start_index;
-            bigint_init_bigint(&start_index, &start_value->value.data.x_enum_tag);
+            bigint_init_bigint(&start_index, &start_value->value->data.x_enum_tag);
 
-            assert(end_value->value.type->id == ZigTypeIdEnum);
+            assert(end_value->value->type->id == ZigTypeIdEnum);
             BigInt end_index;
-            bigint_init_bigint(&end_index, &end_value->value.data.x_enum_tag);
+            bigint_init_bigint(&end_index, &end_value->value->data.x_enum_tag);
 
             BigInt field_index;
             bigint_init_bigint(&field_index, &start_index);
@@ -24154,24 +26584,24 @@ static IrInstruction *ir_analyze_instruction_check_switch_prongs(IrAnalyze *ira,
             IrInstructionCheckSwitchProngsRange *range = &instruction->ranges[range_i];
 
             IrInstruction *start_value_uncasted = range->start->child;
-            if (type_is_invalid(start_value_uncasted->value.type))
+            if (type_is_invalid(start_value_uncasted->value->type))
                 return ira->codegen->invalid_instruction;
             IrInstruction *start_value = ir_implicit_cast(ira, start_value_uncasted, switch_type);
-            if (type_is_invalid(start_value->value.type))
+            if (type_is_invalid(start_value->value->type))
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *end_value_uncasted = range->end->child;
-            if (type_is_invalid(end_value_uncasted->value.type))
+            if (type_is_invalid(end_value_uncasted->value->type))
                 return ira->codegen->invalid_instruction;
             IrInstruction *end_value = ir_implicit_cast(ira, end_value_uncasted, switch_type);
-            if (type_is_invalid(end_value->value.type))
+            if (type_is_invalid(end_value->value->type))
                 return ira->codegen->invalid_instruction;
 
-            ir_assert(start_value->value.type->id == ZigTypeIdErrorSet, &instruction->base);
-            uint32_t start_index = start_value->value.data.x_err_set->value;
+            ir_assert(start_value->value->type->id == ZigTypeIdErrorSet, &instruction->base);
+            uint32_t start_index = start_value->value->data.x_err_set->value;
 
-            ir_assert(end_value->value.type->id == ZigTypeIdErrorSet, &instruction->base);
-            uint32_t end_index = end_value->value.data.x_err_set->value;
+            ir_assert(end_value->value->type->id == ZigTypeIdErrorSet, &instruction->base);
+            uint32_t end_index = end_value->value->data.x_err_set->value;
 
             if (start_index != end_index) {
                 ir_add_error(ira, end_value, buf_sprintf("ranges not allowed when switching on errors"));
@@ -24212,17 +26642,17 @@ static IrInstruction *ir_analyze_instruction_check_switch_prongs(IrAnalyze *ira,
             IrInstructionCheckSwitchProngsRange *range = &instruction->ranges[range_i];
 
             IrInstruction *start_value = range->start->child;
-            if (type_is_invalid(start_value->value.type))
+            if (type_is_invalid(start_value->value->type))
                 return ira->codegen->invalid_instruction;
             IrInstruction *casted_start_value = ir_implicit_cast(ira, start_value, switch_type);
-            if (type_is_invalid(casted_start_value->value.type))
+            if (type_is_invalid(casted_start_value->value->type))
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *end_value = range->end->child;
-            if (type_is_invalid(end_value->value.type))
+            if (type_is_invalid(end_value->value->type))
                 return ira->codegen->invalid_instruction;
             IrInstruction *casted_end_value = ir_implicit_cast(ira, end_value, switch_type);
-            if (type_is_invalid(casted_end_value->value.type))
+            if (type_is_invalid(casted_end_value->value->type))
                 return ira->codegen->invalid_instruction;
 
             ConstExprValue *start_val = ir_resolve_const(ira, casted_start_value, UndefBad);
@@ -24262,7 +26692,7 @@ static IrInstruction *ir_analyze_instruction_check_switch_prongs(IrAnalyze *ira,
             IrInstruction *value = range->start->child;
 
             IrInstruction *casted_value = ir_implicit_cast(ira, value, switch_type);
-            if (type_is_invalid(casted_value->value.type))
+            if (type_is_invalid(casted_value->value->type))
                 return ira->codegen->invalid_instruction;
 
             ConstExprValue *const_expr_val = ir_resolve_const(ira, casted_value, UndefBad);
@@ -24298,7 +26728,7 @@ static IrInstruction *ir_analyze_instruction_check_statement_is_void(IrAnalyze *
         IrInstructionCheckStatementIsVoid *instruction)
 {
     IrInstruction *statement_value = instruction->statement_value->child;
-    ZigType *statement_type = statement_value->value.type;
+    ZigType *statement_type = statement_value->value->type;
     if (type_is_invalid(statement_type))
         return ira->codegen->invalid_instruction;
 
@@ -24311,7 +26741,7 @@ static IrInstruction *ir_analyze_instruction_check_statement_is_void(IrAnalyze *
 
 static IrInstruction *ir_analyze_instruction_panic(IrAnalyze *ira, IrInstructionPanic *instruction) {
     IrInstruction *msg = instruction->msg->child;
-    if (type_is_invalid(msg->value.type))
+    if (type_is_invalid(msg->value->type))
         return ir_unreach_error(ira);
 
     if (ir_should_inline(ira->new_irb.exec, instruction->base.scope)) {
@@ -24323,7 +26753,7 @@ static IrInstruction *ir_analyze_instruction_panic(IrAnalyze *ira, IrInstruction
             true, false, PtrLenUnknown, 0, 0, 0, false);
     ZigType *str_type = get_slice_type(ira->codegen, u8_ptr_type);
     IrInstruction *casted_msg = ir_implicit_cast(ira, msg, str_type);
-    if (type_is_invalid(casted_msg->value.type))
+    if (type_is_invalid(casted_msg->value->type))
         return ir_unreach_error(ira);
 
     IrInstruction *new_instruction = ir_build_panic(&ira->new_irb, instruction->base.scope,
@@ -24334,7 +26764,7 @@ static IrInstruction *ir_analyze_instruction_panic(IrAnalyze *ira, IrInstruction
 static IrInstruction *ir_align_cast(IrAnalyze *ira, IrInstruction *target, uint32_t align_bytes, bool safety_check_on) {
     Error err;
 
-    ZigType *target_type = target->value.type;
+    ZigType *target_type = target->value->type;
     assert(!type_is_invalid(target_type));
 
     ZigType *result_type;
@@ -24393,8 +26823,8 @@ static IrInstruction *ir_align_cast(IrAnalyze *ira, IrInstruction *target, uint3
         }
 
         IrInstruction *result = ir_const(ira, target, result_type);
-        copy_const_val(&result->value, val, true);
-        result->value.type = result_type;
+        copy_const_val(result->value, val, true);
+        result->value->type = result_type;
         return result;
     }
 
@@ -24404,7 +26834,7 @@ static IrInstruction *ir_align_cast(IrAnalyze *ira, IrInstruction *target, uint3
     } else {
         result = ir_build_cast(&ira->new_irb, target->scope, target->source_node, result_type, target, CastOpNoop);
     }
-    result->value.type = result_type;
+    result->value->type = result_type;
     return result;
 }
 
@@ -24413,7 +26843,7 @@ static IrInstruction *ir_analyze_ptr_cast(IrAnalyze *ira, IrInstruction *source_
 {
     Error err;
 
-    ZigType *src_type = ptr->value.type;
+    ZigType *src_type = ptr->value->type;
     assert(!type_is_invalid(src_type));
 
     // We have a check for zero bits later so we use get_src_ptr_type to
@@ -24463,13 +26893,13 @@ static IrInstruction *ir_analyze_ptr_cast(IrAnalyze *ira, IrInstruction *source_
         }
 
         IrInstruction *result;
-        if (ptr->value.data.x_ptr.mut == ConstPtrMutInfer) {
+        if (ptr->value->data.x_ptr.mut == ConstPtrMutInfer) {
             result = ir_build_ptr_cast_gen(ira, source_instr, dest_type, ptr, safety_check_on);
         } else {
             result = ir_const(ira, source_instr, dest_type);
         }
-        copy_const_val(&result->value, val, true);
-        result->value.type = dest_type;
+        copy_const_val(result->value, val, true);
+        result->value->type = dest_type;
 
         // Keep the bigger alignment, it can only help-
         // unless the target is zero bits.
@@ -24507,7 +26937,7 @@ static IrInstruction *ir_analyze_ptr_cast(IrAnalyze *ira, IrInstruction *source_
     IrInstruction *result;
     if (src_align_bytes > dest_align_bytes && type_has_bits(dest_type)) {
         result = ir_align_cast(ira, casted_ptr, src_align_bytes, false);
-        if (type_is_invalid(result->value.type))
+        if (type_is_invalid(result->value->type))
             return ira->codegen->invalid_instruction;
     } else {
         result = casted_ptr;
@@ -24522,7 +26952,7 @@ static IrInstruction *ir_analyze_instruction_ptr_cast(IrAnalyze *ira, IrInstruct
         return ira->codegen->invalid_instruction;
 
     IrInstruction *ptr = instruction->ptr->child;
-    ZigType *src_type = ptr->value.type;
+    ZigType *src_type = ptr->value->type;
     if (type_is_invalid(src_type))
         return ira->codegen->invalid_instruction;
 
@@ -24531,8 +26961,12 @@ static IrInstruction *ir_analyze_instruction_ptr_cast(IrAnalyze *ira, IrInstruct
 }
 
 static void buf_write_value_bytes_array(CodeGen *codegen, uint8_t *buf, ConstExprValue *val, size_t len) {
+    if (val->data.x_array.special == ConstArraySpecialBuf) {
+        Buf *bytes = val->data.x_array.data.s_buf;
+        memcpy(buf, buf_ptr(bytes), buf_len(bytes));
+        return;
+    }
     size_t buf_i = 0;
-    // TODO optimize the buf case
     expand_undef_array(codegen, val);
     for (size_t elem_i = 0; elem_i < val->type->data.array.len; elem_i += 1) {
         ConstExprValue *elem = &val->data.x_array.data.s_none.elements[elem_i];
@@ -24677,6 +27111,16 @@ static Error buf_read_value_bytes_array(IrAnalyze *ira, CodeGen *codegen, AstNod
     Error err;
     uint64_t elem_size = type_size(codegen, elem_type);
 
+    if (val->type->id == ZigTypeIdArray && elem_type == codegen->builtin_types.entry_u8 &&
+        val->data.x_array.special == ConstArraySpecialNone)
+    {
+        Buf *bytes = buf_alloc();
+        buf_append_mem(bytes, (const char *)buf, len);
+        val->data.x_array.special = ConstArraySpecialBuf;
+        val->data.x_array.data.s_buf = bytes;
+        return ErrorNone;
+    }
+
     switch (val->data.x_array.special) {
         case ConstArraySpecialNone:
             val->data.x_array.data.s_none.elements = create_const_vals(len);
@@ -24856,7 +27300,7 @@ static IrInstruction *ir_analyze_bit_cast(IrAnalyze *ira, IrInstruction *source_
 {
     Error err;
 
-    ZigType *src_type = value->value.type;
+    ZigType *src_type = value->value->type;
     ir_assert(get_codegen_ptr_type(src_type) == nullptr, source_instr);
     ir_assert(type_can_bit_cast(src_type), source_instr);
     ir_assert(get_codegen_ptr_type(dest_type) == nullptr, source_instr);
@@ -24941,7 +27385,7 @@ static IrInstruction *ir_analyze_bit_cast(IrAnalyze *ira, IrInstruction *source_
             buf_write_value_bytes(ira->codegen, buf, val);
         }
         if (dest_type->id == ZigTypeIdVector) {
-            result->value.data.x_array.data.s_none.elements = allocate<ConstExprValue>(dest_type->data.vector.len);
+            result->value->data.x_array.data.s_none.elements = allocate<ConstExprValue>(dest_type->data.vector.len);
             size_t elem_size_bits = type_size_bits(ira->codegen, dest_type->data.vector.elem_type);
             if (buf_easy == nullptr) {
                 buf_easy = allocate<bool>(((src_size_bits + 7) / 8) * 8);
@@ -24973,7 +27417,7 @@ static IrInstruction *ir_analyze_bit_cast(IrAnalyze *ira, IrInstruction *source_
                                       elem_buf_easy[j + 7] << 7;
                 }
 
-                ConstExprValue *sval = &result->value.data.x_array.data.s_none.elements[i];
+                ConstExprValue *sval = &result->value->data.x_array.data.s_none.elements[i];
                 sval->special = ConstValSpecialStatic;
                 sval->type = dest_type->data.vector.elem_type;
                 if ((err = buf_read_value_bytes(ira, ira->codegen, source_instr->source_node, elem_buf, sval)))
@@ -24985,7 +27429,7 @@ static IrInstruction *ir_analyze_bit_cast(IrAnalyze *ira, IrInstruction *source_
             free(elem_buf_easy);
             return result;
         }
-        if ((err = buf_read_value_bytes(ira, ira->codegen, source_instr->source_node, buf, &result->value)))
+        if ((err = buf_read_value_bytes(ira, ira->codegen, source_instr->source_node, buf, result->value)))
             return ira->codegen->invalid_instruction;
         return result;
     }
@@ -25000,7 +27444,7 @@ static IrInstruction *ir_analyze_int_to_ptr(IrAnalyze *ira, IrInstruction *sourc
     ir_assert(type_has_bits(ptr_type), source_instr);
 
     IrInstruction *casted_int = ir_implicit_cast(ira, target, ira->codegen->builtin_types.entry_usize);
-    if (type_is_invalid(casted_int->value.type))
+    if (type_is_invalid(casted_int->value->type))
         return ira->codegen->invalid_instruction;
 
     if (instr_is_comptime(casted_int)) {
@@ -25016,15 +27460,15 @@ static IrInstruction *ir_analyze_int_to_ptr(IrAnalyze *ira, IrInstruction *sourc
         }
 
         IrInstruction *result = ir_const(ira, source_instr, ptr_type);
-        result->value.data.x_ptr.special = ConstPtrSpecialHardCodedAddr;
-        result->value.data.x_ptr.mut = ConstPtrMutRuntimeVar;
-        result->value.data.x_ptr.data.hard_coded_addr.addr = addr;
+        result->value->data.x_ptr.special = ConstPtrSpecialHardCodedAddr;
+        result->value->data.x_ptr.mut = ConstPtrMutRuntimeVar;
+        result->value->data.x_ptr.data.hard_coded_addr.addr = addr;
         return result;
     }
 
     IrInstruction *result = ir_build_int_to_ptr(&ira->new_irb, source_instr->scope,
             source_instr->source_node, nullptr, casted_int);
-    result->value.type = ptr_type;
+    result->value->type = ptr_type;
     return result;
 }
 
@@ -25051,7 +27495,7 @@ static IrInstruction *ir_analyze_instruction_int_to_ptr(IrAnalyze *ira, IrInstru
 
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_analyze_int_to_ptr(ira, &instruction->base, target, dest_type);
@@ -25061,7 +27505,7 @@ static IrInstruction *ir_analyze_instruction_decl_ref(IrAnalyze *ira,
         IrInstructionDeclRef *instruction)
 {
     IrInstruction *ref_instruction = ir_analyze_decl_ref(ira, &instruction->base, instruction->tld);
-    if (type_is_invalid(ref_instruction->value.type))
+    if (type_is_invalid(ref_instruction->value->type))
         return ira->codegen->invalid_instruction;
 
     if (instruction->lval == LValPtr) {
@@ -25073,19 +27517,19 @@ static IrInstruction *ir_analyze_instruction_decl_ref(IrAnalyze *ira,
 
 static IrInstruction *ir_analyze_instruction_ptr_to_int(IrAnalyze *ira, IrInstructionPtrToInt *instruction) {
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *usize = ira->codegen->builtin_types.entry_usize;
 
     // We check size explicitly so we can use get_src_ptr_type here.
-    if (get_src_ptr_type(target->value.type) == nullptr) {
+    if (get_src_ptr_type(target->value->type) == nullptr) {
         ir_add_error(ira, target,
-                buf_sprintf("expected pointer, found '%s'", buf_ptr(&target->value.type->name)));
+                buf_sprintf("expected pointer, found '%s'", buf_ptr(&target->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
-    if (!type_has_bits(target->value.type)) {
+    if (!type_has_bits(target->value->type)) {
         ir_add_error(ira, target,
                 buf_sprintf("pointer to size 0 type has no address"));
         return ira->codegen->invalid_instruction;
@@ -25097,15 +27541,15 @@ static IrInstruction *ir_analyze_instruction_ptr_to_int(IrAnalyze *ira, IrInstru
             return ira->codegen->invalid_instruction;
         if (val->type->id == ZigTypeIdPointer && val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr) {
             IrInstruction *result = ir_const(ira, &instruction->base, usize);
-            bigint_init_unsigned(&result->value.data.x_bigint, val->data.x_ptr.data.hard_coded_addr.addr);
-            result->value.type = usize;
+            bigint_init_unsigned(&result->value->data.x_bigint, val->data.x_ptr.data.hard_coded_addr.addr);
+            result->value->type = usize;
             return result;
         }
     }
 
     IrInstruction *result = ir_build_ptr_to_int(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, target);
-    result->value.type = usize;
+    result->value->type = usize;
     return result;
 }
 
@@ -25166,11 +27610,11 @@ static IrInstruction *ir_analyze_instruction_align_cast(IrAnalyze *ira, IrInstru
         return ira->codegen->invalid_instruction;
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_align_cast(ira, target, align_bytes, true);
-    if (type_is_invalid(result->value.type))
+    if (type_is_invalid(result->value->type))
         return ira->codegen->invalid_instruction;
 
     return result;
@@ -25287,60 +27731,60 @@ static IrInstruction *ir_analyze_instruction_tag_type(IrAnalyze *ira, IrInstruct
 
 static IrInstruction *ir_analyze_instruction_cancel(IrAnalyze *ira, IrInstructionCancel *instruction) {
     IrInstruction *target_inst = instruction->target->child;
-    if (type_is_invalid(target_inst->value.type))
+    if (type_is_invalid(target_inst->value->type))
         return ira->codegen->invalid_instruction;
     IrInstruction *casted_target = ir_implicit_cast(ira, target_inst, ira->codegen->builtin_types.entry_promise);
-    if (type_is_invalid(casted_target->value.type))
+    if (type_is_invalid(casted_target->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_cancel(&ira->new_irb, instruction->base.scope, instruction->base.source_node, casted_target);
-    result->value.type = ira->codegen->builtin_types.entry_void;
-    result->value.special = ConstValSpecialStatic;
+    result->value->type = ira->codegen->builtin_types.entry_void;
+    result->value->special = ConstValSpecialStatic;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_id(IrAnalyze *ira, IrInstructionCoroId *instruction) {
     IrInstruction *promise_ptr = instruction->promise_ptr->child;
-    if (type_is_invalid(promise_ptr->value.type))
+    if (type_is_invalid(promise_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_coro_id(&ira->new_irb, instruction->base.scope, instruction->base.source_node,
             promise_ptr);
-    result->value.type = ira->codegen->builtin_types.entry_usize;
+    result->value->type = ira->codegen->builtin_types.entry_usize;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_alloc(IrAnalyze *ira, IrInstructionCoroAlloc *instruction) {
     IrInstruction *coro_id = instruction->coro_id->child;
-    if (type_is_invalid(coro_id->value.type))
+    if (type_is_invalid(coro_id->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_coro_alloc(&ira->new_irb, instruction->base.scope, instruction->base.source_node,
             coro_id);
-    result->value.type = ira->codegen->builtin_types.entry_bool;
+    result->value->type = ira->codegen->builtin_types.entry_bool;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_size(IrAnalyze *ira, IrInstructionCoroSize *instruction) {
     IrInstruction *result = ir_build_coro_size(&ira->new_irb, instruction->base.scope, instruction->base.source_node);
-    result->value.type = ira->codegen->builtin_types.entry_usize;
+    result->value->type = ira->codegen->builtin_types.entry_usize;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_begin(IrAnalyze *ira, IrInstructionCoroBegin *instruction) {
     IrInstruction *coro_id = instruction->coro_id->child;
-    if (type_is_invalid(coro_id->value.type))
+    if (type_is_invalid(coro_id->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *coro_mem_ptr = instruction->coro_mem_ptr->child;
-    if (type_is_invalid(coro_mem_ptr->value.type))
+    if (type_is_invalid(coro_mem_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigFn *fn_entry = exec_fn_entry(ira->new_irb.exec);
     ir_assert(fn_entry != nullptr, &instruction->base);
     IrInstruction *result = ir_build_coro_begin(&ira->new_irb, instruction->base.scope, instruction->base.source_node,
             coro_id, coro_mem_ptr);
-    result->value.type = get_promise_type(ira->codegen, fn_entry->type_entry->data.fn.fn_type_id.return_type);
+    result->value->type = get_promise_type(ira->codegen, fn_entry->type_entry->data.fn.fn_type_id.return_type);
     return result;
 }
 
@@ -25350,11 +27794,11 @@ static IrInstruction *ir_analyze_instruction_get_implicit_allocator(IrAnalyze *i
 
 static IrInstruction *ir_analyze_instruction_coro_alloc_fail(IrAnalyze *ira, IrInstructionCoroAllocFail *instruction) {
     IrInstruction *err_val = instruction->err_val->child;
-    if (type_is_invalid(err_val->value.type))
+    if (type_is_invalid(err_val->value->type))
         return ir_unreach_error(ira);
 
     IrInstruction *result = ir_build_coro_alloc_fail(&ira->new_irb, instruction->base.scope, instruction->base.source_node, err_val);
-    result->value.type = ira->codegen->builtin_types.entry_unreachable;
+    result->value->type = ira->codegen->builtin_types.entry_unreachable;
     return ir_finish_anal(ira, result);
 }
 
@@ -25362,104 +27806,104 @@ static IrInstruction *ir_analyze_instruction_coro_suspend(IrAnalyze *ira, IrInst
     IrInstruction *save_point = nullptr;
     if (instruction->save_point != nullptr) {
         save_point = instruction->save_point->child;
-        if (type_is_invalid(save_point->value.type))
+        if (type_is_invalid(save_point->value->type))
             return ira->codegen->invalid_instruction;
     }
 
     IrInstruction *is_final = instruction->is_final->child;
-    if (type_is_invalid(is_final->value.type))
+    if (type_is_invalid(is_final->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_coro_suspend(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, save_point, is_final);
-    result->value.type = ira->codegen->builtin_types.entry_u8;
+    result->value->type = ira->codegen->builtin_types.entry_u8;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_end(IrAnalyze *ira, IrInstructionCoroEnd *instruction) {
     IrInstruction *result = ir_build_coro_end(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node);
-    result->value.type = ira->codegen->builtin_types.entry_void;
+    result->value->type = ira->codegen->builtin_types.entry_void;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_free(IrAnalyze *ira, IrInstructionCoroFree *instruction) {
     IrInstruction *coro_id = instruction->coro_id->child;
-    if (type_is_invalid(coro_id->value.type))
+    if (type_is_invalid(coro_id->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *coro_handle = instruction->coro_handle->child;
-    if (type_is_invalid(coro_handle->value.type))
+    if (type_is_invalid(coro_handle->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_coro_free(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, coro_id, coro_handle);
     ZigType *ptr_type = get_pointer_to_type(ira->codegen, ira->codegen->builtin_types.entry_u8, false);
-    result->value.type = get_optional_type(ira->codegen, ptr_type);
+    result->value->type = get_optional_type(ira->codegen, ptr_type);
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_resume(IrAnalyze *ira, IrInstructionCoroResume *instruction) {
     IrInstruction *awaiter_handle = instruction->awaiter_handle->child;
-    if (type_is_invalid(awaiter_handle->value.type))
+    if (type_is_invalid(awaiter_handle->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_target = ir_implicit_cast(ira, awaiter_handle, ira->codegen->builtin_types.entry_promise);
-    if (type_is_invalid(casted_target->value.type))
+    if (type_is_invalid(casted_target->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_coro_resume(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, casted_target);
-    result->value.type = ira->codegen->builtin_types.entry_void;
+    result->value->type = ira->codegen->builtin_types.entry_void;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_save(IrAnalyze *ira, IrInstructionCoroSave *instruction) {
     IrInstruction *coro_handle = instruction->coro_handle->child;
-    if (type_is_invalid(coro_handle->value.type))
+    if (type_is_invalid(coro_handle->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_coro_save(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, coro_handle);
-    result->value.type = ira->codegen->builtin_types.entry_usize;
+    result->value->type = ira->codegen->builtin_types.entry_usize;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_promise(IrAnalyze *ira, IrInstructionCoroPromise *instruction) {
     IrInstruction *coro_handle = instruction->coro_handle->child;
-    if (type_is_invalid(coro_handle->value.type))
+    if (type_is_invalid(coro_handle->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (coro_handle->value.type->id != ZigTypeIdPromise ||
-        coro_handle->value.type->data.promise.result_type == nullptr)
+    if (coro_handle->value->type->id != ZigTypeIdPromise ||
+        coro_handle->value->type->data.promise.result_type == nullptr)
     {
         ir_add_error(ira, &instruction->base, buf_sprintf("expected promise->T, found '%s'",
-                    buf_ptr(&coro_handle->value.type->name)));
+                    buf_ptr(&coro_handle->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
     ZigType *coro_frame_type = get_promise_frame_type(ira->codegen,
-            coro_handle->value.type->data.promise.result_type);
+            coro_handle->value->type->data.promise.result_type);
 
     IrInstruction *result = ir_build_coro_promise(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, coro_handle);
-    result->value.type = get_pointer_to_type(ira->codegen, coro_frame_type, false);
+    result->value->type = get_pointer_to_type(ira->codegen, coro_frame_type, false);
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_coro_alloc_helper(IrAnalyze *ira, IrInstructionCoroAllocHelper *instruction) {
     IrInstruction *realloc_fn = instruction->realloc_fn->child;
-    if (type_is_invalid(realloc_fn->value.type))
+    if (type_is_invalid(realloc_fn->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *coro_size = instruction->coro_size->child;
-    if (type_is_invalid(coro_size->value.type))
+    if (type_is_invalid(coro_size->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_coro_alloc_helper(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, realloc_fn, coro_size);
     ZigType *u8_ptr_type = get_pointer_to_type(ira->codegen, ira->codegen->builtin_types.entry_u8, false);
-    result->value.type = get_optional_type(ira->codegen, u8_ptr_type);
+    result->value->type = get_optional_type(ira->codegen, u8_ptr_type);
     return result;
 }
 
@@ -25501,13 +27945,13 @@ static IrInstruction *ir_analyze_instruction_atomic_rmw(IrAnalyze *ira, IrInstru
         return ira->codegen->invalid_instruction;
 
     IrInstruction *ptr_inst = instruction->ptr->child;
-    if (type_is_invalid(ptr_inst->value.type))
+    if (type_is_invalid(ptr_inst->value->type))
         return ira->codegen->invalid_instruction;
 
     // TODO let this be volatile
     ZigType *ptr_type = get_pointer_to_type(ira->codegen, operand_type, false);
     IrInstruction *casted_ptr = ir_implicit_cast(ira, ptr_inst, ptr_type);
-    if (type_is_invalid(casted_ptr->value.type))
+    if (type_is_invalid(casted_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     AtomicRmwOp op;
@@ -25520,11 +27964,11 @@ static IrInstruction *ir_analyze_instruction_atomic_rmw(IrAnalyze *ira, IrInstru
     }
 
     IrInstruction *operand = instruction->operand->child;
-    if (type_is_invalid(operand->value.type))
+    if (type_is_invalid(operand->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_operand = ir_implicit_cast(ira, operand, operand_type);
-    if (type_is_invalid(casted_operand->value.type))
+    if (type_is_invalid(casted_operand->value->type))
         return ira->codegen->invalid_instruction;
 
     AtomicOrder ordering;
@@ -25540,7 +27984,7 @@ static IrInstruction *ir_analyze_instruction_atomic_rmw(IrAnalyze *ira, IrInstru
         }
     }
 
-    if (instr_is_comptime(casted_operand) && instr_is_comptime(casted_ptr) && casted_ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar)
+    if (instr_is_comptime(casted_operand) && instr_is_comptime(casted_ptr) && casted_ptr->value->data.x_ptr.mut == ConstPtrMutComptimeVar)
     {
         zig_panic("TODO compile-time execution of atomicRmw");
     }
@@ -25548,7 +27992,7 @@ static IrInstruction *ir_analyze_instruction_atomic_rmw(IrAnalyze *ira, IrInstru
     IrInstruction *result = ir_build_atomic_rmw(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, casted_ptr, nullptr, casted_operand, nullptr,
             op, ordering);
-    result->value.type = operand_type;
+    result->value->type = operand_type;
     return result;
 }
 
@@ -25558,12 +28002,12 @@ static IrInstruction *ir_analyze_instruction_atomic_load(IrAnalyze *ira, IrInstr
         return ira->codegen->invalid_instruction;
 
     IrInstruction *ptr_inst = instruction->ptr->child;
-    if (type_is_invalid(ptr_inst->value.type))
+    if (type_is_invalid(ptr_inst->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *ptr_type = get_pointer_to_type(ira->codegen, operand_type, true);
     IrInstruction *casted_ptr = ir_implicit_cast(ira, ptr_inst, ptr_type);
-    if (type_is_invalid(casted_ptr->value.type))
+    if (type_is_invalid(casted_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     AtomicOrder ordering;
@@ -25583,13 +28027,13 @@ static IrInstruction *ir_analyze_instruction_atomic_load(IrAnalyze *ira, IrInstr
 
     if (instr_is_comptime(casted_ptr)) {
         IrInstruction *result = ir_get_deref(ira, &instruction->base, casted_ptr, nullptr);
-        ir_assert(result->value.type != nullptr, &instruction->base);
+        ir_assert(result->value->type != nullptr, &instruction->base);
         return result;
     }
 
     IrInstruction *result = ir_build_atomic_load(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, casted_ptr, nullptr, ordering);
-    result->value.type = operand_type;
+    result->value->type = operand_type;
     return result;
 }
 
@@ -25626,11 +28070,11 @@ static IrInstruction *ir_analyze_instruction_merge_err_ret_traces(IrAnalyze *ira
         IrInstructionMergeErrRetTraces *instruction)
 {
     IrInstruction *coro_promise_ptr = instruction->coro_promise_ptr->child;
-    if (type_is_invalid(coro_promise_ptr->value.type))
+    if (type_is_invalid(coro_promise_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
-    ir_assert(coro_promise_ptr->value.type->id == ZigTypeIdPointer, &instruction->base);
-    ZigType *promise_frame_type = coro_promise_ptr->value.type->data.pointer.child_type;
+    ir_assert(coro_promise_ptr->value->type->id == ZigTypeIdPointer, &instruction->base);
+    ZigType *promise_frame_type = coro_promise_ptr->value->type->data.pointer.child_type;
     ir_assert(promise_frame_type->id == ZigTypeIdStruct, &instruction->base);
     ZigType *promise_result_type = promise_frame_type->data.structure.fields[1].type_entry;
 
@@ -25639,34 +28083,34 @@ static IrInstruction *ir_analyze_instruction_merge_err_ret_traces(IrAnalyze *ira
     }
 
     IrInstruction *src_err_ret_trace_ptr = instruction->src_err_ret_trace_ptr->child;
-    if (type_is_invalid(src_err_ret_trace_ptr->value.type))
+    if (type_is_invalid(src_err_ret_trace_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *dest_err_ret_trace_ptr = instruction->dest_err_ret_trace_ptr->child;
-    if (type_is_invalid(dest_err_ret_trace_ptr->value.type))
+    if (type_is_invalid(dest_err_ret_trace_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_merge_err_ret_traces(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, coro_promise_ptr, src_err_ret_trace_ptr, dest_err_ret_trace_ptr);
-    result->value.type = ira->codegen->builtin_types.entry_void;
+    result->value->type = ira->codegen->builtin_types.entry_void;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_save_err_ret_addr(IrAnalyze *ira, IrInstructionSaveErrRetAddr *instruction) {
     IrInstruction *result = ir_build_save_err_ret_addr(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node);
-    result->value.type = ira->codegen->builtin_types.entry_void;
+    result->value->type = ira->codegen->builtin_types.entry_void;
     return result;
 }
 
 static IrInstruction *ir_analyze_instruction_mark_err_ret_trace_ptr(IrAnalyze *ira, IrInstructionMarkErrRetTracePtr *instruction) {
     IrInstruction *err_ret_trace_ptr = instruction->err_ret_trace_ptr->child;
-    if (type_is_invalid(err_ret_trace_ptr->value.type))
+    if (type_is_invalid(err_ret_trace_ptr->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result = ir_build_mark_err_ret_trace_ptr(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, err_ret_trace_ptr);
-    result->value.type = ira->codegen->builtin_types.entry_void;
+    result->value->type = ira->codegen->builtin_types.entry_void;
     return result;
 }
 
@@ -25852,7 +28296,7 @@ static void ir_eval_float_op(IrAnalyze *ira, IrInstructionFloatOp *source_instr,
 
 static IrInstruction *ir_analyze_instruction_float_op(IrAnalyze *ira, IrInstructionFloatOp *instruction) {
     IrInstruction *type = instruction->type->child;
-    if (type_is_invalid(type->value.type))
+    if (type_is_invalid(type->value->type))
         return ira->codegen->invalid_instruction;
 
     ZigType *expr_type = ir_resolve_type(ira, type);
@@ -25867,11 +28311,11 @@ static IrInstruction *ir_analyze_instruction_float_op(IrAnalyze *ira, IrInstruct
     }
 
     IrInstruction *op1 = instruction->op1->child;
-    if (type_is_invalid(op1->value.type))
+    if (type_is_invalid(op1->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, float_type);
-    if (type_is_invalid(casted_op1->value.type))
+    if (type_is_invalid(casted_op1->value->type))
         return ira->codegen->invalid_instruction;
 
     if (instr_is_comptime(casted_op1)) {
@@ -25889,7 +28333,7 @@ static IrInstruction *ir_analyze_instruction_float_op(IrAnalyze *ira, IrInstruct
             return ira->codegen->invalid_instruction;
 
         IrInstruction *result = ir_const(ira, &instruction->base, expr_type);
-        ConstExprValue *out_val = &result->value;
+        ConstExprValue *out_val = result->value;
 
         if (expr_type->id == ZigTypeIdVector) {
             expand_undef_array(ira->codegen, op1_const);
@@ -25917,7 +28361,7 @@ static IrInstruction *ir_analyze_instruction_float_op(IrAnalyze *ira, IrInstruct
 
     IrInstruction *result = ir_build_float_op(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, casted_op1, instruction->op);
-    result->value.type = expr_type;
+    result->value->type = expr_type;
     return result;
 }
 
@@ -25939,26 +28383,26 @@ static IrInstruction *ir_analyze_instruction_bswap(IrAnalyze *ira, IrInstruction
     }
     ZigType *int_type = type_expr;
 
-    ZigType *expr_type = op->value.type;
+    ZigType *expr_type = op->value->type;
     bool is_vector = expr_type->id == ZigTypeIdVector;
     ZigType *ret_type = int_type;
     if (is_vector)
         ret_type = get_vector_type(ira->codegen, expr_type->data.vector.len, int_type);
 
     op = ir_implicit_cast(ira, instruction->op->child, ret_type);
-    if (type_is_invalid(op->value.type))
+    if (type_is_invalid(op->value->type))
         return ira->codegen->invalid_instruction;
 
     if (int_type->data.integral.bit_count == 0) {
         IrInstruction *result = ir_const(ira, &instruction->base, ret_type);
         if (is_vector) {
-            expand_undef_array(ira->codegen, &result->value);
-            result->value.data.x_array.data.s_none.elements =
+            expand_undef_array(ira->codegen, result->value);
+            result->value->data.x_array.data.s_none.elements =
                 allocate<ConstExprValue>(expr_type->data.vector.len);
             for (unsigned i = 0; i < expr_type->data.vector.len; i++)
-                bigint_init_unsigned(&result->value.data.x_array.data.s_none.elements[i].data.x_bigint, 0);
+                bigint_init_unsigned(&result->value->data.x_array.data.s_none.elements[i].data.x_bigint, 0);
         }
-        bigint_init_unsigned(&result->value.data.x_bigint, 0);
+        bigint_init_unsigned(&result->value->data.x_bigint, 0);
         return result;
     }
 
@@ -25983,22 +28427,22 @@ static IrInstruction *ir_analyze_instruction_bswap(IrAnalyze *ira, IrInstruction
         size_t buf_size = int_type->data.integral.bit_count / 8;
         uint8_t *buf = allocate_nonzero<uint8_t>(buf_size);
         if (is_vector) {
-            expand_undef_array(ira->codegen, &result->value);
-            result->value.data.x_array.data.s_none.elements =
+            expand_undef_array(ira->codegen, result->value);
+            result->value->data.x_array.data.s_none.elements =
                 allocate<ConstExprValue>(expr_type->data.vector.len);
             for (unsigned i = 0; i < expr_type->data.vector.len; i++) {
                 ConstExprValue *cur = &val->data.x_array.data.s_none.elements[i];
-                result->value.data.x_array.data.s_none.elements[i].special = cur->special;
+                result->value->data.x_array.data.s_none.elements[i].special = cur->special;
                 if (cur->special == ConstValSpecialUndef)
                     continue;
                 bigint_write_twos_complement(&cur->data.x_bigint, buf, int_type->data.integral.bit_count, true);
-                bigint_read_twos_complement(&result->value.data.x_array.data.s_none.elements[i].data.x_bigint,
+                bigint_read_twos_complement(&result->value->data.x_array.data.s_none.elements[i].data.x_bigint,
                         buf, int_type->data.integral.bit_count, false,
                         int_type->data.integral.is_signed);
             }
         } else {
             bigint_write_twos_complement(&val->data.x_bigint, buf, int_type->data.integral.bit_count, true);
-            bigint_read_twos_complement(&result->value.data.x_bigint, buf, int_type->data.integral.bit_count, false,
+            bigint_read_twos_complement(&result->value->data.x_bigint, buf, int_type->data.integral.bit_count, false,
                     int_type->data.integral.is_signed);
         }
         return result;
@@ -26006,7 +28450,7 @@ static IrInstruction *ir_analyze_instruction_bswap(IrAnalyze *ira, IrInstruction
 
     IrInstruction *result = ir_build_bswap(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, op);
-    result->value.type = ret_type;
+    result->value->type = ret_type;
     return result;
 }
 
@@ -26016,12 +28460,12 @@ static IrInstruction *ir_analyze_instruction_bit_reverse(IrAnalyze *ira, IrInstr
         return ira->codegen->invalid_instruction;
 
     IrInstruction *op = ir_implicit_cast(ira, instruction->op->child, int_type);
-    if (type_is_invalid(op->value.type))
+    if (type_is_invalid(op->value->type))
         return ira->codegen->invalid_instruction;
 
     if (int_type->data.integral.bit_count == 0) {
         IrInstruction *result = ir_const(ira, &instruction->base, int_type);
-        bigint_init_unsigned(&result->value.data.x_bigint, 0);
+        bigint_init_unsigned(&result->value->data.x_bigint, 0);
         return result;
     }
 
@@ -26050,7 +28494,7 @@ static IrInstruction *ir_analyze_instruction_bit_reverse(IrAnalyze *ira, IrInstr
             }
         }
 
-        bigint_read_twos_complement(&result->value.data.x_bigint,
+        bigint_read_twos_complement(&result->value->data.x_bigint,
                                     result_buf,
                                     int_type->data.integral.bit_count,
                                     ira->codegen->is_big_endian,
@@ -26061,14 +28505,14 @@ static IrInstruction *ir_analyze_instruction_bit_reverse(IrAnalyze *ira, IrInstr
 
     IrInstruction *result = ir_build_bit_reverse(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, op);
-    result->value.type = int_type;
+    result->value->type = int_type;
     return result;
 }
 
 
 static IrInstruction *ir_analyze_instruction_enum_to_int(IrAnalyze *ira, IrInstructionEnumToInt *instruction) {
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_analyze_enum_to_int(ira, &instruction->base, target);
@@ -26093,11 +28537,11 @@ static IrInstruction *ir_analyze_instruction_int_to_enum(IrAnalyze *ira, IrInstr
     ZigType *tag_type = dest_type->data.enumeration.tag_int_type;
 
     IrInstruction *target = instruction->target->child;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *casted_target = ir_implicit_cast(ira, target, tag_type);
-    if (type_is_invalid(casted_target->value.type))
+    if (type_is_invalid(casted_target->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_analyze_int_to_enum(ira, &instruction->base, casted_target, dest_type);
@@ -26164,30 +28608,30 @@ static IrInstruction *ir_analyze_instruction_undeclared_ident(IrAnalyze *ira, Ir
 
 static IrInstruction *ir_analyze_instruction_end_expr(IrAnalyze *ira, IrInstructionEndExpr *instruction) {
     IrInstruction *value = instruction->value->child;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
     bool was_written = instruction->result_loc->written;
     IrInstruction *result_loc = ir_resolve_result(ira, &instruction->base, instruction->result_loc,
-            value->value.type, value, false, false);
+            value->value->type, value, false, false);
     if (result_loc != nullptr) {
-        if (type_is_invalid(result_loc->value.type))
+        if (type_is_invalid(result_loc->value->type))
             return ira->codegen->invalid_instruction;
-        if (result_loc->value.type->id == ZigTypeIdUnreachable)
+        if (result_loc->value->type->id == ZigTypeIdUnreachable)
             return result_loc;
 
         if (!was_written) {
             IrInstruction *store_ptr = ir_analyze_store_ptr(ira, &instruction->base, result_loc, value);
-            if (type_is_invalid(store_ptr->value.type)) {
+            if (type_is_invalid(store_ptr->value->type)) {
                 return ira->codegen->invalid_instruction;
             }
         }
 
-        if (result_loc->value.data.x_ptr.mut == ConstPtrMutInfer) {
+        if (result_loc->value->data.x_ptr.mut == ConstPtrMutInfer) {
             if (instr_is_comptime(value)) {
-                result_loc->value.data.x_ptr.mut = ConstPtrMutComptimeConst;
+                result_loc->value->data.x_ptr.mut = ConstPtrMutComptimeConst;
             } else {
-                result_loc->value.special = ConstValSpecialRuntime;
+                result_loc->value->special = ConstValSpecialRuntime;
             }
         }
     }
@@ -26197,12 +28641,12 @@ static IrInstruction *ir_analyze_instruction_end_expr(IrAnalyze *ira, IrInstruct
 
 static IrInstruction *ir_analyze_instruction_bit_cast_src(IrAnalyze *ira, IrInstructionBitCastSrc *instruction) {
     IrInstruction *operand = instruction->operand->child;
-    if (type_is_invalid(operand->value.type))
+    if (type_is_invalid(operand->value->type))
         return operand;
 
     IrInstruction *result_loc = ir_resolve_result(ira, &instruction->base,
-            &instruction->result_loc_bit_cast->base, operand->value.type, operand, false, false);
-    if (result_loc != nullptr && (type_is_invalid(result_loc->value.type) || instr_is_unreachable(result_loc)))
+            &instruction->result_loc_bit_cast->base, operand->value->type, operand, false, false);
+    if (result_loc != nullptr && (type_is_invalid(result_loc->value->type) || instr_is_unreachable(result_loc)))
         return result_loc;
 
     return instruction->result_loc_bit_cast->parent->gen_instruction;
@@ -26226,11 +28670,11 @@ static IrInstruction *ir_analyze_instruction_union_init_named_field(IrAnalyze *i
         return ira->codegen->invalid_instruction;
 
     IrInstruction *field_result_loc = instruction->field_result_loc->child;
-    if (type_is_invalid(field_result_loc->value.type))
+    if (type_is_invalid(field_result_loc->value->type))
         return ira->codegen->invalid_instruction;
 
     IrInstruction *result_loc = instruction->result_loc->child;
-    if (type_is_invalid(result_loc->value.type))
+    if (type_is_invalid(result_loc->value->type))
         return ira->codegen->invalid_instruction;
 
     return ir_analyze_union_init(ira, &instruction->base, instruction->base.source_node,
@@ -26613,15 +29057,15 @@ ZigType *ir_analyze(CodeGen *codegen, IrExecutable *old_exec, IrExecutable *new_
         }
         IrInstruction *new_instruction = ir_analyze_instruction_base(ira, old_instruction);
         if (new_instruction != nullptr) {
-            ir_assert(new_instruction->value.type != nullptr || new_instruction->value.type != nullptr, old_instruction);
+            ir_assert(new_instruction->value->type != nullptr || new_instruction->value->type != nullptr, old_instruction);
             old_instruction->child = new_instruction;
 
-            if (type_is_invalid(new_instruction->value.type)) {
+            if (type_is_invalid(new_instruction->value->type)) {
                 return ira->codegen->builtin_types.entry_invalid;
             }
 
             // unreachable instructions do their own control flow.
-            if (new_instruction->value.type->id == ZigTypeIdUnreachable)
+            if (new_instruction->value->type->id == ZigTypeIdUnreachable)
                 continue;
         }
 
@@ -23,6 +23,9 @@ ZigType *ir_analyze(CodeGen *g, IrExecutable *old_executable, IrExecutable *new_
 
 bool ir_has_side_effects(IrInstruction *instruction);
 
+// Trims the comptime call cache once semantic analysis is done.
+void ir_comptime_cache_collect(CodeGen *g);
+
 struct IrAnalyze;
 ConstExprValue *const_ptr_pointee(IrAnalyze *ira, CodeGen *codegen, ConstExprValue *const_val,
         AstNode *source_node);
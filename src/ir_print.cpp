@@ -27,7 +27,7 @@ static void ir_print_indent(IrPrint *irp) {
 
 static void ir_print_prefix(IrPrint *irp, IrInstruction *instruction) {
     ir_print_indent(irp);
-    const char *type_name = instruction->value.type ? buf_ptr(&instruction->value.type->name) : "(unknown)";
+    const char *type_name = instruction->value->type ? buf_ptr(&instruction->value->type->name) : "(unknown)";
     const char *ref_count = ir_has_side_effects(instruction) ?
         "-" : buf_ptr(buf_sprintf("%" ZIG_PRI_usize "", instruction->ref_count));
     fprintf(irp->f, "#%-3zu| %-12s| %-2s| ", instruction->debug_id, type_name, ref_count);
@@ -49,8 +49,8 @@ static void ir_print_other_instruction(IrPrint *irp, IrInstruction *instruction)
         fprintf(irp->f, "(null)");
         return;
     }
-    if (instruction->value.special != ConstValSpecialRuntime) {
-        ir_print_const_value(irp, &instruction->value);
+    if (instruction->value->special != ConstValSpecialRuntime) {
+        ir_print_const_value(irp, instruction->value);
     } else {
         ir_print_var_instruction(irp, instruction);
     }
@@ -72,7 +72,7 @@ static void ir_print_return(IrPrint *irp, IrInstructionReturn *return_instructio
 }
 
 static void ir_print_const(IrPrint *irp, IrInstructionConst *const_instruction) {
-    ir_print_const_value(irp, &const_instruction->base.value);
+    ir_print_const_value(irp, const_instruction->base.value);
 }
 
 static const char *ir_bin_op_id_str(IrBinOp op_id) {
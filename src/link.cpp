@@ -1610,11 +1610,46 @@ static void add_glibc_libs(LinkJob *lj) {
     }
 }
 
+static int lto_opt_level(CodeGen *g) {
+    switch (g->build_mode) {
+        case BuildModeDebug:
+            return 0;
+        case BuildModeSmallRelease:
+            return 2;
+        case BuildModeFastRelease:
+        case BuildModeSafeRelease:
+            return 3;
+    }
+    zig_unreachable();
+}
+
+// The ThinLTO backends share the -j limit with C compilation.
+static size_t thin_lto_job_count(CodeGen *g) {
+    return (g->job_count == 0) ? os_cpu_count() : g->job_count;
+}
+
+// LLD keys cache entries on the module hashes, so one directory serves every build.
+static Buf *thin_lto_cache_dir(CodeGen *g) {
+    return buf_sprintf("%s" OS_SEP "thinlto", buf_ptr(g->cache_dir));
+}
+
+// ELF and wasm LLD spell the LTO options the same way.
+static void add_thin_lto_args(LinkJob *lj) {
+    CodeGen *g = lj->codegen;
+    lj->args.append(buf_ptr(buf_sprintf("--lto-O%d", lto_opt_level(g))));
+    lj->args.append(buf_ptr(buf_sprintf("--thinlto-jobs=%" ZIG_PRI_usize, thin_lto_job_count(g))));
+    lj->args.append(buf_ptr(buf_sprintf("--thinlto-cache-dir=%s", buf_ptr(thin_lto_cache_dir(g)))));
+}
+
 static void construct_linker_job_elf(LinkJob *lj) {
     CodeGen *g = lj->codegen;
 
     lj->args.append("-error-limit=0");
 
+    if (g->thin_lto) {
+        add_thin_lto_args(lj);
+    }
+
     if (g->linker_script) {
         lj->args.append("-T");
         lj->args.append(g->linker_script);
@@ -1812,6 +1847,10 @@ static void construct_linker_job_wasm(LinkJob *lj) {
 
     lj->args.append("-error-limit=0");
 
+    if (g->thin_lto) {
+        add_thin_lto_args(lj);
+    }
+
     if (g->out_type != OutTypeExe) {
         lj->args.append("--no-entry"); // So lld doesn't look for _start.
 
@@ -1943,6 +1982,7 @@ static const char *get_def_lib(CodeGen *parent, const char *name, Buf *def_in_re
 
     CacheHash *cache_hash = allocate<CacheHash>(1);
     cache_init(cache_hash, manifest_dir);
+    cache_hash->job_count = parent->job_count;
 
     cache_buf(cache_hash, compiler_id);
     cache_file(cache_hash, def_in_file);
@@ -2143,6 +2183,12 @@ static void construct_linker_job_coff(LinkJob *lj) {
 
     lj->args.append("-NOLOGO");
 
+    if (g->thin_lto) {
+        lj->args.append(buf_ptr(buf_sprintf("-OPT:lldlto=%d", lto_opt_level(g))));
+        lj->args.append(buf_ptr(buf_sprintf("-OPT:lldltojobs=%" ZIG_PRI_usize, thin_lto_job_count(g))));
+        lj->args.append(buf_ptr(buf_sprintf("-LLDLTOCACHE:%s", buf_ptr(thin_lto_cache_dir(g)))));
+    }
+
     if (!g->strip_debug_symbols) {
         lj->args.append("-DEBUG");
     }
@@ -2538,8 +2584,90 @@ void zig_link_add_compiler_rt(CodeGen *g) {
     g->link_objects.append(compiler_rt_o_path);
 }
 
+static void build_link_deps_child(void *context) {
+    CodeGen *g = reinterpret_cast<CodeGen *>(context);
+
+    // Only the dependencies that constructing the link job builds are wanted,
+    // and the output path is not known yet.
+    if (buf_len(&g->output_file_path) == 0) {
+        buf_init_from_str(&g->output_file_path, "link-deps");
+    }
+    g->job_count = g->link_deps_job_count;
+
+    LinkJob lj = {0};
+    lj.args.append("lld");
+    lj.rpath_table.init(4);
+    lj.codegen = g;
+    lj.link_in_crt = (g->libc_link_lib != nullptr && g->out_type == OutTypeExe);
+    construct_linker_job(&lj);
+}
+
+static void wait_link_deps(CodeGen *g) {
+    if (g->link_deps_process == nullptr)
+        return;
+    // Whether it succeeded does not matter; whatever it did not build is built now.
+    Termination term;
+    os_process_wait(g->link_deps_process, &term);
+    g->link_deps_process = nullptr;
+    g->job_count += g->link_deps_job_count;
+    g->link_deps_job_count = 0;
+}
+
+// The CodeGen whose link dependencies are being built, if any, so that
+// kill_link_deps can stop the copy when this process exits early, such as
+// on a compile error.
+static CodeGen *link_deps_owner = nullptr;
+
+static void kill_link_deps(void) {
+    if (link_deps_owner == nullptr || link_deps_owner->link_deps_process == nullptr)
+        return;
+    os_process_kill(link_deps_owner->link_deps_process);
+    wait_link_deps(link_deps_owner);
+}
+
+void codegen_start_link_deps(CodeGen *g) {
+    Error err;
+
+    // Only executables and dynamic libraries have link dependencies. Which
+    // ones is decided from what is known before analysis; if analysis changes
+    // that, for example by linking libc, codegen_link builds the rest itself.
+    if (g->emit_file_type != EmitFileTypeBinary)
+        return;
+    if (g->out_type != OutTypeExe && !(g->out_type == OutTypeLib && g->is_dynamic))
+        return;
+    if (g->is_dummy_so)
+        return;
+    if (link_deps_owner != nullptr && link_deps_owner->link_deps_process != nullptr)
+        return;
+
+    // The copy and this process split the -j budget until codegen_link
+    // waits for the copy. With a single job there is nothing to split.
+    size_t job_count = (g->job_count == 0) ? os_cpu_count() : g->job_count;
+    if (job_count < 2)
+        return;
+    g->link_deps_job_count = job_count / 2;
+
+    // The copy's output would repeat what codegen_link prints when it builds
+    // something again, such as the errors of a dependency that fails.
+    if ((err = os_fork(build_link_deps_child, g, true, &g->link_deps_process))) {
+        // Not fatal; codegen_link builds everything itself.
+        g->link_deps_process = nullptr;
+        g->link_deps_job_count = 0;
+        return;
+    }
+    g->job_count = job_count - g->link_deps_job_count;
+
+    static bool registered_kill_link_deps = false;
+    if (!registered_kill_link_deps) {
+        atexit(kill_link_deps);
+        registered_kill_link_deps = true;
+    }
+    link_deps_owner = g;
+}
+
 void codegen_link(CodeGen *g) {
     codegen_add_time_event(g, "Build Dependencies");
+    wait_link_deps(g);
 
     LinkJob lj = {0};
 
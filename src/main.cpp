@@ -12,6 +12,7 @@
 #include "config.h"
 #include "error.hpp"
 #include "os.hpp"
+#include "server.hpp"
 #include "target.hpp"
 #include "libc_installation.hpp"
 #include "userland.h"
@@ -41,6 +42,7 @@ static int print_full_usage(const char *arg0, FILE *file, int return_code) {
         "  init-lib                     initialize a `zig build` library in the cwd\n"
         "  libc [paths_file]            Display native libc paths file or validate one\n"
         "  run [source] [-- [args]]     create executable and run immediately\n"
+        "  server [socket] [dirs]       serve builds from a socket, keeping parsed std resident\n"
         "  translate-c [source]         convert c code to zig code\n"
         "  translate-c-2 [source]       experimental self-hosted translate-c\n"
         "  targets                      list available compilation targets\n"
@@ -53,6 +55,8 @@ static int print_full_usage(const char *arg0, FILE *file, int return_code) {
         "  --cache-dir [path]           override the local cache directory\n"
         "  --cache [auto|off|on]        build in cache, print output path to stdout\n"
         "  --color [auto|off|on]        enable or disable colored error messages\n"
+        "  --enable-c-pch               share precompiled headers between C files\n"
+        "  --lazy-cimport               translate @cImport declarations when first used\n"
         "  --disable-gen-h              do not generate a C header file (.h)\n"
         "  --disable-valgrind           omit valgrind client requests in debug builds\n"
         "  --enable-valgrind            include valgrind client requests release builds\n"
@@ -62,6 +66,8 @@ static int print_full_usage(const char *arg0, FILE *file, int return_code) {
         "  -fPIC                        enable Position Independent Code\n"
         "  -fno-PIC                     disable Position Independent Code\n"
         "  -ftime-report                print timing diagnostics\n"
+        "  --time-trace [path]          write a Chrome trace of the compilation to path\n"
+        "  -j [count]                   max concurrent jobs (default: CPU count)\n"
         "  --libc [file]                Provide a file which specifies libc paths\n"
         "  --name [name]                override output name\n"
         "  --output-dir [dir]           override output directory (defaults to cwd)\n"
@@ -89,6 +95,10 @@ static int print_full_usage(const char *arg0, FILE *file, int return_code) {
         "  --override-std-dir [arg]     override path to Zig standard library\n"
         "  --override-lib-dir [arg]     override path to Zig lib library\n"
         "  -ffunction-sections          places each function in a seperate section\n"
+        "  -flto=thin                   optimize zig and C objects together at link time\n"
+        "  -fprofile-generate[=dir]     instrument to write a profile to dir\n"
+        "  -fprofile-use=file           optimize using a profile merged by llvm-profdata\n"
+        "  --codegen-units [count]      split the zig object into count objects built in parallel\n"
         "\n"
         "Link Options:\n"
         "  --bundle-compiler-rt         for static libraries, include compiler-rt symbols\n"
@@ -298,7 +308,22 @@ static int zig_error_no_build_file(void) {
 
 extern "C" int ZigClang_main(int argc, char **argv);
 
+static bool is_server_command(const char *cmd) {
+    return strcmp(cmd, "build-exe") == 0 || strcmp(cmd, "build-obj") == 0 ||
+        strcmp(cmd, "build-lib") == 0 || strcmp(cmd, "test") == 0;
+}
+
+static int main0(int argc, char **argv, bool use_server);
+
+static int run_server_command(int argc, char **argv) {
+    return main0(argc, argv, false);
+}
+
 int main(int argc, char **argv) {
+    return main0(argc, argv, true);
+}
+
+static int main0(int argc, char **argv, bool use_server) {
     stage2_attach_segfault_handler();
 
     char *arg0 = argv[0];
@@ -334,6 +359,33 @@ int main(int argc, char **argv) {
         return EXIT_SUCCESS;
     }
 
+    if (argc >= 3 && strcmp(argv[1], "server") == 0) {
+        ZigList<Buf *> source_dirs = {};
+        source_dirs.append(get_zig_std_dir(get_zig_lib_dir()));
+        for (int i = 3; i < argc; i += 1) {
+            source_dirs.append(buf_create_from_str(argv[i]));
+        }
+        for (size_t i = 0; i < source_dirs.length; i += 1) {
+            Buf resolved_dir = os_path_resolve(&source_dirs.at(i), 1);
+            source_dirs.at(i) = buf_create_from_buf(&resolved_dir);
+        }
+        return server_main(buf_create_from_str(argv[2]), source_dirs, run_server_command);
+    }
+
+    const char *server_socket = getenv("ZIG_SERVER");
+    if (use_server && server_socket != nullptr && argc >= 2 && is_server_command(argv[1])) {
+        int exit_code;
+        if ((err = server_client_run(buf_create_from_str(server_socket), argc, argv, &exit_code))) {
+            if (err != ErrorFileNotFound) {
+                fprintf(stderr, "Unable to use zig server at %s: %s\n", server_socket, err_str(err));
+                return EXIT_FAILURE;
+            }
+            // No server is running; build in this process.
+        } else {
+            return exit_code;
+        }
+    }
+
     enum InitKind {
         InitKindNone,
         InitKindExe,
@@ -473,6 +525,7 @@ int main(int argc, char **argv) {
     size_t ver_minor = 0;
     size_t ver_patch = 0;
     bool timing_info = false;
+    const char *time_trace_path = nullptr;
     const char *cache_dir = nullptr;
     CliPkg *cur_pkg = allocate<CliPkg>(1);
     BuildMode build_mode = BuildModeDebug;
@@ -482,6 +535,8 @@ int main(int argc, char **argv) {
     TargetSubsystem subsystem = TargetSubsystemAuto;
     bool want_single_threaded = false;
     bool disable_gen_h = false;
+    bool enable_c_pch = false;
+    bool lazy_cimport = false;
     bool bundle_compiler_rt = false;
     Buf *override_std_dir = nullptr;
     Buf *override_lib_dir = nullptr;
@@ -490,6 +545,12 @@ int main(int argc, char **argv) {
     WantPIC want_pic = WantPICAuto;
     WantStackCheck want_stack_check = WantStackCheckAuto;
     bool function_sections = false;
+    size_t job_count = 0;
+    size_t codegen_units = 1;
+    bool thin_lto = false;
+    bool profile_generate = false;
+    const char *profile_generate_dir = nullptr;
+    const char *profile_use_path = nullptr;
 
     ZigList<const char *> llvm_argv = {0};
     llvm_argv.append("zig (LLVM option parsing)");
@@ -679,6 +740,10 @@ int main(int argc, char **argv) {
                 want_single_threaded = true;
             } else if (strcmp(arg, "--disable-gen-h") == 0) {
                 disable_gen_h = true;
+            } else if (strcmp(arg, "--enable-c-pch") == 0) {
+                enable_c_pch = true;
+            } else if (strcmp(arg, "--lazy-cimport") == 0) {
+                lazy_cimport = true;
             } else if (strcmp(arg, "--bundle-compiler-rt") == 0) {
                 bundle_compiler_rt = true;
             } else if (strcmp(arg, "--test-cmd-bin") == 0) {
@@ -686,6 +751,13 @@ int main(int argc, char **argv) {
             } else if (arg[1] == 'L' && arg[2] != 0) {
                 // alias for --library-path
                 lib_dirs.append(&arg[2]);
+            } else if (arg[1] == 'j' && arg[2] != 0) {
+                // alias for -j [count]
+                if (atoi(&arg[2]) <= 0) {
+                    fprintf(stderr, "invalid job count: %s\n", &arg[2]);
+                    return print_error_usage(arg0);
+                }
+                job_count = atoi(&arg[2]);
             } else if (strcmp(arg, "--pkg-begin") == 0) {
                 if (i + 2 >= argc) {
                     fprintf(stderr, "Expected 2 arguments after --pkg-begin\n");
@@ -707,6 +779,15 @@ int main(int argc, char **argv) {
                 cur_pkg = cur_pkg->parent;
             } else if (strcmp(arg, "-ffunction-sections") == 0) {
                 function_sections = true;
+            } else if (strcmp(arg, "-flto=thin") == 0) {
+                thin_lto = true;
+            } else if (strcmp(arg, "-fprofile-generate") == 0) {
+                profile_generate = true;
+            } else if (strncmp(arg, "-fprofile-generate=", strlen("-fprofile-generate=")) == 0) {
+                profile_generate = true;
+                profile_generate_dir = arg + strlen("-fprofile-generate=");
+            } else if (strncmp(arg, "-fprofile-use=", strlen("-fprofile-use=")) == 0) {
+                profile_use_path = arg + strlen("-fprofile-use=");
             } else if (i + 1 >= argc) {
                 fprintf(stderr, "Expected another argument after %s\n", arg);
                 return print_error_usage(arg0);
@@ -819,6 +900,20 @@ int main(int argc, char **argv) {
                     test_filter = argv[i];
                 } else if (strcmp(arg, "--test-name-prefix") == 0) {
                     test_name_prefix = argv[i];
+                } else if (strcmp(arg, "-j") == 0) {
+                    if (atoi(argv[i]) <= 0) {
+                        fprintf(stderr, "invalid job count: %s\n", argv[i]);
+                        return print_error_usage(arg0);
+                    }
+                    job_count = atoi(argv[i]);
+                } else if (strcmp(arg, "--time-trace") == 0) {
+                    time_trace_path = argv[i];
+                } else if (strcmp(arg, "--codegen-units") == 0) {
+                    if (atoi(argv[i]) <= 0) {
+                        fprintf(stderr, "invalid codegen unit count: %s\n", argv[i]);
+                        return print_error_usage(arg0);
+                    }
+                    codegen_units = atoi(argv[i]);
                 } else if (strcmp(arg, "--ver-major") == 0) {
                     ver_major = atoi(argv[i]);
                 } else if (strcmp(arg, "--ver-minor") == 0) {
@@ -990,6 +1085,34 @@ int main(int argc, char **argv) {
         return print_error_usage(arg0);
     }
 
+    // The bitcode that -flto=thin produces is only optimized by the linker,
+    // so an object or static library would hold bitcode under a native name.
+    if (thin_lto && (out_type == OutTypeObj || (out_type == OutTypeLib && !is_dynamic))) {
+        fprintf(stderr, "-flto=thin requires an executable or a dynamic library\n");
+        return print_error_usage(arg0);
+    }
+
+    if (profile_generate || profile_use_path != nullptr) {
+        if (profile_generate && profile_use_path != nullptr) {
+            fprintf(stderr, "-fprofile-generate is incompatible with -fprofile-use\n");
+            return print_error_usage(arg0);
+        }
+        if (build_mode == BuildModeDebug) {
+            fprintf(stderr, "-fprofile-generate and -fprofile-use require a release build mode\n");
+            return print_error_usage(arg0);
+        }
+        // Only on Linux does the instrumentation find the profile sections
+        // without referencing __llvm_profile_runtime, which is not defined by
+        // std/special/profile_rt.zig.
+        if (profile_generate && target.os != OsLinux) {
+            fprintf(stderr, "-fprofile-generate is only supported for Linux targets\n");
+            return print_error_usage(arg0);
+        }
+        // std/special/profile_rt.zig does not implement value profiling, and
+        // the profile then has no value sites for the profile use to expect.
+        llvm_argv.append("-disable-vp");
+    }
+
     if (llvm_argv.length > 1) {
         llvm_argv.append(nullptr);
         ZigLLVMParseCommandLineOptions(llvm_argv.length - 1, llvm_argv.items);
@@ -1123,6 +1246,10 @@ int main(int argc, char **argv) {
             g->subsystem = subsystem;
 
             g->enable_time_report = timing_info;
+            g->enable_trace = timing_info || time_trace_path != nullptr;
+            if (time_trace_path != nullptr) {
+                g->time_trace_path = buf_create_from_str(time_trace_path);
+            }
             codegen_set_out_name(g, buf_out_name);
             codegen_set_lib_version(g, ver_major, ver_minor, ver_patch);
             g->want_single_threaded = want_single_threaded;
@@ -1145,10 +1272,20 @@ int main(int argc, char **argv) {
             g->verbose_cc = verbose_cc;
             g->output_dir = output_dir;
             g->disable_gen_h = disable_gen_h;
+            g->enable_c_pch = enable_c_pch;
+            g->lazy_cimport = lazy_cimport;
             g->bundle_compiler_rt = bundle_compiler_rt;
             codegen_set_errmsg_color(g, color);
             g->system_linker_hack = system_linker_hack;
             g->function_sections = function_sections;
+            g->job_count = job_count;
+            g->codegen_units = codegen_units;
+            g->thin_lto = thin_lto;
+            g->profile_generate = profile_generate;
+            if (profile_generate_dir != nullptr)
+                g->profile_generate_dir = buf_create_from_str(profile_generate_dir);
+            if (profile_use_path != nullptr)
+                g->profile_use_path = buf_create_from_str(profile_use_path);
 
             for (size_t i = 0; i < lib_dirs.length; i += 1) {
                 codegen_add_lib_dir(g, lib_dirs.at(i));
@@ -45,9 +45,16 @@ typedef SSIZE_T ssize_t;
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <spawn.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <signal.h>
 
 #endif
 
@@ -57,6 +64,7 @@ typedef SSIZE_T ssize_t;
 
 #if defined(ZIG_OS_LINUX)
 #include <sys/auxv.h>
+#include <sys/prctl.h>
 #endif
 
 #if defined(ZIG_OS_FREEBSD) || defined(ZIG_OS_NETBSD)
@@ -782,6 +790,39 @@ Error os_file_exists(Buf *full_path, bool *result) {
 #endif
 }
 
+Error os_file_touch(Buf *full_path) {
+#if defined(ZIG_OS_WINDOWS)
+    HANDLE handle = CreateFileA(buf_ptr(full_path), FILE_WRITE_ATTRIBUTES,
+            FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        DWORD err = GetLastError();
+        if (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND)
+            return ErrorFileNotFound;
+        return ErrorFileSystem;
+    }
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    BOOL ok = SetFileTime(handle, nullptr, nullptr, &now);
+    CloseHandle(handle);
+    return ok ? ErrorNone : ErrorFileSystem;
+#else
+    if (utimes(buf_ptr(full_path), nullptr) == -1) {
+        switch (errno) {
+            case ENOENT:
+            case ENOTDIR:
+                return ErrorFileNotFound;
+            case EACCES:
+            case EPERM:
+                return ErrorAccess;
+            default:
+                return ErrorFileSystem;
+        }
+    }
+    return ErrorNone;
+#endif
+}
+
 #if defined(ZIG_OS_POSIX)
 static Error os_exec_process_posix(ZigList<const char *> &args,
         Termination *term, Buf *out_stderr, Buf *out_stdout)
@@ -1778,6 +1819,72 @@ static int self_exe_shared_libs_callback(struct dl_phdr_info *info, size_t size,
 }
 #endif
 
+#if defined(ZIG_OS_LINUX) || defined(ZIG_OS_FREEBSD) || defined(ZIG_OS_NETBSD)
+#ifndef NT_GNU_BUILD_ID
+#define NT_GNU_BUILD_ID 3
+#endif
+
+struct SelfBuildIdContext {
+    Buf *out_id;
+    bool missing;
+};
+
+// Appends the GNU build ID note of one loaded object, if it has one.
+static bool append_build_id(struct dl_phdr_info *info, Buf *out_id) {
+    for (size_t phdr_i = 0; phdr_i < info->dlpi_phnum; phdr_i += 1) {
+        const ElfW(Phdr) *phdr = &info->dlpi_phdr[phdr_i];
+        if (phdr->p_type != PT_NOTE)
+            continue;
+        size_t align = (phdr->p_align == 8) ? 8 : 4;
+        const char *ptr = reinterpret_cast<const char *>(info->dlpi_addr + phdr->p_vaddr);
+        const char *end = ptr + phdr->p_memsz;
+        while (ptr + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr) *note = reinterpret_cast<const ElfW(Nhdr) *>(ptr);
+            const char *name = ptr + sizeof(ElfW(Nhdr));
+            const char *desc = name + ((note->n_namesz + align - 1) & ~(align - 1));
+            const char *next = desc + ((note->n_descsz + align - 1) & ~(align - 1));
+            if (next > end)
+                break;
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && memcmp(name, "GNU", 4) == 0 &&
+                note->n_descsz != 0)
+            {
+                buf_append_mem(out_id, desc, note->n_descsz);
+                return true;
+            }
+            ptr = next;
+        }
+    }
+    return false;
+}
+
+static int self_build_id_callback(struct dl_phdr_info *info, size_t size, void *data) {
+    SelfBuildIdContext *context = reinterpret_cast<SelfBuildIdContext *>(data);
+    // The executable itself has an empty name. Other objects without a path,
+    // such as the vDSO, are not files that os_self_exe_shared_libs reports.
+    bool is_exe = buf_len(context->out_id) == 0 && info->dlpi_name[0] == 0;
+    if (!is_exe && info->dlpi_name[0] != '/')
+        return 0;
+    if (!append_build_id(info, context->out_id)) {
+        context->missing = true;
+        return 1;
+    }
+    return 0;
+}
+#endif
+
+Error os_self_build_id(Buf *out_id) {
+#if defined(ZIG_OS_LINUX) || defined(ZIG_OS_FREEBSD) || defined(ZIG_OS_NETBSD)
+    buf_resize(out_id, 0);
+    SelfBuildIdContext context = {out_id, false};
+    dl_iterate_phdr(self_build_id_callback, &context);
+    if (context.missing || buf_len(out_id) == 0)
+        return ErrorFileNotFound;
+    return ErrorNone;
+#else
+    return ErrorUnsupportedOperatingSystem;
+#endif
+}
+
 Error os_self_exe_shared_libs(ZigList<Buf *> &paths) {
 #if defined(ZIG_OS_LINUX) || defined(ZIG_OS_FREEBSD) || defined(ZIG_OS_NETBSD)
     paths.resize(0);
@@ -1800,6 +1907,24 @@ Error os_self_exe_shared_libs(ZigList<Buf *> &paths) {
 #endif
 }
 
+#if !defined(ZIG_OS_WINDOWS)
+static void stat_to_file_attr(const struct stat *statbuf, OsFileAttr *attr) {
+    attr->inode = statbuf->st_ino;
+    attr->size = statbuf->st_size;
+#if defined(ZIG_OS_DARWIN)
+    attr->mtime.sec = statbuf->st_mtimespec.tv_sec;
+    attr->mtime.nsec = statbuf->st_mtimespec.tv_nsec;
+    attr->ctime.sec = statbuf->st_ctimespec.tv_sec;
+    attr->ctime.nsec = statbuf->st_ctimespec.tv_nsec;
+#else
+    attr->mtime.sec = statbuf->st_mtim.tv_sec;
+    attr->mtime.nsec = statbuf->st_mtim.tv_nsec;
+    attr->ctime.sec = statbuf->st_ctim.tv_sec;
+    attr->ctime.nsec = statbuf->st_ctim.tv_nsec;
+#endif
+}
+#endif
+
 Error os_file_open_r(Buf *full_path, OsFile *out_file, OsFileAttr *attr) {
 #if defined(ZIG_OS_WINDOWS)
     // TODO use CreateFileW
@@ -1835,7 +1960,9 @@ Error os_file_open_r(Buf *full_path, OsFile *out_file, OsFileAttr *attr) {
             return ErrorUnexpected;
         }
         windows_filetime_to_os_timestamp(&file_info.ftLastWriteTime, &attr->mtime);
+        windows_filetime_to_os_timestamp(&file_info.ftCreationTime, &attr->ctime);
         attr->inode = (((uint64_t)file_info.nFileIndexHigh) << 32) | file_info.nFileIndexLow;
+        attr->size = (((uint64_t)file_info.nFileSizeHigh) << 32) | file_info.nFileSizeLow;
     }
 
     return ErrorNone;
@@ -1872,20 +1999,42 @@ Error os_file_open_r(Buf *full_path, OsFile *out_file, OsFileAttr *attr) {
         *out_file = fd;
 
         if (attr != nullptr) {
-            attr->inode = statbuf.st_ino;
-#if defined(ZIG_OS_DARWIN)
-            attr->mtime.sec = statbuf.st_mtimespec.tv_sec;
-            attr->mtime.nsec = statbuf.st_mtimespec.tv_nsec;
-#else
-            attr->mtime.sec = statbuf.st_mtim.tv_sec;
-            attr->mtime.nsec = statbuf.st_mtim.tv_nsec;
-#endif
+            stat_to_file_attr(&statbuf, attr);
         }
         return ErrorNone;
     }
 #endif
 }
 
+Error os_file_stat(Buf *full_path, OsFileAttr *attr) {
+#if defined(ZIG_OS_WINDOWS)
+    // The file index that stands in for the inode needs a handle.
+    Error err;
+    OsFile file;
+    if ((err = os_file_open_r(full_path, &file, attr)))
+        return err;
+    os_file_close(&file);
+    return ErrorNone;
+#else
+    struct stat statbuf;
+    if (stat(buf_ptr(full_path), &statbuf) == -1) {
+        switch (errno) {
+            case EACCES:
+                return ErrorAccess;
+            case ENOENT:
+            case ENOTDIR:
+                return ErrorFileNotFound;
+            default:
+                return ErrorFileSystem;
+        }
+    }
+    if (S_ISDIR(statbuf.st_mode))
+        return ErrorIsDir;
+    stat_to_file_attr(&statbuf, attr);
+    return ErrorNone;
+#endif
+}
+
 Error os_file_open_lock_rw(Buf *full_path, OsFile *out_file) {
 #if defined(ZIG_OS_WINDOWS)
     for (;;) {
@@ -2080,6 +2229,596 @@ void os_file_close(OsFile *file) {
 #endif
 }
 
+struct OsThread {
+#if defined(ZIG_OS_WINDOWS)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    OsThreadFn fn;
+    void *context;
+};
+
+struct OsMutex {
+#if defined(ZIG_OS_WINDOWS)
+    CRITICAL_SECTION critical_section;
+#else
+    pthread_mutex_t mutex;
+#endif
+};
+
+struct OsCond {
+#if defined(ZIG_OS_WINDOWS)
+    CONDITION_VARIABLE cond;
+#else
+    pthread_cond_t cond;
+#endif
+};
+
+#if defined(ZIG_OS_WINDOWS)
+static DWORD WINAPI os_thread_start(LPVOID arg) {
+    OsThread *thread = reinterpret_cast<OsThread *>(arg);
+    thread->fn(thread->context);
+    return 0;
+}
+#else
+static void *os_thread_start(void *arg) {
+    OsThread *thread = reinterpret_cast<OsThread *>(arg);
+    thread->fn(thread->context);
+    return nullptr;
+}
+#endif
+
+Error os_thread_spawn(OsThreadFn fn, void *context, OsThread **out_thread) {
+    OsThread *thread = allocate<OsThread>(1);
+    thread->fn = fn;
+    thread->context = context;
+#if defined(ZIG_OS_WINDOWS)
+    thread->handle = CreateThread(nullptr, 0, os_thread_start, thread, 0, nullptr);
+    if (thread->handle == nullptr) {
+        free(thread);
+        return ErrorSystemResources;
+    }
+#else
+    if (pthread_create(&thread->handle, nullptr, os_thread_start, thread) != 0) {
+        free(thread);
+        return ErrorSystemResources;
+    }
+#endif
+    *out_thread = thread;
+    return ErrorNone;
+}
+
+void os_thread_join(OsThread *thread) {
+#if defined(ZIG_OS_WINDOWS)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    int rc = pthread_join(thread->handle, nullptr);
+    assert(rc == 0);
+#endif
+    free(thread);
+}
+
+uint32_t os_cpu_count(void) {
+#if defined(ZIG_OS_WINDOWS)
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    return (system_info.dwNumberOfProcessors == 0) ? 1 : system_info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count <= 0) ? 1 : (uint32_t)count;
+#endif
+}
+
+size_t os_peak_rss(void) {
+#if defined(ZIG_OS_WINDOWS)
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__MACH__)
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+OsMutex *os_mutex_create(void) {
+    OsMutex *mutex = allocate<OsMutex>(1);
+#if defined(ZIG_OS_WINDOWS)
+    InitializeCriticalSection(&mutex->critical_section);
+#else
+    int rc = pthread_mutex_init(&mutex->mutex, nullptr);
+    assert(rc == 0);
+#endif
+    return mutex;
+}
+
+void os_mutex_lock(OsMutex *mutex) {
+#if defined(ZIG_OS_WINDOWS)
+    EnterCriticalSection(&mutex->critical_section);
+#else
+    int rc = pthread_mutex_lock(&mutex->mutex);
+    assert(rc == 0);
+#endif
+}
+
+void os_mutex_unlock(OsMutex *mutex) {
+#if defined(ZIG_OS_WINDOWS)
+    LeaveCriticalSection(&mutex->critical_section);
+#else
+    int rc = pthread_mutex_unlock(&mutex->mutex);
+    assert(rc == 0);
+#endif
+}
+
+OsCond *os_cond_create(void) {
+    OsCond *cond = allocate<OsCond>(1);
+#if defined(ZIG_OS_WINDOWS)
+    InitializeConditionVariable(&cond->cond);
+#else
+    int rc = pthread_cond_init(&cond->cond, nullptr);
+    assert(rc == 0);
+#endif
+    return cond;
+}
+
+void os_cond_wait(OsCond *cond, OsMutex *mutex) {
+#if defined(ZIG_OS_WINDOWS)
+    SleepConditionVariableCS(&cond->cond, &mutex->critical_section, INFINITE);
+#else
+    int rc = pthread_cond_wait(&cond->cond, &mutex->mutex);
+    assert(rc == 0);
+#endif
+}
+
+void os_cond_broadcast(OsCond *cond) {
+#if defined(ZIG_OS_WINDOWS)
+    WakeAllConditionVariable(&cond->cond);
+#else
+    int rc = pthread_cond_broadcast(&cond->cond);
+    assert(rc == 0);
+#endif
+}
+
+Error os_dir_entries(Buf *dir_path, ZigList<OsDirEntry> &out_entries) {
+#if defined(ZIG_OS_WINDOWS)
+    Buf *pattern = buf_sprintf("%s\\*", buf_ptr(dir_path));
+    WIN32_FIND_DATAA find_data;
+    HANDLE handle = FindFirstFileA(buf_ptr(pattern), &find_data);
+    if (handle == INVALID_HANDLE_VALUE) {
+        switch (GetLastError()) {
+            case ERROR_FILE_NOT_FOUND:
+            case ERROR_PATH_NOT_FOUND:
+                return ErrorFileNotFound;
+            case ERROR_ACCESS_DENIED:
+                return ErrorAccess;
+            default:
+                return ErrorUnexpected;
+        }
+    }
+    do {
+        if (strcmp(find_data.cFileName, ".") == 0 || strcmp(find_data.cFileName, "..") == 0)
+            continue;
+        OsDirEntry entry;
+        entry.name = buf_create_from_str(find_data.cFileName);
+        entry.is_dir = (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        out_entries.append(entry);
+    } while (FindNextFileA(handle, &find_data));
+    FindClose(handle);
+    return ErrorNone;
+#else
+    DIR *dir = opendir(buf_ptr(dir_path));
+    if (dir == nullptr) {
+        switch (errno) {
+            case ENOENT:
+                return ErrorFileNotFound;
+            case ENOTDIR:
+                return ErrorNotDir;
+            case EACCES:
+                return ErrorAccess;
+            case EMFILE:
+            case ENFILE:
+            case ENOMEM:
+                return ErrorSystemResources;
+            default:
+                return ErrorFileSystem;
+        }
+    }
+    for (;;) {
+        struct dirent *dirent = readdir(dir);
+        if (dirent == nullptr)
+            break;
+        if (strcmp(dirent->d_name, ".") == 0 || strcmp(dirent->d_name, "..") == 0)
+            continue;
+        OsDirEntry entry;
+        entry.name = buf_create_from_str(dirent->d_name);
+        if (dirent->d_type == DT_UNKNOWN) {
+            Buf *full_path = buf_alloc();
+            os_path_join(dir_path, entry.name, full_path);
+            struct stat statbuf;
+            entry.is_dir = stat(buf_ptr(full_path), &statbuf) == 0 && S_ISDIR(statbuf.st_mode);
+        } else {
+            entry.is_dir = (dirent->d_type == DT_DIR);
+        }
+        out_entries.append(entry);
+    }
+    closedir(dir);
+    return ErrorNone;
+#endif
+}
+
+Error os_set_cwd(Buf *path) {
+#if defined(ZIG_OS_WINDOWS)
+    if (!SetCurrentDirectoryA(buf_ptr(path))) {
+        return ErrorFileNotFound;
+    }
+    return ErrorNone;
+#else
+    if (chdir(buf_ptr(path)) == -1) {
+        switch (errno) {
+            case EACCES:
+                return ErrorAccess;
+            case ENOENT:
+                return ErrorFileNotFound;
+            case ENOTDIR:
+                return ErrorNotDir;
+            default:
+                return ErrorFileSystem;
+        }
+    }
+    return ErrorNone;
+#endif
+}
+
+struct OsProcess {
+#if !defined(ZIG_OS_WINDOWS)
+    pid_t pid;
+#endif
+};
+
+Error os_fork(void (*fn)(void *context), void *context, bool silent, OsProcess **out_process) {
+#if defined(ZIG_OS_WINDOWS)
+    return ErrorUnsupportedOperatingSystem;
+#else
+    fflush(stdout);
+    fflush(stderr);
+#if defined(ZIG_OS_LINUX)
+    pid_t parent_pid = getpid();
+#endif
+    pid_t pid = fork();
+    if (pid == -1)
+        return ErrorSystemResources;
+    if (pid == 0) {
+#if defined(ZIG_OS_LINUX)
+        // Do not outlive a parent that dies without killing us, such as
+        // one that aborts.
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid() != parent_pid)
+            _exit(1);
+#endif
+        // Otherwise both processes pick the same temporary file names.
+        srand(rand() ^ (unsigned)getpid());
+        if (silent) {
+            int fd = open("/dev/null", O_WRONLY|O_CLOEXEC);
+            if (fd != -1) {
+                dup2(fd, STDOUT_FILENO);
+                dup2(fd, STDERR_FILENO);
+                close(fd);
+            }
+        }
+        fn(context);
+        exit(0);
+    }
+    OsProcess *process = allocate<OsProcess>(1);
+    process->pid = pid;
+    *out_process = process;
+    return ErrorNone;
+#endif
+}
+
+void os_process_kill(OsProcess *process) {
+#if defined(ZIG_OS_WINDOWS)
+    zig_unreachable();
+#else
+    kill(process->pid, SIGKILL);
+#endif
+}
+
+void os_process_wait(OsProcess *process, Termination *term) {
+#if defined(ZIG_OS_WINDOWS)
+    zig_unreachable();
+#else
+    int status;
+    while (waitpid(process->pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            term->how = TerminationIdUnknown;
+            term->code = errno;
+            free(process);
+            return;
+        }
+    }
+    populate_termination(term, status);
+    free(process);
+#endif
+}
+
+Error os_fork_and_wait(void (*fn)(void *context), void *context, Termination *term) {
+    Error err;
+    OsProcess *process;
+    if ((err = os_fork(fn, context, false, &process)))
+        return err;
+    os_process_wait(process, term);
+    return ErrorNone;
+}
+
+Error os_replace_std_files(OsFile *files) {
+#if defined(ZIG_OS_WINDOWS)
+    return ErrorUnsupportedOperatingSystem;
+#else
+    for (int fd = 0; fd < 3; fd += 1) {
+        if (files[fd] == fd)
+            continue;
+        if (dup2(files[fd], fd) == -1)
+            return ErrorSystemResources;
+        close(files[fd]);
+        files[fd] = fd;
+    }
+    return ErrorNone;
+#endif
+}
+
+char **os_get_environ(void) {
+#if defined(ZIG_OS_WINDOWS)
+    return nullptr;
+#else
+    return environ;
+#endif
+}
+
+Error os_set_environ(char **env) {
+#if defined(ZIG_OS_WINDOWS)
+    return ErrorUnsupportedOperatingSystem;
+#else
+    environ = env;
+    return ErrorNone;
+#endif
+}
+
+#if defined(ZIG_OS_POSIX)
+static Error os_ipc_address(Buf *socket_path, struct sockaddr_un *addr) {
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    if (buf_len(socket_path) >= sizeof(addr->sun_path))
+        return ErrorPathTooLong;
+    memcpy(addr->sun_path, buf_ptr(socket_path), buf_len(socket_path));
+    return ErrorNone;
+}
+
+static Error os_ipc_write_all(int fd, const char *ptr, size_t len, OsFile *files, size_t files_len) {
+    while (len != 0) {
+        struct iovec iov;
+        iov.iov_base = const_cast<char *>(ptr);
+        iov.iov_len = len;
+
+        struct msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+
+        char control[CMSG_SPACE(sizeof(int) * 3)] = {};
+        if (files_len != 0) {
+            assert(files_len <= 3);
+            msg.msg_control = control;
+            msg.msg_controllen = CMSG_SPACE(sizeof(int) * files_len);
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int) * files_len);
+            memcpy(CMSG_DATA(cmsg), files, sizeof(int) * files_len);
+        }
+
+#if defined(MSG_NOSIGNAL)
+        // A client that went away must not kill the server with SIGPIPE.
+        ssize_t amt = sendmsg(fd, &msg, MSG_NOSIGNAL);
+#else
+        ssize_t amt = sendmsg(fd, &msg, 0);
+#endif
+        if (amt == -1) {
+            switch (errno) {
+                case EINTR:
+                    continue;
+                case EPIPE:
+                case ECONNRESET:
+                    return ErrorBrokenPipe;
+                default:
+                    return ErrorUnexpectedWriteFailure;
+            }
+        }
+        // The files go along with the first byte that makes it across.
+        files_len = 0;
+        ptr += amt;
+        len -= amt;
+    }
+    return ErrorNone;
+}
+
+static Error os_ipc_read_all(int fd, char *ptr, size_t len, OsFile *files, size_t files_len) {
+    while (len != 0) {
+        struct iovec iov;
+        iov.iov_base = ptr;
+        iov.iov_len = len;
+
+        struct msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+
+        char control[CMSG_SPACE(sizeof(int) * 3)] = {};
+        if (files_len != 0) {
+            assert(files_len <= 3);
+            msg.msg_control = control;
+            msg.msg_controllen = CMSG_SPACE(sizeof(int) * files_len);
+        }
+
+        ssize_t amt = recvmsg(fd, &msg, 0);
+        if (amt == -1) {
+            if (errno == EINTR)
+                continue;
+            return ErrorFileSystem;
+        }
+        if (amt == 0)
+            return ErrorEndOfFile;
+        if (files_len != 0) {
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+            if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+                cmsg->cmsg_len != CMSG_LEN(sizeof(int) * files_len))
+            {
+                return ErrorInvalidFormat;
+            }
+            memcpy(files, CMSG_DATA(cmsg), sizeof(int) * files_len);
+            files_len = 0;
+        }
+        ptr += amt;
+        len -= amt;
+    }
+    return ErrorNone;
+}
+#endif
+
+Error os_ipc_listen(Buf *socket_path, OsFile *out_socket) {
+#if defined(ZIG_OS_WINDOWS)
+    return ErrorUnsupportedOperatingSystem;
+#else
+    Error err;
+    struct sockaddr_un addr;
+    if ((err = os_ipc_address(socket_path, &addr)))
+        return err;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+        return ErrorSystemResources;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    // A socket file left behind by a previous server would make bind fail.
+    // Anything else at the path is left alone for bind to report.
+    struct stat st;
+    if (lstat(buf_ptr(socket_path), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(buf_ptr(socket_path));
+    }
+    // Whoever can connect can run builds as this user, so the socket file is
+    // created accessible to its owner only, whatever the umask.
+    mode_t old_umask = umask(S_IRWXG | S_IRWXO);
+    int rc = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old_umask);
+    if (rc == -1) {
+        close(fd);
+        switch (errno) {
+            case EACCES:
+                return ErrorAccess;
+            case EADDRINUSE:
+                return ErrorPathAlreadyExists;
+            case ENOENT:
+            case ENOTDIR:
+                return ErrorFileNotFound;
+            default:
+                return ErrorFileSystem;
+        }
+    }
+    if (listen(fd, 16) == -1) {
+        close(fd);
+        return ErrorSystemResources;
+    }
+    *out_socket = fd;
+    return ErrorNone;
+#endif
+}
+
+Error os_ipc_accept(OsFile listen_socket, OsFile *out_socket) {
+#if defined(ZIG_OS_WINDOWS)
+    return ErrorUnsupportedOperatingSystem;
+#else
+    for (;;) {
+        int fd = accept(listen_socket, nullptr, nullptr);
+        if (fd == -1) {
+            switch (errno) {
+                case EINTR:
+                case ECONNABORTED:
+                    continue;
+                case EMFILE:
+                case ENFILE:
+                case ENOBUFS:
+                case ENOMEM:
+                    return ErrorSystemResources;
+                default:
+                    return ErrorUnexpected;
+            }
+        }
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        *out_socket = fd;
+        return ErrorNone;
+    }
+#endif
+}
+
+Error os_ipc_connect(Buf *socket_path, OsFile *out_socket) {
+#if defined(ZIG_OS_WINDOWS)
+    return ErrorUnsupportedOperatingSystem;
+#else
+    Error err;
+    struct sockaddr_un addr;
+    if ((err = os_ipc_address(socket_path, &addr)))
+        return err;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+        return ErrorSystemResources;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    for (;;) {
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+            if (errno == EINTR)
+                continue;
+            close(fd);
+            switch (errno) {
+                case EACCES:
+                    return ErrorAccess;
+                case ENOENT:
+                case ECONNREFUSED:
+                    return ErrorFileNotFound;
+                default:
+                    return ErrorUnexpected;
+            }
+        }
+        break;
+    }
+    *out_socket = fd;
+    return ErrorNone;
+#endif
+}
+
+Error os_ipc_send(OsFile socket, Buf *msg, OsFile *files, size_t files_len) {
+#if defined(ZIG_OS_WINDOWS)
+    return ErrorUnsupportedOperatingSystem;
+#else
+    Error err;
+    uint32_t len = buf_len(msg);
+    if ((err = os_ipc_write_all(socket, (const char *)&len, sizeof(uint32_t), files, files_len)))
+        return err;
+    return os_ipc_write_all(socket, buf_ptr(msg), buf_len(msg), nullptr, 0);
+#endif
+}
+
+Error os_ipc_recv(OsFile socket, Buf *msg, OsFile *files, size_t files_len) {
+#if defined(ZIG_OS_WINDOWS)
+    return ErrorUnsupportedOperatingSystem;
+#else
+    Error err;
+    uint32_t len;
+    if ((err = os_ipc_read_all(socket, (char *)&len, sizeof(uint32_t), files, files_len)))
+        return err;
+    buf_resize(msg, len);
+    return os_ipc_read_all(socket, buf_ptr(msg), len, nullptr, 0);
+#endif
+}
+
 #ifdef ZIG_OS_LINUX
 const char *possible_ld_names[] = {
 #if defined(ZIG_ARCH_X86_64)
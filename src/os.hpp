@@ -95,9 +95,24 @@ struct OsTimeStamp {
 
 struct OsFileAttr {
     OsTimeStamp mtime;
+    // The status change time. Windows has none, so there it is the creation time.
+    OsTimeStamp ctime;
     uint64_t inode;
+    uint64_t size;
 };
 
+struct OsDirEntry {
+    Buf *name;
+    bool is_dir;
+};
+
+struct OsThread;
+struct OsMutex;
+struct OsCond;
+struct OsProcess;
+
+typedef void (*OsThreadFn)(void *context);
+
 int os_init(void);
 
 void os_spawn_process(ZigList<const char *> &args, Termination *term);
@@ -117,6 +132,8 @@ Error ATTRIBUTE_MUST_USE os_make_path(Buf *path);
 Error ATTRIBUTE_MUST_USE os_make_dir(Buf *path);
 
 Error ATTRIBUTE_MUST_USE os_file_open_r(Buf *full_path, OsFile *out_file, OsFileAttr *attr);
+// Gets the same attributes as os_file_open_r without opening the file where possible.
+Error ATTRIBUTE_MUST_USE os_file_stat(Buf *full_path, OsFileAttr *attr);
 Error ATTRIBUTE_MUST_USE os_file_open_lock_rw(Buf *full_path, OsFile *out_file);
 Error ATTRIBUTE_MUST_USE os_file_read(OsFile file, void *ptr, size_t *len);
 Error ATTRIBUTE_MUST_USE os_file_read_all(OsFile file, Buf *contents);
@@ -137,6 +154,8 @@ void os_stderr_set_color(TermColor color);
 Error os_delete_file(Buf *path);
 
 Error ATTRIBUTE_MUST_USE os_file_exists(Buf *full_path, bool *result);
+// Sets the modification time of an existing file to now.
+Error ATTRIBUTE_MUST_USE os_file_touch(Buf *full_path);
 
 Error os_rename(Buf *src_path, Buf *dest_path);
 OsTimeStamp os_timestamp_monotonic(void);
@@ -153,5 +172,56 @@ Error ATTRIBUTE_MUST_USE os_get_win32_ucrt_lib_path(ZigWindowsSDK *sdk, Buf *out
 Error ATTRIBUTE_MUST_USE os_get_win32_kern32_path(ZigWindowsSDK *sdk, Buf *output_buf, ZigLLVM_ArchType platform_type);
 
 Error ATTRIBUTE_MUST_USE os_self_exe_shared_libs(ZigList<Buf *> &paths);
+// The linker-generated build IDs of the executable and of every shared library
+// it loaded, concatenated. Fails unless all of them have one. ELF only.
+Error ATTRIBUTE_MUST_USE os_self_build_id(Buf *out_id);
+
+Error ATTRIBUTE_MUST_USE os_thread_spawn(OsThreadFn fn, void *context, OsThread **out_thread);
+void os_thread_join(OsThread *thread);
+uint32_t os_cpu_count(void);
+// Returns 0 if the peak resident set size is not known on this OS.
+size_t os_peak_rss(void);
+
+OsMutex *os_mutex_create(void);
+void os_mutex_lock(OsMutex *mutex);
+void os_mutex_unlock(OsMutex *mutex);
+
+OsCond *os_cond_create(void);
+// Atomically unlocks mutex and waits; mutex is locked again on return.
+// Spurious wakeups are possible, so callers wait in a loop.
+void os_cond_wait(OsCond *cond, OsMutex *mutex);
+void os_cond_broadcast(OsCond *cond);
+
+Error ATTRIBUTE_MUST_USE os_dir_entries(Buf *dir_path, ZigList<OsDirEntry> &out_entries);
+Error ATTRIBUTE_MUST_USE os_set_cwd(Buf *path);
+
+// Runs fn in a forked copy of this process and waits for it to exit. If fn
+// returns, the child exits with status 0. Not available on Windows.
+Error ATTRIBUTE_MUST_USE os_fork_and_wait(void (*fn)(void *context), void *context, Termination *term);
+// Like os_fork_and_wait, but returns once the child is started. With silent
+// set, the child's stdout and stderr go to the null device. On Linux the
+// child is killed if this process dies first.
+Error ATTRIBUTE_MUST_USE os_fork(void (*fn)(void *context), void *context, bool silent,
+        OsProcess **out_process);
+// Kills a child started by os_fork. It must still be waited for.
+void os_process_kill(OsProcess *process);
+// Waits for a child started by os_fork to exit, and frees process.
+void os_process_wait(OsProcess *process, Termination *term);
+// Makes the given files the stdin, stdout and stderr of this process.
+Error ATTRIBUTE_MUST_USE os_replace_std_files(OsFile *files);
+// The environment as a null terminated array of "NAME=value" strings. The
+// array passed to os_set_environ must stay alive while it is in use. Neither
+// is available on Windows.
+char **os_get_environ(void);
+Error ATTRIBUTE_MUST_USE os_set_environ(char **env);
+
+// Local stream sockets. Each message is length-prefixed and may carry open
+// files (stdin/stdout/stderr of a client) to the other end. Not available
+// on Windows.
+Error ATTRIBUTE_MUST_USE os_ipc_listen(Buf *socket_path, OsFile *out_socket);
+Error ATTRIBUTE_MUST_USE os_ipc_accept(OsFile listen_socket, OsFile *out_socket);
+Error ATTRIBUTE_MUST_USE os_ipc_connect(Buf *socket_path, OsFile *out_socket);
+Error ATTRIBUTE_MUST_USE os_ipc_send(OsFile socket, Buf *msg, OsFile *files, size_t files_len);
+Error ATTRIBUTE_MUST_USE os_ipc_recv(OsFile socket, Buf *msg, OsFile *files, size_t files_len);
 
 #endif
@@ -6,6 +6,7 @@
  */
 
 #include "parser.hpp"
+#include "arena.hpp"
 #include "errmsg.hpp"
 #include "analyze.hpp"
 
@@ -20,6 +21,7 @@ struct ParseContext {
     ZigList<Token> *tokens;
     ZigType *owner;
     ErrColor err_color;
+    bool lazy_fn_bodies;
 };
 
 struct PtrPayload {
@@ -62,6 +64,7 @@ static AstNode *ast_parse_prefix_expr(ParseContext *pc);
 static AstNode *ast_parse_primary_expr(ParseContext *pc);
 static AstNode *ast_parse_if_expr(ParseContext *pc);
 static AstNode *ast_parse_block(ParseContext *pc);
+static bool ast_skip_fn_body(ParseContext *pc, size_t *out_body_token);
 static AstNode *ast_parse_loop_expr(ParseContext *pc);
 static AstNode *ast_parse_for_expr(ParseContext *pc);
 static AstNode *ast_parse_while_expr(ParseContext *pc);
@@ -154,7 +157,7 @@ static void ast_invalid_token_error(ParseContext *pc, Token *token) {
 }
 
 static AstNode *ast_create_node_no_line_info(ParseContext *pc, NodeType type) {
-    AstNode *node = allocate<AstNode>(1);
+    AstNode *node = arena_allocate<AstNode>(&ast_arena, 1);
     node->type = type;
     node->owner = pc->owner;
     return node;
@@ -472,13 +475,59 @@ AstNode *ast_parse_bin_op_simple(ParseContext *pc) {
     return res;
 }
 
-AstNode *ast_parse(Buf *buf, ZigList<Token> *tokens, ZigType *owner, ErrColor err_color) {
-    ParseContext pc = {};
-    pc.err_color = err_color;
-    pc.owner = owner;
-    pc.buf = buf;
-    pc.tokens = tokens;
-    return ast_parse_root(&pc);
+AstNode *ast_parse(Buf *buf, ZigList<Token> *tokens, ZigType *owner, ErrColor err_color,
+        bool lazy_fn_bodies)
+{
+    // Skipped function bodies keep a pointer to the context, so it outlives this call.
+    ParseContext *pc = allocate<ParseContext>(1);
+    pc->err_color = err_color;
+    pc->owner = owner;
+    pc->buf = buf;
+    pc->tokens = tokens;
+    pc->lazy_fn_bodies = lazy_fn_bodies;
+    return ast_parse_root(pc);
+}
+
+AstNode *ast_fn_def_body(AstNode *fn_def_node) {
+    assert(fn_def_node->type == NodeTypeFnDef);
+    AstNodeFnDef *fn_def = &fn_def_node->data.fn_def;
+    if (fn_def->body == nullptr && fn_def->lazy_pc != nullptr) {
+        ParseContext pc = *fn_def->lazy_pc;
+        pc.current_token = fn_def->lazy_body_token;
+        pc.lazy_fn_bodies = false;
+        fn_def->body = ast_parse_block(&pc);
+        assert(fn_def->body != nullptr);
+        fn_def->lazy_pc = nullptr;
+    }
+    return fn_def->body;
+}
+
+// Skips the function body at the current token by matching braces, leaving it
+// for ast_fn_def_body. Returns false, having consumed nothing, when lazy
+// parsing is off, there is no body, or the braces do not balance, in which
+// case the normal parse handles it and reports any error.
+static bool ast_skip_fn_body(ParseContext *pc, size_t *out_body_token) {
+    if (!pc->lazy_fn_bodies || peek_token(pc)->id != TokenIdLBrace)
+        return false;
+    size_t depth = 0;
+    for (size_t i = pc->current_token; i < pc->tokens->length; i += 1) {
+        switch (pc->tokens->at(i).id) {
+            case TokenIdLBrace:
+                depth += 1;
+                break;
+            case TokenIdRBrace:
+                depth -= 1;
+                if (depth == 0) {
+                    *out_body_token = pc->current_token;
+                    pc->current_token = i + 1;
+                    return true;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
 }
 
 // Root <- skip ContainerMembers eof
@@ -614,8 +663,10 @@ static AstNode *ast_parse_top_level_decl(ParseContext *pc, VisibMod visib_mod) {
 
         AstNode *fn_proto = ast_parse_fn_proto(pc);
         if (fn_proto != nullptr) {
-            AstNode *body = ast_parse_block(pc);
-            if (body == nullptr)
+            size_t lazy_body_token;
+            bool body_skipped = ast_skip_fn_body(pc, &lazy_body_token);
+            AstNode *body = body_skipped ? nullptr : ast_parse_block(pc);
+            if (body == nullptr && !body_skipped)
                 expect_token(pc, TokenIdSemicolon);
 
             assert(fn_proto->type == NodeTypeFnProto);
@@ -627,10 +678,14 @@ static AstNode *ast_parse_top_level_decl(ParseContext *pc, VisibMod visib_mod) {
             fn_proto->data.fn_proto.is_inline = first->id == TokenIdKeywordInline;
             fn_proto->data.fn_proto.lib_name = token_buf(lib_name);
             AstNode *res = fn_proto;
-            if (body != nullptr) {
+            if (body != nullptr || body_skipped) {
                 res = ast_create_node_copy_line_info(pc, NodeTypeFnDef, fn_proto);
                 res->data.fn_def.fn_proto = fn_proto;
                 res->data.fn_def.body = body;
+                if (body_skipped) {
+                    res->data.fn_def.lazy_pc = pc;
+                    res->data.fn_def.lazy_body_token = lazy_body_token;
+                }
                 fn_proto->data.fn_proto.fn_def_node = res;
             }
 
@@ -654,17 +709,23 @@ static AstNode *ast_parse_top_level_decl(ParseContext *pc, VisibMod visib_mod) {
 
     AstNode *fn_proto = ast_parse_fn_proto(pc);
     if (fn_proto != nullptr) {
-        AstNode *body = ast_parse_block(pc);
-        if (body == nullptr)
+        size_t lazy_body_token;
+        bool body_skipped = ast_skip_fn_body(pc, &lazy_body_token);
+        AstNode *body = body_skipped ? nullptr : ast_parse_block(pc);
+        if (body == nullptr && !body_skipped)
             expect_token(pc, TokenIdSemicolon);
 
         assert(fn_proto->type == NodeTypeFnProto);
         fn_proto->data.fn_proto.visib_mod = visib_mod;
         AstNode *res = fn_proto;
-        if (body != nullptr) {
+        if (body != nullptr || body_skipped) {
             res = ast_create_node_copy_line_info(pc, NodeTypeFnDef, fn_proto);
             res->data.fn_def.fn_proto = fn_proto;
             res->data.fn_def.body = body;
+            if (body_skipped) {
+                res->data.fn_def.lazy_pc = pc;
+                res->data.fn_def.lazy_body_token = lazy_body_token;
+            }
             fn_proto->data.fn_proto.fn_def_node = res;
         }
 
@@ -16,7 +16,11 @@ ATTRIBUTE_PRINTF(2, 3)
 void ast_token_error(Token *token, const char *format, ...);
 
 
-AstNode * ast_parse(Buf *buf, ZigList<Token> *tokens, ZigType *owner, ErrColor err_color);
+// With lazy_fn_bodies, function bodies are only checked for balanced braces
+// here, and parsed by ast_fn_def_body when first needed.
+AstNode * ast_parse(Buf *buf, ZigList<Token> *tokens, ZigType *owner, ErrColor err_color,
+        bool lazy_fn_bodies);
+AstNode *ast_fn_def_body(AstNode *fn_def_node);
 
 void ast_print(AstNode *node, int indent);
 
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2019 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "server.hpp"
+#include "os.hpp"
+#include "parser.hpp"
+
+#include <stdio.h>
+
+struct AstCacheEntry {
+    Buf *path;
+    Buf *source_code;
+    OsTimeStamp mtime;
+    Tokenization tokenization;
+    AstNode *root_node;
+    // Placeholder owner for the AST nodes. The CodeGen that claims the entry
+    // turns it into the real import type, so the nodes need no fixup.
+    ZigType *owner;
+    bool claimed;
+};
+
+struct ServerRequest {
+    Buf *cwd;
+    ZigList<char *> argv;
+    // The client's environment, which replaces the server's.
+    ZigList<char *> env;
+    OsFile files[3];
+    ServerCommandFn run_command;
+};
+
+static bool ast_cache_enabled = false;
+static HashMap<Buf *, AstCacheEntry *, buf_hash, buf_eql_buf> ast_cache;
+
+static void collect_zig_files(Buf *dir_path, ZigList<Buf *> &out_paths) {
+    ZigList<OsDirEntry> entries = {};
+    if (os_dir_entries(dir_path, entries) != ErrorNone)
+        return;
+    for (size_t i = 0; i < entries.length; i += 1) {
+        OsDirEntry *entry = &entries.at(i);
+        Buf *full_path = buf_alloc();
+        os_path_join(dir_path, entry->name, full_path);
+        if (entry->is_dir) {
+            collect_zig_files(full_path, out_paths);
+        } else if (buf_ends_with_str(entry->name, ".zig")) {
+            out_paths.append(full_path);
+        }
+    }
+    entries.deinit();
+}
+
+static AstNode *parse_entry(AstCacheEntry *entry) {
+    RootStruct *root_struct = allocate<RootStruct>(1);
+    root_struct->path = entry->path;
+    root_struct->source_code = entry->source_code;
+    root_struct->line_offsets = entry->tokenization.line_offsets;
+
+    entry->owner = allocate<ZigType>(1);
+    entry->owner->data.structure.root_struct = root_struct;
+    return ast_parse(entry->source_code, entry->tokenization.tokens, entry->owner, ErrColorAuto, false);
+}
+
+// The parser reports syntax errors by exiting, so every file is parsed once
+// in a throwaway child before the server commits to parsing it itself.
+static void parse_check_child(void *context) {
+    ZigList<AstCacheEntry *> *entries = reinterpret_cast<ZigList<AstCacheEntry *> *>(context);
+    for (size_t i = 0; i < entries->length; i += 1) {
+        parse_entry(entries->at(i));
+    }
+}
+
+static bool parse_check(ZigList<AstCacheEntry *> *entries) {
+    Termination term;
+    if (os_fork_and_wait(parse_check_child, entries, &term) != ErrorNone)
+        return false;
+    return term.how == TerminationIdClean && term.code == 0;
+}
+
+static void ast_cache_refresh(ZigList<Buf *> &source_dirs) {
+    Error err;
+
+    ZigList<Buf *> paths = {};
+    for (size_t i = 0; i < source_dirs.length; i += 1) {
+        collect_zig_files(source_dirs.at(i), paths);
+    }
+
+    ZigList<AstCacheEntry *> pending = {};
+    for (size_t i = 0; i < paths.length; i += 1) {
+        Buf *path = paths.at(i);
+        auto existing = ast_cache.maybe_get(path);
+
+        OsFile file;
+        OsFileAttr attr;
+        if ((err = os_file_open_r(path, &file, &attr))) {
+            if (existing != nullptr)
+                ast_cache.remove(path);
+            continue;
+        }
+        if (existing != nullptr && existing->value->mtime.sec == attr.mtime.sec &&
+            existing->value->mtime.nsec == attr.mtime.nsec)
+        {
+            os_file_close(&file);
+            continue;
+        }
+        Buf *source_code = buf_alloc();
+        err = os_file_read_all(file, source_code);
+        os_file_close(&file);
+        if (err != ErrorNone) {
+            if (existing != nullptr)
+                ast_cache.remove(path);
+            continue;
+        }
+        if (existing != nullptr && buf_eql_buf(existing->value->source_code, source_code)) {
+            existing->value->mtime = attr.mtime;
+            continue;
+        }
+
+        AstCacheEntry *entry = allocate<AstCacheEntry>(1);
+        entry->path = path;
+        entry->source_code = source_code;
+        entry->mtime = attr.mtime;
+        // Files that do not tokenize or parse stay in the cache without an
+        // AST so that they are not retried until they change again.
+        ast_cache.put(path, entry);
+        tokenize(source_code, &entry->tokenization);
+        if (entry->tokenization.err == nullptr) {
+            pending.append(entry);
+        }
+    }
+
+    if (pending.length != 0 && !parse_check(&pending)) {
+        // Find out which of the files are broken.
+        ZigList<AstCacheEntry *> good = {};
+        ZigList<AstCacheEntry *> one = {};
+        for (size_t i = 0; i < pending.length; i += 1) {
+            one.resize(0);
+            one.append(pending.at(i));
+            if (parse_check(&one)) {
+                good.append(pending.at(i));
+            }
+        }
+        one.deinit();
+        pending.deinit();
+        pending = good;
+    }
+
+    for (size_t i = 0; i < pending.length; i += 1) {
+        AstCacheEntry *entry = pending.at(i);
+        entry->root_node = parse_entry(entry);
+    }
+    pending.deinit();
+    paths.deinit();
+}
+
+static void run_request_child(void *context) {
+    Error err;
+    ServerRequest *request = reinterpret_cast<ServerRequest *>(context);
+    if ((err = os_replace_std_files(request->files))) {
+        fprintf(stderr, "Unable to use the client's stdio: %s\n", err_str(err));
+        exit(EXIT_FAILURE);
+    }
+    if ((err = os_set_cwd(request->cwd))) {
+        fprintf(stderr, "Unable to change directory to %s: %s\n", buf_ptr(request->cwd), err_str(err));
+        exit(EXIT_FAILURE);
+    }
+    if ((err = os_set_environ(request->env.items))) {
+        fprintf(stderr, "Unable to use the client's environment: %s\n", err_str(err));
+        exit(EXIT_FAILURE);
+    }
+    exit(request->run_command((int)request->argv.length, request->argv.items));
+}
+
+static void serve_request(OsFile conn, ZigList<Buf *> &source_dirs, ServerCommandFn run_command) {
+    Error err;
+
+    ServerRequest request = {};
+    request.run_command = run_command;
+
+    Buf msg = BUF_INIT;
+    if ((err = os_ipc_recv(conn, &msg, request.files, 3))) {
+        fprintf(stderr, "Ignoring malformed request: %s\n", err_str(err));
+        return;
+    }
+
+    // cwd, the argument count, each argument, then each environment
+    // variable, all null terminated.
+    Buf *argc_str = nullptr;
+    size_t argc = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < buf_len(&msg); i += 1) {
+        if (buf_ptr(&msg)[i] != 0)
+            continue;
+        Buf *field = buf_create_from_mem(buf_ptr(&msg) + start, i - start);
+        if (request.cwd == nullptr) {
+            request.cwd = field;
+        } else if (argc_str == nullptr) {
+            argc_str = field;
+            argc = (size_t)strtoull(buf_ptr(field), nullptr, 10);
+        } else if (request.argv.length < argc) {
+            request.argv.append(buf_ptr(field));
+        } else {
+            request.env.append(buf_ptr(field));
+        }
+        start = i + 1;
+    }
+
+    int exit_code = EXIT_FAILURE;
+    if (request.cwd != nullptr && request.argv.length != 0 && request.argv.length == argc) {
+        // argv[argc] must be null, as it is for main(), and so must the end
+        // of the environment.
+        request.argv.ensure_capacity(request.argv.length + 1);
+        request.argv.items[request.argv.length] = nullptr;
+        request.env.append(nullptr);
+
+        ast_cache_refresh(source_dirs);
+
+        Termination term;
+        if ((err = os_fork_and_wait(run_request_child, &request, &term))) {
+            fprintf(stderr, "Unable to fork: %s\n", err_str(err));
+        } else {
+            exit_code = (term.how == TerminationIdClean) ? term.code : -1;
+        }
+    }
+    for (size_t i = 0; i < 3; i += 1) {
+        os_file_close(&request.files[i]);
+    }
+
+    Buf *reply = buf_sprintf("%d", exit_code);
+    if ((err = os_ipc_send(conn, reply, nullptr, 0))) {
+        fprintf(stderr, "Unable to reply to client: %s\n", err_str(err));
+    }
+}
+
+int server_main(Buf *socket_path, ZigList<Buf *> &source_dirs, ServerCommandFn run_command) {
+    Error err;
+
+    OsFile listen_socket;
+    if ((err = os_ipc_listen(socket_path, &listen_socket))) {
+        fprintf(stderr, "Unable to listen on %s: %s\n", buf_ptr(socket_path), err_str(err));
+        return EXIT_FAILURE;
+    }
+
+    ast_cache.init(512);
+    ast_cache_enabled = true;
+    ast_cache_refresh(source_dirs);
+    fprintf(stderr, "Listening on %s with %d files parsed\n", buf_ptr(socket_path), ast_cache.size());
+
+    for (;;) {
+        OsFile conn;
+        if ((err = os_ipc_accept(listen_socket, &conn))) {
+            fprintf(stderr, "Unable to accept connection: %s\n", err_str(err));
+            return EXIT_FAILURE;
+        }
+        serve_request(conn, source_dirs, run_command);
+        os_file_close(&conn);
+    }
+}
+
+Error server_client_run(Buf *socket_path, int argc, char **argv, int *out_exit_code) {
+#if defined(ZIG_OS_WINDOWS)
+    return ErrorUnsupportedOperatingSystem;
+#else
+    Error err;
+
+    OsFile conn;
+    if ((err = os_ipc_connect(socket_path, &conn)))
+        return err;
+
+    Buf *msg = buf_alloc();
+    if ((err = os_get_cwd(msg))) {
+        os_file_close(&conn);
+        return err;
+    }
+    buf_append_char(msg, 0);
+    buf_appendf(msg, "%d", argc);
+    buf_append_char(msg, 0);
+    for (int i = 0; i < argc; i += 1) {
+        buf_append_str(msg, argv[i]);
+        buf_append_char(msg, 0);
+    }
+    for (char **var = os_get_environ(); *var != nullptr; var += 1) {
+        buf_append_str(msg, *var);
+        buf_append_char(msg, 0);
+    }
+
+    OsFile files[] = {0, 1, 2};
+    if ((err = os_ipc_send(conn, msg, files, 3))) {
+        os_file_close(&conn);
+        return err;
+    }
+    Buf reply = BUF_INIT;
+    err = os_ipc_recv(conn, &reply, nullptr, 0);
+    os_file_close(&conn);
+    if (err != ErrorNone) {
+        // The server went away after accepting the request.
+        return (err == ErrorFileNotFound) ? ErrorBrokenPipe : err;
+    }
+    *out_exit_code = atoi(buf_ptr(&reply));
+    return ErrorNone;
+#endif
+}
+
+ZigType *server_ast_cache_claim(Buf *resolved_path, Buf *source_code, Tokenization *out_tokenization,
+        AstNode **out_root_node)
+{
+    if (!ast_cache_enabled)
+        return nullptr;
+    auto cached = ast_cache.maybe_get(resolved_path);
+    if (cached == nullptr)
+        return nullptr;
+    AstCacheEntry *entry = cached->value;
+    if (entry->root_node == nullptr || entry->claimed || !buf_eql_buf(entry->source_code, source_code))
+        return nullptr;
+    entry->claimed = true;
+    *out_tokenization = entry->tokenization;
+    *out_root_node = entry->root_node;
+    return entry->owner;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2019 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_SERVER_HPP
+#define ZIG_SERVER_HPP
+
+#include "all_types.hpp"
+#include "tokenizer.hpp"
+
+typedef int (*ServerCommandFn)(int argc, char **argv);
+
+// Listens on socket_path and runs each request with run_command in a forked
+// copy of the server, so that the parsed source of every .zig file under
+// source_dirs stays resident across builds. Does not return unless the
+// socket cannot be set up.
+int server_main(Buf *socket_path, ZigList<Buf *> &source_dirs, ServerCommandFn run_command);
+
+// Forwards argv to the server listening on socket_path along with this
+// process's stdin, stdout and stderr, and waits for the command to finish.
+// Returns ErrorFileNotFound if no server is listening.
+Error ATTRIBUTE_MUST_USE server_client_run(Buf *socket_path, int argc, char **argv, int *out_exit_code);
+
+// If the server parsed resolved_path ahead of time and its contents still
+// match source_code, hands out the tokens and AST, and returns the type that
+// the AST nodes already use as their owner. Each cached file can be claimed
+// once per process. Returns nullptr otherwise.
+ZigType *server_ast_cache_claim(Buf *resolved_path, Buf *source_code, Tokenization *out_tokenization,
+        AstNode **out_root_node);
+
+#endif
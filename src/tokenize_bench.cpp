@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2019 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// Tokenizes every .zig file under the given directories, std and lib by
+// default, and reports the throughput. See the tokenize_bench target in
+// CMakeLists.txt.
+
+#include "buffer.hpp"
+#include "error.hpp"
+#include "os.hpp"
+#include "tokenizer.hpp"
+
+#include <stdio.h>
+
+static const double min_seconds = 1.0;
+
+static double timestamp_seconds(void) {
+    OsTimeStamp timestamp = os_timestamp_monotonic();
+    return (double)timestamp.sec + ((double)timestamp.nsec) / 1000000000.0;
+}
+
+static void collect_zig_files(Buf *dir_path, ZigList<Buf *> &out_paths) {
+    Error err;
+    ZigList<OsDirEntry> entries = {0};
+    if ((err = os_dir_entries(dir_path, entries))) {
+        fprintf(stderr, "unable to open directory '%s': %s\n", buf_ptr(dir_path), err_str(err));
+        return;
+    }
+    for (size_t i = 0; i < entries.length; i += 1) {
+        Buf *full_path = buf_alloc();
+        os_path_join(dir_path, entries.at(i).name, full_path);
+        if (entries.at(i).is_dir) {
+            collect_zig_files(full_path, out_paths);
+        } else if (buf_ends_with_str(full_path, ".zig")) {
+            out_paths.append(full_path);
+        }
+    }
+    entries.deinit();
+}
+
+static void free_tokenization(Tokenization *tokenization) {
+    for (size_t i = 0; i < tokenization->tokens->length; i += 1) {
+        Token *token = &tokenization->tokens->at(i);
+        if (token->id == TokenIdSymbol || token->id == TokenIdStringLiteral) {
+            buf_deinit(&token->data.str_lit.str);
+        }
+    }
+    tokenization->tokens->deinit();
+    tokenization->line_offsets->deinit();
+    free(tokenization->tokens);
+    free(tokenization->line_offsets);
+}
+
+int main(int argc, char **argv) {
+    Error err;
+    os_init();
+
+    ZigList<Buf *> paths = {0};
+    if (argc > 1) {
+        for (int i = 1; i < argc; i += 1) {
+            collect_zig_files(buf_create_from_str(argv[i]), paths);
+        }
+    } else {
+        collect_zig_files(buf_create_from_str("std"), paths);
+        collect_zig_files(buf_create_from_str("lib"), paths);
+    }
+    if (paths.length == 0) {
+        fprintf(stderr, "no .zig files found\n");
+        return EXIT_FAILURE;
+    }
+
+    ZigList<Buf *> sources = {0};
+    size_t total_bytes = 0;
+    for (size_t i = 0; i < paths.length; i += 1) {
+        Buf *contents = buf_alloc();
+        if ((err = os_fetch_file_path(paths.at(i), contents))) {
+            fprintf(stderr, "unable to read '%s': %s\n", buf_ptr(paths.at(i)), err_str(err));
+            return EXIT_FAILURE;
+        }
+        sources.append(contents);
+        total_bytes += buf_len(contents);
+    }
+
+    // Whole passes over all the files until enough time has passed to be
+    // meaningful. Tokens are freed as we go so that memory use stays flat.
+    size_t passes = 0;
+    size_t total_tokens = 0;
+    size_t error_count = 0;
+    double start = timestamp_seconds();
+    double elapsed;
+    do {
+        for (size_t i = 0; i < sources.length; i += 1) {
+            Tokenization tokenization = {0};
+            tokenize(sources.at(i), &tokenization);
+            if (passes == 0) {
+                total_tokens += tokenization.tokens->length;
+                if (tokenization.err != nullptr)
+                    error_count += 1;
+            }
+            free_tokenization(&tokenization);
+        }
+        passes += 1;
+        elapsed = timestamp_seconds() - start;
+    } while (elapsed < min_seconds);
+
+    double mb = (double)(total_bytes * passes) / (1024.0 * 1024.0);
+    fprintf(stdout, "%zu files, %zu bytes, %zu tokens, %zu with errors\n",
+            sources.length, total_bytes, total_tokens, error_count);
+    fprintf(stdout, "%zu passes in %.3fs: %.2f MB/s\n", passes, elapsed, mb / elapsed);
+    return EXIT_SUCCESS;
+}
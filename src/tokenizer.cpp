@@ -15,6 +15,11 @@
 #include <limits.h>
 #include <errno.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ZIG_TOKENIZER_SSE2
+#include <emmintrin.h>
+#endif
+
 #define WHITESPACE \
          ' ': \
     case '\n'
@@ -105,6 +110,7 @@ struct ZigKeyword {
     TokenId token_id;
 };
 
+// Sorted, for find_zig_keyword.
 static const struct ZigKeyword zig_keywords[] = {
     {"align", TokenIdKeywordAlign},
     {"allowzero", TokenIdKeywordAllowZero},
@@ -130,6 +136,7 @@ static const struct ZigKeyword zig_keywords[] = {
     {"for", TokenIdKeywordFor},
     {"if", TokenIdKeywordIf},
     {"inline", TokenIdKeywordInline},
+    {"linksection", TokenIdKeywordLinkSection},
     {"nakedcc", TokenIdKeywordNakedCC},
     {"noalias", TokenIdKeywordNoAlias},
     {"null", TokenIdKeywordNull},
@@ -140,7 +147,6 @@ static const struct ZigKeyword zig_keywords[] = {
     {"pub", TokenIdKeywordPub},
     {"resume", TokenIdKeywordResume},
     {"return", TokenIdKeywordReturn},
-    {"linksection", TokenIdKeywordLinkSection},
     {"stdcallcc", TokenIdKeywordStdcallCC},
     {"struct", TokenIdKeywordStruct},
     {"suspend", TokenIdKeywordSuspend},
@@ -159,13 +165,30 @@ static const struct ZigKeyword zig_keywords[] = {
     {"while", TokenIdKeywordWhile},
 };
 
-bool is_zig_keyword(Buf *buf) {
-    for (size_t i = 0; i < array_length(zig_keywords); i += 1) {
-        if (buf_eql_str(buf, zig_keywords[i].text)) {
-            return true;
+static const ZigKeyword *find_zig_keyword(const char *mem, size_t len) {
+    size_t lo = 0;
+    size_t hi = array_length(zig_keywords);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const char *text = zig_keywords[mid].text;
+        size_t text_len = strlen(text);
+        int cmp = memcmp(mem, text, (len < text_len) ? len : text_len);
+        if (cmp == 0) {
+            if (len == text_len)
+                return &zig_keywords[mid];
+            cmp = (len < text_len) ? -1 : 1;
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
         }
     }
-    return false;
+    return nullptr;
+}
+
+bool is_zig_keyword(Buf *buf) {
+    return find_zig_keyword(buf_ptr(buf), buf_len(buf)) != nullptr;
 }
 
 static bool is_symbol_char(uint8_t c) {
@@ -236,6 +259,8 @@ struct Tokenize {
     int line;
     int column;
     Token *cur_tok;
+    // Where the contents of the current identifier or string literal begin in buf.
+    size_t str_start;
     Tokenization *out;
     uint32_t radix;
     int32_t exp_add_amt;
@@ -270,9 +295,10 @@ static void set_token_id(Tokenize *t, Token *token, TokenId id) {
         bigfloat_init_32(&token->data.float_lit.bigfloat, 0.0f);
         token->data.float_lit.overflow = false;
     } else if (id == TokenIdStringLiteral || id == TokenIdSymbol) {
+        // Left uninitialized until token_str is called; see there.
         memset(&token->data.str_lit.str, 0, sizeof(Buf));
-        buf_resize(&token->data.str_lit.str, 0);
         token->data.str_lit.is_c_str = false;
+        t->str_start = t->pos;
     }
 }
 
@@ -302,23 +328,40 @@ static void end_float_token(Tokenize *t) {
     }
 }
 
+// Identifiers and string literals without escapes are a span of the source,
+// so their Buf is filled in one piece the first time it is needed: when the
+// token ends, or when an escape means the contents start to differ from the
+// source. Until then the Buf is all zeroes.
+static bool token_str_pending(Token *token) {
+    return token->data.str_lit.str.list.length == 0;
+}
+
+static Buf *token_str(Tokenize *t, size_t end) {
+    Buf *str = &t->cur_tok->data.str_lit.str;
+    if (token_str_pending(t->cur_tok)) {
+        buf_init_from_mem(str, buf_ptr(t->buf) + t->str_start, end - t->str_start);
+    }
+    return str;
+}
+
 static void end_token(Tokenize *t) {
     assert(t->cur_tok);
     t->cur_tok->end_pos = t->pos + 1;
 
     if (t->cur_tok->id == TokenIdFloatLiteral) {
         end_float_token(t);
-    } else if (t->cur_tok->id == TokenIdSymbol) {
+    } else if (t->cur_tok->id == TokenIdSymbol && token_str_pending(t->cur_tok)) {
         char *token_mem = buf_ptr(t->buf) + t->cur_tok->start_pos;
-        int token_len = (int)(t->cur_tok->end_pos - t->cur_tok->start_pos);
+        size_t token_len = t->cur_tok->end_pos - t->cur_tok->start_pos;
 
-        for (size_t i = 0; i < array_length(zig_keywords); i += 1) {
-            if (mem_eql_str(token_mem, token_len, zig_keywords[i].text)) {
-                t->cur_tok->id = zig_keywords[i].token_id;
-                break;
-            }
+        const ZigKeyword *keyword = find_zig_keyword(token_mem, token_len);
+        if (keyword != nullptr) {
+            t->cur_tok->id = keyword->token_id;
         }
     }
+    if (t->cur_tok->id == TokenIdSymbol || t->cur_tok->id == TokenIdStringLiteral) {
+        t->out->str_bytes_copied += buf_len(token_str(t, t->cur_tok->end_pos));
+    }
 
     t->cur_tok = nullptr;
 }
@@ -349,6 +392,7 @@ static void handle_string_escape(Tokenize *t, uint8_t c) {
         t->cur_tok->data.char_lit.c = c;
         t->state = TokenizeStateCharLiteralEnd;
     } else if (t->cur_tok->id == TokenIdStringLiteral || t->cur_tok->id == TokenIdSymbol) {
+        assert(!token_str_pending(t->cur_tok));
         buf_append_char(&t->cur_tok->data.str_lit.str, c);
         t->state = TokenizeStateString;
     } else {
@@ -399,6 +443,113 @@ static void invalid_char_error(Tokenize *t, uint8_t c) {
     tokenize_error(t, "invalid character: '\\x%02x'", c);
 }
 
+// The scan functions below return how many bytes from ptr, up to end, a
+// state would step over without doing anything but advancing the column.
+// They look at 16 bytes at a time where SSE2 is available and finish the
+// last few bytes one at a time, never reading past end.
+
+static size_t scan_symbol_chars(const uint8_t *ptr, const uint8_t *end) {
+    const uint8_t *start = ptr;
+#if defined(ZIG_TOKENIZER_SSE2)
+    // There is no unsigned byte compare, so ranges are checked by shifting
+    // them to start at -128 and doing a signed compare against the top.
+    const __m128i alpha_bias = _mm_set1_epi8((char)(0x80 - 'a'));
+    const __m128i alpha_limit = _mm_set1_epi8((char)(0x80 + 26));
+    const __m128i digit_bias = _mm_set1_epi8((char)(0x80 - '0'));
+    const __m128i digit_limit = _mm_set1_epi8((char)(0x80 + 10));
+    const __m128i lower_bit = _mm_set1_epi8(0x20);
+    const __m128i underscore = _mm_set1_epi8('_');
+    while (end - ptr >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        __m128i lower = _mm_or_si128(chunk, lower_bit);
+        __m128i is_alpha = _mm_cmplt_epi8(_mm_add_epi8(lower, alpha_bias), alpha_limit);
+        __m128i is_digit = _mm_cmplt_epi8(_mm_add_epi8(chunk, digit_bias), digit_limit);
+        __m128i is_underscore = _mm_cmpeq_epi8(chunk, underscore);
+        __m128i is_symbol = _mm_or_si128(_mm_or_si128(is_alpha, is_digit), is_underscore);
+        uint32_t other = ~(uint32_t)_mm_movemask_epi8(is_symbol) & 0xffff;
+        if (other != 0)
+            return (ptr - start) + ctzll(other);
+        ptr += 16;
+    }
+#endif
+    while (ptr < end && is_symbol_char(*ptr))
+        ptr += 1;
+    return ptr - start;
+}
+
+// Stops at the first of a, b or c.
+static size_t scan_until(const uint8_t *ptr, const uint8_t *end, uint8_t a, uint8_t b, uint8_t c) {
+    const uint8_t *start = ptr;
+#if defined(ZIG_TOKENIZER_SSE2)
+    const __m128i va = _mm_set1_epi8((char)a);
+    const __m128i vb = _mm_set1_epi8((char)b);
+    const __m128i vc = _mm_set1_epi8((char)c);
+    while (end - ptr >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)),
+                _mm_cmpeq_epi8(chunk, vc));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(hit);
+        if (mask != 0)
+            return (ptr - start) + ctzll(mask);
+        ptr += 16;
+    }
+#endif
+    while (ptr < end && *ptr != a && *ptr != b && *ptr != c)
+        ptr += 1;
+    return ptr - start;
+}
+
+static size_t scan_spaces(const uint8_t *ptr, const uint8_t *end) {
+    const uint8_t *start = ptr;
+#if defined(ZIG_TOKENIZER_SSE2)
+    const __m128i space = _mm_set1_epi8(' ');
+    while (end - ptr >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        uint32_t other = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, space)) & 0xffff;
+        if (other != 0)
+            return (ptr - start) + ctzll(other);
+        ptr += 16;
+    }
+#endif
+    while (ptr < end && *ptr == ' ')
+        ptr += 1;
+    return ptr - start;
+}
+
+// Moves t->pos over a run of bytes that the current state only steps over
+// or appends, so the state machine sees the byte that ends the run. None of
+// the runs contain a newline, so the line bookkeeping stays with the main loop.
+static void skip_run(Tokenize *t) {
+    const uint8_t *ptr = (const uint8_t *)buf_ptr(t->buf) + t->pos;
+    const uint8_t *end = (const uint8_t *)buf_ptr(t->buf) + buf_len(t->buf);
+    size_t len;
+    switch (t->state) {
+        case TokenizeStateStart:
+            len = scan_spaces(ptr, end);
+            break;
+        case TokenizeStateSymbol:
+            len = scan_symbol_chars(ptr, end);
+            break;
+        case TokenizeStateLineComment:
+            len = scan_until(ptr, end, '\n', '\n', '\n');
+            break;
+        case TokenizeStateString:
+            len = scan_until(ptr, end, '"', '\\', '\n');
+            if (!token_str_pending(t->cur_tok)) {
+                buf_append_mem(&t->cur_tok->data.str_lit.str, (const char *)ptr, len);
+            }
+            break;
+        case TokenizeStateLineString:
+            len = scan_until(ptr, end, '\n', '\n', '\n');
+            buf_append_mem(&t->cur_tok->data.str_lit.str, (const char *)ptr, len);
+            break;
+        default:
+            return;
+    }
+    t->pos += len;
+    t->column += (int)len;
+}
+
 void tokenize(Buf *buf, Tokenization *out) {
     Tokenize t = {0};
     t.out = out;
@@ -409,6 +560,9 @@ void tokenize(Buf *buf, Tokenization *out) {
 
     out->line_offsets->append(0);
     for (t.pos = 0; t.pos < buf_len(t.buf); t.pos += 1) {
+        skip_run(&t);
+        if (t.pos >= buf_len(t.buf))
+            break;
         uint8_t c = buf_ptr(t.buf)[t.pos];
         switch (t.state) {
             case TokenizeStateError:
@@ -420,13 +574,11 @@ void tokenize(Buf *buf, Tokenization *out) {
                     case 'c':
                         t.state = TokenizeStateSymbolFirstC;
                         begin_token(&t, TokenIdSymbol);
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
                         break;
                     case ALPHA_EXCEPT_C:
                     case '_':
                         t.state = TokenizeStateSymbol;
                         begin_token(&t, TokenIdSymbol);
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
                         break;
                     case '0':
                         t.state = TokenizeStateZero;
@@ -448,6 +600,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                         break;
                     case '"':
                         begin_token(&t, TokenIdStringLiteral);
+                        t.str_start = t.pos + 1;
                         t.state = TokenizeStateString;
                         break;
                     case '\'':
@@ -923,6 +1076,11 @@ void tokenize(Buf *buf, Tokenization *out) {
                 switch (c) {
                     case '\\':
                         t.state = TokenizeStateLineString;
+                        // Lines are joined with '\n' rather than the whitespace
+                        // and backslashes between them, so the contents are never
+                        // a span of the source.
+                        t.str_start = t.pos + 1;
+                        token_str(&t, t.str_start);
                         break;
                     default:
                         invalid_char_error(&t, c);
@@ -1003,6 +1161,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                     case '"':
                         set_token_id(&t, t.cur_tok, TokenIdStringLiteral);
                         t.cur_tok->data.str_lit.is_c_str = true;
+                        t.str_start = t.pos + 1;
                         t.state = TokenizeStateString;
                         break;
                     case '\\':
@@ -1012,7 +1171,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                         break;
                     case SYMBOL_CHAR:
                         t.state = TokenizeStateSymbol;
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
                         break;
                     default:
                         t.pos -= 1;
@@ -1025,6 +1183,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                 switch (c) {
                     case '"':
                         set_token_id(&t, t.cur_tok, TokenIdSymbol);
+                        t.str_start = t.pos + 1;
                         t.state = TokenizeStateString;
                         break;
                     default:
@@ -1037,7 +1196,6 @@ void tokenize(Buf *buf, Tokenization *out) {
             case TokenizeStateSymbol:
                 switch (c) {
                     case SYMBOL_CHAR:
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
                         break;
                     default:
                         t.pos -= 1;
@@ -1049,6 +1207,7 @@ void tokenize(Buf *buf, Tokenization *out) {
             case TokenizeStateString:
                 switch (c) {
                     case '"':
+                        token_str(&t, t.pos);
                         end_token(&t);
                         t.state = TokenizeStateStart;
                         break;
@@ -1056,10 +1215,13 @@ void tokenize(Buf *buf, Tokenization *out) {
                         tokenize_error(&t, "newline not allowed in string literal");
                         break;
                     case '\\':
+                        token_str(&t, t.pos);
                         t.state = TokenizeStateStringEscape;
                         break;
                     default:
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
+                        if (!token_str_pending(t.cur_tok)) {
+                            buf_append_char(&t.cur_tok->data.str_lit.str, c);
+                        }
                         break;
                 }
                 break;
@@ -1432,6 +1594,12 @@ void tokenize(Buf *buf, Tokenization *out) {
             break;
         case TokenizeStateSymbol:
         case TokenizeStateSymbolFirstC:
+            // pos is one past the last character of the symbol here. Ending the
+            // token there would count the null terminator as part of it, and a
+            // keyword at the end of the file would not be recognized.
+            t.pos -= 1;
+            end_token(&t);
+            break;
         case TokenizeStateZero:
         case TokenizeStateNumber:
         case TokenizeStateFloatFraction:
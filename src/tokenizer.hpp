@@ -179,6 +179,8 @@ typedef Token ZigToken;
 struct Tokenization {
     ZigList<Token> *tokens;
     ZigList<size_t> *line_offsets;
+    // total length of the identifier and string literal contents
+    size_t str_bytes_copied;
 
     // if an error occurred
     Buf *err;
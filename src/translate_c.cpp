@@ -75,6 +75,13 @@ struct TransScopeWhile {
     AstNode *node;
 };
 
+// Something a lazy import declares, to be translated when it is first used.
+// Exactly one of decl and macro_text is set.
+struct LazyCName {
+    const ZigClangDecl *decl;
+    const char *macro_text;
+};
+
 struct Context {
     AstNode *root;
     VisibMod visib_mod;
@@ -84,8 +91,16 @@ struct Context {
     HashMap<Buf *, AstNode *, buf_hash, buf_eql_buf> global_table;
     ZigClangSourceManager *source_manager;
     ZigList<Alias> aliases;
+    size_t aliases_rendered;
     bool warnings_on;
 
+    // A lazy import indexes every name the header declares, by the name
+    // translation gives it. The bare names of struct, union and enum tags
+    // are kept apart because they are only aliases.
+    bool is_lazy;
+    HashMap<Buf *, LazyCName, buf_hash, buf_eql_buf> lazy_names;
+    HashMap<Buf *, const ZigClangDecl *, buf_hash, buf_eql_buf> lazy_tag_names;
+
     CodeGen *codegen;
     ZigClangASTContext *ctx;
 
@@ -4630,7 +4645,10 @@ static bool decl_visitor(void *context, const ZigClangDecl *decl) {
 }
 
 static bool name_exists_global(Context *c, Buf *name) {
-    return get_global(c, name) != nullptr;
+    if (get_global(c, name) != nullptr)
+        return true;
+    // a lazy import has not translated most of its names yet
+    return c->is_lazy && c->lazy_names.maybe_get(name) != nullptr;
 }
 
 static bool name_exists_scope(Context *c, Buf *name, TransScope *scope) {
@@ -4710,8 +4728,8 @@ static TransScopeBlock *trans_scope_block_find(TransScope *scope) {
 }
 
 static void render_aliases(Context *c) {
-    for (size_t i = 0; i < c->aliases.length; i += 1) {
-        Alias *alias = &c->aliases.at(i);
+    for (; c->aliases_rendered < c->aliases.length; c->aliases_rendered += 1) {
+        Alias *alias = &c->aliases.at(c->aliases_rendered);
         if (name_exists_global(c, alias->new_name))
             continue;
 
@@ -4796,6 +4814,21 @@ static AstNode *trans_lookup_ast_maybe_fn(Context *c, AstNode *ref_node) {
     return fn_proto_node;
 }
 
+static void render_macro(Context *c, Buf *name, AstNode *value_node) {
+    AstNode *proto_node;
+    if (value_node->type == NodeTypeFnDef) {
+        add_top_level_decl(c, value_node->data.fn_def.fn_proto->data.fn_proto.name, value_node);
+    } else if ((proto_node = trans_lookup_ast_maybe_fn(c, value_node))) {
+        // If a macro aliases a global variable which is a function pointer, we conclude that
+        // the macro is intended to represent a function that assumes the function pointer
+        // variable is non-null and calls it.
+        AstNode *inline_fn_node = trans_create_node_inline_fn(c, name, value_node, proto_node);
+        add_top_level_decl(c, name, inline_fn_node);
+    } else {
+        add_global_var(c, name, value_node);
+    }
+}
+
 static void render_macros(Context *c) {
     auto it = c->macro_table.entry_iterator();
     for (;;) {
@@ -4803,19 +4836,7 @@ static void render_macros(Context *c) {
         if (!entry)
             break;
 
-        AstNode *proto_node;
-        AstNode *value_node = entry->value;
-        if (value_node->type == NodeTypeFnDef) {
-            add_top_level_decl(c, value_node->data.fn_def.fn_proto->data.fn_proto.name, value_node);
-        } else if ((proto_node = trans_lookup_ast_maybe_fn(c, value_node))) {
-            // If a macro aliases a global variable which is a function pointer, we conclude that
-            // the macro is intended to represent a function that assumes the function pointer
-            // variable is non-null and calls it.
-            AstNode *inline_fn_node = trans_create_node_inline_fn(c, entry->key, value_node, proto_node);
-            add_top_level_decl(c, entry->key, inline_fn_node);
-        } else {
-            add_global_var(c, entry->key, value_node);
-        }
+        render_macro(c, entry->key, entry->value);
     }
 }
 
@@ -5087,13 +5108,11 @@ static void process_preprocessor_entities(Context *c, ZigClangASTUnit *zunit) {
     }
 }
 
-Error parse_h_file(CodeGen *codegen, AstNode **out_root_node,
+static Error load_h_file(Context *c, CodeGen *codegen, ZigClangASTUnit **out_ast_unit,
         Stage2ErrorMsg **errors_ptr, size_t *errors_len,
         const char **args_begin, const char **args_end,
         Stage2TranslateMode mode, const char *resources_path)
 {
-    Context context = {0};
-    Context *c = &context;
     c->warnings_on = codegen->verbose_cimport;
     if (mode == Stage2TranslateModeImport) {
         c->visib_mod = VisibModPub;
@@ -5121,6 +5140,26 @@ Error parse_h_file(CodeGen *codegen, AstNode **out_root_node,
     c->root = trans_create_node(c, NodeTypeContainerDecl);
     c->root->data.container_decl.is_root = true;
 
+    *out_ast_unit = ast_unit;
+    return ErrorNone;
+}
+
+Error parse_h_file(CodeGen *codegen, AstNode **out_root_node,
+        Stage2ErrorMsg **errors_ptr, size_t *errors_len,
+        const char **args_begin, const char **args_end,
+        Stage2TranslateMode mode, const char *resources_path)
+{
+    Error err;
+    Context context = {0};
+    Context *c = &context;
+
+    ZigClangASTUnit *ast_unit;
+    if ((err = load_h_file(c, codegen, &ast_unit, errors_ptr, errors_len, args_begin, args_end,
+        mode, resources_path)))
+    {
+        return err;
+    }
+
     ZigClangASTUnit_visitLocalTopLevelDecls(ast_unit, c, decl_visitor);
 
     process_preprocessor_entities(c, ast_unit);
@@ -5134,3 +5173,182 @@ Error parse_h_file(CodeGen *codegen, AstNode **out_root_node,
 
     return ErrorNone;
 }
+
+struct CImportLazy {
+    Context context;
+    ZigClangASTUnit *ast_unit;
+    CTokenize ctok;
+};
+
+static void lazy_index_name(Context *c, Buf *name, const ZigClangDecl *decl, const char *macro_text) {
+    // the first declaration wins, as it does in parse_h_file
+    if (name_exists_global(c, name))
+        return;
+    c->lazy_names.put(name, {decl, macro_text});
+}
+
+static void lazy_index_tag_name(Context *c, const char *raw_name, const ZigClangDecl *decl) {
+    Buf *name = buf_create_from_str(raw_name);
+    if (c->lazy_tag_names.maybe_get(name) == nullptr) {
+        c->lazy_tag_names.put(name, decl);
+    }
+}
+
+static bool lazy_index_visitor(void *context, const ZigClangDecl *decl) {
+    Context *c = (Context*)context;
+    const char *raw_name = ZigClangDecl_getName_bytes_begin(decl);
+
+    switch (ZigClangDecl_getKind(decl)) {
+        case ZigClangDeclFunction:
+        case ZigClangDeclTypedef:
+        case ZigClangDeclVar:
+            lazy_index_name(c, buf_create_from_str(raw_name), decl, nullptr);
+            break;
+        case ZigClangDeclEnum:
+            {
+                if (raw_name[0] != 0) {
+                    lazy_index_name(c, buf_sprintf("enum_%s", raw_name), decl, nullptr);
+                    lazy_index_tag_name(c, raw_name, decl);
+                }
+                // resolve_enum_decl declares every value in the global namespace too
+                const ZigClangEnumDecl *enum_def =
+                    ZigClangEnumDecl_getDefinition(reinterpret_cast<const ZigClangEnumDecl *>(decl));
+                if (enum_def == nullptr)
+                    break;
+                for (auto it = reinterpret_cast<const clang::EnumDecl *>(enum_def)->enumerator_begin(),
+                          it_end = reinterpret_cast<const clang::EnumDecl *>(enum_def)->enumerator_end();
+                          it != it_end; ++it)
+                {
+                    const clang::EnumConstantDecl *enum_const = *it;
+                    lazy_index_name(c,
+                        buf_create_from_str(ZigClangDecl_getName_bytes_begin((const ZigClangDecl *)enum_const)),
+                        decl, nullptr);
+                }
+                break;
+            }
+        case ZigClangDeclRecord:
+            {
+                const ZigClangRecordDecl *record_decl = reinterpret_cast<const ZigClangRecordDecl *>(decl);
+                if (raw_name[0] == 0 || ZigClangRecordDecl_isAnonymousStructOrUnion(record_decl))
+                    break;
+                const char *container_kind_name;
+                if (ZigClangRecordDecl_isUnion(record_decl)) {
+                    container_kind_name = "union";
+                } else if (ZigClangRecordDecl_isStruct(record_decl)) {
+                    container_kind_name = "struct";
+                } else {
+                    break;
+                }
+                lazy_index_name(c, buf_sprintf("%s_%s", container_kind_name, raw_name), decl, nullptr);
+                lazy_index_tag_name(c, raw_name, decl);
+                break;
+            }
+        default:
+            break;
+    }
+
+    return true;
+}
+
+static void lazy_index_macros(Context *c, ZigClangASTUnit *zunit) {
+    clang::ASTUnit *unit = reinterpret_cast<clang::ASTUnit *>(zunit);
+
+    for (clang::PreprocessedEntity *entity : unit->getLocalPreprocessingEntities()) {
+        if (entity->getKind() != clang::PreprocessedEntity::MacroDefinitionKind)
+            continue;
+
+        clang::MacroDefinitionRecord *macro = static_cast<clang::MacroDefinitionRecord *>(entity);
+        clang::SourceRange range = macro->getSourceRange();
+        ZigClangSourceLocation begin_loc = bitcast(range.getBegin());
+        ZigClangSourceLocation end_loc = bitcast(range.getEnd());
+        if (ZigClangSourceLocation_eq(begin_loc, end_loc)) {
+            // a macro without a value, see process_preprocessor_entities
+            continue;
+        }
+
+        const char *begin_c = ZigClangSourceManager_getCharacterData(c->source_manager, begin_loc);
+        lazy_index_name(c, buf_create_from_str(macro->getName()->getNameStart()), nullptr, begin_c);
+    }
+}
+
+Error parse_h_file_lazy(CodeGen *codegen, CImportLazy **out_lazy,
+        Stage2ErrorMsg **errors_ptr, size_t *errors_len,
+        const char **args_begin, const char **args_end, const char *resources_path)
+{
+    Error err;
+    CImportLazy *lazy = allocate<CImportLazy>(1);
+    Context *c = &lazy->context;
+
+    if ((err = load_h_file(c, codegen, &lazy->ast_unit, errors_ptr, errors_len, args_begin, args_end,
+        Stage2TranslateModeImport, resources_path)))
+    {
+        return err;
+    }
+
+    c->is_lazy = true;
+    c->lazy_names.init(8);
+    c->lazy_tag_names.init(8);
+
+    // Declarations go first so that they win over macros of the same name.
+    ZigClangASTUnit_visitLocalTopLevelDecls(lazy->ast_unit, c, lazy_index_visitor);
+    lazy_index_macros(c, lazy->ast_unit);
+
+    // The AST unit stays alive for as long as names may be looked up.
+    *out_lazy = lazy;
+    return ErrorNone;
+}
+
+static void lazy_translate_name(CImportLazy *lazy, Buf *name);
+
+static void lazy_translate_macro(CImportLazy *lazy, Buf *name, const char *macro_text) {
+    Context *c = &lazy->context;
+    process_macro(c, &lazy->ctok, name, macro_text);
+    auto entry = c->macro_table.maybe_get(name);
+    if (entry == nullptr)
+        return;
+
+    // render_macro looks at the type of the variable a macro names, so that
+    // variable has to be translated first.
+    AstNode *ref_node = entry->value;
+    while (ref_node->type == NodeTypeFieldAccessExpr) {
+        ref_node = ref_node->data.field_access_expr.struct_expr;
+    }
+    if (ref_node->type == NodeTypeSymbol) {
+        lazy_translate_name(lazy, ref_node->data.symbol_expr.symbol);
+    }
+
+    render_macro(c, name, entry->value);
+}
+
+static void lazy_translate_name(CImportLazy *lazy, Buf *name) {
+    Context *c = &lazy->context;
+    if (get_global(c, name) != nullptr)
+        return;
+
+    auto entry = c->lazy_names.maybe_get(name);
+    if (entry != nullptr) {
+        if (entry->value.decl != nullptr) {
+            decl_visitor(c, entry->value.decl);
+        } else {
+            lazy_translate_macro(lazy, name, entry->value.macro_text);
+        }
+    } else {
+        auto tag_entry = c->lazy_tag_names.maybe_get(name);
+        if (tag_entry == nullptr)
+            return;
+        decl_visitor(c, tag_entry->value);
+    }
+
+    render_aliases(c);
+}
+
+void translate_c_lazy_name(CImportLazy *lazy, Buf *name, ZigList<AstNode *> *out_decls) {
+    ZigList<AstNode *> *decls = &lazy->context.root->data.container_decl.decls;
+    size_t first_new_decl = decls->length;
+
+    lazy_translate_name(lazy, name);
+
+    for (size_t i = first_new_decl; i < decls->length; i += 1) {
+        out_decls->append(decls->at(i));
+    }
+}
@@ -16,4 +16,16 @@ Error parse_h_file(CodeGen *codegen, AstNode **out_root_node,
         const char **args_begin, const char **args_end,
         Stage2TranslateMode mode, const char *resources_path);
 
+// An @cImport translated one name at a time, for --lazy-cimport.
+struct CImportLazy;
+
+Error parse_h_file_lazy(CodeGen *codegen, CImportLazy **out_lazy,
+        Stage2ErrorMsg **errors_ptr, size_t *errors_len,
+        const char **args_begin, const char **args_end, const char *resources_path);
+
+// Appends the top level declarations translated for name, including those of
+// the types it needs that were not translated yet. Appends nothing when the
+// header does not declare name or it was translated before.
+void translate_c_lazy_name(CImportLazy *lazy, Buf *name, ZigList<AstNode *> *out_decls);
+
 #endif
@@ -29,15 +29,34 @@ void assert(bool ok) {
     }
 }
 
+uint32_t hash_bytes(const void *ptr, size_t len) {
+    const uint8_t *bytes = (const uint8_t *)ptr;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ ((uint64_t)len * 0xff51afd7ed558ccdULL);
+    // One multiply per 8 bytes; the final mix takes care of avalanche.
+    for (; len >= 8; bytes += 8, len -= 8) {
+        uint64_t word;
+        memcpy(&word, bytes, 8);
+        h ^= word * 0xc4ceb9fe1a85ec53ULL;
+        h = ((h << 27) | (h >> 37)) * 0x9e3779b97f4a7c15ULL;
+    }
+    if (len != 0) {
+        uint64_t word = 0;
+        memcpy(&word, bytes, len);
+        h ^= word * 0xc4ceb9fe1a85ec53ULL;
+        h = ((h << 27) | (h >> 37)) * 0x9e3779b97f4a7c15ULL;
+    }
+    return hash_mix64(h);
+}
+
 uint32_t int_hash(int i) {
-    return (uint32_t)(i % UINT32_MAX);
+    return hash_mix64((uint64_t)(uint32_t)i);
 }
 bool int_eq(int a, int b) {
     return a == b;
 }
 
 uint32_t uint64_hash(uint64_t i) {
-    return (uint32_t)(i % UINT32_MAX);
+    return hash_mix64(i);
 }
 
 bool uint64_eq(uint64_t a, uint64_t b) {
@@ -45,7 +64,7 @@ bool uint64_eq(uint64_t a, uint64_t b) {
 }
 
 uint32_t ptr_hash(const void *ptr) {
-    return (uint32_t)(((uintptr_t)ptr) % UINT32_MAX);
+    return hash_mix64((uint64_t)(uintptr_t)ptr);
 }
 
 bool ptr_eq(const void *a, const void *b) {
@@ -191,6 +191,21 @@ static inline uint64_t round_to_next_power_of_2(uint64_t x) {
     return x + 1;
 }
 
+// The murmur3 64-bit finalizer. Every input bit affects both the low bits
+// and the high bits of the result, which HashMap uses for the slot tag and
+// the group index respectively. Pointers and small integers are not good
+// hashes on their own since their low bits are mostly alignment or zero.
+static inline uint32_t hash_mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return (uint32_t)x;
+}
+
+uint32_t hash_bytes(const void *ptr, size_t len);
+
 uint32_t int_hash(int i);
 bool int_eq(int a, int b);
 uint32_t uint64_hash(uint64_t i);
@@ -22,6 +22,7 @@
 
 #include <llvm/Analysis/TargetLibraryInfo.h>
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/DiagnosticInfo.h>
 #include <llvm/IR/IRBuilder.h>
@@ -39,6 +40,7 @@
 #include <llvm/Support/TargetParser.h>
 #include <llvm/Support/Timer.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
 #include <llvm/Support/TargetRegistry.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/CodeGenCWrappers.h>
@@ -48,6 +50,8 @@
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include <llvm/Transforms/Scalar.h>
 #include <llvm/Transforms/Utils.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
 
 #include <lld/Common/Driver.h>
 
@@ -150,12 +154,14 @@ LLVMTargetMachineRef ZigLLVMCreateTargetMachine(LLVMTargetRef T, const char *Tri
     return reinterpret_cast<LLVMTargetMachineRef>(TM);
 }
 
+void ZigLLVMSetTimePasses(bool enabled) {
+    TimePassesIsEnabled = enabled;
+}
+
 bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
         const char *filename, ZigLLVM_EmitOutputType output_type, char **error_message, bool is_debug,
-        bool is_small, bool time_report)
+        bool is_small, bool time_report, const char *pgo_instr_gen, const char *pgo_instr_use)
 {
-    TimePassesIsEnabled = time_report;
-
     std::error_code EC;
     raw_fd_ostream dest(filename, EC, sys::fs::F_None);
     if (EC) {
@@ -188,12 +194,20 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
     PMBuilder->VerifyOutput = assertions_on;
     PMBuilder->MergeFunctions = !is_debug;
     PMBuilder->PrepareForLTO = false;
-    PMBuilder->PrepareForThinLTO = false;
+    PMBuilder->PrepareForThinLTO = output_type == ZigLLVM_EmitThinLTOBitcode;
     PMBuilder->PerformThinLTO = false;
 
     TargetLibraryInfoImpl tlii(Triple(module->getTargetTriple()));
     PMBuilder->LibraryInfo = &tlii;
 
+    // Only the optimizing pipeline adds the PGO passes.
+    if (pgo_instr_gen != nullptr) {
+        PMBuilder->PGOInstrGen = pgo_instr_gen;
+    }
+    if (pgo_instr_use != nullptr) {
+        PMBuilder->PGOInstrUse = pgo_instr_use;
+    }
+
     if (is_debug) {
         PMBuilder->Inliner = createAlwaysInlinerLegacyPass(false);
     } else {
@@ -222,7 +236,9 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
 
     // Set output pass.
     TargetMachine::CodeGenFileType ft;
-    if (output_type != ZigLLVM_EmitLLVMIr) {
+    if (output_type == ZigLLVM_EmitThinLTOBitcode) {
+        MPM.add(createWriteThinLTOBitcodePass(dest));
+    } else if (output_type != ZigLLVM_EmitLLVMIr) {
         switch (output_type) {
             case ZigLLVM_EmitAssembly:
                 ft = TargetMachine::CGFT_AssemblyFile;
@@ -261,6 +277,67 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
     return false;
 }
 
+size_t ZigLLVMSplitModule(LLVMModuleRef module_ref, size_t unit_count, ZigLLVMSplitModulePartFn part_fn,
+        void *context)
+{
+    Module *module = unwrap(module_ref);
+
+    legacy::PassManager MPM;
+    MPM.add(createAlwaysInlinerLegacyPass(false));
+    MPM.run(*module);
+
+    // SplitModule would name the unnamed globals, such as string literals,
+    // by their order in the module, so adding one would rename all that
+    // follow it along with every unit that uses them. Name them by their
+    // contents instead. Literals that point at other literals come after
+    // them, so those are already named when they are printed.
+    std::unique_ptr<Module> split_module = CloneModule(*module);
+    for (GlobalVariable &global : split_module->globals()) {
+        if (global.hasName() || !global.hasInitializer())
+            continue;
+        std::string contents;
+        raw_string_ostream os(contents);
+        global.getInitializer()->print(os);
+        os.flush();
+        global.setName("__unnamed_" + utohexstr(xxHash64(contents)));
+    }
+
+    size_t part_count = 0;
+    SplitModule(std::move(split_module), unit_count, [&](std::unique_ptr<Module> part) {
+        // Each part declares every global of the module, and the locals that
+        // SplitModule promoted are hidden. Drop the declarations a part does
+        // not use: an unused thread local one is emitted as an untyped symbol
+        // that the linker rejects against the definition.
+        for (auto it = part->global_begin(); it != part->global_end();) {
+            GlobalVariable &global = *it++;
+            global.removeDeadConstantUsers();
+            if (global.isDeclaration() && global.use_empty())
+                global.eraseFromParent();
+        }
+        for (auto it = part->begin(); it != part->end();) {
+            Function &fn = *it++;
+            fn.removeDeadConstantUsers();
+            if (fn.isDeclaration() && fn.use_empty())
+                fn.eraseFromParent();
+        }
+        SmallString<0> bitcode;
+        raw_svector_ostream os(bitcode);
+        WriteBitcodeToFile(*part, os);
+        part_fn(context, LLVMCreateMemoryBufferWithMemoryRangeCopy(bitcode.data(), bitcode.size(),
+                part->getModuleIdentifier().c_str()));
+        part_count += 1;
+    }, false);
+    return part_count;
+}
+
+LLVMTargetMachineRef ZigLLVMCloneTargetMachine(LLVMTargetMachineRef targ_machine_ref) {
+    TargetMachine *TM = reinterpret_cast<TargetMachine*>(targ_machine_ref);
+    TargetMachine *clone = TM->getTarget().createTargetMachine(TM->getTargetTriple().str(),
+            TM->getTargetCPU(), TM->getTargetFeatureString(), TM->Options,
+            TM->getRelocationModel(), TM->getCodeModel(), TM->getOptLevel());
+    return reinterpret_cast<LLVMTargetMachineRef>(clone);
+}
+
 ZIG_EXTERN_C LLVMTypeRef ZigLLVMTokenTypeInContext(LLVMContextRef context_ref) {
   return wrap(Type::getTokenTy(*unwrap(context_ref)));
 }
@@ -52,11 +52,34 @@ enum ZigLLVM_EmitOutputType {
     ZigLLVM_EmitAssembly,
     ZigLLVM_EmitBinary,
     ZigLLVM_EmitLLVMIr,
+    // Bitcode with a ThinLTO summary, optimized with the pre-link pipeline.
+    ZigLLVM_EmitThinLTOBitcode,
 };
 
+/// Sets whether passes record their time. This is global LLVM state, so call it before
+/// any thread runs passes.
+ZIG_EXTERN_C void ZigLLVMSetTimePasses(bool enabled);
+
+/// time_report prints the pass times recorded since ZigLLVMSetTimePasses enabled them.
+/// pgo_instr_gen is the profile path instrumentation writes to, and pgo_instr_use the .profdata
+/// file that guides optimization. Either may be null. Neither has an effect when is_debug.
 ZIG_EXTERN_C bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
         const char *filename, enum ZigLLVM_EmitOutputType output_type, char **error_message, bool is_debug,
-        bool is_small, bool time_report);
+        bool is_small, bool time_report, const char *pgo_instr_gen, const char *pgo_instr_use);
+
+/// Partitions the module by function into at most unit_count parts, serialized as bitcode so that
+/// each can be parsed into its own LLVMContext and emitted on its own thread. Internal symbols are
+/// promoted to hidden external ones so that references across parts still resolve at link time.
+/// Always-inline functions are inlined into the module first because calls to them cannot cross parts.
+/// part_fn is called on the calling thread with each part as soon as it is serialized, so the caller
+/// can start emitting it while the remaining parts are split off; it must free the part with
+/// LLVMDisposeMemoryBuffer. Returns the number of parts.
+typedef void (*ZigLLVMSplitModulePartFn)(void *context, LLVMMemoryBufferRef bitcode);
+ZIG_EXTERN_C size_t ZigLLVMSplitModule(LLVMModuleRef module_ref, size_t unit_count,
+        ZigLLVMSplitModulePartFn part_fn, void *context);
+
+/// Creates a target machine with the same settings as targ_machine_ref, for use on another thread.
+ZIG_EXTERN_C LLVMTargetMachineRef ZigLLVMCloneTargetMachine(LLVMTargetMachineRef targ_machine_ref);
 
 ZIG_EXTERN_C LLVMTargetMachineRef ZigLLVMCreateTargetMachine(LLVMTargetRef T, const char *Triple,
     const char *CPU, const char *Features, LLVMCodeGenOptLevel Level, LLVMRelocMode Reloc,
@@ -216,6 +216,10 @@ pub fn kill(pid: pid_t, sig: u8) KillError!void {
 
 /// Exits the program cleanly with the specified status code.
 pub fn exit(status: u8) noreturn {
+    if (builtin.profile_generate_file != null and !builtin.link_libc) {
+        // With libc, start.zig registers the writer with atexit instead.
+        @import("special/profile_rt.zig").writeFile();
+    }
     if (builtin.link_libc) {
         system.exit(status);
     }
@@ -0,0 +1,176 @@
+// Writes the counters of -fprofile-generate instrumentation to a .profraw
+// file, which `llvm-profdata merge` turns into the input of -fprofile-use.
+// The profile is written when the program exits normally: by returning from
+// main or calling std.os.exit, or exit() when libc is linked. A program that
+// aborts, panics or dies from a signal writes no profile.
+//
+// This is the part of compiler-rt's profile runtime that Zig programs need.
+// Value profiling is turned off when instrumenting, so a profile is the
+// header followed by copies of the sections the instrumentation emits.
+
+const std = @import("std");
+const builtin = @import("builtin");
+
+// The linker defines these around the sections of the same name.
+extern var __start___llvm_prf_data: u8;
+extern var __stop___llvm_prf_data: u8;
+extern var __start___llvm_prf_cnts: u8;
+extern var __stop___llvm_prf_cnts: u8;
+extern var __start___llvm_prf_names: u8;
+extern var __stop___llvm_prf_names: u8;
+
+// LLVM 8's raw format version, marked as coming from IR-level instrumentation.
+// The instrumentation defines __llvm_profile_raw_version with this value, but
+// declaring it here would make the instrumentation of this module rename its
+// own definition.
+const raw_version: u64 = (1 << 56) | 4;
+
+const value_kind_last = 1;
+
+// The layout of __llvm_profile_data in LLVM 8.
+const ProfileData = extern struct {
+    name_ref: u64,
+    func_hash: u64,
+    counter_ptr: usize,
+    function_pointer: usize,
+    values: usize,
+    num_counters: u32,
+    num_value_sites: [value_kind_last + 1]u16,
+};
+
+const RawHeader = extern struct {
+    magic: u64,
+    version: u64,
+    data_size: u64,
+    counters_size: u64,
+    names_size: u64,
+    counters_delta: u64,
+    names_delta: u64,
+    value_kind_last: u64,
+};
+
+const raw_magic: u64 = (255 << 56) | ('l' << 48) | ('p' << 40) | ('r' << 32) | ('o' << 24) | ('f' << 16) |
+    ((if (@sizeOf(usize) == 8) 'r' else 'R') << 8) | 129;
+
+const Section = struct {
+    begin: usize,
+    end: usize,
+
+    fn bytes(self: Section) []const u8 {
+        return @intToPtr([*]const u8, self.begin)[0 .. self.end - self.begin];
+    }
+};
+
+/// LLVM_PROFILE_FILE overrides the path given to -fprofile-generate.
+pub fn writeFile() void {
+    const path = std.os.getenv("LLVM_PROFILE_FILE") orelse builtin.profile_generate_file.?;
+    const file = std.fs.File.openWrite(path) catch |err| {
+        std.debug.warn("unable to open profile '{}': {}\n", path, @errorName(err));
+        return;
+    };
+    defer file.close();
+    const data = Section{
+        .begin = @ptrToInt(&__start___llvm_prf_data),
+        .end = @ptrToInt(&__stop___llvm_prf_data),
+    };
+    const counters = Section{
+        .begin = @ptrToInt(&__start___llvm_prf_cnts),
+        .end = @ptrToInt(&__stop___llvm_prf_cnts),
+    };
+    const names = Section{
+        .begin = @ptrToInt(&__start___llvm_prf_names),
+        .end = @ptrToInt(&__stop___llvm_prf_names),
+    };
+    var file_stream = file.outStream();
+    writeRaw(std.fs.File.WriteError, &file_stream.stream, data, counters, names) catch |err| {
+        std.debug.warn("unable to write profile '{}': {}\n", path, @errorName(err));
+    };
+}
+
+/// Registered with atexit when libc is linked, like compiler-rt's
+/// __llvm_profile_register_write_file_atexit.
+pub extern fn writeFileAtExit() void {
+    writeFile();
+}
+
+fn writeRaw(
+    comptime Error: type,
+    out: *std.io.OutStream(Error),
+    data: Section,
+    counters: Section,
+    names: Section,
+) Error!void {
+    const header = RawHeader{
+        .magic = raw_magic,
+        .version = raw_version,
+        .data_size = (data.end - data.begin) / @sizeOf(ProfileData),
+        .counters_size = (counters.end - counters.begin) / @sizeOf(u64),
+        .names_size = names.end - names.begin,
+        .counters_delta = counters.begin,
+        .names_delta = names.begin,
+        .value_kind_last = value_kind_last,
+    };
+
+    try out.write(std.mem.asBytes(&header));
+    try out.write(data.bytes());
+    try out.write(counters.bytes());
+    try out.write(names.bytes());
+    // The reader expects whatever follows the names to be 8-byte aligned.
+    const padding = [_]u8{0} ** 8;
+    try out.write(padding[0 .. (8 - header.names_size % 8) % 8]);
+}
+
+fn sliceSection(bytes: []const u8) Section {
+    return Section{
+        .begin = @ptrToInt(bytes.ptr),
+        .end = @ptrToInt(bytes.ptr) + bytes.len,
+    };
+}
+
+test "writeRaw" {
+    const data = [_]ProfileData{
+        ProfileData{
+            .name_ref = 0x1234,
+            .func_hash = 0x5678,
+            .counter_ptr = 0,
+            .function_pointer = 0,
+            .values = 0,
+            .num_counters = 2,
+            .num_value_sites = [_]u16{ 0, 0 },
+        },
+    };
+    const counters = [_]u64{ 7, 9 };
+    const names = "abc";
+
+    var buf: [256]u8 = undefined;
+    var slice_stream = std.io.SliceOutStream.init(buf[0..]);
+    try writeRaw(
+        std.io.SliceOutStream.Error,
+        &slice_stream.stream,
+        sliceSection(@sliceToBytes(data[0..])),
+        sliceSection(@sliceToBytes(counters[0..])),
+        sliceSection(names[0..]),
+    );
+    const written = slice_stream.getWritten();
+
+    const header_size = @sizeOf(RawHeader);
+    const data_size = @sizeOf(ProfileData);
+    std.testing.expect(written.len == header_size + data_size + 16 + 8);
+    std.testing.expect(written.len % 8 == 0);
+
+    var header: RawHeader = undefined;
+    std.mem.copy(u8, std.mem.asBytes(&header), written[0..header_size]);
+    std.testing.expect(header.magic == raw_magic);
+    std.testing.expect(header.version == raw_version);
+    std.testing.expect(header.data_size == 1);
+    std.testing.expect(header.counters_size == 2);
+    std.testing.expect(header.names_size == 3);
+    std.testing.expect(header.counters_delta == @ptrToInt(&counters));
+    std.testing.expect(header.names_delta == @ptrToInt(&names));
+    std.testing.expect(header.value_kind_last == value_kind_last);
+
+    const body = written[header_size..];
+    std.testing.expect(std.mem.eql(u8, body[0..data_size], @sliceToBytes(data[0..])));
+    std.testing.expect(std.mem.eql(u8, body[data_size .. data_size + 16], @sliceToBytes(counters[0..])));
+    std.testing.expect(std.mem.eql(u8, body[data_size + 16 ..], "abc\x00\x00\x00\x00\x00"));
+}
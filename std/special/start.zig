@@ -112,6 +112,9 @@ extern fn main(c_argc: i32, c_argv: [*][*]u8, c_envp: [*]?[*]u8) i32 {
     var env_count: usize = 0;
     while (c_envp[env_count] != null) : (env_count += 1) {}
     const envp = @ptrCast([*][*]u8, c_envp)[0..env_count];
+    if (builtin.profile_generate_file != null) {
+        _ = std.c.atexit(@import("profile_rt.zig").writeFileAtExit);
+    }
     return callMainWithArgs(@intCast(usize, c_argc), c_argv, envp);
 }
 
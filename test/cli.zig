@@ -34,6 +34,15 @@ pub fn main() !void {
         testZigInitLib,
         testZigInitExe,
         testGodboltApi,
+        testComptimeCache,
+        testComptimeCacheBounded,
+        testPackedArrayStores,
+        testServer,
+        testThinLto,
+        testCPch,
+        testLazyCImport,
+        testCodegenUnits,
+        testCodegenUnitCache,
     };
     for (test_fns) |testFn| {
         try fs.deleteTree(a, dir_path);
@@ -58,8 +67,12 @@ fn printCmd(cwd: []const u8, argv: []const []const u8) void {
 }
 
 fn exec(cwd: []const u8, argv: []const []const u8) !ChildProcess.ExecResult {
+    return execEnv(cwd, argv, null);
+}
+
+fn execEnv(cwd: []const u8, argv: []const []const u8, env_map: ?*const std.BufMap) !ChildProcess.ExecResult {
     const max_output_size = 100 * 1024;
-    const result = ChildProcess.exec(a, argv, cwd, null, max_output_size) catch |err| {
+    const result = ChildProcess.exec(a, argv, cwd, env_map, max_output_size) catch |err| {
         std.debug.warn("The following command failed:\n");
         printCmd(cwd, argv);
         return err;
@@ -129,3 +142,412 @@ fn testGodboltApi(zig_exe: []const u8, dir_path: []const u8) anyerror!void {
     testing.expect(std.mem.indexOf(u8, out_asm, "mov\teax, edi") != null);
     testing.expect(std.mem.indexOf(u8, out_asm, "imul\teax, edi") != null);
 }
+
+// Reads the number at the start of the -ftime-report line that contains suffix.
+fn timeReportCount(report: []const u8, suffix: []const u8) !usize {
+    const end = std.mem.indexOf(u8, report, suffix) orelse return error.MissingTimeReport;
+    const start = if (std.mem.lastIndexOfScalar(u8, report[0..end], '\n')) |i| i + 1 else 0;
+    return std.fmt.parseInt(usize, report[start..end], 10);
+}
+
+fn testComptimeCache(zig_exe: []const u8, dir_path: []const u8) !void {
+    const test_zig_path = try fs.path.join(a, [_][]const u8{ dir_path, "test.zig" });
+    const words_zig_path = try fs.path.join(a, [_][]const u8{ dir_path, "words.zig" });
+    const words_txt_path = try fs.path.join(a, [_][]const u8{ dir_path, "words.txt" });
+    const args = [_][]const u8{ zig_exe, "test", test_zig_path, "--cache-dir", dir_path, "-ftime-report" };
+    const loads_suffix = " comptime calls loaded from the cache";
+
+    try std.io.writeFile(words_zig_path,
+        \\pub fn count() usize {
+        \\    const words = @embedFile("words.txt");
+        \\    var n: usize = 0;
+        \\    for (words) |c| {
+        \\        if (c == ' ') n += 1;
+        \\    }
+        \\    return n;
+        \\}
+    );
+    try std.io.writeFile(words_txt_path, "a b c ");
+    try std.io.writeFile(test_zig_path,
+        \\const words = @import("words.zig");
+        \\test "count" {
+        \\    comptime @import("std").testing.expect(words.count() == 3);
+        \\}
+    );
+    const first_loads = try timeReportCount((try exec(dir_path, args)).stdout, loads_suffix);
+    testing.expect(first_loads == 0);
+
+    // Editing a file that words.count does not depend on keeps its entry.
+    try std.io.writeFile(test_zig_path,
+        \\const words = @import("words.zig");
+        \\test "count" {
+        \\    comptime @import("std").testing.expect(words.count() == 3);
+        \\    comptime @import("std").testing.expect(words.count() != 4);
+        \\}
+    );
+    const hit_loads = try timeReportCount((try exec(dir_path, args)).stdout, loads_suffix);
+
+    // Editing the file it embeds does not.
+    try std.io.writeFile(words_txt_path, "a b c d ");
+    try std.io.writeFile(test_zig_path,
+        \\const words = @import("words.zig");
+        \\test "count" {
+        \\    comptime @import("std").testing.expect(words.count() == 4);
+        \\    comptime @import("std").testing.expect(words.count() != 3);
+        \\}
+    );
+    const miss_loads = try timeReportCount((try exec(dir_path, args)).stdout, loads_suffix);
+    testing.expect(hit_loads == miss_loads + 1);
+}
+
+fn testComptimeCacheBounded(zig_exe: []const u8, dir_path: []const u8) !void {
+    // The same as comptime_cache_max_entries in src/ir.cpp.
+    const max_entries = 16384;
+    const entries_path = try fs.path.join(a, [_][]const u8{ dir_path, "ce" });
+    const test_zig_path = try fs.path.join(a, [_][]const u8{ dir_path, "test.zig" });
+    const args = [_][]const u8{ zig_exe, "test", test_zig_path, "--cache-dir", dir_path };
+
+    // Entries that earlier builds stored and last used long ago.
+    try fs.makeDir(entries_path);
+    var i: usize = 0;
+    while (i < max_entries + 16) : (i += 1) {
+        const name = try std.fmt.allocPrint(a, "stale{}", i);
+        const file = try fs.File.openWrite(try fs.path.join(a, [_][]const u8{ entries_path, name }));
+        defer file.close();
+        try file.updateTimes(0, 0);
+    }
+
+    try std.io.writeFile(test_zig_path,
+        \\fn sum(n: usize) usize {
+        \\    var total: usize = 0;
+        \\    var i: usize = 0;
+        \\    while (i < n) : (i += 1) total += i;
+        \\    return total;
+        \\}
+        \\test "sum" {
+        \\    comptime @import("std").testing.expect(sum(10) == 45);
+        \\}
+    );
+    _ = try exec(dir_path, args);
+
+    var entry_count: usize = 0;
+    var stored_count: usize = 0;
+    var dir = try fs.Dir.open(a, entries_path);
+    defer dir.close();
+    while (try dir.next()) |entry| {
+        entry_count += 1;
+        if (!std.mem.startsWith(u8, entry.name, "stale")) stored_count += 1;
+    }
+    testing.expect(entry_count <= max_entries);
+    testing.expect(stored_count != 0);
+}
+
+fn packedArraysExpanded(zig_exe: []const u8, dir_path: []const u8, source: []const u8) !usize {
+    const source_path = try fs.path.join(a, [_][]const u8{ dir_path, "packed.zig" });
+    try std.io.writeFile(source_path, source);
+    const args = [_][]const u8{ zig_exe, "build-obj", source_path, "--cache", "off", "-ftime-report" };
+    return timeReportCount((try exec(dir_path, args)).stdout, " packed u8 arrays expanded");
+}
+
+fn testPackedArrayStores(zig_exe: []const u8, dir_path: []const u8) !void {
+    const read_only = try packedArraysExpanded(zig_exe, dir_path,
+        \\export fn f() u8 {
+        \\    return comptime g();
+        \\}
+        \\fn g() u8 {
+        \\    var a = "hello";
+        \\    return a[0] +% a[4];
+        \\}
+    );
+    const stored = try packedArraysExpanded(zig_exe, dir_path,
+        \\export fn f() u8 {
+        \\    return comptime g();
+        \\}
+        \\fn g() u8 {
+        \\    var a = "hello";
+        \\    a[0] = 'j';
+        \\    a[4] = 'y';
+        \\    return a[0] +% a[4];
+        \\}
+    );
+    const sliced = try packedArraysExpanded(zig_exe, dir_path,
+        \\export fn f() u8 {
+        \\    return comptime g();
+        \\}
+        \\fn g() u8 {
+        \\    var a = "hello";
+        \\    const s = a[1..4];
+        \\    return s[0] +% s[2];
+        \\}
+    );
+    testing.expect(stored == read_only);
+    testing.expect(sliced == read_only);
+}
+
+fn buildAsm(zig_exe: []const u8, dir_path: []const u8, out_dir: []const u8, env_map: ?*const std.BufMap) ![]u8 {
+    const source_path = try fs.path.join(a, [_][]const u8{ dir_path, "served.zig" });
+    const out_path = try fs.path.join(a, [_][]const u8{ dir_path, out_dir });
+    const asm_path = try fs.path.join(a, [_][]const u8{ out_path, "served.s" });
+    try fs.makeDir(out_path);
+    const args = [_][]const u8{
+        zig_exe,     "build-obj",
+        source_path, "--output-dir",
+        out_path,    "--emit",
+        "asm",       "--cache",
+        "off",       "--strip",
+    };
+    _ = try execEnv(dir_path, args, env_map);
+    return std.io.readFileAlloc(a, asm_path);
+}
+
+fn testServer(zig_exe: []const u8, dir_path: []const u8) !void {
+    if (builtin.os != .linux) return;
+
+    const source_path = try fs.path.join(a, [_][]const u8{ dir_path, "served.zig" });
+    const socket_path = try fs.path.join(a, [_][]const u8{ dir_path, "zig.sock" });
+    try std.io.writeFile(source_path,
+        \\const std = @import("std");
+        \\export fn sum(n: u32) u32 {
+        \\    var total: u32 = 0;
+        \\    var i: u32 = 0;
+        \\    while (i < n) : (i += 1) total +%= std.math.rotl(u32, i, 3);
+        \\    return total;
+        \\}
+    );
+    const direct = try buildAsm(zig_exe, dir_path, "direct", null);
+
+    const server = try ChildProcess.init([_][]const u8{ zig_exe, "server", socket_path }, a);
+    server.cwd = dir_path;
+    server.stdin_behavior = .Ignore;
+    server.stdout_behavior = .Ignore;
+    server.stderr_behavior = .Pipe;
+    try server.spawn();
+    defer _ = server.kill() catch undefined;
+    // The server reports that it is listening once std is parsed.
+    const listening = try server.stderr.?.inStream().stream.readUntilDelimiterAlloc(a, '\n', 4096);
+    testing.expect(std.mem.startsWith(u8, listening, "Listening on "));
+
+    // Only the owner may connect.
+    const socket_path_c = try std.cstr.addNullByte(a, socket_path);
+    var stat: std.os.linux.Stat = undefined;
+    testing.expect(std.os.linux.stat(socket_path_c.ptr, &stat) == 0);
+    testing.expect(stat.mode & 0o077 == 0);
+
+    var env_map = try process.getEnvMap(a);
+    try env_map.set("ZIG_SERVER", socket_path);
+    const served = try buildAsm(zig_exe, dir_path, "served", &env_map);
+    testing.expect(std.mem.eql(u8, direct, served));
+}
+
+fn testThinLto(zig_exe: []const u8, dir_path: []const u8) !void {
+    if (builtin.os != .linux) return;
+
+    const main_zig_path = try fs.path.join(a, [_][]const u8{ dir_path, "main.zig" });
+    const add_c_path = try fs.path.join(a, [_][]const u8{ dir_path, "add.c" });
+    try std.io.writeFile(main_zig_path,
+        \\const std = @import("std");
+        \\extern fn add(a: i32, b: i32) i32;
+        \\pub fn main() void {
+        \\    std.debug.warn("{}\n", add(40, 2));
+        \\}
+    );
+    try std.io.writeFile(add_c_path,
+        \\int add(int a, int b) {
+        \\    return a + b;
+        \\}
+    );
+
+    const exe_args = [_][]const u8{
+        zig_exe,       "build-exe",
+        main_zig_path, "--c-source",
+        add_c_path,    "--cache-dir",
+        dir_path,      "--output-dir",
+        dir_path,      "--release-fast",
+        "-flto=thin",
+    };
+    _ = try exec(dir_path, exe_args);
+    const main_exe_path = try fs.path.join(a, [_][]const u8{ dir_path, "main" });
+    const run_result = try exec(dir_path, [_][]const u8{main_exe_path});
+    testing.expect(std.mem.eql(u8, run_result.stderr, "42\n"));
+
+    // An object would hold bitcode that only the linker can optimize.
+    const obj_args = [_][]const u8{ zig_exe, "build-obj", main_zig_path, "--cache-dir", dir_path, "-flto=thin" };
+    const obj_result = try ChildProcess.exec(a, obj_args, dir_path, null, 100 * 1024);
+    testing.expect(obj_result.term.Exited != 0);
+    testing.expect(std.mem.indexOf(u8, obj_result.stderr, "-flto=thin requires an executable") != null);
+}
+
+fn testCPch(zig_exe: []const u8, dir_path: []const u8) !void {
+    const main_zig_path = try fs.path.join(a, [_][]const u8{ dir_path, "main.zig" });
+    const first_c_path = try fs.path.join(a, [_][]const u8{ dir_path, "first.c" });
+    const second_c_path = try fs.path.join(a, [_][]const u8{ dir_path, "second.c" });
+    try std.io.writeFile(main_zig_path,
+        \\const std = @import("std");
+        \\extern fn first() usize;
+        \\extern fn second() usize;
+        \\pub fn main() void {
+        \\    std.debug.warn("{} {}\n", first(), second());
+        \\}
+    );
+    try std.io.writeFile(first_c_path,
+        \\#include <stdlib.h>
+        \\#include <string.h>
+        \\size_t first(void) {
+        \\    return strlen("one");
+        \\}
+    );
+    try std.io.writeFile(second_c_path,
+        \\#include <stdlib.h>
+        \\#include <string.h>
+        \\size_t second(void) {
+        \\    return strlen("three");
+        \\}
+    );
+
+    const exe_args = [_][]const u8{
+        zig_exe,       "build-exe",
+        main_zig_path, "--c-source",
+        first_c_path,  "--c-source",
+        second_c_path, "--library",
+        "c",           "--cache-dir",
+        dir_path,      "--output-dir",
+        dir_path,      "--enable-c-pch",
+        "--verbose-cc",
+    };
+    const build_result = try exec(dir_path, exe_args);
+    // The shared includes are compiled once and used by both sources.
+    testing.expect(std.mem.indexOf(u8, build_result.stderr, "-include-pch") != null);
+    const main_exe_path = try fs.path.join(a, [_][]const u8{ dir_path, "main" });
+    const run_result = try exec(dir_path, [_][]const u8{main_exe_path});
+    testing.expect(std.mem.eql(u8, run_result.stderr, "3 5\n"));
+}
+
+fn testLazyCImport(zig_exe: []const u8, dir_path: []const u8) !void {
+    const main_zig_path = try fs.path.join(a, [_][]const u8{ dir_path, "main.zig" });
+    const lazy_h_path = try fs.path.join(a, [_][]const u8{ dir_path, "lazy.h" });
+    const lazy_c_path = try fs.path.join(a, [_][]const u8{ dir_path, "lazy.c" });
+    try std.io.writeFile(main_zig_path,
+        \\const std = @import("std");
+        \\const c = @cImport(@cInclude("lazy.h"));
+        \\const ns = struct {
+        \\    usingnamespace c;
+        \\};
+        \\pub fn main() void {
+        \\    var p = c.lazy_point_t{ .x = 1, .y = 2 };
+        \\    const color: c.lazy_color = c.lazy_green;
+        \\    std.debug.warn("{} {} {}\n", c.lazy_sum(&p), c.lazy_twice(@enumToInt(color)), ns.LAZY_ANSWER);
+        \\}
+    );
+    try std.io.writeFile(lazy_h_path,
+        \\#define LAZY_ANSWER 42
+        \\struct lazy_point { int x; int y; };
+        \\typedef struct lazy_point lazy_point_t;
+        \\enum lazy_color { lazy_red, lazy_green = 5 };
+        \\int lazy_sum(const lazy_point_t *p);
+        \\static inline int lazy_twice(int v) { return v * 2; }
+        \\struct lazy_unused;
+        \\int lazy_unused_fn(struct lazy_unused *u);
+    );
+    try std.io.writeFile(lazy_c_path,
+        \\#include "lazy.h"
+        \\int lazy_sum(const lazy_point_t *p) {
+        \\    return p->x + p->y;
+        \\}
+    );
+
+    const exe_args = [_][]const u8{
+        zig_exe,       "build-exe",
+        main_zig_path, "--c-source",
+        lazy_c_path,   "-isystem",
+        dir_path,      "--cache-dir",
+        dir_path,      "--output-dir",
+        dir_path,      "--lazy-cimport",
+    };
+    _ = try exec(dir_path, exe_args);
+    const main_exe_path = try fs.path.join(a, [_][]const u8{ dir_path, "main" });
+    const run_result = try exec(dir_path, [_][]const u8{main_exe_path});
+    testing.expect(std.mem.eql(u8, run_result.stderr, "3 10 42\n"));
+}
+
+fn testCodegenUnits(zig_exe: []const u8, dir_path: []const u8) !void {
+    const main_zig_path = try fs.path.join(a, [_][]const u8{ dir_path, "main.zig" });
+    const main_exe_path = try fs.path.join(a, [_][]const u8{ dir_path, "main" });
+    try std.io.writeFile(main_zig_path,
+        \\const std = @import("std");
+        \\threadlocal var calls: u32 = 0;
+        \\fn fib(n: u32) u32 {
+        \\    calls += 1;
+        \\    return if (n < 2) n else fib(n - 1) + fib(n - 2);
+        \\}
+        \\pub fn main() void {
+        \\    std.debug.warn("{} {}\n", fib(20), calls);
+        \\}
+    );
+
+    const release_args = [_][]const u8{
+        zig_exe,           "build-exe",
+        main_zig_path,     "--cache-dir",
+        dir_path,          "--output-dir",
+        dir_path,          "--release-fast",
+        "--codegen-units", "4",
+    };
+    _ = try exec(dir_path, release_args);
+    const release_result = try exec(dir_path, [_][]const u8{main_exe_path});
+    testing.expect(std.mem.eql(u8, release_result.stderr, "6765 21891\n"));
+
+    // In Debug, the units that do not use the thread local must not declare it.
+    const debug_args = [_][]const u8{
+        zig_exe,           "build-exe",
+        main_zig_path,     "--cache-dir",
+        dir_path,          "--output-dir",
+        dir_path,          "--codegen-units",
+        "4",
+    };
+    _ = try exec(dir_path, debug_args);
+    const debug_result = try exec(dir_path, [_][]const u8{main_exe_path});
+    testing.expect(std.mem.eql(u8, debug_result.stderr, "6765 21891\n"));
+}
+
+fn testCodegenUnitCache(zig_exe: []const u8, dir_path: []const u8) !void {
+    const main_zig_path = try fs.path.join(a, [_][]const u8{ dir_path, "main.zig" });
+    const args = [_][]const u8{
+        zig_exe,           "build-exe",
+        main_zig_path,     "--cache-dir",
+        dir_path,          "--cache",
+        "on",              "--codegen-units",
+        "4",               "-ftime-report",
+    };
+    const reused_suffix = " of 4 codegen units reused from the cache";
+
+    try std.io.writeFile(main_zig_path,
+        \\const std = @import("std");
+        \\fn square(x: u64) u64 {
+        \\    return x * x;
+        \\}
+        \\pub fn main() void {
+        \\    var list = std.ArrayList(u64).init(std.heap.direct_allocator);
+        \\    var i: u64 = 0;
+        \\    while (i < 10) : (i += 1) list.append(square(i)) catch unreachable;
+        \\    std.debug.warn("{}\n", list.len);
+        \\}
+    );
+    const first_reused = try timeReportCount((try exec(dir_path, args)).stdout, reused_suffix);
+    testing.expect(first_reused == 0);
+
+    // Only the unit holding square changes, although the edit adds a string
+    // literal for the overflow panic to the module.
+    try std.io.writeFile(main_zig_path,
+        \\const std = @import("std");
+        \\fn square(x: u64) u64 {
+        \\    return x * x + 1;
+        \\}
+        \\pub fn main() void {
+        \\    var list = std.ArrayList(u64).init(std.heap.direct_allocator);
+        \\    var i: u64 = 0;
+        \\    while (i < 10) : (i += 1) list.append(square(i)) catch unreachable;
+        \\    std.debug.warn("{}\n", list.len);
+        \\}
+    );
+    const edit_reused = try timeReportCount((try exec(dir_path, args)).stdout, reused_suffix);
+    testing.expect(edit_reused > 0);
+}
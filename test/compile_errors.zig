@@ -2,6 +2,40 @@ const tests = @import("tests.zig");
 const builtin = @import("builtin");
 
 pub fn addCases(cases: *tests.CompileErrorContext) void {
+    cases.add(
+        "error in a later comptime call of a function reports that call",
+        \\fn f(x: u32) u32 {
+        \\    if (x == 2) @compileError("two");
+        \\    return x;
+        \\}
+        \\export fn entry() u32 {
+        \\    const a = comptime f(1);
+        \\    const b = comptime f(2);
+        \\    return a + b;
+        \\}
+    ,
+        "tmp.zig:2:17: error: two",
+        "tmp.zig:7:25: note: called from here",
+    );
+
+    cases.add(
+        "keyword at end of file",
+        \\export fn entry() void {}
+        \\const
+    ,
+        "tmp.zig:2:1: error: expected token 'Symbol', found 'EOF'",
+    );
+
+    cases.add(
+        "identifier at end of file",
+        \\export fn entry() void {
+        \\    var a: @This() = undefined;
+        \\}
+        \\x: bogus
+    ,
+        "tmp.zig:4:4: error: use of undeclared identifier 'bogus'",
+    );
+
     cases.add(
         "capture group on switch prong with incompatible payload types",
         \\const Union = union(enum) {
@@ -41,6 +41,8 @@ comptime {
     _ = @import("behavior/byval_arg_var.zig");
     _ = @import("behavior/cancel.zig");
     _ = @import("behavior/cast.zig");
+    _ = @import("behavior/comptime_cache.zig");
+    _ = @import("behavior/comptime_loop.zig");
     _ = @import("behavior/const_slice_child.zig");
     _ = @import("behavior/coroutine_await_struct.zig");
     _ = @import("behavior/coroutines.zig");
@@ -274,3 +274,22 @@ test "double nested array to const slice cast in array literal" {
     S.entry(2);
     comptime S.entry(2);
 }
+
+test "comptime stores into a string literal copy" {
+    comptime {
+        var a = "hello";
+        const b = a;
+        a[0] = 'j';
+        a[4] = 'y';
+        expect(mem.eql(u8, a[0..], "jelly"));
+        expect(mem.eql(u8, b[0..], "hello"));
+        expect(mem.eql(u8, "hello", "hello"[0..]));
+
+        var c = "ab" ** 3;
+        c[5] = 'c';
+        var d = c;
+        d[0] = 'x';
+        expect(mem.eql(u8, c[0..], "ababac"));
+        expect(mem.eql(u8, d[0..], "xbabac"));
+    }
+}
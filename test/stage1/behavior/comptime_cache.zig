@@ -0,0 +1,67 @@
+const std = @import("std");
+const expect = std.testing.expect;
+const mem = std.mem;
+
+// The results of these calls are kept in the comptime cache, and a rebuild
+// after editing some other file loads them instead of running the calls.
+// Either way they must come out the same. test/cli.zig checks that the
+// entries are hit and invalidated.
+
+const Point = struct {
+    x: i32,
+    y: i32,
+    name: []const u8,
+};
+
+fn makePoint(comptime x: i32) Point {
+    return Point{
+        .x = x,
+        .y = x * 2,
+        .name = "point " ++ [_]u8{@intCast(u8, '0' + x)},
+    };
+}
+
+fn squares(comptime n: usize) [n]u32 {
+    var result: [n]u32 = undefined;
+    for (result) |*r, i| {
+        r.* = @intCast(u32, i * i);
+    }
+    return result;
+}
+
+fn greeting(comptime name: []const u8) []const u8 {
+    return "hello, " ++ name;
+}
+
+fn wordCount() usize {
+    const words = @embedFile("comptime_cache/words.txt");
+    var count: usize = 0;
+    for (words) |c| {
+        if (c == ' ' or c == '\n') count += 1;
+    }
+    return count;
+}
+
+fn firstWord() []const u8 {
+    const words = @embedFile("comptime_cache/words.txt");
+    return words[0..mem.indexOfScalar(u8, words, ' ').?];
+}
+
+test "comptime calls returning structs, arrays and slices" {
+    const p = comptime makePoint(3);
+    expect(p.x == 3);
+    expect(p.y == 6);
+    expect(mem.eql(u8, p.name, "point 3"));
+
+    const s = comptime squares(5);
+    expect(s.len == 5);
+    expect(s[0] == 0 and s[1] == 1 and s[2] == 4 and s[3] == 9 and s[4] == 16);
+
+    const g = comptime greeting("world");
+    expect(mem.eql(u8, g, "hello, world"));
+}
+
+test "comptime calls that embed a file" {
+    comptime expect(wordCount() == 3);
+    expect(mem.eql(u8, comptime firstWord(), "alpha"));
+}
@@ -0,0 +1,100 @@
+const std = @import("std");
+const expect = std.testing.expect;
+
+// These loops run mostly in the comptime loop interpreter. They must give
+// the same results as analysis does.
+
+fn addOne(x: u32) u32 {
+    return x + 1;
+}
+
+fn doublingTable() [16]u32 {
+    var table: [16]u32 = undefined;
+    table[0] = 1;
+    var i: usize = 1;
+    while (i < 16) : (i += 1) {
+        table[i] = table[i - 1] * 2;
+        // The interpreter stops here after storing to the table, and
+        // analysis runs this iteration again.
+        if (i == 5) table[i] = addOne(table[i]);
+    }
+    return table;
+}
+
+test "comptime loop storing to array elements" {
+    const table = comptime doublingTable();
+    var expected: u32 = 1;
+    for (table) |x, i| {
+        expect(x == expected);
+        expected = if (i == 4) x * 2 + 1 else x * 2;
+    }
+}
+
+fn sieve() [64]bool {
+    var composite = [_]bool{false} ** 64;
+    var i: usize = 2;
+    while (i < 64) : (i += 1) {
+        if (composite[i]) continue;
+        var j = i * i;
+        while (j < 64) : (j += i) {
+            composite[j] = true;
+        }
+    }
+    return composite;
+}
+
+test "comptime nested loops over a bool array" {
+    const composite = comptime sieve();
+    var count: usize = 0;
+    var i: usize = 2;
+    while (i < 64) : (i += 1) {
+        if (!composite[i]) count += 1;
+    }
+    expect(count == 18);
+    expect(!composite[61] and composite[63]);
+}
+
+const primes = [_]u32{ 2, 3, 5, 7, 11, 13 };
+
+fn sumOfSquares() u32 {
+    var sum: u32 = 0;
+    for (primes) |p| {
+        sum += p * p;
+    }
+    return sum;
+}
+
+fn prefixSums() [8]u64 {
+    var values = [_]u64{ 3, 1, 4, 1, 5, 9, 2, 6 };
+    var sums: [8]u64 = undefined;
+    var total: u64 = 0;
+    for (values) |x, i| {
+        total += x;
+        sums[i] = total;
+        values[i] = 0;
+    }
+    return sums;
+}
+
+test "comptime for loops over arrays" {
+    comptime expect(sumOfSquares() == 377);
+    const sums = comptime prefixSums();
+    expect(sums[0] == 3 and sums[3] == 9 and sums[7] == 31);
+}
+
+fn indexOfFirstOverflow() usize {
+    var values: [10]u8 = undefined;
+    var x: u8 = 1;
+    var i: usize = 0;
+    while (i < 10) : (i += 1) {
+        values[i] = x;
+        x = x *% 3;
+        // Returning leaves the loop from the interpreter.
+        if (x < values[i]) return i;
+    }
+    return 10;
+}
+
+test "comptime loop leaving from the middle of an iteration" {
+    comptime expect(indexOfFirstOverflow() == 5);
+}
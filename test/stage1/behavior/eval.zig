@@ -794,3 +794,14 @@ test "no undeclared identifier error in unanalyzed branches" {
         lol_this_doesnt_exist = nonsense;
     }
 }
+
+test "comptime calls of one function with zero-bit and sized arguments" {
+    comptime {
+        expect(sizeOfArg(u32(1)) == 4);
+        expect(sizeOfArg({}) == 0);
+    }
+}
+
+fn sizeOfArg(x: var) usize {
+    return @sizeOf(@typeOf(x));
+}
@@ -235,11 +235,12 @@ fn testStruct() void {
     expect(struct_info.Struct.fields[1].offset == null);
     expect(struct_info.Struct.fields[2].field_type == *TestStruct);
     expect(struct_info.Struct.decls.len == 2);
-    expect(struct_info.Struct.decls[0].is_pub);
-    expect(!struct_info.Struct.decls[0].data.Fn.is_extern);
-    expect(struct_info.Struct.decls[0].data.Fn.lib_name == null);
-    expect(struct_info.Struct.decls[0].data.Fn.return_type == void);
-    expect(struct_info.Struct.decls[0].data.Fn.fn_type == fn (*const TestStruct) void);
+    expect(mem.eql(u8, struct_info.Struct.decls[0].name, "Self"));
+    expect(struct_info.Struct.decls[1].is_pub);
+    expect(!struct_info.Struct.decls[1].data.Fn.is_extern);
+    expect(struct_info.Struct.decls[1].data.Fn.lib_name == null);
+    expect(struct_info.Struct.decls[1].data.Fn.return_type == void);
+    expect(struct_info.Struct.decls[1].data.Fn.fn_type == fn (*const TestStruct) void);
 }
 
 const TestStruct = packed struct {
@@ -12,3 +12,15 @@ test "usingnamespace inside a generic struct" {
     std2.testing.expect(true);
     testing2.expect(true);
 }
+
+const SelfImport = struct {
+    usingnamespace @This();
+
+    pub const a = 1;
+    pub const b = 2;
+};
+
+test "usingnamespace of the enclosing container" {
+    std.testing.expect(SelfImport.a == 1);
+    std.testing.expect(SelfImport.b == 2);
+}